@@ -15,6 +15,7 @@
  */
 #include "backend/common/pass/communication_op_fusion.h"
 
+#include <algorithm>
 #include <vector>
 #include <set>
 #include <memory>
@@ -136,10 +137,11 @@ bool CheckSegments(size_t communication_op_node_size, const std::vector<size_t>
 }
 }  // namespace
 
-bool CommunicationOpFusion::GetSplitSegments(const CommunicationOpInfo &communication_op_info,
+bool CommunicationOpFusion::GetSplitSegments(CommunicationOpInfo *communication_op_info,
                                              std::vector<size_t> *segment_index, const std::string &group) const {
+  MS_EXCEPTION_IF_NULL(communication_op_info);
   MS_EXCEPTION_IF_NULL(segment_index);
-  size_t communication_op_node_size = communication_op_info.communication_op_nodes.size();
+  size_t communication_op_node_size = communication_op_info->communication_op_nodes.size();
   MS_LOG(INFO) << "graph " << op_name_ << " node size " << communication_op_node_size;
 
   if (op_name_ == kHcomSendOpName || op_name_ == kReceiveOpName) {
@@ -182,11 +184,16 @@ bool CommunicationOpFusion::GetSplitSegments(const CommunicationOpInfo &communic
     segment_index->push_back(communication_op_node_size - 1);
   }
   auto parallel_mode = parallel_context->parallel_mode();
-  if (parallel_mode == parallel::kDataParallel && op_name_ == kAllReduceOpName) {
-    auto threshold = parallel_context->dp_fusion_threshold_mb();
-    GetAllReduceSplitSegment(communication_op_info.communication_op_nodes, threshold, segment_index);
+  auto threshold = parallel_context->dp_fusion_threshold_mb();
+  if (parallel_mode == parallel::kDataParallel && op_name_ == kAllReduceOpName && threshold > 0) {
+    GetAllReduceSplitSegment(communication_op_info->communication_op_nodes, threshold, segment_index);
     MS_LOG(INFO) << "The split threshold for AllReduce is " << threshold << ", the segment num is "
                  << segment_index->size();
+  } else if (op_name_ == kAllReduceOpName && bucket_size_ > 0 && split_indices.empty() && groups_ == 1) {
+    GetBucketSplitSegment(*communication_op_info, segment_index);
+    communication_op_info->bucketed = segment_index->size() > 1;
+    MS_LOG(INFO) << "The bucket size for AllReduce is " << bucket_size_ << ", the segment num is "
+                 << segment_index->size();
   }
   return CheckSegments(communication_op_node_size, segment_index);
 }
@@ -224,6 +231,39 @@ void CommunicationOpFusion::GetAllReduceSplitSegment(const std::vector<CNodePtr>
   *segment_index = std::move(real_segment_index);
 }
 
+void CommunicationOpFusion::GetBucketSplitSegment(const CommunicationOpInfo &communication_op_info,
+                                                  std::vector<size_t> *segment_index) const {
+  MS_EXCEPTION_IF_NULL(segment_index);
+  const auto &nodes = communication_op_info.communication_op_nodes;
+  if (nodes.empty()) {
+    return;
+  }
+  // Fill the buckets in the order that the inputs are ready, so the first bucket is launched as early as possible and
+  // its reduction overlaps the computation of the inputs of the later buckets.
+  std::vector<size_t> real_segment_index;
+  size_t accumulate = 0;
+  if (communication_op_info.sorted_by_index) {
+    for (size_t j = nodes.size() - 1; j > 0; --j) {
+      accumulate += AnfAlgo::GetOutputTensorMemSize(nodes[j], 0);
+      if (accumulate >= bucket_size_) {
+        real_segment_index.push_back(j - 1);
+        accumulate = 0;
+      }
+    }
+    std::reverse(real_segment_index.begin(), real_segment_index.end());
+    real_segment_index.push_back(nodes.size() - 1);
+  } else {
+    for (size_t j = 0; j < nodes.size(); ++j) {
+      accumulate += AnfAlgo::GetOutputTensorMemSize(nodes[j], 0);
+      if (accumulate >= bucket_size_ || j == nodes.size() - 1) {
+        real_segment_index.push_back(j);
+        accumulate = 0;
+      }
+    }
+  }
+  *segment_index = std::move(real_segment_index);
+}
+
 // Hard coded Load(%paraxxx, cnode()) to Load(%paraxxx, U) to prevent
 // cycle after AllReduce fused. It's a workaround.
 // case 1:
@@ -518,11 +558,15 @@ bool CommunicationOpFusion::Run(const FuncGraphPtr &func_graph) {
                          return common::AnfAlgo::GetNodeAttr<int64_t>(a, kAttrIndex) <
                                 common::AnfAlgo::GetNodeAttr<int64_t>(b, kAttrIndex);
                        });
+      it.second.sorted_by_index = true;
     }
     std::vector<size_t> segment_index;
-    if (GetSplitSegments(it.second, &segment_index, it.first)) {
+    if (GetSplitSegments(&it.second, &segment_index, it.first)) {
       if (DoFusion(func_graph, it.second, segment_index)) {
         changed = true;
+        if (it.second.bucketed) {
+          func_graph->set_flag(kAttrAllReduceBucketed, true);
+        }
       }
     }
   }
@@ -30,12 +30,18 @@ struct CommunicationOpInfo {
   std::vector<CNodePtr> communication_op_nodes;
   std::vector<float> input_grad_size;
   std::vector<float> input_grad_time;
+  // Whether the nodes are sorted by the index attr, which is the order of the parameters, and the gradients of the
+  // parameters are computed in the reversed order.
+  bool sorted_by_index{false};
+  // Whether the nodes are split into the buckets of bucket_size.
+  bool bucketed{false};
 };
 
 class CommunicationOpFusion : public Pass {
  public:
-  explicit CommunicationOpFusion(const std::string &name, std::string op_name, size_t groups = 1)
-      : Pass(name), op_name_(std::move(op_name)), groups_(groups) {}
+  explicit CommunicationOpFusion(const std::string &name, std::string op_name, size_t groups = 1,
+                                 size_t bucket_size = 0)
+      : Pass(name), op_name_(std::move(op_name)), groups_(groups), bucket_size_(bucket_size) {}
   ~CommunicationOpFusion() override = default;
   bool Run(const FuncGraphPtr &graph) override;
 
@@ -44,13 +50,18 @@ class CommunicationOpFusion : public Pass {
                 const std::vector<size_t> &segment_index) const;
   void GetAllReduceSplitSegment(const std::vector<CNodePtr> &nodes, int64_t threshold,
                                 std::vector<size_t> *segment_index) const;
+  void GetBucketSplitSegment(const CommunicationOpInfo &communication_op_info,
+                             std::vector<size_t> *segment_index) const;
   AnfNodePtr CreateFusedCommunicationOp(const FuncGraphPtr &func_graph,
                                         const CommunicationOpInfo &communication_op_info, size_t start_index,
                                         size_t end_index) const;
-  bool GetSplitSegments(const CommunicationOpInfo &communication_op_info, std::vector<size_t> *segment_index,
+  bool GetSplitSegments(CommunicationOpInfo *communication_op_info, std::vector<size_t> *segment_index,
                         const std::string &group) const;
   std::string op_name_;
   size_t groups_ = 1;
+  // The max byte size of the fused communication op if the split is not configured, the fused op of each bucket can
+  // be launched once the inputs of the bucket are ready, 0 means no limit.
+  size_t bucket_size_ = 0;
 };
 
 class SendFusion : public CommunicationOpFusion {
@@ -67,7 +78,8 @@ class RecvFusion : public CommunicationOpFusion {
 
 class AllReduceFusion : public CommunicationOpFusion {
  public:
-  explicit AllReduceFusion(size_t groups = 1) : CommunicationOpFusion("all_reduce_fusion", kAllReduceOpName, groups) {}
+  explicit AllReduceFusion(size_t groups = 1, size_t bucket_size = 0)
+      : CommunicationOpFusion("all_reduce_fusion", kAllReduceOpName, groups, bucket_size) {}
   ~AllReduceFusion() override = default;
 };
 
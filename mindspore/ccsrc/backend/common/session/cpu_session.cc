@@ -193,8 +193,13 @@ void CPUSession::LoadInputData(const std::shared_ptr<KernelGraph> &kernel_graph,
 
 void CPUSession::PreExecuteGraph(const std::shared_ptr<KernelGraph> &kernel_graph,
                                  const std::vector<tensor::TensorPtr> &inputs, VectorRef *const outputs) {
-  MS_LOG(INFO) << "Bind input output address";
-  runtime_.BindInputOutput(kernel_graph.get(), inputs, outputs);
+  if (device::KernelRuntime::UseMemScheduler()) {
+    // The inputs are copied into the memory of MemScheduler when the kernels are launched.
+    kernel_graph->SetInputTensors(inputs);
+  } else {
+    MS_LOG(INFO) << "Bind input output address";
+    runtime_.BindInputOutput(kernel_graph.get(), inputs, outputs);
+  }
 
 #if ((defined ENABLE_CPU) && (!defined _WIN32) && !defined(__APPLE__))
   InitPSParamAndOptim(kernel_graph, inputs);
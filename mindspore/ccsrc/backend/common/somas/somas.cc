@@ -16,9 +16,12 @@
 
 #include "backend/common/somas/somas.h"
 #include <algorithm>
+#include <cctype>
 #include <fstream>
 #include <iterator>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <set>
 
@@ -79,6 +82,81 @@ std::map<TensorType, std::string> tensor_type_name_map = {{kCommon, "Common"},
                                                           {kEventVirtualOutput, "EventVirtualOutput"},
                                                           {kUnknown, "Unknown"}};
 
+namespace {
+// The solved results of the latest graphs in this process by the SOMAS model hash, so that recompiling an unchanged
+// graph reuses the offsets without solving or reading the cache file again. Only the kMaxCachedResults most recently
+// used results are kept, the older ones are still found in the cache files.
+class SomasResultCache {
+ public:
+  static SomasResultCache &GetInstance() {
+    static SomasResultCache instance;
+    return instance;
+  }
+
+  bool Get(const std::string &hash_id, nlohmann::json *somas_json) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto &iter = index_.find(hash_id);
+    if (iter == index_.end()) {
+      return false;
+    }
+    results_.splice(results_.begin(), results_, iter->second);
+    *somas_json = iter->second->second;
+    return true;
+  }
+
+  void Put(const std::string &hash_id, const nlohmann::json &somas_json) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto &iter = index_.find(hash_id);
+    if (iter != index_.end()) {
+      iter->second->second = somas_json;
+      results_.splice(results_.begin(), results_, iter->second);
+      return;
+    }
+    results_.emplace_front(hash_id, somas_json);
+    index_[hash_id] = results_.begin();
+    if (results_.size() > kMaxCachedResults) {
+      (void)index_.erase(results_.back().first);
+      results_.pop_back();
+    }
+  }
+
+ private:
+  static constexpr size_t kMaxCachedResults = 8;
+  SomasResultCache() = default;
+  std::mutex mutex_;
+  // Most recently used first
+  std::list<std::pair<std::string, nlohmann::json>> results_;
+  std::map<std::string, std::list<std::pair<std::string, nlohmann::json>>::iterator> index_;
+};
+
+// Remove the unique ids of the ops like "Conv2D-op123", which change when the graph is compiled again.
+std::string RemoveOpIds(const std::string &info) {
+  constexpr char kOpIdPrefix[] = "-op";
+  constexpr size_t kOpIdPrefixLen = sizeof(kOpIdPrefix) - 1;
+  std::string result;
+  result.reserve(info.size());
+  size_t pos = 0;
+  while (pos < info.size()) {
+    auto found = info.find(kOpIdPrefix, pos);
+    if (found == std::string::npos) {
+      (void)result.append(info, pos, std::string::npos);
+      break;
+    }
+    auto end = found + kOpIdPrefixLen;
+    while (end < info.size() && std::isdigit(static_cast<unsigned char>(info[end]))) {
+      ++end;
+    }
+    (void)result.append(info, pos, found - pos);
+    if (end == found + kOpIdPrefixLen) {
+      // Not followed by the id.
+      (void)result.append(kOpIdPrefix);
+    }
+    pos = end;
+  }
+  return result;
+}
+}  // namespace
+
 std::map<LifeLongType, std::string> life_long_name_map = {{kLifeLongNone, "LifeLongNone"},
                                                           {kLifeLongGraphAll, "LifeLongGraphAll"},
                                                           {kLifeLongGraphStart, "LifeLongGraphStart"},
@@ -128,8 +206,14 @@ bool Somas::LoadSomasCache(const session::KernelGraph *graph) {
 
   bool ret = CalcSomasModelHash(graph);
   if (ret) {
-    std::string filename = Common::GetCompilerCachePath() + "/somas_meta/somas_graph_" +
-                           std::to_string(graph->graph_id()) + "_" + hash_id_ + ".json";
+    nlohmann::json somas_json;
+    if (SomasResultCache::GetInstance().Get(hash_id_, &somas_json) && VerifySomasResult(graph, somas_json) &&
+        UpdateTensorsOffset(somas_json[kTensors])) {
+      mem_offset_ = somas_json[kMemOffset];
+      MS_LOG(INFO) << "Reuse the Somas result of hash id " << hash_id_ << " for graph " << graph->graph_id();
+      return true;
+    }
+    std::string filename = Common::GetCompilerCachePath() + "/somas_meta/somas_graph_" + hash_id_ + ".json";
     ret = LoadSomasResult(graph, filename);
     if (ret) {
       MS_LOG(INFO) << "Load Somas Cache file " << filename << " Successfully.";
@@ -143,11 +227,11 @@ bool Somas::LoadSomasCache(const session::KernelGraph *graph) {
 
 bool Somas::CalcSomasModelHash(const session::KernelGraph *graph) {
   MS_EXCEPTION_IF_NULL(graph);
-  auto model_str = SomasInfo(true);
+  // The hash doesn't depend on the graph id and op ids, the unchanged graph compiled again gets the same hash.
+  auto model_str = RemoveOpIds(SomasInfo(true));
   hash_id_ = std::to_string(std::hash<std::string>()(model_str));
   MS_LOG(INFO) << "Graph " << graph->graph_id() << "'s SOMAS Model hash id is " << hash_id_;
-  std::string filename = Common::GetCompilerCachePath() + "/somas_meta/somas_graph_" +
-                         std::to_string(graph->graph_id()) + "_" + hash_id_ + ".info";
+  std::string filename = Common::GetCompilerCachePath() + "/somas_meta/somas_graph_" + hash_id_ + ".info";
   return Common::SaveStringToFile(filename, model_str);
 }
 
@@ -182,9 +266,9 @@ bool Somas::SaveSomasResult(const session::KernelGraph *graph) {
     tensors_json.emplace_back(tensor_json);
   }
   somas_json[kTensors] = tensors_json;
+  SomasResultCache::GetInstance().Put(hash_id_, somas_json);
 
-  std::string filename = Common::GetCompilerCachePath() + "/somas_meta/somas_graph_" +
-                         std::to_string(graph->graph_id()) + "_" + hash_id_ + ".json";
+  std::string filename = Common::GetCompilerCachePath() + "/somas_meta/somas_graph_" + hash_id_ + ".json";
   (void)Common::SaveStringToFile(filename, somas_json.dump());
   return true;
 }
@@ -235,8 +319,7 @@ bool Somas::VerifySomasResult(const session::KernelGraph *graph, const nlohmann:
   auto stream_group_size = somas_json[kStreamGroupSize];
 
   if (graph_id != graph->graph_id()) {
-    MS_LOG(WARNING) << "Mismatch graph id " << graph_id << " vs " << graph->graph_id();
-    return false;
+    MS_LOG(INFO) << "The Somas result of graph " << graph_id << " is reused by graph " << graph->graph_id();
   }
 
   if (hash_id != hash_id_) {
@@ -1047,34 +1130,43 @@ void Somas::ComputeConflictPairs() {
     reuse_matrix_.emplace_back(count);
   }
 
-  if (tensors_list_.size() < kParallelComputeSizeThreshold) {
-    ComputeMultiTensorConflicts(tensors_list_, tensors_list_, nodes_dependency, &reuse_matrix_);
-  } else {
-    MS_LOG(INFO) << "Tensor Num " << tensors_list_.size() << " is larger than " << kParallelComputeSizeThreshold;
-    MS_LOG(INFO) << "Enter Multi-Thread Mode...";
-    size_t process_num = common::ThreadPool::GetInstance().GetSyncRunThreadNum();
-    MS_LOG(INFO) << "Threads Num is " << process_num;
-
-    int64_t start_index = 0;
-    int64_t total_size = tensors_list_.size();
-    int64_t job_size = total_size / process_num;
-    if (job_size == 0) {
-      job_size = total_size;
-    }
-    std::vector<common::Task> tasks;
-    while (start_index < total_size) {
-      int64_t end_index = (start_index + job_size) > total_size ? total_size : start_index + job_size;
-      auto jobs = std::vector<SomasTensorPtr>(tensors_list_.begin() + start_index, tensors_list_.begin() + end_index);
-      auto task = [this, jobs, &nodes_dependency]() {
-        this->ComputeMultiTensorConflicts(jobs, tensors_list_, nodes_dependency, &reuse_matrix_);
-        return common::SUCCESS;
-      };
-      tasks.emplace_back(task);
-      start_index += job_size;
-    }
-
-    common::ThreadPool::GetInstance().SyncRun(tasks);
+  // Every task computes the relations of its tensors with the tensors after them and writes only the bitsets of its
+  // tensors, so the tasks never write the same word. The rows are interleaved to the tasks for the balance, because the
+  // earlier tensors have more tensors after them. The relations are mirrored to the bitsets of later tensors at last.
+  size_t process_num = 1;
+  if (tensors_list_.size() >= kParallelComputeSizeThreshold) {
+    process_num = common::ThreadPool::GetInstance().GetSyncRunThreadNum();
+    MS_LOG(INFO) << "Tensor Num " << tensors_list_.size() << " is larger than " << kParallelComputeSizeThreshold
+                 << ", compute the tensor relations in " << process_num << " threads.";
+  }
+  std::vector<common::Task> tasks;
+  for (size_t task_id = 0; task_id < process_num; ++task_id) {
+    auto task = [this, task_id, process_num, &nodes_dependency]() {
+      for (size_t i = task_id; i < tensors_list_.size(); i += process_num) {
+        ComputeOneTensorConflicts(i, nodes_dependency, &reuse_matrix_);
+      }
+      return common::SUCCESS;
+    };
+    tasks.emplace_back(task);
+  }
+  (void)common::ThreadPool::GetInstance().SyncRun(tasks);
+  tasks.clear();
+  for (size_t task_id = 0; task_id < process_num; ++task_id) {
+    auto task = [this, task_id, process_num]() {
+      for (size_t j = task_id; j < tensors_list_.size(); j += process_num) {
+        auto target_id = tensors_list_[j]->GetId();
+        for (size_t i = 0; i < j; i++) {
+          auto calc_id = tensors_list_[i]->GetId();
+          if (reuse_matrix_[calc_id].IsBitTrue(target_id)) {
+            reuse_matrix_[target_id].SetBitTrue(calc_id);
+          }
+        }
+      }
+      return common::SUCCESS;
+    };
+    tasks.emplace_back(task);
   }
+  (void)common::ThreadPool::GetInstance().SyncRun(tasks);
   MS_LOG(INFO) << "End Tensor Relation Computing";
   auto end_conflict = std::chrono::system_clock::now();
   MS_LOG(INFO) << "End Conflict Computing (Bitset Model)(time taken "
@@ -1139,73 +1231,51 @@ void Somas::UpdateTensorDestinations() {
   }
 }
 
-void Somas::ComputeMultiTensorConflicts(const std::vector<SomasTensorPtr> &calc_tensors_list,
-                                        const std::vector<SomasTensorPtr> &all_tensors_list,
-                                        const vector<DynamicBitSet> &nodes_dependency,
-                                        std::vector<DynamicBitSet> *tensor_relation) const {
-  auto start = std::chrono::system_clock::now();
-  MS_LOG(INFO) << "Start Computing Conflicts Pairs, tensors list size is " << calc_tensors_list.size();
-  for (size_t i = 0; i < calc_tensors_list.size(); i++) {
-    auto calc_tensor = calc_tensors_list[i];
-    MS_EXCEPTION_IF_NULL(calc_tensor);
-    if (calc_tensor->IsLifelong() || calc_tensor->IsSemiLifelongEnd() || calc_tensor->IsRefOverlap() ||
-        calc_tensor->GetAlignedSize() == 0) {
-      continue;
-    }
+bool Somas::CanReuse(const SomasTensorPtr &calc_tensor, const SomasTensorPtr &target_tensor,
+                     const vector<DynamicBitSet> &nodes_dependency) const {
+  MS_EXCEPTION_IF_NULL(calc_tensor);
+  MS_EXCEPTION_IF_NULL(target_tensor);
+  if (calc_tensor->IsLifelong() || calc_tensor->IsSemiLifelongEnd() || calc_tensor->IsRefOverlap() ||
+      calc_tensor->GetAlignedSize() == 0) {
+    return false;
+  }
+  if (target_tensor->IsLifelong() || target_tensor->IsSemiLifelongStart() || target_tensor->IsRefOverlap() ||
+      target_tensor->GetAlignedSize() == 0) {
+    return false;
+  }
+  size_t target_src_node_id = target_tensor->GetSourceNodeId();
+  if (calc_tensor->GetSourceNodeId() == target_src_node_id) {
+    return false;
+  }
 
-    ComputeOneTensorConflicts(calc_tensor, all_tensors_list, nodes_dependency, tensor_relation);
+  // check calc_tensor's all consumers is target_tensor's source node's dependency or not
+  for (const auto &dst_map : calc_tensor->stream_max_destination_node_) {
+    const auto &dst_node_id = dst_map.second;
+    if (nodes_dependency[target_src_node_id].IsBitTrue(dst_node_id) == false) {
+      // calc_tensor's consumer is not in target_tensor's source node's dependency, not sure this consumer is done or
+      // not when target_tensor produced
+      return false;
+    } else if (target_src_node_id == dst_node_id) {
+      // calc_tensor is target_tensor's source node's input, can't reuse
+      return false;
+    }
   }
-  auto end = std::chrono::system_clock::now();
-  MS_LOG(INFO) << "End Computing Conflicts Pairs (time taken "
-               << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms)";
+  // calc_tensor's consumers are in target_tensor's source node's dependency, they are done when target_tensor produced
+  return true;
 }
 
-void Somas::ComputeOneTensorConflicts(const std::shared_ptr<SomasTensor> &calc_tensor,
-                                      const std::vector<SomasTensorPtr> &all_tensors_list,
-                                      const vector<DynamicBitSet> &nodes_dependency,
+void Somas::ComputeOneTensorConflicts(size_t calc_index, const vector<DynamicBitSet> &nodes_dependency,
                                       std::vector<DynamicBitSet> *tensor_relation) const {
+  MS_EXCEPTION_IF_NULL(tensor_relation);
+  const auto &calc_tensor = tensors_list_[calc_index];
   MS_EXCEPTION_IF_NULL(calc_tensor);
-  for (size_t j = 0; j < all_tensors_list.size(); j++) {
-    auto target_tensor = all_tensors_list[j];
-    MS_EXCEPTION_IF_NULL(target_tensor);
-    if (calc_tensor == target_tensor || target_tensor->IsLifelong() || target_tensor->IsSemiLifelongStart() ||
-        target_tensor->IsRefOverlap() || target_tensor->GetAlignedSize() == 0) {
-      continue;
-    }
-    size_t calc_src_node_id = calc_tensor->GetSourceNodeId();
-    size_t target_src_node_id = target_tensor->GetSourceNodeId();
-    if (calc_src_node_id == target_src_node_id) {
-      continue;
-    }
-    if ((*tensor_relation)[calc_tensor->GetId()].IsBitTrue(target_tensor->GetId()) ||
-        (*tensor_relation)[target_tensor->GetId()].IsBitTrue(calc_tensor->GetId())) {
-      continue;
-    }
-
-    bool reuse = true;
-    // check calc_tensor's all consumers is target_tensor's source node's dependency or not
-    for (const auto &dst_map : calc_tensor->stream_max_destination_node_) {
-      const auto &dst_node_id = dst_map.second;
-      if (nodes_dependency[target_src_node_id].IsBitTrue(dst_node_id) == false) {
-        // calc_tensor's consumer is not in target_tensor's source node's dependency, not sure this consumer is done or
-        // not when target_tensor produced
-        reuse = false;
-        break;
-      } else if (target_src_node_id == dst_node_id) {
-        // calc_tensor is target_tensor's source node's input, can't reuse
-        reuse = false;
-        break;
-      } else {
-        // calc_tensor's consumer is in target_tensor's source node's dependency, this consumer is done when
-        // target_tensor produced
-        reuse = true;
-      }
-    }
-
-    if (reuse) {
-      // calc_tensor and target_tensor have dependencies so they can reuse each other
-      (*tensor_relation)[calc_tensor->GetId()].SetBitTrue(target_tensor->GetId());
-      (*tensor_relation)[target_tensor->GetId()].SetBitTrue(calc_tensor->GetId());
+  auto &calc_relation = (*tensor_relation)[calc_tensor->GetId()];
+  for (size_t j = calc_index + 1; j < tensors_list_.size(); j++) {
+    const auto &target_tensor = tensors_list_[j];
+    // The two tensors can reuse each other if either one is produced after all consumers of the other one.
+    if (CanReuse(calc_tensor, target_tensor, nodes_dependency) ||
+        CanReuse(target_tensor, calc_tensor, nodes_dependency)) {
+      calc_relation.SetBitTrue(target_tensor->GetId());
     }
   }
 }
@@ -142,14 +142,10 @@ class Somas {
   SomasParameterPtr CreateSomasParameter(const AnfNodePtr &node, size_t index);
   void InitCommonNodeInputs(bool is_all_nop_node, const CNodePtr &kernel);
   void InitAtomicCleanInputs(bool is_all_nop_node, const CNodePtr &kernel);
-  void ComputeOneTensorConflicts(const std::shared_ptr<SomasTensor> &calc_tensor,
-                                 const std::vector<SomasTensorPtr> &all_tensors_list,
-                                 const vector<DynamicBitSet> &nodes_dependency,
+  bool CanReuse(const SomasTensorPtr &calc_tensor, const SomasTensorPtr &target_tensor,
+                const vector<DynamicBitSet> &nodes_dependency) const;
+  void ComputeOneTensorConflicts(size_t calc_index, const vector<DynamicBitSet> &nodes_dependency,
                                  std::vector<DynamicBitSet> *tensor_relation) const;
-  void ComputeMultiTensorConflicts(const std::vector<SomasTensorPtr> &calc_tensors_list,
-                                   const std::vector<SomasTensorPtr> &all_tensors_list,
-                                   const vector<DynamicBitSet> &nodes_dependency,
-                                   std::vector<DynamicBitSet> *tensor_relation) const;
   void UpdateTensorDestinations();
   void UpdateRefTensorsConflict();
   void UpdateRefOverlapTensorsConflicts();
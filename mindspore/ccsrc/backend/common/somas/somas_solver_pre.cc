@@ -107,7 +107,8 @@ Status SomasSolverPre::Solving(const session::KernelGraph *graph, TensorsDescMap
     constexpr size_t numAlgorithmTypes = static_cast<size_t>(kNumAlgorithmTypes);
     constexpr size_t total_sol = numSortingTypes * numFittingTypes * numAlgorithmTypes;
     size_t process_num = common::ThreadPool::GetInstance().GetSyncRunThreadNum();
-    bool isMultiThreadPermit = ball && process_num >= total_sol && total_sol > 1;
+    // The candidate solutions are solved in parallel, the thread pool runs the solutions more than its threads in turn.
+    bool isMultiThreadPermit = ball && process_num > 1 && total_sol > 1;
     bool isMultiThreadValid = isMultiThreadPermit && (total_sol > kSolNumThresholdMultiThread ||
                                                       kParallelComputeSizeThreshold <= tensors.size());
     const double giga = 1024. * 1024. * 1024.;
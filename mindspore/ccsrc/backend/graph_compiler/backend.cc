@@ -1332,17 +1332,19 @@ void MindRTBackend::BatchBuildCallback() {
     ms_context->set_param<bool>(MS_CTX_ENABLE_PYNATIVE_INFER, infer_flag);
     MS_LOG(DEBUG) << "End";
   } catch (const py::type_error &ex) {
+    // The python exceptions are rethrown as they are instead of copied. On the build thread of the op executor, which
+    // has no GIL, the exception is passed to the python thread and thrown there.
     op_executor.Reset();
-    throw py::type_error(ex);
+    throw;
   } catch (const py::value_error &ex) {
     op_executor.Reset();
-    throw py::value_error(ex);
+    throw;
   } catch (const py::index_error &ex) {
     op_executor.Reset();
-    throw py::index_error(ex);
+    throw;
   } catch (const py::name_error &ex) {
     op_executor.Reset();
-    throw py::name_error(ex);
+    throw;
   } catch (const std::exception &ex) {
     op_executor.Reset();
     throw(std::runtime_error(ex.what()));
@@ -1453,7 +1455,12 @@ void MindRTBackend::RunOp(OpRunInfo *op_run_info, VectorRef *outputs) {
   device_context->Initialize();
 
   bool single_op_cache_hit = true;
-  auto graph_id = graph_compiler_->CompileGraph(*op_run_info, &single_op_cache_hit, device_context);
+  GraphId graph_id;
+  {
+    // The kernels of the previous ops may be in building on the build thread of op executor.
+    auto compile_lock = runtime::OpExecutor::GetInstance().LockCompile();
+    graph_id = graph_compiler_->CompileGraph(*op_run_info, &single_op_cache_hit, device_context);
+  }
   std::string actor_info = std::to_string(graph_id) + "_" + op_run_info->op_name;
   if (runtime::OpExecutor::GetInstance().ActorInQueue(actor_info)) {
     WaitTaskFinish();
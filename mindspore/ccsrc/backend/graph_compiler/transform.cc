@@ -615,6 +615,14 @@ void SetMindRTEnable() {
     return;
   }
 
+  // The memory offload of CPU graphs is run by the CPU session with the MemScheduler.
+  if (!common::GetEnv(kCpuOffloadPath).empty() && target == kCPUDevice &&
+      context_ptr->get_param<int>(MS_CTX_EXECUTION_MODE) == kGraphMode) {
+    context_ptr->set_param<bool>(MS_CTX_ENABLE_MINDRT, false);
+    context_ptr->set_param<bool>(MS_CTX_ENABLE_MEM_SCHEDULER, true);
+    return;
+  }
+
   MS_LOG(DEBUG) << "Enable mindRT.";
   context_ptr->set_param<bool>(MS_CTX_ENABLE_MINDRT, true);
 }
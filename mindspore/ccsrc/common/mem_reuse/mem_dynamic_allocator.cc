@@ -43,6 +43,22 @@ static const std::map<AllocatorType, std::string> kAllocatorTypeString = {
   {AllocatorType::kOther, "other"},
 };
 
+// The index of size class bin of the idle memory buf.
+static size_t SizeClassBinIndex(size_t size) { return size == 0 ? 0 : (size - 1) / DYNAMIC_MEM_ALIGN_SIZE; }
+
+// The index of the lowest set bit, the bits must not be zero.
+static size_t LowestBitIndex(uint64_t bits) {
+  size_t index = 0;
+  for (size_t shift = DYNAMIC_MEM_BIN_BITMAP_BITS >> 1; shift > 0; shift >>= 1) {
+    uint64_t low_mask = (static_cast<uint64_t>(1) << shift) - 1;
+    if ((bits & low_mask) == 0) {
+      bits >>= shift;
+      index += shift;
+    }
+  }
+  return index;
+}
+
 DynamicMemPoolBestFit::~DynamicMemPoolBestFit() {
   persistent_mem_->clear();
   common_mem_->clear();
@@ -56,6 +72,19 @@ DeviceMemPtr DynamicMemPoolBestFit::AllocTensorMem(size_t size, bool from_persis
   if (!device_addr) {
     device_addr = AddMemBlockAndMemBuf(align_size, from_persistent_mem);
   }
+  // The memory freed on the streams can be reused after the streams are synchronized.
+  if (!device_addr && SyncAndReleaseDeferredFreeMem()) {
+    device_addr = FindIdleMemBuf(align_size, from_persistent_mem);
+    if (!device_addr) {
+      device_addr = AddMemBlockAndMemBuf(align_size, from_persistent_mem);
+    }
+  }
+  // The idle memory may be fragmented in several memory blocks, free the blocks which have no used memory buf and
+  // allocate the memory in one new memory block.
+  if (!device_addr && IsMemBlockReleasable() &&
+      (ReleaseFreeMemBlock(common_mem_) + ReleaseFreeMemBlock(persistent_mem_) > 0)) {
+    device_addr = AddMemBlockAndMemBuf(align_size, from_persistent_mem);
+  }
 
   // Alloc memory failed and dump the info.
   if (!device_addr) {
@@ -122,33 +151,87 @@ DeviceMemPtr DynamicMemPoolBestFit::FindIdleMemBuf(size_t size, bool from_persis
   if (from_persistent_mem) {
     mem_mng = persistent_mem_;
   }
+  // Take the idle memory buf out of the size class bin or the size map.
+  auto mem_buf = TakeIdleMemBuf(size, mem_mng);
+  if (mem_buf == nullptr) {
+    return nullptr;
+  }
+  if (mem_buf->status_ != DynamicMemBufStatus::kMemBufIdle) {
+    DumpDynamicMemPoolDebugInfo();
+    MS_LOG(EXCEPTION) << "Find the mem_buf is not idle, alloc_size[" << size << "] mem_buf_size[" << mem_buf->size_
+                      << "] mem_buf_address[" << mem_buf->device_addr_ << "].";
+  }
+  mem_buf->status_ = DynamicMemBufStatus::kMemBufUsed;
+  mem_buf->allocator_name_ = DynamicMemAllocatorDebugInfo::GetDebugInfo().name_;
+  mem_buf->allocator_type_ = DynamicMemAllocatorDebugInfo::GetDebugInfo().type_;
+  // Divide memory buf
+  if (IsSplit(size, mem_buf->size_)) {
+    SplitMemBuf(size, mem_buf, mem_mng);
+  }
+  // Memory statistics
+  mem_mng->mps_.total_used_mem_size_ += mem_buf->size_;
+  if (mem_mng->mps_.total_used_mem_size_ > mem_mng->mps_.used_mem_peak_size_) {
+    mem_mng->mps_.used_mem_peak_size_ = mem_mng->mps_.total_used_mem_size_;
+  }
+  return mem_buf->device_addr_;
+}
+
+DynamicMemBufPtr DynamicMemPoolBestFit::TakeIdleMemBuf(size_t size, const MemStatusManagerPtr &mem_mng) {
   MS_EXCEPTION_IF_NULL(mem_mng);
-  const auto &iter = mem_mng->idle_mem_buf_map_.lower_bound(size);
-  if (iter != mem_mng->idle_mem_buf_map_.end()) {
-    auto mem_buf = iter->second;
-    MS_EXCEPTION_IF_NULL(mem_buf);
-    if (mem_buf->status_ != DynamicMemBufStatus::kMemBufIdle) {
-      DumpDynamicMemPoolDebugInfo();
-      MS_LOG(EXCEPTION) << "Find the mem_buf is not idle, alloc_size[" << size << "] mem_buf_size[" << mem_buf->size_
-                        << "] mem_buf_address[" << mem_buf->device_addr_ << "].";
+  auto take_from_bin = [&mem_mng](size_t bin_index) {
+    auto &bin = mem_mng->idle_mem_buf_bins_[bin_index];
+    auto mem_buf = bin.begin()->second;
+    (void)bin.erase(bin.begin());
+    if (bin.empty()) {
+      mem_mng->idle_mem_buf_bin_bitmap_[bin_index / DYNAMIC_MEM_BIN_BITMAP_BITS] &=
+        ~(static_cast<uint64_t>(1) << (bin_index % DYNAMIC_MEM_BIN_BITMAP_BITS));
     }
-    mem_buf->status_ = DynamicMemBufStatus::kMemBufUsed;
-    mem_buf->allocator_name_ = DynamicMemAllocatorDebugInfo::GetDebugInfo().name_;
-    mem_buf->allocator_type_ = DynamicMemAllocatorDebugInfo::GetDebugInfo().type_;
-    // Remove map of old idle memory buf
-    (void)mem_mng->idle_mem_buf_map_.erase(iter);
-    // Divide memory buf
-    if (IsSplit(size, mem_buf->size_)) {
-      SplitMemBuf(size, mem_buf, mem_mng);
+    return mem_buf;
+  };
+
+  if (size <= DYNAMIC_MEM_SMALL_BUF_MAX_SIZE) {
+    // All the bufs of the bins after the size class bin are big enough, but the bufs of the size class bin may be
+    // smaller than the size which is not aligned.
+    size_t bin_index = SizeClassBinIndex(size);
+    const auto &bin = mem_mng->idle_mem_buf_bins_[bin_index];
+    if (!bin.empty() && bin.begin()->second->size_ >= size) {
+      return take_from_bin(bin_index);
     }
-    // Memory statistics
-    mem_mng->mps_.total_used_mem_size_ += mem_buf->size_;
-    if (mem_mng->mps_.total_used_mem_size_ > mem_mng->mps_.used_mem_peak_size_) {
-      mem_mng->mps_.used_mem_peak_size_ = mem_mng->mps_.total_used_mem_size_;
+    // Find the first not empty bin after the size class bin by the bitmap.
+    size_t next_bin_index = bin_index + 1;
+    for (size_t word = next_bin_index / DYNAMIC_MEM_BIN_BITMAP_BITS; word < mem_mng->idle_mem_buf_bin_bitmap_.size();
+         ++word) {
+      uint64_t bits = mem_mng->idle_mem_buf_bin_bitmap_[word];
+      if (word == next_bin_index / DYNAMIC_MEM_BIN_BITMAP_BITS) {
+        bits &= ~static_cast<uint64_t>(0) << (next_bin_index % DYNAMIC_MEM_BIN_BITMAP_BITS);
+      }
+      if (bits != 0) {
+        return take_from_bin(word * DYNAMIC_MEM_BIN_BITMAP_BITS + LowestBitIndex(bits));
+      }
     }
-    return mem_buf->device_addr_;
   }
-  return nullptr;
+
+  const auto &iter = mem_mng->idle_mem_buf_map_.lower_bound(size);
+  if (iter == mem_mng->idle_mem_buf_map_.end()) {
+    return nullptr;
+  }
+  auto mem_buf = iter->second;
+  MS_EXCEPTION_IF_NULL(mem_buf);
+  (void)mem_mng->idle_mem_buf_map_.erase(iter);
+  return mem_buf;
+}
+
+void DynamicMemPoolBestFit::AddIdleMemBuf(const DynamicMemBufPtr &mem_buf, const MemStatusManagerPtr &mem_mng) {
+  MS_EXCEPTION_IF_NULL(mem_buf);
+  MS_EXCEPTION_IF_NULL(mem_mng);
+  if (mem_buf->size_ > DYNAMIC_MEM_SMALL_BUF_MAX_SIZE) {
+    (void)mem_mng->idle_mem_buf_map_.emplace(mem_buf->size_, mem_buf);
+    return;
+  }
+  size_t bin_index = SizeClassBinIndex(mem_buf->size_);
+  (void)mem_mng->idle_mem_buf_bins_[bin_index].emplace(mem_buf->device_addr_, mem_buf);
+  mem_mng->idle_mem_buf_bin_bitmap_[bin_index / DYNAMIC_MEM_BIN_BITMAP_BITS] |=
+    static_cast<uint64_t>(1) << (bin_index % DYNAMIC_MEM_BIN_BITMAP_BITS);
 }
 
 size_t DynamicMemPoolBestFit::MemAllocUnitSize(bool from_persistent_mem) const {
@@ -286,8 +369,8 @@ void DynamicMemPoolBestFit::SplitMemBuf(size_t size, const DynamicMemBufPtr &mem
   auto new_mem_buf = std::make_shared<DynamicMemBuf>(newbuf_addr, DynamicMemBufStatus::kMemBufIdle, newbuf_size);
   // Add map of new memory buf in the block
   (void)mem_block->block_all_mem_buf_map_.emplace(newbuf_addr, new_mem_buf);
-  // Add map of new idle memory buf
-  (void)mem_mng->idle_mem_buf_map_.emplace(newbuf_size, new_mem_buf);
+  // Add the new idle memory buf
+  AddIdleMemBuf(new_mem_buf, mem_mng);
 }
 
 bool DynamicMemPoolBestFit::CmpMemBlock(const DeviceMemPtr &device_addr, const DynamicMemBlockPtr &mem_block) {
@@ -310,6 +393,11 @@ DynamicMemBlockPtr DynamicMemPoolBestFit::FindMemBlock(const DeviceMemPtr &devic
 void DynamicMemPoolBestFit::FreeTensorMem(const DeviceMemPtr &device_addr) {
   MS_EXCEPTION_IF_NULL(device_addr);
   std::lock_guard<std::mutex> locker(mutex_);
+  FreeTensorMemInner(device_addr);
+}
+
+void DynamicMemPoolBestFit::FreeTensorMemInner(const DeviceMemPtr &device_addr) {
+  MS_EXCEPTION_IF_NULL(device_addr);
   auto fn = [this](const MemStatusManagerPtr &mem_mng, const DeviceMemPtr &device_addr) -> DynamicMemBlockPtr {
     auto mem_block = FindMemBlock(device_addr, mem_mng);
     if (mem_block != nullptr) {
@@ -334,6 +422,90 @@ void DynamicMemPoolBestFit::FreeTensorMem(const DeviceMemPtr &device_addr) {
   }
 }
 
+void DynamicMemPoolBestFit::FreeTensorMemOnStream(const DeviceMemPtr &device_addr, size_t stream_id) {
+  MS_EXCEPTION_IF_NULL(device_addr);
+  std::lock_guard<std::mutex> locker(mutex_);
+  deferred_free_mem_[stream_id].emplace_back(device_addr);
+}
+
+void DynamicMemPoolBestFit::ReleaseDeferredFreeMem(size_t stream_id) {
+  std::lock_guard<std::mutex> locker(mutex_);
+  const auto &iter = deferred_free_mem_.find(stream_id);
+  if (iter == deferred_free_mem_.end()) {
+    return;
+  }
+  for (const auto &device_addr : iter->second) {
+    FreeTensorMemInner(device_addr);
+  }
+  (void)deferred_free_mem_.erase(iter);
+}
+
+size_t DynamicMemPoolBestFit::DeferredFreeMemSize() {
+  std::lock_guard<std::mutex> locker(mutex_);
+  size_t deferred_size = 0;
+  for (const auto &stream_free_mem : deferred_free_mem_) {
+    for (const auto &device_addr : stream_free_mem.second) {
+      for (const auto &mem_mng : {common_mem_, persistent_mem_}) {
+        auto mem_block = FindMemBlock(device_addr, mem_mng);
+        if (mem_block == nullptr) {
+          continue;
+        }
+        const auto &iter = mem_block->block_all_mem_buf_map_.find(device_addr);
+        if (iter != mem_block->block_all_mem_buf_map_.end()) {
+          deferred_size += iter->second->size_;
+          break;
+        }
+      }
+    }
+  }
+  return deferred_size;
+}
+
+bool DynamicMemPoolBestFit::SyncAndReleaseDeferredFreeMem() {
+  bool released = false;
+  for (auto iter = deferred_free_mem_.begin(); iter != deferred_free_mem_.end();) {
+    if (!SyncStream(iter->first)) {
+      MS_LOG(WARNING) << "Sync stream " << iter->first << " failed, the memory freed on it can't be released.";
+      ++iter;
+      continue;
+    }
+    for (const auto &device_addr : iter->second) {
+      FreeTensorMemInner(device_addr);
+    }
+    released = released || !iter->second.empty();
+    iter = deferred_free_mem_.erase(iter);
+  }
+  return released;
+}
+
+size_t DynamicMemPoolBestFit::ReleaseFreeMemBlock(const MemStatusManagerPtr &mem_mng) {
+  MS_EXCEPTION_IF_NULL(mem_mng);
+  size_t released_size = 0;
+  for (auto iter = mem_mng->mem_block_list_.begin(); iter != mem_mng->mem_block_list_.end();) {
+    const auto &mem_block = *iter;
+    MS_EXCEPTION_IF_NULL(mem_block);
+    // The adjacent idle memory bufs are always combined, so the block without used memory buf has one idle buf.
+    const auto &mem_buf_map = mem_block->block_all_mem_buf_map_;
+    if (mem_buf_map.size() != 1 || mem_buf_map.begin()->second->status_ != DynamicMemBufStatus::kMemBufIdle) {
+      ++iter;
+      continue;
+    }
+    const auto &mem_buf = mem_buf_map.begin()->second;
+    EraseIdleMemBuf(mem_buf->size_, mem_buf->device_addr_, mem_mng);
+    if (!FreeDeviceMem(mem_block->device_addr_base_)) {
+      MS_LOG(EXCEPTION) << "Free device memory[" << mem_block->device_addr_base_ << "] error.";
+    }
+    mem_mng->mps_.total_mem_size_ -= mem_block->mem_block_size_;
+    released_size += mem_block->mem_block_size_;
+    iter = mem_mng->mem_block_list_.erase(iter);
+  }
+  if (released_size > 0) {
+    MS_LOG(INFO) << "Release the free memory blocks, size: " << released_size << ", remaining block counts: "
+                 << mem_mng->mem_block_list_.size();
+  }
+  return released_size;
+}
+
 void DynamicMemPoolBestFit::CombineMemBuf(const DynamicMemBlockPtr &mem_block, const DeviceMemPtr &device_addr,
                                           const MemStatusManagerPtr &mem_mng) {
   MS_EXCEPTION_IF_NULL(mem_block);
@@ -382,17 +554,31 @@ void DynamicMemPoolBestFit::CombineMemBuf(const DynamicMemBlockPtr &mem_block, c
       forward_combine = true;
     }
   }
-  // Add map of new idle memory
+  // Add the new idle memory
   if (forward_combine) {
-    (void)mem_mng->idle_mem_buf_map_.emplace(prev_mem_buf->size_, prev_mem_buf);
+    AddIdleMemBuf(prev_mem_buf, mem_mng);
   } else {
-    (void)mem_mng->idle_mem_buf_map_.emplace(mem_buf->size_, mem_buf);
+    AddIdleMemBuf(mem_buf, mem_mng);
   }
 }
 
 void DynamicMemPoolBestFit::EraseIdleMemBuf(size_t size, const DeviceMemPtr &device_addr,
                                             const MemStatusManagerPtr &mem_mng) {
   MS_EXCEPTION_IF_NULL(device_addr);
+  if (size <= DYNAMIC_MEM_SMALL_BUF_MAX_SIZE) {
+    size_t bin_index = SizeClassBinIndex(size);
+    auto &bin = mem_mng->idle_mem_buf_bins_[bin_index];
+    if (bin.erase(device_addr) > 0) {
+      if (bin.empty()) {
+        mem_mng->idle_mem_buf_bin_bitmap_[bin_index / DYNAMIC_MEM_BIN_BITMAP_BITS] &=
+          ~(static_cast<uint64_t>(1) << (bin_index % DYNAMIC_MEM_BIN_BITMAP_BITS));
+      }
+      return;
+    }
+    MS_LOG(ERROR) << "Can't find the size[" << size << "] and device address[" << device_addr
+                  << "] in the idle mem_buf.";
+    return;
+  }
   auto &&iter = mem_mng->idle_mem_buf_map_.equal_range(size);
   while (iter.first != iter.second) {
     MS_EXCEPTION_IF_NULL(iter.first->second);
@@ -420,11 +606,39 @@ void DynamicMemPoolBestFit::ReleaseDeviceRes() {
         device_addr = nullptr;
       }
     }
-    mem_mng->mem_block_list_.clear();
-    mem_mng->idle_mem_buf_map_.clear();
+    mem_mng->clear();
   };
   fn(common_mem_);
   fn(persistent_mem_);
+  deferred_free_mem_.clear();
+}
+
+FragmentationState DynamicMemPoolBestFit::FragmentationStatistics(bool from_persistent_mem) {
+  std::lock_guard<std::mutex> locker(mutex_);
+  return CalFragmentationState(from_persistent_mem ? persistent_mem_ : common_mem_);
+}
+
+FragmentationState DynamicMemPoolBestFit::CalFragmentationState(const MemStatusManagerPtr &mem_mng) const {
+  MS_EXCEPTION_IF_NULL(mem_mng);
+  FragmentationState state;
+  mem_mng->VisitIdleMemBuf([&state](const DynamicMemBufPtr &mem_buf) {
+    MS_EXCEPTION_IF_NULL(mem_buf);
+    state.total_idle_size_ += mem_buf->size_;
+    state.max_idle_buf_size_ = std::max(state.max_idle_buf_size_, mem_buf->size_);
+    ++state.idle_buf_count_;
+  });
+  for (const auto &mem_block : mem_mng->mem_block_list_) {
+    MS_EXCEPTION_IF_NULL(mem_block);
+    const auto &mem_buf_map = mem_block->block_all_mem_buf_map_;
+    if (mem_buf_map.size() == 1 && mem_buf_map.begin()->second->status_ == DynamicMemBufStatus::kMemBufIdle) {
+      state.free_block_size_ += mem_block->mem_block_size_;
+    }
+  }
+  if (state.total_idle_size_ > 0) {
+    state.fragmentation_ =
+      1.0f - static_cast<float>(state.max_idle_buf_size_) / static_cast<float>(state.total_idle_size_);
+  }
+  return state;
 }
 
 void DynamicMemPoolBestFit::DumpDynamicMemPoolStateInfo() {
@@ -451,11 +665,16 @@ void DynamicMemPoolBestFit::DumpDynamicMemPoolStateInfo() {
     }
 
     // Dump all the memory buf info
+    auto fragmentation_state = CalFragmentationState(mem_mng);
     MS_LOG(INFO) << mem_type << " pool info: Total allocated mem:" << mem_mng->mps_.total_mem_size_ / kMBToByte
                  << "M, peak used mem:" << mem_mng->mps_.used_mem_peak_size_ / kMBToByte
                  << "M, in used mem:" << mem_mng->mps_.total_used_mem_size_ / kMBToByte << "M, total idle mem:"
                  << (mem_mng->mps_.total_mem_size_ - mem_mng->mps_.total_used_mem_size_) / kMBToByte
-                 << "M. Block unit size:" << mem_mng->unit_size_ / kMBToByte
+                 << "M. Idle mem_buf counts:" << fragmentation_state.idle_buf_count_
+                 << ", max idle mem_buf size:" << fragmentation_state.max_idle_buf_size_ / kMBToByte
+                 << "M, free block size:" << fragmentation_state.free_block_size_ / kMBToByte
+                 << "M, fragmentation:" << fragmentation_state.fragmentation_
+                 << ". Block unit size:" << mem_mng->unit_size_ / kMBToByte
                  << "M, block counts:" << mem_mng->mem_block_list_.size() << buf.str();
   };
 
@@ -502,15 +721,15 @@ void DynamicMemPoolBestFit::DumpDynamicMemPoolDebugInfo() {
       }
     }
     // Dump all the idle memory buf info.
-    MS_LOG(INFO) << mem_type << " all idle mem_buf info: counts[" << mem_mng->idle_mem_buf_map_.size() << "].";
-    for (auto iter_idle = mem_mng->idle_mem_buf_map_.begin(); iter_idle != mem_mng->idle_mem_buf_map_.end();
-         ++iter_idle) {
-      auto mem_buf = iter_idle->second;
+    size_t idle_mem_buf_count = 0;
+    mem_mng->VisitIdleMemBuf([&idle_mem_buf_count](const DynamicMemBufPtr &) { ++idle_mem_buf_count; });
+    MS_LOG(INFO) << mem_type << " all idle mem_buf info: counts[" << idle_mem_buf_count << "].";
+    mem_mng->VisitIdleMemBuf([&total_idle_mem2](const DynamicMemBufPtr &mem_buf) {
       MS_EXCEPTION_IF_NULL(mem_buf);
       total_idle_mem2 += mem_buf->size_;
       MS_LOG(INFO) << " Idle mem_buf info: size[" << mem_buf->size_ << "] address[" << mem_buf->device_addr_
                    << "] status[" << kBufStatusString.at(mem_buf->status_) << "].";
-    }
+    });
     // Dump the memory statistical info.
     MS_LOG(INFO) << mem_type << " total allocated memory[" << total_mem << "], used memory[" << total_used_mem
                  << "], idle memory[" << total_idle_mem1 << "].";
@@ -25,6 +25,7 @@
 #include <thread>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include "utils/ms_utils.h"
 
 namespace mindspore {
@@ -44,6 +45,11 @@ static const size_t DYNAMIC_MEM_ALIGN_SIZE = 512;
 // The minimum unit size (1G) of memory block used for dynamic extend.
 static const size_t DYNAMIC_MEM_ALLOC_UNIT_SIZE = 1024 << 20;
 
+// The idle memory bufs not bigger than 1M are kept in the size class bins, one bin for every aligned size.
+static const size_t DYNAMIC_MEM_SMALL_BUF_MAX_SIZE = 1024 << 10;
+static const size_t DYNAMIC_MEM_BIN_NUM = DYNAMIC_MEM_SMALL_BUF_MAX_SIZE / DYNAMIC_MEM_ALIGN_SIZE;
+static const size_t DYNAMIC_MEM_BIN_BITMAP_BITS = 64;
+
 // The Comparator of device address from small to large.
 struct DeviceAddrCmp {
   bool operator()(const DeviceMemPtr &addr1, const DeviceMemPtr &addr2) const { return addr1 < addr2; }
@@ -130,16 +136,53 @@ struct DeviceState {
   size_t used_mem_peak_size_{0};
 };
 
+// The fragmentation statistics of the idle memory.
+struct FragmentationState {
+  // The sum of all idle memory bufs.
+  size_t total_idle_size_{0};
+  // The biggest memory which can be allocated without adding a memory block.
+  size_t max_idle_buf_size_{0};
+  size_t idle_buf_count_{0};
+  // The memory of the blocks which have no used memory buf.
+  size_t free_block_size_{0};
+  // 1 - max_idle_buf_size / total_idle_size, 0 means all the idle memory is in one memory buf.
+  float fragmentation_{0.0f};
+};
+
 struct MemStatusManager {
   size_t unit_size_{DYNAMIC_MEM_ALLOC_UNIT_SIZE};
   // Mem pool state
   DeviceState mps_;
   std::vector<DynamicMemBlockPtr> mem_block_list_;
-  // The map of all idle memory buf by size.
+  // The map of the idle memory bufs bigger than DYNAMIC_MEM_SMALL_BUF_MAX_SIZE by size.
   SizeMapMemBuf idle_mem_buf_map_;
+  // The size class bins of the small idle memory bufs, the bin i keeps the bufs whose size is in the range
+  // (i * DYNAMIC_MEM_ALIGN_SIZE, (i + 1) * DYNAMIC_MEM_ALIGN_SIZE] by device address, so the lower address is reused
+  // first. The bit i of the bitmap is set when the bin i is not empty.
+  std::vector<DeviceAddrMapMemBuf> idle_mem_buf_bins_{DYNAMIC_MEM_BIN_NUM};
+  std::vector<uint64_t> idle_mem_buf_bin_bitmap_ =
+    std::vector<uint64_t>(DYNAMIC_MEM_BIN_NUM / DYNAMIC_MEM_BIN_BITMAP_BITS, 0);
+
+  // Visit all the idle memory bufs, in the bins and in the size map.
+  template <typename Visitor>
+  void VisitIdleMemBuf(const Visitor &visitor) const {
+    for (const auto &bin : idle_mem_buf_bins_) {
+      for (const auto &iter : bin) {
+        visitor(iter.second);
+      }
+    }
+    for (const auto &iter : idle_mem_buf_map_) {
+      visitor(iter.second);
+    }
+  }
+
   void clear() noexcept {
     mem_block_list_.clear();
     idle_mem_buf_map_.clear();
+    for (auto &bin : idle_mem_buf_bins_) {
+      bin.clear();
+    }
+    std::fill(idle_mem_buf_bin_bitmap_.begin(), idle_mem_buf_bin_bitmap_.end(), 0);
   }
 };
 using MemStatusManagerPtr = std::shared_ptr<MemStatusManager>;
@@ -157,6 +200,13 @@ class DynamicMemPoolBestFit {
   std::vector<DeviceMemPtr> AllocContinuousTensorMem(size_t total_size, const std::vector<size_t> &size_list);
   // The main program entry of memory free.
   void FreeTensorMem(const DeviceMemPtr &device_addr);
+  // Free the memory which may be still used by the launched tasks of the stream. The memory buf is kept in use until
+  // the stream is synchronized and ReleaseDeferredFreeMem is called, the frees of a stream are released in order.
+  void FreeTensorMemOnStream(const DeviceMemPtr &device_addr, size_t stream_id);
+  // Release the memory freed on the stream, which must be called after the stream is synchronized.
+  void ReleaseDeferredFreeMem(size_t stream_id);
+  // The size of memory freed on the streams and not released yet.
+  size_t DeferredFreeMemSize();
 
   // Release the real device memory.
   void ReleaseDeviceRes();
@@ -178,6 +228,8 @@ class DynamicMemPoolBestFit {
   size_t UsedMemPeakStatistics() const {
     return common_mem_->mps_.used_mem_peak_size_ + persistent_mem_->mps_.used_mem_peak_size_;
   }
+  // The fragmentation statistics of the idle memory.
+  FragmentationState FragmentationStatistics(bool from_persistent_mem = false);
 
   // Display the brief state information of memory block and memory buf.
   void DumpDynamicMemPoolStateInfo();
@@ -188,6 +240,9 @@ class DynamicMemPoolBestFit {
   virtual size_t AllocDeviceMem(size_t size, DeviceMemPtr *addr) = 0;
   virtual bool FreeDeviceMem(const DeviceMemPtr &addr) = 0;
   virtual size_t free_mem_size() = 0;
+  // Wait for the tasks of stream completed, which is called to release the deferred free memory when the memory is not
+  // enough, needs override by the device which launches the tasks asynchronously.
+  virtual bool SyncStream(size_t stream_id) { return true; }
 
  protected:
   const MemStatusManagerPtr &common_mem() const { return common_mem_; }
@@ -196,6 +251,9 @@ class DynamicMemPoolBestFit {
   virtual size_t AlignMemorySize(size_t size) const;
   // Calculate memory block required alloc size when adding the memory block.
   virtual size_t CalMemBlockAllocSize(size_t size, bool from_persistent_mem);
+  // Whether the memory blocks can be freed to the device one by one when the memory is not enough, so that the idle
+  // memory of the blocks can be allocated in a new memory block.
+  virtual bool IsMemBlockReleasable() const { return false; }
 
  private:
   // Find the idle memory buf by aligned size when memory alloc.
@@ -215,11 +273,25 @@ class DynamicMemPoolBestFit {
                      const MemStatusManagerPtr &mem_mng);
   // Erase the idle memory buf by size and device address when idle memory buf is combined.
   void EraseIdleMemBuf(size_t size, const DeviceMemPtr &device_addr, const MemStatusManagerPtr &mem_mng);
+  // Add the idle memory buf to the size class bin or the size map by its size.
+  void AddIdleMemBuf(const DynamicMemBufPtr &mem_buf, const MemStatusManagerPtr &mem_mng);
+  // Take the smallest idle memory buf which is not smaller than size, return nullptr if there is not.
+  DynamicMemBufPtr TakeIdleMemBuf(size_t size, const MemStatusManagerPtr &mem_mng);
+  // Free the memory buf without lock.
+  void FreeTensorMemInner(const DeviceMemPtr &device_addr);
+  // Release the memory of the blocks which have no used memory buf, return the released size.
+  size_t ReleaseFreeMemBlock(const MemStatusManagerPtr &mem_mng);
+  // Sync the streams and release their deferred free memory, return whether any memory is released.
+  bool SyncAndReleaseDeferredFreeMem();
+  // Calculate the fragmentation statistics of the idle memory.
+  FragmentationState CalFragmentationState(const MemStatusManagerPtr &mem_mng) const;
 
   // Support multi-thread.
   std::mutex mutex_;
   MemStatusManagerPtr persistent_mem_{nullptr};
   MemStatusManagerPtr common_mem_{nullptr};
+  // The memory freed on the streams which is not released yet, in the free order of every stream.
+  std::unordered_map<size_t, std::vector<DeviceMemPtr>> deferred_free_mem_;
   // In the graph mode, the unit size set in the context will be modified through the FetchMemUnitSize function, so it
   // needs to be changed back after that
   size_t config_unit_size_{DYNAMIC_MEM_ALLOC_UNIT_SIZE};
@@ -76,9 +76,13 @@ class PersistentData : public Data<T> {
   // and config can be like this: std::map<std::string, std::string> config = {{kFileStoragePath, "real_path_of_dir"}};
   void Initialize(const std::map<std::string, std::string> &storage_config);
 
-  // In disaster recovery mode, memory of tensor need to be saved into disk file periodically.
+  // In disaster recovery mode, memory of tensor need to be saved into disk file periodically. Only the snapshot of the
+  // dirty part is taken when Persist returns, and it is written to the storage in the background.
   void Persist(const storage::DirtyInfo &dirty_info) const;
 
+  // Wait until the persisted data is written to the storage.
+  void Flush() const;
+
   // In disaster recovery mode, server node or worker node need to restore persistent data when restart.
   void Restore() const;
 
@@ -103,6 +107,12 @@ void PersistentData<T>::Persist(const storage::DirtyInfo &dirty_info) const {
   storage_->Write(input, dirty_info);
 }
 
+template <typename T>
+void PersistentData<T>::Flush() const {
+  MS_EXCEPTION_IF_NULL(storage_);
+  storage_->Flush();
+}
+
 template <typename T>
 void PersistentData<T>::Restore() const {
   storage::OutputData output = std::make_pair(Data<T>::data(), Data<T>::size() * sizeof(T));
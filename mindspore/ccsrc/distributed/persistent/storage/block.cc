@@ -37,6 +37,23 @@ bool Block::CheckSha256Seq() const {
   }
   return true;
 }
+
+void Block::GenChecksum(const std::vector<std::pair<const void *, size_t>> &data) const {
+  MS_EXCEPTION_IF_NULL(block_meta_);
+  block_meta_->Update(kChecksum, CalcChecksum(data));
+}
+
+bool Block::CheckChecksum(const std::vector<std::pair<void *, size_t>> &data) const {
+  MS_EXCEPTION_IF_NULL(block_meta_);
+  if (!block_meta_->Exists(kChecksum)) {
+    return CheckSha256Seq();
+  }
+  if (block_meta_->Get<uint32_t>(kChecksum) != CalcChecksum(data)) {
+    MS_LOG(ERROR) << "The block file has been modified, file name: " << block_file_name_;
+    return false;
+  }
+  return true;
+}
 }  // namespace storage
 }  // namespace distributed
 }  // namespace mindspore
@@ -19,10 +19,13 @@
 
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "distributed/persistent/storage/json_utils.h"
 #include "nlohmann/json.hpp"
 #include "distributed/persistent/storage/constants.h"
+#include "utils/system/crc32c.h"
 
 namespace mindspore {
 namespace distributed {
@@ -45,6 +48,19 @@ class Block {
   // Check sha256 hash sequence.
   bool CheckSha256Seq() const;
 
+  // The following two methods check the block content in memory, which avoids reading the block file again.
+  // Generate crc32c checksum of the content written to the block file, the checksum is persisted by committing the
+  // block meta.
+  void GenChecksum(const std::vector<std::pair<const void *, size_t>> &data) const;
+
+  // Check crc32c checksum of the content read from the block file, the block file without checksum is checked by
+  // sha256 hash sequence.
+  bool CheckChecksum(const std::vector<std::pair<void *, size_t>> &data) const;
+
+  // Calculate crc32c checksum of the content.
+  template <typename T>
+  static uint32_t CalcChecksum(const std::vector<std::pair<T *, size_t>> &data);
+
   // Set the block meta pointer associated with the block file.
   void set_block_meta(const std::shared_ptr<BlockMeta> &block_meta) { block_meta_ = block_meta; }
 
@@ -57,6 +73,15 @@ class Block {
   // The block file path.
   std::string block_file_name_;
 };
+
+template <typename T>
+uint32_t Block::CalcChecksum(const std::vector<std::pair<T *, size_t>> &data) {
+  uint32_t crc = 0;
+  for (const auto &item : data) {
+    crc = system::Crc32c::MakeCrc32c(crc, reinterpret_cast<const char *>(item.first), item.second);
+  }
+  return crc;
+}
 }  // namespace storage
 }  // namespace distributed
 }  // namespace mindspore
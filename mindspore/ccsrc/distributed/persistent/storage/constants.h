@@ -27,15 +27,20 @@ constexpr char kShardShape[] = "shard_shape";
 constexpr char kShardRangeLowerBound[] = "shard_range_lower_bound";
 constexpr char kShardRangeUpperBound[] = "shard_range_upper_bound";
 constexpr char kHashSeq[] = "hash_seq";
+constexpr char kChecksum[] = "checksum";
 
 constexpr char kBlockFilePrefix[] = "block_";
 constexpr char kBlockMetaFilePrefix[] = "block_meta_";
 constexpr char kJsonSuffix[] = ".json";
 constexpr size_t JSON_SUFFIX_LENS = 5;
+// The new content of a block file is written to the temporary file first, and then replaces the block file.
+constexpr char kTempFileSuffix[] = ".tmp";
+constexpr size_t TEMP_FILE_SUFFIX_LENS = 4;
 
 // Storage config related.
 constexpr char kFileStoragePath[] = "file_storage_path";
 constexpr char kMaxBlockLength[] = "max_block_length";
+constexpr char kWriterThreadNum[] = "writer_thread_num";
 }  // namespace storage
 }  // namespace distributed
 }  // namespace mindspore
@@ -17,7 +17,9 @@
 #include "distributed/persistent/storage/file_io_utils.h"
 
 #include <dirent.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <cstdio>
 #include <fstream>
 
 #include "include/common/utils/utils.h"
@@ -118,6 +120,37 @@ bool FileIOUtils::Read(const std::string &file_name, const std::vector<std::pair
   return true;
 }
 
+bool FileIOUtils::Sync(const std::string &path) {
+#if defined(_WIN32) || defined(_WIN64)
+  return IsFileOrDirExist(path);
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    MS_LOG(ERROR) << "Open file failed, file name: " << path << ", errno: " << errno;
+    return false;
+  }
+  if (fsync(fd) != 0) {
+    MS_LOG(ERROR) << "Sync file failed, file name: " << path << ", errno: " << errno;
+    (void)close(fd);
+    return false;
+  }
+  (void)close(fd);
+  return true;
+#endif
+}
+
+bool FileIOUtils::Rename(const std::string &old_file_name, const std::string &new_file_name) {
+#if defined(_WIN32) || defined(_WIN64)
+  // The rename doesn't replace the existing file on windows.
+  (void)std::remove(new_file_name.c_str());
+#endif
+  if (std::rename(old_file_name.c_str(), new_file_name.c_str()) != 0) {
+    MS_LOG(ERROR) << "Rename file " << old_file_name << " to " << new_file_name << " failed, errno: " << errno;
+    return false;
+  }
+  return true;
+}
+
 bool FileIOUtils::IsFileOrDirExist(const std::string &path) {
   if (path.empty()) {
     MS_LOG(EXCEPTION) << "The path name is empty";
@@ -34,6 +34,12 @@ class FileIOUtils {
   // Read file and load the context into memory buffer, return false if the file is not exist.
   static bool Read(const std::string &file_name, const std::vector<std::pair<void *, size_t>> &outputs);
 
+  // Flush the content of the file or the entries of the directory to the storage medium.
+  static bool Sync(const std::string &path);
+
+  // Rename the file and replace the existing file with the new name.
+  static bool Rename(const std::string &old_file_name, const std::string &new_file_name);
+
   // Judeg whether a file exists.
   static bool IsFileOrDirExist(const std::string &file);
 
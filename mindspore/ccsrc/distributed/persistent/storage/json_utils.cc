@@ -16,6 +16,7 @@
 
 #include "distributed/persistent/storage/json_utils.h"
 #include "distributed/persistent/storage/file_io_utils.h"
+#include "distributed/persistent/storage/constants.h"
 #include "include/common/utils/utils.h"
 
 namespace mindspore {
@@ -40,6 +41,16 @@ bool JsonUtils::Initialize() {
   return true;
 }
 
+bool JsonUtils::Commit() const {
+  std::string temp_file_name = file_name_ + kTempFileSuffix;
+  std::string content = js_.dump();
+  if (!FileIOUtils::Write(temp_file_name, {{content.data(), content.size()}}) || !FileIOUtils::Sync(temp_file_name)) {
+    MS_LOG(ERROR) << "Write json file failed, file name: " << temp_file_name;
+    return false;
+  }
+  return FileIOUtils::Rename(temp_file_name, file_name_);
+}
+
 bool JsonUtils::Exists(const std::string &key) const {
   if (!js_.contains(key)) {
     return false;
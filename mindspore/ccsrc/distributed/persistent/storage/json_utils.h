@@ -44,6 +44,14 @@ class JsonUtils {
   template <typename T>
   void Insert(const std::string &key, const T &value);
 
+  // Change the value corresponding to the key in memory only, the json file is rewritten by Commit.
+  template <typename T>
+  void Update(const std::string &key, const T &value);
+
+  // Write json to a temporary file and sync it, then replace the json file by renaming, so the json file keeps either
+  // the old content or the new content completely if the process crashes.
+  bool Commit() const;
+
   // Check whether key exists in json or not.
   bool Exists(const std::string &key) const;
 
@@ -71,6 +79,11 @@ void JsonUtils::Insert(const std::string &key, const T &value) {
   output_file << js_.dump();
   output_file.close();
 }
+
+template <typename T>
+void JsonUtils::Update(const std::string &key, const T &value) {
+  js_[key] = value;
+}
 }  // namespace storage
 }  // namespace distributed
 }  // namespace mindspore
@@ -17,9 +17,15 @@
 #include "distributed/persistent/storage/local_file.h"
 
 #include <dirent.h>
+#include <sys/stat.h>
+#include <atomic>
 #include <cmath>
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
 #include <numeric>
+#include <thread>
 #include <tuple>
 #include <utility>
 
@@ -32,6 +38,45 @@
 namespace mindspore {
 namespace distributed {
 namespace storage {
+namespace {
+// Run the tasks by the threads, return false if any task fails.
+bool ParallelRun(size_t task_num, size_t thread_num, const std::function<bool(size_t)> &task) {
+  std::atomic<size_t> next_task(0);
+  std::atomic<bool> success(true);
+  auto run_tasks = [&]() {
+    for (size_t i = next_task++; i < task_num; i = next_task++) {
+      try {
+        if (!task(i)) {
+          success = false;
+        }
+      } catch (const std::exception &e) {
+        MS_LOG(ERROR) << "Run task " << i << " failed, the exception: " << e.what();
+        success = false;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < std::min(thread_num, task_num); ++i) {
+    (void)threads.emplace_back(run_tasks);
+  }
+  run_tasks();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return success;
+}
+}  // namespace
+
+LocalFile::~LocalFile() {
+  if (write_thread_.joinable()) {
+    write_thread_.join();
+  }
+  if (!write_success_) {
+    MS_LOG(ERROR) << "Write block files in the background failed, file path: " << file_path_;
+  }
+}
+
 void LocalFile::Write(const InputData &input, const DirtyInfo &dirty_info) {
   std::vector<InputData> inputs = {input};
   Write(inputs, dirty_info);
@@ -42,14 +87,14 @@ void LocalFile::Write(const std::vector<InputData> &inputs, const DirtyInfo &dir
     MS_LOG(EXCEPTION) << "The inputs is empty";
   }
 
+  // The snapshots of last write may be still in flight, wait for them before the block files are rewritten.
+  Flush();
+
   // The block file has been created, only the blocks related to the dirty information need to be rewritten.
   if (finish_create_block_files_) {
-    std::vector<int> block_indices;
+    std::vector<size_t> block_indices;
     TransformDirtyInfoToBlockIndices(dirty_info, &block_indices);
-
-    for (const auto &block_index : block_indices) {
-      WriteOneBlockFile(IntToSize(block_index), inputs);
-    }
+    WriteBlockSnapshots(block_indices, inputs);
     return;
   }
 
@@ -57,39 +102,36 @@ void LocalFile::Write(const std::vector<InputData> &inputs, const DirtyInfo &dir
   WriteBlockFiles(inputs);
 }
 
-void LocalFile::TransformDirtyInfoToBlockIndices(const DirtyInfo &dirty_info, std::vector<int> *block_indices) const {
+void LocalFile::Flush() {
+  if (write_thread_.joinable()) {
+    write_thread_.join();
+  }
+  if (!write_success_) {
+    write_success_ = true;
+    MS_LOG(EXCEPTION) << "Write block files in the background failed, file path: " << file_path_;
+  }
+}
+
+void LocalFile::TransformDirtyInfoToBlockIndices(const DirtyInfo &dirty_info,
+                                                 std::vector<size_t> *block_indices) const {
   MS_EXCEPTION_IF_NULL(block_indices);
-  if (block_meta_list_.empty()) {
+  if (block_upper_bounds_.empty()) {
     MS_LOG(EXCEPTION) << "The block meta list is empty";
   }
 
-  size_t block_index = 0;
-  bool block_index_alread_insert_vec = false;
-  auto block_meta_ptr = block_meta_list_.at(block_index);
-  MS_EXCEPTION_IF_NULL(block_meta_ptr);
-  int cur_lower_bound = block_meta_ptr->Get<int>(kShardRangeLowerBound);
-  int cur_upper_bound = block_meta_ptr->Get<int>(kShardRangeUpperBound);
-
+  // The dirty info is not required to be sorted or unique, and the block of each dirty value is found by the upper
+  // bounds of the shard ranges.
+  std::vector<bool> is_dirty_block(block_upper_bounds_.size(), false);
   for (const auto &dirty_value : dirty_info) {
-    if (dirty_value >= cur_lower_bound && dirty_value < cur_upper_bound) {
-      if (!block_index_alread_insert_vec) {
-        block_index_alread_insert_vec = true;
-        block_indices->push_back(block_index);
-      }
+    auto iter = std::upper_bound(block_upper_bounds_.begin(), block_upper_bounds_.end(), dirty_value);
+    if (dirty_value < 0 || iter == block_upper_bounds_.end()) {
       continue;
     }
+    is_dirty_block[LongToSize(iter - block_upper_bounds_.begin())] = true;
+  }
 
-    while (!(dirty_value >= cur_lower_bound && dirty_value < cur_upper_bound)) {
-      if (++block_index >= block_meta_list_.size()) {
-        break;
-      }
-      block_meta_ptr = block_meta_list_[block_index];
-      MS_EXCEPTION_IF_NULL(block_meta_ptr);
-      cur_lower_bound = block_meta_ptr->Get<int>(kShardRangeLowerBound);
-      cur_upper_bound = block_meta_ptr->Get<int>(kShardRangeUpperBound);
-    }
-
-    if (block_index < block_meta_list_.size()) {
+  for (size_t block_index = 0; block_index < is_dirty_block.size(); ++block_index) {
+    if (is_dirty_block[block_index]) {
       block_indices->push_back(block_index);
     }
   }
@@ -143,6 +185,7 @@ void LocalFile::WriteBlockFiles(const std::vector<InputData> &inputs) {
     block_meta_ptr->Insert(kOffset, offset);
     offset += field_length;
     block_meta_list_.push_back(block_meta_ptr);
+    block_upper_bounds_.push_back(SizeToInt(cur_upper_bound));
 
     // Create block.
     auto block_ptr = std::make_shared<Block>(file_path_ + "/" + kBlockFilePrefix + std::to_string(block_index));
@@ -152,13 +195,22 @@ void LocalFile::WriteBlockFiles(const std::vector<InputData> &inputs) {
 
   finish_create_block_files_ = true;
 
-  // Write inputs_data to block files and Gen Sha256 seq.
-  for (size_t block_index = 0; block_index < block_num; ++block_index) {
-    WriteOneBlockFile(block_index, inputs);
+  // Write inputs_data to block files and generate checksum, then sync all block files in a batch and commit the block
+  // metas after the block data is durable.
+  bool success = ParallelRun(block_num, writer_thread_num_, [this, &inputs](size_t block_index) {
+    return WriteOneBlockFile(block_index, GetBlockData(block_index, inputs));
+  });
+  success = success && ParallelRun(block_num, writer_thread_num_, [this](size_t block_index) {
+              return FileIOUtils::Sync(block_list_[block_index]->block_file_name()) &&
+                     block_meta_list_[block_index]->Commit();
+            });
+  if (!success || !FileIOUtils::Sync(file_path_)) {
+    MS_LOG(EXCEPTION) << "Write block files failed, file path: " << file_path_;
   }
 }
 
-void LocalFile::WriteOneBlockFile(size_t block_index, const std::vector<InputData> &inputs) const {
+std::vector<std::pair<const void *, size_t>> LocalFile::GetBlockData(size_t block_index,
+                                                                     const std::vector<InputData> &inputs) const {
   const auto &block_meta_ptr = block_meta_list_.at(block_index);
   MS_EXCEPTION_IF_NULL(block_meta_ptr);
   size_t field_size = block_meta_ptr->Get<size_t>(kFieldsLength);
@@ -170,18 +222,82 @@ void LocalFile::WriteOneBlockFile(size_t block_index, const std::vector<InputDat
     size_t data_size = field_size;
     (void)block_inputs_data.emplace_back(data_ptr, data_size);
   }
+  return block_inputs_data;
+}
+
+void LocalFile::WriteBlockSnapshots(const std::vector<size_t> &block_indices, const std::vector<InputData> &inputs) {
+  if (block_indices.empty()) {
+    return;
+  }
+
+  // Only the copy of the dirty blocks blocks the caller, and the block files are written in the background.
+  auto snapshots = std::make_shared<std::vector<std::pair<size_t, std::vector<char>>>>(block_indices.size());
+  bool success = ParallelRun(block_indices.size(), writer_thread_num_, [&](size_t i) {
+    size_t block_index = block_indices[i];
+    auto block_data = GetBlockData(block_index, inputs);
+    size_t block_size = std::accumulate(block_data.begin(), block_data.end(), size_t(0),
+                                        [](size_t size, const auto &data) { return size + data.second; });
+    auto &snapshot = (*snapshots)[i];
+    snapshot.first = block_index;
+    snapshot.second.resize(block_size);
+    char *dst = snapshot.second.data();
+    for (const auto &data : block_data) {
+      (void)memcpy(dst, data.first, data.second);
+      dst += data.second;
+    }
+    return true;
+  });
+  if (!success) {
+    MS_LOG(EXCEPTION) << "Copy the snapshots of the dirty blocks failed, file path: " << file_path_;
+  }
+
+  write_thread_ = std::thread([this, snapshots]() { write_success_ = WriteSnapshotsToBlockFiles(*snapshots); });
+}
+
+bool LocalFile::WriteSnapshotsToBlockFiles(const std::vector<std::pair<size_t, std::vector<char>>> &snapshots) const {
+  auto temp_file_name = [this, &snapshots](size_t i) {
+    return block_list_.at(snapshots[i].first)->block_file_name() + kTempFileSuffix;
+  };
+  bool success = ParallelRun(snapshots.size(), writer_thread_num_, [&snapshots, &temp_file_name](size_t i) {
+    const auto &snapshot = snapshots[i].second;
+    return FileIOUtils::Write(temp_file_name(i), {{snapshot.data(), snapshot.size()}});
+  });
+  success = success && ParallelRun(snapshots.size(), writer_thread_num_,
+                                   [&temp_file_name](size_t i) { return FileIOUtils::Sync(temp_file_name(i)); });
+  // The block meta with the new checksum is committed before the block file is replaced. If the process crashes
+  // between them, the synced temporary file matches the committed checksum and replaces the block file on loading.
+  success = success && ParallelRun(snapshots.size(), writer_thread_num_, [&](size_t i) {
+              const auto &block_ptr = block_list_.at(snapshots[i].first);
+              const auto &block_meta_ptr = block_meta_list_.at(snapshots[i].first);
+              MS_EXCEPTION_IF_NULL(block_ptr);
+              MS_EXCEPTION_IF_NULL(block_meta_ptr);
+              const auto &snapshot = snapshots[i].second;
+              block_ptr->GenChecksum({{snapshot.data(), snapshot.size()}});
+              if (!block_meta_ptr->Commit() || !FileIOUtils::Rename(temp_file_name(i), block_ptr->block_file_name())) {
+                return false;
+              }
+              ChangeFileMode(block_ptr->block_file_name(), S_IRWXU | S_IRWXG | S_IRWXO);
+              return true;
+            });
+  // Persist the renaming of the block files.
+  return success && FileIOUtils::Sync(file_path_);
+}
 
+bool LocalFile::WriteOneBlockFile(size_t block_index,
+                                  const std::vector<std::pair<const void *, size_t>> &block_data) const {
   const auto &block_ptr = block_list_.at(block_index);
   MS_EXCEPTION_IF_NULL(block_ptr);
   // Rewrite the current block file.
-  if (!FileIOUtils::Write(block_ptr->block_file_name(), block_inputs_data)) {
-    MS_LOG(EXCEPTION) << "Write to block file[" << block_ptr->block_file_name() << "] failed.";
+  if (!FileIOUtils::Write(block_ptr->block_file_name(), block_data)) {
+    MS_LOG(ERROR) << "Write to block file[" << block_ptr->block_file_name() << "] failed.";
+    return false;
   }
 
   ChangeFileMode(block_ptr->block_file_name(), S_IRWXU | S_IRWXG | S_IRWXO);
 
-  // Generate sha256 hash sequence.
-  block_ptr->GenSha256Seq();
+  // Generate checksum of the block content.
+  block_ptr->GenChecksum(block_data);
+  return true;
 }
 
 void LocalFile::Read(const OutputData &output) {
@@ -190,6 +306,9 @@ void LocalFile::Read(const OutputData &output) {
 }
 
 void LocalFile::Read(const std::vector<OutputData> &outputs) {
+  // Make sure the block files are up to date.
+  Flush();
+
   if (block_list_.empty() || block_meta_list_.empty()) {
     // Load file list info of block files and block meta files in the current folder to block list and block meta list.
     if (!LoadBlocksInfo()) {
@@ -197,8 +316,8 @@ void LocalFile::Read(const std::vector<OutputData> &outputs) {
     }
   }
 
-  // Read all block files.
-  for (size_t block_index = 0; block_index < block_list_.size(); ++block_index) {
+  // Read all block files in parallel.
+  bool success = ParallelRun(block_list_.size(), writer_thread_num_, [this, &outputs](size_t block_index) {
     std::vector<std::pair<void *, size_t>> block_output_data;
     const auto &block_meta_ptr = block_meta_list_[block_index];
     MS_EXCEPTION_IF_NULL(block_meta_ptr);
@@ -213,13 +332,19 @@ void LocalFile::Read(const std::vector<OutputData> &outputs) {
 
     const auto &block_ptr = block_list_[block_index];
     MS_EXCEPTION_IF_NULL(block_ptr);
-    if (!block_ptr->CheckSha256Seq()) {
-      MS_LOG(EXCEPTION) << "CheckSha256 failed, file name [" << block_ptr->block_file_name() << "]";
+    if (!FileIOUtils::Read(block_ptr->block_file_name(), block_output_data)) {
+      MS_LOG(ERROR) << "Read block file failed, file name [" << block_ptr->block_file_name() << "]";
+      return false;
     }
 
-    if (!FileIOUtils::Read(block_ptr->block_file_name(), block_output_data)) {
-      MS_LOG(EXCEPTION) << "Read block file failed, file name [" << block_ptr->block_file_name() << "]";
+    if (!block_ptr->CheckChecksum(block_output_data)) {
+      MS_LOG(ERROR) << "CheckChecksum failed, file name [" << block_ptr->block_file_name() << "]";
+      return false;
     }
+    return true;
+  });
+  if (!success) {
+    MS_LOG(EXCEPTION) << "Read block files failed, file path: " << file_path_;
   }
 }
 
@@ -231,6 +356,7 @@ bool LocalFile::LoadBlocksInfo() {
   }
   std::vector<std::string> block_file_name_list;
   std::vector<std::string> block_meta_file_name_list;
+  std::vector<std::string> temp_block_file_name_list;
   struct dirent *entry;
 
   // Get file names of all block file and block meta file in the current folder.
@@ -241,6 +367,18 @@ bool LocalFile::LoadBlocksInfo() {
     }
 
     std::string real_storage_file_path = file_path_ + "/" + file_name;
+    // The temporary file is left by the interrupted write. The temporary block meta file is not committed, and the
+    // temporary block file is recovered after the block metas are loaded.
+    if (file_name.substr(file_name.length() - TEMP_FILE_SUFFIX_LENS) == kTempFileSuffix) {
+      auto name = file_name.substr(0, file_name.length() - TEMP_FILE_SUFFIX_LENS);
+      if (name.length() > JSON_SUFFIX_LENS && name.substr(name.length() - JSON_SUFFIX_LENS) == kJsonSuffix) {
+        (void)std::remove(real_storage_file_path.c_str());
+      } else {
+        temp_block_file_name_list.push_back(real_storage_file_path);
+      }
+      continue;
+    }
+
     auto suffix = file_name.substr(file_name.length() - JSON_SUFFIX_LENS);
     if (suffix == kJsonSuffix) {
       block_meta_file_name_list.push_back(real_storage_file_path);
@@ -270,8 +408,72 @@ bool LocalFile::LoadBlocksInfo() {
     block_ptr->set_block_meta(block_meta_ptr);
     block_list_.push_back(block_ptr);
   }
+
+  for (const auto &temp_file_name : temp_block_file_name_list) {
+    auto block_file_name = temp_file_name.substr(0, temp_file_name.length() - TEMP_FILE_SUFFIX_LENS);
+    auto iter = std::find(block_file_name_list.begin(), block_file_name_list.end(), block_file_name);
+    if (iter == block_file_name_list.end() ||
+        !RecoverBlockFile(LongToSize(iter - block_file_name_list.begin()), temp_file_name)) {
+      (void)std::remove(temp_file_name.c_str());
+    }
+  }
+  if (!temp_block_file_name_list.empty() && !FileIOUtils::Sync(file_path_)) {
+    MS_LOG(ERROR) << "Sync the recovered block files failed, file path: " << file_path_;
+    return false;
+  }
+  SortBlocksByShardRange();
+  finish_create_block_files_ = !block_list_.empty();
+  return true;
+}
+
+bool LocalFile::RecoverBlockFile(size_t block_index, const std::string &temp_file_name) const {
+  const auto &block_ptr = block_list_.at(block_index);
+  const auto &block_meta_ptr = block_meta_list_.at(block_index);
+  MS_EXCEPTION_IF_NULL(block_ptr);
+  MS_EXCEPTION_IF_NULL(block_meta_ptr);
+  struct stat file_stat;
+  if (!block_meta_ptr->Exists(kChecksum) || stat(temp_file_name.c_str(), &file_stat) != 0 || file_stat.st_size <= 0) {
+    return false;
+  }
+
+  // The temporary file is synced before the block meta is committed, so it is complete if it matches the checksum.
+  std::vector<char> content(LongToSize(file_stat.st_size));
+  if (!FileIOUtils::Read(temp_file_name, {{content.data(), content.size()}}) ||
+      Block::CalcChecksum(std::vector<std::pair<char *, size_t>>{{content.data(), content.size()}}) !=
+        block_meta_ptr->Get<uint32_t>(kChecksum)) {
+    return false;
+  }
+  if (!FileIOUtils::Rename(temp_file_name, block_ptr->block_file_name())) {
+    return false;
+  }
+  ChangeFileMode(block_ptr->block_file_name(), S_IRWXU | S_IRWXG | S_IRWXO);
+  MS_LOG(WARNING) << "Recover the block file interrupted in writing, file name: " << block_ptr->block_file_name();
   return true;
 }
+
+void LocalFile::SortBlocksByShardRange() {
+  // The file names are sorted in lexicographical order, such as block_1, block_10, block_2.
+  std::vector<size_t> order(block_list_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::vector<int> upper_bounds(block_meta_list_.size());
+  for (size_t i = 0; i < block_meta_list_.size(); ++i) {
+    MS_EXCEPTION_IF_NULL(block_meta_list_[i]);
+    upper_bounds[i] = block_meta_list_[i]->Get<int>(kShardRangeUpperBound);
+  }
+  std::sort(order.begin(), order.end(),
+            [&upper_bounds](size_t lhs, size_t rhs) { return upper_bounds[lhs] < upper_bounds[rhs]; });
+
+  std::vector<std::shared_ptr<Block>> block_list;
+  std::vector<std::shared_ptr<BlockMeta>> block_meta_list;
+  block_upper_bounds_.clear();
+  for (size_t index : order) {
+    block_list.push_back(block_list_[index]);
+    block_meta_list.push_back(block_meta_list_[index]);
+    block_upper_bounds_.push_back(upper_bounds[index]);
+  }
+  block_list_.swap(block_list);
+  block_meta_list_.swap(block_meta_list);
+}
 }  // namespace storage
 }  // namespace distributed
 }  // namespace mindspore
@@ -17,9 +17,12 @@
 #ifndef MINDSPORE_CCSRC_DISTRIBUTED_PERSISTENT_STORAGE_LOCAL_FILE_H_
 #define MINDSPORE_CCSRC_DISTRIBUTED_PERSISTENT_STORAGE_LOCAL_FILE_H_
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "distributed/persistent/storage/storage.h"
@@ -31,6 +34,8 @@ namespace distributed {
 namespace storage {
 // The default maximum block length : 128MB.
 constexpr size_t DEFAULT_MAX_BLOCK_LENGTH = 128 << 20;
+// The default number of threads to write or read block files.
+constexpr size_t DEFAULT_WRITER_THREAD_NUM = 4;
 
 // File type persistence storage implementation class.
 class LocalFile : public StorageBase {
@@ -47,21 +52,32 @@ class LocalFile : public StorageBase {
     } else {
       max_block_length_ = DEFAULT_MAX_BLOCK_LENGTH;
     }
+
+    auto thread_num_iter = storage_config.find(kWriterThreadNum);
+    if (thread_num_iter != storage_config.end() && !(thread_num_iter->second).empty()) {
+      writer_thread_num_ = std::max<size_t>(1, std::stoul(thread_num_iter->second));
+    } else {
+      writer_thread_num_ = DEFAULT_WRITER_THREAD_NUM;
+    }
   }
 
-  ~LocalFile() override = default;
+  ~LocalFile() override;
 
   // The following two methods are override version function for Write:
-  // 1. Create blocks and block metas.
-  // 2. Write input data to block files and Generate sha256 sequence for every block file.
+  // 1. Create blocks and block metas, write input data to all block files and generate checksum for every block file.
+  // 2. After the block files are created, only copy the dirty blocks of input data to the snapshots, which are written
+  // to the block files by the background thread, so the input data could be modified once the Write returns.
   // Write the entire blob data of tensor to the block files on disk:
   void Write(const InputData &input, const DirtyInfo &dirty_info) override;
   // Write the entire blob data composed of multiple tensors to the block files on disk:
   void Write(const std::vector<InputData> &inputs, const DirtyInfo &dirty_info) override;
 
+  // Wait for the background thread to finish writing the snapshots to the block files.
+  void Flush() override;
+
   // The following two methods are override version function for Read:
-  // 1.Tamper proof check.
-  // 2.Read all block files and merge them into contiguous memory.
+  // 1.Read all block files in parallel and merge them into contiguous memory.
+  // 2.Tamper proof check.
   // Read data from all block files in file_path_(dir):
   void Read(const OutputData &output) override;
   // Read data from all block files in file_path_(dir) for multiple tensors.
@@ -71,16 +87,34 @@ class LocalFile : public StorageBase {
   // Create blocks and block metas and write input data to block files.
   void WriteBlockFiles(const std::vector<InputData> &inputs);
 
-  // Write shardding data to one specific block file by block index and generate sha256.
-  void WriteOneBlockFile(size_t block_index, const std::vector<InputData> &inputs) const;
+  // Get the shardding data of all inputs in one specific block.
+  std::vector<std::pair<const void *, size_t>> GetBlockData(size_t block_index,
+                                                            const std::vector<InputData> &inputs) const;
+
+  // Copy the shardding data of the blocks to the snapshots and write them to the block files in the background.
+  void WriteBlockSnapshots(const std::vector<size_t> &block_indices, const std::vector<InputData> &inputs);
+
+  // Write the snapshots to the temporary files and sync all of them in a batch, then commit the block metas with the
+  // new checksums and replace the block files, so a block file is either the old content or the new content if the
+  // process crashes.
+  bool WriteSnapshotsToBlockFiles(const std::vector<std::pair<size_t, std::vector<char>>> &snapshots) const;
+
+  // Write shardding data to one specific block file by block index and generate checksum.
+  bool WriteOneBlockFile(size_t block_index, const std::vector<std::pair<const void *, size_t>> &block_data) const;
 
-  // Obtain the corresponding file block index according to dirty info, only need to rewrite these file blocks, and
-  // dirty info needs to be sorted in ascending order.
-  void TransformDirtyInfoToBlockIndices(const DirtyInfo &dirty_info, std::vector<int> *block_indices) const;
+  // Obtain the corresponding file block index according to dirty info, only need to rewrite these file blocks.
+  void TransformDirtyInfoToBlockIndices(const DirtyInfo &dirty_info, std::vector<size_t> *block_indices) const;
 
   // Load file list info of block files and block meta files in the 'file_path_' to block list and block meta list.
   bool LoadBlocksInfo();
 
+  // Replace the block file by the temporary file left by the interrupted write if the block meta has been committed
+  // with the checksum of the temporary file, return false if the temporary file is not committed.
+  bool RecoverBlockFile(size_t block_index, const std::string &temp_file_name) const;
+
+  // Sort the blocks by the shard range and record the upper bounds of the shard ranges.
+  void SortBlocksByShardRange();
+
   // The local file is composed of many block files, and each block file corresponds to a Block object in memory.
   std::vector<std::shared_ptr<Block>> block_list_;
 
@@ -88,14 +122,26 @@ class LocalFile : public StorageBase {
   // such as shard shape, shard range, field length, etc.
   std::vector<std::shared_ptr<BlockMeta>> block_meta_list_;
 
+  // The upper bound of the shard range of every block in ascending order, used to find the block of the dirty info.
+  std::vector<int> block_upper_bounds_;
+
   // Folder path to save all block files.
   std::string file_path_;
 
   // Maximum size of each block file.
   size_t max_block_length_;
 
+  // The number of threads to copy the snapshots, write or read block files.
+  size_t writer_thread_num_;
+
   // Indicates whether block files has been created.
   bool finish_create_block_files_{false};
+
+  // The background thread writing the snapshots of the dirty blocks, at most one write is in flight.
+  std::thread write_thread_;
+
+  // Whether the last background write succeeded, which is checked after the background thread is joined.
+  bool write_success_{true};
 };
 }  // namespace storage
 }  // namespace distributed
@@ -53,6 +53,9 @@ class StorageBase {
   // The parameter dirty_info indicates that the part of the Tensor that needs to be rewritten to storage.
   virtual void Write(const std::vector<InputData> &input, const DirtyInfo &dirty_info) {}
 
+  // Wait until the data written in the background is persisted to the storage medium.
+  virtual void Flush() {}
+
   // Read data from the storage medium or memory buffer and merge them into contiguous memory.
   virtual void Read(const OutputData &output) {}
 
@@ -0,0 +1,200 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "distributed/rpc/shm/shm_channel.h"
+
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <utility>
+
+#include "distributed/rpc/tcp/socket_operation.h"
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace distributed {
+namespace rpc {
+namespace {
+// The client writes the ring buffer with this suffix and the server reads it, and vice versa.
+constexpr char kClientToServerSuffix[] = "_c2s";
+constexpr char kServerToClientSuffix[] = "_s2c";
+// The max length of the channel names, which is far below NAME_MAX.
+constexpr size_t kMaxShmNameLen = 64;
+}  // namespace
+
+ShmChannel::~ShmChannel() { Close(); }
+
+bool ShmChannel::Create(const std::string &name, size_t ring_size) {
+  send_ring_ = std::make_unique<ShmRingBuffer>();
+  recv_ring_ = std::make_unique<ShmRingBuffer>();
+  return send_ring_->Create(name + kClientToServerSuffix, ring_size) &&
+         recv_ring_->Create(name + kServerToClientSuffix, ring_size);
+}
+
+bool ShmChannel::Open(const std::string &name) {
+  send_ring_ = std::make_unique<ShmRingBuffer>();
+  recv_ring_ = std::make_unique<ShmRingBuffer>();
+  return send_ring_->Open(name + kServerToClientSuffix) && recv_ring_->Open(name + kClientToServerSuffix);
+}
+
+void ShmChannel::Unlink() {
+  if (send_ring_ != nullptr) {
+    send_ring_->Unlink();
+  }
+  if (recv_ring_ != nullptr) {
+    recv_ring_->Unlink();
+  }
+}
+
+void ShmChannel::Start(const MessageHandler &handler, EventLoop *recv_event_loop) {
+  MS_EXCEPTION_IF_NULL(recv_event_loop);
+  message_handler_ = handler;
+  recv_event_loop_ = recv_event_loop;
+  recv_thread_ = std::thread(&ShmChannel::ReceiveLoop, this);
+}
+
+ssize_t ShmChannel::Send(MessageBase *msg) {
+  std::unique_ptr<MessageBase> message(msg);
+  MS_EXCEPTION_IF_NULL(message);
+  MS_EXCEPTION_IF_NULL(send_ring_);
+  MessageHeader header;
+  FillMessageHeader(*message, &header);
+  std::string send_to = message->to;
+  std::string send_from = message->from;
+
+  struct iovec iov[SEND_MSG_IO_VEC_LEN] = {{&header, sizeof(header)},
+                                          {const_cast<char *>(message->name.data()), message->name.size()},
+                                          {const_cast<char *>(send_to.data()), send_to.size()},
+                                          {const_cast<char *>(send_from.data()), send_from.size()},
+                                          {const_cast<char *>(message->body.data()), message->body.size()}};
+  std::lock_guard<std::mutex> lock(send_mutex_);
+  if (!send_ring_->WriteV(iov, SEND_MSG_IO_VEC_LEN)) {
+    MS_LOG(WARNING) << "Failed to send the message " << message->name << " through the closed shared memory "
+                    << send_ring_->name();
+    return -1;
+  }
+  return SizeToLong(message->body.size());
+}
+
+MessageBase *ShmChannel::ReadMessage() {
+  MessageHeader header;
+  if (!recv_ring_->Read(&header, sizeof(header))) {
+    return nullptr;
+  }
+  if (strncmp(header.magic, RPC_MAGICID, sizeof(RPC_MAGICID) - 1) != 0) {
+    MS_LOG(ERROR) << "Failed to check magicid of the message from the shared memory " << recv_ring_->name();
+    return nullptr;
+  }
+  size_t name_len = ntohl(header.name_len);
+  size_t to_len = ntohl(header.to_len);
+  size_t from_len = ntohl(header.from_len);
+  size_t body_len = ntohl(header.body_len);
+  if (name_len > MAX_KMSG_NAME_LEN || to_len > MAX_KMSG_TO_LEN || from_len > MAX_KMSG_FROM_LEN ||
+      body_len > MAX_KMSG_BODY_LEN) {
+    MS_LOG(ERROR) << "Drop invalid data from the shared memory " << recv_ring_->name();
+    return nullptr;
+  }
+
+  std::unique_ptr<MessageBase> message = std::make_unique<MessageBase>();
+  std::string recv_to(to_len, '\0');
+  std::string recv_from(from_len, '\0');
+  message->name.resize(name_len);
+  message->body.resize(body_len);
+  if (!recv_ring_->Read(const_cast<char *>(message->name.data()), name_len) ||
+      !recv_ring_->Read(const_cast<char *>(recv_to.data()), to_len) ||
+      !recv_ring_->Read(const_cast<char *>(recv_from.data()), from_len) ||
+      !recv_ring_->Read(const_cast<char *>(message->body.data()), body_len)) {
+    return nullptr;
+  }
+  message->to = AID(recv_to);
+  message->from = AID(recv_from);
+  return message.release();
+}
+
+void ShmChannel::ReceiveLoop() {
+  // The channel may be released before the queued messages are handled.
+  std::weak_ptr<ShmChannel> weak_channel = weak_from_this();
+  while (true) {
+    MessageBase *message = ReadMessage();
+    if (message == nullptr) {
+      break;
+    }
+    (void)recv_event_loop_->AddTask([weak_channel, message]() {
+      auto channel = weak_channel.lock();
+      if (channel == nullptr) {
+        delete message;
+        return RPC_OK;
+      }
+      channel->HandleMessage(message);
+      return RPC_OK;
+    });
+  }
+  MS_LOG(INFO) << "The shared memory channel " << recv_ring_->name() << " is closed.";
+}
+
+void ShmChannel::HandleMessage(MessageBase *message) {
+  if (message_handler_ == nullptr) {
+    MS_LOG(INFO) << "Message handler was not found";
+    delete message;
+    return;
+  }
+  // Send the result message back to the peer if any.
+  auto result = message_handler_(message);
+  if (result != NULL_MSG) {
+    (void)Send(result);
+  }
+}
+
+void ShmChannel::Close() {
+  if (send_ring_ != nullptr) {
+    send_ring_->Close();
+  }
+  if (recv_ring_ != nullptr) {
+    recv_ring_->Close();
+  }
+  if (recv_thread_.joinable() && recv_thread_.get_id() != std::this_thread::get_id()) {
+    recv_thread_.join();
+  }
+}
+
+bool ShmChannel::IsClosed() const { return recv_ring_ == nullptr || recv_ring_->IsClosed(); }
+
+std::string ShmChannel::GenerateName() {
+  static std::atomic<size_t> channel_id(0);
+  return kShmNamePrefix + std::to_string(getpid()) + "_" + std::to_string(channel_id++);
+}
+
+bool ShmChannel::IsValidName(const std::string &name) {
+  const std::string prefix = kShmNamePrefix;
+  if (name.size() <= prefix.size() || name.size() > kMaxShmNameLen || name.compare(0, prefix.size(), prefix) != 0) {
+    return false;
+  }
+  return std::all_of(name.begin() + prefix.size(), name.end(), [](char c) { return isdigit(c) || c == '_'; });
+}
+
+bool IsShmTransportEnabled() { return common::GetEnv(kEnvEnableShmTransport) == "1"; }
+
+bool IsShmTransportEnabled(const std::string &dst_url) {
+  if (!IsShmTransportEnabled()) {
+    return false;
+  }
+  // The peer runs on the same host if its IP address belongs to one of the local network interfaces.
+  return SocketOperation::IsLocalIP(SocketOperation::GetIP(dst_url));
+}
+}  // namespace rpc
+}  // namespace distributed
+}  // namespace mindspore
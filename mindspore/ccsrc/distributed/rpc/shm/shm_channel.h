@@ -0,0 +1,118 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_DISTRIBUTED_RPC_SHM_SHM_CHANNEL_H_
+#define MINDSPORE_CCSRC_DISTRIBUTED_RPC_SHM_SHM_CHANNEL_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "actor/msg.h"
+#include "distributed/rpc/tcp/constants.h"
+#include "distributed/rpc/tcp/event_loop.h"
+#include "distributed/rpc/shm/shm_ring_buffer.h"
+
+namespace mindspore {
+namespace distributed {
+namespace rpc {
+// Set this environment variable to 1 on both sides to send the messages to the co-located peers through the shared
+// memory instead of the TCP loopback.
+constexpr char kEnvEnableShmTransport[] = "MS_ENABLE_SHM_TRANSPORT";
+
+// The prefix of the channel names, the server only opens the shared memory with this prefix.
+constexpr char kShmNamePrefix[] = "/mindspore_rpc_";
+
+// The capacity of each direction of the shared memory channel.
+constexpr size_t kShmRingSize = 8 << 20;
+
+constexpr char kShmConnectSuccess[] = "1";
+constexpr char kShmConnectFailure[] = "0";
+
+// The timeout in seconds of building the shared memory channel.
+constexpr uint32_t kShmConnectTimeout = 10;
+
+/*
+ * The bidirectional channel between two processes on the same host through two shared memory ring buffers. The
+ * messages keep the same wire format as TCP. The client creates the ring buffers and the server opens them by the
+ * name, then the receiving thread of each side posts the messages to the receiving event loop of TCP, so the messages
+ * from TCP and the shared memory are handled by the same thread in order. The message returned by the handler is sent
+ * back, which is the same as the TCP connection. The channel is closed once the peer process exits.
+ */
+class ShmChannel : public std::enable_shared_from_this<ShmChannel> {
+ public:
+  ShmChannel() = default;
+  ~ShmChannel();
+
+  // Create the ring buffers of the channel with the name, called by the client.
+  bool Create(const std::string &name, size_t ring_size = kShmRingSize);
+
+  // Open the ring buffers created by the client, called by the server.
+  bool Open(const std::string &name);
+
+  // Remove the names of the ring buffers after the server opens them.
+  void Unlink();
+
+  // Start the thread receiving the messages from the peer, which are handled in the event loop.
+  void Start(const MessageHandler &handler, EventLoop *recv_event_loop);
+
+  // Send the message to the peer and take its ownership. Return the byte size of the message body or -1 on failure.
+  ssize_t Send(MessageBase *msg);
+
+  // Close the channel for both sides and stop the receiving thread.
+  void Close();
+  bool IsClosed() const;
+
+  // Generate a channel name which is unique on the host.
+  static std::string GenerateName();
+
+  // Whether the name is generated by GenerateName.
+  static bool IsValidName(const std::string &name);
+
+ private:
+  // Read a message from the peer, return nullptr if the channel is closed or the data is invalid.
+  MessageBase *ReadMessage();
+
+  void ReceiveLoop();
+
+  // Handle the message in the receiving event loop and send back the result.
+  void HandleMessage(MessageBase *message);
+
+  std::unique_ptr<ShmRingBuffer> send_ring_;
+  std::unique_ptr<ShmRingBuffer> recv_ring_;
+
+  // The message handler is called by the receiving event loop.
+  MessageHandler message_handler_;
+  EventLoop *recv_event_loop_{nullptr};
+  std::thread recv_thread_;
+
+  // The messages may be sent by multiple threads.
+  std::mutex send_mutex_;
+
+  DISABLE_COPY_AND_ASSIGN(ShmChannel);
+};
+
+// Whether the shared memory transport is enabled in this process.
+bool IsShmTransportEnabled();
+
+// Whether the messages to the server of the url are sent through the shared memory.
+bool IsShmTransportEnabled(const std::string &dst_url);
+}  // namespace rpc
+}  // namespace distributed
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_DISTRIBUTED_RPC_SHM_SHM_CHANNEL_H_
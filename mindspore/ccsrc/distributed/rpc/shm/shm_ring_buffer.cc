@@ -0,0 +1,308 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "distributed/rpc/shm/shm_ring_buffer.h"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace distributed {
+namespace rpc {
+namespace {
+// The number of yields before the reader or writer sleeps on the futex.
+constexpr size_t kSpinCount = 128;
+// The futex wait timeout in nanoseconds, after which the closed flag and the peer process are checked again.
+constexpr long kFutexWaitTimeout = 100000000;
+// The data of the ring buffer is aligned to the cache line.
+constexpr size_t kDataAlignment = 64;
+
+size_t ControlSize() { return (sizeof(ShmRingControl) + kDataAlignment - 1) / kDataAlignment * kDataAlignment; }
+
+// The futex in the shared memory is not private, so the wake up works across processes.
+void FutexWait(std::atomic<uint32_t> *addr, uint32_t value) {
+  struct timespec timeout = {0, kFutexWaitTimeout};
+  (void)syscall(SYS_futex, reinterpret_cast<uint32_t *>(addr), FUTEX_WAIT, value, &timeout, nullptr, 0);
+}
+
+void FutexWake(std::atomic<uint32_t> *addr) {
+  (void)syscall(SYS_futex, reinterpret_cast<uint32_t *>(addr), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+}
+}  // namespace
+
+ShmRingBuffer::~ShmRingBuffer() {
+  if (control_ != nullptr) {
+    (void)munmap(control_, map_size_);
+    control_ = nullptr;
+    data_ = nullptr;
+  }
+  if (is_creator_) {
+    Unlink();
+  }
+}
+
+bool ShmRingBuffer::Create(const std::string &name, size_t capacity) {
+  if (capacity == 0) {
+    MS_LOG(ERROR) << "The capacity of the shared memory ring buffer " << name << " is 0.";
+    return false;
+  }
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    MS_LOG(WARNING) << "Failed to create the shared memory " << name << ", errno: " << errno;
+    return false;
+  }
+  name_ = name;
+  is_creator_ = true;
+  created_ = true;
+
+  // Reserve the memory in advance, otherwise the process is killed by SIGBUS when the shared memory is exhausted.
+  size_t map_size = ControlSize() + capacity;
+  int ret = posix_fallocate(fd, 0, static_cast<off_t>(map_size));
+  if (ret != 0) {
+    MS_LOG(WARNING) << "Failed to allocate " << map_size << " bytes for the shared memory " << name
+                    << ", error: " << ret;
+    (void)close(fd);
+    return false;
+  }
+  if (!Map(fd, map_size)) {
+    return false;
+  }
+  control_ = new (control_) ShmRingControl();
+  control_->head = 0;
+  control_->tail = 0;
+  control_->data_seq = 0;
+  control_->space_seq = 0;
+  control_->reader_waiting = 0;
+  control_->writer_waiting = 0;
+  control_->closed = 0;
+  control_->creator_pid = static_cast<int32_t>(getpid());
+  control_->opener_pid = 0;
+  control_->capacity = capacity;
+  return true;
+}
+
+bool ShmRingBuffer::Open(const std::string &name) {
+  int fd = shm_open(name.c_str(), O_RDWR, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    MS_LOG(WARNING) << "Failed to open the shared memory " << name << ", errno: " << errno;
+    return false;
+  }
+  name_ = name;
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) <= ControlSize()) {
+    MS_LOG(WARNING) << "Invalid size of the shared memory " << name << ", errno: " << errno;
+    (void)close(fd);
+    return false;
+  }
+  size_t map_size = static_cast<size_t>(file_stat.st_size);
+  if (!Map(fd, map_size)) {
+    return false;
+  }
+  if (control_->capacity != map_size - ControlSize()) {
+    MS_LOG(WARNING) << "The capacity " << control_->capacity << " of the shared memory " << name
+                    << " doesn't match the size " << map_size;
+    (void)munmap(control_, map_size_);
+    control_ = nullptr;
+    data_ = nullptr;
+    return false;
+  }
+  control_->opener_pid = static_cast<int32_t>(getpid());
+  return true;
+}
+
+bool ShmRingBuffer::Map(int fd, size_t map_size) {
+  void *addr = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  // The mapping keeps the shared memory alive after the fd is closed.
+  (void)close(fd);
+  if (addr == MAP_FAILED) {
+    MS_LOG(WARNING) << "Failed to map the shared memory " << name_ << ", errno: " << errno;
+    return false;
+  }
+  control_ = reinterpret_cast<ShmRingControl *>(addr);
+  data_ = reinterpret_cast<char *>(addr) + ControlSize();
+  map_size_ = map_size;
+  return true;
+}
+
+void ShmRingBuffer::Unlink() {
+  if (!name_.empty() && is_creator_) {
+    (void)shm_unlink(name_.c_str());
+    is_creator_ = false;
+  }
+}
+
+bool ShmRingBuffer::Write(const void *data, size_t size) {
+  struct iovec iov = {const_cast<void *>(data), size};
+  return WriteV(&iov, 1);
+}
+
+bool ShmRingBuffer::WriteV(const struct iovec *iov, size_t iov_num) {
+  MS_EXCEPTION_IF_NULL(control_);
+  uint64_t capacity = control_->capacity;
+  uint64_t head = control_->head.load(std::memory_order_relaxed);
+  uint64_t space = 0;
+  for (size_t i = 0; i < iov_num; ++i) {
+    const char *src = reinterpret_cast<const char *>(iov[i].iov_base);
+    size_t size = iov[i].iov_len;
+    while (size > 0) {
+      if (space == 0) {
+        // Publish the written bytes before waiting, so the reader could make room.
+        NotifyData(head);
+        space = WaitSpace();
+        if (space == 0) {
+          return false;
+        }
+      }
+      size_t offset = head % capacity;
+      size_t len = std::min({static_cast<size_t>(space), size, static_cast<size_t>(capacity - offset)});
+      (void)memcpy(data_ + offset, src, len);
+      head += len;
+      space -= len;
+      src += len;
+      size -= len;
+    }
+  }
+  NotifyData(head);
+  return true;
+}
+
+void ShmRingBuffer::NotifyData(uint64_t head) {
+  if (head == control_->head.load(std::memory_order_relaxed)) {
+    return;
+  }
+  control_->head.store(head);
+  // Wake up the reader only if it sleeps.
+  (void)control_->data_seq.fetch_add(1);
+  if (control_->reader_waiting.load() != 0) {
+    FutexWake(&control_->data_seq);
+  }
+}
+
+bool ShmRingBuffer::Read(void *data, size_t size) {
+  MS_EXCEPTION_IF_NULL(control_);
+  char *dst = reinterpret_cast<char *>(data);
+  uint64_t capacity = control_->capacity;
+  while (size > 0) {
+    uint64_t available = WaitData();
+    if (available == 0) {
+      return false;
+    }
+    uint64_t tail = control_->tail.load(std::memory_order_relaxed);
+    size_t offset = tail % capacity;
+    size_t len = std::min({static_cast<size_t>(available), size, static_cast<size_t>(capacity - offset)});
+    (void)memcpy(dst, data_ + offset, len);
+    control_->tail.store(tail + len);
+
+    // Wake up the writer only if it sleeps.
+    (void)control_->space_seq.fetch_add(1);
+    if (control_->writer_waiting.load() != 0) {
+      FutexWake(&control_->space_seq);
+    }
+    dst += len;
+    size -= len;
+  }
+  return true;
+}
+
+uint64_t ShmRingBuffer::WaitData() {
+  for (size_t i = 0;; ++i) {
+    uint64_t available = control_->head.load() - control_->tail.load(std::memory_order_relaxed);
+    if (available > 0) {
+      return available;
+    }
+    if (control_->closed.load() != 0) {
+      return 0;
+    }
+    if (i < kSpinCount) {
+      (void)sched_yield();
+      continue;
+    }
+    // The writer bumps the sequence after moving the head, so the wake up between the check and the wait is not lost.
+    uint32_t seq = control_->data_seq.load();
+    control_->reader_waiting.store(1);
+    if (control_->head.load() == control_->tail.load(std::memory_order_relaxed) && control_->closed.load() == 0) {
+      FutexWait(&control_->data_seq, seq);
+    }
+    control_->reader_waiting.store(0);
+    if (!IsPeerAlive()) {
+      Close();
+    }
+  }
+}
+
+uint64_t ShmRingBuffer::WaitSpace() {
+  for (size_t i = 0;; ++i) {
+    if (control_->closed.load() != 0) {
+      return 0;
+    }
+    uint64_t space = control_->capacity - (control_->head.load(std::memory_order_relaxed) - control_->tail.load());
+    if (space > 0) {
+      return space;
+    }
+    if (i < kSpinCount) {
+      (void)sched_yield();
+      continue;
+    }
+    uint32_t seq = control_->space_seq.load();
+    control_->writer_waiting.store(1);
+    if (control_->head.load(std::memory_order_relaxed) - control_->tail.load() == control_->capacity &&
+        control_->closed.load() == 0) {
+      FutexWait(&control_->space_seq, seq);
+    }
+    control_->writer_waiting.store(0);
+    if (!IsPeerAlive()) {
+      Close();
+    }
+  }
+}
+
+void ShmRingBuffer::Close() {
+  if (control_ == nullptr) {
+    return;
+  }
+  control_->closed.store(1);
+  (void)control_->data_seq.fetch_add(1);
+  (void)control_->space_seq.fetch_add(1);
+  FutexWake(&control_->data_seq);
+  FutexWake(&control_->space_seq);
+}
+
+bool ShmRingBuffer::IsPeerAlive() const {
+  auto peer_pid = static_cast<pid_t>(created_ ? control_->opener_pid.load() : control_->creator_pid.load());
+  if (peer_pid == 0 || kill(peer_pid, 0) == 0 || errno != ESRCH) {
+    return true;
+  }
+  MS_LOG(WARNING) << "The peer process " << peer_pid << " of the shared memory " << name_ << " exits.";
+  return false;
+}
+
+bool ShmRingBuffer::IsClosed() const { return control_ == nullptr || control_->closed.load() != 0; }
+}  // namespace rpc
+}  // namespace distributed
+}  // namespace mindspore
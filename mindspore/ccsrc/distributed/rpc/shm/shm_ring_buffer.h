@@ -0,0 +1,109 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_DISTRIBUTED_RPC_SHM_SHM_RING_BUFFER_H_
+#define MINDSPORE_CCSRC_DISTRIBUTED_RPC_SHM_SHM_RING_BUFFER_H_
+
+#include <sys/uio.h>
+#include <atomic>
+#include <string>
+
+#include "utils/ms_utils.h"
+
+namespace mindspore {
+namespace distributed {
+namespace rpc {
+/*
+ * The control block at the beginning of the shared memory, and the data of the ring buffer follows it.
+ * The head and tail are the total number of bytes written and read, the sequences are the futex words
+ * for the reader waiting for data and the writer waiting for space. The pids of the creator and the opener are used to
+ * find out the death of the peer process.
+ */
+struct ShmRingControl {
+  std::atomic<uint64_t> head;
+  std::atomic<uint64_t> tail;
+  std::atomic<uint32_t> data_seq;
+  std::atomic<uint32_t> space_seq;
+  std::atomic<uint32_t> reader_waiting;
+  std::atomic<uint32_t> writer_waiting;
+  std::atomic<uint32_t> closed;
+  std::atomic<int32_t> creator_pid;
+  std::atomic<int32_t> opener_pid;
+  uint64_t capacity;
+};
+
+/*
+ * The single producer single consumer byte ring buffer in the POSIX shared memory, which is used by two processes on
+ * the same host. The data larger than the capacity is streamed through the ring buffer, and the blocked reader or
+ * writer sleeps on a futex in the shared memory instead of polling.
+ */
+class ShmRingBuffer {
+ public:
+  ShmRingBuffer() = default;
+  ~ShmRingBuffer();
+
+  // Create the shared memory with the name and capacity, the creator removes the name when destroyed.
+  bool Create(const std::string &name, size_t capacity);
+
+  // Map the shared memory created by the peer process.
+  bool Open(const std::string &name);
+
+  // Remove the name of the shared memory, the memory is released after both processes unmap it.
+  void Unlink();
+
+  // Write or read all the bytes, which blocks until they are transferred. Return false if the ring buffer is closed,
+  // which is also done by the blocked reader or writer once the peer process exits.
+  bool Write(const void *data, size_t size);
+  bool Read(void *data, size_t size);
+
+  // Write the buffers as a whole, and the reader is notified once unless the ring buffer is full.
+  bool WriteV(const struct iovec *iov, size_t iov_num);
+
+  // Close the ring buffer for both processes and wake up the blocked reader and writer.
+  void Close();
+  bool IsClosed() const;
+
+  const std::string &name() const { return name_; }
+
+ private:
+  bool Map(int fd, size_t map_size);
+
+  // Wait until the ring buffer has data to read or space to write, return the available bytes or 0 if closed.
+  uint64_t WaitData();
+  uint64_t WaitSpace();
+
+  // Publish the written bytes to the reader.
+  void NotifyData(uint64_t head);
+
+  // Whether the peer process is alive, which is true before the peer opens the ring buffer.
+  bool IsPeerAlive() const;
+
+  std::string name_;
+  // Whether the name is removed when destroyed.
+  bool is_creator_{false};
+  // Whether the ring buffer is created by this process, which is not changed by Unlink.
+  bool created_{false};
+
+  ShmRingControl *control_{nullptr};
+  char *data_{nullptr};
+  size_t map_size_{0};
+
+  DISABLE_COPY_AND_ASSIGN(ShmRingBuffer);
+};
+}  // namespace rpc
+}  // namespace distributed
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_DISTRIBUTED_RPC_SHM_SHM_RING_BUFFER_H_
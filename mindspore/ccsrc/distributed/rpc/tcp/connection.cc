@@ -117,7 +117,8 @@ Connection::Connection()
       send_event_loop(nullptr),
       recv_event_loop(nullptr),
       send_metrics(nullptr),
-      send_message(nullptr),
+      send_messages{},
+      send_message_num(0),
       recv_message(nullptr),
       recv_state(kMsgHeader),
       total_recv_len(0),
@@ -138,15 +139,8 @@ Connection::Connection()
   recv_kernel_msg.msg_iov = recv_io_vec;
   recv_kernel_msg.msg_iovlen = RECV_MSG_IO_VEC_LEN;
 
-  // Initialize the send message header.
+  // The magic id of the send message headers is initialized by the constructor of MessageHeader.
   send_metrics = new SendMetrics();
-  for (unsigned int i = 0; i < BUSMAGIC_LEN; i++) {
-    if (i < sizeof(RPC_MAGICID) - 1) {
-      send_msg_header.magic[i] = RPC_MAGICID[i];
-    } else {
-      send_msg_header.magic[i] = '\0';
-    }
-  }
 
   // Initialize the send kernel message structure.
   send_kernel_msg.msg_control = nullptr;
@@ -155,7 +149,7 @@ Connection::Connection()
   send_kernel_msg.msg_name = nullptr;
   send_kernel_msg.msg_namelen = 0;
   send_kernel_msg.msg_iov = send_io_vec;
-  send_kernel_msg.msg_iovlen = SEND_MSG_IO_VEC_LEN;
+  send_kernel_msg.msg_iovlen = 0;
 }
 
 int Connection::Initialize() {
@@ -215,10 +209,7 @@ void Connection::Close() {
 
   // There's no need to release the recv_message because the lifecycle of this data is passed to the caller.
 
-  if (total_send_len != 0 && send_message != nullptr) {
-    delete send_message;
-    send_message = nullptr;
-  }
+  (void)ReleaseSendMessages();
 
   MessageBase *tmpMsg = nullptr;
   while (!send_message_queue.empty()) {
@@ -250,12 +241,18 @@ int Connection::ReceiveMessage() {
     return 0;
   }
 
+  // The shared memory channel is only built for the clients on the same host, so the request carries the address of
+  // the peer socket instead of the address claimed by the client.
+  if (is_remote && recv_message->name == kShmConnectMsgName) {
+    recv_message->from = AID(recv_message->from.Name(), peer);
+  }
+
   // Call msg handler if set
   if (message_handler) {
     auto result = message_handler(recv_message);
     if (result != rpc::NULL_MSG) {
-      // Send the result message back to the tcp client if any.
-      FillSendMessage(result, "", false);
+      // Send the result message back to the tcp client if any, after the messages already queued.
+      (void)send_message_queue.emplace(result);
       (void)Flush();
     }
   } else {
@@ -321,62 +318,95 @@ std::string Connection::GenerateHttpMessage(MessageBase *msg) {
 }
 
 void Connection::FillSendMessage(MessageBase *msg, const std::string &advertiseUrl, bool isHttpKmsg) {
-  if (msg->type == MessageBase::Type::KMSG) {
-    int index = 0;
-    if (!isHttpKmsg) {
-      send_to = msg->to;
-      send_from = msg->from;
-      FillMessageHeader(*msg, &send_msg_header);
-
-      send_io_vec[index].iov_base = &send_msg_header;
-      send_io_vec[index].iov_len = sizeof(send_msg_header);
-      ++index;
-      send_io_vec[index].iov_base = const_cast<char *>(msg->name.data());
-      send_io_vec[index].iov_len = msg->name.size();
-      ++index;
-      send_io_vec[index].iov_base = const_cast<char *>(send_to.data());
-      send_io_vec[index].iov_len = send_to.size();
-      ++index;
-      send_io_vec[index].iov_base = const_cast<char *>(send_from.data());
-      send_io_vec[index].iov_len = send_from.size();
-      ++index;
-      send_io_vec[index].iov_base = const_cast<char *>(msg->body.data());
-      send_io_vec[index].iov_len = msg->body.size();
-      ++index;
-      send_kernel_msg.msg_iov = send_io_vec;
-      send_kernel_msg.msg_iovlen = index;
-      total_send_len =
-        UlongToUint(sizeof(send_msg_header)) + msg->name.size() + send_to.size() + send_from.size() + msg->body.size();
-      send_message = msg;
-
-      // update metrics
-      send_metrics->UpdateMax(msg->body.size());
-      send_metrics->last_send_msg_name = msg->name;
-      return;
-    } else {
-      if (advertise_addr_.empty()) {
-        size_t idx = advertiseUrl.find(URL_PROTOCOL_IP_SEPARATOR);
-        if (idx == std::string::npos) {
-          advertise_addr_ = advertiseUrl;
-        } else {
-          advertise_addr_ = advertiseUrl.substr(idx + sizeof(URL_PROTOCOL_IP_SEPARATOR) - 1);
-        }
+  if (msg->type != MessageBase::Type::KMSG) {
+    return;
+  }
+  // Start a new batch.
+  if (send_message_num == 0) {
+    send_kernel_msg.msg_iov = send_io_vec;
+    send_kernel_msg.msg_iovlen = 0;
+    total_send_len = 0;
+  }
+  size_t slot = send_message_num;
+  size_t index = send_kernel_msg.msg_iovlen;
+  if (!isHttpKmsg) {
+    std::string &send_to = send_tos[slot];
+    std::string &send_from = send_froms[slot];
+    MessageHeader &send_msg_header = send_msg_headers[slot];
+    send_to = msg->to;
+    send_from = msg->from;
+    FillMessageHeader(*msg, &send_msg_header);
+
+    send_io_vec[index].iov_base = &send_msg_header;
+    send_io_vec[index].iov_len = sizeof(send_msg_header);
+    ++index;
+    send_io_vec[index].iov_base = const_cast<char *>(msg->name.data());
+    send_io_vec[index].iov_len = msg->name.size();
+    ++index;
+    send_io_vec[index].iov_base = const_cast<char *>(send_to.data());
+    send_io_vec[index].iov_len = send_to.size();
+    ++index;
+    send_io_vec[index].iov_base = const_cast<char *>(send_from.data());
+    send_io_vec[index].iov_len = send_from.size();
+    ++index;
+    send_io_vec[index].iov_base = const_cast<char *>(msg->body.data());
+    send_io_vec[index].iov_len = msg->body.size();
+    ++index;
+    total_send_len += sizeof(send_msg_header) + msg->name.size() + send_to.size() + send_from.size() + msg->body.size();
+  } else {
+    if (advertise_addr_.empty()) {
+      size_t idx = advertiseUrl.find(URL_PROTOCOL_IP_SEPARATOR);
+      if (idx == std::string::npos) {
+        advertise_addr_ = advertiseUrl;
+      } else {
+        advertise_addr_ = advertiseUrl.substr(idx + sizeof(URL_PROTOCOL_IP_SEPARATOR) - 1);
       }
-      msg->body = GenerateHttpMessage(msg);
     }
+    msg->body = GenerateHttpMessage(msg);
 
     send_io_vec[index].iov_base = const_cast<char *>(msg->body.data());
     send_io_vec[index].iov_len = msg->body.size();
     ++index;
-    send_kernel_msg.msg_iov = send_io_vec;
-    send_kernel_msg.msg_iovlen = index;
-    total_send_len = UlongToUint(msg->body.size());
-    send_message = msg;
+    total_send_len += msg->body.size();
+  }
+  send_kernel_msg.msg_iovlen = index;
+  send_messages[slot] = msg;
+  ++send_message_num;
+
+  // update metrics
+  send_metrics->UpdateMax(msg->body.size());
+  send_metrics->last_send_msg_name = msg->name;
+}
+
+void Connection::FillSendMessages() {
+  size_t batch_size = 0;
+  while (!send_message_queue.empty() && send_message_num < SEND_MSG_BATCH_NUM) {
+    MessageBase *msg = send_message_queue.front();
+    if (msg->type != MessageBase::Type::KMSG) {
+      MS_LOG(WARNING) << "Drop the message " << msg->name << " with unsupported type to: " << destination;
+      send_message_queue.pop();
+      delete msg;
+      continue;
+    }
+    // The small messages are coalesced to save the system calls, and a large message is sent alone.
+    if (send_message_num > 0 && batch_size + msg->body.size() > SEND_MSG_BATCH_SIZE) {
+      break;
+    }
+    send_message_queue.pop();
+    batch_size += msg->body.size();
+    FillSendMessage(msg, source, false);
+  }
+}
 
-    // update metrics
-    send_metrics->UpdateMax(msg->body.size());
-    send_metrics->last_send_msg_name = msg->name;
+size_t Connection::ReleaseSendMessages() {
+  size_t body_size = 0;
+  for (size_t i = 0; i < send_message_num; ++i) {
+    body_size += send_messages[i]->body.size();
+    delete send_messages[i];
+    send_messages[i] = nullptr;
   }
+  send_message_num = 0;
+  return body_size;
 }
 
 void Connection::FillRecvMessage() {
@@ -426,8 +456,10 @@ int Connection::Flush() {
   int total_send_bytes = 0;
   while (!send_message_queue.empty() || total_send_len != 0) {
     if (total_send_len == 0) {
-      FillSendMessage(send_message_queue.front(), source, false);
-      send_message_queue.pop();
+      FillSendMessages();
+      if (send_message_num == 0) {
+        continue;
+      }
     }
     size_t sendLen = 0;
     int retval = socket_operation->SendMessage(this, &send_kernel_msg, total_send_len, &sendLen);
@@ -437,11 +469,9 @@ int Connection::Flush() {
         // update metrics
         send_metrics->UpdateError(false);
 
-        output_buffer_size -= send_message->body.size();
-        total_send_bytes += send_message->body.size();
-        delete send_message;
-        send_message = nullptr;
-        break;
+        size_t body_size = ReleaseSendMessages();
+        output_buffer_size -= body_size;
+        total_send_bytes += body_size;
       }
     } else if (retval == IO_RW_OK && sendLen == 0) {
       // EAGAIN
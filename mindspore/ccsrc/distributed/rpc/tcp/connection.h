@@ -100,9 +100,15 @@ struct Connection {
   int ReceiveMessage();
   void CheckMessageType();
 
-  // Fill the message to be sent based on the input message.
+  // Append the message to the batch to be sent, the io vectors reference the name and body of the message directly.
   void FillSendMessage(MessageBase *msg, const std::string &advertiseUrl, bool isHttpKmsg);
 
+  // Coalesce the queued messages into one batch to be sent by a single sendmsg call.
+  void FillSendMessages();
+
+  // Release the messages of the batch which has been sent and return the total body size.
+  size_t ReleaseSendMessages();
+
   void FillRecvMessage();
 
   bool IsSame(const Connection *that) {
@@ -149,7 +155,8 @@ struct Connection {
   SendMetrics *send_metrics;
 
   // The message data waiting to be sent and receive through this connection..
-  MessageBase *send_message;
+  MessageBase *send_messages[SEND_MSG_BATCH_NUM];
+  size_t send_message_num;
   MessageBase *recv_message;
 
   // Owned by the tcp_comm.
@@ -162,13 +169,13 @@ struct Connection {
   size_t total_send_len;
   size_t recv_len;
 
-  std::string send_to;
-  std::string send_from;
+  std::string send_tos[SEND_MSG_BATCH_NUM];
+  std::string send_froms[SEND_MSG_BATCH_NUM];
   std::string recv_to;
   std::string recv_from;
 
   // Message header.
-  MessageHeader send_msg_header;
+  MessageHeader send_msg_headers[SEND_MSG_BATCH_NUM];
   MessageHeader recv_msg_header;
 
   // The message structure of kernel.
@@ -176,7 +183,7 @@ struct Connection {
   struct msghdr recv_kernel_msg;
 
   struct iovec recv_io_vec[RECV_MSG_IO_VEC_LEN];
-  struct iovec send_io_vec[SEND_MSG_IO_VEC_LEN];
+  struct iovec send_io_vec[SEND_MSG_IO_VEC_LEN * SEND_MSG_BATCH_NUM];
 
   ParseType recv_message_type{kTcpMsg};
 
@@ -192,6 +199,9 @@ struct Connection {
   // Buffer for messages to be sent.
   std::queue<MessageBase *> send_message_queue;
 
+  // Whether a flush of the queued messages has been scheduled in the send event loop.
+  bool flush_pending{false};
+
   uint64_t output_buffer_size;
 
   // The error code when sending or receiving messages.
@@ -37,6 +37,13 @@ using ConnectionCallBack = void (*)(void *conn);
 constexpr int SEND_MSG_IO_VEC_LEN = 5;
 constexpr int RECV_MSG_IO_VEC_LEN = 4;
 
+// The max number of queued messages coalesced into one sendmsg call, whose io vectors are under IOV_MAX.
+constexpr size_t SEND_MSG_BATCH_NUM = 64;
+// The queued messages are coalesced until the total body size reaches this limit, a larger message is sent alone.
+constexpr size_t SEND_MSG_BATCH_SIZE = 1 << 20;
+// The max number of messages parsed in one read event of the connection.
+constexpr int RECV_MSG_BATCH_NUM = 64;
+
 constexpr unsigned int BUSMAGIC_LEN = 4;
 constexpr int SENDMSG_QUEUELEN = 1024;
 constexpr int SENDMSG_DROPED = -1;
@@ -46,6 +53,9 @@ constexpr size_t MAX_KMSG_TO_LEN = 1024;
 constexpr size_t MAX_KMSG_NAME_LEN = 1024;
 constexpr size_t MAX_KMSG_BODY_LEN = 1073741824;
 
+// The name of the message sent through TCP to build the shared memory channel, whose body is the channel name.
+constexpr char kShmConnectMsgName[] = "ShmConnect";
+
 enum ParseType { kTcpMsg = 1, kHttpReq, kHttpRsp, kUnknown };
 enum State { kMsgHeader, kBody };
 enum ConnectionState { kInit = 1, kConnecting, kConnected, kDisconnecting, kClose };
@@ -145,6 +145,31 @@ std::string SocketOperation::GetLocalIP() {
   return "";
 }
 
+bool SocketOperation::IsLocalIP(const std::string &ip) {
+  if (ip.empty()) {
+    return false;
+  }
+  struct ifaddrs *if_addrs;
+  if (getifaddrs(&if_addrs) != 0) {
+    MS_LOG(ERROR) << "Failed to lookup local network interfaces.";
+    return false;
+  }
+  bool is_local = false;
+  for (struct ifaddrs *if_addr = if_addrs; if_addr != nullptr; if_addr = if_addr->ifa_next) {
+    if (if_addr->ifa_addr == nullptr || if_addr->ifa_addr->sa_family != AF_INET) {
+      continue;
+    }
+    auto sock_addr = reinterpret_cast<struct sockaddr_in *>(if_addr->ifa_addr);
+    char ip_addr[INET_ADDRSTRLEN] = {0};
+    if (inet_ntop(AF_INET, &sock_addr->sin_addr, ip_addr, sizeof(ip_addr)) != nullptr && ip == ip_addr) {
+      is_local = true;
+      break;
+    }
+  }
+  freeifaddrs(if_addrs);
+  return is_local;
+}
+
 std::string SocketOperation::GetIP(const std::string &url) {
   size_t index1 = url.find("[");
   if (index1 == std::string::npos) {
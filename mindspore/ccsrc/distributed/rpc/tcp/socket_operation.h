@@ -42,6 +42,9 @@ class SocketOperation {
   // Lookup the local IP address of the first available network interface.
   static std::string GetLocalIP();
 
+  // Whether the IP address belongs to one of the network interfaces on the local machine.
+  static bool IsLocalIP(const std::string &ip);
+
   static std::string GetIP(const std::string &url);
   static uint16_t GetPort(int sock_fd);
 
@@ -26,12 +26,13 @@ bool TCPClient::Initialize() {
     MS_EXCEPTION_IF_NULL(tcp_comm_);
 
     // This message handler is used to accept and maintain the received message from the tcp server.
-    tcp_comm_->SetMessageHandler([this](MessageBase *const message) -> MessageBase *const {
+    message_handler_ = [this](MessageBase *const message) -> MessageBase *const {
       received_message_ = message;
       std::unique_lock<std::mutex> lock(mutex_);
       wait_msg_cond_.notify_one();
       return NULL_MSG;
-    });
+    };
+    tcp_comm_->SetMessageHandler(message_handler_);
     rt = tcp_comm_->Initialize();
   } else {
     rt = true;
@@ -40,6 +41,14 @@ bool TCPClient::Initialize() {
 }
 
 void TCPClient::Finalize() {
+  std::map<std::string, std::shared_ptr<ShmChannel>> shm_channels;
+  {
+    std::lock_guard<std::mutex> lock(shm_mutex_);
+    shm_channels.swap(shm_channels_);
+  }
+  for (auto &channel : shm_channels) {
+    channel.second->Close();
+  }
   if (tcp_comm_ != nullptr) {
     tcp_comm_->Finalize();
     tcp_comm_.reset();
@@ -52,6 +61,9 @@ bool TCPClient::Connect(const std::string &dst_url, size_t retry_count) {
   for (size_t i = 0; i < retry_count; ++i) {
     if (tcp_comm_->Connect(dst_url)) {
       MS_LOG(INFO) << "Connected to the tcp server " << dst_url << " successfully.";
+      if (IsShmTransportEnabled(dst_url) && !ConnectShm(dst_url)) {
+        MS_LOG(WARNING) << "Failed to build the shared memory channel to " << dst_url << ", use TCP instead.";
+      }
       return true;
     } else {
       MS_LOG(WARNING) << "Failed to connect to the tcp server : " << dst_url << ", retry to reconnect(" << (i + 1)
@@ -65,6 +77,10 @@ bool TCPClient::Connect(const std::string &dst_url, size_t retry_count) {
 
 bool TCPClient::Disconnect(const std::string &dst_url, size_t timeout_in_sec) {
   bool rt = false;
+  auto channel = RemoveShmChannel(dst_url);
+  if (channel != nullptr) {
+    channel->Close();
+  }
   tcp_comm_->Disconnect(dst_url);
 
   size_t timeout_in_ms = timeout_in_sec * 1000;
@@ -86,12 +102,12 @@ bool TCPClient::Disconnect(const std::string &dst_url, size_t timeout_in_sec) {
   return rt;
 }
 
-int TCPClient::SendSync(std::unique_ptr<MessageBase> &&msg) { return tcp_comm_->Send(msg.release(), true); }
+int TCPClient::SendSync(std::unique_ptr<MessageBase> &&msg) { return Send(msg.release(), true); }
 
-void TCPClient::SendAsync(std::unique_ptr<MessageBase> &&msg) { (void)tcp_comm_->Send(msg.release(), false); }
+void TCPClient::SendAsync(std::unique_ptr<MessageBase> &&msg) { (void)Send(msg.release(), false); }
 
 MessageBase *TCPClient::ReceiveSync(std::unique_ptr<MessageBase> &&msg, uint32_t timeout) {
-  int retval = tcp_comm_->Send(msg.release(), true);
+  int retval = Send(msg.release(), true);
   if (retval > 0) {
     std::unique_lock<std::mutex> lock(mutex_);
     bool res =
@@ -106,6 +122,72 @@ MessageBase *TCPClient::ReceiveSync(std::unique_ptr<MessageBase> &&msg, uint32_t
   }
   return NULL_MSG;
 }
+
+bool TCPClient::IsShmConnected(const std::string &dst_url) {
+  std::lock_guard<std::mutex> lock(shm_mutex_);
+  auto iter = shm_channels_.find(dst_url);
+  return iter != shm_channels_.end() && !iter->second->IsClosed();
+}
+
+bool TCPClient::ConnectShm(const std::string &dst_url) {
+  auto channel = std::make_shared<ShmChannel>();
+  auto channel_name = ShmChannel::GenerateName();
+  if (!channel->Create(channel_name)) {
+    return false;
+  }
+
+  // Ask the server to open the channel through the TCP connection.
+  auto message = std::make_unique<MessageBase>();
+  message->name = kShmConnectMsgName;
+  message->to = AID("", dst_url);
+  message->body = channel_name;
+  MessageBase *reply = ReceiveSync(std::move(message), kShmConnectTimeout);
+  bool success = (reply != nullptr && reply->body == kShmConnectSuccess);
+  delete reply;
+  // The names are not needed after the server maps the shared memory, so nothing is left if the processes crash.
+  channel->Unlink();
+  if (!success) {
+    return false;
+  }
+
+  channel->Start(message_handler_, tcp_comm_->recv_event_loop());
+  std::lock_guard<std::mutex> lock(shm_mutex_);
+  shm_channels_[dst_url] = channel;
+  MS_LOG(INFO) << "Connected to the server " << dst_url << " through the shared memory channel " << channel_name;
+  return true;
+}
+
+ssize_t TCPClient::Send(MessageBase *msg, bool sync) {
+  MS_EXCEPTION_IF_NULL(msg);
+  std::shared_ptr<ShmChannel> channel;
+  {
+    std::lock_guard<std::mutex> lock(shm_mutex_);
+    auto iter = shm_channels_.find(msg->to.Url());
+    if (iter != shm_channels_.end()) {
+      channel = iter->second;
+    }
+  }
+  if (channel != nullptr) {
+    if (!channel->IsClosed()) {
+      return channel->Send(msg);
+    }
+    // The channel is closed once the server exits, then the message goes to TCP which reports the broken connection.
+    MS_LOG(WARNING) << "The shared memory channel to " << msg->to.Url() << " is closed, use TCP instead.";
+    (void)RemoveShmChannel(msg->to.Url());
+  }
+  return tcp_comm_->Send(msg, sync);
+}
+
+std::shared_ptr<ShmChannel> TCPClient::RemoveShmChannel(const std::string &dst_url) {
+  std::lock_guard<std::mutex> lock(shm_mutex_);
+  auto iter = shm_channels_.find(dst_url);
+  if (iter == shm_channels_.end()) {
+    return nullptr;
+  }
+  auto channel = iter->second;
+  (void)shm_channels_.erase(iter);
+  return channel;
+}
 }  // namespace rpc
 }  // namespace distributed
 }  // namespace mindspore
@@ -17,17 +17,21 @@
 #ifndef MINDSPORE_CCSRC_DISTRIBUTED_RPC_TCP_TCP_CLIENT_H_
 #define MINDSPORE_CCSRC_DISTRIBUTED_RPC_TCP_TCP_CLIENT_H_
 
+#include <map>
 #include <string>
 #include <memory>
 #include <mutex>
 #include <condition_variable>
 
 #include "distributed/rpc/tcp/tcp_comm.h"
+#include "distributed/rpc/shm/shm_channel.h"
 #include "utils/ms_utils.h"
 
 namespace mindspore {
 namespace distributed {
 namespace rpc {
+// The messages to the server on the same host are sent through the shared memory channel instead of the TCP loopback,
+// and the TCP connection is still used to build the channel.
 class TCPClient {
  public:
   TCPClient() = default;
@@ -53,10 +57,30 @@ class TCPClient {
   // Returns nullptr after timeout.
   MessageBase *ReceiveSync(std::unique_ptr<MessageBase> &&msg, uint32_t timeout = 30);
 
+  // Whether the messages to the server are sent through the shared memory channel.
+  bool IsShmConnected(const std::string &dst_url);
+
  private:
+  // Build the shared memory channel to the server on the same host, return false if the server can't open it.
+  bool ConnectShm(const std::string &dst_url);
+
+  // Send the message through the shared memory channel if any, otherwise through TCP.
+  ssize_t Send(MessageBase *msg, bool sync);
+
+  // Remove the shared memory channel to the server and return it, or nullptr if not found.
+  std::shared_ptr<ShmChannel> RemoveShmChannel(const std::string &dst_url);
+
   // The basic TCP communication component used by the client.
   std::unique_ptr<TCPComm> tcp_comm_;
 
+  // The handler of the messages returned by the server.
+  MessageHandler message_handler_;
+
+  // The shared memory channels to the servers on the same host. The mutex only guards the map, and the messages are
+  // sent after it is released, because sending blocks while the ring buffer is full.
+  std::mutex shm_mutex_;
+  std::map<std::string, std::shared_ptr<ShmChannel>> shm_channels_;
+
   // The mutex and condition variable used to synchronize the write and read of the received message returned by calling
   // the `ReceiveSync` method.
   std::mutex mutex_;
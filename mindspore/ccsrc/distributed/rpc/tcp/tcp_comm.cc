@@ -16,6 +16,7 @@
 
 #include "distributed/rpc/tcp/tcp_comm.h"
 
+#include <future>
 #include <mutex>
 #include <utility>
 #include <memory>
@@ -208,14 +209,14 @@ bool TCPComm::StartServerSocket() {
 int TCPComm::GetServerFd() const { return server_fd_; }
 
 void TCPComm::ReadCallBack(void *connection) {
-  const int max_recv_count = 3;
+  // Parse the messages coalesced by the sender in one read event.
   Connection *conn = reinterpret_cast<Connection *>(connection);
   int count = 0;
   int retval = 0;
   do {
     retval = ReceiveMessage(conn);
     ++count;
-  } while (retval > 0 && count < max_recv_count);
+  } while (retval > 0 && count < RECV_MSG_BATCH_NUM);
 
   return;
 }
@@ -300,7 +301,7 @@ void TCPComm::DropMessage(MessageBase *msg) {
 }
 
 ssize_t TCPComm::Send(MessageBase *msg, bool sync) {
-  auto task = [msg, this] {
+  auto task = [msg, sync, this] {
     std::lock_guard<std::mutex> lock(*conn_mutex_);
     // Search connection by the target address
     Connection *conn = conn_pool_->FindConnection(msg->to.Url());
@@ -330,12 +331,19 @@ ssize_t TCPComm::Send(MessageBase *msg, bool sync) {
       return error_no;
     }
 
-    if (conn->total_send_len == 0) {
-      conn->FillSendMessage(msg, url_, false);
-    } else {
-      (void)conn->send_message_queue.emplace(msg);
+    // The message is coalesced with the other queued messages by the flush.
+    std::string dst_url = msg->to.Url();
+    (void)conn->send_message_queue.emplace(msg);
+    if (sync || conn->send_message_queue.size() >= SEND_MSG_BATCH_NUM) {
+      return conn->Flush();
     }
-    return conn->Flush();
+    // Defer the flush after the send tasks already in the event loop, so the messages sent asynchronously in a row
+    // are sent by one system call.
+    if (!conn->flush_pending) {
+      conn->flush_pending = true;
+      (void)send_event_loop_->AddTask([dst_url, this] { return FlushConnection(dst_url); });
+    }
+    return 0;
   };
   if (sync) {
     return task();
@@ -345,6 +353,20 @@ ssize_t TCPComm::Send(MessageBase *msg, bool sync) {
   }
 }
 
+int TCPComm::FlushConnection(const std::string &dst_url) {
+  std::lock_guard<std::mutex> lock(*conn_mutex_);
+  Connection *conn = conn_pool_->FindConnection(dst_url);
+  if (conn == nullptr) {
+    return 0;
+  }
+  conn->flush_pending = false;
+  if (conn->state != ConnectionState::kConnected) {
+    MS_LOG(WARNING) << "Invalid connection state " << conn->state << " to flush the messages to: " << dst_url;
+    return 0;
+  }
+  return conn->Flush();
+}
+
 bool TCPComm::Connect(const std::string &dst_url) {
   std::lock_guard<std::mutex> lock(*conn_mutex_);
 
@@ -430,8 +452,17 @@ bool TCPComm::Disconnect(const std::string &dst_url) {
                   << ", because there are still pending tasks to be executed, please try later.";
     return false;
   }
-  std::lock_guard<std::mutex> lock(*conn_mutex_);
-  conn_pool_->DeleteConnection(dst_url);
+  // The connection is deleted in the receiving event loop, so that a read callback still parsing the messages of the
+  // connection never accesses it after it is freed.
+  auto deleted = std::make_shared<std::promise<void>>();
+  auto future = deleted->get_future();
+  (void)recv_event_loop_->AddTask([dst_url, deleted, this] {
+    std::lock_guard<std::mutex> lock(*conn_mutex_);
+    conn_pool_->DeleteConnection(dst_url);
+    deleted->set_value();
+    return 0;
+  });
+  future.wait();
   return true;
 }
 
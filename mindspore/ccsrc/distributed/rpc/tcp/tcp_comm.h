@@ -71,10 +71,16 @@ class TCPComm {
   // Get the file descriptor of server socket.
   int GetServerFd() const;
 
+  // Get the event loop handling the received messages.
+  EventLoop *recv_event_loop() const { return recv_event_loop_; }
+
  private:
   // Build the connection.
   Connection *CreateDefaultConn(const std::string &to);
 
+  // Send the messages queued in the connection to the destination.
+  int FlushConnection(const std::string &dst_url);
+
   // Send a message.
   static void SendExitMsg(const std::string &from, const std::string &to);
 
@@ -16,6 +16,10 @@
 
 #include "distributed/rpc/tcp/tcp_server.h"
 
+#include <algorithm>
+
+#include "distributed/rpc/tcp/socket_operation.h"
+
 namespace mindspore {
 namespace distributed {
 namespace rpc {
@@ -24,6 +28,14 @@ bool TCPServer::Initialize(const std::string &url) { return InitializeImpl(url);
 bool TCPServer::Initialize() { return InitializeImpl(""); }
 
 void TCPServer::Finalize() {
+  std::vector<std::shared_ptr<ShmChannel>> shm_channels;
+  {
+    std::lock_guard<std::mutex> lock(shm_mutex_);
+    shm_channels.swap(shm_channels_);
+  }
+  for (auto &channel : shm_channels) {
+    channel->Close();
+  }
   if (tcp_comm_ != nullptr) {
     tcp_comm_->Finalize();
     tcp_comm_.reset();
@@ -31,7 +43,14 @@ void TCPServer::Finalize() {
   }
 }
 
-void TCPServer::SetMessageHandler(const MessageHandler &handler) { tcp_comm_->SetMessageHandler(handler); }
+void TCPServer::SetMessageHandler(const MessageHandler &handler) {
+  tcp_comm_->SetMessageHandler([this, handler](MessageBase *const message) -> MessageBase *const {
+    if (message != nullptr && message->name == kShmConnectMsgName) {
+      return AcceptShm(message, handler);
+    }
+    return handler(message);
+  });
+}
 
 std::string TCPServer::GetIP() const { return ip_; }
 
@@ -60,6 +79,44 @@ bool TCPServer::InitializeImpl(const std::string &url) {
     return true;
   }
 }
+
+MessageBase *TCPServer::AcceptShm(MessageBase *const message, const MessageHandler &handler) {
+  std::unique_ptr<MessageBase> request(message);
+  bool success = false;
+  // The from url of the request is the address of the peer socket.
+  auto peer_ip = SocketOperation::GetIP(request->from.Url());
+  if (!IsShmTransportEnabled()) {
+    MS_LOG(INFO) << "Reject the shared memory channel from " << request->from.Url() << " because the transport is off.";
+  } else if (!SocketOperation::IsLocalIP(peer_ip)) {
+    MS_LOG(WARNING) << "Reject the shared memory channel from the remote client " << request->from.Url();
+  } else if (!ShmChannel::IsValidName(request->body)) {
+    MS_LOG(WARNING) << "Reject the invalid shared memory channel name " << request->body << " from "
+                    << request->from.Url();
+  } else {
+    auto channel = std::make_shared<ShmChannel>();
+    success = channel->Open(request->body);
+    if (success) {
+      // The messages from the channel are handled by the same handler and event loop as the TCP messages.
+      channel->Start(handler, tcp_comm_->recv_event_loop());
+      std::lock_guard<std::mutex> lock(shm_mutex_);
+      // Release the channels closed by the clients.
+      (void)shm_channels_.erase(
+        std::remove_if(shm_channels_.begin(), shm_channels_.end(),
+                       [](const std::shared_ptr<ShmChannel> &shm_channel) { return shm_channel->IsClosed(); }),
+        shm_channels_.end());
+      shm_channels_.push_back(channel);
+      MS_LOG(INFO) << "Accept the shared memory channel " << request->body << " from " << request->from.Url();
+    }
+  }
+
+  auto reply = new (std::nothrow) MessageBase();
+  MS_EXCEPTION_IF_NULL(reply);
+  reply->name = kShmConnectMsgName;
+  reply->from = request->to;
+  reply->to = request->from;
+  reply->body = success ? kShmConnectSuccess : kShmConnectFailure;
+  return reply;
+}
 }  // namespace rpc
 }  // namespace distributed
 }  // namespace mindspore
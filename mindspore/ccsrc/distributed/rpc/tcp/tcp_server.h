@@ -19,8 +19,11 @@
 
 #include <string>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include "distributed/rpc/tcp/tcp_comm.h"
+#include "distributed/rpc/shm/shm_channel.h"
 #include "utils/ms_utils.h"
 
 namespace mindspore {
@@ -50,12 +53,20 @@ class TCPServer {
  private:
   bool InitializeImpl(const std::string &url);
 
+  // Open the shared memory channel requested by the client on the same host, and reply whether it succeeds. The
+  // request is rejected if the transport is not enabled, the client is remote or the name is not a channel name.
+  MessageBase *AcceptShm(MessageBase *const message, const MessageHandler &handler);
+
   // The basic TCP communication component used by the server.
   std::unique_ptr<TCPComm> tcp_comm_;
 
   std::string ip_{""};
   uint32_t port_{0};
 
+  // The shared memory channels from the clients on the same host.
+  std::mutex shm_mutex_;
+  std::vector<std::shared_ptr<ShmChannel>> shm_channels_;
+
   DISABLE_COPY_AND_ASSIGN(TCPServer);
 };
 }  // namespace rpc
@@ -120,10 +120,10 @@ int TCPSocketOperation::SendMessage(Connection *connection, struct msghdr *sendM
       } else if (eagainCount == EAGAIN_RETRY) {
         MS_LOG(ERROR) << "Failed to call sendmsg after retry " + std::to_string(EAGAIN_RETRY) + " times and errno is: "
                       << errno;
-        *sendLen = 0;
+        // Keep the number of bytes already sent, the rest of the io vectors is sent by the next call.
         return IO_RW_OK;
       }
-      MS_LOG(ERROR) << "retry(" + std::to_string(eagainCount) + "/" + std::to_string(EAGAIN_RETRY) + ") sending ...";
+      MS_LOG(DEBUG) << "retry(" + std::to_string(eagainCount) + "/" + std::to_string(EAGAIN_RETRY) + ") sending ...";
     } else {
       *sendLen += retval;
 
@@ -15,11 +15,18 @@
  */
 
 #include "fl/compression/decode_executor.h"
+#include "plugin/device/cpu/kernel/nnacl/fp32/add_fp32.h"
+#include "plugin/device/cpu/kernel/nnacl/fp32/mul_fp32.h"
 
 namespace mindspore {
 namespace fl {
 namespace compression {
-std::vector<int> DecodeExecutor::ConstructMaskArray(int seed, float upload_sparse_rate, size_t param_num) {
+namespace {
+// The number of the parameters decoded at one time, which is small enough to be kept in the cache.
+constexpr size_t kDecodeChunkSize = 1024;
+}  // namespace
+
+std::vector<uint8_t> DecodeExecutor::ConstructMaskArray(int seed, float upload_sparse_rate, size_t param_num) {
   static int multiplier = 2147483647;
   static double increment = 4294967294.0;
   static int modulo = 48271;
@@ -28,7 +35,7 @@ std::vector<int> DecodeExecutor::ConstructMaskArray(int seed, float upload_spars
   if (retain_num == 0) {
     MS_LOG(WARNING) << "The retain_num is 0, and upload_sparse_rate is too small.";
   }
-  std::vector<int> mask_array(param_num, 0);
+  std::vector<uint8_t> mask_array(param_num, 0);
   for (size_t i = 0; i < retain_num; ++i) {
     mask_array[i] = 1;
   }
@@ -40,99 +47,158 @@ std::vector<int> DecodeExecutor::ConstructMaskArray(int seed, float upload_spars
     // update seed
     seed = (seed * modulo) % multiplier;
     size_t j = size_t(rand * static_cast<double>(param_num - i)) + i;
-    int temp = mask_array[i];
+    uint8_t temp = mask_array[i];
     mask_array[i] = mask_array[j];
     mask_array[j] = temp;
   }
   return mask_array;
 }
 
-bool DecodeExecutor::DeQuantSparseDiff(std::map<std::string, std::vector<float>> *weight_map,
+std::shared_ptr<const std::vector<uint8_t>> DecodeExecutor::GetMaskArray(int seed, float upload_sparse_rate,
+                                                                         size_t param_num) {
+  std::unique_lock<std::mutex> lock(mask_array_mutex_);
+  if (mask_array_ == nullptr || mask_seed_ != seed || mask_upload_sparse_rate_ != upload_sparse_rate ||
+      mask_param_num_ != param_num) {
+    mask_array_ = std::make_shared<const std::vector<uint8_t>>(ConstructMaskArray(seed, upload_sparse_rate, param_num));
+    mask_seed_ = seed;
+    mask_upload_sparse_rate_ = upload_sparse_rate;
+    mask_param_num_ = param_num;
+  }
+  return mask_array_;
+}
+
+bool DecodeExecutor::DeQuantSparseDiff(std::map<std::string, server::AccumulateFunc> *accumulate_funcs,
                                        const std::vector<CompressFeatureMap> &compress_feature_maps, size_t num_bits,
                                        float upload_sparse_rate, int seed, const std::vector<std::string> &name_vec,
                                        size_t data_size) {
-  std::vector<std::vector<float>> decompress_feature_maps;
-
   // origin parameters
-  std::vector<size_t> shape_vec;
-  size_t param_num = 0;
   const auto &iter_to_model = mindspore::fl::server::ModelStore::GetInstance().iteration_to_model();
+  if (iter_to_model.empty()) {
+    MS_LOG(WARNING) << "There is no model to decode the parameter difference against.";
+    return false;
+  }
   size_t latest_iter_num = iter_to_model.rbegin()->first;
   std::map<std::string, AddressPtr> feature_maps =
     mindspore::fl::server::ModelStore::GetInstance().GetModelByIterNum(latest_iter_num);
+  return DeQuantSparseDiff(accumulate_funcs, feature_maps, compress_feature_maps, num_bits, upload_sparse_rate, seed,
+                           name_vec, data_size);
+}
+
+bool DecodeExecutor::DeQuantSparseDiff(std::map<std::string, server::AccumulateFunc> *accumulate_funcs,
+                                       const std::map<std::string, AddressPtr> &last_model,
+                                       const std::vector<CompressFeatureMap> &compress_feature_maps, size_t num_bits,
+                                       float upload_sparse_rate, int seed, const std::vector<std::string> &name_vec,
+                                       size_t data_size) {
+  MS_ERROR_IF_NULL_W_RET_VAL(accumulate_funcs, false);
+  std::vector<size_t> shape_vec;
+  size_t param_num = 0;
   // get shape vector and number of upload parameters
   for (const auto &name : name_vec) {
-    size_t shape = feature_maps[name]->size / sizeof(float);
+    auto iter = last_model.find(name);
+    if (iter == last_model.end() || iter->second == nullptr || iter->second->addr == nullptr) {
+      MS_LOG(WARNING) << "The weight " << name << " is not in the model.";
+      return false;
+    }
+    size_t shape = iter->second->size / sizeof(float);
     shape_vec.emplace_back(shape);
     param_num += shape;
   }
   MS_LOG(DEBUG) << "Compression get last weights success!";
 
-  // quant decode
+  // The quantized data of all the weights is one stream, each segment of which has its own min and max value.
+  struct QuantSegment {
+    size_t begin;
+    size_t end;
+    const int8_t *data;
+    float min_val;
+    float scale_val;
+  };
   auto temp1 = static_cast<float>(1 << num_bits) - 1.0f;
   auto temp2 = static_cast<float>(1 << (num_bits - 1));
-  std::vector<float> de_min_max_feature_map;
-  for (auto compress_feature_map : compress_feature_maps) {
+  auto segments = std::make_shared<std::vector<QuantSegment>>();
+  size_t quant_num = 0;
+  for (const auto &compress_feature_map : compress_feature_maps) {
     float min_val = compress_feature_map.min_val;
     float max_val = compress_feature_map.max_val;
     float scale_val = static_cast<float>(max_val - min_val) / temp1 + 1e-10f;
-    size_t size = compress_feature_map.compress_data.size();
-    for (size_t i = 0; i < size; ++i) {
-      de_min_max_feature_map.emplace_back(
-        (static_cast<float>(compress_feature_map.compress_data[i]) + temp2) * scale_val + min_val);
+    size_t size = compress_feature_map.compress_data_size;
+    if (size == 0) {
+      continue;
     }
+    MS_ERROR_IF_NULL_W_RET_VAL(compress_feature_map.compress_data, false);
+    segments->push_back({quant_num, quant_num + size, compress_feature_map.compress_data, min_val, scale_val});
+    quant_num += size;
   }
-  MS_LOG(DEBUG) << "Compression quant decode success!";
 
-  // sparse decode
-  std::vector<int> mask_array = ConstructMaskArray(seed, upload_sparse_rate, param_num);
+  // The start of each weight in the quantized stream is the number of the retained parameters before it.
+  auto mask_array = GetMaskArray(seed, upload_sparse_rate, param_num);
+  std::vector<size_t> quant_starts;
+  size_t retain_num = 0;
   size_t index = 0;
-  size_t de_min_max_feature_map_index = 0;
   for (const auto &shape : shape_vec) {
-    std::vector<float> feature_map(shape);
-    for (size_t i = 0; i < shape; ++i) {
-      if (index >= mask_array.size()) {
-        MS_LOG(WARNING) << "The mask_array and parameter shape is not matched.";
+    quant_starts.push_back(retain_num);
+    retain_num += static_cast<size_t>(std::count(mask_array->begin() + index, mask_array->begin() + index + shape, 1));
+    index += shape;
+  }
+  if (retain_num > quant_num) {
+    MS_LOG(WARNING) << "The number of upload parameters is too small.";
+    return false;
+  }
+
+  size_t global_start = 0;
+  for (size_t i = 0; i < name_vec.size(); ++i) {
+    const std::string &name = name_vec[i];
+    size_t shape = shape_vec[i];
+    size_t quant_start = quant_starts[i];
+    AddressPtr last_weight = last_model.at(name);
+    (*accumulate_funcs)[name] = [=](float *accum, size_t accum_num) -> bool {
+      if (accum == nullptr || accum_num != shape) {
+        MS_LOG(WARNING) << "The shape of weight " << name << " is " << shape << ", but the accumulator is "
+                        << accum_num;
         return false;
       }
-      if (mask_array[index] == 1) {
-        if (de_min_max_feature_map_index >= de_min_max_feature_map.size()) {
-          MS_LOG(WARNING) << "The number of upload parameters is too small.";
-          return false;
+      const float *last_weight_data = reinterpret_cast<const float *>(last_weight->addr);
+      const uint8_t *mask = mask_array->data() + global_start;
+      auto segment = std::upper_bound(segments->begin(), segments->end(), quant_start,
+                                      [](size_t pos, const QuantSegment &seg) { return pos < seg.end; });
+      size_t quant_index = quant_start;
+      float weight_scale = static_cast<float>(data_size);
+      ArithmeticParameter param{};
+      param.in_elements_num0_ = 1;
+      float buffer[kDecodeChunkSize];
+      for (size_t begin = 0; begin < shape; begin += kDecodeChunkSize) {
+        size_t num = std::min(kDecodeChunkSize, shape - begin);
+        // difference decode
+        (void)ElementOptMul(&weight_scale, last_weight_data + begin, buffer, SizeToInt(num), &param);
+        // sparse and quant decode
+        for (size_t j = 0; j < num; ++j) {
+          if (mask[begin + j] == 0) {
+            continue;
+          }
+          while (quant_index >= segment->end) {
+            ++segment;
+          }
+          buffer[j] += (static_cast<float>(segment->data[quant_index - segment->begin]) + temp2) * segment->scale_val +
+                       segment->min_val;
+          ++quant_index;
         }
-        feature_map[i] = de_min_max_feature_map[de_min_max_feature_map_index];
-        de_min_max_feature_map_index += 1;
-      } else {
-        feature_map[i] = 0.0f;
+        (void)ElementAdd(accum + begin, buffer, accum + begin, SizeToInt(num));
       }
-      index += 1;
-    }
-    decompress_feature_maps.emplace_back(feature_map);
-  }
-  MS_LOG(DEBUG) << "Compression sparse decode success!";
-
-  // difference decode
-  for (size_t i = 0; i < decompress_feature_maps.size(); ++i) {
-    size_t feature_size = decompress_feature_maps[i].size();
-    std::string name = name_vec[i];
-    float *weight_data = reinterpret_cast<float *>(feature_maps[name]->addr);
-    auto &weight_item = (*weight_map)[name];
-    weight_item.resize(feature_size);
-    for (size_t j = 0; j < feature_size; ++j) {
-      weight_item[j] = decompress_feature_maps[i][j] + data_size * weight_data[j];
-    }
+      return true;
+    };
+    global_start += shape;
   }
-  MS_LOG(DEBUG) << "Compression difference decode success!";
-
+  MS_LOG(DEBUG) << "Compression decode functions are constructed!";
   return true;
 }
 
-bool DecodeExecutor::Decode(std::map<std::string, std::vector<float>> *weight_map,
+bool DecodeExecutor::Decode(std::map<std::string, server::AccumulateFunc> *accumulate_funcs,
                             const std::vector<CompressFeatureMap> &compress_feature_maps,
                             schema::CompressType upload_compress_type, float upload_sparse_rate, int seed,
                             const std::vector<std::string> &name_vec, size_t data_size) {
   if (upload_compress_type == schema::CompressType_DIFF_SPARSE_QUANT) {
-    return DeQuantSparseDiff(weight_map, compress_feature_maps, 8, upload_sparse_rate, seed, name_vec, data_size);
+    return DeQuantSparseDiff(accumulate_funcs, compress_feature_maps, 8, upload_sparse_rate, seed, name_vec,
+                             data_size);
   }
   return false;
 }
@@ -28,6 +28,7 @@
 #include <regex>
 #include <map>
 #include <utility>
+#include <mutex>
 #include "schema/fl_job_generated.h"
 #include "schema/cipher_generated.h"
 #include "fl/server/model_store.h"
@@ -37,9 +38,11 @@
 namespace mindspore {
 namespace fl {
 namespace compression {
+// The compressed data points to the memory of the request, so it's valid only when the request is being handled.
 struct CompressFeatureMap {
   std::string weight_fullname;
-  std::vector<int8_t> compress_data;
+  const int8_t *compress_data{nullptr};
+  size_t compress_data_size{0};
   float min_val;
   float max_val;
 };
@@ -52,20 +55,39 @@ class DecodeExecutor {
   }
 
   // construct mask array for random sparse
-  std::vector<int> ConstructMaskArray(int seed, float upload_sparse_rate, size_t param_num);
+  std::vector<uint8_t> ConstructMaskArray(int seed, float upload_sparse_rate, size_t param_num);
 
-  // decode min_max quantization and random sparse and parameter difference
-  bool DeQuantSparseDiff(std::map<std::string, std::vector<float>> *weight_map,
+  // decode min_max quantization and random sparse and parameter difference. The weights are not materialized: the
+  // accumulate function of each weight decodes it chunk by chunk and adds it to the accumulator of the aggregation.
+  bool DeQuantSparseDiff(std::map<std::string, server::AccumulateFunc> *accumulate_funcs,
+                         const std::vector<CompressFeatureMap> &compress_feature_maps, size_t num_bits,
+                         float upload_sparse_rate, int seed, const std::vector<std::string> &name_vec,
+                         size_t data_size);
+
+  // The same as above, but the difference is decoded against last_model instead of the latest model in ModelStore.
+  // The weights of last_model have to stay valid as long as the accumulate functions are called.
+  bool DeQuantSparseDiff(std::map<std::string, server::AccumulateFunc> *accumulate_funcs,
+                         const std::map<std::string, AddressPtr> &last_model,
                          const std::vector<CompressFeatureMap> &compress_feature_maps, size_t num_bits,
                          float upload_sparse_rate, int seed, const std::vector<std::string> &name_vec,
                          size_t data_size);
 
   // decode
-  bool Decode(std::map<std::string, std::vector<float>> *weight_map,
+  bool Decode(std::map<std::string, server::AccumulateFunc> *accumulate_funcs,
               const std::vector<CompressFeatureMap> &compress_feature_maps, schema::CompressType upload_compress_type,
               float upload_sparse_rate, int seed, const std::vector<std::string> &name_vec, size_t data_size);
 
   schema::CompressType GetCompressType(schema::CompressType upload_compress_type);
+
+ private:
+  // The seed of the mask array is the iteration number, so all the clients of one iteration share the same mask array.
+  std::shared_ptr<const std::vector<uint8_t>> GetMaskArray(int seed, float upload_sparse_rate, size_t param_num);
+
+  std::mutex mask_array_mutex_;
+  std::shared_ptr<const std::vector<uint8_t>> mask_array_;
+  int mask_seed_{0};
+  float mask_upload_sparse_rate_{0};
+  size_t mask_param_num_{0};
 };
 }  // namespace compression
 }  // namespace fl
@@ -121,6 +121,11 @@ using ReuseKernelNodeInfo = std::map<std::string, size_t>;
 // related logic is done.
 using UploadData = std::map<std::string, Address>;
 
+// AccumulateFunc adds the weight uploaded by a worker to the accumulation buffer whose element number is accum_num. The
+// compressed weight is decoded inside the function so it is never materialized. Returns false without modifying the
+// buffer if the uploaded weight doesn't match the buffer.
+using AccumulateFunc = std::function<bool(float *accum, size_t accum_num)>;
+
 constexpr auto kWeight = "weight";
 constexpr auto kNewWeight = "new_weight";
 constexpr auto kAccumulation = "accum";
@@ -92,6 +92,41 @@ bool Executor::HandleModelUpdate(const std::string &param_name, const UploadData
   return true;
 }
 
+bool Executor::HandleModelUpdate(const std::string &param_name, const AccumulateFunc &accumulate_func,
+                                 size_t data_size) {
+  MS_LOG(DEBUG) << "Do UpdateModel for parameter " << param_name;
+  // The param_aggrs_ is not modified during the iteration, so it could be read without the lock.
+  auto iter = param_aggrs_.find(param_name);
+  if (iter == param_aggrs_.end()) {
+    MS_LOG(WARNING) << "Parameter " << param_name << " is not registered in server.";
+    return true;
+  }
+  auto &param_aggr = iter->second;
+  MS_ERROR_IF_NULL_W_RET_VAL(param_aggr, false);
+  if (param_aggr->SupportAccumulate()) {
+    if (!param_aggr->LaunchAggregators(accumulate_func, data_size)) {
+      MS_LOG(ERROR) << "Launching aggregators for parameter " << param_name << " failed.";
+      return false;
+    }
+    return true;
+  }
+
+  // The aggregation kernels don't support the accumulation, so the uploaded data is materialized for them.
+  AddressPtr weight = param_aggr->GetWeight();
+  MS_ERROR_IF_NULL_W_RET_VAL(weight, false);
+  std::vector<float> new_weight(weight->size / sizeof(float), 0.0f);
+  if (!accumulate_func(new_weight.data(), new_weight.size())) {
+    MS_LOG(ERROR) << "Decoding the uploaded data for parameter " << param_name << " failed.";
+    return false;
+  }
+  UploadData upload_data;
+  upload_data[kNewWeight].addr = new_weight.data();
+  upload_data[kNewWeight].size = new_weight.size() * sizeof(float);
+  upload_data[kNewDataSize].addr = &data_size;
+  upload_data[kNewDataSize].size = sizeof(size_t);
+  return HandleModelUpdate(param_name, upload_data);
+}
+
 bool Executor::HandlePushWeight(const std::map<std::string, Address> &feature_map) {
   for (const auto &trainable_param : feature_map) {
     const std::string &param_name = trainable_param.first;
@@ -57,6 +57,10 @@ class Executor {
   // Called in federated learning training mode. Update value for parameter param_name.
   bool HandleModelUpdate(const std::string &param_name, const UploadData &upload_data);
 
+  // Called in federated learning training mode. The data uploaded for parameter param_name is added to the weight by the
+  // accumulate_func, which is called concurrently if the aggregation kernels support it.
+  bool HandleModelUpdate(const std::string &param_name, const AccumulateFunc &accumulate_func, size_t data_size);
+
   // Forcibly overwrite specific weights in overwriteWeights message.
   bool HandlePushWeight(const std::map<std::string, Address> &feature_map);
 
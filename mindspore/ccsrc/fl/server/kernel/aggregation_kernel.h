@@ -47,6 +47,11 @@ class AggregationKernelMod : public DeprecatedNativeCpuKernelMod {
   }
   virtual bool AllReduce() = 0;
 
+  // The kernels supporting LaunchAccumulate add the data uploaded by the workers through the AccumulateFunc. It could be
+  // called concurrently without the lock of the ParameterAggregator or copying the uploaded data.
+  virtual bool SupportAccumulate() const { return false; }
+  virtual bool LaunchAccumulate(const AccumulateFunc &accumulate_func, size_t data_size) { return false; }
+
   // Server kernel's memory allocation method, which is different from the workflow in
   // Session(GPUSession/CPUSession/AscendSession).
   // virtual void AssignMemory(const CNodePtr &kernel_node, std::shared_ptr<MemoryRegister> memory_register) = 0;
@@ -15,11 +15,51 @@
  */
 
 #include "fl/server/kernel/fed_avg_kernel.h"
+#include "include/common/thread_pool.h"
+#include "plugin/device/cpu/kernel/nnacl/fp32/mul_fp32.h"
 
 namespace mindspore {
 namespace fl {
 namespace server {
 namespace kernel {
+namespace {
+// The min data number processed by each thread.
+constexpr size_t kMinDataNumPerThread = 16 << 10;
+
+void ParallelRun(size_t data_num, const std::function<void(size_t, size_t)> &task) {
+  auto &thread_pool = common::ThreadPool::GetInstance();
+  size_t thread_num = std::min(thread_pool.GetSyncRunThreadNum(), data_num / kMinDataNumPerThread);
+  if (thread_num <= 1) {
+    task(0, data_num);
+    return;
+  }
+  size_t task_size = (data_num + thread_num - 1) / thread_num;
+  std::vector<common::Task> tasks;
+  for (size_t begin = 0; begin < data_num; begin += task_size) {
+    size_t size = std::min(task_size, data_num - begin);
+    (void)tasks.emplace_back([&task, begin, size]() {
+      task(begin, size);
+      return common::SUCCESS;
+    });
+  }
+  (void)thread_pool.SyncRun(tasks);
+}
+}  // namespace
+
+void ParallelAdd(float *dst, const float *src, size_t data_num) {
+  ParallelRun(data_num, [dst, src](size_t begin, size_t size) {
+    (void)ElementAdd(dst + begin, src + begin, dst + begin, SizeToInt(size));
+  });
+}
+
+void ParallelScale(float *data, float scale, size_t data_num) {
+  ArithmeticParameter param{};
+  param.in_elements_num0_ = 1;
+  ParallelRun(data_num, [data, scale, &param](size_t begin, size_t size) {
+    (void)ElementOptMul(&scale, data + begin, data + begin, SizeToInt(size), &param);
+  });
+}
+
 REG_AGGREGATION_KERNEL_TWO(FedAvg,
                            ParamsInfo()
                              .AddInputNameType(kWeight, kNumberTypeFloat32)
@@ -17,11 +17,15 @@
 #ifndef MINDSPORE_CCSRC_FL_SERVER_KERNEL_FED_AVG_KERNEL_H_
 #define MINDSPORE_CCSRC_FL_SERVER_KERNEL_FED_AVG_KERNEL_H_
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 #include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
 #include "plugin/device/cpu/kernel/cpu_kernel.h"
 #include "fl/server/common.h"
 #include "fl/server/collective_ops_impl.h"
@@ -29,17 +33,28 @@
 #include "fl/server/local_meta_store.h"
 #include "fl/server/kernel/aggregation_kernel.h"
 #include "fl/server/kernel/aggregation_kernel_factory.h"
+#include "plugin/device/cpu/kernel/nnacl/fp32/add_fp32.h"
 
 namespace mindspore {
 namespace fl {
 namespace server {
 namespace kernel {
 constexpr size_t kFedAvgInputsNum = 4;
+
+// Add src to dst by the simd instructions. The data is split to the threads of the common thread pool if it's large.
+void ParallelAdd(float *dst, const float *src, size_t data_num);
+
+// Multiply the data by the scale in the same way as ParallelAdd.
+void ParallelScale(float *data, float scale, size_t data_num);
+
 // The implementation for the federated average. We do weighted average for the weights. The uploaded weights from
 // FL-clients is already multiplied by its data size so only sum and division are done in this kernel.
 
 // Pay attention that this kernel is the distributed version of federated average, which means each server node in the
 // cluster in invalved in the aggragation process. So the DistributedCountService and CollectiveOpsImpl are called.
+
+// The uploads of the workers are accumulated concurrently: each accumulation takes an idle partial accumulator, so only
+// taking and returning the accumulator are locked. The partial accumulators are merged into the weight in AllReduce.
 template <typename T, typename S>
 class FedAvgKernel : public AggregationKernelMod {
  public:
@@ -97,6 +112,7 @@ class FedAvgKernel : public AggregationKernelMod {
     T *weight_addr = reinterpret_cast<T *>(weight_addr_->addr);
     size_t weight_size = weight_addr_->size;
     S *data_size_addr = reinterpret_cast<S *>(data_size_addr_->addr);
+    MergeAccumulators(weight_addr, weight_size / sizeof(T), data_size_addr);
     if (!CollectiveOpsImpl::GetInstance().AllReduce<T>(name_, weight_addr, weight_addr, weight_size / sizeof(T))) {
       MS_LOG(ERROR) << "Federated average allreduce failed.";
       return false;
@@ -110,8 +126,12 @@ class FedAvgKernel : public AggregationKernelMod {
       return false;
     }
     LocalMetaStore::GetInstance().put_value(kCtxFedAvgTotalDataSize, data_size_addr[0]);
-    for (size_t i = 0; i < weight_size / sizeof(T); i++) {
-      weight_addr[i] /= data_size_addr[0];
+    if constexpr (std::is_same<T, float>::value) {
+      ParallelScale(weight_addr, 1.0f / static_cast<float>(data_size_addr[0]), weight_size / sizeof(T));
+    } else {
+      for (size_t i = 0; i < weight_size / sizeof(T); i++) {
+        weight_addr[i] /= data_size_addr[0];
+      }
     }
     done_ = true;
     return true;
@@ -127,32 +147,65 @@ class FedAvgKernel : public AggregationKernelMod {
       MS_ERROR_IF_NULL_W_RET_VAL(inputs[i]->addr, false);
     }
 
-    std::unique_lock<std::mutex> lock(weight_mutex_);
-    if (done_) {
-      MS_LOG(INFO) << "AllReduce for " << name_ << " has finished";
-      return true;
-    }
     // The weight and new_weight values should be multiplied by clients already, so we don't need to do multiplication
     // again.
-    T *weight_addr = reinterpret_cast<T *>(inputs[0]->addr);
-    S *data_size_addr = reinterpret_cast<S *>(inputs[1]->addr);
     T *new_weight_addr = reinterpret_cast<T *>(inputs[2]->addr);
     S *new_data_size_addr = reinterpret_cast<S *>(inputs[3]->addr);
-
+    size_t new_weight_num = inputs[2]->size / sizeof(T);
     MS_LOG(DEBUG) << "Iteration: " << LocalMetaStore::GetInstance().curr_iter_num() << " launching FedAvgKernel for "
-                  << name_ << " new data size is " << new_data_size_addr[0] << ", current total data size is "
-                  << data_size_addr[0];
-    for (size_t i = 0; i < inputs[2]->size / sizeof(T); i++) {
-      weight_addr[i] += new_weight_addr[i];
-    }
-    data_size_addr[0] += new_data_size_addr[0];
-    lock.unlock();
+                  << name_ << " new data size is " << new_data_size_addr[0];
 
-    accum_count_++;
+    PartialAccumulator *accumulator = AcquireAccumulator();
+    if (accumulator == nullptr) {
+      MS_LOG(INFO) << "AllReduce for " << name_ << " has finished";
+      return true;
+    }
+    if (new_weight_num != accumulator->weight.size()) {
+      MS_LOG(ERROR) << "The uploaded weight number " << new_weight_num << " of " << name_
+                    << " doesn't match the weight number " << accumulator->weight.size();
+      ReleaseAccumulator(accumulator, false);
+      return false;
+    }
+    if constexpr (std::is_same<T, float>::value) {
+      (void)ElementAdd(accumulator->weight.data(), new_weight_addr, accumulator->weight.data(),
+                       SizeToInt(new_weight_num));
+    } else {
+      for (size_t i = 0; i < new_weight_num; i++) {
+        accumulator->weight[i] += new_weight_addr[i];
+      }
+    }
+    accumulator->data_size += new_data_size_addr[0];
+    ReleaseAccumulator(accumulator, true);
     return true;
   }
 
+  bool SupportAccumulate() const override { return std::is_same<T, float>::value; }
+
+  bool LaunchAccumulate(const AccumulateFunc &accumulate_func, size_t data_size) override {
+    if constexpr (std::is_same<T, float>::value) {
+      PartialAccumulator *accumulator = AcquireAccumulator();
+      if (accumulator == nullptr) {
+        MS_LOG(INFO) << "AllReduce for " << name_ << " has finished";
+        return true;
+      }
+      bool ret = accumulate_func(accumulator->weight.data(), accumulator->weight.size());
+      if (ret) {
+        accumulator->data_size += static_cast<S>(data_size);
+      }
+      ReleaseAccumulator(accumulator, ret);
+      return ret;
+    } else {
+      return false;
+    }
+  }
+
   void Reset() override {
+    std::unique_lock<std::mutex> lock(accumulator_mutex_);
+    accumulator_cond_.wait(lock, [this]() { return idle_accumulators_.size() == accumulators_.size(); });
+    for (auto &accumulator : accumulators_) {
+      ClearAccumulator(accumulator.get());
+    }
+    accumulation_closed_ = false;
     accum_count_ = 0;
     done_ = false;
     ClearWeightAndDataSize();
@@ -173,6 +226,30 @@ class FedAvgKernel : public AggregationKernelMod {
     return true;
   }
 
+ protected:
+  // Wait for the accumulations in flight and add the partial accumulators to the weight and data size. The later
+  // accumulations of this round are dropped. This is the local part of AllReduce, it needs no other server.
+  void MergeAccumulators(T *weight_addr, size_t weight_num, S *data_size_addr) {
+    std::unique_lock<std::mutex> lock(accumulator_mutex_);
+    accumulator_cond_.wait(lock, [this]() { return idle_accumulators_.size() == accumulators_.size(); });
+    accumulation_closed_ = true;
+    for (auto &accumulator : accumulators_) {
+      if (!accumulator->dirty) {
+        continue;
+      }
+      size_t merge_num = std::min(weight_num, accumulator->weight.size());
+      if constexpr (std::is_same<T, float>::value) {
+        ParallelAdd(weight_addr, accumulator->weight.data(), merge_num);
+      } else {
+        for (size_t i = 0; i < merge_num; i++) {
+          weight_addr[i] += accumulator->weight[i];
+        }
+      }
+      data_size_addr[0] += accumulator->data_size;
+      ClearAccumulator(accumulator.get());
+    }
+  }
+
  private:
   void GenerateReuseKernelNodeInfo() override {
     MS_LOG(INFO) << "FedAvg reuse 'weight' of the kernel node.";
@@ -181,6 +258,51 @@ class FedAvgKernel : public AggregationKernelMod {
     return;
   }
 
+  // The partial sum of the weights and data sizes uploaded by the workers.
+  struct PartialAccumulator {
+    std::vector<T> weight;
+    S data_size{0};
+    bool dirty{false};
+  };
+
+  // Take an idle partial accumulator, or return nullptr if the accumulation of this round is closed.
+  PartialAccumulator *AcquireAccumulator() {
+    std::unique_lock<std::mutex> lock(accumulator_mutex_);
+    if (done_ || accumulation_closed_ || weight_addr_ == nullptr) {
+      return nullptr;
+    }
+    if (idle_accumulators_.empty()) {
+      auto accumulator = std::make_unique<PartialAccumulator>();
+      accumulator->weight.resize(weight_addr_->size / sizeof(T), 0);
+      idle_accumulators_.push_back(accumulator.get());
+      accumulators_.push_back(std::move(accumulator));
+    }
+    PartialAccumulator *accumulator = idle_accumulators_.back();
+    idle_accumulators_.pop_back();
+    accumulator->dirty = true;
+    return accumulator;
+  }
+
+  // Return the accumulator taken by AcquireAccumulator, only the successful accumulation is counted. The failed
+  // accumulation doesn't modify the accumulator.
+  void ReleaseAccumulator(PartialAccumulator *accumulator, bool accumulated) {
+    std::unique_lock<std::mutex> lock(accumulator_mutex_);
+    idle_accumulators_.push_back(accumulator);
+    if (accumulated) {
+      accum_count_++;
+    }
+    accumulator_cond_.notify_all();
+  }
+
+  void ClearAccumulator(PartialAccumulator *accumulator) {
+    if (!accumulator->dirty) {
+      return;
+    }
+    std::fill(accumulator->weight.begin(), accumulator->weight.end(), static_cast<T>(0));
+    accumulator->data_size = 0;
+    accumulator->dirty = false;
+  }
+
   // In some cases, the Launch method is not called and the weights involved in AllReduce should be set to 0.
   void ClearWeightAndDataSize() {
     MS_ERROR_IF_NULL_WO_RET_VAL(weight_addr_);
@@ -210,6 +332,14 @@ class FedAvgKernel : public AggregationKernelMod {
   AddressPtr new_data_size_addr_;
   // The kernel could be called concurrently so we need lock to ensure threadsafe.
   std::mutex weight_mutex_;
+
+  // The partial accumulators are created on demand, so their number is the max number of concurrent accumulations.
+  std::vector<std::unique_ptr<PartialAccumulator>> accumulators_;
+  std::vector<PartialAccumulator *> idle_accumulators_;
+  // Whether the partial accumulators have been merged into the weight in this round.
+  bool accumulation_closed_{false};
+  std::mutex accumulator_mutex_;
+  std::condition_variable accumulator_cond_;
 };
 }  // namespace kernel
 }  // namespace server
@@ -20,6 +20,7 @@
 #include <vector>
 #include <utility>
 #include "fl/server/kernel/round/update_model_kernel.h"
+#include "plugin/device/cpu/kernel/nnacl/fp32/add_fp32.h"
 
 namespace mindspore {
 namespace fl {
@@ -342,13 +343,13 @@ ResultCode UpdateModelKernel::UpdateModel(const schema::RequestUpdateModel *upda
   size_t data_size = device_meta.data_size();
 
   std::map<std::string, std::vector<float>> weight_map;
-  std::map<std::string, UploadData> feature_map;
+  std::map<std::string, AccumulateFunc> feature_map;
   if (ps::PSContext::instance()->encrypt_type() == ps::kDSEncryptType) {
-    feature_map = ParseSignDSFeatureMap(update_model_req, data_size, &weight_map);
+    feature_map = ToAccumulateFuncs(ParseSignDSFeatureMap(update_model_req, data_size, &weight_map));
   } else if (ps::PSContext::instance()->upload_compress_type() == kDiffSparseQuant) {
-    feature_map = ParseUploadCompressFeatureMap(update_model_req, data_size, &weight_map);
+    feature_map = ParseUploadCompressFeatureMap(update_model_req, data_size);
   } else {
-    feature_map = ParseFeatureMap(update_model_req);
+    feature_map = ToAccumulateFuncs(ParseFeatureMap(update_model_req));
   }
 
   if (feature_map.empty()) {
@@ -358,10 +359,8 @@ ResultCode UpdateModelKernel::UpdateModel(const schema::RequestUpdateModel *upda
     return ResultCode::kFail;
   }
 
-  for (auto weight : feature_map) {
-    weight.second[kNewDataSize].addr = &data_size;
-    weight.second[kNewDataSize].size = sizeof(size_t);
-    if (!executor_->HandleModelUpdate(weight.first, weight.second)) {
+  for (const auto &weight : feature_map) {
+    if (!executor_->HandleModelUpdate(weight.first, weight.second, data_size)) {
       std::string reason = "Updating weight " + weight.first + " failed for fl id " + update_model_fl_id;
       BuildUpdateModelRsp(
         fbb, schema::ResponseCode_OutOfTime, reason,
@@ -405,6 +404,30 @@ std::map<std::string, UploadData> UpdateModelKernel::ParseFeatureMap(
   return feature_map;
 }
 
+std::map<std::string, AccumulateFunc> UpdateModelKernel::ToAccumulateFuncs(
+  const std::map<std::string, UploadData> &feature_map) {
+  std::map<std::string, AccumulateFunc> accumulate_funcs;
+  for (const auto &weight : feature_map) {
+    auto iter = weight.second.find(kNewWeight);
+    if (iter == weight.second.end()) {
+      continue;
+    }
+    const std::string &weight_full_name = weight.first;
+    const float *weight_data = reinterpret_cast<const float *>(iter->second.addr);
+    size_t weight_num = iter->second.size / sizeof(float);
+    accumulate_funcs[weight_full_name] = [weight_full_name, weight_data, weight_num](float *accum, size_t accum_num) {
+      if (accum == nullptr || weight_data == nullptr || accum_num != weight_num) {
+        MS_LOG(WARNING) << "The size of weight " << weight_full_name << " is " << weight_num
+                        << ", but the accumulator is " << accum_num;
+        return false;
+      }
+      (void)ElementAdd(accum, weight_data, accum, SizeToInt(weight_num));
+      return true;
+    };
+  }
+  return accumulate_funcs;
+}
+
 std::map<std::string, UploadData> UpdateModelKernel::ParseSignDSFeatureMap(
   const schema::RequestUpdateModel *update_model_req, size_t data_size,
   std::map<std::string, std::vector<float>> *weight_map) {
@@ -449,38 +472,24 @@ std::map<std::string, UploadData> UpdateModelKernel::ParseSignDSFeatureMap(
   return feature_map;
 }
 
-std::map<std::string, UploadData> UpdateModelKernel::ParseUploadCompressFeatureMap(
-  const schema::RequestUpdateModel *update_model_req, size_t data_size,
-  std::map<std::string, std::vector<float>> *weight_map) {
-  std::map<std::string, UploadData> feature_map;
+std::map<std::string, AccumulateFunc> UpdateModelKernel::ParseUploadCompressFeatureMap(
+  const schema::RequestUpdateModel *update_model_req, size_t data_size) {
   schema::CompressType upload_compress_type = update_model_req->upload_compress_type();
   upload_compress_type =
     mindspore::fl::compression::DecodeExecutor::GetInstance().GetCompressType(upload_compress_type);
   MS_LOG(DEBUG) << "This schema upload compress type is: " << upload_compress_type;
   if (upload_compress_type != schema::CompressType_NO_COMPRESS) {
     MS_LOG(DEBUG) << "This upload compress type is DIFF_SPARSE_QUANT.";
-    feature_map = DecodeFeatureMap(weight_map, update_model_req, upload_compress_type, data_size);
-    return feature_map;
+    return DecodeFeatureMap(update_model_req, upload_compress_type, data_size);
   }
   MS_LOG(DEBUG) << "This upload compress type is NO_COMPRESS.";
   // Some clients upload origin weights.
-  auto fbs_feature_map = update_model_req->feature_map();
-  for (uint32_t i = 0; i < fbs_feature_map->size(); i++) {
-    std::string weight_full_name = fbs_feature_map->Get(i)->weight_fullname()->str();
-    float *weight_data = const_cast<float *>(fbs_feature_map->Get(i)->data()->data());
-    size_t weight_size = fbs_feature_map->Get(i)->data()->size() * sizeof(float);
-    UploadData upload_data;
-    upload_data[kNewWeight].addr = weight_data;
-    upload_data[kNewWeight].size = weight_size;
-    feature_map[weight_full_name] = upload_data;
-  }
-  return feature_map;
+  return ToAccumulateFuncs(ParseFeatureMap(update_model_req));
 }
 
-std::map<std::string, UploadData> UpdateModelKernel::DecodeFeatureMap(
-  std::map<std::string, std::vector<float>> *weight_map, const schema::RequestUpdateModel *update_model_req,
-  schema::CompressType upload_compress_type, size_t data_size) {
-  std::map<std::string, UploadData> feature_map;
+std::map<std::string, AccumulateFunc> UpdateModelKernel::DecodeFeatureMap(
+  const schema::RequestUpdateModel *update_model_req, schema::CompressType upload_compress_type, size_t data_size) {
+  std::map<std::string, AccumulateFunc> feature_map;
 
   // Get and set decode hyper parameters.
   auto seed = update_model_req->iteration();
@@ -494,17 +503,14 @@ std::map<std::string, UploadData> UpdateModelKernel::DecodeFeatureMap(
     name_vec.emplace_back(fbs_name_vec->Get(i)->str());
   }
 
-  // Parameter process for decode.
+  // Parameter process for decode. The compressed data is decoded from the request when it's accumulated.
   auto fbs_compress_feature_map = update_model_req->compress_feature_map();
   std::vector<mindspore::fl::compression::CompressFeatureMap> compress_feature_maps;
   for (size_t i = 0; i < fbs_compress_feature_map->size(); ++i) {
     mindspore::fl::compression::CompressFeatureMap compress_feature_map;
-    int8_t *compress_weight_data = const_cast<int8_t *>(fbs_compress_feature_map->Get(i)->compress_data()->data());
-    size_t compress_weight_size = fbs_compress_feature_map->Get(i)->compress_data()->size();
-    MS_LOG(DEBUG) << "The compress weight size: " << compress_weight_size;
-    for (size_t j = 0; j < compress_weight_size; ++j) {
-      compress_feature_map.compress_data.emplace_back(compress_weight_data[j]);
-    }
+    compress_feature_map.compress_data = fbs_compress_feature_map->Get(i)->compress_data()->data();
+    compress_feature_map.compress_data_size = fbs_compress_feature_map->Get(i)->compress_data()->size();
+    MS_LOG(DEBUG) << "The compress weight size: " << compress_feature_map.compress_data_size;
     compress_feature_map.min_val = fbs_compress_feature_map->Get(i)->min_val();
     compress_feature_map.max_val = fbs_compress_feature_map->Get(i)->max_val();
     MS_LOG(DEBUG) << "Min value: " << compress_feature_map.min_val;
@@ -514,19 +520,11 @@ std::map<std::string, UploadData> UpdateModelKernel::DecodeFeatureMap(
 
   // Decode.
   bool status = mindspore::fl::compression::DecodeExecutor::GetInstance().Decode(
-    weight_map, compress_feature_maps, upload_compress_type, upload_sparse_rate, seed, name_vec, data_size);
-  if (status) {
-    for (size_t i = 0; i < name_vec.size(); ++i) {
-      std::string weight_full_name = name_vec[i];
-      size_t weight_size = (*weight_map)[weight_full_name].size() * sizeof(float);
-      UploadData upload_data;
-      upload_data[kNewWeight].addr = (*weight_map)[weight_full_name].data();
-      upload_data[kNewWeight].size = weight_size;
-      feature_map[weight_full_name] = upload_data;
-    }
-    return feature_map;
+    &feature_map, compress_feature_maps, upload_compress_type, upload_sparse_rate, seed, name_vec, data_size);
+  if (!status) {
+    MS_LOG(WARNING) << "Decode failed!";
+    feature_map.clear();
   }
-  MS_LOG(WARNING) << "Decode failed!";
   return feature_map;
 }
 
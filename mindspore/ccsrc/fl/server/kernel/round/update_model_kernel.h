@@ -67,9 +67,10 @@ class UpdateModelKernel : public RoundKernel {
   std::map<std::string, UploadData> ParseSignDSFeatureMap(const schema::RequestUpdateModel *update_model_req,
                                                           size_t data_size,
                                                           std::map<std::string, std::vector<float>> *weight_map);
-  std::map<std::string, UploadData> ParseUploadCompressFeatureMap(
-    const schema::RequestUpdateModel *update_model_req, size_t data_size,
-    std::map<std::string, std::vector<float>> *weight_map);
+  std::map<std::string, AccumulateFunc> ParseUploadCompressFeatureMap(
+    const schema::RequestUpdateModel *update_model_req, size_t data_size);
+  // Wrap the uploaded weights, which are valid only when the request is being handled, into the accumulate functions.
+  std::map<std::string, AccumulateFunc> ToAccumulateFuncs(const std::map<std::string, UploadData> &feature_map);
   bool VerifySignDSFeatureMap(const std::unordered_map<std::string, size_t> &model,
                               const schema::RequestUpdateModel *update_model_req);
   bool VerifyUploadCompressFeatureMap(const schema::RequestUpdateModel *update_model_req);
@@ -89,9 +90,8 @@ class UpdateModelKernel : public RoundKernel {
   size_t iteration_time_window_{0};
 
   // Decode functions of compression.
-  std::map<std::string, UploadData> DecodeFeatureMap(std::map<std::string, std::vector<float>> *weight_map,
-                                                     const schema::RequestUpdateModel *update_model_req,
-                                                     schema::CompressType upload_compress_type, size_t data_size);
+  std::map<std::string, AccumulateFunc> DecodeFeatureMap(const schema::RequestUpdateModel *update_model_req,
+                                                         schema::CompressType upload_compress_type, size_t data_size);
 };
 }  // namespace kernel
 }  // namespace server
@@ -78,6 +78,13 @@ class ParameterAggregator {
   // Launch aggregators/optimizers of this ParameterAggregator in order.
   bool LaunchAggregators();
 
+  // Whether all the aggregation kernels support accumulating the uploaded data through the AccumulateFunc.
+  bool SupportAccumulate() const;
+
+  // Launch the aggregation kernels with the AccumulateFunc. Unlike other methods, this method could be called
+  // concurrently without the lock.
+  bool LaunchAggregators(const AccumulateFunc &accumulate_func, size_t data_size);
+
   // Different from the method Pull, this method simply returns the weight of this ParameterAggregator without causing
   // any change of status.
   AddressPtr GetWeight();
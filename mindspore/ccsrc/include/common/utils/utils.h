@@ -429,6 +429,8 @@ constexpr auto kAttrLabelForInsertStreamActive = "label_for_insert_stream_active
 constexpr auto kAttrFpBpEnd = "fpbp_end";
 constexpr auto kAttrFusion = "fusion";
 constexpr auto kAttrNotDelayFusion = "not_delay_fusion";
+// The graph flag of the AllReduce fused into more than one bucket.
+constexpr auto kAttrAllReduceBucketed = "all_reduce_bucketed";
 constexpr auto kAttrGroup = "group";
 constexpr auto kAttrGroups = "groups";
 constexpr auto kAttrGroupBack = "group_back";
@@ -586,6 +588,7 @@ constexpr auto kValueTrue = "true";
 
 // env key
 constexpr auto kGraphOpRun = "GRAPH_OP_RUN";
+constexpr auto kCpuOffloadPath = "MS_DEV_CPU_OFFLOAD_PATH";
 
 // some size
 const size_t kShape4dDims = 4;
@@ -65,6 +65,7 @@
 #include "minddata/dataset/engine/ir/datasetops/shuffle_node.h"
 #ifndef ENABLE_ANDROID
 #include "minddata/dataset/engine/ir/datasetops/skip_node.h"
+#include "minddata/dataset/engine/ir/datasetops/snapshot_node.h"
 #include "minddata/dataset/engine/ir/datasetops/take_node.h"
 #include "minddata/dataset/engine/ir/datasetops/transfer_node.h"
 #include "minddata/dataset/engine/ir/datasetops/zip_node.h"
@@ -569,6 +570,17 @@ SkipDataset::SkipDataset(const std::shared_ptr<Dataset> &input, int32_t count) {
   }
 }
 
+SnapshotDataset::SnapshotDataset(const std::shared_ptr<Dataset> &input, const std::vector<char> &path,
+                                 int32_t num_shards) {
+  if (input == nullptr) {
+    ir_node_ = nullptr;
+  } else {
+    auto ds = std::make_shared<SnapshotNode>(input->IRNode(), CharToString(path), num_shards);
+
+    ir_node_ = std::static_pointer_cast<DatasetNode>(ds);
+  }
+}
+
 TakeDataset::TakeDataset(const std::shared_ptr<Dataset> &input, int32_t count) {
   if (input == nullptr) {
     ir_node_ = nullptr;
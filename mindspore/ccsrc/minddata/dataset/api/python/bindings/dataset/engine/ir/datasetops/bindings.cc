@@ -119,20 +119,22 @@ PYBIND_REGISTER(BucketBatchByLengthNode, 2, ([](const py::module *m) {
                     .def(py::init([](const std::shared_ptr<DatasetNode> &dataset, const py::list &column_names,
                                      const std::vector<int32_t> &bucket_boundaries,
                                      const std::vector<int32_t> &bucket_batch_sizes, py::object element_length_function,
-                                     const py::dict &pad_info, bool pad_to_bucket_boundary, bool drop_remainder) {
+                                     const py::dict &pad_info, bool pad_to_bucket_boundary, bool drop_remainder,
+                                     int32_t max_tokens, int32_t window_size) {
                            std::map<std::string, std::pair<TensorShape, std::shared_ptr<Tensor>>> c_pad_info;
                            THROW_IF_ERROR(toPadInfo(pad_info, &c_pad_info));
 
                            auto bucket_batch = std::make_shared<BucketBatchByLengthNode>(
                              dataset, toStringVector(column_names), bucket_boundaries, bucket_batch_sizes,
                              toPyFuncOp(std::move(element_length_function), DataType::DE_INT32), c_pad_info,
-                             pad_to_bucket_boundary, drop_remainder);
+                             pad_to_bucket_boundary, drop_remainder, max_tokens, window_size);
                            THROW_IF_ERROR(bucket_batch->ValidateParams());
                            return bucket_batch;
                          }),
                          py::arg("dataset"), py::arg("column_names"), py::arg("bucket_boundaries"),
                          py::arg("bucket_batch_sizes"), py::arg("element_length_function") = py::none(),
-                         py::arg("pad_info"), py::arg("pad_to_bucket_boundary"), py::arg("drop_remainder"));
+                         py::arg("pad_info"), py::arg("pad_to_bucket_boundary"), py::arg("drop_remainder"),
+                         py::arg("max_tokens") = 0, py::arg("window_size") = 0);
                 }));
 
 PYBIND_REGISTER(BuildSentenceVocabNode, 2, ([](const py::module *m) {
@@ -58,7 +58,8 @@ ConfigManager::ConfigManager()
       save_autoconfig_(false),
       autotune_interval_(kCfgAutoTuneInterval),
       enable_watchdog_(true),
-      multiprocessing_timeout_interval_(kCfgMultiprocessingTimeoutInterval) {
+      multiprocessing_timeout_interval_(kCfgMultiprocessingTimeoutInterval),
+      enable_slab_allocator_(false) {
   autotune_json_filepath_ = kEmptyString;
   num_cpu_threads_ = num_cpu_threads_ > 0 ? num_cpu_threads_ : std::numeric_limits<uint16_t>::max();
   num_parallel_workers_ = num_parallel_workers_ < num_cpu_threads_ ? num_parallel_workers_ : num_cpu_threads_;
@@ -98,6 +99,7 @@ Status ConfigManager::FromJson(const nlohmann::json &j) {
   set_cache_port(j.value("cachePort", cache_port_));
   set_num_connections(j.value("numConnections", num_connections_));
   set_cache_prefetch_size(j.value("cachePrefetchSize", cache_prefetch_size_));
+  set_enable_slab_allocator(j.value("enableSlabAllocator", enable_slab_allocator()));
   return Status::OK();
 }
 
@@ -275,6 +275,14 @@ class ConfigManager {
   // @param interval - multiprocessing timeout interval in seconds
   void set_multiprocessing_timeout_interval(uint32_t interval) { multiprocessing_timeout_interval_ = interval; }
 
+  // setter function
+  // @param enable - To allocate the data of new tensors from the slab pool instead of the system pool
+  void set_enable_slab_allocator(bool enable) { enable_slab_allocator_ = enable; }
+
+  // getter function
+  // @return - Flag to indicate whether the data of new tensors comes from the slab pool
+  bool enable_slab_allocator() const { return enable_slab_allocator_; }
+
  private:
   // Private helper function that takes a nlohmann json format and populates the settings
   // @param j - The json nlohmann json info
@@ -307,6 +315,7 @@ class ConfigManager {
   int64_t autotune_interval_;
   bool enable_watchdog_;                       // Watchdog python thread enabled flag
   uint32_t multiprocessing_timeout_interval_;  // Multiprocessing timeout interval in seconds
+  bool enable_slab_allocator_;                 // Allocate tensor data from the slab pool
   std::string autotune_json_filepath_;         // Filepath name of the final AutoTune Configuration JSON file
 };
 }  // namespace dataset
@@ -28,7 +28,7 @@ const int kYuvDefaultChannels = 4;
 DeviceTensor::DeviceTensor(const TensorShape &shape, const DataType &type)
     : Tensor(shape, type), device_data_(nullptr), size_(0) {
   // grab the mem pool from global context and create the allocator for char data area
-  std::shared_ptr<MemoryPool> global_pool = GlobalContext::Instance()->mem_pool();
+  std::shared_ptr<MemoryPool> global_pool = GlobalContext::Instance()->tensor_mem_pool();
   data_allocator_ = std::make_unique<Allocator<unsigned char>>(global_pool);
   device_data_type_ = type;
   host_data_tensor_ = nullptr;
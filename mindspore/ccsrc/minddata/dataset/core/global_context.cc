@@ -28,6 +28,7 @@
 #include "minddata/dataset/engine/perf/profiling.h"
 #endif
 #include "minddata/dataset/util/allocator.h"
+#include "minddata/dataset/util/slab_pool.h"
 #include "minddata/dataset/util/system_pool.h"
 
 namespace mindspore {
@@ -57,6 +58,8 @@ GlobalContext *GlobalContext::Instance() {
 Status GlobalContext::Init() {
   config_manager_ = std::make_shared<ConfigManager>();
   mem_pool_ = std::make_shared<SystemPool>();
+  // The slab pool reserves nothing until it is used
+  slab_pool_ = std::make_shared<SlabPool>();
   // For testing we can use Dummy pool instead
 
   // Create some tensor allocators for the different types and hook them into the pool.
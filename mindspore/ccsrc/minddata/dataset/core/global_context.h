@@ -86,6 +86,12 @@ class GlobalContext {
   // @return the mem pool
   std::shared_ptr<MemoryPool> mem_pool() const { return mem_pool_; }
 
+  // Getter method
+  // @return the mem pool for the data of new tensors, the slab pool when it is enabled in the config
+  std::shared_ptr<MemoryPool> tensor_mem_pool() const {
+    return config_manager_->enable_slab_allocator() ? slab_pool_ : mem_pool_;
+  }
+
   // Getter method
   // @return the tensor allocator as raw pointer
   const TensorAlloc *tensor_allocator() const { return tensor_allocator_.get(); }
@@ -113,6 +119,7 @@ class GlobalContext {
   static std::once_flag init_instance_flag_;
   static std::unique_ptr<GlobalContext> global_context_;        // The instance of the singleton (global)
   std::shared_ptr<MemoryPool> mem_pool_;                        // A global memory pool
+  std::shared_ptr<MemoryPool> slab_pool_;                       // A slab pool for tensor data
   std::shared_ptr<ConfigManager> config_manager_;               // The configs
   std::unique_ptr<TensorAlloc> tensor_allocator_;               // An allocator for Tensors
   std::unique_ptr<CVTensorAlloc> cv_tensor_allocator_;          // An allocator for CV Tensors
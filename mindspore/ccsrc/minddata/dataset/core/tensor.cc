@@ -65,7 +65,7 @@ namespace dataset {
 
 Tensor::Tensor(const TensorShape &shape, const DataType &type) : shape_(shape), type_(type), data_(nullptr) {
   // grab the mem pool from global context and create the allocator for char data area
-  std::shared_ptr<MemoryPool> global_pool = GlobalContext::Instance()->mem_pool();
+  std::shared_ptr<MemoryPool> global_pool = GlobalContext::Instance()->tensor_mem_pool();
   data_allocator_ = std::make_unique<Allocator<unsigned char>>(global_pool);
 }
 
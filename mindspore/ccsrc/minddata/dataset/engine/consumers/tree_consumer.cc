@@ -25,6 +25,7 @@
 #include "minddata/dataset/engine/opt/pre/getter_pass.h"
 #ifndef ENABLE_SECURITY
 #include "minddata/dataset/engine/perf/auto_tune.h"
+#include "minddata/dataset/engine/perf/batch_padding_tracing.h"
 #include "minddata/dataset/engine/perf/monitor.h"
 #include "minddata/dataset/engine/perf/profiling.h"
 #endif
@@ -59,7 +60,13 @@ Status TreeConsumer::Init(std::shared_ptr<DatasetNode> d) {
 
 Status TreeConsumer::Terminate() {
   if (tree_adapter_->AllTasks() != nullptr) {
-    return tree_adapter_->AllTasks()->ServiceStop();
+    RETURN_IF_NOT_OK(tree_adapter_->AllTasks()->ServiceStop());
+  }
+  const ExecutionTree *tree = tree_adapter_->GetExecutionTree();
+  if (tree != nullptr) {
+    for (auto itr = tree->begin(); itr != tree->end(); ++itr) {
+      RETURN_IF_NOT_OK(itr->Terminate());
+    }
   }
   return Status::OK();
 }
@@ -82,6 +89,8 @@ Status IteratorConsumer::RegisterProfilingManager() {
     // dataset_iterator node is used for graph mode
     std::shared_ptr<Tracing> iterator_tracing = std::make_shared<DatasetIteratorTracing>();
     RETURN_IF_NOT_OK(profiling_manager_->RegisterTracingNode(iterator_tracing));
+    // batch_padding node is only filled when the pipeline batches by length
+    RETURN_IF_NOT_OK(profiling_manager_->RegisterTracingNode(std::make_shared<BatchPaddingTracing>()));
     RETURN_IF_NOT_OK(tree_adapter_->SetProfilingManagerPtr(profiling_manager_, iterator_tracing));
     // Launch Monitor Thread
     RETURN_IF_NOT_OK(profiling_manager_->LaunchMonitor());
@@ -108,6 +117,8 @@ Status ToDevice::RegisterProfilingManager() {
     // device_queue node is used for graph mode
     std::shared_ptr<Tracing> device_queue_tracing = std::make_shared<DeviceQueueTracing>();
     RETURN_IF_NOT_OK(profiling_manager_->RegisterTracingNode(device_queue_tracing));
+    // batch_padding node is only filled when the pipeline batches by length
+    RETURN_IF_NOT_OK(profiling_manager_->RegisterTracingNode(std::make_shared<BatchPaddingTracing>()));
     RETURN_IF_NOT_OK(tree_adapter_->SetProfilingManagerPtr(profiling_manager_));
     // Launch Monitor Thread
     RETURN_IF_NOT_OK(profiling_manager_->LaunchMonitor());
@@ -49,7 +49,7 @@ class TreeConsumer {
   /// \return Status error code.
   virtual Status Init(std::shared_ptr<DatasetNode> d);
 
-  /// Internal function to perform the termination
+  /// Internal function to perform the termination, stops the tasks of the tree and then terminates its ops
   /// \return Status error code
   virtual Status Terminate();
 
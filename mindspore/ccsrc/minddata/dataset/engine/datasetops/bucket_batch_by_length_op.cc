@@ -15,6 +15,7 @@
  */
 #include "minddata/dataset/engine/datasetops/bucket_batch_by_length_op.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -24,6 +25,10 @@
 #include "minddata/dataset/core/tensor_shape.h"
 #include "minddata/dataset/engine/dataset_iterator.h"
 #include "minddata/dataset/engine/datasetops/parallel_op.h"
+#ifndef ENABLE_SECURITY
+#include "minddata/dataset/engine/perf/batch_padding_tracing.h"
+#include "minddata/dataset/engine/perf/profiling.h"
+#endif
 #include "minddata/dataset/util/status.h"
 
 namespace py = pybind11;
@@ -33,8 +38,8 @@ BucketBatchByLengthOp::BucketBatchByLengthOp(const std::vector<std::string> &len
                                              const std::vector<int32_t> &bucket_boundaries,
                                              const std::vector<int32_t> &bucket_batch_sizes,
                                              std::shared_ptr<TensorOp> element_length_function, const PadInfo &pad_info,
-                                             bool pad_to_bucket_boundary, bool drop_remainder,
-                                             int32_t op_connector_size)
+                                             bool pad_to_bucket_boundary, bool drop_remainder, int32_t max_tokens,
+                                             int32_t window_size, int32_t op_connector_size)
     : PipelineOp(op_connector_size),
       length_dependent_columns_(length_dependent_columns),
       bucket_boundaries_(bucket_boundaries),
@@ -43,10 +48,16 @@ BucketBatchByLengthOp::BucketBatchByLengthOp(const std::vector<std::string> &len
       pad_info_(pad_info),
       pad_to_bucket_boundary_(pad_to_bucket_boundary),
       drop_remainder_(drop_remainder),
-      batch_count_(0) {
+      max_tokens_(max_tokens),
+      window_size_(window_size),
+      batch_count_(0),
+      window_new_rows_(0),
+      real_tokens_(0),
+      padded_tokens_(0) {
   for (int i = 0; i < bucket_batch_sizes_.size(); i++) {
     buckets_.push_back(std::make_unique<TensorQTable>());
   }
+  bucket_tokens_.resize(bucket_batch_sizes_.size(), {0, 0});
 }
 
 Status BucketBatchByLengthOp::EoeReceived(int32_t) {
@@ -56,6 +67,15 @@ Status BucketBatchByLengthOp::EoeReceived(int32_t) {
 
 Status BucketBatchByLengthOp::operator()() {
   TaskManager::FindMe()->Post();
+#ifndef ENABLE_SECURITY
+  if (GlobalContext::profiling_manager()->IsProfilingEnable(tree_)) {
+    std::shared_ptr<Tracing> node;
+    // Only the consumers that profile the pipeline register the node
+    if (GlobalContext::profiling_manager()->GetTracingNode(kBatchPaddingTracingName, &node).IsOk()) {
+      padding_tracing_ = std::dynamic_pointer_cast<BatchPaddingTracing>(node);
+    }
+  }
+#endif
 
   TensorRow current_row;
   child_iterator_ = std::make_unique<ChildIterator>(this, 0, 0);
@@ -65,12 +85,25 @@ Status BucketBatchByLengthOp::operator()() {
       int32_t element_length;
       RETURN_IF_NOT_OK(ObtainElementLength(&element_length, current_row));
 
+      if (max_tokens_ > 0) {
+        window_.emplace_back(element_length, std::move(current_row));
+        // Count the new rows only, the rows left over from the last window could fill a window on their own
+        // and would otherwise sort the window again for every new row
+        if (++window_new_rows_ >= window_size_) {
+          RETURN_IF_NOT_OK(BatchWindow(false));
+        }
+        RETURN_IF_NOT_OK(child_iterator_->FetchNextTensorRow(&current_row));
+        continue;
+      }
+
       int bucket_index = bucket_boundaries_.size() - 1;
       while (element_length < bucket_boundaries_[bucket_index]) {
         bucket_index--;
       }
 
       buckets_[bucket_index]->push_back(current_row);
+      bucket_tokens_[bucket_index].first += element_length;
+      bucket_tokens_[bucket_index].second = std::max(bucket_tokens_[bucket_index].second, element_length);
 
       if (buckets_[bucket_index]->size() == bucket_batch_sizes_[bucket_index]) {
         RETURN_IF_NOT_OK(PadAndBatchBucket(bucket_index, bucket_batch_sizes_[bucket_index]));
@@ -80,13 +113,16 @@ Status BucketBatchByLengthOp::operator()() {
     }
 
     // got EOE, do what we need to do with remainders in each bucket
-    if (!drop_remainder_) {
+    if (max_tokens_ > 0) {
+      RETURN_IF_NOT_OK(BatchWindow(true));
+    } else if (!drop_remainder_) {
       for (int i = 0; i < bucket_boundaries_.size(); i++) {
         if (!buckets_[i]->empty()) {
           RETURN_IF_NOT_OK(PadAndBatchBucket(i, buckets_[i]->size()));
         }
       }
     }
+    ReportPadding();
 
     // need to send EOE manually since we set state to idle in EoeRecieved()
     RETURN_IF_NOT_OK(out_connector_->SendEOE());
@@ -153,20 +189,88 @@ Status BucketBatchByLengthOp::PadAndBatchBucket(int32_t bucket_index, int32_t ba
     }
   }
 
+  int32_t padded_length = bucket_tokens_[bucket_index].second;
+  if (pad_to_bucket_boundary_ && bucket_index + 1 < bucket_boundaries_.size()) {
+    padded_length = bucket_boundaries_[bucket_index + 1] - 1;
+  }
+  int64_t num_tokens = bucket_tokens_[bucket_index].first;
+  bucket_tokens_[bucket_index] = {0, 0};
+  return SendBatch(bucket, pad_info_copy, num_tokens, padded_length);
+}
+
+Status BucketBatchByLengthOp::BatchWindow(bool flush) {
+  window_new_rows_ = 0;
+  // Rows of equal length keep their order
+  std::stable_sort(window_.begin(), window_.end(),
+                   [](const std::pair<int32_t, TensorRow> &a, const std::pair<int32_t, TensorRow> &b) {
+                     return a.first < b.first;
+                   });
+  auto rows = std::make_unique<TensorQTable>();
+  size_t begin = 0;
+  int64_t num_tokens = 0;
+  for (size_t i = 0; i < window_.size(); ++i) {
+    // The window is sorted, so row i is the longest one of the batch it joins. A row longer than the
+    // whole budget still makes a batch on its own.
+    auto padded_size = static_cast<int64_t>(i - begin + 1) * window_[i].first;
+    if (i > begin && padded_size > max_tokens_) {
+      RETURN_IF_NOT_OK(SendBatch(&rows, pad_info_, num_tokens, window_[i - 1].first));
+      begin = i;
+      num_tokens = 0;
+    }
+    rows->push_back(std::move(window_[i].second));
+    num_tokens += window_[i].first;
+  }
+  if (flush) {
+    if (!drop_remainder_ && !rows->empty()) {
+      RETURN_IF_NOT_OK(SendBatch(&rows, pad_info_, num_tokens, window_.back().first));
+    }
+    window_.clear();
+    return Status::OK();
+  }
+  // Give the rows of the last batch another chance to fill it up with the next window
+  size_t i = begin;
+  for (auto &row : *rows) {
+    window_[i++].second = std::move(row);
+  }
+  (void)window_.erase(window_.begin(), window_.begin() + begin);
+  return Status::OK();
+}
+
+Status BucketBatchByLengthOp::SendBatch(std::unique_ptr<TensorQTable> *rows, const PadInfo &pad_info,
+                                        int64_t num_tokens, int32_t padded_length) {
+  auto batch_size = static_cast<int32_t>((*rows)->size());
   // PadColumns will change the data in bucket
-  RETURN_IF_NOT_OK(BatchOp::PadColumns(bucket, pad_info_copy, column_name_id_map_));
+  RETURN_IF_NOT_OK(BatchOp::PadColumns(rows, pad_info, column_name_id_map_));
 
   TensorRow batched_bucket;
-  RETURN_IF_NOT_OK(BatchOp::BatchRows(bucket, &batched_bucket, batch_size));
-  (*bucket)->clear();
+  RETURN_IF_NOT_OK(BatchOp::BatchRows(rows, &batched_bucket, batch_size));
+  (*rows)->clear();
 
   RETURN_IF_NOT_OK(out_connector_->Add(std::move(batched_bucket)));
 
   batch_count_++;
 
+  int64_t padded_tokens = static_cast<int64_t>(batch_size) * padded_length;
+  real_tokens_ += num_tokens;
+  padded_tokens_ += padded_tokens;
+#ifndef ENABLE_SECURITY
+  if (padding_tracing_ != nullptr) {
+    padding_tracing_->RecordPadding(num_tokens, batch_count_, padded_tokens, ProfilingTime::GetCurMilliSecond());
+  }
+#endif
   return Status::OK();
 }
 
+void BucketBatchByLengthOp::ReportPadding() {
+  if (padded_tokens_ > 0) {
+    MS_LOG(INFO) << "BucketBatchByLength sent " << batch_count_ << " batches of " << real_tokens_
+                 << " tokens padded to " << padded_tokens_ << " tokens, "
+                 << (padded_tokens_ - real_tokens_) * 100 / padded_tokens_ << "% of the batches is padding.";
+  }
+  real_tokens_ = 0;
+  padded_tokens_ = 0;
+}
+
 // Computing the assignment of the column name map and check compute input columns.
 Status BucketBatchByLengthOp::ComputeColMap() {
   RETURN_IF_NOT_OK(DatasetOp::ComputeColMap());
@@ -20,6 +20,7 @@
 #include <memory>
 #include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "minddata/dataset/core/config_manager.h"
@@ -33,12 +34,23 @@
 namespace mindspore {
 namespace dataset {
 
+class BatchPaddingTracing;
+
+// BucketBatchByLengthOp batches rows of similar length together, in one of two modes:
+//   - bucket mode: every row goes into the bucket its length falls in, and a bucket is padded and
+//     batched once it holds the batch size of the bucket.
+//   - token budget mode (max_tokens > 0): rows are collected into a window of window_size rows, the
+//     window is sorted by length and cut into batches whose padded size, i.e. number of rows times the
+//     longest length in the batch, stays within max_tokens. The unfinished last batch of a window is
+//     sorted into the next window instead of being sent short.
+// In both modes the number of real and padded tokens of every batch goes to the profiler.
 class BucketBatchByLengthOp : public PipelineOp {
  public:
   BucketBatchByLengthOp(const std::vector<std::string> &length_dependent_columns,
                         const std::vector<int32_t> &bucket_boundaries, const std::vector<int32_t> &bucket_batch_sizes,
                         std::shared_ptr<TensorOp> element_length_function, const PadInfo &pad_info,
-                        bool pad_to_bucket_boundary, bool drop_remainder, int32_t op_connector_size);
+                        bool pad_to_bucket_boundary, bool drop_remainder, int32_t max_tokens, int32_t window_size,
+                        int32_t op_connector_size);
 
   // Destructor
   ~BucketBatchByLengthOp() = default;
@@ -69,6 +81,23 @@ class BucketBatchByLengthOp : public PipelineOp {
 
   Status PadAndBatchBucket(int32_t bucket_index, int32_t batch_size);
 
+  // Sort the window by length and send the batches that fit into the token budget.
+  // @param bool flush - also send the last batch of the window, which may have room left
+  // @return Status The status code returned
+  Status BatchWindow(bool flush);
+
+  // Pad and batch the rows, then send the batch and record its padding
+  // @param std::unique_ptr<TensorQTable> *rows - rows of the batch, the table is cleared afterwards
+  // @param const PadInfo &pad_info - how to pad the columns
+  // @param int64_t num_tokens - sum of the lengths of the rows
+  // @param int32_t padded_length - length every row is padded to
+  // @return Status The status code returned
+  Status SendBatch(std::unique_ptr<TensorQTable> *rows, const PadInfo &pad_info, int64_t num_tokens,
+                   int32_t padded_length);
+
+  // Log the padding of the epoch and reset the counters
+  void ReportPadding();
+
   Status ComputeColMap() override;
 
   std::vector<std::string> length_dependent_columns_;
@@ -78,10 +107,20 @@ class BucketBatchByLengthOp : public PipelineOp {
   PadInfo pad_info_;
   bool pad_to_bucket_boundary_;
   bool drop_remainder_;
+  int32_t max_tokens_;   // token budget of a batch, 0 to batch by buckets
+  int32_t window_size_;  // number of rows sorted together in token budget mode
 
   int32_t batch_count_;
   std::unique_ptr<ChildIterator> child_iterator_;
   std::vector<std::unique_ptr<TensorQTable>> buckets_;
+  std::vector<std::pair<int64_t, int32_t>> bucket_tokens_;  // sum and max of the lengths in each bucket
+  std::vector<std::pair<int32_t, TensorRow>> window_;       // rows waiting for a batch with their lengths
+  int32_t window_new_rows_;  // rows added to the window since it was last batched
+
+  // Padding of the current epoch
+  int64_t real_tokens_;
+  int64_t padded_tokens_;
+  std::shared_ptr<BatchPaddingTracing> padding_tracing_;
 };
 }  // namespace dataset
 }  // namespace mindspore
@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <iomanip>
+#include <functional>
 #include <limits>
 #include <string>
 #include <unordered_map>
@@ -31,7 +32,6 @@ BuildVocabOp::BuildVocabOp(std::shared_ptr<Vocab> vocab, std::vector<std::string
                            std::pair<int64_t, int64_t> freq_r, int64_t top_k, const std::vector<std::string> &tokens,
                            bool prepend, int32_t num_workers, int32_t op_conn_size)
     : ParallelOp(num_workers, op_conn_size),
-      interval_(op_conn_size * num_workers),
       vocab_(vocab),
       col_names_(col_names),
       freq_range_(freq_r),
@@ -40,17 +40,49 @@ BuildVocabOp::BuildVocabOp(std::shared_ptr<Vocab> vocab, std::vector<std::string
       special_first_(prepend) {
   // init two queues for thread sync
   distributor_queue_ = std::make_unique<Queue<TensorRow>>(num_workers * op_conn_size);
-  collector_queue_ =
-    std::make_unique<Queue<std::unique_ptr<std::unordered_map<std::string, int64_t>>>>((num_workers * op_conn_size));
+  collector_queue_ = std::make_unique<Queue<int32_t>>(num_workers);
+  // a few shards per worker keeps the chance of two flushing workers meeting on the same lock low
+  const int32_t shards_per_worker = 4;
+  num_shards_ = std::max(num_workers, 1) * shards_per_worker;
+  shard_cnt_.resize(num_shards_);
+  shard_mutex_ = std::make_unique<std::mutex[]>(num_shards_);
+}
+
+void BuildVocabOp::FlushToShards(WordCountMap *local_cnt) {
+  std::vector<WordCountMap> parts(num_shards_);
+  std::hash<std::string> hasher;
+  while (!local_cnt->empty()) {
+    auto node = local_cnt->extract(local_cnt->begin());
+    size_t shard = hasher(node.key()) % static_cast<size_t>(num_shards_);
+    (void)parts[shard].insert(std::move(node));
+  }
+  for (int32_t shard = 0; shard < num_shards_; ++shard) {
+    if (parts[shard].empty()) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(shard_mutex_[shard]);
+    WordCountMap &dst = shard_cnt_[shard];
+    if (dst.empty()) {
+      dst.swap(parts[shard]);
+      continue;
+    }
+    while (!parts[shard].empty()) {
+      auto node = parts[shard].extract(parts[shard].begin());
+      auto itr = dst.find(node.key());
+      if (itr == dst.end()) {
+        (void)dst.insert(std::move(node));
+      } else {
+        itr->second += node.mapped();
+      }
+    }
+  }
 }
 
 Status BuildVocabOp::WorkerEntry(int32_t worker_id) {
   TaskManager::FindMe()->Post();
   TensorRow new_row;
   RETURN_IF_NOT_OK(distributor_queue_->PopFront(&new_row));
-  std::unique_ptr<std::unordered_map<std::string, int64_t>> wrkr_map =
-    std::make_unique<std::unordered_map<std::string, int64_t>>();
-  int32_t row_cnt = 0;
+  WordCountMap wrkr_map;
   while (!new_row.empty()) {
     for (int32_t col : col_ids_) {
       CHECK_FAIL_RETURN_UNEXPECTED(!new_row[col]->type().IsNumeric(),
@@ -58,22 +90,19 @@ Status BuildVocabOp::WorkerEntry(int32_t worker_id) {
                                    "numeric type: " +
                                      new_row[col]->type().ToString());
       for (auto itr = new_row[col]->begin<std::string_view>(); itr != new_row[col]->end<std::string_view>(); ++itr) {
-        (*wrkr_map)[std::string(*itr)] += 1;
+        wrkr_map[std::string(*itr)] += 1;
       }
     }
-    row_cnt++;  // row is processed by this point
-    if ((row_cnt % interval_ == 0) && ((row_cnt / interval_) % num_workers_ == worker_id) && (!wrkr_map->empty())) {
-      RETURN_IF_NOT_OK(collector_queue_->Add(std::move(wrkr_map)));
-      wrkr_map = std::make_unique<std::unordered_map<std::string, int64_t>>();
+    // bound the memory held by the local table
+    if (wrkr_map.size() >= kLocalFlushThreshold) {
+      FlushToShards(&wrkr_map);
     }
     RETURN_IF_NOT_OK(distributor_queue_->PopFront(&new_row));
   }
   // clean up
-  if (!wrkr_map->empty()) {
-    RETURN_IF_NOT_OK(collector_queue_->Add(std::move(wrkr_map)));
-  }
-  // empty map as quit signal
-  RETURN_IF_NOT_OK(collector_queue_->Add(std::make_unique<std::unordered_map<std::string, int64_t>>()));
+  FlushToShards(&wrkr_map);
+  // worker id as quit signal
+  RETURN_IF_NOT_OK(collector_queue_->Add(worker_id));
   return Status::OK();
 }
 
@@ -128,62 +157,75 @@ Status BuildVocabOp::operator()() {
   return Status::OK();
 }
 
+void BuildVocabOp::SelectTopK(std::vector<std::string> *words) {
+  // count is kept next to the word so that ordering does not need any hash lookup
+  std::vector<std::pair<int64_t, const std::string *>> candidates;
+  size_t total = 0;
+  for (const auto &shard : shard_cnt_) {
+    total += shard.size();
+  }
+  candidates.reserve(total);
+  for (const auto &shard : shard_cnt_) {
+    for (const auto &wd : shard) {
+      if (wd.second >= freq_range_.first && wd.second <= freq_range_.second) {
+        candidates.emplace_back(wd.second, &wd.first);
+      }
+    }
+  }
+  int64_t num_words = std::min(static_cast<int64_t>(candidates.size()), top_k_);
+  auto cmp = [](const std::pair<int64_t, const std::string *> &w1, const std::pair<int64_t, const std::string *> &w2) {
+    return w1.first == w2.first ? *w1.second < *w2.second : w1.first > w2.first;
+  };
+  // select the top-k in linear time, then only sort those
+  if (num_words < static_cast<int64_t>(candidates.size())) {
+    std::nth_element(candidates.begin(), candidates.begin() + num_words, candidates.end(), cmp);
+  }
+  std::sort(candidates.begin(), candidates.begin() + num_words, cmp);
+  words->reserve(num_words);
+  for (int64_t i = 0; i < num_words; i++) {
+    words->push_back(*candidates[i].second);
+  }
+}
+
 Status BuildVocabOp::CollectorThread() {
   TaskManager::FindMe()->Post();
   int32_t num_quited_worker = 0;
-  std::unique_ptr<std::unordered_map<std::string, int64_t>> wrkr_map;
+  int32_t wrkr_id;
   while (num_quited_worker != num_workers_) {
-    RETURN_IF_NOT_OK(collector_queue_->PopFront(&wrkr_map));
-    RETURN_UNEXPECTED_IF_NULL(wrkr_map);
-    if (!wrkr_map->empty()) {
-      for (const auto &wd : *wrkr_map) word_cnt_[wd.first] += wd.second;
-    } else {
-      ++num_quited_worker;
-    }
+    RETURN_IF_NOT_OK(collector_queue_->PopFront(&wrkr_id));
+    ++num_quited_worker;
   }  // all frequencies are obtained
-  CHECK_FAIL_RETURN_UNEXPECTED(!word_cnt_.empty(),
+  bool no_words = std::all_of(shard_cnt_.begin(), shard_cnt_.end(), [](const auto &shard) { return shard.empty(); });
+  CHECK_FAIL_RETURN_UNEXPECTED(!no_words,
                                "Invalid data, BuildVocab load data failed that no words found in vocab, check vocab.");
-  std::vector<std::string> words;
-  // make sure enough is reserved, this will become a partially sorted list eventually
-  words.reserve(wrkr_map->size());
-
-  for (auto it = word_cnt_.begin(); it != word_cnt_.end();) {
-    if (it->second >= freq_range_.first && it->second <= freq_range_.second) {
-      words.push_back(it->first);
-      it++;
-    } else {
-      it = word_cnt_.erase(it);
-    }
-  }
+  std::hash<std::string> hasher;
   std::string err_msg;
 
   for (const std::string &sp_tk : special_tokens_) {
     // if a special word exists in dataset, warn user about this
-    err_msg += (word_cnt_.find(sp_tk) != word_cnt_.end() ? sp_tk + "\t" : "");
+    const auto &shard = shard_cnt_[hasher(sp_tk) % static_cast<size_t>(num_shards_)];
+    auto itr = shard.find(sp_tk);
+    bool in_range = itr != shard.end() && itr->second >= freq_range_.first && itr->second <= freq_range_.second;
+    err_msg += (in_range ? sp_tk + "\t" : "");
   }
 
   CHECK_FAIL_RETURN_UNEXPECTED(err_msg.empty(),
                                "Invalid special words, these special words are already in the vocab: " + err_msg + ".");
 
-  int64_t num_words = std::min(static_cast<int64_t>(words.size()), top_k_);
-  if (num_words == 0) {
+  // this would take the top-k most frequent words
+  std::vector<std::string> words;
+  SelectTopK(&words);
+  if (words.empty()) {
     MS_LOG(WARNING) << "No word falls in the frequency range: (" << freq_range_.first << "," << freq_range_.second
                     << ") vocab would be empty (except for special tokens).";
   }
 
-  // this would take the top-k most frequent words
-  std::partial_sort(words.begin(), words.begin() + num_words, words.end(),
-                    [this](const std::string &w1, const std::string &w2) {
-                      int64_t f1 = word_cnt_[w1], f2 = word_cnt_[w2];
-                      return f1 == f2 ? w1 < w2 : f1 > f2;
-                    });
-
   if (special_first_) {
     for (const std::string &sp_tk : special_tokens_) vocab_->AppendWord(sp_tk);
   }
 
-  for (int64_t i = 0; i < num_words; i++) {
-    vocab_->AppendWord(words[i]);
+  for (const std::string &word : words) {
+    vocab_->AppendWord(word);
   }
 
   if (!special_first_) {
@@ -192,7 +234,6 @@ Status BuildVocabOp::CollectorThread() {
 
   RETURN_IF_NOT_OK(out_connector_->SendEOE());
   RETURN_IF_NOT_OK(out_connector_->SendEOF());
-  // then use std::nth_element to partial sort
   return Status::OK();
 }
 
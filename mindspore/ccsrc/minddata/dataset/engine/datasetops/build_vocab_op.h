@@ -18,6 +18,7 @@
 
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <string>
 #include <utility>
@@ -69,7 +70,21 @@ class BuildVocabOp : public ParallelOp<TensorRow, TensorRow> {
   Status Reset() override { RETURN_STATUS_UNEXPECTED("[Internal ERROR] Reset shouldn't be called in BuildVocabOp"); }
 
  private:
-  const int32_t interval_;
+  using WordCountMap = std::unordered_map<std::string, int64_t>;
+
+  /// \brief Move the counts of a worker local table into the shared sharded table. Entries are grouped by
+  ///     shard first so every shard lock is taken once per flush, and the map nodes are spliced rather than
+  ///     copied so the words are not reallocated.
+  /// \param[in] local_cnt Worker local table, empty on return
+  void FlushToShards(WordCountMap *local_cnt);
+
+  /// \brief Pick the words in the frequency range with the top_k_ highest counts, most frequent first.
+  /// \param[out] words Selected words
+  void SelectTopK(std::vector<std::string> *words);
+
+  // Number of distinct words a worker counts locally before flushing to the shared table
+  static constexpr size_t kLocalFlushThreshold = 1 << 20;
+
   bool special_first_;
   std::shared_ptr<Vocab> vocab_;
   std::vector<std::string> col_names_;
@@ -82,8 +97,10 @@ class BuildVocabOp : public ParallelOp<TensorRow, TensorRow> {
   int64_t top_k_;                                        // every thing means top_k_ == int32_max
   std::unique_ptr<ChildIterator> child_iterator_;        // child iterator for fetching TensorRows 1 by 1
   std::unique_ptr<Queue<TensorRow>> distributor_queue_;  // master thread assigns each worker TensorRow via this
-  std::unique_ptr<Queue<std::unique_ptr<std::unordered_map<std::string, int64_t>>>> collector_queue_;
-  std::unordered_map<std::string, int64_t> word_cnt_;
+  std::unique_ptr<Queue<int32_t>> collector_queue_;       // each worker posts its id here when done
+  int32_t num_shards_;                                    // number of shards of the shared word count table
+  std::vector<WordCountMap> shard_cnt_;                   // shared word count table, sharded by word hash
+  std::unique_ptr<std::mutex[]> shard_mutex_;             // one lock per shard
 };
 }  // namespace dataset
 }  // namespace mindspore
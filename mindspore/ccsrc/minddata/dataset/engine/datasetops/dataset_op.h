@@ -53,6 +53,7 @@ constexpr char kRenameOp[] = "RenameOp";
 constexpr char kRepeatOp[] = "RepeatOp";
 constexpr char kShuffleOp[] = "ShuffleOp";
 constexpr char kSkipOp[] = "SkipOp";
+constexpr char kSnapshotOp[] = "SnapshotOp";
 constexpr char kTakeOp[] = "TakeOp";
 constexpr char kZipOp[] = "ZipOp";
 
@@ -195,6 +196,12 @@ class DatasetOp : public std::enable_shared_from_this<DatasetOp> {
   // \return Status The status code returned
   virtual Status Reset();
 
+  // \brief Performs handling for when the tree is terminated. It is only called once all the tasks of the
+  //     tree have stopped, so an operator can finish work it defers to EOF even when the consumer stops the
+  //     tree before EOF. The base class implementation does nothing.
+  // \return Status The status code returned
+  virtual Status Terminate() { return Status::OK(); }
+
   // \brief During tree prepare phase, operators may have specific post-operations to perform depending on
   //     their role.
   // \notes Derived versions of this function should always call it's superclass version first
@@ -0,0 +1,274 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "minddata/dataset/engine/datasetops/snapshot_op.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <utility>
+#include <nlohmann/json.hpp>
+
+#include "minddata/dataset/core/tensor.h"
+#include "minddata/dataset/util/log_adapter.h"
+#include "minddata/dataset/util/path.h"
+#include "minddata/dataset/util/services.h"
+
+namespace mindspore {
+namespace dataset {
+namespace {
+constexpr uint64_t kSnapshotAlign = 8;
+const char kPadding[kSnapshotAlign] = {0};
+
+std::string ShardName(int32_t shard, const std::string &suffix) { return "shard_" + std::to_string(shard) + suffix; }
+
+template <typename T>
+void WritePod(std::ostream *out, const T &value) {
+  (void)out->write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+Status ReadPod(const uint8_t *data, uint64_t num_bytes, uint64_t *pos, T *value) {
+  CHECK_FAIL_RETURN_UNEXPECTED(*pos + sizeof(T) <= num_bytes, "Invalid snapshot, row record is truncated.");
+  (void)std::copy(data + *pos, data + *pos + sizeof(T), reinterpret_cast<uint8_t *>(value));
+  *pos += sizeof(T);
+  return Status::OK();
+}
+}  // namespace
+
+SnapshotOp::SnapshotOp(std::string snapshot_dir, int32_t num_shards)
+    : PipelineOp(0),
+      snapshot_dir_(std::move(snapshot_dir)),
+      num_shards_(num_shards),
+      writing_(!snapshot_dir_.empty()),
+      finished_(false),
+      num_rows_(0) {
+  tmp_dir_ = snapshot_dir_ + "_tmp_" + Services::GetUniqueID();
+}
+
+SnapshotOp::~SnapshotOp() {
+  if (!shard_files_.empty() || finished_) {
+    // The first pass never completed, or its snapshot was never published, drop what has been written
+    MS_LOG(WARNING) << "Snapshot " << snapshot_dir_ << " is not published and will be discarded.";
+    shard_files_.clear();
+    RemoveTmpDir();
+  }
+}
+
+void SnapshotOp::Print(std::ostream &out, bool show_all) const {
+  if (!show_all) {
+    // Call the super class for displaying any common 1-liner info
+    PipelineOp::Print(out, show_all);
+    // Then show any custom derived-internal 1-liner info for this op
+    out << " [shards: " << num_shards_ << "]\n";
+  } else {
+    // Call the super class for displaying any common detailed info
+    PipelineOp::Print(out, show_all);
+    // Then show any custom derived-internal stuff
+    out << "\nSnapshot dir: " << snapshot_dir_ << "\nNumber of shards: " << num_shards_ << "\n\n";
+  }
+}
+
+Status SnapshotOp::operator()() { RETURN_STATUS_UNEXPECTED("[Internal ERROR] SnapshotOp is an inlined operator."); }
+
+bool SnapshotOp::SnapshotReady(const std::string &snapshot_dir) {
+  return Path(snapshot_dir + "/" + kManifestFile).Exists();
+}
+
+Status SnapshotOp::SerializeRow(const TensorRow &row, std::ostream *out, uint64_t *num_bytes) {
+  RETURN_UNEXPECTED_IF_NULL(out);
+  RETURN_UNEXPECTED_IF_NULL(num_bytes);
+  uint64_t written = 0;
+  WritePod(out, static_cast<uint64_t>(row.size()));
+  written += sizeof(uint64_t);
+  for (const auto &tensor : row) {
+    RETURN_UNEXPECTED_IF_NULL(tensor);
+    std::vector<dsize_t> dims = tensor->shape().AsVector();
+    auto len = static_cast<uint64_t>(tensor->SizeInBytes());
+    WritePod(out, static_cast<uint32_t>(tensor->type().value()));
+    WritePod(out, static_cast<uint32_t>(dims.size()));
+    for (auto dim : dims) {
+      WritePod(out, static_cast<int64_t>(dim));
+    }
+    WritePod(out, len);
+    if (len > 0) {
+      (void)out->write(reinterpret_cast<const char *>(tensor->GetBuffer()), static_cast<std::streamsize>(len));
+    }
+    uint64_t pad = (kSnapshotAlign - len % kSnapshotAlign) % kSnapshotAlign;
+    (void)out->write(kPadding, static_cast<std::streamsize>(pad));
+    written += sizeof(uint32_t) * 2 + sizeof(int64_t) * dims.size() + sizeof(uint64_t) + len + pad;
+  }
+  CHECK_FAIL_RETURN_UNEXPECTED(out->good(), "Failed to write snapshot, check disk space and permission.");
+  *num_bytes = written;
+  return Status::OK();
+}
+
+Status SnapshotOp::DeserializeRow(const uint8_t *data, uint64_t num_bytes, TensorRow *row) {
+  RETURN_UNEXPECTED_IF_NULL(data);
+  RETURN_UNEXPECTED_IF_NULL(row);
+  uint64_t pos = 0;
+  uint64_t num_cols = 0;
+  RETURN_IF_NOT_OK(ReadPod(data, num_bytes, &pos, &num_cols));
+  row->reserve(num_cols);
+  for (uint64_t i = 0; i < num_cols; ++i) {
+    uint32_t type = 0;
+    uint32_t rank = 0;
+    RETURN_IF_NOT_OK(ReadPod(data, num_bytes, &pos, &type));
+    RETURN_IF_NOT_OK(ReadPod(data, num_bytes, &pos, &rank));
+    CHECK_FAIL_RETURN_UNEXPECTED(type < DataType::NUM_OF_TYPES, "Invalid snapshot, unknown tensor type.");
+    std::vector<dsize_t> dims(rank);
+    for (uint32_t d = 0; d < rank; ++d) {
+      int64_t dim = 0;
+      RETURN_IF_NOT_OK(ReadPod(data, num_bytes, &pos, &dim));
+      dims[d] = static_cast<dsize_t>(dim);
+    }
+    uint64_t len = 0;
+    RETURN_IF_NOT_OK(ReadPod(data, num_bytes, &pos, &len));
+    CHECK_FAIL_RETURN_UNEXPECTED(pos + len <= num_bytes, "Invalid snapshot, tensor data is truncated.");
+    DataType data_type(static_cast<DataType::Type>(type));
+    std::shared_ptr<Tensor> tensor;
+    if (len > 0) {
+      RETURN_IF_NOT_OK(
+        Tensor::CreateFromMemory(TensorShape(dims), data_type, data + pos, static_cast<dsize_t>(len), &tensor));
+    } else {
+      RETURN_IF_NOT_OK(Tensor::CreateEmpty(TensorShape(dims), data_type, &tensor));
+    }
+    row->push_back(std::move(tensor));
+    pos += len + (kSnapshotAlign - len % kSnapshotAlign) % kSnapshotAlign;
+  }
+  return Status::OK();
+}
+
+Status SnapshotOp::OpenShards() {
+  RETURN_IF_NOT_OK(Path(tmp_dir_).CreateDirectories());
+  for (int32_t i = 0; i < num_shards_; ++i) {
+    std::string file_name = tmp_dir_ + "/" + ShardName(i, ".data");
+    auto file = std::make_unique<std::ofstream>(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+    CHECK_FAIL_RETURN_UNEXPECTED(file->is_open(), "Failed to open snapshot file: " + file_name);
+    shard_files_.push_back(std::move(file));
+    shard_offsets_.emplace_back(1, 0);
+  }
+  return Status::OK();
+}
+
+Status SnapshotOp::Finish() {
+  for (int32_t i = 0; i < num_shards_; ++i) {
+    shard_files_[i]->close();
+    CHECK_FAIL_RETURN_UNEXPECTED(!shard_files_[i]->fail(), "Failed to close snapshot shard " + std::to_string(i));
+    std::string index_name = tmp_dir_ + "/" + ShardName(i, ".index");
+    std::ofstream index(index_name, std::ios::out | std::ios::binary | std::ios::trunc);
+    CHECK_FAIL_RETURN_UNEXPECTED(index.is_open(), "Failed to open snapshot file: " + index_name);
+    (void)index.write(reinterpret_cast<const char *>(shard_offsets_[i].data()),
+                      static_cast<std::streamsize>(shard_offsets_[i].size() * sizeof(uint64_t)));
+    index.close();
+    CHECK_FAIL_RETURN_UNEXPECTED(!index.fail(), "Failed to write snapshot file: " + index_name);
+  }
+  shard_files_.clear();
+
+  std::vector<std::pair<std::string, int32_t>> columns(column_name_id_map_.begin(), column_name_id_map_.end());
+  std::sort(columns.begin(), columns.end(), [](const auto &a, const auto &b) { return a.second < b.second; });
+  nlohmann::json manifest;
+  manifest["num_rows"] = num_rows_;
+  manifest["num_shards"] = num_shards_;
+  std::vector<std::string> names;
+  (void)std::transform(columns.begin(), columns.end(), std::back_inserter(names),
+                       [](const auto &col) { return col.first; });
+  manifest["columns"] = names;
+  std::string manifest_name = tmp_dir_ + "/" + kManifestFile;
+  std::ofstream manifest_file(manifest_name, std::ios::out | std::ios::trunc);
+  CHECK_FAIL_RETURN_UNEXPECTED(manifest_file.is_open(), "Failed to open snapshot file: " + manifest_name);
+  manifest_file << manifest.dump();
+  manifest_file.close();
+  CHECK_FAIL_RETURN_UNEXPECTED(!manifest_file.fail(), "Failed to write snapshot file: " + manifest_name);
+  finished_ = true;
+  return Status::OK();
+}
+
+Status SnapshotOp::Finalize() {
+  finished_ = false;
+  std::string manifest_name = tmp_dir_ + "/" + kManifestFile;
+  // Publish the snapshot, another pipeline may have won the race, in which case ours is dropped
+  if (std::rename(tmp_dir_.c_str(), snapshot_dir_.c_str()) != 0) {
+    MS_LOG(WARNING) << "Snapshot " << snapshot_dir_ << " already exists, discard the one just written.";
+    for (int32_t i = 0; i < num_shards_; ++i) {
+      RETURN_IF_NOT_OK(Path(tmp_dir_ + "/" + ShardName(i, ".data")).Remove());
+      RETURN_IF_NOT_OK(Path(tmp_dir_ + "/" + ShardName(i, ".index")).Remove());
+    }
+    RETURN_IF_NOT_OK(Path(manifest_name).Remove());
+    RETURN_IF_NOT_OK(Path(tmp_dir_).Remove());
+  } else {
+    MS_LOG(INFO) << "Snapshot " << snapshot_dir_ << " is written with " << num_rows_ << " rows.";
+  }
+  return Status::OK();
+}
+
+void SnapshotOp::RemoveTmpDir() {
+  // Best effort, the files of an unfinished pass may not all exist
+  for (int32_t i = 0; i < num_shards_; ++i) {
+    (void)Path(tmp_dir_ + "/" + ShardName(i, ".data")).Remove();
+    (void)Path(tmp_dir_ + "/" + ShardName(i, ".index")).Remove();
+  }
+  (void)Path(tmp_dir_ + "/" + kManifestFile).Remove();
+  (void)Path(tmp_dir_).Remove();
+}
+
+Status SnapshotOp::Terminate() {
+  // The iterator stops the tree without pulling EOF, the first pass is complete though
+  if (finished_) {
+    RETURN_IF_NOT_OK(Finalize());
+  }
+  return Status::OK();
+}
+
+Status SnapshotOp::GetNextRow(TensorRow *row) {
+  RETURN_UNEXPECTED_IF_NULL(row);
+  RETURN_IF_NOT_OK(child_[0]->GetNextRow(row));
+  if (row->eof() && (writing_ || finished_)) {
+    // The pipeline ran to its end, the snapshot can be published
+    if (writing_ && !shard_files_.empty()) {
+      RETURN_IF_NOT_OK(Finish());
+    }
+    writing_ = false;
+    if (finished_) {
+      RETURN_IF_NOT_OK(Finalize());
+    }
+    return Status::OK();
+  }
+  if (!writing_) {
+    return Status::OK();
+  }
+  if (row->eoe()) {
+    // The first pass is complete, from now on rows only pass through
+    writing_ = false;
+    if (!shard_files_.empty()) {
+      RETURN_IF_NOT_OK(Finish());
+    }
+    return Status::OK();
+  }
+  if (row->empty()) {
+    return Status::OK();
+  }
+  if (shard_files_.empty()) {
+    RETURN_IF_NOT_OK(OpenShards());
+  }
+  int32_t shard = static_cast<int32_t>(num_rows_ % num_shards_);
+  uint64_t num_bytes = 0;
+  RETURN_IF_NOT_OK(SerializeRow(*row, shard_files_[shard].get(), &num_bytes));
+  shard_offsets_[shard].push_back(shard_offsets_[shard].back() + num_bytes);
+  num_rows_++;
+  return Status::OK();
+}
+}  // namespace dataset
+}  // namespace mindspore
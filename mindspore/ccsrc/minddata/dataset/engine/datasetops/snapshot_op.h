@@ -0,0 +1,109 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_CCSRC_MINDDATA_DATASET_ENGINE_DATASETOPS_SNAPSHOT_OP_H_
+#define MINDSPORE_CCSRC_MINDDATA_DATASET_ENGINE_DATASETOPS_SNAPSHOT_OP_H_
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "minddata/dataset/core/tensor_row.h"
+#include "minddata/dataset/engine/datasetops/pipeline_op.h"
+
+namespace mindspore {
+namespace dataset {
+// A snapshot is a directory named after the CRC of the pipeline it materializes. It holds
+//   - shard_<i>.data  : the serialized rows, row r is in shard r % num_shards
+//   - shard_<i>.index : the byte offset of every row in the data file, plus the end of the last row
+//   - manifest.json   : column names, number of rows and number of shards
+// The manifest is written last and the directory only gets its final name once it is complete,
+// so a snapshot directory that exists is always usable.
+//
+// SnapshotOp is the inlined operator that writes a snapshot. It passes the rows of its child
+// through unchanged and writes out the rows of the first pass over its child, up to the first EOE.
+// A Repeat inside the child only sends its EOE after its last repeat, so the first pass holds all
+// of them. The snapshot is published at EOF, or when the tree is terminated after the first pass,
+// as the iterator never pulls EOF. SnapshotReaderOp reads the rows back.
+class SnapshotOp : public PipelineOp {
+ public:
+  static constexpr char kManifestFile[] = "manifest.json";
+
+  /// \brief Constructor
+  /// \param[in] snapshot_dir Final directory of the snapshot, empty to only pass the rows through
+  /// \param[in] num_shards Number of shard files to spread the rows over
+  SnapshotOp(std::string snapshot_dir, int32_t num_shards);
+
+  /// \brief Destructor, removes a snapshot that was not published
+  ~SnapshotOp() override;
+
+  /// \brief A print method typically used for debugging
+  /// \param[out] out The output stream to write output to
+  /// \param[in] show_all A bool to control if you want to show all info or just a summary
+  void Print(std::ostream &out, bool show_all) const override;
+
+  /// \brief SnapshotOp is inlined, it has no thread of its own.
+  Status operator()() override;
+
+  /// \brief Get the next row from the child and write it to the snapshot when still writing.
+  /// \param[out] row Fetched row
+  /// \return Status The status code returned
+  Status GetNextRow(TensorRow *row) override;
+
+  /// \brief Publish the snapshot when the tree is terminated after the first pass.
+  /// \return Status The status code returned
+  Status Terminate() override;
+
+  /// \brief Op name getter
+  /// \return Name of the current Op
+  std::string Name() const override { return kSnapshotOp; }
+
+  /// \brief Check if a complete snapshot exists in a directory.
+  static bool SnapshotReady(const std::string &snapshot_dir);
+
+  /// \brief Serialize a row to a stream. Every tensor is written as type, rank, dims, number of bytes
+  ///     and the raw buffer, padded to 8 bytes so the next tensor stays aligned when mapped.
+  static Status SerializeRow(const TensorRow &row, std::ostream *out, uint64_t *num_bytes);
+
+  /// \brief Deserialize a row written by SerializeRow.
+  static Status DeserializeRow(const uint8_t *data, uint64_t num_bytes, TensorRow *row);
+
+ private:
+  /// \brief Create the temporary directory and open the shard files.
+  Status OpenShards();
+
+  /// \brief Close the shard files and write index and manifest.
+  Status Finish();
+
+  /// \brief Publish the snapshot under its final name.
+  Status Finalize();
+
+  /// \brief Remove the temporary directory and the files written to it.
+  void RemoveTmpDir();
+
+  std::string snapshot_dir_;  // final directory of the snapshot
+  std::string tmp_dir_;       // directory the snapshot is written to before it is complete
+  int32_t num_shards_;
+  bool writing_;   // the rows of the first pass are being written
+  bool finished_;  // the first pass is written and waits for EOF to be published
+  int64_t num_rows_;
+  std::vector<std::unique_ptr<std::ofstream>> shard_files_;
+  std::vector<std::vector<uint64_t>> shard_offsets_;
+};
+}  // namespace dataset
+}  // namespace mindspore
+
+#endif  // MINDSPORE_CCSRC_MINDDATA_DATASET_ENGINE_DATASETOPS_SNAPSHOT_OP_H_
@@ -0,0 +1,191 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "minddata/dataset/engine/datasetops/source/snapshot_reader_op.h"
+
+#include <fstream>
+#include <utility>
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <nlohmann/json.hpp>
+
+#include "minddata/dataset/engine/datasetops/snapshot_op.h"
+#include "minddata/dataset/engine/datasetops/source/sampler/sequential_sampler.h"
+#include "minddata/dataset/util/log_adapter.h"
+
+namespace mindspore {
+namespace dataset {
+namespace {
+Status ReadManifest(const std::string &snapshot_dir, nlohmann::json *manifest) {
+  std::string file_name = snapshot_dir + "/" + SnapshotOp::kManifestFile;
+  std::ifstream in(file_name);
+  CHECK_FAIL_RETURN_UNEXPECTED(in.is_open(), "Invalid snapshot, failed to open " + file_name);
+  try {
+    in >> *manifest;
+    CHECK_FAIL_RETURN_UNEXPECTED(manifest->contains("num_rows") && manifest->contains("num_shards") &&
+                                   manifest->contains("columns"),
+                                 "Invalid snapshot, manifest is incomplete: " + file_name);
+  } catch (const std::exception &err) {
+    RETURN_STATUS_UNEXPECTED("Invalid snapshot, failed to parse " + file_name + ": " + err.what());
+  }
+  return Status::OK();
+}
+}  // namespace
+
+SnapshotReaderOp::SnapshotReaderOp(int32_t num_workers, int32_t op_connector_size, std::string snapshot_dir)
+    : MappableLeafOp(num_workers, op_connector_size, std::make_shared<SequentialSamplerRT>(0, 0)),
+      snapshot_dir_(std::move(snapshot_dir)) {}
+
+SnapshotReaderOp::~SnapshotReaderOp() {
+#if !defined(_WIN32) && !defined(_WIN64)
+  for (auto &shard : shards_) {
+    if (shard.mapped) {
+      (void)munmap(const_cast<uint8_t *>(shard.data), shard.size);
+    }
+  }
+#endif
+}
+
+void SnapshotReaderOp::Print(std::ostream &out, bool show_all) const {
+  if (!show_all) {
+    // Call the super class for displaying any common 1-liner info
+    ParallelOp::Print(out, show_all);
+    // Then show any custom derived-internal 1-liner info for this op
+    out << " [total rows: " << num_rows_ << "]\n";
+  } else {
+    // Call the super class for displaying any common detailed info
+    ParallelOp::Print(out, show_all);
+    // Then show any custom derived-internal stuff
+    out << "\nSnapshot dir: " << snapshot_dir_ << "\nNumber of rows: " << num_rows_
+        << "\nNumber of shards: " << shards_.size() << "\n\n";
+  }
+}
+
+Status SnapshotReaderOp::CountTotalRows(const std::string &snapshot_dir, int64_t *count) {
+  RETURN_UNEXPECTED_IF_NULL(count);
+  nlohmann::json manifest;
+  RETURN_IF_NOT_OK(ReadManifest(snapshot_dir, &manifest));
+  *count = manifest["num_rows"].get<int64_t>();
+  return Status::OK();
+}
+
+Status SnapshotReaderOp::OpenShard(int32_t shard_id, Shard *shard) {
+  std::string prefix = snapshot_dir_ + "/shard_" + std::to_string(shard_id);
+  std::string index_name = prefix + ".index";
+  std::ifstream index(index_name, std::ios::in | std::ios::binary | std::ios::ate);
+  CHECK_FAIL_RETURN_UNEXPECTED(index.is_open(), "Invalid snapshot, failed to open " + index_name);
+  auto index_size = static_cast<uint64_t>(index.tellg());
+  CHECK_FAIL_RETURN_UNEXPECTED(index_size >= sizeof(uint64_t) && index_size % sizeof(uint64_t) == 0,
+                               "Invalid snapshot, index file is corrupted: " + index_name);
+  shard->offsets.resize(index_size / sizeof(uint64_t));
+  (void)index.seekg(0);
+  (void)index.read(reinterpret_cast<char *>(shard->offsets.data()), static_cast<std::streamsize>(index_size));
+  CHECK_FAIL_RETURN_UNEXPECTED(index.good(), "Invalid snapshot, failed to read " + index_name);
+
+  std::string data_name = prefix + ".data";
+#if !defined(_WIN32) && !defined(_WIN64)
+  int fd = open(data_name.c_str(), O_RDONLY);
+  CHECK_FAIL_RETURN_UNEXPECTED(fd >= 0, "Invalid snapshot, failed to open " + data_name);
+  struct stat st {};
+  if (fstat(fd, &st) != 0) {
+    (void)close(fd);
+    RETURN_STATUS_UNEXPECTED("Invalid snapshot, failed to stat " + data_name);
+  }
+  shard->size = static_cast<uint64_t>(st.st_size);
+  if (shard->size > 0) {
+    void *p = mmap(nullptr, shard->size, PROT_READ, MAP_SHARED, fd, 0);
+    if (p != MAP_FAILED) {
+      shard->data = reinterpret_cast<const uint8_t *>(p);
+      shard->mapped = true;
+      (void)madvise(p, shard->size, MADV_WILLNEED);
+    }
+  }
+  (void)close(fd);
+#endif
+  if (!shard->mapped) {
+    // Mapping is not available, hold the whole shard in memory instead
+    std::ifstream data(data_name, std::ios::in | std::ios::binary | std::ios::ate);
+    CHECK_FAIL_RETURN_UNEXPECTED(data.is_open(), "Invalid snapshot, failed to open " + data_name);
+    shard->size = static_cast<uint64_t>(data.tellg());
+    shard->buffer.resize(shard->size);
+    (void)data.seekg(0);
+    (void)data.read(reinterpret_cast<char *>(shard->buffer.data()), static_cast<std::streamsize>(shard->size));
+    CHECK_FAIL_RETURN_UNEXPECTED(data.good(), "Invalid snapshot, failed to read " + data_name);
+    shard->data = shard->buffer.data();
+  }
+  CHECK_FAIL_RETURN_UNEXPECTED(shard->offsets.back() <= shard->size,
+                               "Invalid snapshot, data file is shorter than its index: " + data_name);
+  return Status::OK();
+}
+
+Status SnapshotReaderOp::PrepareData() {
+  nlohmann::json manifest;
+  RETURN_IF_NOT_OK(ReadManifest(snapshot_dir_, &manifest));
+  num_rows_ = manifest["num_rows"].get<int64_t>();
+  auto num_shards = manifest["num_shards"].get<int32_t>();
+  if (columns_.empty()) {
+    columns_ = manifest["columns"].get<std::vector<std::string>>();
+  }
+  CHECK_FAIL_RETURN_UNEXPECTED(num_shards > 0, "Invalid snapshot, number of shards should be positive.");
+  shards_.resize(num_shards);
+  int64_t total = 0;
+  for (int32_t i = 0; i < num_shards; ++i) {
+    RETURN_IF_NOT_OK(OpenShard(i, &shards_[i]));
+    total += static_cast<int64_t>(shards_[i].offsets.size()) - 1;
+  }
+  CHECK_FAIL_RETURN_UNEXPECTED(total == num_rows_, "Invalid snapshot, manifest records " + std::to_string(num_rows_) +
+                                                     " rows but the shards hold " + std::to_string(total) + ".");
+  return Status::OK();
+}
+
+Status SnapshotReaderOp::LoadTensorRow(row_id_type row_id, TensorRow *row) {
+  RETURN_UNEXPECTED_IF_NULL(row);
+  CHECK_FAIL_RETURN_UNEXPECTED(row_id >= 0 && row_id < num_rows_, "[Internal ERROR] Wrong index.");
+  const auto num_shards = static_cast<row_id_type>(shards_.size());
+  const Shard &shard = shards_[row_id % num_shards];
+  const auto local_id = static_cast<size_t>(row_id / num_shards);
+  uint64_t begin = shard.offsets[local_id];
+  uint64_t end = shard.offsets[local_id + 1];
+  CHECK_FAIL_RETURN_UNEXPECTED(begin <= end && end <= shard.size, "Invalid snapshot, index file is corrupted.");
+  RETURN_IF_NOT_OK(SnapshotOp::DeserializeRow(shard.data + begin, end - begin, row));
+  CHECK_FAIL_RETURN_UNEXPECTED(row->size() == columns_.size(),
+                               "Invalid snapshot, row has " + std::to_string(row->size()) + " columns, expected " +
+                                 std::to_string(columns_.size()) + ".");
+  row->setPath(std::vector<std::string>(row->size(), snapshot_dir_));
+  return Status::OK();
+}
+
+Status SnapshotReaderOp::ComputeColMap() {
+  // Set the column name map (base class field)
+  if (column_name_id_map_.empty()) {
+    if (columns_.empty()) {
+      nlohmann::json manifest;
+      RETURN_IF_NOT_OK(ReadManifest(snapshot_dir_, &manifest));
+      columns_ = manifest["columns"].get<std::vector<std::string>>();
+    }
+    for (size_t i = 0; i < columns_.size(); ++i) {
+      column_name_id_map_[columns_[i]] = static_cast<int32_t>(i);
+    }
+  } else {
+    MS_LOG(WARNING) << "Column name map is already set!";
+  }
+  return Status::OK();
+}
+}  // namespace dataset
+}  // namespace mindspore
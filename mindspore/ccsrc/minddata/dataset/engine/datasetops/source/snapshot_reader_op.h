@@ -0,0 +1,83 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_CCSRC_MINDDATA_DATASET_ENGINE_DATASETOPS_SOURCE_SNAPSHOT_READER_OP_H_
+#define MINDSPORE_CCSRC_MINDDATA_DATASET_ENGINE_DATASETOPS_SOURCE_SNAPSHOT_READER_OP_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "minddata/dataset/core/tensor_row.h"
+#include "minddata/dataset/engine/datasetops/source/mappable_leaf_op.h"
+#include "minddata/dataset/util/status.h"
+
+namespace mindspore {
+namespace dataset {
+// SnapshotReaderOp replays a snapshot written by SnapshotOp in place of the pipeline it was taken from.
+// The shard files are memory mapped, so a row costs one copy from the page cache into its tensors and
+// no decode or transform work at all.
+class SnapshotReaderOp : public MappableLeafOp {
+ public:
+  /// \brief Constructor
+  /// \param[in] num_workers Number of workers reading rows in parallel
+  /// \param[in] op_connector_size Size of the output connector
+  /// \param[in] snapshot_dir Directory of a complete snapshot
+  SnapshotReaderOp(int32_t num_workers, int32_t op_connector_size, std::string snapshot_dir);
+
+  /// \brief Destructor, unmaps the shard files
+  ~SnapshotReaderOp() override;
+
+  /// \brief A print method typically used for debugging
+  /// \param[out] out The output stream to write output to
+  /// \param[in] show_all A bool to control if you want to show all info or just a summary
+  void Print(std::ostream &out, bool show_all) const override;
+
+  /// \brief Op name getter
+  /// \return Name of the current Op
+  std::string Name() const override { return "SnapshotReaderOp"; }
+
+  /// \brief Read the number of rows from the manifest of a snapshot.
+  static Status CountTotalRows(const std::string &snapshot_dir, int64_t *count);
+
+ protected:
+  /// \brief Read the manifest and map the shard files.
+  Status PrepareData() override;
+
+  /// \brief Load a row from the shard holding it.
+  Status LoadTensorRow(row_id_type row_id, TensorRow *row) override;
+
+ private:
+  struct Shard {
+    const uint8_t *data = nullptr;  // start of the mapped data file
+    uint64_t size = 0;              // size of the data file
+    bool mapped = false;            // whether data points to a mapping of the file
+    std::vector<uint64_t> offsets;  // offset of every row, plus the end of the last one
+    std::vector<uint8_t> buffer;    // file content when it could not be mapped
+  };
+
+  /// \brief Map one shard data file and read its index.
+  Status OpenShard(int32_t shard_id, Shard *shard);
+
+  /// \brief Private function for computing the assignment of the column name map.
+  Status ComputeColMap() override;
+
+  std::string snapshot_dir_;
+  std::vector<std::string> columns_;
+  std::vector<Shard> shards_;
+};
+}  // namespace dataset
+}  // namespace mindspore
+
+#endif  // MINDSPORE_CCSRC_MINDDATA_DATASET_ENGINE_DATASETOPS_SOURCE_SNAPSHOT_READER_OP_H_
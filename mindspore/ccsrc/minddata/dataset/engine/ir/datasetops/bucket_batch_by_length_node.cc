@@ -33,21 +33,23 @@ BucketBatchByLengthNode::BucketBatchByLengthNode(
   const std::vector<int32_t> &bucket_boundaries, const std::vector<int32_t> &bucket_batch_sizes,
   std::shared_ptr<TensorOp> element_length_function,
   const std::map<std::string, std::pair<TensorShape, std::shared_ptr<Tensor>>> &pad_info, bool pad_to_bucket_boundary,
-  bool drop_remainder)
+  bool drop_remainder, int32_t max_tokens, int32_t window_size)
     : column_names_(column_names),
       bucket_boundaries_(bucket_boundaries),
       bucket_batch_sizes_(bucket_batch_sizes),
       element_length_function_(element_length_function),
       pad_info_(pad_info),
       pad_to_bucket_boundary_(pad_to_bucket_boundary),
-      drop_remainder_(drop_remainder) {
+      drop_remainder_(drop_remainder),
+      max_tokens_(max_tokens),
+      window_size_(window_size) {
   this->AddChild(child);
 }
 
 std::shared_ptr<DatasetNode> BucketBatchByLengthNode::Copy() {
   auto node = std::make_shared<BucketBatchByLengthNode>(nullptr, column_names_, bucket_boundaries_, bucket_batch_sizes_,
                                                         element_length_function_, pad_info_, pad_to_bucket_boundary_,
-                                                        drop_remainder_);
+                                                        drop_remainder_, max_tokens_, window_size_);
   return node;
 }
 
@@ -79,6 +81,9 @@ void BucketBatchByLengthNode::Print(std::ostream &out) const {
     }
     i++;
   }
+  if (max_tokens_ > 0) {
+    out << ",max_tokens:" << max_tokens_ << ",window_size:" << window_size_;
+  }
   out << ")";
 }
 
@@ -86,7 +91,7 @@ Status BucketBatchByLengthNode::Build(std::vector<std::shared_ptr<DatasetOp>> *c
   bucket_boundaries_.insert(bucket_boundaries_.begin(), 0);
   auto op = std::make_shared<BucketBatchByLengthOp>(column_names_, bucket_boundaries_, bucket_batch_sizes_,
                                                     element_length_function_, pad_info_, pad_to_bucket_boundary_,
-                                                    drop_remainder_, connector_que_size_);
+                                                    drop_remainder_, max_tokens_, window_size_, connector_que_size_);
   op->SetTotalRepeats(GetTotalRepeats());
   op->SetNumRepeatsPerEpoch(GetNumRepeatsPerEpoch());
   node_ops->push_back(op);
@@ -105,6 +110,31 @@ Status BucketBatchByLengthNode::ValidateParams() {
     LOG_AND_RETURN_STATUS_SYNTAX_ERROR(err_msg);
   }
 
+  if (!column_names_.empty()) {
+    RETURN_IF_NOT_OK(ValidateDatasetColumnParam("BucketBatchByLengthNode", "column_names", column_names_));
+  }
+
+  if (max_tokens_ < 0) {
+    std::string err_msg =
+      "BucketBatchByLengthNode: max_tokens must be greater than or equal to 0, but got: " + std::to_string(max_tokens_);
+    LOG_AND_RETURN_STATUS_SYNTAX_ERROR(err_msg);
+  }
+
+  // In token budget mode the buckets are not used
+  if (max_tokens_ > 0) {
+    if (window_size_ <= 0) {
+      std::string err_msg =
+        "BucketBatchByLengthNode: window_size must be positive when max_tokens is set, but got: " +
+        std::to_string(window_size_);
+      LOG_AND_RETURN_STATUS_SYNTAX_ERROR(err_msg);
+    }
+    if (pad_to_bucket_boundary_) {
+      std::string err_msg = "BucketBatchByLengthNode: pad_to_bucket_boundary can not be used when max_tokens is set.";
+      LOG_AND_RETURN_STATUS_SYNTAX_ERROR(err_msg);
+    }
+    return Status::OK();
+  }
+
   // Check bucket_boundaries: must be positive and strictly increasing
   if (bucket_boundaries_.empty()) {
     std::string err_msg = "BucketBatchByLengthNode: bucket_boundaries cannot be empty.";
@@ -127,10 +157,6 @@ Status BucketBatchByLengthNode::ValidateParams() {
     }
   }
 
-  if (!column_names_.empty()) {
-    RETURN_IF_NOT_OK(ValidateDatasetColumnParam("BucketBatchByLengthNode", "column_names", column_names_));
-  }
-
   // Check bucket_batch_sizes: must be positive
   if (bucket_batch_sizes_.empty()) {
     std::string err_msg = "BucketBatchByLengthNode: bucket_batch_sizes must be non-empty";
@@ -34,7 +34,8 @@ class BucketBatchByLengthNode : public DatasetNode {
                           const std::vector<int32_t> &bucket_boundaries, const std::vector<int32_t> &bucket_batch_sizes,
                           std::shared_ptr<TensorOp> element_length_function = nullptr,
                           const std::map<std::string, std::pair<TensorShape, std::shared_ptr<Tensor>>> &pad_info = {},
-                          bool pad_to_bucket_boundary = false, bool drop_remainder = false);
+                          bool pad_to_bucket_boundary = false, bool drop_remainder = false, int32_t max_tokens = 0,
+                          int32_t window_size = 0);
 
   /// \brief Destructor
   ~BucketBatchByLengthNode() override = default;
@@ -70,6 +71,8 @@ class BucketBatchByLengthNode : public DatasetNode {
   const std::map<std::string, std::pair<TensorShape, std::shared_ptr<Tensor>>> &PadInfo() const { return pad_info_; }
   bool PadToBucketBoundary() const { return pad_to_bucket_boundary_; }
   bool DropRemainder() const { return drop_remainder_; }
+  int32_t MaxTokens() const { return max_tokens_; }
+  int32_t WindowSize() const { return window_size_; }
 
  private:
   std::vector<std::string> column_names_;
@@ -79,6 +82,8 @@ class BucketBatchByLengthNode : public DatasetNode {
   std::map<std::string, std::pair<TensorShape, std::shared_ptr<Tensor>>> pad_info_;
   bool pad_to_bucket_boundary_;
   bool drop_remainder_;
+  int32_t max_tokens_;   // token budget of a batch, 0 to batch by buckets
+  int32_t window_size_;  // number of rows sorted together in token budget mode
 };
 }  // namespace dataset
 }  // namespace mindspore
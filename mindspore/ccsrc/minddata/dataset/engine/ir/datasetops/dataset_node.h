@@ -70,6 +70,7 @@ constexpr char kRepeatNode[] = "Repeat";
 constexpr char kRootNode[] = "Top";
 constexpr char kShuffleNode[] = "Shuffle";
 constexpr char kSkipNode[] = "Skip";
+constexpr char kSnapshotNode[] = "Snapshot";
 constexpr char kSyncWaitNode[] = "SyncWait";
 constexpr char kTakeNode[] = "Take";
 constexpr char kTransferNode[] = "Transfer";
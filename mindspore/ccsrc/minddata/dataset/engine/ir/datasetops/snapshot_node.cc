@@ -0,0 +1,139 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "minddata/dataset/engine/ir/datasetops/snapshot_node.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "minddata/dataset/engine/datasetops/snapshot_op.h"
+#include "minddata/dataset/engine/datasetops/source/snapshot_reader_op.h"
+#include "minddata/dataset/engine/opt/pass.h"
+#include "minddata/dataset/util/status.h"
+
+namespace mindspore {
+namespace dataset {
+// Constructor for SnapshotNode
+SnapshotNode::SnapshotNode(std::shared_ptr<DatasetNode> child, const std::string &path, int32_t num_shards)
+    : path_(path), num_shards_(num_shards) {
+  this->AddChild(child);
+}
+
+std::shared_ptr<DatasetNode> SnapshotNode::Copy() {
+  auto node = std::make_shared<SnapshotNode>(nullptr, path_, num_shards_);
+  node->SetNumWorkers(num_workers_);
+  node->SetConnectorQueueSize(connector_que_size_);
+  return node;
+}
+
+void SnapshotNode::Print(std::ostream &out) const {
+  out << (Name() + "(path:" + path_ + ",num_shards:" + std::to_string(num_shards_) + ",key:" + key_ +
+          ",reading:" + (reading_ ? "true" : "false") + ",pass_through:" + (pass_through_ ? "true" : "false") +
+          ")");
+}
+
+void SnapshotNode::UseSnapshot() {
+  // The rows come from disk from now on, the pipeline that produced them is not needed anymore
+  children_.clear();
+  reading_ = true;
+}
+
+// Function to build the SnapshotOp or the SnapshotReaderOp
+Status SnapshotNode::Build(std::vector<std::shared_ptr<DatasetOp>> *const node_ops) {
+  CHECK_FAIL_RETURN_UNEXPECTED(pass_through_ || !key_.empty(),
+                               "[Internal ERROR] Snapshot key is not set, SnapshotTransformPass is not run on the tree.");
+  std::shared_ptr<DatasetOp> op;
+  if (pass_through_) {
+    // Without a snapshot directory the op only passes the rows through
+    op = std::make_shared<SnapshotOp>("", num_shards_);
+  } else if (reading_) {
+    op = std::make_shared<SnapshotReaderOp>(num_workers_, connector_que_size_, SnapshotDir());
+  } else {
+    op = std::make_shared<SnapshotOp>(SnapshotDir(), num_shards_);
+  }
+  op->SetTotalRepeats(GetTotalRepeats());
+  op->SetNumRepeatsPerEpoch(GetNumRepeatsPerEpoch());
+  node_ops->push_back(op);
+  return Status::OK();
+}
+
+// Function to validate the parameters for SnapshotNode
+Status SnapshotNode::ValidateParams() {
+  RETURN_IF_NOT_OK(DatasetNode::ValidateParams());
+  if (path_.empty()) {
+    std::string err_msg = "Snapshot: 'path' should not be empty.";
+    LOG_AND_RETURN_STATUS_SYNTAX_ERROR(err_msg);
+  }
+  if (num_shards_ <= 0) {
+    std::string err_msg = "Snapshot: 'num_shards' should be positive, but got: " + std::to_string(num_shards_);
+    LOG_AND_RETURN_STATUS_SYNTAX_ERROR(err_msg);
+  }
+  return Status::OK();
+}
+
+// Get Dataset size
+Status SnapshotNode::GetDatasetSize(const std::shared_ptr<DatasetSizeGetter> &size_getter, bool estimate,
+                                    int64_t *dataset_size) {
+  if (dataset_size_ > 0) {
+    *dataset_size = dataset_size_;
+    return Status::OK();
+  }
+  if (reading_) {
+    RETURN_IF_NOT_OK(SnapshotReaderOp::CountTotalRows(SnapshotDir(), dataset_size));
+  } else {
+    RETURN_IF_NOT_OK(children_[0]->GetDatasetSize(size_getter, estimate, dataset_size));
+  }
+  dataset_size_ = *dataset_size;
+  return Status::OK();
+}
+
+// Visitor accepting method for IRNodePass
+Status SnapshotNode::Accept(IRNodePass *const p, bool *const modified) {
+  // Downcast shared pointer then call visitor
+  return p->Visit(shared_from_base<SnapshotNode>(), modified);
+}
+
+// Visitor accepting method for IRNodePass
+Status SnapshotNode::AcceptAfter(IRNodePass *const p, bool *const modified) {
+  // Downcast shared pointer then call visitor
+  return p->VisitAfter(shared_from_base<SnapshotNode>(), modified);
+}
+
+Status SnapshotNode::to_json(nlohmann::json *out_json) {
+  nlohmann::json args;
+  args["num_parallel_workers"] = num_workers_;
+  args["connector_queue_size"] = connector_que_size_;
+  args["path"] = path_;
+  args["num_shards"] = num_shards_;
+  *out_json = args;
+  return Status::OK();
+}
+
+Status SnapshotNode::from_json(nlohmann::json json_obj, std::shared_ptr<DatasetNode> ds,
+                               std::shared_ptr<DatasetNode> *result) {
+  RETURN_IF_NOT_OK(ValidateParamInJson(json_obj, "num_parallel_workers", kSnapshotNode));
+  RETURN_IF_NOT_OK(ValidateParamInJson(json_obj, "connector_queue_size", kSnapshotNode));
+  RETURN_IF_NOT_OK(ValidateParamInJson(json_obj, "path", kSnapshotNode));
+  RETURN_IF_NOT_OK(ValidateParamInJson(json_obj, "num_shards", kSnapshotNode));
+  std::string path = json_obj["path"];
+  int32_t num_shards = json_obj["num_shards"];
+  *result = std::make_shared<SnapshotNode>(ds, path, num_shards);
+  (void)(*result)->SetNumWorkers(json_obj["num_parallel_workers"]);
+  (void)(*result)->SetConnectorQueueSize(json_obj["connector_queue_size"]);
+  return Status::OK();
+}
+}  // namespace dataset
+}  // namespace mindspore
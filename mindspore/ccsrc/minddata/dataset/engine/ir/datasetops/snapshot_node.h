@@ -0,0 +1,125 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_CCSRC_MINDDATA_DATASET_ENGINE_IR_DATASETOPS_SNAPSHOT_NODE_H_
+#define MINDSPORE_CCSRC_MINDDATA_DATASET_ENGINE_IR_DATASETOPS_SNAPSHOT_NODE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "minddata/dataset/engine/ir/datasetops/dataset_node.h"
+
+namespace mindspore {
+namespace dataset {
+/// \class SnapshotNode
+/// \brief Materializes the rows of its child to disk during the first run of a pipeline, and replays them
+///     from disk in later runs of the same pipeline. The snapshot is keyed by the serialized child pipeline,
+///     SnapshotTransformPass computes the key and swaps the child out for the reader when a snapshot exists.
+class SnapshotNode : public DatasetNode {
+ public:
+  /// \brief Constructor
+  /// \param[in] child The pipeline to be materialized
+  /// \param[in] path Root directory the snapshots are kept in
+  /// \param[in] num_shards Number of shard files to spread the rows over
+  SnapshotNode(std::shared_ptr<DatasetNode> child, const std::string &path, int32_t num_shards);
+
+  /// \brief Destructor
+  ~SnapshotNode() override = default;
+
+  /// \brief Node name getter
+  /// \return Name of the current node
+  std::string Name() const override { return kSnapshotNode; }
+
+  /// \brief Print the description
+  /// \param out - The output stream to write output to
+  void Print(std::ostream &out) const override;
+
+  /// \brief Copy the node to a new object
+  /// \return A shared pointer to the new copy
+  std::shared_ptr<DatasetNode> Copy() override;
+
+  /// \brief a base class override function to create the required runtime dataset op objects for this class
+  /// \param node_ops - A vector containing shared pointer to the Dataset Ops that this object will create
+  /// \return Status Status::OK() if build successfully
+  Status Build(std::vector<std::shared_ptr<DatasetOp>> *const node_ops) override;
+
+  /// \brief Parameters validation
+  /// \return Status Status::OK() if all the parameters are valid
+  Status ValidateParams() override;
+
+  /// \brief Base-class override for GetDatasetSize
+  /// \param[in] size_getter Shared pointer to DatasetSizeGetter
+  /// \param[in] estimate This is only supported by some of the ops and it's used to speed up the process of getting
+  ///     dataset size at the expense of accuracy.
+  /// \param[out] dataset_size the size of the dataset
+  /// \return Status of the function
+  Status GetDatasetSize(const std::shared_ptr<DatasetSizeGetter> &size_getter, bool estimate,
+                        int64_t *dataset_size) override;
+
+  /// \brief Base-class override for accepting IRNodePass visitor
+  /// \param[in] p The node to visit
+  /// \param[out] modified Indicator if the node was modified
+  /// \return Status of the node visit
+  Status Accept(IRNodePass *const p, bool *const modified) override;
+
+  /// \brief Base-class override for accepting IRNodePass visitor
+  /// \param[in] p The node to visit
+  /// \param[out] modified Indicator if the node was modified
+  /// \return Status of the node visit
+  Status AcceptAfter(IRNodePass *const p, bool *const modified) override;
+
+  /// \brief Get the arguments of node
+  /// \param[out] out_json JSON string of all attributes
+  /// \return Status of the function
+  Status to_json(nlohmann::json *out_json) override;
+
+  /// \brief Function for read dataset operation from json
+  /// \param[in] json_obj The JSON object to be deserialized
+  /// \param[in] ds dataset node constructed
+  /// \param[out] result Deserialized dataset after the operation
+  /// \return Status The status code returned
+  static Status from_json(nlohmann::json json_obj, std::shared_ptr<DatasetNode> ds,
+                          std::shared_ptr<DatasetNode> *result);
+
+  /// \brief Set the key of the snapshot, the snapshot lives in <path>/<key>.
+  void SetKey(const std::string &key) { key_ = key; }
+
+  /// \brief Replay the snapshot instead of running the child pipeline, which is dropped from the tree.
+  void UseSnapshot();
+
+  /// \brief Run the child pipeline without the snapshot, for a pipeline that can't be keyed.
+  void PassThrough() { pass_through_ = true; }
+
+  /// \brief Getter functions
+  const std::string &SnapshotPath() const { return path_; }
+  int32_t NumShards() const { return num_shards_; }
+  const std::string &Key() const { return key_; }
+  bool IsReading() const { return reading_; }
+  bool IsPassThrough() const { return pass_through_; }
+
+  /// \brief Directory of the snapshot of this pipeline
+  std::string SnapshotDir() const { return path_ + "/" + key_; }
+
+ private:
+  std::string path_;
+  int32_t num_shards_;
+  std::string key_;
+  bool reading_ = false;
+  bool pass_through_ = false;
+};
+}  // namespace dataset
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_MINDDATA_DATASET_ENGINE_IR_DATASETOPS_SNAPSHOT_NODE_H_
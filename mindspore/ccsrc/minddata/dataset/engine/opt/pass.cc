@@ -36,6 +36,7 @@
 #include "minddata/dataset/engine/ir/datasetops/root_node.h"
 #include "minddata/dataset/engine/ir/datasetops/shuffle_node.h"
 #include "minddata/dataset/engine/ir/datasetops/skip_node.h"
+#include "minddata/dataset/engine/ir/datasetops/snapshot_node.h"
 #ifndef ENABLE_ANDROID
 #include "minddata/dataset/engine/ir/datasetops/source/minddata_node.h"
 #endif
@@ -243,6 +244,12 @@ Status IRNodePass::Visit(std::shared_ptr<SkipNode> node, bool *const modified) {
 Status IRNodePass::VisitAfter(std::shared_ptr<SkipNode> node, bool *const modified) {
   return VisitAfter(std::static_pointer_cast<DatasetNode>(node), modified);
 }
+Status IRNodePass::Visit(std::shared_ptr<SnapshotNode> node, bool *const modified) {
+  return Visit(std::static_pointer_cast<DatasetNode>(node), modified);
+}
+Status IRNodePass::VisitAfter(std::shared_ptr<SnapshotNode> node, bool *const modified) {
+  return VisitAfter(std::static_pointer_cast<DatasetNode>(node), modified);
+}
 Status IRNodePass::Visit(std::shared_ptr<TakeNode> node, bool *const modified) {
   return Visit(std::static_pointer_cast<DatasetNode>(node), modified);
 }
@@ -45,6 +45,7 @@ class RepeatNode;
 class RootNode;
 class ShuffleNode;
 class SkipNode;
+class SnapshotNode;
 class TakeNode;
 class TFRecordNode;
 class TransferNode;
@@ -204,6 +205,8 @@ class IRNodePass : public IRPass {
   virtual Status VisitAfter(std::shared_ptr<ShuffleNode> node, bool *const modified);
   virtual Status Visit(std::shared_ptr<SkipNode> node, bool *const modified);
   virtual Status VisitAfter(std::shared_ptr<SkipNode> node, bool *const modified);
+  virtual Status Visit(std::shared_ptr<SnapshotNode> node, bool *const modified);
+  virtual Status VisitAfter(std::shared_ptr<SnapshotNode> node, bool *const modified);
 #ifdef ENABLE_PYTHON
   virtual Status Visit(std::shared_ptr<SyncWaitNode> node, bool *const modified);
   virtual Status VisitAfter(std::shared_ptr<SyncWaitNode> node, bool *const modified);
@@ -0,0 +1,72 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "minddata/dataset/engine/opt/pre/snapshot_transform_pass.h"
+
+#include <iomanip>
+#include <sstream>
+
+#include "minddata/dataset/engine/datasetops/snapshot_op.h"
+#include "minddata/dataset/engine/ir/datasetops/snapshot_node.h"
+#include "minddata/dataset/engine/serdes.h"
+#include "utils/system/crc32c.h"
+
+namespace mindspore {
+namespace dataset {
+Status SnapshotTransformPass::PipelineKey(const std::shared_ptr<DatasetNode> &node, std::string *key) {
+  RETURN_UNEXPECTED_IF_NULL(node);
+  RETURN_UNEXPECTED_IF_NULL(key);
+  nlohmann::json pipeline;
+  Status rc = Serdes::SaveToJSON(node, "", &pipeline);
+  if (rc.IsError()) {
+    RETURN_STATUS_UNEXPECTED("Snapshot: the pipeline under the snapshot can not be serialized to identify it, " +
+                             rc.GetErrDescription());
+  }
+  std::string dump = pipeline.dump();
+  // The length goes with the CRC to make a collision between two different pipelines even less likely
+  std::stringstream ss;
+  ss << std::hex << std::setw(8) << std::setfill('0') << system::Crc32c::GetMaskCrc32cValue(dump.data(), dump.size())
+     << "_" << std::dec << dump.size();
+  *key = ss.str();
+  return Status::OK();
+}
+
+Status SnapshotTransformPass::Visit(std::shared_ptr<SnapshotNode> node, bool *const modified) {
+  MS_LOG(DEBUG) << "SnapshotTransformPass::Visit(<SnapshotNode>): visiting " << node->Name() << ".";
+  if (node->IsReading() || node->IsPassThrough() || !node->Key().empty()) {
+    return Status::OK();
+  }
+  CHECK_FAIL_RETURN_UNEXPECTED(node->Children().size() == 1, "Snapshot: expected exactly 1 child but got " +
+                                                                std::to_string(node->Children().size()) + ".");
+  *modified = true;
+  std::string key;
+  Status rc = PipelineKey(node->Children()[0], &key);
+  if (rc.IsError()) {
+    MS_LOG(WARNING) << rc.GetErrDescription() << " The pipeline runs without the snapshot.";
+    node->PassThrough();
+    return Status::OK();
+  }
+  node->SetKey(key);
+  if (SnapshotOp::SnapshotReady(node->SnapshotDir())) {
+    MS_LOG(INFO) << "Snapshot " << node->SnapshotDir() << " is found, it replaces the pipeline beneath it.";
+    node->UseSnapshot();
+  } else {
+    MS_LOG(INFO) << "Snapshot " << node->SnapshotDir() << " is not found, it is written in this run.";
+  }
+  return Status::OK();
+}
+}  // namespace dataset
+}  // namespace mindspore
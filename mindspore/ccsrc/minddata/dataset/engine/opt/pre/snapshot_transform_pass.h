@@ -0,0 +1,55 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_MINDDATA_DATASET_ENGINE_OPT_PRE_SNAPSHOT_TRANSFORM_PASS_H_
+#define MINDSPORE_CCSRC_MINDDATA_DATASET_ENGINE_OPT_PRE_SNAPSHOT_TRANSFORM_PASS_H_
+
+#include <memory>
+#include <string>
+#include "minddata/dataset/engine/opt/pass.h"
+
+namespace mindspore {
+namespace dataset {
+/// \class SnapshotTransformPass snapshot_transform_pass.h
+/// \brief This is a NodePass who's job is to key every SnapshotNode by the pipeline beneath it, and to switch the
+///     node to replay mode when a complete snapshot of that pipeline is already on disk.
+/// \note The key is derived from the serialized pipeline, so any change to a parameter of an operator beneath the
+///     snapshot gives a new key and the stale snapshot is not picked up. A pipeline that can't be serialized runs
+///     without the snapshot.
+class SnapshotTransformPass : public IRNodePass {
+ public:
+  /// \brief Constructor
+  SnapshotTransformPass() = default;
+
+  /// \brief Destructor
+  ~SnapshotTransformPass() = default;
+
+  /// \brief Compute the key of the snapshot and check if the snapshot can be replayed
+  /// \param[in] node The node being visited
+  /// \param[in,out] modified Indicator if the node was changed at all
+  /// \return Status The status code returned
+  Status Visit(std::shared_ptr<SnapshotNode> node, bool *const modified) override;
+
+  /// \brief Compute the key of the pipeline rooted at a node
+  /// \param[in] node Root of the pipeline
+  /// \param[out] key Key of the pipeline
+  /// \return Status The status code returned
+  static Status PipelineKey(const std::shared_ptr<DatasetNode> &node, std::string *key);
+};
+}  // namespace dataset
+}  // namespace mindspore
+
+#endif  // MINDSPORE_CCSRC_MINDDATA_DATASET_ENGINE_OPT_PRE_SNAPSHOT_TRANSFORM_PASS_H_
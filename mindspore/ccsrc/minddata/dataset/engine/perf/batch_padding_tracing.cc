@@ -0,0 +1,39 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "minddata/dataset/engine/perf/batch_padding_tracing.h"
+#include <mutex>
+#include <string>
+#include "minddata/dataset/util/path.h"
+
+namespace mindspore {
+namespace dataset {
+
+void BatchPaddingTracing::RecordPadding(int64_t num_tokens, int32_t batch_num, int64_t padded_tokens,
+                                        uint64_t time_stamp) {
+  if (!active_) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(lock_);
+  (void)value_.emplace_back(std::to_string(PADDING) + " " + std::to_string(num_tokens) + " " +
+                            std::to_string(batch_num) + " " + std::to_string(padded_tokens) + " " +
+                            std::to_string(time_stamp));
+}
+
+Path BatchPaddingTracing::GetFileName(const std::string &dir_path, const std::string &rank_id) {
+  return Path(dir_path) / Path("batch_padding_profiling_" + rank_id + ".txt");
+}
+}  // namespace dataset
+}  // namespace mindspore
@@ -0,0 +1,52 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_BATCH_PADDING_TRACING_H
+#define MINDSPORE_BATCH_PADDING_TRACING_H
+
+#include <cstdint>
+#include <string>
+#include "minddata/dataset/engine/perf/profiling.h"
+#include "minddata/dataset/util/path.h"
+
+namespace mindspore {
+namespace dataset {
+// Records the real and padded number of tokens of the batches sent by BucketBatchByLengthOp
+class BatchPaddingTracing : public Tracing {
+ public:
+  // Constructor
+  BatchPaddingTracing() = default;
+
+  // Destructor
+  ~BatchPaddingTracing() override = default;
+
+  std::string Name() const override { return kBatchPaddingTracingName; };
+
+  // Record a batch in the format of Tracing::Record with a PADDING type. The token counts of a batch can
+  // go beyond int32, so they are kept as int64 instead of going through TracingRecord.
+  // @param int64_t num_tokens - number of tokens in the batch
+  // @param int32_t batch_num - batch number
+  // @param int64_t padded_tokens - number of tokens in the batch including padding
+  // @param uint64_t time_stamp - time stamp
+  void RecordPadding(int64_t num_tokens, int32_t batch_num, int64_t padded_tokens, uint64_t time_stamp);
+
+ protected:
+  Path GetFileName(const std::string &dir_path, const std::string &rank_id) override;
+};
+}  // namespace dataset
+}  // namespace mindspore
+
+#endif  // MINDSPORE_BATCH_PADDING_TRACING_H
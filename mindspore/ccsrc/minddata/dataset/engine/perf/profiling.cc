@@ -91,16 +91,19 @@ Status Tracing::ChangeFileMode(const std::string &dir_path, const std::string &r
 void Tracing::Record(const int32_t type, const int32_t extra_info, const int32_t batch_num, const int32_t value,
                      const uint64_t time_stamp) {
   // Format: "type extra-info batch-num value"
-  // type: 0: time,  1: connector size
+  // type: 0: time,  1: connector size, 2: padding
   // extra-info: if type is 0 - 0: pipeline time, 1: push tdt time, 2: batch time
   //             if type is 1 - connector capacity
+  //             if type is 2 - number of tokens in the batch
   // batch-num: batch number
   // value: if type is 0 - value is time(ms)
   //        if type is 1 - value is connector size
+  //        if type is 2 - number of tokens in the batch including padding
   // time-stamp: time stamp
   // Examples:
   // 0 0 20 10 xxx- The 20th batch took 10ms to get data from pipeline.
   // 1 64 20 5 xxx- Connector size is 5 when get the 20th batch.Connector capacity is 64.
+  // 2 900 20 1024 xxx- The 20th batch holds 900 tokens and is padded to 1024 tokens.
   if (!active_) {
     return;
   }
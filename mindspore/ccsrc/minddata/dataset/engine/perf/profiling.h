@@ -41,6 +41,7 @@ const char kDeviceQueueTracingName[] = "Device_Queue_Tracing";
 const char kDatasetIteratorTracingName[] = "Dataset_Iterator_Tracing";
 const char kConnectorSizeSamplingName[] = "Connector_Size_Sampling";
 const char kCpuSamplerName[] = "Cpu_Sampler";
+const char kBatchPaddingTracingName[] = "Batch_Padding_Tracing";
 
 // Values for process memory metrics - common for profiling and cpu_sampler
 enum ProcessMemoryMetric { kPSS, kRSS, kVSS };
@@ -602,7 +603,7 @@ class ProfilingManager {
   Status TimeToStepInterval(uint64_t start_ts, uint64_t end_ts, int32_t *start_step, int32_t *end_step);
 };
 
-enum ProfilingType { TIME, CONNECTOR_DEPTH };
+enum ProfilingType { TIME, CONNECTOR_DEPTH, PADDING };
 
 enum ProfilingTimeSubType {
   PIPELINE_TIME,
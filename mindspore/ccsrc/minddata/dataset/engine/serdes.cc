@@ -216,6 +216,8 @@ Status Serdes::CreateDatasetOperationNode(const std::shared_ptr<DatasetNode> &ds
     RETURN_IF_NOT_OK(ShuffleNode::from_json(json_obj, ds, result));
   } else if (op_type == kSkipNode) {
     RETURN_IF_NOT_OK(SkipNode::from_json(json_obj, ds, result));
+  } else if (op_type == kSnapshotNode) {
+    RETURN_IF_NOT_OK(SnapshotNode::from_json(json_obj, ds, result));
   } else if (op_type == kTransferNode) {
     RETURN_IF_NOT_OK(TransferNode::from_json(json_obj, ds, result));
   } else if (op_type == kTakeNode) {
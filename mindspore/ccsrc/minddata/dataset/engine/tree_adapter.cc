@@ -37,6 +37,7 @@
 #include "minddata/dataset/engine/opt/pre/input_validation_pass.h"
 #include "minddata/dataset/engine/opt/pre/node_removal_pass.h"
 #include "minddata/dataset/engine/opt/pre/skip_pushdown_pass.h"
+#include "minddata/dataset/engine/opt/pre/snapshot_transform_pass.h"
 
 namespace mindspore {
 namespace dataset {
@@ -66,6 +67,7 @@ Status TreeAdapter::PrePass(std::shared_ptr<DatasetNode> ir) {
   actions.emplace_back(std::make_unique<EpochCtrlPass>());
   if (usage_ == kDeGetter) actions.emplace_back(std::make_unique<GetterPass>());
 #ifndef ENABLE_ANDROID
+  actions.emplace_back(std::make_unique<SnapshotTransformPass>());
   actions.emplace_back(std::make_unique<CacheTransformPass>());
 
   std::unique_ptr<NodeOffloadPass> offload = std::make_unique<NodeOffloadPass>();
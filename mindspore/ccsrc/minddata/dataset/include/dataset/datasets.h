@@ -77,6 +77,7 @@ class DSCallback;
 
 class RepeatDataset;
 class SkipDataset;
+class SnapshotDataset;
 class TakeDataset;
 class ZipDataset;
 
@@ -574,6 +575,25 @@ class MS_API Dataset : public std::enable_shared_from_this<Dataset> {
   /// \endcode
   std::shared_ptr<SkipDataset> Skip(int32_t count) { return std::make_shared<SkipDataset>(shared_from_this(), count); }
 
+  /// \brief Function to create a SnapshotDataset.
+  /// \note Writes the rows of this dataset to disk during the first epoch of the first run, and replays them from
+  ///     disk in later runs of the same pipeline, skipping all the work above the source. The pipeline should be
+  ///     deterministic, otherwise later runs replay the rows of the first one. A pipeline that can't be
+  ///     serialized to identify it runs without the snapshot.
+  /// \param[in] path Root directory of the snapshots, every distinct pipeline gets a sub directory.
+  /// \param[in] num_shards Number of files the rows are spread over (default=4).
+  /// \return Shared pointer to the current Dataset.
+  /// \par Example
+  /// \code
+  ///      /* Decode the images once and replay the decoded images afterwards */
+  ///      std::shared_ptr<Dataset> ds = Mnist(folder_path, "all", std::make_shared<SequentialSampler>(0, 10));
+  ///      ds = ds->Map({std::make_shared<vision::Decode>()}, {"image"});
+  ///      ds = ds->Snapshot("/path/to/snapshot_dir");
+  /// \endcode
+  std::shared_ptr<SnapshotDataset> Snapshot(const std::string &path, int32_t num_shards = 4) {
+    return std::make_shared<SnapshotDataset>(shared_from_this(), StringToChar(path), num_shards);
+  }
+
   /// \brief Function to create a TakeDataset.
   /// \note Takes count elements in this dataset.
   /// \param[in] count Number of elements the dataset to be taken.
@@ -952,6 +972,21 @@ class MS_API SkipDataset : public Dataset {
   ~SkipDataset() override = default;
 };
 
+/// \class SnapshotDataset
+/// \brief The result of applying the Snapshot operator to the input Dataset.
+class MS_API SnapshotDataset : public Dataset {
+ public:
+  /// \brief Constructor of SnapshotDataset.
+  /// \note Materializes the input dataset to disk and replays it in later runs.
+  /// \param[in] input The dataset which need to apply snapshot operation.
+  /// \param[in] path Root directory of the snapshots.
+  /// \param[in] num_shards Number of files the rows are spread over.
+  SnapshotDataset(const std::shared_ptr<Dataset> &input, const std::vector<char> &path, int32_t num_shards);
+
+  /// \brief Destructor of SnapshotDataset.
+  ~SnapshotDataset() override = default;
+};
+
 /// \class TakeDataset
 /// \brief The result of applying the Take operator to the input Dataset.
 class MS_API TakeDataset : public Dataset {
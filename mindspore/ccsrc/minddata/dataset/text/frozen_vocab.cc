@@ -0,0 +1,85 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "minddata/dataset/text/frozen_vocab.h"
+
+#include <functional>
+#include <limits>
+
+namespace mindspore {
+namespace dataset {
+namespace {
+constexpr uint32_t kTagShift = 32;
+}  // namespace
+
+Status FrozenVocab::Build(const Vocab &vocab, std::unique_ptr<FrozenVocab> *out) {
+  RETURN_UNEXPECTED_IF_NULL(out);
+  const auto &word2id = vocab.GetVocab();
+  CHECK_FAIL_RETURN_UNEXPECTED(word2id.size() < static_cast<size_t>(std::numeric_limits<int32_t>::max()),
+                               "FrozenVocab: too many words in vocab: " + std::to_string(word2id.size()));
+  std::unique_ptr<FrozenVocab> frozen(new FrozenVocab());
+  size_t num_chars = 0;
+  for (const auto &wd : word2id) {
+    num_chars += wd.first.size();
+  }
+  frozen->chars_.reserve(num_chars);
+  frozen->offsets_.reserve(word2id.size() + 1);
+  frozen->ids_.reserve(word2id.size());
+
+  // keep the load factor at or below one half
+  size_t capacity = 1;
+  while (capacity < word2id.size() * 2) {
+    capacity <<= 1;
+  }
+  frozen->slots_.resize(capacity);
+  frozen->mask_ = capacity - 1;
+
+  std::hash<std::string_view> hasher;
+  for (const auto &wd : word2id) {
+    auto index = static_cast<int32_t>(frozen->ids_.size());
+    frozen->offsets_.push_back(frozen->chars_.size());
+    frozen->chars_.append(wd.first);
+    frozen->ids_.push_back(wd.second);
+    uint64_t h = hasher(wd.first);
+    uint64_t pos = h & frozen->mask_;
+    while (frozen->slots_[pos].index != kEmptySlot) {
+      pos = (pos + 1) & frozen->mask_;
+    }
+    frozen->slots_[pos].index = index;
+    frozen->slots_[pos].tag = static_cast<uint32_t>(h >> kTagShift);
+  }
+  frozen->offsets_.push_back(frozen->chars_.size());
+  *out = std::move(frozen);
+  return Status::OK();
+}
+
+WordIdType FrozenVocab::Lookup(const std::string_view &word) const {
+  if (ids_.empty()) {
+    return Vocab::kNoTokenExists;
+  }
+  uint64_t h = std::hash<std::string_view>()(word);
+  auto tag = static_cast<uint32_t>(h >> kTagShift);
+  for (uint64_t pos = h & mask_;; pos = (pos + 1) & mask_) {
+    const Slot &slot = slots_[pos];
+    if (slot.index == kEmptySlot) {
+      return Vocab::kNoTokenExists;
+    }
+    if (slot.tag == tag && WordAt(slot.index) == word) {
+      return ids_[slot.index];
+    }
+  }
+}
+}  // namespace dataset
+}  // namespace mindspore
@@ -0,0 +1,73 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_CCSRC_MINDDATA_DATASET_TEXT_FROZEN_VOCAB_H_
+#define MINDSPORE_CCSRC_MINDDATA_DATASET_TEXT_FROZEN_VOCAB_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "minddata/dataset/include/dataset/text.h"
+#include "minddata/dataset/util/status.h"
+
+namespace mindspore {
+namespace dataset {
+/// \brief Read-only snapshot of a Vocab for word to id lookup.
+/// \note All words are stored back to back in one character buffer and indexed by an open addressing table
+///     with linear probing. Each slot keeps a part of the word hash as a tag, so a probe only compares the
+///     characters of words whose tag matches. Lookup takes a string_view and never allocates, unlike
+///     Vocab::TokensToIds which needs a std::string key.
+class FrozenVocab {
+ public:
+  /// \brief Build a frozen copy of a vocab.
+  /// \param[in] vocab Vocab to copy.
+  /// \param[out] out Frozen vocab.
+  /// \return Status code.
+  static Status Build(const Vocab &vocab, std::unique_ptr<FrozenVocab> *out);
+
+  /// \brief Lookup the id of a word.
+  /// \param[in] word Word to be looked up.
+  /// \return ID of the word in the vocab, Vocab::kNoTokenExists if the word doesn't exist.
+  WordIdType Lookup(const std::string_view &word) const;
+
+  /// \brief Number of words in the vocab.
+  size_t size() const { return ids_.size(); }
+
+ private:
+  static constexpr int32_t kEmptySlot = -1;
+
+  struct Slot {
+    int32_t index = kEmptySlot;  // index of the word in offsets_ and ids_
+    uint32_t tag = 0;            // high bits of the word hash
+  };
+
+  FrozenVocab() = default;
+
+  std::string_view WordAt(int32_t index) const {
+    return std::string_view(chars_.data() + offsets_[index], offsets_[index + 1] - offsets_[index]);
+  }
+
+  std::string chars_;              // all words back to back
+  std::vector<uint64_t> offsets_;  // start of every word in chars_, plus the end of the last one
+  std::vector<WordIdType> ids_;    // id of every word
+  std::vector<Slot> slots_;        // hash table, size is a power of two
+  uint64_t mask_ = 0;
+};
+}  // namespace dataset
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_MINDDATA_DATASET_TEXT_FROZEN_VOCAB_H_
@@ -22,15 +22,47 @@ namespace dataset {
 LookupOp::LookupOp(std::shared_ptr<Vocab> vocab, WordIdType default_id, const DataType &data_type)
     : vocab_(vocab), default_id_(default_id), type_(data_type) {}
 
+void LookupOp::GetFrozenVocab(std::shared_ptr<const FrozenVocab> *frozen_vocab) {
+  // Words can only be appended to a vocab, so a change of the size means the copy is stale
+  auto up_to_date = [this](const std::shared_ptr<const FrozenVocab> &frozen) {
+    return freeze_failed_.load() || (frozen != nullptr && frozen->size() == vocab_->GetVocab().size());
+  };
+  *frozen_vocab = std::atomic_load(&frozen_vocab_);
+  if (up_to_date(*frozen_vocab)) {
+    return;
+  }
+  // Only the builds are serialized, a lookup never waits for the mutex once the copy is up to date
+  std::lock_guard<std::mutex> lock(frozen_vocab_mutex_);
+  *frozen_vocab = std::atomic_load(&frozen_vocab_);
+  if (up_to_date(*frozen_vocab)) {
+    return;
+  }
+  std::unique_ptr<FrozenVocab> frozen;
+  Status rc = FrozenVocab::Build(*vocab_, &frozen);
+  if (rc.IsError()) {
+    MS_LOG(WARNING) << "Lookup: failed to freeze vocab, fall back to unordered_map lookup. " << rc.ToString();
+    // Drop the stale copy too, the words appended since would be missed otherwise
+    *frozen_vocab = nullptr;
+    std::atomic_store(&frozen_vocab_, *frozen_vocab);
+    freeze_failed_.store(true);
+    return;
+  }
+  *frozen_vocab = std::move(frozen);
+  std::atomic_store(&frozen_vocab_, *frozen_vocab);
+}
+
 Status LookupOp::Compute(const std::shared_ptr<Tensor> &input, std::shared_ptr<Tensor> *output) {
   IO_CHECK(input, output);
   RETURN_UNEXPECTED_IF_NULL(vocab_);
   CHECK_FAIL_RETURN_UNEXPECTED(input->type() == DataType::DE_STRING, "Lookup: input is not string datatype.");
 
+  std::shared_ptr<const FrozenVocab> frozen_vocab;
+  GetFrozenVocab(&frozen_vocab);
   std::vector<WordIdType> word_ids;
   word_ids.reserve(input->Size());
   for (auto itr = input->begin<std::string_view>(); itr != input->end<std::string_view>(); ++itr) {
-    WordIdType word_id = vocab_->TokensToIds(std::string(*itr));
+    WordIdType word_id =
+      frozen_vocab != nullptr ? frozen_vocab->Lookup(*itr) : vocab_->TokensToIds(std::string(*itr));
     word_ids.emplace_back(word_id == Vocab::kNoTokenExists ? default_id_ : word_id);
     CHECK_FAIL_RETURN_UNEXPECTED(word_ids.back() != Vocab::kNoTokenExists,
                                  "Lookup: invalid data, token: \"" + std::string(*itr) +
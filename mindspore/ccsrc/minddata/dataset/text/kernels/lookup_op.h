@@ -17,7 +17,9 @@
 #ifndef MINDSPORE_CCSRC_MINDDATA_DATASET_TEXT_KERNELS_LOOKUP_OP_H_
 #define MINDSPORE_CCSRC_MINDDATA_DATASET_TEXT_KERNELS_LOOKUP_OP_H_
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -25,6 +27,7 @@
 #include "minddata/dataset/core/tensor.h"
 #include "minddata/dataset/include/dataset/text.h"
 #include "minddata/dataset/kernels/tensor_op.h"
+#include "minddata/dataset/text/frozen_vocab.h"
 #include "minddata/dataset/util/status.h"
 
 namespace mindspore {
@@ -57,7 +60,16 @@ class LookupOp : public TensorOp {
   std::string Name() const override { return kLookupOp; }
 
  private:
+  /// \brief Get the frozen copy of the vocab, which is built on the first lookup and built again
+  ///     when words were appended to the vocab since then. The copy is published with atomic_store,
+  ///     so only the builds take frozen_vocab_mutex_. A failed build is not retried.
+  /// \param[out] frozen_vocab The frozen copy, nullptr if the vocab can't be frozen.
+  void GetFrozenVocab(std::shared_ptr<const FrozenVocab> *frozen_vocab);
+
   std::shared_ptr<Vocab> vocab_;
+  std::mutex frozen_vocab_mutex_;                     // serializes the builds of frozen_vocab_
+  std::shared_ptr<const FrozenVocab> frozen_vocab_;  // read-only copy of vocab_ that is cheaper to query
+  std::atomic<bool> freeze_failed_{false};           // set when vocab_ can't be frozen
   WordIdType default_id_;
   DataType type_;  // type of tensor after lookup
 };
@@ -0,0 +1,350 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "minddata/dataset/util/slab_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include "./securec.h"
+#include "minddata/dataset/util/log_adapter.h"
+
+namespace mindspore {
+namespace dataset {
+namespace {
+constexpr uint32_t kBlockMagic = 0x51AB51ABu;
+constexpr int32_t kLargeClass = SlabPool::kNumSizeClasses;
+constexpr int32_t kMaxCachedBlocks = 256;
+
+// Every block starts with a header, the caller gets the memory right after it. The header is 16 bytes
+// so the memory handed out keeps the 16 bytes alignment of malloc.
+struct BlockHeader {
+  uint32_t magic;
+  int32_t size_class;
+  uint64_t size;  // only set for blocks from malloc
+};
+constexpr size_t kHeaderSize = sizeof(BlockHeader);
+static_assert(kHeaderSize == 16, "The block header should keep the block 16 bytes aligned.");
+
+// A free block reuses its memory to link to the next free block. Free blocks reach the shared free list
+// in batches, the first block of a batch also links to the next batch and keeps the size of its batch.
+struct FreeBlock {
+  FreeBlock *next;
+  FreeBlock *next_batch;
+  int32_t batch_size;
+};
+static_assert(sizeof(FreeBlock) <= SlabPool::kMinBlockSize, "A free block should fit into the smallest block.");
+
+inline BlockHeader *HeaderOf(void *p) {
+  return reinterpret_cast<BlockHeader *>(static_cast<uint8_t *>(p) - kHeaderSize);
+}
+
+inline void *MemoryOf(BlockHeader *h) { return reinterpret_cast<uint8_t *>(h) + kHeaderSize; }
+
+// The number of blocks a thread cache holds of a size class before it gives half of them back
+inline int32_t CacheCapacity(int32_t size_class) {
+  auto n = static_cast<int32_t>(SlabPool::kSlabSize / SlabPool::ClassSize(size_class));
+  return std::min(std::max(n, 2), kMaxCachedBlocks);
+}
+
+// The number of blocks moved between a thread cache and the shared free list at once
+inline int32_t BatchSize(int32_t size_class) { return CacheCapacity(size_class) / 2; }
+
+std::atomic<uint64_t> g_next_pool_id{0};
+}  // namespace
+
+struct SlabPool::Central {
+  Central() : id(g_next_pool_id.fetch_add(1)), slab_bytes(0), large_bytes(0) {
+    for (auto &head : free_lists) {
+      head = nullptr;
+    }
+  }
+
+  ~Central() {
+    for (auto slab : slabs) {
+      free(slab);
+    }
+  }
+
+  // Push a batch onto the free list of a size class
+  void Push(int32_t size_class, FreeBlock *batch) {
+    std::lock_guard<std::mutex> lck(list_mux[size_class]);
+    batch->next_batch = free_lists[size_class];
+    free_lists[size_class] = batch;
+  }
+
+  // Pop a batch from the free list of a size class, nullptr if it is empty
+  FreeBlock *Pop(int32_t size_class) {
+    std::lock_guard<std::mutex> lck(list_mux[size_class]);
+    FreeBlock *batch = free_lists[size_class];
+    if (batch != nullptr) {
+      free_lists[size_class] = batch->next_batch;
+    }
+    return batch;
+  }
+
+  // Reserve a new slab for a size class, keep its first batch and put the others onto the free list
+  Status NewSlab(int32_t size_class, FreeBlock **first) {
+    const size_t stride = kHeaderSize + ClassSize(size_class);
+    const size_t num_blocks = std::max<size_t>(kSlabSize / stride, 2);
+    const size_t bytes = stride * num_blocks;
+    auto *slab = static_cast<uint8_t *>(malloc(bytes));
+    if (slab == nullptr) {
+      return Status(StatusCode::kMDOutOfMemory, __LINE__, __FILE__,
+                    "Out of memory, failed to reserve a slab of " + std::to_string(bytes) + " bytes.");
+    }
+    {
+      std::lock_guard<std::mutex> lck(mux);
+      slabs.push_back(slab);
+    }
+    slab_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    const auto batch_size = static_cast<size_t>(BatchSize(size_class));
+    FreeBlock *batch = nullptr;
+    FreeBlock *prev = nullptr;
+    *first = nullptr;
+    for (size_t i = 0; i < num_blocks; ++i) {
+      auto *h = reinterpret_cast<BlockHeader *>(slab + i * stride);
+      h->magic = kBlockMagic;
+      h->size_class = size_class;
+      h->size = 0;
+      auto *b = static_cast<FreeBlock *>(MemoryOf(h));
+      b->next = nullptr;
+      b->next_batch = nullptr;
+      if (i % batch_size == 0) {
+        // Start a new batch, the previous one is complete
+        b->batch_size = static_cast<int32_t>(std::min(batch_size, num_blocks - i));
+        if (batch == nullptr) {
+          *first = b;
+        } else if (batch != *first) {
+          Push(size_class, batch);
+        }
+        batch = b;
+      } else {
+        prev->next = b;
+      }
+      prev = b;
+    }
+    if (batch != *first) {
+      Push(size_class, batch);
+    }
+    return Status::OK();
+  }
+
+  const uint64_t id;
+  FreeBlock *free_lists[kNumSizeClasses];
+  std::mutex list_mux[kNumSizeClasses];  // guards free_lists
+  std::mutex mux;                        // guards slabs
+  std::vector<uint8_t *> slabs;
+  std::atomic<uint64_t> slab_bytes;
+  std::atomic<uint64_t> large_bytes;
+};
+
+namespace {
+// The free blocks a thread holds of one pool
+class ThreadCache {
+ public:
+  explicit ThreadCache(const std::shared_ptr<SlabPool::Central> &central) : id_(central->id), central_(central) {
+    for (int32_t i = 0; i < SlabPool::kNumSizeClasses; ++i) {
+      heads_[i] = nullptr;
+      counts_[i] = 0;
+    }
+  }
+
+  ~ThreadCache() {
+    // Give the blocks back when the thread exits, unless the pool is gone along with its slabs
+    auto central = central_.lock();
+    if (central != nullptr) {
+      for (int32_t i = 0; i < SlabPool::kNumSizeClasses; ++i) {
+        Flush(central.get(), i, counts_[i]);
+      }
+    }
+  }
+
+  uint64_t id() const { return id_; }
+
+  bool expired() const { return central_.expired(); }
+
+  Status Pop(SlabPool::Central *central, int32_t size_class, void **p) {
+    if (heads_[size_class] == nullptr) {
+      RETURN_IF_NOT_OK(Refill(central, size_class));
+    }
+    FreeBlock *b = heads_[size_class];
+    heads_[size_class] = b->next;
+    counts_[size_class]--;
+    *p = b;
+    return Status::OK();
+  }
+
+  void Push(SlabPool::Central *central, int32_t size_class, void *p) {
+    auto *b = static_cast<FreeBlock *>(p);
+    b->next = heads_[size_class];
+    heads_[size_class] = b;
+    if (++counts_[size_class] > CacheCapacity(size_class)) {
+      Flush(central, size_class, BatchSize(size_class));
+    }
+  }
+
+ private:
+  // Move n blocks of a size class to the shared free list as one batch
+  void Flush(SlabPool::Central *central, int32_t size_class, int32_t n) {
+    if (n <= 0 || heads_[size_class] == nullptr) {
+      return;
+    }
+    FreeBlock *first = heads_[size_class];
+    FreeBlock *last = first;
+    int32_t moved = 1;
+    while (moved < n && last->next != nullptr) {
+      last = last->next;
+      moved++;
+    }
+    heads_[size_class] = last->next;
+    counts_[size_class] -= moved;
+    last->next = nullptr;
+    first->batch_size = moved;
+    central->Push(size_class, first);
+  }
+
+  // Take a batch of blocks from the shared free list, or from a new slab when the list is empty
+  Status Refill(SlabPool::Central *central, int32_t size_class) {
+    FreeBlock *batch = central->Pop(size_class);
+    if (batch == nullptr) {
+      RETURN_IF_NOT_OK(central->NewSlab(size_class, &batch));
+    }
+    heads_[size_class] = batch;
+    counts_[size_class] = batch->batch_size;
+    return Status::OK();
+  }
+
+  const uint64_t id_;
+  std::weak_ptr<SlabPool::Central> central_;
+  FreeBlock *heads_[SlabPool::kNumSizeClasses];
+  int32_t counts_[SlabPool::kNumSizeClasses];
+};
+
+// Find the cache of a pool for the calling thread, create it on first use
+ThreadCache *GetThreadCache(const std::shared_ptr<SlabPool::Central> &central) {
+  thread_local std::vector<std::unique_ptr<ThreadCache>> caches;
+  thread_local ThreadCache *last = nullptr;
+  if (last != nullptr && last->id() == central->id) {
+    return last;
+  }
+  for (auto &cache : caches) {
+    if (cache->id() == central->id) {
+      last = cache.get();
+      return last;
+    }
+  }
+  // Drop the caches of the pools that are gone before adding a new one
+  (void)caches.erase(std::remove_if(caches.begin(), caches.end(),
+                                    [](const std::unique_ptr<ThreadCache> &cache) { return cache->expired(); }),
+                     caches.end());
+  caches.push_back(std::make_unique<ThreadCache>(central));
+  last = caches.back().get();
+  return last;
+}
+}  // namespace
+
+SlabPool::SlabPool() : central_(std::make_shared<Central>()) {}
+
+SlabPool::~SlabPool() {
+  auto stats = GetStats();
+  MS_LOG(INFO) << "Slab pool released " << stats.num_slabs << " slabs of " << stats.slab_bytes << " bytes in total.";
+}
+
+int32_t SlabPool::SizeClass(size_t n) {
+  if (n > kMaxBlockSize) {
+    return kLargeClass;
+  }
+  int32_t size_class = 0;
+  size_t sz = kMinBlockSize;
+  while (sz < n) {
+    sz <<= 1;
+    size_class++;
+  }
+  return size_class;
+}
+
+Status SlabPool::Allocate(size_t n, void **p) {
+  RETURN_UNEXPECTED_IF_NULL(p);
+  int32_t size_class = SizeClass(n);
+  if (size_class == kLargeClass) {
+    CHECK_FAIL_RETURN_UNEXPECTED(n <= std::numeric_limits<size_t>::max() - kHeaderSize,
+                                 "Invalid allocation size: " + std::to_string(n));
+    auto *h = static_cast<BlockHeader *>(malloc(kHeaderSize + n));
+    if (h == nullptr) {
+      return Status(StatusCode::kMDOutOfMemory, __LINE__, __FILE__);
+    }
+    h->magic = kBlockMagic;
+    h->size_class = kLargeClass;
+    h->size = n;
+    central_->large_bytes.fetch_add(n, std::memory_order_relaxed);
+    *p = MemoryOf(h);
+    return Status::OK();
+  }
+  return GetThreadCache(central_)->Pop(central_.get(), size_class, p);
+}
+
+void SlabPool::Deallocate(void *p) {
+  if (p == nullptr) {
+    return;
+  }
+  BlockHeader *h = HeaderOf(p);
+  if (h->magic != kBlockMagic) {
+    MS_LOG(ERROR) << "[Internal ERROR] The memory being freed does not belong to the slab pool.";
+    return;
+  }
+  if (h->size_class == kLargeClass) {
+    central_->large_bytes.fetch_sub(h->size, std::memory_order_relaxed);
+    free(h);
+    return;
+  }
+  GetThreadCache(central_)->Push(central_.get(), h->size_class, p);
+}
+
+Status SlabPool::Reallocate(void **p, size_t old_sz, size_t new_sz) {
+  RETURN_UNEXPECTED_IF_NULL(p);
+  if (old_sz >= new_sz) {
+    // Do nothing if we shrink.
+    return Status::OK();
+  }
+  BlockHeader *h = HeaderOf(*p);
+  if (h->size_class != kLargeClass && new_sz <= ClassSize(h->size_class)) {
+    // The block is large enough already
+    return Status::OK();
+  }
+  void *q = nullptr;
+  RETURN_IF_NOT_OK(Allocate(new_sz, &q));
+  errno_t err = memcpy_s(q, new_sz, *p, old_sz);
+  if (err) {
+    Deallocate(q);
+    RETURN_STATUS_UNEXPECTED(std::to_string(err));
+  }
+  Deallocate(*p);
+  *p = q;
+  return Status::OK();
+}
+
+uint64_t SlabPool::get_max_size() const { return std::numeric_limits<uint64_t>::max(); }
+
+SlabPool::Stats SlabPool::GetStats() const {
+  Stats stats{};
+  stats.slab_bytes = central_->slab_bytes.load(std::memory_order_relaxed);
+  stats.large_bytes = central_->large_bytes.load(std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lck(central_->mux);
+  stats.num_slabs = central_->slabs.size();
+  return stats;
+}
+}  // namespace dataset
+}  // namespace mindspore
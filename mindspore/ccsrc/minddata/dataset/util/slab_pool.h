@@ -0,0 +1,88 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_CCSRC_MINDDATA_DATASET_UTIL_SLAB_POOL_H_
+#define MINDSPORE_CCSRC_MINDDATA_DATASET_UTIL_SLAB_POOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "minddata/dataset/util/memory_pool.h"
+
+namespace mindspore {
+namespace dataset {
+// A MemoryPool for the tensor buffers of a running pipeline. Requests are rounded up to a power of two
+// size class, and blocks of a class are carved from large slabs which are never returned to the system
+// while the pool is alive. Freed blocks are recycled instead, so a steady state pipeline stops calling
+// malloc and free once its working set is reserved, and the resident size stays flat.
+//
+// Every thread keeps a small cache of free blocks per size class. The cache is thread local, so allocating
+// from and freeing into it needs no lock. A block freed by another thread than the one that allocated it
+// simply lands in the cache of the freeing thread. The shared free list of each class and the list of slabs
+// are guarded by mutexes: a cache that overflows moves half of its blocks as one batch to the shared free
+// list of the class, and an empty cache takes a whole batch from it, so the mutex of a shared list is only
+// taken once every few dozen allocations. The pool is not lock-free.
+//
+// Requests larger than the largest size class go straight to malloc.
+class SlabPool : public MemoryPool {
+ public:
+  static constexpr size_t kMinBlockSize = 64;
+  static constexpr int32_t kNumSizeClasses = 17;
+  static constexpr size_t kMaxBlockSize = kMinBlockSize << (kNumSizeClasses - 1);  // 4MB
+  static constexpr size_t kSlabSize = 1 << 20;                                     // 1MB
+
+  // Memory usage of the pool
+  struct Stats {
+    uint64_t slab_bytes;   // reserved in slabs
+    uint64_t large_bytes;  // allocated with malloc and not yet freed
+    uint64_t num_slabs;
+  };
+
+  SlabPool();
+
+  ~SlabPool() override;
+
+  Status Allocate(size_t n, void **p) override;
+
+  Status Reallocate(void **p, size_t old_sz, size_t new_sz) override;
+
+  void Deallocate(void *p) override;
+
+  uint64_t get_max_size() const override;
+
+  int PercentFree() const override { return 100; }
+
+  // Memory usage of the pool
+  Stats GetStats() const;
+
+  // Size class of a request, kNumSizeClasses if it is served by malloc
+  static int32_t SizeClass(size_t n);
+
+  // Usable size of a block of a size class
+  static size_t ClassSize(int32_t size_class) { return kMinBlockSize << size_class; }
+
+  // The state shared by the pool and the thread caches
+  struct Central;
+
+ private:
+  std::shared_ptr<Central> central_;
+};
+}  // namespace dataset
+}  // namespace mindspore
+
+#endif  // MINDSPORE_CCSRC_MINDDATA_DATASET_UTIL_SLAB_POOL_H_
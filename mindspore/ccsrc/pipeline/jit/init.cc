@@ -550,6 +550,20 @@ PYBIND11_MODULE(_c_expression, m) {
     .def("upload_sparse_rate", &PSContext::upload_sparse_rate, "Get upload sparse rate.")
     .def("set_download_compress_type", &PSContext::set_download_compress_type, "Set download compress type.")
     .def("download_compress_type", &PSContext::download_compress_type, "Get download compress type.")
+    .def("set_push_compress_type", &PSContext::set_push_compress_type, "Set compress type of the pushed gradients.")
+    .def("push_compress_type", &PSContext::push_compress_type, "Get compress type of the pushed gradients.")
+    .def("set_push_sparse_rate", &PSContext::set_push_sparse_rate, "Set top-k sparse rate of the pushed gradients.")
+    .def("push_sparse_rate", &PSContext::push_sparse_rate, "Get top-k sparse rate of the pushed gradients.")
+    .def("set_pull_compress_type", &PSContext::set_pull_compress_type, "Set compress type of the pulled weights.")
+    .def("pull_compress_type", &PSContext::pull_compress_type, "Get compress type of the pulled weights.")
+    .def("set_enable_embedding_hash_shard", &PSContext::set_enable_embedding_hash_shard,
+         "Set whether the embedding tables are sharded by consistent hashing.")
+    .def("enable_embedding_hash_shard", &PSContext::enable_embedding_hash_shard,
+         "Get whether the embedding tables are sharded by consistent hashing.")
+    .def("set_embedding_server_num", &PSContext::set_embedding_server_num,
+         "Set the number of the servers the embedding tables are placed on.")
+    .def("embedding_server_num", &PSContext::embedding_server_num,
+         "Get the number of the servers the embedding tables are placed on.")
     .def("set_checkpoint_dir", &PSContext::set_checkpoint_dir, "Set server checkpoint directory.")
     .def("checkpoint_dir", &PSContext::checkpoint_dir, "Server checkpoint directory.");
   (void)m.def("_encrypt", &mindspore::pipeline::PyEncrypt, "Encrypt the data.");
@@ -1502,6 +1502,11 @@ void ForwardExecutor::GetOpOutputAbstract(const OpExecInfoPtr &op_exec_info,
       *prim_cache_hit = true;
     }
   }
+  if (*prim_cache_hit) {
+    ++infer_cache_hit_count_;
+  } else {
+    ++infer_cache_miss_count_;
+  }
 
   if (op_exec_info->abstract == nullptr || force_infer_prim.find(op_name) != force_infer_prim.end()) {
     // Use python infer method
@@ -2563,7 +2568,10 @@ void ForwardExecutor::ClearRes() {
   lazy_build_ = false;
   cell_depth_ = 0;
   implicit_cast_map_.clear();
+  MS_LOG(INFO) << "Infer cache hit count: " << infer_cache_hit_count_ << ", miss count: " << infer_cache_miss_count_;
   prim_abs_list_.clear();
+  infer_cache_hit_count_ = 0;
+  infer_cache_miss_count_ = 0;
   node_abs_map_.clear();
   dynamic_shape_info_ptr()->reset();
 }
@@ -422,6 +422,9 @@ class ForwardExecutor {
   uint32_t cell_depth_{0};
   GradExecutorWeakPtr grad_executor_;
   PrimAbsCache prim_abs_list_;
+  // The hit and miss count of the infer cache prim_abs_list_.
+  size_t infer_cache_hit_count_{0};
+  size_t infer_cache_miss_count_{0};
   ImplicitCastCache implicit_cast_map_;
   mindspore::HashMap<std::string, abstract::AbstractBasePtr> node_abs_map_;
   bool lazy_build_{false};
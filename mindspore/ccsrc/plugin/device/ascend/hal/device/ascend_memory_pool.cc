@@ -106,10 +106,10 @@ void AscendMemoryPool::ResetIdleMemBuf() {
     if (mem_mng->mem_block_list_.empty()) {
       return;
     }
-    for (auto &it : mem_mng->idle_mem_buf_map_) {
-      MS_EXCEPTION_IF_NULL(it.second);
-      (void)rtMemset(it.second->device_addr_, it.first, 0, it.first);
-    }
+    mem_mng->VisitIdleMemBuf([](const DynamicMemBufPtr &mem_buf) {
+      MS_EXCEPTION_IF_NULL(mem_buf);
+      (void)rtMemset(mem_buf->device_addr_, mem_buf->size_, 0, mem_buf->size_);
+    });
   };
   fn(persistent_mem());
   fn(common_mem());
@@ -63,6 +63,14 @@ const size_t INIT_NODE_REF = 1;
 void CPUKernelRuntime::AssignKernelGraphAddress(session::KernelGraph *kernel_graph) {
   AssignValueNodeAddress(kernel_graph);
   AssignInputNodeAddress(kernel_graph);
+  if (UseMemScheduler()) {
+    // The memory of the parameters, kernel outputs and workspaces is allocated and swapped by the MemScheduler.
+    // The CPU kernels and the memcpy swaps run without a stream, but the MemScheduler only swaps memory with a
+    // non-null stream, so it gets a placeholder which is never used as a stream.
+    stream_ = &mem_scheduler_stream_;
+    AssignKernelOutputAddress(kernel_graph);
+    return;
+  }
   auto context_ptr = MsContext::GetInstance();
   MS_EXCEPTION_IF_NULL(context_ptr);
   bool is_enable_mem_reuse = EnvConfigParser::GetInstance().GetSysMemreuse();
@@ -446,6 +454,9 @@ void CPUKernelRuntime::GetRuntimeAddressFromNode(const AnfNodePtr &node, std::ve
 }
 
 bool CPUKernelRuntime::Run(const session::KernelGraph &kernel_graph, bool) {
+  if (UseMemScheduler()) {
+    return LaunchKernels(kernel_graph);
+  }
   static_cast<CPUMemoryManager *>(mem_manager_.get())->IncreaseAddressRefCount(&kernel_graph);
 
   auto kernels = kernel_graph.execution_order();
@@ -74,6 +74,8 @@ class CPUKernelRuntime : public KernelRuntime {
                                  std::vector<kernel::AddressPtr> *outputs, std::vector<kernel::AddressPtr> *workspaces);
 
   bool initialized_{false};
+  // The placeholder stream given to the MemScheduler.
+  int mem_scheduler_stream_{0};
 };
 }  // namespace cpu
 }  // namespace device
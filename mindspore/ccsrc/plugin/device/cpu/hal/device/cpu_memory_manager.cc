@@ -15,13 +15,20 @@
  */
 
 #include "plugin/device/cpu/hal/device/cpu_memory_manager.h"
+#include <algorithm>
 #include "backend/common/session/anf_runtime_algorithm.h"
 #include "include/common/utils/anfalgo.h"
 #include "utils/ms_context.h"
 #include "include/common/utils/convert_utils.h"
+#include "include/common/utils/utils.h"
+#include "utils/ms_utils.h"
 namespace mindspore {
 namespace device {
 namespace cpu {
+namespace {
+constexpr size_t kGBToByte = 1024 << 20;
+}  // namespace
+
 uint8_t *CPUMemoryManager::MemMalloc(size_t size) {
   auto block = std::make_shared<std::vector<uint8_t>>();
   try {
@@ -216,6 +223,93 @@ void CPUMemoryManager::DecreaseAddressRefCount(const AnfNodePtr &kernel) {
     }
   }
 }
+
+void *CPUMemoryManager::MallocDevice(size_t mem_size) {
+  auto context_ptr = MsContext::GetInstance();
+  MS_EXCEPTION_IF_NULL(context_ptr);
+  const auto max_device_memory = FloatToSize(context_ptr->get_param<float>(MS_CTX_MAX_DEVICE_MEMORY) * kGBToByte);
+  if (offload_device_mem_size_ + mem_size > max_device_memory) {
+    return nullptr;
+  }
+  auto ptr = MallocMemFromMemPool(mem_size, false);
+  if (ptr != nullptr) {
+    offload_device_mem_[ptr] = mem_size;
+    offload_device_mem_size_ += mem_size;
+  }
+  return ptr;
+}
+
+void CPUMemoryManager::FreeDevice(void *ptr) {
+  MS_EXCEPTION_IF_NULL(ptr);
+  auto iter = offload_device_mem_.find(ptr);
+  if (iter != offload_device_mem_.end()) {
+    offload_device_mem_size_ -= iter->second;
+    (void)offload_device_mem_.erase(iter);
+  }
+  FreeMemFromMemPool(ptr);
+}
+
+void *CPUMemoryManager::MallocHost(size_t mem_size) {
+  if (!swap_file_checked_) {
+    swap_file_checked_ = true;
+    const auto offload_path = common::GetEnv(kCpuOffloadPath);
+    if (!offload_path.empty()) {
+      swap_file_ = std::make_unique<MmapSwapFile>(offload_path);
+    }
+  }
+  if (swap_file_ == nullptr) {
+    return MemoryManager::MallocHost(mem_size);
+  }
+  auto ptr = swap_file_->Malloc(mem_size);
+  if (ptr == nullptr) {
+    MS_LOG(EXCEPTION) << "Malloc memory from the swap file failed: size " << mem_size
+                      << ", file size: " << swap_file_->file_size();
+  }
+  return ptr;
+}
+
+void CPUMemoryManager::FreeHost(void *ptr) {
+  MS_EXCEPTION_IF_NULL(ptr);
+  if (swap_file_ != nullptr && swap_file_->Free(ptr)) {
+    return;
+  }
+  MemoryManager::FreeHost(ptr);
+}
+
+void CPUMemoryManager::SwapIn(const void *host_ptr, void *device_ptr, size_t mem_size, void *) {
+  MS_EXCEPTION_IF_NULL(host_ptr);
+  MS_EXCEPTION_IF_NULL(device_ptr);
+  auto ret = memcpy_s(device_ptr, mem_size, host_ptr, mem_size);
+  if (ret != EOK) {
+    MS_LOG(EXCEPTION) << "SwapIn memcpy failed, size: " << mem_size << ", errno: " << ret;
+  }
+}
+
+void CPUMemoryManager::SwapOut(const void *device_ptr, void *host_ptr, size_t mem_size, void *) {
+  MS_EXCEPTION_IF_NULL(device_ptr);
+  MS_EXCEPTION_IF_NULL(host_ptr);
+  auto ret = memcpy_s(host_ptr, mem_size, device_ptr, mem_size);
+  if (ret != EOK) {
+    MS_LOG(EXCEPTION) << "SwapOut memcpy failed, size: " << mem_size << ", errno: " << ret;
+  }
+  if (swap_file_ != nullptr && swap_file_->Contains(host_ptr)) {
+    swap_file_->Evict(host_ptr, mem_size);
+  }
+}
+
+void CPUMemoryManager::PrefetchHost(const void *host_ptr, size_t mem_size) {
+  if (swap_file_ != nullptr && swap_file_->Contains(host_ptr)) {
+    swap_file_->Prefetch(host_ptr, mem_size);
+  }
+}
+
+size_t CPUMemoryManager::GetAvailableMemSize() {
+  auto context_ptr = MsContext::GetInstance();
+  MS_EXCEPTION_IF_NULL(context_ptr);
+  const auto max_device_memory = FloatToSize(context_ptr->get_param<float>(MS_CTX_MAX_DEVICE_MEMORY) * kGBToByte);
+  const auto system_memory = CPUMemoryPool::GetInstance().free_mem_size() + offload_device_mem_size_;
+  return std::min(max_device_memory, system_memory) - offload_device_mem_size_;
+}
 }  // namespace cpu
 }  // namespace device
 }  // namespace mindspore
@@ -23,6 +23,7 @@
 #include "backend/common/session/session_basic.h"
 #include "runtime/device/device_address.h"
 #include "runtime/device/memory_manager.h"
+#include "runtime/device/mmap_swap_file.h"
 #include "plugin/device/cpu/hal/device/cpu_simple_mem_plan.h"
 #include "plugin/device/cpu/hal/hardware/cpu_memory_pool.h"
 
@@ -54,6 +55,17 @@ class CPUMemoryManager : public MemoryManager {
     return CPUMemoryPool::GetInstance().AllocContinuousTensorMem(total_size, size_list);
   }
 
+  // swap manager interface, the device memory is limited by the max_device_memory of context, and the swapped out
+  // memory is kept in the swap file under the directory of MS_DEV_CPU_OFFLOAD_PATH if it is set.
+  void *MallocDevice(size_t mem_size) override;
+  void FreeDevice(void *ptr) override;
+  void *MallocHost(size_t mem_size) override;
+  void FreeHost(void *ptr) override;
+  void SwapIn(const void *host_ptr, void *device_ptr, size_t mem_size, void *stream) override;
+  void SwapOut(const void *device_ptr, void *host_ptr, size_t mem_size, void *stream) override;
+  void PrefetchHost(const void *host_ptr, size_t mem_size) override;
+  size_t GetAvailableMemSize() override;
+
  protected:
   uint8_t *MallocStaticMem(size_t size, bool communication_mem, uint32_t graph_id) override;
   uint8_t *MallocDynamicMem(size_t size, bool communication_mem) override;
@@ -70,6 +82,11 @@ class CPUMemoryManager : public MemoryManager {
   std::map<void *, size_t> static_mem_;
   std::map<void *, size_t> cached_mem_;
   std::map<void *, std::shared_ptr<std::vector<uint8_t>>> mem_block_map_;
+  // The device memory allocated by the memory scheduler.
+  std::map<void *, size_t> offload_device_mem_;
+  size_t offload_device_mem_size_{0};
+  std::unique_ptr<MmapSwapFile> swap_file_{nullptr};
+  bool swap_file_checked_{false};
 };
 }  // namespace cpu
 }  // namespace device
@@ -18,6 +18,11 @@
 #include <string>
 #include <memory>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <tuple>
 #include "kernel/common_utils.h"
 #include "plugin/factory/ms_factory.h"
 #include "plugin/device/cpu/kernel/cpu_kernel.h"
@@ -29,6 +34,7 @@
 #include "plugin/device/cpu/kernel/custom/custom_julia_cpu_kernel.h"
 #include "utils/trace_base.h"
 #include "include/common/utils/convert_utils.h"
+#include "utils/hash_map.h"
 
 namespace mindspore {
 namespace device {
@@ -345,6 +351,74 @@ void UpdateCustomKernelBuildInfo(const CNodePtr &kernel_node, bool is_akg_op) {
   }
 }
 
+// The kernel selection of the registered cpu kernels only depends on the op name, the input and output data types and
+// whether the inputs are cnodes, so the selected build info is cached by them. It is mostly hit by the single op graphs
+// of PyNative, which are rebuilt for the new shapes of the same op.
+class KernelSelectCache {
+ public:
+  struct SelectResult {
+    std::vector<std::string> input_formats_;
+    std::vector<TypeId> input_types_;
+    std::vector<std::string> output_formats_;
+    std::vector<TypeId> output_types_;
+  };
+
+  static KernelSelectCache &GetInstance() {
+    static KernelSelectCache instance;
+    return instance;
+  }
+
+  static std::string GenerateKey(const std::string &op_name, const std::vector<TypeId> &input_types,
+                                 const std::vector<size_t> &input_not_cnode_indexes,
+                                 const std::vector<TypeId> &output_types) {
+    std::ostringstream buf;
+    buf << op_name << "_";
+    for (auto input_type : input_types) {
+      buf << input_type << ",";
+    }
+    buf << "_";
+    for (auto index : input_not_cnode_indexes) {
+      buf << index << ",";
+    }
+    buf << "_";
+    for (auto output_type : output_types) {
+      buf << output_type << ",";
+    }
+    return buf.str();
+  }
+
+  bool Find(const std::string &key, SelectResult *result) {
+    MS_EXCEPTION_IF_NULL(result);
+    {
+      std::shared_lock<std::shared_mutex> lock(mutex_);
+      auto iter = results_.find(key);
+      if (iter != results_.end()) {
+        *result = iter->second;
+        ++hit_count_;
+        return true;
+      }
+    }
+    auto miss_count = ++miss_count_;
+    MS_LOG(INFO) << "Kernel select cache miss: " << key << ", hit count: " << hit_count_.load()
+                 << ", miss count: " << miss_count;
+    return false;
+  }
+
+  void Insert(const std::string &key, SelectResult result) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    (void)results_.emplace(key, std::move(result));
+  }
+
+ private:
+  KernelSelectCache() = default;
+  ~KernelSelectCache() = default;
+
+  std::shared_mutex mutex_;
+  mindspore::HashMap<std::string, SelectResult> results_;
+  std::atomic<size_t> hit_count_{0};
+  std::atomic<size_t> miss_count_{0};
+};
+
 kernel::KernelAttr FillNoneInKernelAttr(const CNodePtr &kernel_node, const std::vector<TypeId> &input_types,
                                         const std::vector<TypeId> &output_types,
                                         const kernel::KernelAttr &kernel_attr) {
@@ -505,6 +579,14 @@ std::pair<std::string, ExceptionType> SetKernelInfoWithMsg(const CNodePtr &kerne
   MS_LOG(INFO) << "SetKernelInfo, CNode Name: " << op_name;
   GetInputDtypes(kernel_node, &input_types, &input_not_cnode_indexes);
   GetOutputDtypes(kernel_node, &output_types);
+  auto &select_cache = KernelSelectCache::GetInstance();
+  const auto &cache_key = KernelSelectCache::GenerateKey(op_name, input_types, input_not_cnode_indexes, output_types);
+  KernelSelectCache::SelectResult cached_result;
+  if (select_cache.Find(cache_key, &cached_result)) {
+    SetKernelBuildInfo(cached_result.input_formats_, cached_result.input_types_, cached_result.output_formats_,
+                       cached_result.output_types_, kernel_node.get());
+    return {};
+  }
   kernel::KernelAttr selected_kernel_attr;
   std::pair<bool, bool> matched = std::make_pair(false, false);
   auto kernel_attrs = kernel::NativeCpuKernelMod::GetCpuSupportedList(op_name);
@@ -536,6 +618,7 @@ std::pair<std::string, ExceptionType> SetKernelInfoWithMsg(const CNodePtr &kerne
     }
   }
   SetKernelBuildInfo(input_formats, input_types, selected_output_formats, selected_output_types, kernel_node.get());
+  select_cache.Insert(cache_key, {input_formats, input_types, selected_output_formats, selected_output_types});
   return {};
 }
 
@@ -16,15 +16,27 @@
 
 #include "plugin/device/cpu/hal/hardware/allreduce_impl.h"
 
+#include <algorithm>
 #include <vector>
 #include <functional>
 #include <memory>
+#include <utility>
+#include "include/common/thread_pool.h"
+#include "plugin/device/cpu/kernel/nnacl/fp32/add_fp32.h"
 
 namespace mindspore {
 namespace device {
 namespace cpu {
 namespace {
 constexpr size_t kWaitTimeout = 30;
+// The byte size of the segment which is the unit of the ring pipeline.
+constexpr size_t kRingSegmentSize = 256 << 10;
+// The max byte size of the data which uses the halving doubling algorithm, the larger data uses the ring pipeline.
+constexpr size_t kHalvingDoublingMaxSize = 4 << 20;
+// The min data number reduced by each thread.
+constexpr size_t kMinReduceNumPerThread = 16 << 10;
+
+bool IsPowerOfTwo(size_t value) { return value != 0 && (value & (value - 1)) == 0; }
 }  // namespace
 
 AllReduceLauncher::AllReduceLauncher() {
@@ -53,11 +65,60 @@ bool AllReduceLauncher::Execute(const void *input_data, void *const output_data,
     MS_LOG(DEBUG) << "AllReduceLauncher executes ReduceBroadcastAllReduce algorithm on the rank " << rank_id_;
     return ReduceBroadcastAllReduce(input_data, output_data, data_size);
   }
+  if (IsPowerOfTwo(rank_size_) && data_size <= kHalvingDoublingMaxSize) {
+    MS_LOG(DEBUG) << "AllReduceLauncher executes HalvingDoublingAllReduce algorithm on the rank " << rank_id_;
+    return HalvingDoublingAllReduce(input_data, output_data, data_size);
+  }
   // If the data number is not less than the node number, the RingAllReduce algorithm is used.
   MS_LOG(DEBUG) << "AllReduceLauncher executes RingAllReduce algorithm on the rank " << rank_id_;
   return RingAllReduce(input_data, output_data, data_size);
 }
 
+bool AllReduceLauncher::Receive(uint32_t rank, std::shared_ptr<std::vector<unsigned char>> *rec_ptr,
+                                size_t expect_size) const {
+  MS_EXCEPTION_IF_NULL(rec_ptr);
+  auto rec_req_id = abs_node_->CollectiveReceiveAsync(ps::core::NodeRole::WORKER, rank, rec_ptr);
+  if (!abs_node_->CollectiveWait(rec_req_id, kWaitTimeout)) {
+    MS_LOG(ERROR) << "AllReduce wait receiving " << rec_req_id.second << " from rank " << rank << " failed.";
+    return false;
+  }
+  if (*rec_ptr == nullptr || (*rec_ptr)->size() != expect_size) {
+    MS_LOG(ERROR) << "AllReduce receives " << (*rec_ptr == nullptr ? 0 : (*rec_ptr)->size()) << " bytes from rank "
+                  << rank << ", but " << expect_size << " bytes are expected.";
+    return false;
+  }
+  return true;
+}
+
+bool AllReduceLauncher::WaitSend(const std::vector<uint64_t> &send_req_ids) const {
+  for (const auto send_req_id : send_req_ids) {
+    if (send_req_id == 0 || !abs_node_->Wait(send_req_id, kWaitTimeout)) {
+      MS_LOG(ERROR) << "AllReduce wait sending " << send_req_id << " failed.";
+      return false;
+    }
+  }
+  return true;
+}
+
+void AllReduceLauncher::ReduceSum(float *dst, const float *src, size_t data_num) const {
+  auto &thread_pool = common::ThreadPool::GetInstance();
+  size_t thread_num = std::min(thread_pool.GetSyncRunThreadNum(), data_num / kMinReduceNumPerThread);
+  if (thread_num <= 1) {
+    (void)ElementAdd(dst, src, dst, SizeToInt(data_num));
+    return;
+  }
+  size_t task_size = (data_num + thread_num - 1) / thread_num;
+  std::vector<common::Task> tasks;
+  for (size_t begin = 0; begin < data_num; begin += task_size) {
+    size_t size = std::min(task_size, data_num - begin);
+    (void)tasks.emplace_back([dst, src, begin, size]() {
+      (void)ElementAdd(dst + begin, src + begin, dst + begin, SizeToInt(size));
+      return common::SUCCESS;
+    });
+  }
+  (void)thread_pool.SyncRun(tasks);
+}
+
 bool AllReduceLauncher::RingAllReduce(const void *input_data, void *const output_data, size_t data_size) const {
   int memcpy_ret = memcpy_s(output_data, data_size, input_data, data_size);
   if (memcpy_ret != EOK) {
@@ -79,79 +140,139 @@ bool AllReduceLauncher::RingAllReduce(const void *input_data, void *const output
       std::accumulate(chunk_sizes.begin(), chunk_sizes.begin() + SizeToLong(i), size_t(0), std::plus<size_t>());
     chunk_offset.push_back(ofs);
   }
+  // All the chunks are split into the same number of segments, so every rank sends and receives the segments in the
+  // same order.
+  size_t segment_num = (chunk_sizes[0] * sizeof(float) + kRingSegmentSize - 1) / kRingSegmentSize;
+  segment_num = std::max(std::min(segment_num, chunk_sizes[rank_size_ - 1]), static_cast<size_t>(1));
+  auto segment_range = [&chunk_sizes, &chunk_offset, segment_num](size_t chunk_index, size_t segment_index) {
+    size_t segment_size = chunk_sizes[chunk_index] / segment_num;
+    size_t segment_remainder = chunk_sizes[chunk_index] % segment_num;
+    size_t offset =
+      chunk_offset[chunk_index] + segment_index * segment_size + std::min(segment_index, segment_remainder);
+    return std::make_pair(offset, segment_index < segment_remainder ? segment_size + 1 : segment_size);
+  };
 
   auto *output_buff = reinterpret_cast<float *>(output_data);
   uint32_t send_to_rank = SizeToUint((rank_id_ + 1) % rank_size_);
   uint32_t rec_from_rank = SizeToUint((rank_id_ - 1 + rank_size_) % rank_size_);
   MS_LOG(DEBUG) << "AllReduce data_num:" << data_num << ", rank_size_:" << rank_size_ << ", rank_id_:" << rank_id_
                 << ", chunk_size:" << chunk_size << ", remainder_size:" << remainder_size
-                << ", chunk_sizes:" << chunk_sizes << ", send_to_rank:" << send_to_rank
-                << ", rec_from_rank:" << rec_from_rank;
-
-  // Ring ReduceScatter.
-  MS_LOG(DEBUG) << "Start Ring ReduceScatter.";
-  for (size_t i = 0; i < rank_size_ - 1; i++) {
-    // Step 1: Async send data to next rank.
-    size_t send_chunk_index = (rank_id_ - i + rank_size_) % rank_size_;
-    float *send_chunk = output_buff + chunk_offset[send_chunk_index];
-    auto send_req_id = abs_node_->CollectiveSendAsync(ps::core::NodeRole::WORKER, send_to_rank, send_chunk,
-                                                      chunk_sizes[send_chunk_index] * sizeof(float));
-    // Step 2: Async receive data to next rank and wait until it's done.
-    size_t rec_chunk_index = (rank_id_ - i - 1 + rank_size_) % rank_size_;
-    float *rec_chunk = output_buff + chunk_offset[rec_chunk_index];
-    MS_LOG(DEBUG) << "Ring ReduceScatter send_to_rank:" << send_to_rank << ", rec_from_rank:" << rec_from_rank
-                  << ", send data_num:" << chunk_sizes[send_chunk_index]
-                  << ", rec data_num:" << chunk_sizes[rec_chunk_index] << ", iteration:" << i;
+                << ", chunk_sizes:" << chunk_sizes << ", segment_num:" << segment_num
+                << ", send_to_rank:" << send_to_rank << ", rec_from_rank:" << rec_from_rank;
 
-    std::shared_ptr<std::vector<unsigned char>> rec_ptr = nullptr;
-    auto rec_req_id = abs_node_->CollectiveReceiveAsync(ps::core::NodeRole::WORKER, rec_from_rank, &rec_ptr);
-    if (!abs_node_->CollectiveWait(rec_req_id, kWaitTimeout)) {
-      MS_LOG(ERROR) << "Ring ReduceScatter wait receiving" << rec_req_id << " failed.";
-      return false;
-    }
-    // Step 3: Reduce the data, so we can overlap the time cost of send.
-    const auto *tmp_data = reinterpret_cast<float *>(rec_ptr->data());
-    for (size_t j = 0; j < chunk_sizes[rec_chunk_index]; j++) {
-      rec_chunk[j] += tmp_data[j];
-    }
-    // Step 4: Wait until send is done.
-    if (!abs_node_->Wait(send_req_id, kWaitTimeout)) {
-      MS_LOG(ERROR) << "Ring ReduceScatter wait sending " << send_req_id << " failed.";
-      return false;
+  // The first rank_size_ - 1 steps are the ring reduce scatter and the rest are the ring all gather. In the step i, the
+  // chunk (rank_id_ - i) is sent and the chunk (rank_id_ - i - 1) is received, so the chunk received in a step is sent
+  // in the next step, and each segment is sent as soon as it is received, without waiting for the whole chunk.
+  const size_t step_num = 2 * (rank_size_ - 1);
+  std::vector<uint64_t> send_req_ids;
+  size_t first_send_chunk_index = rank_id_;
+  for (size_t j = 0; j < segment_num; j++) {
+    auto [offset, size] = segment_range(first_send_chunk_index, j);
+    (void)send_req_ids.emplace_back(abs_node_->CollectiveSendAsync(ps::core::NodeRole::WORKER, send_to_rank,
+                                                                   output_buff + offset, size * sizeof(float)));
+  }
+  for (size_t i = 0; i < step_num; i++) {
+    size_t rec_chunk_index = (rank_id_ + 2 * rank_size_ - i - 1) % rank_size_;
+    bool is_reduce_scatter = i < rank_size_ - 1;
+    MS_LOG(DEBUG) << "Ring " << (is_reduce_scatter ? "ReduceScatter" : "AllGather") << " send_to_rank:" << send_to_rank
+                  << ", rec_from_rank:" << rec_from_rank << ", rec data_num:" << chunk_sizes[rec_chunk_index]
+                  << ", iteration:" << i;
+    for (size_t j = 0; j < segment_num; j++) {
+      auto [offset, size] = segment_range(rec_chunk_index, j);
+      std::shared_ptr<std::vector<unsigned char>> rec_ptr = nullptr;
+      if (!Receive(rec_from_rank, &rec_ptr, size * sizeof(float))) {
+        MS_LOG(ERROR) << "RingAllReduce receives the segment " << j << " of the iteration " << i << " failed.";
+        return false;
+      }
+      // Reduce the data while the next segments are being received and the earlier segments are being sent.
+      float *rec_segment = output_buff + offset;
+      if (is_reduce_scatter) {
+        ReduceSum(rec_segment, reinterpret_cast<float *>(rec_ptr->data()), size);
+      } else {
+        memcpy_ret = memcpy_s(rec_segment, size * sizeof(float), rec_ptr->data(), rec_ptr->size());
+        if (memcpy_ret != EOK) {
+          MS_LOG(ERROR) << "Ring AllGather memcpy_s received data error, errorno(" << memcpy_ret << ")";
+          return false;
+        }
+      }
+      if (i + 1 < step_num) {
+        (void)send_req_ids.emplace_back(abs_node_->CollectiveSendAsync(ps::core::NodeRole::WORKER, send_to_rank,
+                                                                       rec_segment, size * sizeof(float)));
+      }
     }
   }
-  MS_LOG(DEBUG) << "End Ring ReduceScatter.";
-
-  // Ring AllGather.
-  MS_LOG(DEBUG) << "Start Ring AllGather.";
-  for (size_t i = 0; i < rank_size_ - 1; i++) {
-    size_t send_chunk_index = (rank_id_ - i + 1 + rank_size_) % rank_size_;
-    float *send_chunk = output_buff + chunk_offset[send_chunk_index];
-    auto send_req_id = abs_node_->CollectiveSendAsync(ps::core::NodeRole::WORKER, send_to_rank, send_chunk,
-                                                      chunk_sizes[send_chunk_index] * sizeof(float));
-    size_t rec_chunk_index = (rank_id_ - i + rank_size_) % rank_size_;
-    float *rec_chunk = output_buff + chunk_offset[rec_chunk_index];
-    MS_LOG(DEBUG) << "Ring AllGather send_to_rank:" << send_to_rank << ", rec_from_rank:" << rec_from_rank
-                  << ", send data_num:" << chunk_sizes[send_chunk_index]
-                  << ", rec data_num:" << chunk_sizes[rec_chunk_index] << ", iteration:" << i;
+  if (!WaitSend(send_req_ids)) {
+    MS_LOG(ERROR) << "RingAllReduce wait sending failed.";
+    return false;
+  }
+  return true;
+}
+
+bool AllReduceLauncher::HalvingDoublingAllReduce(const void *input_data, void *const output_data,
+                                                 size_t data_size) const {
+  int memcpy_ret = memcpy_s(output_data, data_size, input_data, data_size);
+  if (memcpy_ret != EOK) {
+    MS_LOG(ERROR) << "HalvingDoublingAllReduce memcpy_s input_data error, errorno(" << memcpy_ret << ")";
+    return false;
+  }
+  auto *output_buff = reinterpret_cast<float *>(output_data);
+  size_t begin = 0;
+  size_t end = data_size / sizeof(float);
+  // The data range of each halving step, which is restored in the reversed order by the doubling steps.
+  std::vector<std::pair<size_t, size_t>> ranges;
+  std::vector<uint64_t> send_req_ids;
 
+  // Recursive halving reduce scatter: exchange half of the current range with the partner and reduce the other half.
+  // The partners have the same range, and each rank owns the reduced 1 / rank_size_ of the data at last.
+  for (size_t mask = rank_size_ >> 1; mask > 0; mask >>= 1) {
+    uint32_t partner = SizeToUint(rank_id_ ^ mask);
+    size_t middle = begin + (end - begin) / 2;
+    bool keep_lower = (rank_id_ & mask) == 0;
+    size_t send_begin = keep_lower ? middle : begin;
+    size_t send_end = keep_lower ? end : middle;
+    size_t keep_begin = keep_lower ? begin : middle;
+    size_t keep_end = keep_lower ? middle : end;
+    (void)send_req_ids.emplace_back(abs_node_->CollectiveSendAsync(
+      ps::core::NodeRole::WORKER, partner, output_buff + send_begin, (send_end - send_begin) * sizeof(float)));
     std::shared_ptr<std::vector<unsigned char>> rec_ptr = nullptr;
-    auto rec_req_id = abs_node_->CollectiveReceiveAsync(ps::core::NodeRole::WORKER, rec_from_rank, &rec_ptr);
-    if (!abs_node_->CollectiveWait(rec_req_id, kWaitTimeout)) {
-      MS_LOG(ERROR) << "Ring AllGather wait receiving " << rec_req_id << " failed.";
+    if (!Receive(partner, &rec_ptr, (keep_end - keep_begin) * sizeof(float))) {
+      MS_LOG(ERROR) << "Halving ReduceScatter receives from rank " << partner << " failed.";
       return false;
     }
-    memcpy_ret = memcpy_s(rec_chunk, chunk_sizes[rec_chunk_index] * sizeof(float), rec_ptr->data(), rec_ptr->size());
-    if (memcpy_ret != 0) {
-      MS_LOG(ERROR) << "Ring AllGather memcpy_s received data error, errorno(" << memcpy_ret << ")";
+    ReduceSum(output_buff + keep_begin, reinterpret_cast<float *>(rec_ptr->data()), keep_end - keep_begin);
+    (void)ranges.emplace_back(begin, end);
+    begin = keep_begin;
+    end = keep_end;
+  }
+
+  // Recursive doubling all gather: exchange the owned range with the partner, which owns the other half of the range
+  // of the corresponding halving step.
+  for (size_t mask = 1; mask < rank_size_; mask <<= 1) {
+    uint32_t partner = SizeToUint(rank_id_ ^ mask);
+    auto [range_begin, range_end] = ranges.back();
+    ranges.pop_back();
+    (void)send_req_ids.emplace_back(abs_node_->CollectiveSendAsync(ps::core::NodeRole::WORKER, partner,
+                                                                   output_buff + begin, (end - begin) * sizeof(float)));
+    size_t rec_begin = begin == range_begin ? end : range_begin;
+    size_t rec_end = begin == range_begin ? range_end : begin;
+    std::shared_ptr<std::vector<unsigned char>> rec_ptr = nullptr;
+    if (!Receive(partner, &rec_ptr, (rec_end - rec_begin) * sizeof(float))) {
+      MS_LOG(ERROR) << "Doubling AllGather receives from rank " << partner << " failed.";
       return false;
     }
-    if (!abs_node_->Wait(send_req_id, kWaitTimeout)) {
-      MS_LOG(ERROR) << "RingAllReduce wait sending " << send_req_id << " failed.";
+    memcpy_ret = memcpy_s(output_buff + rec_begin, (rec_end - rec_begin) * sizeof(float), rec_ptr->data(),
+                          rec_ptr->size());
+    if (memcpy_ret != EOK) {
+      MS_LOG(ERROR) << "Doubling AllGather memcpy_s received data error, errorno(" << memcpy_ret << ")";
       return false;
     }
+    begin = range_begin;
+    end = range_end;
+  }
+  if (!WaitSend(send_req_ids)) {
+    MS_LOG(ERROR) << "HalvingDoublingAllReduce wait sending failed.";
+    return false;
   }
-  MS_LOG(DEBUG) << "End Ring AllGather.";
   return true;
 }
 
@@ -175,10 +296,7 @@ bool AllReduceLauncher::ReduceBroadcastAllReduce(const void *input_data, void *c
         MS_LOG(ERROR) << "Reduce wait receiving " << rec_req_id << " failed.";
         return false;
       }
-      const auto *tmp_data = reinterpret_cast<float *>(rec_ptr->data());
-      for (size_t j = 0; j < data_num; j++) {
-        output_buff[j] += tmp_data[j];
-      }
+      ReduceSum(output_buff, reinterpret_cast<float *>(rec_ptr->data()), data_num);
     }
   } else {
     MS_LOG(DEBUG) << "Reduce send data to rank 0 process.";
@@ -17,7 +17,9 @@
 #ifndef MINDSPORE_CCSRC_RUNTIME_HARDWARE_CPU_ALLREDUCE_IMPL_H_
 #define MINDSPORE_CCSRC_RUNTIME_HARDWARE_CPU_ALLREDUCE_IMPL_H_
 
+#include <memory>
 #include <string>
+#include <vector>
 #include "distributed/cluster/cluster_context.h"
 
 namespace mindspore {
@@ -43,8 +45,19 @@ class AllReduceLauncher {
 
   AllReduceLauncher();
 
+  // The ring algorithm for the large data, the chunks are split into segments and the reduce scatter and all gather
+  // are pipelined by segment, so the sending, receiving and reduction of different segments overlap.
   bool RingAllReduce(const void *input_data, void *const output_data, size_t data_size) const;
+  // The recursive halving reduce scatter and recursive doubling all gather for the power of two ranks, which needs
+  // log2(rank_size) steps instead of 2 * (rank_size - 1) steps of the ring.
+  bool HalvingDoublingAllReduce(const void *input_data, void *const output_data, size_t data_size) const;
   bool ReduceBroadcastAllReduce(const void *input_data, void *const output_data, size_t data_size) const;
+
+  // Receive the data from the rank and check the received size.
+  bool Receive(uint32_t rank, std::shared_ptr<std::vector<unsigned char>> *rec_ptr, size_t expect_size) const;
+  bool WaitSend(const std::vector<uint64_t> &send_req_ids) const;
+  // Add the src to the dst by multiple threads.
+  void ReduceSum(float *dst, const float *src, size_t data_num) const;
 };
 }  // namespace cpu
 }  // namespace device
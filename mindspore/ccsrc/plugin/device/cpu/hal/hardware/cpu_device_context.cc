@@ -50,6 +50,11 @@
 namespace mindspore {
 namespace device {
 namespace cpu {
+namespace {
+// The max byte size of the fused AllReduce, the gradients are fused into the buckets of this size, so the reduction of
+// the ready buckets overlaps the computation of the rest gradients.
+constexpr size_t kAllReduceBucketSize = 4 << 20;
+}  // namespace
 using mindspore::kernel::KernelBuildInfo;
 
 void CPUDeviceContext::Initialize() {
@@ -172,7 +177,7 @@ void CPUDeviceContext::OptimizeGraphImpl(const KernelGraphPtr &graph) const {
   auto optimizer = std::make_shared<opt::GraphOptimizer>();
   auto pm = std::make_shared<opt::PassManager>();
   pm->AddPass(std::make_shared<opt::InsertFormatTransformOpCPU>("insert_format_transform_op_cpu"));
-  pm->AddPass(std::make_shared<opt::AllReduceFusion>());
+  pm->AddPass(std::make_shared<opt::AllReduceFusion>(1, kAllReduceBucketSize));
   pm->AddPass(std::make_shared<opt::InsertCastCPU>("insert_cast"));
   pm->AddPass(std::make_shared<opt::EraseVisitAttr>());
   optimizer->AddPassManager(pm);
@@ -76,13 +76,20 @@ size_t CPUMemoryPool::AllocDeviceMem(size_t alloc_size, DeviceMemPtr *addr) {
   }
 
   total_used_memory_ += alloc_size;
+  mem_block_sizes_[*addr] = alloc_size;
   MS_LOG(INFO) << "Current alloc size[" << alloc_size << "], total used size[" << total_used_memory_ << "].";
 
   return alloc_size;
 }
 
 bool CPUMemoryPool::FreeDeviceMem(const DeviceMemPtr &addr) {
+  const auto &iter = mem_block_sizes_.find(addr);
+  if (iter != mem_block_sizes_.end()) {
+    total_used_memory_ -= iter->second;
+    (void)mem_block_sizes_.erase(iter);
+  }
   free(addr);
+  MS_LOG(INFO) << "Current free address[" << addr << "], total used size[" << total_used_memory_ << "].";
   return true;
 }
 
@@ -17,6 +17,7 @@
 #ifndef MINDSPORE_CCSRC_RUNTIME_HARDWARE_CPU_CPU_MEMORY_POOL_H_
 #define MINDSPORE_CCSRC_RUNTIME_HARDWARE_CPU_CPU_MEMORY_POOL_H_
 
+#include <map>
 #include <memory>
 #include "utils/ms_utils.h"
 #include "common/mem_reuse/mem_dynamic_allocator.h"
@@ -37,11 +38,17 @@ class CPUMemoryPool : public DynamicMemPoolBestFit {
   bool FreeDeviceMem(const DeviceMemPtr &addr) override;
   size_t free_mem_size() override;
 
+ protected:
+  // The memory blocks are allocated by malloc, the free blocks can be given back to the system one by one.
+  bool IsMemBlockReleasable() const override { return true; }
+
  private:
   CPUMemoryPool() = default;
   DISABLE_COPY_AND_ASSIGN(CPUMemoryPool);
 
   size_t total_used_memory_{0};
+  // The size of memory blocks allocated by malloc.
+  std::map<DeviceMemPtr, size_t> mem_block_sizes_;
 };
 }  // namespace cpu
 }  // namespace device
@@ -0,0 +1,208 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "nnacl/fp32/sparse_optimizer_fp32.h"
+
+// 32 bits, block_size : (512/256/128/32), block_num : (16/8/4/1)
+#define SimdSparseAdamMomentumCoreCalc(block_size, block_num, m, v, gradient, beta1, beta2, size, index)    \
+  for (; index + block_num <= size; index += block_num) {                                                   \
+    MS_FLOAT_32xN(block_num) g = MS_LD_F32(block_size, gradient + index);                                   \
+    MS_FLOAT_32xN(block_num) m_r = MS_LD_F32(block_size, m + index);                                        \
+    MS_FLOAT_32xN(block_num) v_r = MS_LD_F32(block_size, v + index);                                        \
+    m_r = MS_ADD_F32(block_size, m_r, MS_MUL_N_F32(block_size, g, 1 - (beta1)));                            \
+    v_r = MS_ADD_F32(block_size, v_r, MS_MUL_N_F32(block_size, MS_MUL_F32(block_size, g, g), 1 - (beta2))); \
+    MS_ST_F32(block_size, m + index, m_r);                                                                  \
+    MS_ST_F32(block_size, v + index, v_r);                                                                  \
+  }
+
+#define SimdSparseAdamNesterovCoreCalc(block_size, block_num, m, m_t, v, gradient, beta1, beta2, size, index)  \
+  for (; index + block_num <= size; index += block_num) {                                                      \
+    MS_FLOAT_32xN(block_num) g = MS_LD_F32(block_size, gradient + index);                                      \
+    MS_FLOAT_32xN(block_num) g_beta1 = MS_MUL_N_F32(block_size, g, 1 - (beta1));                               \
+    MS_FLOAT_32xN(block_num) m_r = MS_ADD_F32(block_size, MS_LD_F32(block_size, m + index), g_beta1);          \
+    MS_FLOAT_32xN(block_num) v_r = MS_LD_F32(block_size, v + index);                                           \
+    v_r = MS_ADD_F32(block_size, v_r, MS_MUL_N_F32(block_size, MS_MUL_F32(block_size, g, g), 1 - (beta2)));    \
+    MS_ST_F32(block_size, m + index, m_r);                                                                     \
+    MS_ST_F32(block_size, v + index, v_r);                                                                     \
+    MS_ST_F32(block_size, m_t + index, MS_ADD_F32(block_size, MS_MUL_N_F32(block_size, m_r, beta1), g_beta1)); \
+  }
+
+int SparseAdamMomentumFp32(float *m, float *m_t, float *v, const float *gradient, float beta1, float beta2,
+                           size_t size, bool use_nesterov) {
+  size_t index = 0;
+  if (use_nesterov) {
+    MS_SIMD_RUN_NO_SCALAR(SimdSparseAdamNesterovCoreCalc, m, m_t, v, gradient, beta1, beta2, size, index);
+  } else {
+    MS_SIMD_RUN_NO_SCALAR(SimdSparseAdamMomentumCoreCalc, m, v, gradient, beta1, beta2, size, index);
+  }
+  for (; index < size; ++index) {
+    float g = gradient[index];
+    m[index] += (1 - beta1) * g;
+    v[index] += (1 - beta2) * g * g;
+    if (use_nesterov) {
+      m_t[index] = m[index] * beta1 + (1 - beta1) * g;
+    }
+  }
+  return NNACL_OK;
+}
+
+#define SimdSparseLazyAdamCoreCalc(block_size, block_num, var, m, v, gradient, lr, beta1, beta2, epsilon, size,    \
+                                   use_nesterov, index)                                                            \
+  for (; index + block_num <= size; index += block_num) {                                                          \
+    MS_FLOAT_32xN(block_num) g = MS_LD_F32(block_size, gradient + index);                                          \
+    MS_FLOAT_32xN(block_num) g_beta1 = MS_MUL_N_F32(block_size, g, 1 - (beta1));                                   \
+    MS_FLOAT_32xN(block_num) m_r = MS_MUL_N_F32(block_size, MS_LD_F32(block_size, m + index), beta1);              \
+    MS_FLOAT_32xN(block_num) v_r = MS_MUL_N_F32(block_size, MS_LD_F32(block_size, v + index), beta2);              \
+    m_r = MS_ADD_F32(block_size, m_r, g_beta1);                                                                    \
+    v_r = MS_ADD_F32(block_size, v_r, MS_MUL_N_F32(block_size, MS_MUL_F32(block_size, g, g), 1 - (beta2)));        \
+    MS_ST_F32(block_size, m + index, m_r);                                                                         \
+    MS_ST_F32(block_size, v + index, v_r);                                                                         \
+    MS_FLOAT_32xN(block_num) numerator =                                                                           \
+      (use_nesterov) ? MS_ADD_F32(block_size, MS_MUL_N_F32(block_size, m_r, beta1), g_beta1) : m_r;                \
+    MS_FLOAT_32xN(block_num) denominator = MS_ADD_N_F32(block_size, MS_SQRT_F32(block_size, v_r), epsilon);        \
+    MS_FLOAT_32xN(block_num) delta = MS_DIV_F32(block_size, MS_MUL_N_F32(block_size, numerator, lr), denominator); \
+    MS_ST_F32(block_size, var + index, MS_SUB_F32(block_size, MS_LD_F32(block_size, var + index), delta));         \
+  }
+
+int SparseLazyAdamFp32(float *var, float *m, float *v, const float *gradient, float lr, float beta1, float beta2,
+                       float epsilon, size_t size, bool use_nesterov) {
+  size_t index = 0;
+  MS_SIMD_RUN_NO_SCALAR(SimdSparseLazyAdamCoreCalc, var, m, v, gradient, lr, beta1, beta2, epsilon, size,
+                        use_nesterov, index);
+  for (; index < size; ++index) {
+    float g = gradient[index];
+    m[index] = beta1 * m[index] + (1 - beta1) * g;
+    v[index] = beta2 * v[index] + (1 - beta2) * g * g;
+    if (use_nesterov) {
+      var[index] -= lr * (m[index] * beta1 + (1 - beta1) * g) / (sqrtf(v[index]) + epsilon);
+    } else {
+      var[index] -= lr * m[index] / (sqrtf(v[index]) + epsilon);
+    }
+  }
+  return NNACL_OK;
+}
+
+// sign(linear) * l1 - linear is written as clamp(linear, -l1, l1) - linear, which is also 0 when |linear| <= l1.
+#define SimdSparseFtrlCoreCalc(block_size, block_num, var, accum, linear, gradient, lr, l1, l2_plus, size, index)   \
+  for (; index + block_num <= size; index += block_num) {                                                           \
+    MS_FLOAT_32xN(block_num) g = MS_LD_F32(block_size, gradient + index);                                           \
+    MS_FLOAT_32xN(block_num) accum_r = MS_LD_F32(block_size, accum + index);                                        \
+    MS_FLOAT_32xN(block_num) accum_new = MS_ADD_F32(block_size, accum_r, MS_MUL_F32(block_size, g, g));             \
+    MS_FLOAT_32xN(block_num) y = MS_SQRT_F32(block_size, accum_new);                                                \
+    MS_FLOAT_32xN(block_num) sigma = MS_SUB_F32(block_size, y, MS_SQRT_F32(block_size, accum_r));                   \
+    sigma = MS_DIV_N_F32(block_size, sigma, lr);                                                                    \
+    MS_FLOAT_32xN(block_num) linear_r = MS_ADD_F32(block_size, MS_LD_F32(block_size, linear + index), g);           \
+    linear_r = MS_SUB_F32(block_size, linear_r, MS_MUL_F32(block_size, sigma, MS_LD_F32(block_size, var + index))); \
+    MS_ST_F32(block_size, accum + index, accum_new);                                                                \
+    MS_ST_F32(block_size, linear + index, linear_r);                                                                \
+    MS_FLOAT_32xN(block_num) clamp = MS_MIN_N_F32(block_size, MS_MAX_N_F32(block_size, linear_r, -(l1)), l1);       \
+    y = MS_ADD_N_F32(block_size, MS_DIV_N_F32(block_size, y, lr), l2_plus);                                         \
+    MS_ST_F32(block_size, var + index, MS_DIV_F32(block_size, MS_SUB_F32(block_size, clamp, linear_r), y));         \
+  }
+
+int SparseFtrlFp32(float *var, float *accum, float *linear, const float *gradient, float lr, float l1, float l2_plus,
+                   size_t size) {
+  size_t index = 0;
+  MS_SIMD_RUN_NO_SCALAR(SimdSparseFtrlCoreCalc, var, accum, linear, gradient, lr, l1, l2_plus, size, index);
+  for (; index < size; ++index) {
+    float g = gradient[index];
+    float accum_new = accum[index] + g * g;
+    float y = sqrtf(accum_new);
+    linear[index] += g;
+    linear[index] -= ((y - sqrtf(accum[index])) / lr) * var[index];
+    accum[index] = accum_new;
+    float x = (linear[index] > 0 ? l1 : -l1) - linear[index];
+    y = y / lr + l2_plus;
+    var[index] = fabsf(linear[index]) > l1 ? x / y : 0;
+  }
+  return NNACL_OK;
+}
+
+// sign(prox_v) * max(|prox_v| - lr * l1, 0) is written as prox_v - clamp(prox_v, -lr * l1, lr * l1).
+#define SimdSparseProximalAdagradCoreCalc(block_size, block_num, var, accum, gradient, lr, l1, l2, size, index)  \
+  for (; index + block_num <= size; index += block_num) {                                                        \
+    MS_FLOAT_32xN(block_num) g = MS_LD_F32(block_size, gradient + index);                                        \
+    MS_FLOAT_32xN(block_num) accum_r = MS_ADD_F32(block_size, MS_LD_F32(block_size, accum + index),              \
+                                                  MS_MUL_F32(block_size, g, g));                                 \
+    MS_ST_F32(block_size, accum + index, accum_r);                                                               \
+    MS_FLOAT_32xN(block_num) learning_rate =                                                                     \
+      MS_DIV_F32(block_size, MS_MOVN_F32(block_size, 1.0f), MS_SQRT_F32(block_size, accum_r));                   \
+    learning_rate = MS_MUL_N_F32(block_size, learning_rate, lr);                                                 \
+    MS_FLOAT_32xN(block_num) prox_v =                                                                            \
+      MS_SUB_F32(block_size, MS_LD_F32(block_size, var + index), MS_MUL_F32(block_size, g, learning_rate));      \
+    if ((l1) > 0) {                                                                                              \
+      MS_FLOAT_32xN(block_num) threshold = MS_MUL_N_F32(block_size, learning_rate, l1);                          \
+      MS_FLOAT_32xN(block_num) neg_threshold = MS_SUB_F32(block_size, MS_MOVN_F32(block_size, 0.0f), threshold); \
+      prox_v = MS_SUB_F32(block_size, prox_v,                                                                    \
+                          MS_MIN_F32(block_size, MS_MAX_F32(block_size, prox_v, neg_threshold), threshold));     \
+    }                                                                                                            \
+    MS_FLOAT_32xN(block_num) denominator =                                                                       \
+      MS_ADD_N_F32(block_size, MS_MUL_N_F32(block_size, learning_rate, l2), 1.0f);                               \
+    MS_ST_F32(block_size, var + index, MS_DIV_F32(block_size, prox_v, denominator));                             \
+  }
+
+int SparseProximalAdagradFp32(float *var, float *accum, const float *gradient, float lr, float l1, float l2,
+                              size_t size) {
+  size_t index = 0;
+  MS_SIMD_RUN_NO_SCALAR(SimdSparseProximalAdagradCoreCalc, var, accum, gradient, lr, l1, l2, size, index);
+  for (; index < size; ++index) {
+    float g = gradient[index];
+    accum[index] += g * g;
+    float learning_rate = lr * (1 / sqrtf(accum[index]));
+    float prox_v = var[index] - g * learning_rate;
+    if (l1 > 0) {
+      float sign = prox_v > 0 ? 1.0f : (prox_v < 0 ? -1.0f : 0.0f);
+      var[index] = sign * fmaxf(fabsf(prox_v) - learning_rate * l1, 0.0f) / (1 + l2 * learning_rate);
+    } else {
+      var[index] = prox_v / (1 + l2 * learning_rate);
+    }
+  }
+  return NNACL_OK;
+}
+
+#define SimdAdamDecayMomentumCoreCalc(block_size, block_num, m, v, beta1, beta2, end, index)             \
+  for (; index + block_num <= end; index += block_num) {                                                 \
+    MS_ST_F32(block_size, m + index, MS_MUL_N_F32(block_size, MS_LD_F32(block_size, m + index), beta1)); \
+    MS_ST_F32(block_size, v + index, MS_MUL_N_F32(block_size, MS_LD_F32(block_size, v + index), beta2)); \
+  }
+
+int AdamDecayMomentumFp32(float *m, float *v, float beta1, float beta2, size_t start, size_t end) {
+  size_t index = start;
+  MS_SIMD_RUN_NO_SCALAR(SimdAdamDecayMomentumCoreCalc, m, v, beta1, beta2, end, index);
+  for (; index < end; ++index) {
+    m[index] *= beta1;
+    v[index] *= beta2;
+  }
+  return NNACL_OK;
+}
+
+#define SimdAdamUpdateWeightCoreCalc(block_size, block_num, var, m, v, lr, epsilon, end, index)            \
+  for (; index + block_num <= end; index += block_num) {                                                   \
+    MS_FLOAT_32xN(block_num) denominator =                                                                 \
+      MS_ADD_N_F32(block_size, MS_SQRT_F32(block_size, MS_LD_F32(block_size, v + index)), epsilon);        \
+    MS_FLOAT_32xN(block_num) delta =                                                                       \
+      MS_DIV_F32(block_size, MS_MUL_N_F32(block_size, MS_LD_F32(block_size, m + index), lr), denominator); \
+    MS_ST_F32(block_size, var + index, MS_SUB_F32(block_size, MS_LD_F32(block_size, var + index), delta)); \
+  }
+
+int AdamUpdateWeightFp32(float *var, const float *m, const float *v, float lr, float epsilon, size_t start,
+                         size_t end) {
+  size_t index = start;
+  MS_SIMD_RUN_NO_SCALAR(SimdAdamUpdateWeightCoreCalc, var, m, v, lr, epsilon, end, index);
+  for (; index < end; ++index) {
+    var[index] -= lr * m[index] / (sqrtf(v[index]) + epsilon);
+  }
+  return NNACL_OK;
+}
@@ -0,0 +1,45 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_NNACL_FP32_SPARSE_OPTIMIZER_FP32_H_
+#define MINDSPORE_NNACL_FP32_SPARSE_OPTIMIZER_FP32_H_
+
+#include <math.h>
+#include "nnacl/op_base.h"
+#include "nnacl/errorcode.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// The row updates of the sparse optimizers, 'size' elements of the row of 'var' hit by one reduced gradient row.
+int SparseAdamMomentumFp32(float *m, float *m_t, float *v, const float *gradient, float beta1, float beta2,
+                           size_t size, bool use_nesterov);
+int SparseLazyAdamFp32(float *var, float *m, float *v, const float *gradient, float lr, float beta1, float beta2,
+                       float epsilon, size_t size, bool use_nesterov);
+// Only for lr_power == -0.5, other powers have no vector pow and stay in the kernel.
+int SparseFtrlFp32(float *var, float *accum, float *linear, const float *gradient, float lr, float l1, float l2_plus,
+                   size_t size);
+int SparseProximalAdagradFp32(float *var, float *accum, const float *gradient, float lr, float l1, float l2,
+                              size_t size);
+
+// The dense part of the sparse adam, run over [start, end) of the whole 'var'.
+int AdamDecayMomentumFp32(float *m, float *v, float beta1, float beta2, size_t start, size_t end);
+int AdamUpdateWeightFp32(float *var, const float *m, const float *v, float lr, float epsilon, size_t start,
+                         size_t end);
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MINDSPORE_NNACL_FP32_SPARSE_OPTIMIZER_FP32_H_
@@ -0,0 +1,90 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "nnacl/fp32/stochastic_quant_fp32.h"
+
+// 32 bits, block_size : (512/256/128/32), block_num : (16/8/4/1)
+#define SimdMinMaxCoreCalc(block_size, block_num, data, size, min_val, max_val, index)             \
+  if (index + block_num <= size) {                                                                 \
+    MS_FLOAT_32xN(block_num) min_r = MS_LD_F32(block_size, data + index);                          \
+    MS_FLOAT_32xN(block_num) max_r = min_r;                                                        \
+    for (index += block_num; index + block_num <= size; index += block_num) {                      \
+      MS_FLOAT_32xN(block_num) d = MS_LD_F32(block_size, data + index);                            \
+      min_r = MS_MIN_F32(block_size, min_r, d);                                                    \
+      max_r = MS_MAX_F32(block_size, max_r, d);                                                    \
+    }                                                                                              \
+    min_val = MSMIN(min_val, -MS_GET_MAX_F32(block_size, MS_MUL_N_F32(block_size, min_r, -1.0f))); \
+    max_val = MSMAX(max_val, MS_GET_MAX_F32(block_size, max_r));                                   \
+  }
+
+int MinMaxFp32(const float *data, size_t size, float *min, float *max) {
+  if (data == NULL || min == NULL || max == NULL || size == 0) {
+    return NNACL_PARAM_INVALID;
+  }
+  float min_val = data[0];
+  float max_val = data[0];
+  size_t index = 0;
+  MS_SIMD_RUN_NO_SCALAR(SimdMinMaxCoreCalc, data, size, min_val, max_val, index);
+  for (; index < size; ++index) {
+    min_val = MSMIN(min_val, data[index]);
+    max_val = MSMAX(max_val, data[index]);
+  }
+  *min = min_val;
+  *max = max_val;
+  return NNACL_OK;
+}
+
+// The codes are non-negative, floor is only vectorized on x86 and neon falls back to the scalar loop.
+#define SimdStochasticQuantCoreCalc(block_size, block_num, data, noise, size, min, inv_scale, max_code, codes, index) \
+  for (; index + block_num <= size; index += block_num) {                                                             \
+    MS_FLOAT_32xN(block_num) d = MS_SUB_N_F32(block_size, MS_LD_F32(block_size, data + index), min);                  \
+    MS_FLOAT_32xN(block_num) n = MS_LD_F32(block_size, noise + index);                                                \
+    MS_FLOAT_32xN(block_num) c = MS_ADD_F32(block_size, MS_MUL_N_F32(block_size, d, inv_scale), n);                   \
+    c = MS_FLOOR_F32(block_size, c);                                                                                  \
+    c = MS_MIN_N_F32(block_size, MS_MAX_N_F32(block_size, c, 0.0f), max_code);                                        \
+    MS_ST_F32(block_size, codes + index, c);                                                                          \
+  }
+
+int StochasticQuantFp32(const float *data, const float *noise, size_t size, float min, float inv_scale,
+                        float max_code, float *codes) {
+  if (data == NULL || noise == NULL || codes == NULL) {
+    return NNACL_NULL_PTR;
+  }
+  size_t index = 0;
+  MS_SIMD_RUN_X86_NO_SCALAR(SimdStochasticQuantCoreCalc, data, noise, size, min, inv_scale, max_code, codes, index);
+  for (; index < size; ++index) {
+    float c = floorf((data[index] - min) * inv_scale + noise[index]);
+    codes[index] = MSMIN(MSMAX(c, 0.0f), max_code);
+  }
+  return NNACL_OK;
+}
+
+#define SimdDequantCoreCalc(block_size, block_num, codes, size, min, scale, out, index)                    \
+  for (; index + block_num <= size; index += block_num) {                                                  \
+    MS_FLOAT_32xN(block_num) c = MS_LD_F32(block_size, codes + index);                                     \
+    MS_ST_F32(block_size, out + index, MS_ADD_N_F32(block_size, MS_MUL_N_F32(block_size, c, scale), min)); \
+  }
+
+int DequantFp32(const float *codes, size_t size, float min, float scale, float *out) {
+  if (codes == NULL || out == NULL) {
+    return NNACL_NULL_PTR;
+  }
+  size_t index = 0;
+  MS_SIMD_RUN_NO_SCALAR(SimdDequantCoreCalc, codes, size, min, scale, out, index);
+  for (; index < size; ++index) {
+    out[index] = codes[index] * scale + min;
+  }
+  return NNACL_OK;
+}
@@ -0,0 +1,36 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_NNACL_FP32_STOCHASTIC_QUANT_FP32_H_
+#define MINDSPORE_NNACL_FP32_STOCHASTIC_QUANT_FP32_H_
+
+#include <math.h>
+#include "nnacl/op_base.h"
+#include "nnacl/errorcode.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+int MinMaxFp32(const float *data, size_t size, float *min, float *max);
+// codes[i] = min(floor((data[i] - min) * inv_scale + noise[i]), max_code), noise is uniform in [0, 1).
+int StochasticQuantFp32(const float *data, const float *noise, size_t size, float min, float inv_scale,
+                        float max_code, float *codes);
+// out[i] = codes[i] * scale + min, 'codes' and 'out' may be the same buffer.
+int DequantFp32(const float *codes, size_t size, float min, float scale, float *out);
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MINDSPORE_NNACL_FP32_STOCHASTIC_QUANT_FP32_H_
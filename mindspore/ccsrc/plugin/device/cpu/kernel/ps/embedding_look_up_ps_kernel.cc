@@ -20,6 +20,7 @@
 #include <functional>
 #include "kernel/common_utils.h"
 #include "ps/util.h"
+#include "ps/ps_context.h"
 
 namespace mindspore {
 namespace kernel {
@@ -62,6 +63,11 @@ void EmbeddingLookUpPSKernelMod::InitKernel(
 
   // input shape must be sharded after computing offset_;
   Shard(&input_shape_, kAxis);
+  // The ids of the consistent hash sharded table are translated to the local rows by the parameter server.
+  if (mindspore::ps::PSContext::instance()->enable_embedding_hash_shard()) {
+    offset_ = 0;
+    first_dim_size_ = input_shape_[kAxis];
+  }
 
   size_t output_size =
     std::accumulate(output_shape.begin(), output_shape.end(), sizeof(float), std::multiplies<size_t>());
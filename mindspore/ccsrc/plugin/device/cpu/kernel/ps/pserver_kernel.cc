@@ -15,6 +15,8 @@
  */
 
 #include "plugin/device/cpu/kernel/ps/pserver_kernel.h"
+#include "ps/ps_context.h"
+#include "ps/embedding_shard_ring.h"
 
 namespace mindspore {
 namespace kernel {
@@ -24,6 +26,12 @@ void PServerKernel::Shard(std::vector<size_t> *shape, int axis) {
   if ((*shape).size() <= IntToSize(axis)) {
     MS_LOG(EXCEPTION) << "Shape size is invalid.";
   }
+  // The consistent hash sharded embedding table is allocated with the room for the rows migrated from other servers.
+  if (mindspore::ps::PSContext::instance()->enable_embedding_hash_shard()) {
+    (*shape)[IntToSize(axis)] =
+      mindspore::ps::EmbeddingShardMap::LocalRowCapacity((*shape)[IntToSize(axis)], pserver_num_);
+    return;
+  }
   (*shape)[IntToSize(axis)] =
     LongToSize(Util::LocalShard(SizeToLong((*shape)[IntToSize(axis)]), SizeToLong(rank_id_), SizeToLong(pserver_num_)));
 }
@@ -17,6 +17,7 @@
 #include "plugin/device/cpu/kernel/sparse_apply_adam_cpu_kernel.h"
 #include "kernel/common_utils.h"
 #include "plugin/device/cpu/hal/device/cpu_device_address.h"
+#include "plugin/device/cpu/kernel/nnacl/fp32/sparse_optimizer_fp32.h"
 
 namespace mindspore {
 namespace kernel {
@@ -44,15 +45,9 @@ void ComputeAdam(MultiThreadComputeParams<T> *input_params, size_t start, size_t
                         << SizeToLong(var_first_dim_size) << "), but got " << index;
     }
     size_t start_index = var_outer_dim_size * static_cast<size_t>(index);
-    size_t end_index = start_index + var_outer_dim_size;
-    for (size_t j = start_index, k = var_outer_dim_size * i; j < end_index; ++j, ++k) {
-      auto summed_grad = unique_sparse_grad.value_[k];
-      m[j] += (1 - beta1) * summed_grad;
-      v[j] += (1 - beta2) * summed_grad * summed_grad;
-      if (use_nesterov) {
-        m_t[j] = m[j] * beta1 + (1 - beta1) * summed_grad;
-      }
-    }
+    (void)SparseAdamMomentumFp32(m + start_index, m_t + start_index, v + start_index,
+                                 unique_sparse_grad.value_ + var_outer_dim_size * i, beta1, beta2, var_outer_dim_size,
+                                 use_nesterov);
   }
 }
 
@@ -63,10 +58,7 @@ void ComputeMomentum(MultiThreadComputeParams<T> *input_params, size_t start, si
   auto v = input_params->v_;
   const auto beta1 = input_params->beta1_;
   const auto beta2 = input_params->beta2_;
-  for (size_t i = start; i < end; ++i) {
-    m[i] *= beta1;
-    v[i] *= beta2;
-  }
+  (void)AdamDecayMomentumFp32(m, v, beta1, beta2, start, end);
 }
 
 template <typename T>
@@ -77,9 +69,7 @@ void ComputeWeight(MultiThreadComputeParams<T> *input_params, size_t start, size
   const auto *v = input_params->v_;
   const auto lr = input_params->lr_;
   const auto epsilon = input_params->epsilon_;
-  for (size_t i = start; i < end; ++i) {
-    var[i] -= lr * m[i] / (std::sqrt(v[i]) + epsilon);
-  }
+  (void)AdamUpdateWeightFp32(var, m, v, lr, epsilon, start, end);
 }
 }  // namespace
 
@@ -197,7 +187,7 @@ void SparseApplyAdamCpuKernelMod::LaunchKernel(const std::vector<kernel::Address
   input_params.v_ = v;
   input_params.beta1_ = beta1;
   input_params.beta2_ = beta2;
-  MultiThreadCompute<T>(ComputeMomentum<T>, &input_params, total_dim_size);
+  MultiThreadCompute<T>(ComputeMomentum<T>, &input_params, total_dim_size, kCacheLineFloatNum);
   input_params.m_t_ = m_t;
   input_params.use_nesterov_ = use_nesterov_;
   input_params.sparse_grad_ = unique_sparse_grad;
@@ -211,7 +201,7 @@ void SparseApplyAdamCpuKernelMod::LaunchKernel(const std::vector<kernel::Address
   input_params.var_ = var;
   input_params.lr_ = lr;
   input_params.epsilon_ = epsilon;
-  MultiThreadCompute<T>(ComputeWeight<T>, &input_params, total_dim_size);
+  MultiThreadCompute<T>(ComputeWeight<T>, &input_params, total_dim_size, kCacheLineFloatNum);
 }
 
 bool SparseApplyAdamCpuKernelMod::Launch(const std::vector<kernel::AddressPtr> &inputs,
@@ -17,6 +17,7 @@
 #include "plugin/device/cpu/kernel/sparse_apply_ftrl_cpu_kernel.h"
 #include "kernel/common_utils.h"
 #include "plugin/device/cpu/hal/device/cpu_device_address.h"
+#include "plugin/device/cpu/kernel/nnacl/fp32/sparse_optimizer_fp32.h"
 
 namespace mindspore {
 namespace kernel {
@@ -45,19 +46,18 @@ void ComputeFtrl(MultiThreadComputeParams<T> *input_params, size_t start, size_t
                         << SizeToLong(var_first_dim_size) << "), but got " << index;
     }
     size_t start_index = var_outer_dim_size * static_cast<size_t>(index);
+    if (lr_power == -0.5) {
+      (void)SparseFtrlFp32(var + start_index, accum + start_index, linear + start_index,
+                           unique_sparse_grad.value_ + var_outer_dim_size * i, lr, l1, l2_plus, var_outer_dim_size);
+      continue;
+    }
     size_t end_index = start_index + var_outer_dim_size;
     for (size_t j = start_index, k = var_outer_dim_size * i; j < end_index; ++j, ++k) {
       auto summed_grad = unique_sparse_grad.value_[k];
       auto accum_new = accum[j] + summed_grad * summed_grad;
-      float y;
       linear[j] += summed_grad;
-      if (lr_power == -0.5) {
-        y = std::sqrt(accum_new);
-        linear[j] -= ((y - std::sqrt(accum[j])) / lr) * var[j];
-      } else {
-        y = std::pow(accum_new, -lr_power);
-        linear[j] -= ((y - std::pow(accum[j], -lr_power)) / lr) * var[j];
-      }
+      float y = std::pow(accum_new, -lr_power);
+      linear[j] -= ((y - std::pow(accum[j], -lr_power)) / lr) * var[j];
       accum[j] = accum_new;
       auto x = Sign(linear[j]) * l1 - linear[j];
       y = y / lr + l2_plus;
@@ -17,6 +17,7 @@
 #include "plugin/device/cpu/kernel/sparse_apply_lazy_adam_cpu_kernel.h"
 #include "kernel/common_utils.h"
 #include "plugin/device/cpu/hal/device/cpu_device_address.h"
+#include "plugin/device/cpu/kernel/nnacl/fp32/sparse_optimizer_fp32.h"
 
 namespace mindspore {
 namespace kernel {
@@ -46,17 +47,9 @@ void ComputeLazyAdam(MultiThreadComputeParams<T> *input_params, size_t start, si
                         << SizeToLong(var_first_dim_size) << "), but got " << index;
     }
     size_t start_index = var_outer_dim_size * static_cast<size_t>(index);
-    size_t end_index = start_index + var_outer_dim_size;
-    for (size_t j = start_index, k = var_outer_dim_size * i; j < end_index; ++j, ++k) {
-      auto summed_grad = unique_sparse_grad.value_[k];
-      m[j] = beta1 * m[j] + (1 - beta1) * summed_grad;
-      v[j] = beta2 * v[j] + (1 - beta2) * summed_grad * summed_grad;
-      if (use_nesterov) {
-        var[j] -= lr * (m[j] * beta1 + (1 - beta1) * summed_grad) / (std::sqrt(v[j]) + epsilon);
-      } else {
-        var[j] -= lr * m[j] / (std::sqrt(v[j]) + epsilon);
-      }
-    }
+    (void)SparseLazyAdamFp32(var + start_index, m + start_index, v + start_index,
+                             unique_sparse_grad.value_ + var_outer_dim_size * i, lr, beta1, beta2, epsilon,
+                             var_outer_dim_size, use_nesterov);
   }
 }
 }  // namespace
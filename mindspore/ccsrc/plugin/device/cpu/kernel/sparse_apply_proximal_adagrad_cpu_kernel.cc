@@ -17,6 +17,7 @@
 #include "plugin/device/cpu/kernel/sparse_apply_proximal_adagrad_cpu_kernel.h"
 #include "kernel/common_utils.h"
 #include "plugin/device/cpu/hal/device/cpu_device_address.h"
+#include "plugin/device/cpu/kernel/nnacl/fp32/sparse_optimizer_fp32.h"
 
 namespace mindspore {
 namespace kernel {
@@ -54,20 +55,9 @@ void ComputeProximalAdagrad(MultiThreadComputeParams<T> *input_params, size_t st
                         << SizeToLong(var_first_dim_size) << "), but got " << index;
     }
     size_t start_index = var_outer_dim_size * static_cast<size_t>(index);
-    size_t end_index = start_index + var_outer_dim_size;
-    for (size_t j = start_index, k = var_outer_dim_size * i; j < end_index; ++j, ++k) {
-      auto summed_grad = unique_sparse_grad.value_[k];
-      accum[j] += summed_grad * summed_grad;
-      auto learning_rate = lr * (1 / std::sqrt(accum[j]));
-      auto prox_v = var[j];
-      prox_v -= summed_grad * learning_rate;
-      if (l1 > 0) {
-        var[j] = Sign(prox_v) * std::fmax(std::fabs(prox_v) - learning_rate * l1, static_cast<float>(0.0)) /
-                 (1 + l2 * learning_rate);
-      } else {
-        var[j] = prox_v / (1 + l2 * learning_rate);
-      }
-    }
+    (void)SparseProximalAdagradFp32(var + start_index, accum + start_index,
+                                    unique_sparse_grad.value_ + var_outer_dim_size * i, lr, l1, l2,
+                                    var_outer_dim_size);
   }
 }
 }  // namespace
@@ -17,12 +17,13 @@
 #ifndef MINDSPORE_CCSRC_BACKEND_KERNEL_COMPILER_CPU_SPARSE_OPTIMIZER_CPU_KERNEL_H_
 #define MINDSPORE_CCSRC_BACKEND_KERNEL_COMPILER_CPU_SPARSE_OPTIMIZER_CPU_KERNEL_H_
 
+#include <climits>
 #include <vector>
 #include <memory>
-#include <unordered_map>
 #include <algorithm>
 #include <utility>
 #include "plugin/device/cpu/kernel/cpu_kernel.h"
+#include "plugin/device/cpu/kernel/nnacl/fp32/add_fp32.h"
 #include "plugin/factory/ms_factory.h"
 #include "include/common/thread_pool.h"
 namespace mindspore {
@@ -41,7 +42,6 @@ struct ReduceSparseGradientParam {
   SparseGradient<T> *output_grad_{nullptr};
   size_t max_index_{0};
   size_t value_stride_{0};
-  bool use_sort_reduce_{false};
 };
 
 template <typename T>
@@ -74,6 +74,8 @@ struct BucketSparseGradient {
   T *indices_;
   T *global_indices_;
   size_t indices_size_;
+  size_t digit_begin_;
+  size_t digit_end_;
 };
 
 template <typename T>
@@ -84,9 +86,18 @@ struct MultiThreadReduceSparseGradientParam {
   size_t max_index_{0};
   size_t value_stride_{0};
   size_t thread_num_{0};
-  bool use_sort_reduce_{false};
+  size_t radix_shift_{0};
+  size_t radix_digit_num_{1};
 };
 
+// The duplicate indices are reduced by a radix sort: the high bits of an index (its digit) pick the bucket, and the
+// low bits are sorted inside the bucket. So every bucket holds a contiguous index range and comes out sorted.
+constexpr size_t kRadixDigitBits = 10;
+constexpr size_t kRadixSortPassBits = 8;
+constexpr size_t kRadixSortMinSize = 64;
+// The dense loops are cut on cache lines, so that no line is written by two threads.
+constexpr size_t kCacheLineFloatNum = 16;
+
 class SparseOptimizerCpuKernelMod : public DeprecatedNativeCpuKernelMod {
  public:
   SparseOptimizerCpuKernelMod() = default;
@@ -96,22 +107,33 @@ class SparseOptimizerCpuKernelMod : public DeprecatedNativeCpuKernelMod {
   static void BucketReduceSparseGradient(const ReduceSparseGradientParam<T> &param) {
     MS_LOG(DEBUG) << "Start";
     MS_EXCEPTION_IF_NULL(param.input_grad_);
+    MS_EXCEPTION_IF_NULL(param.output_grad_);
+    if (param.input_grad_->indices_size_ == 0 || param.max_index_ == 0) {
+      param.output_grad_->indices_size_ = 0;
+      return;
+    }
     size_t thread_num = common::ThreadPool::GetInstance().GetSyncRunThreadNum();
     if (param.input_grad_->indices_size_ < thread_num) {
       thread_num = param.input_grad_->indices_size_;
     }
+    size_t index_bits = 0;
+    while (index_bits < sizeof(size_t) * CHAR_BIT && ((param.max_index_ - 1) >> index_bits) != 0) {
+      ++index_bits;
+    }
+    size_t radix_shift = index_bits > kRadixDigitBits ? index_bits - kRadixDigitBits : 0;
     MultiThreadReduceSparseGradientParam<T> multi_thread_param(
       {param.input_grad_, param.workspace_grad_, param.output_grad_, param.max_index_, param.value_stride_, thread_num,
-       param.use_sort_reduce_});
+       radix_shift, ((param.max_index_ - 1) >> radix_shift) + 1});
     std::vector<std::shared_ptr<SparseGradient<T>>> segments;
-    std::vector<std::shared_ptr<std::vector<size_t>>> segment_bucket_sizes;
-    SplitAndCalculateSegmentBucketSize(multi_thread_param, &segments, &segment_bucket_sizes);
+    std::vector<std::shared_ptr<std::vector<size_t>>> segment_digit_sizes;
+    SplitAndCalculateSegmentDigitSize(multi_thread_param, &segments, &segment_digit_sizes);
 
     std::vector<std::shared_ptr<BucketSparseGradient<T>>> buckets;
-    GatherSegmentIndicesToOutputBucket(multi_thread_param, segments, segment_bucket_sizes, &buckets);
+    std::vector<size_t> digit_offsets;
+    GatherSegmentIndicesToOutputBucket(multi_thread_param, segments, segment_digit_sizes, &buckets, &digit_offsets);
 
     std::vector<std::shared_ptr<SparseGradient<T>>> reduced_buckets;
-    ReduceBucketSparseGradientToWorkspace(multi_thread_param, buckets, &reduced_buckets);
+    ReduceBucketSparseGradientToWorkspace(multi_thread_param, buckets, digit_offsets, &reduced_buckets);
 
     MergeReduceSparseGradient(multi_thread_param, reduced_buckets);
     MS_LOG(DEBUG) << "End";
@@ -120,12 +142,13 @@ class SparseOptimizerCpuKernelMod : public DeprecatedNativeCpuKernelMod {
  protected:
   template <typename T>
   void MultiThreadCompute(const MultiThreadComputeFunc<T> &func, MultiThreadComputeParams<T> *params,
-                          size_t total_compute_size) const {
+                          size_t total_compute_size, size_t align_size = 1) const {
     std::vector<common::Task> tasks;
     auto max_thread_num = common::ThreadPool::GetInstance().GetSyncRunThreadNum();
     tasks.reserve(max_thread_num);
     size_t start = 0;
     size_t once_compute_size = (total_compute_size + max_thread_num - 1) / max_thread_num;
+    once_compute_size = (once_compute_size + align_size - 1) / align_size * align_size;
     while (start < total_compute_size) {
       size_t end = (start + once_compute_size) > total_compute_size ? total_compute_size : (start + once_compute_size);
       auto task = [&func, &params, start, end]() {
@@ -140,35 +163,31 @@ class SparseOptimizerCpuKernelMod : public DeprecatedNativeCpuKernelMod {
 
  private:
   template <typename T>
-  static void CalculateEachBucketSize(const std::shared_ptr<SparseGradient<T>> &sparse_grad, size_t max_index,
-                                      std::vector<size_t> *each_bucket_size) {
+  static void CalculateEachDigitSize(const MultiThreadReduceSparseGradientParam<T> &param,
+                                     const std::shared_ptr<SparseGradient<T>> &sparse_grad,
+                                     std::vector<size_t> *each_digit_size) {
     MS_LOG(DEBUG) << "Start";
     MS_EXCEPTION_IF_NULL(sparse_grad);
     MS_EXCEPTION_IF_NULL(sparse_grad->indices_);
-    MS_EXCEPTION_IF_NULL(each_bucket_size);
-    size_t bucket_num = each_bucket_size->size();
-    if (bucket_num < 1) {
-      MS_LOG(EXCEPTION) << "For 'SparseOptimizer', the 'bucket_num' must be at least 1, but got " << bucket_num;
-    }
+    MS_EXCEPTION_IF_NULL(each_digit_size);
     for (size_t i = 0; i < sparse_grad->indices_size_; ++i) {
       T index = sparse_grad->indices_[i];
-      if (index >= 0 && LongToSize(index) < max_index) {
-        auto bucket_id = index % bucket_num;
-        each_bucket_size->at(bucket_id)++;
+      if (index >= 0 && LongToSize(index) < param.max_index_) {
+        (*each_digit_size)[LongToSize(index) >> param.radix_shift_]++;
       }
     }
     MS_LOG(DEBUG) << "End";
   }
 
   template <typename T>
-  static void SplitAndCalculateSegmentBucketSize(
+  static void SplitAndCalculateSegmentDigitSize(
     const MultiThreadReduceSparseGradientParam<T> &param, std::vector<std::shared_ptr<SparseGradient<T>>> *segments_ptr,
-    std::vector<std::shared_ptr<std::vector<size_t>>> *segment_bucket_sizes_ptr) {
+    std::vector<std::shared_ptr<std::vector<size_t>>> *segment_digit_sizes_ptr) {
     MS_EXCEPTION_IF_NULL(param.input_grad_);
-    MS_EXCEPTION_IF_NULL(segment_bucket_sizes_ptr);
+    MS_EXCEPTION_IF_NULL(segment_digit_sizes_ptr);
     MS_EXCEPTION_IF_NULL(segments_ptr);
     auto &segments = *segments_ptr;
-    auto &segment_bucket_sizes = *segment_bucket_sizes_ptr;
+    auto &segment_digit_sizes = *segment_digit_sizes_ptr;
     auto input_grad = param.input_grad_;
     if (param.thread_num_ < 1) {
       MS_EXCEPTION(ArgumentError) << "Input param thread num must > 0!";
@@ -181,7 +200,7 @@ class SparseOptimizerCpuKernelMod : public DeprecatedNativeCpuKernelMod {
 
     size_t current_indices_offset = 0;
     for (size_t i = 0; i < param.thread_num_; ++i) {
-      (void)segment_bucket_sizes.emplace_back(std::make_shared<std::vector<size_t>>(param.thread_num_, 0));
+      (void)segment_digit_sizes.emplace_back(std::make_shared<std::vector<size_t>>(param.radix_digit_num_, 0));
       size_t indices_size = thread_indices_size;
       if (i < left_indices_size) {
         indices_size += 1;
@@ -190,8 +209,8 @@ class SparseOptimizerCpuKernelMod : public DeprecatedNativeCpuKernelMod {
       segments[i]->value_ = input_grad->value_ + current_indices_offset * param.value_stride_;
       segments[i]->indices_ = input_grad->indices_ + current_indices_offset;
       segments[i]->indices_size_ = indices_size;
-      auto task = [&segments, &param, &segment_bucket_sizes, i]() {
-        CalculateEachBucketSize<T>(segments[i], param.max_index_, segment_bucket_sizes[i].get());
+      auto task = [&segments, &param, &segment_digit_sizes, i]() {
+        CalculateEachDigitSize<T>(param, segments[i], segment_digit_sizes[i].get());
         return common::SUCCESS;
       };
       (void)tasks.emplace_back(task);
@@ -202,23 +221,20 @@ class SparseOptimizerCpuKernelMod : public DeprecatedNativeCpuKernelMod {
 
   template <typename T>
   static void CopySegmentIndicesToBucket(const MultiThreadReduceSparseGradientParam<T> &param,
-                                         const std::shared_ptr<SparseGradient<T>> &segment, size_t bucket_offset,
-                                         const std::vector<std::shared_ptr<BucketSparseGradient<T>>> &buckets) {
+                                         const std::shared_ptr<SparseGradient<T>> &segment, size_t segment_offset,
+                                         std::vector<size_t> *digit_positions) {
     MS_LOG(DEBUG) << "Start";
     MS_EXCEPTION_IF_NULL(segment);
     MS_EXCEPTION_IF_NULL(segment->indices_);
-    if (param.thread_num_ == 0) {
-      MS_EXCEPTION(ArgumentError) << "Input param thread num must > 0!";
-    }
-    std::vector<size_t> bucket_data_num(param.thread_num_, 0);
+    MS_EXCEPTION_IF_NULL(digit_positions);
+    T *bucket_indices = param.output_grad_->indices_;
+    T *bucket_global_indices = param.workspace_grad_->indices_;
     for (size_t i = 0; i < segment->indices_size_; ++i) {
       T index = segment->indices_[i];
       if (index >= 0 && LongToSize(index) < param.max_index_) {
-        auto bucket_id = index % param.thread_num_;
-        auto bucket_index = bucket_data_num[bucket_id];
-        buckets[bucket_id]->indices_[bucket_index] = index;
-        buckets[bucket_id]->global_indices_[bucket_index] = bucket_offset + i;
-        bucket_data_num[bucket_id]++;
+        size_t position = (*digit_positions)[LongToSize(index) >> param.radix_shift_]++;
+        bucket_indices[position] = index;
+        bucket_global_indices[position] = static_cast<T>(segment_offset + i);
       }
     }
     MS_LOG(DEBUG) << "End";
@@ -228,52 +244,59 @@ class SparseOptimizerCpuKernelMod : public DeprecatedNativeCpuKernelMod {
   static void GatherSegmentIndicesToOutputBucket(
     const MultiThreadReduceSparseGradientParam<T> &param,
     const std::vector<std::shared_ptr<SparseGradient<T>>> &segments,
-    const std::vector<std::shared_ptr<std::vector<size_t>>> &segment_bucket_sizes,
-    std::vector<std::shared_ptr<BucketSparseGradient<T>>> *buckets_ptr) {
+    const std::vector<std::shared_ptr<std::vector<size_t>>> &segment_digit_sizes,
+    std::vector<std::shared_ptr<BucketSparseGradient<T>>> *buckets_ptr, std::vector<size_t> *digit_offsets_ptr) {
     MS_EXCEPTION_IF_NULL(param.output_grad_);
     MS_EXCEPTION_IF_NULL(param.output_grad_->value_);
     MS_EXCEPTION_IF_NULL(param.output_grad_->indices_);
+    MS_EXCEPTION_IF_NULL(param.workspace_grad_);
+    MS_EXCEPTION_IF_NULL(param.workspace_grad_->indices_);
     MS_EXCEPTION_IF_NULL(buckets_ptr);
+    MS_EXCEPTION_IF_NULL(digit_offsets_ptr);
     auto &buckets = *buckets_ptr;
+    auto &digit_offsets = *digit_offsets_ptr;
     size_t thread_num = param.thread_num_;
-    if (thread_num != segment_bucket_sizes.size()) {
+    size_t digit_num = param.radix_digit_num_;
+    if (thread_num != segment_digit_sizes.size()) {
       MS_EXCEPTION(ArgumentError) << "Input param thread num not equal to segment size!";
     }
-    std::vector<size_t> bucket_data_size(thread_num, 0);
-    for (size_t i = 0; i < thread_num; ++i) {
-      for (size_t j = 0; j < thread_num; ++j) {
-        bucket_data_size[j] += segment_bucket_sizes[i]->at(j);
+    // Lay the digits out one after another, and each segment after the segments before it inside every digit, so the
+    // scatter below is a stable counting sort on the digit.
+    digit_offsets.assign(digit_num + 1, 0);
+    std::vector<std::vector<size_t>> segment_digit_positions(thread_num, std::vector<size_t>(digit_num, 0));
+    for (size_t j = 0; j < digit_num; ++j) {
+      size_t position = digit_offsets[j];
+      for (size_t i = 0; i < thread_num; ++i) {
+        segment_digit_positions[i][j] = position;
+        position += segment_digit_sizes[i]->at(j);
       }
+      digit_offsets[j + 1] = position;
     }
-    size_t current_indices_offset = 0;
+    // Cut the digits into buckets of about the same size. A hot digit of a skewed input takes a whole bucket, and the
+    // buckets after it are left empty.
+    size_t total_indices_size = digit_offsets[digit_num];
+    size_t digit = 0;
     for (size_t i = 0; i < thread_num; ++i) {
-      (void)buckets.emplace_back(std::make_shared<BucketSparseGradient<T>>());
-      buckets[i]->value_ = param.output_grad_->value_ + current_indices_offset * param.value_stride_;
-      buckets[i]->indices_ = param.output_grad_->indices_ + current_indices_offset;
-      buckets[i]->global_indices_ = param.workspace_grad_->indices_ + current_indices_offset;
-      buckets[i]->indices_size_ = bucket_data_size[i];
-      current_indices_offset += bucket_data_size[i];
-    }
-    std::vector<size_t> tmp_bucket_data_size(thread_num, 0);
-    std::vector<std::vector<std::shared_ptr<BucketSparseGradient<T>>>> each_thread_buckets;
-    for (size_t i = 0; i < thread_num; ++i) {
-      std::vector<std::shared_ptr<BucketSparseGradient<T>>> thread_buckets;
-      for (size_t j = 0; j < thread_num; ++j) {
-        (void)thread_buckets.emplace_back(std::make_shared<BucketSparseGradient<T>>());
-        thread_buckets[j]->indices_ = buckets[j]->indices_ + tmp_bucket_data_size[j];
-        thread_buckets[j]->global_indices_ = buckets[j]->global_indices_ + tmp_bucket_data_size[j];
-        thread_buckets[j]->value_ = buckets[j]->value_ + tmp_bucket_data_size[j] * param.value_stride_;
-        thread_buckets[j]->indices_size_ = segment_bucket_sizes[i]->at(j);
-        tmp_bucket_data_size[j] += segment_bucket_sizes[i]->at(j);
+      size_t digit_begin = digit;
+      size_t bucket_end_offset = total_indices_size * (i + 1) / thread_num;
+      while (digit < digit_num && digit_offsets[digit + 1] <= bucket_end_offset) {
+        ++digit;
       }
-      (void)each_thread_buckets.emplace_back(thread_buckets);
+      size_t bucket_offset = digit_offsets[digit_begin];
+      (void)buckets.emplace_back(std::make_shared<BucketSparseGradient<T>>());
+      buckets[i]->value_ = param.output_grad_->value_ + bucket_offset * param.value_stride_;
+      buckets[i]->indices_ = param.output_grad_->indices_ + bucket_offset;
+      buckets[i]->global_indices_ = param.workspace_grad_->indices_ + bucket_offset;
+      buckets[i]->indices_size_ = digit_offsets[digit] - bucket_offset;
+      buckets[i]->digit_begin_ = digit_begin;
+      buckets[i]->digit_end_ = digit;
     }
     std::vector<common::Task> tasks;
     tasks.reserve(thread_num);
-    current_indices_offset = 0;
+    size_t current_indices_offset = 0;
     for (size_t i = 0; i < thread_num; ++i) {
-      auto task = [&param, &segments, &each_thread_buckets, i, current_indices_offset]() {
-        CopySegmentIndicesToBucket<T>(param, segments[i], current_indices_offset, each_thread_buckets[i]);
+      auto task = [&param, &segments, &segment_digit_positions, i, current_indices_offset]() {
+        CopySegmentIndicesToBucket<T>(param, segments[i], current_indices_offset, &segment_digit_positions[i]);
         return common::SUCCESS;
       };
       (void)tasks.emplace_back(task);
@@ -283,93 +306,93 @@ class SparseOptimizerCpuKernelMod : public DeprecatedNativeCpuKernelMod {
   }
 
   template <typename T>
-  static void SortAndReduceBucketSparseGradient(const MultiThreadReduceSparseGradientParam<T> &param,
-                                                const std::shared_ptr<BucketSparseGradient<T>> &bucket,
-                                                const std::shared_ptr<SparseGradient<T>> &reduced_bucket) {
-    MS_LOG(DEBUG) << "Start";
-    MS_EXCEPTION_IF_NULL(bucket);
-    MS_EXCEPTION_IF_NULL(bucket->value_);
-    MS_EXCEPTION_IF_NULL(bucket->indices_);
-    MS_EXCEPTION_IF_NULL(reduced_bucket);
-    MS_EXCEPTION_IF_NULL(reduced_bucket->value_);
-    MS_EXCEPTION_IF_NULL(reduced_bucket->indices_);
-    std::vector<std::pair<T, T>> sorted_indices;
-    sorted_indices.reserve(bucket->indices_size_);
-    for (size_t i = 0; i < bucket->indices_size_; ++i) {
-      T index = bucket->indices_[i];
-      T global_index = bucket->global_indices_[i];
-      (void)sorted_indices.emplace_back(std::pair<T, T>(index, global_index));
-    }
-    std::sort(sorted_indices.begin(), sorted_indices.end());
-
-    float *global_value = param.input_grad_->value_;
-    size_t unique_indices_size = 0;
-    size_t max_length = reduced_bucket->indices_size_ * param.value_stride_;
-    T last_index{0};
-    size_t value_offset{0};
-    for (size_t i = 0; i < sorted_indices.size(); ++i) {
-      T index = sorted_indices[i].first;
-      T global_index = sorted_indices[i].second;
-      T global_value_offset = global_index * param.value_stride_;
-      if (i == 0 || index != last_index) {
-        if (i != 0) {
-          unique_indices_size++;
-        }
-        reduced_bucket->indices_[unique_indices_size] = index;
-        value_offset = unique_indices_size * param.value_stride_;
-        auto ret_code = memcpy_s(reduced_bucket->value_ + value_offset, (max_length - value_offset) * sizeof(float),
-                                 global_value + global_value_offset, param.value_stride_ * sizeof(float));
-        if (ret_code != EOK) {
-          MS_LOG(EXCEPTION) << "For 'SparseOptimizer', failed to copy data. Error no: " << ret_code;
-        }
-      } else {
-        for (size_t j = 0; j < param.value_stride_; ++j) {
-          reduced_bucket->value_[value_offset + j] += global_value[global_value_offset + j];
+  static void RadixSortIndices(T *indices, T *global_indices, size_t indices_size, size_t sort_bits,
+                               std::vector<T> *indices_buffer, std::vector<T> *global_indices_buffer) {
+    MS_EXCEPTION_IF_NULL(indices_buffer);
+    MS_EXCEPTION_IF_NULL(global_indices_buffer);
+    if (indices_size < kRadixSortMinSize) {
+      for (size_t i = 1; i < indices_size; ++i) {
+        T index = indices[i];
+        T global_index = global_indices[i];
+        size_t j = i;
+        for (; j > 0 && indices[j - 1] > index; --j) {
+          indices[j] = indices[j - 1];
+          global_indices[j] = global_indices[j - 1];
         }
+        indices[j] = index;
+        global_indices[j] = global_index;
       }
-      last_index = index;
+      return;
+    }
+    indices_buffer->resize(indices_size);
+    global_indices_buffer->resize(indices_size);
+    for (size_t shift = 0; shift < sort_bits; shift += kRadixSortPassBits) {
+      size_t mask = (size_t(1) << std::min(kRadixSortPassBits, sort_bits - shift)) - 1;
+      std::vector<size_t> positions((size_t(1) << kRadixSortPassBits) + 1, 0);
+      for (size_t i = 0; i < indices_size; ++i) {
+        positions[((LongToSize(indices[i]) >> shift) & mask) + 1]++;
+      }
+      // All the indices share this byte, which is common for the hot ids of a skewed input.
+      if (std::find(positions.begin(), positions.end(), indices_size) != positions.end()) {
+        continue;
+      }
+      for (size_t j = 1; j < positions.size(); ++j) {
+        positions[j] += positions[j - 1];
+      }
+      for (size_t i = 0; i < indices_size; ++i) {
+        size_t position = positions[(LongToSize(indices[i]) >> shift) & mask]++;
+        (*indices_buffer)[position] = indices[i];
+        (*global_indices_buffer)[position] = global_indices[i];
+      }
+      (void)std::copy(indices_buffer->begin(), indices_buffer->end(), indices);
+      (void)std::copy(global_indices_buffer->begin(), global_indices_buffer->end(), global_indices);
     }
-    reduced_bucket->indices_size_ = unique_indices_size;
-    MS_LOG(DEBUG) << "End";
   }
 
   template <typename T>
-  static void ReduceBucketSparseGradient(const MultiThreadReduceSparseGradientParam<T> &param,
-                                         const std::shared_ptr<BucketSparseGradient<T>> &bucket,
-                                         const std::shared_ptr<SparseGradient<T>> &reduced_bucket) {
+  static void SortAndReduceBucketSparseGradient(const MultiThreadReduceSparseGradientParam<T> &param,
+                                                const std::shared_ptr<BucketSparseGradient<T>> &bucket,
+                                                const std::vector<size_t> &digit_offsets,
+                                                const std::shared_ptr<SparseGradient<T>> &reduced_bucket) {
     MS_LOG(DEBUG) << "Start";
     MS_EXCEPTION_IF_NULL(bucket);
-    MS_EXCEPTION_IF_NULL(bucket->value_);
     MS_EXCEPTION_IF_NULL(bucket->indices_);
+    MS_EXCEPTION_IF_NULL(bucket->global_indices_);
     MS_EXCEPTION_IF_NULL(reduced_bucket);
     MS_EXCEPTION_IF_NULL(reduced_bucket->value_);
     MS_EXCEPTION_IF_NULL(reduced_bucket->indices_);
+    if (param.radix_shift_ > 0) {
+      std::vector<T> indices_buffer;
+      std::vector<T> global_indices_buffer;
+      size_t bucket_offset = digit_offsets[bucket->digit_begin_];
+      for (size_t digit = bucket->digit_begin_; digit < bucket->digit_end_; ++digit) {
+        size_t digit_offset = digit_offsets[digit] - bucket_offset;
+        RadixSortIndices<T>(bucket->indices_ + digit_offset, bucket->global_indices_ + digit_offset,
+                            digit_offsets[digit + 1] - digit_offsets[digit], param.radix_shift_, &indices_buffer,
+                            &global_indices_buffer);
+      }
+    }
 
+    // The reduced indices overwrite the global indices of the bucket, never ahead of the one being read.
     float *global_value = param.input_grad_->value_;
-    std::unordered_map<T, size_t> index_map;
     size_t unique_indices_size = 0;
     size_t max_length = reduced_bucket->indices_size_ * param.value_stride_;
+    float *reduced_value = nullptr;
     for (size_t i = 0; i < bucket->indices_size_; ++i) {
       T index = bucket->indices_[i];
-      T global_index = bucket->global_indices_[i];
-      auto iter = index_map.find(index);
-      if (iter == index_map.end()) {
+      float *value = global_value + LongToSize(bucket->global_indices_[i]) * param.value_stride_;
+      if (i == 0 || index != bucket->indices_[i - 1]) {
         reduced_bucket->indices_[unique_indices_size] = index;
-        size_t start_index = unique_indices_size * param.value_stride_;
-        index_map[index] = start_index;
-        auto ret_code =
-          memcpy_s(reduced_bucket->value_ + start_index, (max_length - start_index) * sizeof(float),
-                   global_value + global_index * param.value_stride_, param.value_stride_ * sizeof(float));
+        size_t value_offset = unique_indices_size * param.value_stride_;
+        reduced_value = reduced_bucket->value_ + value_offset;
+        auto ret_code = memcpy_s(reduced_value, (max_length - value_offset) * sizeof(float), value,
+                                 param.value_stride_ * sizeof(float));
         if (ret_code != EOK) {
           MS_LOG(EXCEPTION) << "For 'SparseOptimizer', failed to copy data. Error no: " << ret_code;
         }
         unique_indices_size++;
       } else {
-        size_t start_index = iter->second;
-        size_t end_index = start_index + param.value_stride_;
-        for (size_t j = start_index, k = global_index * param.value_stride_; j < end_index; ++j, ++k) {
-          reduced_bucket->value_[j] += global_value[k];
-        }
+        (void)ElementAdd(reduced_value, value, reduced_value, SizeToInt(param.value_stride_));
       }
     }
     reduced_bucket->indices_size_ = unique_indices_size;
@@ -379,7 +402,7 @@ class SparseOptimizerCpuKernelMod : public DeprecatedNativeCpuKernelMod {
   template <typename T>
   static void ReduceBucketSparseGradientToWorkspace(
     const MultiThreadReduceSparseGradientParam<T> &param,
-    const std::vector<std::shared_ptr<BucketSparseGradient<T>>> &buckets,
+    const std::vector<std::shared_ptr<BucketSparseGradient<T>>> &buckets, const std::vector<size_t> &digit_offsets,
     std::vector<std::shared_ptr<SparseGradient<T>>> *reduced_buckets_ptr) {
     MS_EXCEPTION_IF_NULL(param.workspace_grad_);
     MS_EXCEPTION_IF_NULL(param.workspace_grad_->value_);
@@ -396,15 +419,13 @@ class SparseOptimizerCpuKernelMod : public DeprecatedNativeCpuKernelMod {
       reduced_buckets[i]->value_ = param.workspace_grad_->value_ + current_indices_offset * param.value_stride_;
       reduced_buckets[i]->indices_ = param.workspace_grad_->indices_ + current_indices_offset;
       reduced_buckets[i]->indices_size_ = buckets[i]->indices_size_;
-      auto task = [&param, &buckets, &reduced_buckets, i]() {
-        if (param.use_sort_reduce_) {
-          SortAndReduceBucketSparseGradient<T>(param, buckets[i], reduced_buckets[i]);
-        } else {
-          ReduceBucketSparseGradient<T>(param, buckets[i], reduced_buckets[i]);
-        }
-        return common::SUCCESS;
-      };
-      (void)tasks.emplace_back(task);
+      if (buckets[i]->indices_size_ > 0) {
+        auto task = [&param, &buckets, &digit_offsets, &reduced_buckets, i]() {
+          SortAndReduceBucketSparseGradient<T>(param, buckets[i], digit_offsets, reduced_buckets[i]);
+          return common::SUCCESS;
+        };
+        (void)tasks.emplace_back(task);
+      }
       current_indices_offset += buckets[i]->indices_size_;
     }
     ParallelLaunch(tasks);
@@ -419,26 +440,33 @@ class SparseOptimizerCpuKernelMod : public DeprecatedNativeCpuKernelMod {
     MS_EXCEPTION_IF_NULL(output_grad->indices_);
     size_t stride_data_size = param.value_stride_ * sizeof(float);
     size_t unique_indices_size = 0;
+    std::vector<common::Task> tasks;
+    tasks.reserve(reduced_buckets.size());
     for (size_t i = 0; i < reduced_buckets.size(); ++i) {
       auto &bucket = reduced_buckets[i];
       MS_EXCEPTION_IF_NULL(bucket);
       if (bucket->indices_size_ == 0) {
         continue;
       }
-      auto ret_code = memcpy_s(output_grad->value_ + unique_indices_size * param.value_stride_,
-                               (output_grad->indices_size_ - unique_indices_size) * stride_data_size, bucket->value_,
-                               bucket->indices_size_ * stride_data_size);
-      if (ret_code != EOK) {
-        MS_LOG(EXCEPTION) << "For 'SparseOptimizer', failed to copy data. Error no: " << ret_code;
-      }
-      ret_code = memcpy_s(output_grad->indices_ + unique_indices_size,
-                          (output_grad->indices_size_ - unique_indices_size) * sizeof(T), bucket->indices_,
-                          bucket->indices_size_ * sizeof(T));
-      if (ret_code != EOK) {
-        MS_LOG(EXCEPTION) << "For 'SparseOptimizer', failed to copy data. Error no: " << ret_code;
-      }
+      auto task = [&param, &bucket, output_grad, stride_data_size, unique_indices_size]() {
+        auto ret_code = memcpy_s(output_grad->value_ + unique_indices_size * param.value_stride_,
+                                 (output_grad->indices_size_ - unique_indices_size) * stride_data_size, bucket->value_,
+                                 bucket->indices_size_ * stride_data_size);
+        if (ret_code != EOK) {
+          MS_LOG(EXCEPTION) << "For 'SparseOptimizer', failed to copy data. Error no: " << ret_code;
+        }
+        ret_code = memcpy_s(output_grad->indices_ + unique_indices_size,
+                            (output_grad->indices_size_ - unique_indices_size) * sizeof(T), bucket->indices_,
+                            bucket->indices_size_ * sizeof(T));
+        if (ret_code != EOK) {
+          MS_LOG(EXCEPTION) << "For 'SparseOptimizer', failed to copy data. Error no: " << ret_code;
+        }
+        return common::SUCCESS;
+      };
+      (void)tasks.emplace_back(task);
       unique_indices_size += bucket->indices_size_;
     }
+    ParallelLaunch(tasks);
     output_grad->indices_size_ = unique_indices_size;
   }
 
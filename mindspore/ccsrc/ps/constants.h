@@ -39,6 +39,7 @@ constexpr char kEnvSchedulerHost[] = "MS_SCHED_HOST";
 constexpr char kEnvSchedulerPort[] = "MS_SCHED_PORT";
 constexpr char kEnvSchedulerManagePort[] = "MS_SCHED_MANAGE_PORT";
 constexpr char kEnvNodeId[] = "MS_NODE_ID";
+constexpr char kEnvPsCacheSwapStepNum[] = "MS_PS_CACHE_SWAP_STEP_NUM";
 
 constexpr char kCommTypeOfIBVerbs[] = "ibverbs";
 constexpr char kRoleOfPServer[] = "server";
@@ -78,6 +79,8 @@ constexpr int64_t kUpdateEmbeddingsCmd = 21;
 constexpr int64_t kCheckReadyForPushCmd = 25;
 constexpr int64_t kCheckReadyForPullCmd = 26;
 constexpr int64_t kEmbeddingLookupCmd = 30;
+constexpr int64_t kMigrateEmbeddingCmd = 31;
+constexpr int64_t kMigrateEmbeddingRowsCmd = 32;
 constexpr int64_t kFinalizeCmd = 40;
 constexpr int64_t kPushCmd = 50;
 constexpr int64_t kPullCmd = 51;
@@ -100,6 +103,13 @@ constexpr int64_t kSubmitTimeOutInMs = 30000;
 constexpr int64_t kRetryCount = 60;
 constexpr int64_t kRetryIntervalInMs = 10;
 
+// The workers switch to the new placement of an embedding table this number of steps after the commit, so the commit
+// reaches all the workers before they push the step.
+constexpr uint64_t kEmbeddingSwitchStepLag = 3;
+constexpr int64_t kEmbeddingMigrateIntervalInMs = 100;
+// The migrated rows are sent by chunks of this size.
+constexpr size_t kEmbeddingMigrateChunkSize = 16 * (size_t(1) << 20);
+
 constexpr int64_t kThreadNum = 32;
 constexpr int64_t kGradIndex = 0;
 constexpr int64_t kIndiceIndex = 1;
@@ -1250,7 +1250,8 @@ void AbstractNode::ProcessCollectiveSendData(const std::shared_ptr<TcpConnection
   MS_EXCEPTION_IF_NULL(conn);
   MS_EXCEPTION_IF_NULL(meta);
   MS_EXCEPTION_IF_NULL(data);
-  if (!server_->SendMessage(conn, meta, Protos::RAW, data, size)) {
+  // The response only acknowledges the arrival, echoing the data back would take the same bandwidth as the sending.
+  if (!server_->SendMessage(conn, meta, Protos::RAW, data, 0)) {
     MS_LOG(WARNING) << "Server response message failed.";
   }
   RunReceiveCallback(meta, protos, data, size);
@@ -0,0 +1,133 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ps/embedding_shard_ring.h"
+#include <algorithm>
+
+namespace mindspore {
+namespace ps {
+namespace {
+constexpr uint32_t kRankShift = 32;
+}  // namespace
+
+uint64_t EmbeddingShardRing::Mix64(uint64_t value) {
+  // The finalizer of splitmix64.
+  value += 0x9E3779B97F4A7C15ULL;
+  value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+  return value ^ (value >> 31);
+}
+
+void EmbeddingShardRing::Insert(uint32_t rank) {
+  for (uint32_t i = 0; i < virtual_node_num_; i++) {
+    uint64_t position = Mix64((static_cast<uint64_t>(rank) << kRankShift) | i);
+    if (ring_.count(position) != 0) {
+      MS_LOG(WARNING) << "Virtual node " << i << " of server " << rank << " is already mapped to the ring.";
+      continue;
+    }
+    ring_[position] = rank;
+  }
+}
+
+void EmbeddingShardRing::Erase(uint32_t rank) {
+  for (auto iterator = ring_.begin(); iterator != ring_.end();) {
+    if (iterator->second == rank) {
+      (void)ring_.erase(iterator++);
+    } else {
+      ++iterator;
+    }
+  }
+}
+
+uint32_t EmbeddingShardRing::Find(uint64_t hash_value) const {
+  if (ring_.empty()) {
+    MS_LOG(EXCEPTION) << "The embedding shard ring is empty.";
+  }
+  auto iterator = ring_.lower_bound(hash_value);
+  if (iterator == ring_.end()) {
+    iterator = ring_.begin();
+  }
+  return iterator->second;
+}
+
+EmbeddingShardMap::EmbeddingShardMap(size_t row_count, const std::vector<uint32_t> &server_ranks, uint64_t version)
+    : row_count_(row_count), bucket_rows_(BucketRows(row_count)), server_ranks_(server_ranks), version_(version) {
+  std::sort(server_ranks_.begin(), server_ranks_.end());
+  server_ranks_.erase(std::unique(server_ranks_.begin(), server_ranks_.end()), server_ranks_.end());
+  if (row_count_ == 0 || server_ranks_.empty()) {
+    MS_LOG(EXCEPTION) << "The embedding table of " << row_count_ << " rows can't be placed on "
+                      << server_ranks_.size() << " servers.";
+  }
+  EmbeddingShardRing ring;
+  for (uint32_t rank : server_ranks_) {
+    ring.Insert(rank);
+  }
+  size_t bucket_num = (row_count_ + bucket_rows_ - 1) / bucket_rows_;
+  owners_.resize(bucket_num);
+  for (size_t bucket = 0; bucket < bucket_num; bucket++) {
+    owners_[bucket] = ring.Find(EmbeddingShardRing::Mix64(bucket));
+  }
+}
+
+size_t EmbeddingShardMap::BucketRowNum(size_t bucket) const {
+  size_t begin = bucket * bucket_rows_;
+  return begin >= row_count_ ? 0 : std::min(bucket_rows_, row_count_ - begin);
+}
+
+std::vector<size_t> EmbeddingShardMap::OwnedBuckets(uint32_t rank) const {
+  std::vector<size_t> buckets;
+  for (size_t bucket = 0; bucket < owners_.size(); bucket++) {
+    if (owners_[bucket] == rank) {
+      buckets.push_back(bucket);
+    }
+  }
+  return buckets;
+}
+
+bool EmbeddingShardMap::SamePlacement(const std::vector<uint32_t> &server_ranks) const {
+  std::vector<uint32_t> ranks = server_ranks;
+  std::sort(ranks.begin(), ranks.end());
+  ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+  return ranks == server_ranks_;
+}
+
+size_t EmbeddingShardMap::BucketRows(size_t row_count) {
+  return std::max<size_t>(1, (row_count + kMaxEmbeddingBucketNum - 1) / kMaxEmbeddingBucketNum);
+}
+
+size_t EmbeddingShardMap::LocalSlotNum(size_t row_count, size_t server_num) {
+  if (row_count == 0 || server_num == 0) {
+    return 0;
+  }
+  std::vector<uint32_t> ranks(server_num);
+  for (size_t i = 0; i < server_num; i++) {
+    ranks[i] = static_cast<uint32_t>(i);
+  }
+  EmbeddingShardMap shard_map(row_count, ranks, 0);
+  size_t bucket_num = shard_map.bucket_num();
+  size_t max_owned = 0;
+  for (uint32_t rank : ranks) {
+    max_owned = std::max(max_owned, shard_map.OwnedBuckets(rank).size());
+  }
+  size_t capacity = (kEmbeddingSlotCapacityFactor * bucket_num + server_num - 1) / server_num;
+  return std::min(bucket_num, std::max(max_owned, capacity));
+}
+
+size_t EmbeddingShardMap::LocalRowCapacity(size_t row_count, size_t server_num) {
+  return LocalSlotNum(row_count, server_num) * BucketRows(row_count);
+}
+}  // namespace ps
+}  // namespace mindspore
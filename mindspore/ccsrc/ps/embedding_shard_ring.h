@@ -0,0 +1,101 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_PS_EMBEDDING_SHARD_RING_H_
+#define MINDSPORE_CCSRC_PS_EMBEDDING_SHARD_RING_H_
+
+#include <map>
+#include <vector>
+#include "utils/log_adapter.h"
+#include "include/backend/visible.h"
+
+namespace mindspore {
+namespace ps {
+// The virtual nodes of each server on the ring, which keep the buckets of a server within about 10% of the even share.
+constexpr uint32_t kEmbeddingVirtualNodeNum = 128;
+// The rows of an embedding table are hashed by buckets of consecutive rows, so the placement is a small table and the
+// rows of a bucket are migrated together.
+constexpr size_t kMaxEmbeddingBucketNum = 4096;
+// The local table of a server holds up to this times its even share of the buckets, which bounds how many servers an
+// embedding table can be drained to.
+constexpr size_t kEmbeddingSlotCapacityFactor = 2;
+
+// The consistent hash ring of the parameter servers, see also fl::server::ConsistentHashRing. The positions of the
+// virtual nodes are computed by a fixed mixing function, so the workers and the servers build the same ring.
+class BACKEND_EXPORT EmbeddingShardRing {
+ public:
+  explicit EmbeddingShardRing(uint32_t virtual_node_num = kEmbeddingVirtualNodeNum)
+      : virtual_node_num_(virtual_node_num) {}
+  ~EmbeddingShardRing() = default;
+
+  // Insert the virtual nodes of a server according to its rank id.
+  void Insert(uint32_t rank);
+
+  // Remove the virtual nodes of a server.
+  void Erase(uint32_t rank);
+
+  // Find the rank of the first virtual node clockwise from the hash value.
+  uint32_t Find(uint64_t hash_value) const;
+
+  bool empty() const { return ring_.empty(); }
+
+  static uint64_t Mix64(uint64_t value);
+
+ private:
+  uint32_t virtual_node_num_;
+  // Key is the position of the virtual node, value is the rank of the server.
+  std::map<uint64_t, uint32_t> ring_;
+};
+
+// The placement of the rows of an embedding table on a set of servers. Row 'id' belongs to bucket id / bucket_rows, and
+// each bucket is placed on the ring independently of the table, so adding or removing a server only moves the buckets
+// of the ring arcs it takes or gives back.
+class BACKEND_EXPORT EmbeddingShardMap {
+ public:
+  EmbeddingShardMap(size_t row_count, const std::vector<uint32_t> &server_ranks, uint64_t version);
+  ~EmbeddingShardMap() = default;
+
+  uint64_t version() const { return version_; }
+  size_t row_count() const { return row_count_; }
+  size_t bucket_rows() const { return bucket_rows_; }
+  size_t bucket_num() const { return owners_.size(); }
+  const std::vector<uint32_t> &server_ranks() const { return server_ranks_; }
+
+  size_t BucketOf(size_t id) const { return id / bucket_rows_; }
+  uint32_t BucketOwner(size_t bucket) const { return owners_[bucket]; }
+  uint32_t OwnerOf(size_t id) const { return owners_[id / bucket_rows_]; }
+  // The last bucket may have less rows.
+  size_t BucketRowNum(size_t bucket) const;
+  // The buckets of a server in ascending order, which is also the order of its initial local rows.
+  std::vector<size_t> OwnedBuckets(uint32_t rank) const;
+  bool SamePlacement(const std::vector<uint32_t> &server_ranks) const;
+
+  static size_t BucketRows(size_t row_count);
+  // The number of the buckets the local table of each server could hold when the table is spread on 'server_num'
+  // servers at first.
+  static size_t LocalSlotNum(size_t row_count, size_t server_num);
+  static size_t LocalRowCapacity(size_t row_count, size_t server_num);
+
+ private:
+  size_t row_count_;
+  size_t bucket_rows_;
+  std::vector<uint32_t> server_ranks_;
+  uint64_t version_;
+  std::vector<uint32_t> owners_;
+};
+}  // namespace ps
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_PS_EMBEDDING_SHARD_RING_H_
@@ -0,0 +1,385 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ps/embedding_shard_table.h"
+#include <algorithm>
+
+namespace mindspore {
+namespace ps {
+EmbeddingShardTable::EmbeddingShardTable(size_t row_count, size_t server_num, uint32_t rank_id)
+    : row_count_(row_count), bucket_rows_(EmbeddingShardMap::BucketRows(row_count)), rank_id_(rank_id) {
+  std::vector<uint32_t> server_ranks(server_num);
+  for (size_t i = 0; i < server_num; i++) {
+    server_ranks[i] = static_cast<uint32_t>(i);
+  }
+  shard_map_ = std::make_shared<EmbeddingShardMap>(row_count, server_ranks, 0);
+  bucket_slots_.resize(shard_map_->bucket_num(), -1);
+  slot_buckets_.resize(EmbeddingShardMap::LocalSlotNum(row_count, server_num), -1);
+
+  // The owned buckets take the first slots in ascending order, which is the order the workers send the initial rows.
+  std::vector<size_t> owned_buckets = shard_map_->OwnedBuckets(rank_id_);
+  if (owned_buckets.size() > slot_buckets_.size()) {
+    MS_LOG(EXCEPTION) << "Server " << rank_id_ << " owns " << owned_buckets.size() << " buckets but only has "
+                      << slot_buckets_.size() << " slots.";
+  }
+  for (size_t slot = 0; slot < owned_buckets.size(); slot++) {
+    bucket_slots_[owned_buckets[slot]] = static_cast<int64_t>(slot);
+    slot_buckets_[slot] = static_cast<int64_t>(owned_buckets[slot]);
+  }
+  // The free slots are taken from the back.
+  for (size_t slot = slot_buckets_.size(); slot > owned_buckets.size(); slot--) {
+    free_slots_.push_back(slot - 1);
+  }
+}
+
+size_t EmbeddingShardTable::BucketRowNum(size_t bucket) const { return shard_map_->BucketRowNum(bucket); }
+
+void EmbeddingShardTable::GetPlacement(uint64_t *version, std::vector<uint32_t> *server_ranks,
+                                       uint64_t *switch_step) const {
+  MS_EXCEPTION_IF_NULL(version);
+  MS_EXCEPTION_IF_NULL(server_ranks);
+  MS_EXCEPTION_IF_NULL(switch_step);
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto &shard_map = state_ == EmbeddingMigrationState::kCommitted ? target_map_ : shard_map_;
+  *version = shard_map->version();
+  *server_ranks = shard_map->server_ranks();
+  *switch_step = switch_step_;
+}
+
+bool EmbeddingShardTable::ToLocalRows(const int *ids, size_t num, bool accept_incoming, int *rows) const {
+  MS_EXCEPTION_IF_NULL(ids);
+  MS_EXCEPTION_IF_NULL(rows);
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < num; i++) {
+    int id = ids[i];
+    rows[i] = -1;
+    if (id < 0 || static_cast<size_t>(id) >= row_count_) {
+      continue;
+    }
+    size_t bucket = static_cast<size_t>(id) / bucket_rows_;
+    int64_t slot = bucket_slots_[bucket];
+    if (slot < 0) {
+      continue;
+    }
+    if (!accept_incoming && migrating_ && incoming_.count(bucket) > 0) {
+      return false;
+    }
+    rows[i] = static_cast<int>(static_cast<size_t>(slot) * bucket_rows_ + static_cast<size_t>(id) % bucket_rows_);
+  }
+  return true;
+}
+
+int64_t EmbeddingShardTable::SlotOf(size_t bucket) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bucket < bucket_slots_.size() ? bucket_slots_[bucket] : -1;
+}
+
+std::vector<std::pair<size_t, size_t>> EmbeddingShardTable::OwnedBuckets() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::pair<size_t, size_t>> buckets;
+  for (size_t bucket = 0; bucket < bucket_slots_.size(); bucket++) {
+    if (bucket_slots_[bucket] >= 0 && incoming_.count(bucket) == 0) {
+      (void)buckets.emplace_back(bucket, static_cast<size_t>(bucket_slots_[bucket]));
+    }
+  }
+  return buckets;
+}
+
+EmbeddingMigrationState EmbeddingShardTable::state() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return state_;
+}
+
+EmbeddingMigrationState EmbeddingShardTable::Prepare(const std::vector<uint32_t> &server_ranks, uint64_t version) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (state_ != EmbeddingMigrationState::kIdle) {
+    // The prepare may be sent again by the worker.
+    bool same_migration = target_map_ != nullptr && target_map_->version() == version;
+    return same_migration ? state_ : EmbeddingMigrationState::kFailed;
+  }
+  if (version <= shard_map_->version()) {
+    MS_LOG(WARNING) << "The migration version " << version << " is not newer than " << shard_map_->version();
+    return EmbeddingMigrationState::kFailed;
+  }
+  auto target_map = std::make_shared<EmbeddingShardMap>(row_count_, server_ranks, version);
+  std::vector<size_t> incoming;
+  for (size_t bucket = 0; bucket < bucket_slots_.size(); bucket++) {
+    bool owned = bucket_slots_[bucket] >= 0;
+    uint32_t owner = target_map->BucketOwner(bucket);
+    if (owned && owner != rank_id_) {
+      outgoing_[bucket] = {owner, false, false};
+    } else if (!owned && owner == rank_id_) {
+      incoming.push_back(bucket);
+    }
+  }
+  if (incoming.size() > free_slots_.size()) {
+    MS_LOG(WARNING) << "Server " << rank_id_ << " can't take " << incoming.size() << " more buckets, only "
+                    << free_slots_.size() << " slots are free. The embedding table can't be placed on "
+                    << server_ranks.size() << " servers.";
+    outgoing_.clear();
+    return EmbeddingMigrationState::kFailed;
+  }
+  for (size_t bucket : incoming) {
+    size_t slot = free_slots_.back();
+    free_slots_.pop_back();
+    bucket_slots_[bucket] = static_cast<int64_t>(slot);
+    slot_buckets_[slot] = static_cast<int64_t>(bucket);
+    (void)incoming_.insert(bucket);
+  }
+  MS_LOG(INFO) << "Prepare the migration to version " << version << ", server " << rank_id_ << " sends "
+               << outgoing_.size() << " buckets and receives " << incoming_.size() << " buckets.";
+  target_map_ = target_map;
+  copy_cursor_ = 0;
+  copy_rounds_ = 0;
+  dirty_num_ = 0;
+  handoff_started_ = false;
+  state_ = EmbeddingMigrationState::kCopying;
+  migrating_ = true;
+  CheckConverged();
+  return state_;
+}
+
+EmbeddingMigrationState EmbeddingShardTable::Precommit(uint64_t version, uint64_t switch_step,
+                                                       uint64_t current_step) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (target_map_ == nullptr || target_map_->version() != version) {
+    MS_LOG(WARNING) << "The migration to version " << version << " is not prepared on server " << rank_id_;
+    return EmbeddingMigrationState::kFailed;
+  }
+  // The precommit may be sent again by the worker.
+  if (state_ == EmbeddingMigrationState::kPrecommitted || state_ == EmbeddingMigrationState::kCommitted) {
+    return precommit_switch_step_ == switch_step ? state_ : EmbeddingMigrationState::kFailed;
+  }
+  // The workers may run one step ahead of the update of the servers.
+  if (state_ != EmbeddingMigrationState::kConverged || switch_step <= current_step + 1) {
+    MS_LOG(WARNING) << "The migration to version " << version << " can't switch at step " << switch_step
+                    << ", the current step is " << current_step;
+    return EmbeddingMigrationState::kFailed;
+  }
+  precommit_switch_step_ = switch_step;
+  state_ = EmbeddingMigrationState::kPrecommitted;
+  return state_;
+}
+
+EmbeddingMigrationState EmbeddingShardTable::Commit(uint64_t version, uint64_t switch_step) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (target_map_ == nullptr || target_map_->version() != version) {
+    // The commit may be sent again after the migration without moved buckets has completed.
+    bool completed = target_map_ == nullptr && shard_map_->version() == version && switch_step_ == switch_step;
+    return completed ? EmbeddingMigrationState::kCommitted : EmbeddingMigrationState::kFailed;
+  }
+  if (state_ == EmbeddingMigrationState::kCommitted) {
+    return switch_step_ == switch_step ? state_ : EmbeddingMigrationState::kFailed;
+  }
+  if (state_ != EmbeddingMigrationState::kPrecommitted || precommit_switch_step_ != switch_step) {
+    MS_LOG(WARNING) << "The migration to version " << version << " is not precommitted at step " << switch_step;
+    return EmbeddingMigrationState::kFailed;
+  }
+  switch_step_ = switch_step;
+  state_ = EmbeddingMigrationState::kCommitted;
+  CompleteIfDone();
+  return EmbeddingMigrationState::kCommitted;
+}
+
+bool EmbeddingShardTable::Abort(uint64_t version) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (state_ == EmbeddingMigrationState::kIdle) {
+    return true;
+  }
+  if (state_ == EmbeddingMigrationState::kCommitted || target_map_->version() != version) {
+    MS_LOG(WARNING) << "The migration to version " << target_map_->version() << " can't be aborted by " << version;
+    return false;
+  }
+  for (size_t bucket : incoming_) {
+    auto slot = static_cast<size_t>(bucket_slots_[bucket]);
+    bucket_slots_[bucket] = -1;
+    slot_buckets_[slot] = -1;
+    free_slots_.push_back(slot);
+  }
+  ResetMigration();
+  return true;
+}
+
+bool EmbeddingShardTable::WaitingDecision(uint64_t step) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // After the update of 'step', the switch step must still be ahead of the current step plus one.
+  return state_ == EmbeddingMigrationState::kPrecommitted && step + 2 >= precommit_switch_step_;
+}
+
+std::vector<EmbeddingBucketMove> EmbeddingShardTable::NextCopyBuckets(size_t max_num) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<EmbeddingBucketMove> moves;
+  if (!migrating_ || handoff_started_ || outgoing_.empty()) {
+    return moves;
+  }
+  auto iter = outgoing_.lower_bound(copy_cursor_);
+  for (size_t visited = 0; visited < outgoing_.size() && moves.size() < max_num; visited++, ++iter) {
+    if (iter == outgoing_.end()) {
+      iter = outgoing_.begin();
+      copy_rounds_++;
+    }
+    OutgoingBucket &outgoing = iter->second;
+    if (outgoing.copied && !outgoing.dirty) {
+      continue;
+    }
+    if (outgoing.dirty) {
+      dirty_num_--;
+    }
+    outgoing.copied = true;
+    outgoing.dirty = false;
+    moves.push_back({iter->first, outgoing.dest, true});
+    copy_cursor_ = iter->first + 1;
+  }
+  if (moves.empty()) {
+    copy_rounds_++;
+  }
+  CheckConverged();
+  return moves;
+}
+
+void EmbeddingShardTable::MarkDirtyRows(const int *rows, size_t num) {
+  if (!migrating_) {
+    return;
+  }
+  MS_EXCEPTION_IF_NULL(rows);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (handoff_started_ || outgoing_.empty()) {
+    return;
+  }
+  for (size_t i = 0; i < num; i++) {
+    if (rows[i] < 0) {
+      continue;
+    }
+    size_t slot = static_cast<size_t>(rows[i]) / bucket_rows_;
+    if (slot >= slot_buckets_.size() || slot_buckets_[slot] < 0) {
+      continue;
+    }
+    auto iter = outgoing_.find(static_cast<size_t>(slot_buckets_[slot]));
+    if (iter != outgoing_.end() && iter->second.copied && !iter->second.dirty) {
+      iter->second.dirty = true;
+      dirty_num_++;
+    }
+  }
+}
+
+void EmbeddingShardTable::MarkAllDirty() {
+  if (!migrating_) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (handoff_started_) {
+    return;
+  }
+  for (auto &outgoing : outgoing_) {
+    if (outgoing.second.copied && !outgoing.second.dirty) {
+      outgoing.second.dirty = true;
+      dirty_num_++;
+    }
+  }
+}
+
+void EmbeddingShardTable::MarkDirtyBuckets(const std::vector<size_t> &buckets) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (handoff_started_) {
+    return;
+  }
+  for (size_t bucket : buckets) {
+    auto iter = outgoing_.find(bucket);
+    if (iter != outgoing_.end() && iter->second.copied && !iter->second.dirty) {
+      iter->second.dirty = true;
+      dirty_num_++;
+    }
+  }
+}
+
+std::vector<EmbeddingBucketMove> EmbeddingShardTable::HandoffBuckets(uint64_t step) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<EmbeddingBucketMove> moves;
+  if (state_ != EmbeddingMigrationState::kCommitted || handoff_started_ || step < switch_step_) {
+    return moves;
+  }
+  handoff_started_ = true;
+  for (const auto &outgoing : outgoing_) {
+    moves.push_back({outgoing.first, outgoing.second.dest, !outgoing.second.copied || outgoing.second.dirty});
+  }
+  return moves;
+}
+
+void EmbeddingShardTable::FinishOutgoing(const std::vector<size_t> &buckets) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t bucket : buckets) {
+    if (outgoing_.erase(bucket) == 0) {
+      continue;
+    }
+    auto slot = static_cast<size_t>(bucket_slots_[bucket]);
+    bucket_slots_[bucket] = -1;
+    slot_buckets_[slot] = -1;
+    free_slots_.push_back(slot);
+  }
+  CompleteIfDone();
+}
+
+bool EmbeddingShardTable::IsIncoming(size_t bucket) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return incoming_.count(bucket) > 0;
+}
+
+void EmbeddingShardTable::FinishIncoming(const std::vector<size_t> &buckets) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t bucket : buckets) {
+    (void)incoming_.erase(bucket);
+  }
+  CompleteIfDone();
+}
+
+bool EmbeddingShardTable::WaitingIncoming(uint64_t step) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return state_ == EmbeddingMigrationState::kCommitted && step >= switch_step_ && !incoming_.empty();
+}
+
+void EmbeddingShardTable::ResetMigration() {
+  outgoing_.clear();
+  incoming_.clear();
+  target_map_ = nullptr;
+  dirty_num_ = 0;
+  handoff_started_ = false;
+  precommit_switch_step_ = 0;
+  state_ = EmbeddingMigrationState::kIdle;
+  migrating_ = false;
+}
+
+void EmbeddingShardTable::CheckConverged() {
+  if (state_ != EmbeddingMigrationState::kCopying) {
+    return;
+  }
+  bool all_copied = std::all_of(outgoing_.begin(), outgoing_.end(),
+                                [](const std::pair<const size_t, OutgoingBucket> &iter) { return iter.second.copied; });
+  if (all_copied &&
+      (dirty_num_ * kEmbeddingDirtyBucketRatio <= outgoing_.size() || copy_rounds_ >= kMaxEmbeddingPreCopyRounds)) {
+    state_ = EmbeddingMigrationState::kConverged;
+  }
+}
+
+void EmbeddingShardTable::CompleteIfDone() {
+  if (state_ != EmbeddingMigrationState::kCommitted || !outgoing_.empty() || !incoming_.empty()) {
+    return;
+  }
+  MS_LOG(INFO) << "Server " << rank_id_ << " completes the migration to version " << target_map_->version();
+  shard_map_ = target_map_;
+  ResetMigration();
+}
+}  // namespace ps
+}  // namespace mindspore
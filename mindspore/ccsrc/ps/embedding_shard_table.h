@@ -0,0 +1,154 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_PS_EMBEDDING_SHARD_TABLE_H_
+#define MINDSPORE_CCSRC_PS_EMBEDDING_SHARD_TABLE_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+#include "ps/embedding_shard_ring.h"
+#include "include/backend/visible.h"
+
+namespace mindspore {
+namespace ps {
+// The phases of the migration driven by the worker 0 on all the servers.
+enum class EmbeddingMigrationPhase : uint32_t { kPrepare = 0, kQuery, kPrecommit, kCommit, kAbort };
+// The state of the migration on a server. kRetry is only replied to the lookups which should be sent again.
+enum class EmbeddingMigrationState : uint32_t {
+  kIdle = 0,
+  kCopying,
+  kConverged,
+  kPrecommitted,
+  kCommitted,
+  kFailed,
+  kRetry
+};
+
+// The pre-copy converges when the dirty buckets are less than 1/kEmbeddingDirtyBucketRatio of the moved ones, or after
+// kMaxEmbeddingPreCopyRounds rounds over the moved buckets, e.g. the non-lazy Adam updates all the rows every step.
+constexpr size_t kEmbeddingDirtyBucketRatio = 16;
+constexpr size_t kMaxEmbeddingPreCopyRounds = 4;
+
+// A bucket moved from this server to 'dest'. 'dirty' is false if the rows the destination holds are up to date.
+struct EmbeddingBucketMove {
+  size_t bucket;
+  uint32_t dest;
+  bool dirty;
+};
+
+// The local shard of a consistent hash sharded embedding table on a server. The local table is a fixed array of slots,
+// each of which holds the rows of a bucket, and the local row of id is slot * bucket_rows + id % bucket_rows.
+//
+// The migration to a new placement goes online with the training:
+// 1. Prepare: the slots of the incoming buckets are reserved.
+// 2. Pre-copy: the outgoing buckets are copied to the destinations while they are still updated here, the buckets
+//    updated after they are copied are marked dirty and copied again.
+// 3. Precommit: each server checks that 'switch_step' is still ahead of its updates, and its updates wait for the
+//    decision before they could reach the switch step. Any refusal aborts the migration on all the servers.
+// 4. Commit: the workers switch to the new placement from the push of 'switch_step'. After the update of step
+//    switch_step - 1, the dirty buckets are handed off with their final rows, and the destination waits for them
+//    before it applies the update of step switch_step.
+class BACKEND_EXPORT EmbeddingShardTable {
+ public:
+  EmbeddingShardTable(size_t row_count, size_t server_num, uint32_t rank_id);
+  ~EmbeddingShardTable() = default;
+
+  size_t row_count() const { return row_count_; }
+  size_t bucket_rows() const { return bucket_rows_; }
+  size_t slot_num() const { return slot_buckets_.size(); }
+  size_t BucketRowNum(size_t bucket) const;
+  bool migrating() const { return migrating_; }
+
+  // The placement of the last committed migration and the step the workers switch to it.
+  void GetPlacement(uint64_t *version, std::vector<uint32_t> *server_ranks, uint64_t *switch_step) const;
+
+  // Translate the ids to the local rows, -1 for the ids not owned by this server. The rows of the incoming buckets are
+  // only returned if 'accept_incoming', otherwise false is returned and the ids should be retried after the handoff.
+  bool ToLocalRows(const int *ids, size_t num, bool accept_incoming, int *rows) const;
+  // The slot of the bucket held by this server, -1 if none.
+  int64_t SlotOf(size_t bucket) const;
+  // The owned buckets in ascending order with their slots.
+  std::vector<std::pair<size_t, size_t>> OwnedBuckets() const;
+
+  EmbeddingMigrationState state() const;
+  EmbeddingMigrationState Prepare(const std::vector<uint32_t> &server_ranks, uint64_t version);
+  EmbeddingMigrationState Precommit(uint64_t version, uint64_t switch_step, uint64_t current_step);
+  // Only the precommitted migration is committed, which can't fail since the updates wait for the decision.
+  EmbeddingMigrationState Commit(uint64_t version, uint64_t switch_step);
+  // The migration is rolled back until it is committed, then it can't be aborted.
+  bool Abort(uint64_t version);
+  // Whether the update of 'step' waits for the commit or the abort of the precommitted migration.
+  bool WaitingDecision(uint64_t step) const;
+
+  // The source side. The buckets are marked clean before they are copied, so the updates after that mark them dirty.
+  std::vector<EmbeddingBucketMove> NextCopyBuckets(size_t max_num);
+  void MarkDirtyRows(const int *rows, size_t num);
+  void MarkAllDirty();
+  // Mark the copied buckets dirty if their rows failed to be sent, so they are copied again.
+  void MarkDirtyBuckets(const std::vector<size_t> &buckets);
+  // Return the outgoing buckets once 'step' reaches the switch step, only once for each migration.
+  std::vector<EmbeddingBucketMove> HandoffBuckets(uint64_t step);
+  // Release the slots of the buckets received by the destination.
+  void FinishOutgoing(const std::vector<size_t> &buckets);
+
+  // The destination side.
+  bool IsIncoming(size_t bucket) const;
+  void FinishIncoming(const std::vector<size_t> &buckets);
+  // Whether the update of 'step' waits for the incoming buckets.
+  bool WaitingIncoming(uint64_t step) const;
+
+ private:
+  struct OutgoingBucket {
+    uint32_t dest;
+    bool copied;
+    bool dirty;
+  };
+
+  void ResetMigration();
+  void CheckConverged();
+  void CompleteIfDone();
+
+  size_t row_count_;
+  size_t bucket_rows_;
+  uint32_t rank_id_;
+
+  mutable std::mutex mutex_;
+  std::shared_ptr<EmbeddingShardMap> shard_map_;
+  std::shared_ptr<EmbeddingShardMap> target_map_{nullptr};
+  uint64_t switch_step_{0};
+  uint64_t precommit_switch_step_{0};
+  // The slot of each bucket, -1 if it's not held by this server, and the bucket of each slot.
+  std::vector<int64_t> bucket_slots_;
+  std::vector<int64_t> slot_buckets_;
+  std::vector<size_t> free_slots_;
+
+  std::atomic_bool migrating_{false};
+  EmbeddingMigrationState state_{EmbeddingMigrationState::kIdle};
+  std::map<size_t, OutgoingBucket> outgoing_;
+  std::set<size_t> incoming_;
+  size_t copy_cursor_{0};
+  size_t copy_rounds_{0};
+  size_t dirty_num_{0};
+  bool handoff_started_{false};
+};
+}  // namespace ps
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_PS_EMBEDDING_SHARD_TABLE_H_
@@ -18,6 +18,7 @@
 #include <algorithm>
 #include <thread>
 #include <set>
+#include <shared_mutex>
 
 #include "utils/file_utils.h"
 
@@ -53,6 +54,9 @@ void ParameterServer::Run(const FuncGraphPtr &func_graph) {
 
   PSContext::instance()->SetPSRankId(server_node_->rank_id());
   thread_->join();
+  if (migrate_thread_ != nullptr && migrate_thread_->joinable()) {
+    migrate_thread_->join();
+  }
   SyncEmbeddingTables();
   MS_LOG(INFO) << "PServer finished updating models, starts finalizing...";
   server_node_->Finish();
@@ -82,6 +86,7 @@ bool ParameterServer::Init(const FuncGraphPtr &func_graph) {
     this->Finalize();
   });
   server_node_->RegisterEventCallback(core::ClusterEvent::ON_BEGIN_PERSIST, [this]() { this->PersistParameters(); });
+  StartUpdateThreads();
   thread_.reset(new std::thread(&ParameterServer::UpdateWeights, this));
   GetEmbeddingTableParamPtr();
   return true;
@@ -166,9 +171,35 @@ void ParameterServer::InitOptimInputsShape(const Keys &keys, const Values &value
 
 void ParameterServer::InitWeight(const Key &key, const WeightPtr &weight) {
   MS_EXCEPTION_IF_NULL(weight);
+  std::unique_lock<std::shared_mutex> locker(access_weight_mutex_);
   if ((weights_.count(key) == 0) || (is_embedding_[key] && weights_.count(key) != 0)) {
     MS_LOG(INFO) << "Initializing weight for key " << key << ", server rank " << server_node_->rank_id();
-    weights_[key] = weight;
+    auto shard_table = embedding_shard_table(key);
+    if (shard_table != nullptr && weights_.count(key) != 0) {
+      // The rows of the owned buckets are placed to their slots, and the rest of the table is the room for the rows
+      // migrated from the other servers.
+      const WeightPtr &table = weights_[key];
+      MS_EXCEPTION_IF_NULL(table);
+      size_t bucket_size = table->size() / shard_table->slot_num();
+      size_t row_size = bucket_size / shard_table->bucket_rows();
+      size_t pos = 0;
+      for (const auto &owned : shard_table->OwnedBuckets()) {
+        size_t len = shard_table->BucketRowNum(owned.first) * row_size;
+        if (pos + len > weight->size()) {
+          MS_LOG(EXCEPTION) << "The initial rows of the embedding table of key " << key << " are less than the owned "
+                            << "buckets of server " << server_node_->rank_id();
+        }
+        (void)std::copy(weight->data() + pos, weight->data() + pos + len, table->data() + owned.second * bucket_size);
+        pos += len;
+      }
+      if (pos != weight->size()) {
+        MS_LOG(EXCEPTION) << "The initial rows of the embedding table of key " << key << " mismatch the owned "
+                          << "buckets of server " << server_node_->rank_id() << ", expect " << pos << " values, but "
+                          << "got " << weight->size();
+      }
+    } else {
+      weights_[key] = weight;
+    }
     tokens_[key] = 0;
     is_embedding_[key] = false;
   }
@@ -230,6 +261,15 @@ void CopyTensorData(void *dest_ptr, size_t tensor_size, const void *src_ptr) {
     }
   }
 }
+
+// The optimizer states which have a row for each embedding row, they are migrated with the rows.
+const std::map<std::string, std::vector<std::string>> kEmbeddingOptimStates = {
+  {kSparseAdam, {"m", "v"}}, {kSparseLazyAdam, {"m", "v"}}, {kSparseFtrl, {"accum", "linear"}}};
+
+std::vector<std::string> EmbeddingStateNames(const std::string &optim_name) {
+  auto iter = kEmbeddingOptimStates.find(optim_name);
+  return iter == kEmbeddingOptimStates.end() ? std::vector<std::string>() : iter->second;
+}
 }  // namespace
 
 void ParameterServer::PersistKernels(const Key &key,
@@ -328,7 +368,7 @@ void ParameterServer::InitEmbeddingTable(
     }
   }
 
-  std::unique_lock<std::mutex> locker(access_weight_mutex_);
+  std::unique_lock<std::shared_mutex> locker(access_weight_mutex_);
 
   MS_EXCEPTION_IF_NULL(shapes);
   if (weights_.count(key) == 0) {
@@ -336,6 +376,15 @@ void ParameterServer::InitEmbeddingTable(
       std::make_shared<kernel::ps::EmbeddingLookUpPSKernelMod>(server_node_->rank_id(), pserver_num_, worker_num_);
     lookup->InitKernel(shapes);
     embedding_lookup_ops_[key] = lookup;
+    if (PSContext::instance()->enable_embedding_hash_shard()) {
+      if (shapes->empty() || shapes->front()->empty()) {
+        MS_LOG(EXCEPTION) << "The shape of the embedding table of key " << key << " is empty.";
+      }
+      auto shard_table =
+        std::make_shared<EmbeddingShardTable>(shapes->front()->at(0), pserver_num_, server_node_->rank_id());
+      std::unique_lock<std::mutex> shard_lock(shard_tables_mutex_);
+      embedding_shard_tables_[key] = shard_table;
+    }
 
     PersistKernels(key, shapes, param_init_info);
 
@@ -393,6 +442,7 @@ bool ParameterServer::HasWeight(const Key &key) { return (weights_.count(key) >
 void ParameterServer::Finalize() {
   running_ = false;
   apply_grads_cv_.notify_one();
+  embedding_migration_cv_.notify_all();
 
   if (persist_thread_ != nullptr && persist_thread_->joinable()) {
     persist_thread_->join();
@@ -407,10 +457,14 @@ void ParameterServer::UpdateWeights() {
     if (!running_) {
       break;
     }
+    WaitEmbeddingHandoffs(&lock);
+    if (!running_) {
+      break;
+    }
 
+    std::vector<UpdateTask> tasks;
     for (auto iter = weights_.begin(); iter != weights_.end(); iter++) {
       Key key = iter->first;
-      WeightPtr weight_ptr = iter->second;
 
       std::shared_ptr<PServerKernel> optimizer = nullptr;
       if (weight_key_to_optims_.count(key) > 0) {
@@ -420,36 +474,155 @@ void ParameterServer::UpdateWeights() {
 
       std::shared_ptr<OptimizerInfo> optim_info = optim_infos_[key];
       if (optim_info != nullptr) {
-        const std::vector<kernel::AddressPtr> &inputs = optim_info->inputs();
-        const std::vector<kernel::AddressPtr> &workspaces = optim_info->workspaces();
-        const std::vector<kernel::AddressPtr> &outputs = optim_info->outputs();
-
-        std::vector<std::vector<size_t>> shapes = {};
-        std::vector<size_t> indices_shape = {};
-        indices_shape.emplace_back(optim_info->indice_size());
-        shapes.push_back(indices_shape);
-
-        if (original_optim_inputs_shape_.count(key) != 0) {
-          std::transform((*(original_optim_inputs_shape_[key])).begin(), (*(original_optim_inputs_shape_[key])).end(),
-                         std::back_inserter(shapes),
-                         [](const std::shared_ptr<std::vector<size_t>> &input_shapes) -> std::vector<size_t> {
-                           return *input_shapes;
-                         });
+        auto shape_iter = original_optim_inputs_shape_.find(key);
+        InputsShapePtr original_inputs_shape =
+          shape_iter == original_optim_inputs_shape_.end() ? nullptr : shape_iter->second;
+        auto shard_table = embedding_shard_table(key);
+        if (shard_table != nullptr) {
+          original_inputs_shape = EmbeddingInputsShape(key, original_inputs_shape, *shard_table);
         }
-        optimizer->ReInit(shapes);
-        optim_info->ComputeMean(shapes, worker_num_, pserver_num_, server_node_->rank_id());
-        optimizer->Execute(inputs, workspaces, outputs);
-        optim_info->Reset();
+        bool update_all_rows = weight_key_to_optims_[key] == kSparseAdam;
+        tasks.push_back({key, optimizer, optim_info, original_inputs_shape, shard_table, update_all_rows});
       }
       if (!is_embedding_[key]) {
         tokens_[key] = worker_num_;
       }
     }
+    {
+      // The optimizers of the embedding tables write the rows, which are updated by the workers concurrently.
+      auto row_locks = embedding_row_mutexes_.LockAll();
+      ParallelUpdateWeights(tasks);
+    }
     ResetGradAccumCount();
+    update_step_++;
+    lock.unlock();
+    // The update of the next step waits for the handoff, which sends the final rows of the moved buckets.
+    HandoffEmbeddingTables();
+  }
+  StopUpdateThreads();
+}
+
+void ParameterServer::UpdateWeight(const UpdateTask &task) const {
+  const std::shared_ptr<PServerKernel> &optimizer = task.optimizer;
+  const std::shared_ptr<OptimizerInfo> &optim_info = task.optim_info;
+  const std::vector<kernel::AddressPtr> &inputs = optim_info->inputs();
+  const std::vector<kernel::AddressPtr> &workspaces = optim_info->workspaces();
+  const std::vector<kernel::AddressPtr> &outputs = optim_info->outputs();
+
+  std::vector<std::vector<size_t>> shapes = {};
+  std::vector<size_t> indices_shape = {};
+  indices_shape.emplace_back(optim_info->indice_size());
+  shapes.push_back(indices_shape);
+
+  if (task.original_inputs_shape != nullptr) {
+    std::transform(task.original_inputs_shape->begin(), task.original_inputs_shape->end(), std::back_inserter(shapes),
+                   [](const std::shared_ptr<std::vector<size_t>> &input_shapes) -> std::vector<size_t> {
+                     return *input_shapes;
+                   });
+  }
+  optimizer->ReInit(shapes);
+  optim_info->ComputeMean(shapes, worker_num_, pserver_num_, server_node_->rank_id());
+  optimizer->Execute(inputs, workspaces, outputs);
+  if (task.shard_table != nullptr && task.shard_table->migrating()) {
+    if (task.update_all_rows) {
+      task.shard_table->MarkAllDirty();
+    } else {
+      const AddressPtr &indices = optim_info->indices();
+      MS_EXCEPTION_IF_NULL(indices);
+      task.shard_table->MarkDirtyRows(reinterpret_cast<int *>(indices->addr), indices->size / sizeof(int));
+    }
+  }
+  optim_info->Reset();
+}
+
+void ParameterServer::StartUpdateThreads() {
+  size_t thread_num = std::min(static_cast<size_t>(std::max(kCPUCoreNum, 1U)), kMaxUpdateThreadNum);
+  if (thread_num <= 1) {
+    return;
+  }
+  for (size_t i = 0; i < thread_num; i++) {
+    (void)update_shards_.emplace_back(std::make_unique<UpdateShard>());
+  }
+  for (size_t i = 0; i < thread_num; i++) {
+    (void)update_threads_.emplace_back(&ParameterServer::RunUpdateShard, this, update_shards_[i].get());
+  }
+  MS_LOG(INFO) << "Start " << thread_num << " threads to apply the optimizers.";
+}
+
+void ParameterServer::StopUpdateThreads() {
+  for (auto &shard : update_shards_) {
+    std::unique_lock<std::mutex> lock(shard->mutex);
+    shard->stop = true;
+    shard->cv.notify_one();
+  }
+  for (auto &update_thread : update_threads_) {
+    if (update_thread.joinable()) {
+      update_thread.join();
+    }
+  }
+  update_threads_.clear();
+  update_shards_.clear();
+}
+
+void ParameterServer::ParallelUpdateWeights(const std::vector<UpdateTask> &tasks) {
+  if (update_shards_.empty() || tasks.size() <= 1) {
+    for (const auto &task : tasks) {
+      UpdateWeight(task);
+    }
+    return;
+  }
+
+  {
+    std::unique_lock<std::mutex> done_lock(update_done_mutex_);
+    pending_update_num_ = tasks.size();
+    update_exception_ = nullptr;
+  }
+  // The optimizer of a key is always applied by the same thread.
+  for (const auto &task : tasks) {
+    auto &shard = update_shards_[task.key % update_shards_.size()];
+    std::unique_lock<std::mutex> lock(shard->mutex);
+    shard->tasks.push(task);
+    shard->cv.notify_one();
+  }
+
+  std::unique_lock<std::mutex> done_lock(update_done_mutex_);
+  update_done_cv_.wait(done_lock, [this] { return pending_update_num_ == 0; });
+  if (update_exception_ != nullptr) {
+    std::rethrow_exception(update_exception_);
+  }
+}
+
+void ParameterServer::RunUpdateShard(UpdateShard *shard) {
+  MS_EXCEPTION_IF_NULL(shard);
+  while (true) {
+    std::unique_lock<std::mutex> lock(shard->mutex);
+    shard->cv.wait(lock, [shard] { return shard->stop || !shard->tasks.empty(); });
+    if (shard->tasks.empty()) {
+      return;
+    }
+    UpdateTask task = std::move(shard->tasks.front());
+    shard->tasks.pop();
+    lock.unlock();
+
+    std::exception_ptr exception = nullptr;
+    try {
+      UpdateWeight(task);
+    } catch (...) {
+      exception = std::current_exception();
+    }
+
+    std::unique_lock<std::mutex> done_lock(update_done_mutex_);
+    if (exception != nullptr && update_exception_ == nullptr) {
+      update_exception_ = exception;
+    }
+    if (--pending_update_num_ == 0) {
+      update_done_cv_.notify_one();
+    }
   }
 }
 
 void ParameterServer::AccumGrad(const Keys &keys, const Values &values, const Lengths &lengths) {
+  // The gradients are accumulated with the mutex_ held, which the optimizers also hold to apply and reset them.
   std::unique_lock<std::mutex> lock(mutex_);
   const Key &key = keys[0];
   bool no_sparse_grad = values.size() == 1 && values[0] == kGradValue;
@@ -468,6 +641,7 @@ void ParameterServer::AccumGrad(const Keys &keys, const Values &values, const Le
                                             optim_inputs_shape_[key], worker_num_, is_embedding_[key]);
       optim_info.reset(optim);
       optim_infos_[key] = optim_info;
+      ApplyPendingEmbeddingStates(key);
     } else {
       optim_info->Update(values, lengths);
       optim_info->Accumulate(values, lengths);
@@ -494,7 +668,8 @@ WeightPtr ParameterServer::weight(const Key &key) {
   return weight_ptr;
 }
 
-void ParameterServer::DoEmbeddingLookup(Key key, const LookupIds &lookup_ids, KVMessage *res) {
+void ParameterServer::DoEmbeddingLookup(Key key, const LookupIds &lookup_ids, const EmbeddingShardMeta &shard_meta,
+                                        KVMessage *res) {
   if (EnableRecovery()) {
     while (!finish_recovery_) {
       std::this_thread::yield();
@@ -539,6 +714,25 @@ void ParameterServer::DoEmbeddingLookup(Key key, const LookupIds &lookup_ids, KV
   for (size_t i = 0; i < lookup_ids.size(); i++) {
     tmp_ids[i] = static_cast<int>(lookup_ids[i]);
   }
+  auto shard_table = embedding_shard_table(key);
+  if (shard_table != nullptr) {
+    uint64_t version = 0;
+    std::vector<uint32_t> server_ranks;
+    uint64_t switch_step = 0;
+    shard_table->GetPlacement(&version, &server_ranks, &switch_step);
+    EmbeddingShardMeta *res_meta = res->mutable_shard_meta();
+    res_meta->set_key(key);
+    res_meta->set_version(version);
+    *res_meta->mutable_server_ranks() = {server_ranks.begin(), server_ranks.end()};
+    res_meta->set_switch_step(switch_step);
+    // The worker retries the lookup partitioned by the stale placement after the switch step, and the lookup of the
+    // rows which are not handed off yet.
+    bool stale = shard_meta.version() < version && shard_meta.step() >= switch_step;
+    if (stale || !shard_table->ToLocalRows(tmp_ids.get(), lookup_ids.size(), false, tmp_ids.get())) {
+      res_meta->set_state(static_cast<uint32_t>(EmbeddingMigrationState::kRetry));
+      return;
+    }
+  }
   indices->addr = tmp_ids.get();
   indices->size = lookup_ids.size() * sizeof(int);
 
@@ -553,7 +747,12 @@ void ParameterServer::DoEmbeddingLookup(Key key, const LookupIds &lookup_ids, KV
   output->size = output_shapes[0];
   outputs.push_back(output);
 
-  table_lookup_op->Execute(inputs, workspaces, outputs);
+  {
+    // The lookups are serialized by the global mutex, and they lock all the row stripes to not read the rows being
+    // updated.
+    auto row_locks = embedding_row_mutexes_.LockAll();
+    table_lookup_op->Execute(inputs, workspaces, outputs);
+  }
   *res->mutable_values() = {addr->begin(), addr->end()};
   res->add_len(res->values_size());
 }
@@ -565,21 +764,47 @@ void ParameterServer::UpdateEmbeddings(const Key &key, const LookupIds &lookup_i
     }
   }
 
-  std::unique_lock<std::mutex> locker(access_weight_mutex_);
+  // The updates of the embedding tables share the weights, and only the rows in the same stripe are serialized.
+  std::shared_lock<std::shared_mutex> locker(access_weight_mutex_);
 
-  if (weights_.count(key) == 0) {
+  auto table_iter = weights_.find(key);
+  if (table_iter == weights_.end()) {
     MS_LOG(ERROR) << "Invalid embedding table key " << key;
     return;
   }
-  if (embedding_lookup_ops_.count(key) == 0) {
+  auto lookup_op_iter = embedding_lookup_ops_.find(key);
+  if (lookup_op_iter == embedding_lookup_ops_.end()) {
     MS_LOG(ERROR) << "Invalid embedding lookup op key " << key;
     return;
   }
-  WeightPtr table_ptr = weights_[key];
+  WeightPtr table_ptr = table_iter->second;
   MS_EXCEPTION_IF_NULL(table_ptr);
-  std::shared_ptr<PServerKernel> lookup_op = embedding_lookup_ops_[key];
+  std::shared_ptr<PServerKernel> lookup_op = lookup_op_iter->second;
   MS_EXCEPTION_IF_NULL(lookup_op);
-  lookup_op->UpdateEmbeddings(table_ptr->data(), lookup_ids.data(), vals.data(), lookup_ids.size());
+
+  size_t ids_num = lookup_ids.size();
+  if (ids_num == 0) {
+    return;
+  }
+  if (kCPUCoreNum <= 1) {
+    // The updates can't run in parallel on one core, so the rows are updated in one batch without grouping them.
+    auto row_locks = embedding_row_mutexes_.LockAll();
+    lookup_op->UpdateEmbeddings(table_ptr->data(), lookup_ids.data(), vals.data(), ids_num);
+  } else {
+    // The rows of each stripe are gathered and updated in one batch.
+    size_t row_size = vals.size() / ids_num;
+    std::vector<size_t> stripe_ids;
+    std::vector<float> stripe_vals;
+    embedding_row_mutexes_.ForEachStripe(lookup_ids.data(), ids_num, [&](const size_t *positions, size_t num) {
+      stripe_ids.resize(num);
+      stripe_vals.resize(num * row_size);
+      for (size_t i = 0; i < num; i++) {
+        stripe_ids[i] = lookup_ids[positions[i]];
+        (void)std::copy_n(vals.data() + positions[i] * row_size, row_size, stripe_vals.data() + i * row_size);
+      }
+      lookup_op->UpdateEmbeddings(table_ptr->data(), stripe_ids.data(), stripe_vals.data(), num);
+    });
+  }
 
   UpdateDirtyInfo(key, lookup_ids, lookup_op->offset());
 }
@@ -592,6 +817,7 @@ void ParameterServer::UpdateDirtyInfo(const Key &key, const LookupIds &lookup_id
       (void)sorted_ids.insert(index);
     });
 
+    std::unique_lock<std::mutex> lock(dirty_info_mutex_);
     auto iter = weights_dirty_info_.find(key);
     if (iter == weights_dirty_info_.end()) {
       MS_LOG(EXCEPTION) << "Cannot find dirty info for embedding table, key: " << key;
@@ -813,10 +1039,11 @@ void ParameterServer::PersistParameters() {
   }
 
   auto do_persist_task = [this]() {
-    std::unique_lock<std::mutex> locker(access_weight_mutex_);
+    std::unique_lock<std::shared_mutex> locker(access_weight_mutex_);
 
     set_persistent_state(core::PersistentState::PERSISTING);
 
+    std::vector<PersistentWeightPtr> persistent_weights;
     for (const auto &weight_key_pair : weights_) {
       const WeightPtr &weight = weight_key_pair.second;
       auto persistent_weight = std::dynamic_pointer_cast<PersistentWeight>(weight);
@@ -830,10 +1057,18 @@ void ParameterServer::PersistParameters() {
 
       distributed::storage::DirtyInfo &dirty_info = iter->second;
       persistent_weight->Persist(dirty_info);
+      persistent_weights.push_back(persistent_weight);
 
       dirty_info.clear();
     }
 
+    // The weights are only locked while the snapshots of the dirty blocks are taken, and the training goes on while
+    // the snapshots are written to the storage.
+    locker.unlock();
+    for (const auto &persistent_weight : persistent_weights) {
+      persistent_weight->Flush();
+    }
+
     set_persistent_state(core::PersistentState::FINISH_PERSIST);
     MS_LOG(INFO) << "Finish persist weights in parameter server";
   };
@@ -851,20 +1086,35 @@ void ParameterServer::SyncEmbeddingTables() {
     auto lookup = embedding_lookup_ops_[key];
     const std::vector<size_t> &input_shapes = lookup->input_sizes();
     std::vector<int64_t> new_tensor_shape(input_shapes.begin(), input_shapes.end());
+    auto shard_table = embedding_shard_table(key);
+    if (shard_table != nullptr && !new_tensor_shape.empty()) {
+      new_tensor_shape[0] = SizeToLong(shard_table->row_count());
+    }
 
     tensor::TensorPtr new_tensor = std::make_shared<tensor::Tensor>(kNumberTypeFloat32, new_tensor_shape);
     MS_EXCEPTION_IF_NULL(new_tensor);
     float *new_tensor_data_ptr = reinterpret_cast<float *>(new_tensor->data_c());
     size_t new_tensor_size = static_cast<size_t>(new_tensor->data().nbytes());
     size_t embedding_table_size = weights_[key]->size() * sizeof(float);
-    if (new_tensor_size != embedding_table_size) {
-      MS_LOG(EXCEPTION) << "Shape of embedding table can't match. New tensor size:" << new_tensor_size
-                        << ", embedding_table size:" << embedding_table_size;
-    }
     MS_EXCEPTION_IF_NULL(new_tensor_data_ptr);
     MS_EXCEPTION_IF_NULL(weights_[key]->data());
-
-    CopyTensorData(new_tensor_data_ptr, new_tensor_size, weights_[key]->data());
+    if (shard_table != nullptr) {
+      // The rows of the owned buckets are placed back by their ids, and the rows of the other servers are zero.
+      std::fill(new_tensor_data_ptr, new_tensor_data_ptr + new_tensor_size / sizeof(float), 0.0f);
+      size_t bucket_size = weights_[key]->size() / shard_table->slot_num();
+      size_t row_size = bucket_size / shard_table->bucket_rows();
+      for (const auto &owned : shard_table->OwnedBuckets()) {
+        const float *rows = weights_[key]->data() + owned.second * bucket_size;
+        (void)std::copy(rows, rows + shard_table->BucketRowNum(owned.first) * row_size,
+                        new_tensor_data_ptr + owned.first * bucket_size);
+      }
+    } else {
+      if (new_tensor_size != embedding_table_size) {
+        MS_LOG(EXCEPTION) << "Shape of embedding table can't match. New tensor size:" << new_tensor_size
+                          << ", embedding_table size:" << embedding_table_size;
+      }
+      CopyTensorData(new_tensor_data_ptr, new_tensor_size, weights_[key]->data());
+    }
 
     auto paramter_tensor_ptr = embedding_table.second->default_param();
     MS_EXCEPTION_IF_NULL(paramter_tensor_ptr);
@@ -872,6 +1122,425 @@ void ParameterServer::SyncEmbeddingTables() {
   }
 }
 
+std::shared_ptr<EmbeddingShardTable> ParameterServer::embedding_shard_table(const Key &key) {
+  std::unique_lock<std::mutex> lock(shard_tables_mutex_);
+  auto iter = embedding_shard_tables_.find(key);
+  return iter == embedding_shard_tables_.end() ? nullptr : iter->second;
+}
+
+std::vector<std::pair<Key, std::shared_ptr<EmbeddingShardTable>>> ParameterServer::embedding_shard_tables() {
+  std::unique_lock<std::mutex> lock(shard_tables_mutex_);
+  return {embedding_shard_tables_.begin(), embedding_shard_tables_.end()};
+}
+
+void ParameterServer::ToLocalEmbeddingIndices(const Key &key, const Lengths &lengths, Values *values) {
+  MS_EXCEPTION_IF_NULL(values);
+  auto shard_table = embedding_shard_table(key);
+  bool no_sparse_grad = values->size() == 1 && (*values)[0] == kGradValue;
+  if (shard_table == nullptr || no_sparse_grad) {
+    return;
+  }
+  std::string optim_name;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto iter = weight_key_to_optims_.find(key);
+    if (iter == weight_key_to_optims_.end()) {
+      MS_LOG(EXCEPTION) << "No optimizer found for the embedding table of key " << key;
+    }
+    optim_name = iter->second;
+  }
+  auto send_idx_iter = kOptimToPSSendIdx.find(optim_name);
+  if (send_idx_iter == kOptimToPSSendIdx.end() || send_idx_iter->second.count("indices") == 0) {
+    MS_LOG(EXCEPTION) << "The optimizer " << optim_name << " of key " << key << " has no indices.";
+  }
+  size_t indices_index = send_idx_iter->second.at("indices");
+  if (indices_index >= lengths.size()) {
+    MS_LOG(EXCEPTION) << "The indices index " << indices_index << " is out of the range of lens " << lengths.size();
+  }
+  size_t offset = IntToSize(std::accumulate(lengths.begin(), lengths.begin() + indices_index, 0));
+  size_t indices_num = IntToSize(lengths[indices_index]);
+  if (offset + indices_num > values->size()) {
+    MS_LOG(EXCEPTION) << "The pushed values size " << values->size() << " is less than the indices end "
+                      << offset + indices_num;
+  }
+  // The indices are stored as int in the float values, see SparseOptimInfo::Accumulate. The ids of the buckets not
+  // held by this server are translated to -1, which are dropped by the optimizer.
+  int *indices = reinterpret_cast<int *>(values->data() + offset);
+  (void)shard_table->ToLocalRows(indices, indices_num, true, indices);
+}
+
+void ParameterServer::MigrateEmbedding(const EmbeddingShardMeta &request, EmbeddingShardMeta *response) {
+  MS_EXCEPTION_IF_NULL(response);
+  const Key &key = request.key();
+  response->set_key(key);
+  auto shard_table = embedding_shard_table(key);
+  if (shard_table == nullptr) {
+    MS_LOG(ERROR) << "The embedding table of key " << key << " is not sharded by consistent hashing.";
+    response->set_state(static_cast<uint32_t>(EmbeddingMigrationState::kFailed));
+    return;
+  }
+
+  EmbeddingMigrationState state = EmbeddingMigrationState::kFailed;
+  auto phase = static_cast<EmbeddingMigrationPhase>(request.phase());
+  if (phase == EmbeddingMigrationPhase::kPrepare) {
+    if (EnableRecovery()) {
+      MS_LOG(WARNING) << "The embedding table of key " << key << " can't be migrated with the disaster recovery.";
+    } else {
+      std::vector<uint32_t> server_ranks = {request.server_ranks().begin(), request.server_ranks().end()};
+      state = shard_table->Prepare(server_ranks, request.version());
+    }
+    std::unique_lock<std::mutex> lock(shard_tables_mutex_);
+    if (state != EmbeddingMigrationState::kFailed && migrate_thread_ == nullptr) {
+      migrate_thread_ = std::make_unique<std::thread>(&ParameterServer::PreCopyEmbeddingTables, this);
+    }
+  } else if (phase == EmbeddingMigrationPhase::kQuery) {
+    state = shard_table->state();
+  } else if (phase == EmbeddingMigrationPhase::kPrecommit) {
+    // The updates are blocked, so the switch step is checked against the step of the next update.
+    std::unique_lock<std::mutex> lock(mutex_);
+    state = shard_table->Precommit(request.version(), request.switch_step(), update_step_);
+  } else if (phase == EmbeddingMigrationPhase::kCommit || phase == EmbeddingMigrationPhase::kAbort) {
+    // The updates waiting for the decision are woken up, the lock keeps the wakeup from being missed.
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (phase == EmbeddingMigrationPhase::kCommit) {
+      state = shard_table->Commit(request.version(), request.switch_step());
+    } else {
+      state = shard_table->Abort(request.version()) ? EmbeddingMigrationState::kIdle : shard_table->state();
+    }
+    embedding_migration_cv_.notify_all();
+  } else {
+    MS_LOG(ERROR) << "The embedding migration phase " << request.phase() << " is invalid.";
+  }
+
+  uint64_t version = 0;
+  std::vector<uint32_t> server_ranks;
+  uint64_t switch_step = 0;
+  shard_table->GetPlacement(&version, &server_ranks, &switch_step);
+  response->set_version(version);
+  *response->mutable_server_ranks() = {server_ranks.begin(), server_ranks.end()};
+  response->set_switch_step(switch_step);
+  response->set_state(static_cast<uint32_t>(state));
+  response->set_step(update_step_);
+}
+
+void ParameterServer::PreCopyEmbeddingTables() {
+  MS_LOG(INFO) << "Start the pre-copy of the migrating embedding tables.";
+  while (running_) {
+    bool copied = false;
+    for (const auto &iter : embedding_shard_tables()) {
+      const std::shared_ptr<EmbeddingShardTable> &shard_table = iter.second;
+      MS_EXCEPTION_IF_NULL(shard_table);
+      if (!shard_table->migrating()) {
+        continue;
+      }
+      size_t bucket_size = 0;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        bucket_size = EmbeddingRowSize(iter.first, *shard_table) * shard_table->bucket_rows() *
+                      (EmbeddingStateNames(weight_key_to_optims_[iter.first]).size() + 1) * sizeof(float);
+      }
+      size_t bucket_num = std::max<size_t>(1, kEmbeddingMigrateChunkSize / std::max<size_t>(1, bucket_size));
+      // The chunk is sent before the handoff could start, otherwise the stale rows would overwrite the final rows.
+      std::unique_lock<std::mutex> migrate_lock(migrate_mutex_);
+      std::vector<EmbeddingBucketMove> moves = shard_table->NextCopyBuckets(bucket_num);
+      if (!moves.empty()) {
+        copied = true;
+        if (!SendEmbeddingRows(iter.first, shard_table, moves, false)) {
+          // The destinations may hold the rows of a part of the buckets, all of them are copied again.
+          std::vector<size_t> buckets;
+          (void)std::transform(moves.begin(), moves.end(), std::back_inserter(buckets),
+                               [](const EmbeddingBucketMove &move) { return move.bucket; });
+          shard_table->MarkDirtyBuckets(buckets);
+        }
+      }
+    }
+    if (!copied) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(kEmbeddingMigrateIntervalInMs));
+    }
+  }
+}
+
+void ParameterServer::HandoffEmbeddingTables() {
+  for (const auto &iter : embedding_shard_tables()) {
+    const std::shared_ptr<EmbeddingShardTable> &shard_table = iter.second;
+    MS_EXCEPTION_IF_NULL(shard_table);
+    if (!shard_table->migrating()) {
+      continue;
+    }
+    std::unique_lock<std::mutex> migrate_lock(migrate_mutex_);
+    std::vector<EmbeddingBucketMove> moves = shard_table->HandoffBuckets(update_step_);
+    if (moves.empty()) {
+      continue;
+    }
+    MS_LOG(INFO) << "Hand off " << moves.size() << " buckets of the embedding table of key " << iter.first
+                 << " at step " << update_step_;
+    // The destinations can't apply the switch step without the final rows of the buckets.
+    if (!SendEmbeddingRows(iter.first, shard_table, moves, true) && running_) {
+      MS_LOG(EXCEPTION) << "Hand off the buckets of the embedding table of key " << iter.first << " failed.";
+    }
+  }
+}
+
+void ParameterServer::WaitEmbeddingHandoffs(std::unique_lock<std::mutex> *lock) {
+  MS_EXCEPTION_IF_NULL(lock);
+  auto waiting = [this]() {
+    auto shard_tables = embedding_shard_tables();
+    return std::any_of(shard_tables.begin(), shard_tables.end(), [this](const auto &iter) {
+      return iter.second->WaitingIncoming(update_step_) || iter.second->WaitingDecision(update_step_);
+    });
+  };
+  embedding_migration_cv_.wait(*lock, [this, &waiting] { return !running_ || !waiting(); });
+}
+
+bool ParameterServer::SendEmbeddingRows(const Key &key, const std::shared_ptr<EmbeddingShardTable> &shard_table,
+                                        const std::vector<EmbeddingBucketMove> &moves, bool handoff) {
+  MS_EXCEPTION_IF_NULL(shard_table);
+  // Only the rows updated after the pre-copy are sent by the handoff.
+  std::map<uint32_t, std::vector<size_t>> dest_buckets;
+  std::map<uint32_t, std::vector<size_t>> dest_finished_buckets;
+  for (const auto &move : moves) {
+    if (!handoff || move.dirty) {
+      dest_buckets[move.dest].push_back(move.bucket);
+    }
+    if (handoff) {
+      dest_finished_buckets[move.dest].push_back(move.bucket);
+    }
+  }
+  size_t chunk_bucket_num = 1;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    size_t bucket_size = EmbeddingRowSize(key, *shard_table) * shard_table->bucket_rows() *
+                         (EmbeddingStateNames(weight_key_to_optims_[key]).size() + 1) * sizeof(float);
+    chunk_bucket_num = std::max<size_t>(1, kEmbeddingMigrateChunkSize / std::max<size_t>(1, bucket_size));
+  }
+
+  std::set<uint32_t> dests;
+  (void)std::transform(moves.begin(), moves.end(), std::inserter(dests, dests.end()),
+                       [](const EmbeddingBucketMove &move) { return move.dest; });
+  std::vector<size_t> sent_buckets;
+  for (uint32_t dest : dests) {
+    const std::vector<size_t> &buckets = dest_buckets[dest];
+    size_t begin = 0;
+    do {
+      size_t end = std::min(buckets.size(), begin + chunk_bucket_num);
+      EmbeddingRowsMessage message;
+      message.set_key(key);
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto row_locks = embedding_row_mutexes_.LockAll();
+        CopyEmbeddingRows(key, *shard_table, {buckets.begin() + begin, buckets.begin() + end}, &message);
+      }
+      // The destination serves the buckets once the last chunk of the handoff is written.
+      if (handoff && end == buckets.size()) {
+        const std::vector<size_t> &finished_buckets = dest_finished_buckets[dest];
+        *message.mutable_finished_buckets() = {finished_buckets.begin(), finished_buckets.end()};
+      }
+      std::string data = message.SerializeAsString();
+      VectorPtr resp = nullptr;
+      int64_t retry_count = 0;
+      while (!server_node_->Send(core::NodeRole::SERVER, dest, data, kMigrateEmbeddingRowsCmd, &resp)) {
+        if (!running_ || ++retry_count >= kRetryCount) {
+          MS_LOG(WARNING) << "Stop sending the rows of the embedding table of key " << key << " to server " << dest
+                          << " after " << retry_count << " retries.";
+          return false;
+        }
+        MS_LOG(WARNING) << "Send the rows of the embedding table of key " << key << " to server " << dest
+                        << " failed, retry later.";
+        std::this_thread::sleep_for(std::chrono::milliseconds(kRetryIntervalInMs));
+      }
+      begin = end;
+    } while (begin < buckets.size());
+    if (handoff) {
+      const std::vector<size_t> &finished_buckets = dest_finished_buckets[dest];
+      (void)sent_buckets.insert(sent_buckets.end(), finished_buckets.begin(), finished_buckets.end());
+    }
+  }
+
+  if (handoff) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto stash_iter = pending_embedding_states_.find(key);
+    for (size_t bucket : sent_buckets) {
+      int64_t slot = shard_table->SlotOf(bucket);
+      if (stash_iter != pending_embedding_states_.end() && slot >= 0) {
+        (void)stash_iter->second.erase(static_cast<size_t>(slot));
+      }
+    }
+    shard_table->FinishOutgoing(sent_buckets);
+  }
+  return true;
+}
+
+void ParameterServer::CopyEmbeddingRows(const Key &key, const EmbeddingShardTable &shard_table,
+                                        const std::vector<size_t> &buckets, EmbeddingRowsMessage *message) {
+  MS_EXCEPTION_IF_NULL(message);
+  const WeightPtr &weight = weights_[key];
+  MS_EXCEPTION_IF_NULL(weight);
+  size_t bucket_size = EmbeddingRowSize(key, shard_table) * shard_table.bucket_rows();
+  std::vector<std::string> state_names = EmbeddingStateNames(weight_key_to_optims_[key]);
+  std::vector<float *> states = EmbeddingStates(key);
+  auto stash_iter = pending_embedding_states_.find(key);
+
+  std::vector<float> values;
+  values.reserve(buckets.size() * bucket_size * (state_names.size() + 1));
+  for (size_t bucket : buckets) {
+    int64_t slot = shard_table.SlotOf(bucket);
+    if (slot < 0) {
+      MS_LOG(EXCEPTION) << "The bucket " << bucket << " of the embedding table of key " << key
+                        << " is not held by server " << server_node_->rank_id();
+    }
+    message->add_buckets(bucket);
+    size_t offset = static_cast<size_t>(slot) * bucket_size;
+    (void)values.insert(values.end(), weight->data() + offset, weight->data() + offset + bucket_size);
+    for (size_t i = 0; i < state_names.size(); i++) {
+      // The states are stashed if the rows are received before the first push, or filled by the initial values.
+      if (i < states.size()) {
+        (void)values.insert(values.end(), states[i] + offset, states[i] + offset + bucket_size);
+      } else if (stash_iter != pending_embedding_states_.end() &&
+                 stash_iter->second.count(static_cast<size_t>(slot)) != 0) {
+        const std::vector<float> &stash = stash_iter->second[static_cast<size_t>(slot)];
+        (void)values.insert(values.end(), stash.begin() + i * bucket_size, stash.begin() + (i + 1) * bucket_size);
+      } else {
+        (void)values.insert(values.end(), bucket_size, EmbeddingStateDefault(key, state_names[i]));
+      }
+    }
+  }
+  message->set_state_num(SizeToUint(state_names.size()));
+  *message->mutable_values() = {values.begin(), values.end()};
+}
+
+void ParameterServer::WriteEmbeddingRows(const EmbeddingRowsMessage &message) {
+  const Key &key = message.key();
+  auto shard_table = embedding_shard_table(key);
+  if (shard_table == nullptr) {
+    MS_LOG(ERROR) << "The embedding table of key " << key << " is not sharded by consistent hashing.";
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto row_locks = embedding_row_mutexes_.LockAll();
+    const WeightPtr &weight = weights_[key];
+    MS_EXCEPTION_IF_NULL(weight);
+    size_t bucket_size = EmbeddingRowSize(key, *shard_table) * shard_table->bucket_rows();
+    size_t state_num = message.state_num();
+    if (IntToSize(message.values_size()) != IntToSize(message.buckets_size()) * bucket_size * (state_num + 1)) {
+      MS_LOG(EXCEPTION) << "The migrated values size " << message.values_size() << " mismatches "
+                        << message.buckets_size() << " buckets of " << bucket_size << " values and " << state_num
+                        << " states.";
+    }
+    std::vector<float *> states = EmbeddingStates(key);
+    const float *src = message.values().data();
+    for (uint64_t bucket : message.buckets()) {
+      int64_t slot = shard_table->SlotOf(bucket);
+      if (slot < 0 || !shard_table->IsIncoming(bucket)) {
+        MS_LOG(WARNING) << "The bucket " << bucket << " of the embedding table of key " << key
+                        << " is not migrating to server " << server_node_->rank_id();
+        src += bucket_size * (state_num + 1);
+        continue;
+      }
+      size_t offset = static_cast<size_t>(slot) * bucket_size;
+      (void)std::copy(src, src + bucket_size, weight->data() + offset);
+      src += bucket_size;
+      if (states.size() == state_num) {
+        for (size_t i = 0; i < state_num; i++) {
+          (void)std::copy(src, src + bucket_size, states[i] + offset);
+          src += bucket_size;
+        }
+      } else {
+        pending_embedding_states_[key][static_cast<size_t>(slot)] = {src, src + state_num * bucket_size};
+        src += state_num * bucket_size;
+      }
+    }
+    // The update waiting for the handoff checks the incoming buckets with the mutex_ held, so it can't miss the
+    // notification.
+    if (message.finished_buckets_size() > 0) {
+      shard_table->FinishIncoming({message.finished_buckets().begin(), message.finished_buckets().end()});
+      MS_LOG(INFO) << "Receive " << message.finished_buckets_size() << " buckets of the embedding table of key "
+                   << key;
+    }
+  }
+  if (message.finished_buckets_size() > 0) {
+    embedding_migration_cv_.notify_all();
+  }
+}
+
+std::vector<float *> ParameterServer::EmbeddingStates(const Key &key) {
+  std::vector<float *> states;
+  auto optim_info_iter = optim_infos_.find(key);
+  auto optim_iter = weight_key_to_optims_.find(key);
+  if (optim_info_iter == optim_infos_.end() || optim_info_iter->second == nullptr ||
+      optim_iter == weight_key_to_optims_.end()) {
+    return states;
+  }
+  const std::vector<kernel::AddressPtr> &inputs = optim_info_iter->second->inputs();
+  const OptimOriginIdx &origin_idx = kOptimToOriginIdx.at(optim_iter->second);
+  for (const auto &state_name : EmbeddingStateNames(optim_iter->second)) {
+    size_t index = origin_idx.at(state_name);
+    if (index >= inputs.size() || inputs[index] == nullptr) {
+      MS_LOG(EXCEPTION) << "The optimizer state " << state_name << " of key " << key << " is not found.";
+    }
+    states.push_back(reinterpret_cast<float *>(inputs[index]->addr));
+  }
+  return states;
+}
+
+float ParameterServer::EmbeddingStateDefault(const Key &key, const std::string &state_name) {
+  if (weight_key_to_optims_[key] == kSparseFtrl && state_name == "accum") {
+    auto ftrl = std::dynamic_pointer_cast<kernel::ps::SparseApplyFtrlPSKernelMod>(optimizers_[key]);
+    MS_EXCEPTION_IF_NULL(ftrl);
+    return ftrl->init_accum();
+  }
+  return 0.0f;
+}
+
+size_t ParameterServer::EmbeddingRowSize(const Key &key, const EmbeddingShardTable &shard_table) {
+  const WeightPtr &weight = weights_[key];
+  MS_EXCEPTION_IF_NULL(weight);
+  size_t local_rows = shard_table.slot_num() * shard_table.bucket_rows();
+  if (local_rows == 0) {
+    MS_LOG(EXCEPTION) << "The embedding table of key " << key << " has no local rows.";
+  }
+  return weight->size() / local_rows;
+}
+
+void ParameterServer::ApplyPendingEmbeddingStates(const Key &key) {
+  auto stash_iter = pending_embedding_states_.find(key);
+  if (stash_iter == pending_embedding_states_.end()) {
+    return;
+  }
+  auto shard_table = embedding_shard_table(key);
+  std::vector<float *> states = EmbeddingStates(key);
+  if (shard_table != nullptr && !states.empty()) {
+    size_t bucket_size = EmbeddingRowSize(key, *shard_table) * shard_table->bucket_rows();
+    for (const auto &stash : stash_iter->second) {
+      const float *src = stash.second.data();
+      size_t offset = stash.first * bucket_size;
+      for (size_t i = 0; i < states.size() && (i + 1) * bucket_size <= stash.second.size(); i++) {
+        (void)std::copy(src + i * bucket_size, src + (i + 1) * bucket_size, states[i] + offset);
+      }
+    }
+  }
+  (void)pending_embedding_states_.erase(stash_iter);
+}
+
+InputsShapePtr ParameterServer::EmbeddingInputsShape(const Key &key, const InputsShapePtr &original_inputs_shape,
+                                                     const EmbeddingShardTable &shard_table) {
+  auto iter = embedding_inputs_shape_.find(key);
+  if (iter != embedding_inputs_shape_.end()) {
+    return iter->second;
+  }
+  if (original_inputs_shape == nullptr || original_inputs_shape->empty() || original_inputs_shape->front()->empty()) {
+    return original_inputs_shape;
+  }
+  // The optimizer sees the local table, whose rows are the slots of the buckets.
+  InputsShapePtr inputs_shape = std::make_shared<InputsShape>();
+  for (const auto &shape : *original_inputs_shape) {
+    inputs_shape->push_back(std::make_shared<std::vector<size_t>>(*shape));
+  }
+  inputs_shape->front()->at(0) = shard_table.slot_num() * shard_table.bucket_rows();
+  embedding_inputs_shape_[key] = inputs_shape;
+  return inputs_shape;
+}
+
 void ParameterServer::ServerHandler::Init() {
   handlers_[kInitWeightsCmd] = &ServerHandler::HandleInitWeights;
   handlers_[kInitWeightToOptimIdCmd] = &ServerHandler::HandleInitWeightToOptimId;
@@ -884,6 +1553,8 @@ void ParameterServer::ServerHandler::Init() {
   handlers_[kFinalizeCmd] = &ServerHandler::HandleFinalize;
   handlers_[kPushCmd] = &ServerHandler::HandlePushReq;
   handlers_[kPullCmd] = &ServerHandler::HandlePullReq;
+  handlers_[kMigrateEmbeddingCmd] = &ServerHandler::HandleMigrateEmbedding;
+  handlers_[kMigrateEmbeddingRowsCmd] = &ServerHandler::HandleMigrateEmbeddingRows;
   commands_[kInitWeightsCmd] = "kInitWeightsCmd";
   commands_[kInitWeightToOptimIdCmd] = "kInitWeightToOptimIdCmd";
   commands_[kInitOptimInputsShapeCmd] = "kInitOptimInputsShapeCmd";
@@ -895,6 +1566,8 @@ void ParameterServer::ServerHandler::Init() {
   commands_[kFinalizeCmd] = "kFinalizeCmd";
   commands_[kPushCmd] = "kPushCmd";
   commands_[kPullCmd] = "kPullCmd";
+  commands_[kMigrateEmbeddingCmd] = "kMigrateEmbeddingCmd";
+  commands_[kMigrateEmbeddingRowsCmd] = "kMigrateEmbeddingRowsCmd";
 }
 
 void ParameterServer::ServerHandler::operator()(const std::shared_ptr<core::TcpConnection> &conn,
@@ -933,10 +1606,35 @@ void ParameterServer::ServerHandler::HandlePushReq(const void *data, size_t size
   Keys keys = {input.keys().begin(), input.keys().end()};
   Values values = {input.values().begin(), input.values().end()};
   Lengths lens = {input.len().begin(), input.len().end()};
+  if (input.compress_type() != static_cast<uint32_t>(PSCompressType::kNoCompress)) {
+    DecompressPushedValues(input, lens, &values);
+  }
+  ps_->ToLocalEmbeddingIndices(keys[0], lens, &values);
   MS_LOG(DEBUG) << "The keys:" << keys << " the values:" << values << " the len:" << lens;
   ps_->AccumGrad(keys, values, lens);
 }
 
+void ParameterServer::ServerHandler::DecompressPushedValues(const KVMessage &input, const Lengths &lens,
+                                                            Values *values) {
+  MS_EXCEPTION_IF_NULL(values);
+  size_t index = input.compress_index();
+  if (index >= lens.size()) {
+    MS_LOG(EXCEPTION) << "The compress index " << index << " is out of the range of lens " << lens.size();
+  }
+  size_t offset = IntToSize(std::accumulate(lens.begin(), lens.begin() + index, 0));
+  size_t compress_size = IntToSize(lens[index]);
+  size_t total_size = IntToSize(std::accumulate(lens.begin(), lens.end(), 0));
+  if (values->size() + compress_size != total_size) {
+    MS_LOG(EXCEPTION) << "The pushed values size " << values->size() << " mismatches the lens, total size "
+                      << total_size << ", compressed size " << compress_size;
+  }
+  (void)values->insert(values->begin() + offset, compress_size, 0.0f);
+  auto compress_type = static_cast<PSCompressType>(input.compress_type());
+  if (!PSCompressor::Decompress(compress_type, input.compress_data(), values->data() + offset, compress_size)) {
+    MS_LOG(EXCEPTION) << "Decompress the pushed values of key " << input.keys()[0] << " failed.";
+  }
+}
+
 void ParameterServer::ServerHandler::HandlePullReq(const void *data, size_t size, const VectorPtr &res) {
   MS_EXCEPTION_IF_NULL(data);
   MS_EXCEPTION_IF_NULL(res);
@@ -948,7 +1646,16 @@ void ParameterServer::ServerHandler::HandlePullReq(const void *data, size_t size
   auto weight = ps_->weight(key);
   auto weight_data = weight->MutableData();
   MS_EXCEPTION_IF_NULL(weight_data);
-  *res_data.mutable_values() = {weight_data->begin(), weight_data->end()};
+  auto shard_table = ps_->embedding_shard_table(key);
+  if (shard_table != nullptr) {
+    std::unique_lock<std::mutex> lock(ps_->mutex());
+    auto row_locks = ps_->embedding_row_mutexes_.LockAll();
+    BuildPulledEmbeddingRows(*shard_table, *weight_data, &res_data);
+  } else if (input.compress_type() == static_cast<uint32_t>(PSCompressType::kDeltaQuant8Bit)) {
+    BuildPulledValues(input, key, *weight_data, &res_data);
+  } else {
+    *res_data.mutable_values() = {weight_data->begin(), weight_data->end()};
+  }
   res->resize(res_data.ByteSizeLong());
   size_t dest_size = res_data.ByteSizeLong();
   size_t src_size = res_data.ByteSizeLong();
@@ -958,6 +1665,45 @@ void ParameterServer::ServerHandler::HandlePullReq(const void *data, size_t size
   }
 }
 
+void ParameterServer::ServerHandler::BuildPulledValues(const KVMessage &input, Key key, const Values &weight,
+                                                       KVMessage *res_data) {
+  MS_EXCEPTION_IF_NULL(res_data);
+  std::pair<uint64_t, Values> *snapshot = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(pull_snapshots_mutex_);
+    snapshot = &pull_snapshots_[std::make_pair(input.rank_id(), key)];
+  }
+  // The full weight is sent if the worker lost the track of the snapshot, e.g. the first pull or a restarted worker.
+  uint64_t version = snapshot->first;
+  bool in_sync = version != 0 && input.compress_index() == version && snapshot->second.size() == weight.size();
+  uint32_t seed = static_cast<uint32_t>(version) + input.rank_id();
+  auto compress_data = res_data->mutable_compress_data();
+  if (in_sync && PSCompressor::EncodeDelta(weight.data(), weight.size(), seed, &snapshot->second, compress_data)) {
+    res_data->set_compress_type(static_cast<uint32_t>(PSCompressType::kDeltaQuant8Bit));
+  } else {
+    snapshot->second = weight;
+    res_data->clear_compress_data();
+    *res_data->mutable_values() = {weight.begin(), weight.end()};
+    res_data->set_compress_type(static_cast<uint32_t>(PSCompressType::kNoCompress));
+  }
+  snapshot->first = version + 1;
+  res_data->set_compress_index(snapshot->first);
+}
+
+void ParameterServer::ServerHandler::BuildPulledEmbeddingRows(const EmbeddingShardTable &shard_table,
+                                                              const Values &weight, KVMessage *res_data) {
+  MS_EXCEPTION_IF_NULL(res_data);
+  size_t bucket_size = weight.size() / shard_table.slot_num();
+  size_t row_size = bucket_size / shard_table.bucket_rows();
+  std::vector<float> values;
+  for (const auto &owned : shard_table.OwnedBuckets()) {
+    res_data->add_len(owned.first);
+    auto begin = weight.begin() + owned.second * bucket_size;
+    (void)values.insert(values.end(), begin, begin + shard_table.BucketRowNum(owned.first) * row_size);
+  }
+  *res_data->mutable_values() = {values.begin(), values.end()};
+}
+
 void ParameterServer::ServerHandler::HandleInitWeights(const void *data, size_t size, const VectorPtr &res) {
   std::unique_lock<std::mutex> lock(ps_->mutex());
   MS_EXCEPTION_IF_NULL(data);
@@ -1110,7 +1856,7 @@ void ParameterServer::ServerHandler::HandleEmbeddingLookup(const void *data, siz
   std::vector<Key> keys = {input.keys().begin(), input.keys().end()};
   *res_data.mutable_keys() = {input.keys().begin(), input.keys().end()};
 
-  ps_->DoEmbeddingLookup(key, keys, &res_data);
+  ps_->DoEmbeddingLookup(key, keys, input.shard_meta(), &res_data);
 
   res->resize(res_data.ByteSizeLong());
   size_t dest_size = res_data.ByteSizeLong();
@@ -1122,7 +1868,6 @@ void ParameterServer::ServerHandler::HandleEmbeddingLookup(const void *data, siz
 }
 
 void ParameterServer::ServerHandler::HandleUpdateEmbeddings(const void *data, size_t size, const VectorPtr &res) {
-  std::unique_lock<std::mutex> lock(ps_->mutex());
   MS_EXCEPTION_IF_NULL(data);
   MS_EXCEPTION_IF_NULL(res);
   KVMessage input;
@@ -1138,6 +1883,30 @@ void ParameterServer::ServerHandler::HandleFinalize(const void *, size_t, const
   ps_->Finalize();
 }
 
+void ParameterServer::ServerHandler::HandleMigrateEmbedding(const void *data, size_t size, const VectorPtr &res) {
+  MS_EXCEPTION_IF_NULL(data);
+  MS_EXCEPTION_IF_NULL(res);
+  EmbeddingShardMeta input;
+  CHECK_RETURN_TYPE(input.ParseFromArray(data, SizeToInt(size)));
+  EmbeddingShardMeta res_data;
+  ps_->MigrateEmbedding(input, &res_data);
+  res->resize(res_data.ByteSizeLong());
+  size_t dest_size = res_data.ByteSizeLong();
+  size_t src_size = res_data.ByteSizeLong();
+  int ret = memcpy_s(res->data(), dest_size, res_data.SerializeAsString().data(), src_size);
+  if (ret != 0) {
+    MS_LOG(EXCEPTION) << "The memcpy_s error, errorno(" << ret << ")";
+  }
+}
+
+void ParameterServer::ServerHandler::HandleMigrateEmbeddingRows(const void *data, size_t size, const VectorPtr &res) {
+  MS_EXCEPTION_IF_NULL(data);
+  MS_EXCEPTION_IF_NULL(res);
+  EmbeddingRowsMessage input;
+  CHECK_RETURN_TYPE(input.ParseFromArray(data, SizeToInt(size)));
+  ps_->WriteEmbeddingRows(input);
+}
+
 void ParameterServer::RecoverHandler::Init() {
   handlers_[kRecoverEmbedding] = &RecoverHandler::RecoverEmbedding;
 
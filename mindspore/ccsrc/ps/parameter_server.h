@@ -23,8 +23,11 @@
 #include <memory>
 #include <vector>
 #include <mutex>
+#include <shared_mutex>
 #include <condition_variable>
 #include <thread>
+#include <queue>
+#include <exception>
 #include <cmath>
 #include <random>
 #include <utility>
@@ -42,6 +45,7 @@
 #include "ps/optimizer_info.h"
 #include "ps/optimizer_info_builder.h"
 #include "ps/ps_context.h"
+#include "ps/ps_compressor.h"
 #include "plugin/device/cpu/hal/device/kernel_select_cpu.h"
 #include "utils/ms_context.h"
 #include "kernel/kernel.h"
@@ -58,6 +62,8 @@
 #include "ps/constants.h"
 #include "ps/util.h"
 #include "ps/embedding_table_shard_metadata.h"
+#include "ps/embedding_shard_table.h"
+#include "ps/striped_mutex.h"
 #include "utils/log_adapter.h"
 #include "proto/comm.pb.h"
 #include "proto/ps.pb.h"
@@ -67,6 +73,9 @@
 
 namespace mindspore {
 namespace ps {
+// The max number of the threads applying the optimizers, each of which owns a shard of the keys.
+constexpr size_t kMaxUpdateThreadNum = 8;
+
 class BACKEND_EXPORT ParameterServer {
  public:
   static ParameterServer &GetInstance();
@@ -106,8 +115,16 @@ class BACKEND_EXPORT ParameterServer {
     void HandleEmbeddingLookup(const void *data, size_t size, const VectorPtr &res);
     void HandleUpdateEmbeddings(const void *data, size_t size, const VectorPtr &res);
     void HandleFinalize(const void *data, size_t size, const VectorPtr &res);
+    void HandleMigrateEmbedding(const void *data, size_t size, const VectorPtr &res);
+    void HandleMigrateEmbeddingRows(const void *data, size_t size, const VectorPtr &res);
 
    private:
+    void DecompressPushedValues(const KVMessage &input, const Lengths &lens, Values *values);
+    // Fill the weight of 'key' into 'res_data', as the quantized delta to the snapshot of the worker if requested.
+    void BuildPulledValues(const KVMessage &input, Key key, const Values &weight, KVMessage *res_data);
+    // Fill the rows of the owned buckets of the consistent hash sharded table, and the buckets in 'len'.
+    void BuildPulledEmbeddingRows(const EmbeddingShardTable &shard_table, const Values &weight, KVMessage *res_data);
+
     ParameterServer *ps_;
     typedef void (ServerHandler::*RequestHandler)(const void *data, size_t size, const VectorPtr &res);
     mindspore::HashMap<int, RequestHandler> handlers_;
@@ -115,6 +132,11 @@ class BACKEND_EXPORT ParameterServer {
     mindspore::HashMap<Key, bool> init_weights_;
     mindspore::HashMap<Key, bool> init_weight_to_optim_;
     mindspore::HashMap<Key, bool> init_optim_info_;
+    // The weight snapshot and its version that each worker holds for the delta encoded pulls, keyed by the worker rank
+    // and the weight key. The snapshots differ once the workers pull at different steps, so they take worker_num times
+    // the memory of the dense weights delta pulled from this server.
+    std::mutex pull_snapshots_mutex_;
+    std::map<std::pair<uint32_t, Key>, std::pair<uint64_t, Values>> pull_snapshots_;
   };
 
   // For disaster recovery, you can customize the key-value structure that needs to be persisted, and you can customize
@@ -154,9 +176,11 @@ class BACKEND_EXPORT ParameterServer {
   bool HasWeight(const Key &key);
   void Finalize();
   void UpdateWeights();
+  void StartUpdateThreads();
+  void StopUpdateThreads();
   void AccumGrad(const Keys &key, const Values &values, const Lengths &lengths);
   WeightPtr weight(const Key &key);
-  void DoEmbeddingLookup(Key key, const LookupIds &lookup_ids, KVMessage *res);
+  void DoEmbeddingLookup(Key key, const LookupIds &lookup_ids, const EmbeddingShardMeta &shard_meta, KVMessage *res);
   void UpdateEmbeddings(const Key &key, const LookupIds &lookup_ids, const Values &vals);
   inline bool ReadyForUpdateWeights() const;
   inline bool ReadyForPush(const Key &key);
@@ -199,6 +223,73 @@ class BACKEND_EXPORT ParameterServer {
   // Ser current persistent state to server node.
   void set_persistent_state(core::PersistentState persistent_state) const;
 
+  // The shard of the consistent hash sharded embedding table of the key, nullptr for the other keys.
+  std::shared_ptr<EmbeddingShardTable> embedding_shard_table(const Key &key);
+  std::vector<std::pair<Key, std::shared_ptr<EmbeddingShardTable>>> embedding_shard_tables();
+
+  // Translate the indices of the pushed sparse gradient to the local rows of the consistent hash sharded table.
+  void ToLocalEmbeddingIndices(const Key &key, const Lengths &lengths, Values *values);
+
+  // Run a migration phase requested by the worker 0.
+  void MigrateEmbedding(const EmbeddingShardMeta &request, EmbeddingShardMeta *response);
+
+  // The pre-copy of the migrating tables, which runs in the background while the training goes on.
+  void PreCopyEmbeddingTables();
+
+  // Hand off the moved buckets once the update of the switch step - 1 is applied.
+  void HandoffEmbeddingTables();
+
+  // Wait for the buckets handed off to this server before the update of the switch step, and for the decision of the
+  // precommitted migrations before the update could pass their switch steps, with 'lock' released.
+  void WaitEmbeddingHandoffs(std::unique_lock<std::mutex> *lock);
+
+  // Send the rows of the moved buckets to their destinations, and the finished buckets if it's the handoff. Return
+  // false if a chunk can't be sent after kRetryCount retries.
+  bool SendEmbeddingRows(const Key &key, const std::shared_ptr<EmbeddingShardTable> &shard_table,
+                         const std::vector<EmbeddingBucketMove> &moves, bool handoff);
+
+  // The rows of the buckets and the received rows, with the optimizer states of the rows. The mutex_ must be held.
+  void CopyEmbeddingRows(const Key &key, const EmbeddingShardTable &shard_table, const std::vector<size_t> &buckets,
+                         EmbeddingRowsMessage *message);
+  void WriteEmbeddingRows(const EmbeddingRowsMessage &message);
+
+  // The optimizer states which have a row for each embedding row. The mutex_ must be held.
+  std::vector<float *> EmbeddingStates(const Key &key);
+  float EmbeddingStateDefault(const Key &key, const std::string &state_name);
+  size_t EmbeddingRowSize(const Key &key, const EmbeddingShardTable &shard_table);
+  void ApplyPendingEmbeddingStates(const Key &key);
+  InputsShapePtr EmbeddingInputsShape(const Key &key, const InputsShapePtr &original_inputs_shape,
+                                      const EmbeddingShardTable &shard_table);
+
+  // The optimizer of one key with its inputs, which is applied by the update thread owning the key.
+  struct UpdateTask {
+    Key key;
+    std::shared_ptr<PServerKernel> optimizer;
+    std::shared_ptr<OptimizerInfo> optim_info;
+    InputsShapePtr original_inputs_shape;
+    // The updated rows of the consistent hash sharded table are marked dirty while it's migrating, and the optimizers
+    // like the non-lazy Adam update all the rows.
+    std::shared_ptr<EmbeddingShardTable> shard_table;
+    bool update_all_rows;
+  };
+
+  // The update queue of a shard of the keys.
+  struct UpdateShard {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::queue<UpdateTask> tasks;
+    bool stop{false};
+  };
+
+  // Apply the optimizer of one key.
+  void UpdateWeight(const UpdateTask &task) const;
+
+  // Dispatch the tasks to the update queues by key and wait for them to finish.
+  void ParallelUpdateWeights(const std::vector<UpdateTask> &tasks);
+
+  // The loop of the update thread of a shard.
+  void RunUpdateShard(UpdateShard *shard);
+
   std::unique_ptr<RecoverHandler> recover_handler_;
   std::atomic_bool finish_recovery_{false};
 
@@ -232,12 +323,39 @@ class BACKEND_EXPORT ParameterServer {
   std::mutex mutex_;
   std::condition_variable apply_grads_cv_;
 
-  std::mutex access_weight_mutex_;
+  // The embedding rows are updated with the shared lock, and the persistence takes the exclusive lock.
+  std::shared_mutex access_weight_mutex_;
+  // The embedding rows of the same stripe are updated exclusively. The optimizers, the lookups, the pulls and the
+  // migration of the embedding tables lock all the stripes.
+  StripedMutex embedding_row_mutexes_;
+  std::mutex dirty_info_mutex_;
+
+  std::vector<std::unique_ptr<UpdateShard>> update_shards_;
+  std::vector<std::thread> update_threads_;
+  std::mutex update_done_mutex_;
+  std::condition_variable update_done_cv_;
+  size_t pending_update_num_{0};
+  std::exception_ptr update_exception_{nullptr};
+
   std::unique_ptr<std::thread> thread_;
   std::unique_ptr<std::thread> persist_thread_;
   std::shared_ptr<core::PSServerNode> server_node_;
   std::map<Key, ParameterPtr> embedding_tables_;
 
+  // The consistent hash sharded embedding tables and the number of the updates applied, which is the push step the
+  // migrations switch at.
+  std::mutex shard_tables_mutex_;
+  mindspore::HashMap<Key, std::shared_ptr<EmbeddingShardTable>> embedding_shard_tables_;
+  mindspore::HashMap<Key, InputsShapePtr> embedding_inputs_shape_;
+  std::atomic<uint64_t> update_step_{0};
+  // Notified with the mutex_ held when the handed off buckets are received or a precommitted migration is decided.
+  std::condition_variable embedding_migration_cv_;
+  // The pre-copy and the handoff of the migrated rows are serialized.
+  std::mutex migrate_mutex_;
+  std::unique_ptr<std::thread> migrate_thread_{nullptr};
+  // The optimizer states of the received rows before the optimizer info of the key is built, keyed by the local slot.
+  std::map<Key, std::map<size_t, std::vector<float>>> pending_embedding_states_;
+
   friend class ServerHandler;
 };
 }  // namespace ps
@@ -15,9 +15,192 @@
  */
 
 #include "ps/ps_cache/embedding_hash_map.h"
+#include <algorithm>
 
 namespace mindspore {
 namespace ps {
+namespace {
+constexpr size_t kGroupSize = 8;
+constexpr size_t kTagBits = 7;
+constexpr uint8_t kEmptyTag = 0x80;
+constexpr uint8_t kDeletedTag = 0xFE;
+constexpr uint64_t kLowBits = 0x0101010101010101ULL;
+constexpr uint64_t kHighBits = 0x8080808080808080ULL;
+// The max load factor of the table is 7/8.
+constexpr size_t kMaxLoadNumerator = 7;
+constexpr size_t kMaxLoadDenominator = 8;
+
+size_t HashId(int id) {
+  auto hash = static_cast<uint64_t>(static_cast<uint32_t>(id)) * 0x9E3779B97F4A7C15ULL;
+  return static_cast<size_t>(hash ^ (hash >> 32));
+}
+
+uint8_t GetTag(size_t hash) { return static_cast<uint8_t>(hash & ((1U << kTagBits) - 1)); }
+
+// The bit 7 of every byte which equals to the tag is set, a byte next to a matched byte may be set falsely, which is
+// filtered by comparing the ids.
+uint64_t MatchTag(uint64_t group, uint8_t tag) {
+  auto value = group ^ (kLowBits * tag);
+  return (value - kLowBits) & ~value & kHighBits;
+}
+
+uint64_t MatchEmpty(uint64_t group) { return MatchTag(group, kEmptyTag); }
+
+// The empty and deleted tags are the only tags whose bit 7 is set.
+uint64_t MatchEmptyOrDeleted(uint64_t group) { return group & kHighBits; }
+
+size_t LowestMatchedByte(uint64_t mask) {
+#ifdef _MSC_VER
+  size_t byte = 0;
+  while ((mask & 0xFF) == 0) {
+    mask >>= kGroupSize;
+    ++byte;
+  }
+  return byte;
+#else
+  return static_cast<size_t>(__builtin_ctzll(mask)) / kGroupSize;
+#endif
+}
+
+uint8_t GetSlotTag(const std::vector<uint64_t> &tag_groups, size_t slot) {
+  return static_cast<uint8_t>(tag_groups[slot / kGroupSize] >> ((slot % kGroupSize) * kGroupSize));
+}
+
+void SetSlotTag(std::vector<uint64_t> *tag_groups, size_t slot, uint8_t tag) {
+  auto shift = (slot % kGroupSize) * kGroupSize;
+  auto &group = (*tag_groups)[slot / kGroupSize];
+  group = (group & ~(0xFFULL << shift)) | (static_cast<uint64_t>(tag) << shift);
+}
+}  // namespace
+
+IdIndexTable::IdIndexTable(size_t capacity) {
+  size_t group_num = 1;
+  while (group_num * kGroupSize * kMaxLoadNumerator < capacity * kMaxLoadDenominator) {
+    group_num <<= 1;
+  }
+  Rehash(group_num);
+}
+
+bool IdIndexTable::FindSlot(int id, size_t hash, size_t *slot) const {
+  auto tag = GetTag(hash);
+  auto group_index = (hash >> kTagBits) & group_mask_;
+  bool has_insert_slot = false;
+  // Probe the groups quadratically, which visits all groups since the group number is a power of two.
+  for (size_t step = 1; step <= group_mask_ + 1; ++step) {
+    auto group = tag_groups_[group_index];
+    for (auto matched = MatchTag(group, tag); matched != 0; matched &= matched - 1) {
+      auto candidate = group_index * kGroupSize + LowestMatchedByte(matched);
+      if (ids_[candidate] == id && GetSlotTag(tag_groups_, candidate) == tag) {
+        *slot = candidate;
+        return true;
+      }
+    }
+    auto free_slots = MatchEmptyOrDeleted(group);
+    if (!has_insert_slot && free_slots != 0) {
+      *slot = group_index * kGroupSize + LowestMatchedByte(free_slots);
+      has_insert_slot = true;
+    }
+    // The id is not in the table if the probing meets an empty slot.
+    if (MatchEmpty(group) != 0) {
+      return false;
+    }
+    group_index = (group_index + step) & group_mask_;
+  }
+  return false;
+}
+
+bool IdIndexTable::Find(int id, int *index) const {
+  MS_EXCEPTION_IF_NULL(index);
+  size_t slot = 0;
+  if (!FindSlot(id, HashId(id), &slot)) {
+    return false;
+  }
+  *index = indexes_[slot];
+  return true;
+}
+
+void IdIndexTable::Insert(int id, int index) {
+  if ((size_ + deleted_size_ + 1) * kMaxLoadDenominator > tag_groups_.size() * kGroupSize * kMaxLoadNumerator) {
+    // Grow the table if it is crowded by the ids, otherwise clean the deleted slots.
+    auto group_num = tag_groups_.size();
+    if ((size_ + 1) * kMaxLoadDenominator * 2 > group_num * kGroupSize * kMaxLoadNumerator) {
+      group_num <<= 1;
+    }
+    Rehash(group_num);
+  }
+  auto hash = HashId(id);
+  size_t slot = 0;
+  if (FindSlot(id, hash, &slot)) {
+    MS_LOG(EXCEPTION) << "The id " << id << " is already in the table.";
+  }
+  if (GetSlotTag(tag_groups_, slot) == kDeletedTag) {
+    --deleted_size_;
+  }
+  SetSlotTag(&tag_groups_, slot, GetTag(hash));
+  ids_[slot] = id;
+  indexes_[slot] = index;
+  ++size_;
+}
+
+bool IdIndexTable::Erase(int id) {
+  size_t slot = 0;
+  if (!FindSlot(id, HashId(id), &slot)) {
+    return false;
+  }
+  SetSlotTag(&tag_groups_, slot, kDeletedTag);
+  --size_;
+  ++deleted_size_;
+  return true;
+}
+
+void IdIndexTable::ForEach(const std::function<void(int, int)> &func) const {
+  for (size_t slot = 0; slot < ids_.size(); ++slot) {
+    auto tag = GetSlotTag(tag_groups_, slot);
+    if (tag != kEmptyTag && tag != kDeletedTag) {
+      func(ids_[slot], indexes_[slot]);
+    }
+  }
+}
+
+void IdIndexTable::Rehash(size_t group_num) {
+  auto old_tag_groups = std::move(tag_groups_);
+  auto old_ids = std::move(ids_);
+  auto old_indexes = std::move(indexes_);
+  tag_groups_.assign(group_num, kLowBits * kEmptyTag);
+  ids_.assign(group_num * kGroupSize, INVALID_INDEX_VALUE);
+  indexes_.assign(group_num * kGroupSize, INVALID_INDEX_VALUE);
+  group_mask_ = group_num - 1;
+  size_ = 0;
+  deleted_size_ = 0;
+  for (size_t slot = 0; slot < old_ids.size(); ++slot) {
+    auto tag = GetSlotTag(old_tag_groups, slot);
+    if (tag == kEmptyTag || tag == kDeletedTag) {
+      continue;
+    }
+    auto hash = HashId(old_ids[slot]);
+    size_t new_slot = 0;
+    (void)FindSlot(old_ids[slot], hash, &new_slot);
+    SetSlotTag(&tag_groups_, new_slot, GetTag(hash));
+    ids_[new_slot] = old_ids[slot];
+    indexes_[new_slot] = old_indexes[slot];
+    ++size_;
+  }
+}
+
+size_t EmbeddingHashMap::hash_id_count() const {
+  size_t count = 0;
+  for (const auto &shard : id_index_shards_) {
+    count += shard.size();
+  }
+  return count;
+}
+
+void EmbeddingHashMap::ForEachHashId(const std::function<void(int, int)> &func) const {
+  for (const auto &shard : id_index_shards_) {
+    shard.ForEach(func);
+  }
+}
+
 int EmbeddingHashMap::ParseData(const int id, int *const swap_out_index, int *const swap_out_ids,
                                 const size_t data_step, const size_t graph_running_step, size_t *const swap_out_size,
                                 bool *const need_wait_graph) {
@@ -30,21 +213,24 @@ int EmbeddingHashMap::ParseData(const int id, int *const swap_out_index, int *co
     return hash_index;
   }
 
+  auto &element = hash_map_elements_[hash_index];
   if (!need_swap) {
     hash_count_++;
-    (void)hash_id_to_index_.emplace(id, hash_index);
-    hash_map_elements_[hash_index].set_id(id);
-    hash_map_elements_[hash_index].set_step(data_step);
+    id_index_shards_[GetShard(id)].Insert(id, hash_index);
+    element.set_id(id);
+    element.set_step(data_step);
+    element.frequency_ = 0;
     return hash_index;
   }
 
   swap_out_index[*swap_out_size] = hash_index;
-  swap_out_ids[*swap_out_size] = hash_map_elements_[hash_index].id_;
+  swap_out_ids[*swap_out_size] = element.id_;
   (*swap_out_size)++;
-  (void)hash_id_to_index_.erase(hash_map_elements_[hash_index].id_);
-  (void)hash_id_to_index_.emplace(id, hash_index);
-  hash_map_elements_[hash_index].set_id(id);
-  hash_map_elements_[hash_index].set_step(data_step);
+  (void)id_index_shards_[GetShard(element.id_)].Erase(element.id_);
+  id_index_shards_[GetShard(id)].Insert(id, hash_index);
+  element.set_id(id);
+  element.set_step(data_step);
+  element.frequency_ = 0;
   return hash_index;
 }
 
@@ -53,14 +239,23 @@ int EmbeddingHashMap::FindInsertionPos(const size_t, const size_t graph_running_
   MS_EXCEPTION_IF_NULL(need_swap);
   MS_EXCEPTION_IF_NULL(need_wait_graph);
   int hash_index = INVALID_INDEX_VALUE;
+  // Whether this scan passed over frequent ids, it is local to the scan so no decay leaks into the next one.
+  bool frequency_decayed = false;
   while (!expired_element_full_) {
-    if (hash_map_elements_[current_pos_].IsEmpty()) {
+    auto &element = hash_map_elements_[current_pos_];
+    if (element.IsEmpty()) {
       hash_index = current_pos_;
       hash_count_++;
-    } else if (hash_map_elements_[current_pos_].IsExpired(graph_running_step)) {
-      hash_index = current_pos_;
-      *need_swap = true;
-    } else if (hash_map_elements_[current_pos_].IsStep(graph_running_step)) {
+    } else if (element.IsExpired(graph_running_step)) {
+      // The frequent id is passed over with its frequency halved, it is evicted in a later round if it keeps unused.
+      if (element.frequency_ == 0) {
+        hash_index = current_pos_;
+        *need_swap = true;
+      } else {
+        element.frequency_ >>= 1;
+        frequency_decayed = true;
+      }
+    } else if (element.IsStep(graph_running_step)) {
       graph_running_index_[graph_running_index_num_++] = current_pos_;
     }
     current_pos_ = (current_pos_ + 1) % hash_capacity_;
@@ -68,6 +263,12 @@ int EmbeddingHashMap::FindInsertionPos(const size_t, const size_t graph_running_
       return hash_index;
     }
     if (current_pos_ == current_batch_start_pos_) {
+      // Scan another round since the passed over ids become evictable, the frequency reaches 0 in 8 rounds.
+      if (frequency_decayed) {
+        frequency_decayed = false;
+        graph_running_index_num_ = 0;
+        continue;
+      }
       expired_element_full_ = true;
       MS_LOG(INFO) << "Running step:" << graph_running_step << "(num:" << graph_running_index_num_
                    << ") will be used, index swap will wait until the graph completed.";
@@ -85,14 +286,13 @@ int EmbeddingHashMap::FindInsertionPos(const size_t, const size_t graph_running_
 void EmbeddingHashMap::DumpHashMap() {
   MS_LOG(INFO) << "Dump hash map info begin, hash_capacity: " << hash_capacity_ << " hash_count: " << hash_count_;
   MS_LOG(INFO) << "Dump hash_id_to_index: ";
-  for (auto iter = hash_id_to_index_.begin(); iter != hash_id_to_index_.end(); ++iter) {
-    MS_LOG(INFO) << "  id: " << iter->first << " index: " << iter->second;
-  }
+  ForEachHashId([](int id, int index) { MS_LOG(INFO) << "  id: " << id << " index: " << index; });
   MS_LOG(INFO) << "Dump hash_map_unit: ";
   for (size_t i = 0; i < hash_map_elements_.size(); i++) {
     if (!hash_map_elements_[i].IsEmpty()) {
       MS_LOG(INFO) << "  index: " << i << " id: " << hash_map_elements_[i].id_
-                   << " step: " << hash_map_elements_[i].step_;
+                   << " step: " << hash_map_elements_[i].step_
+                   << " frequency: " << static_cast<size_t>(hash_map_elements_[i].frequency_);
     }
   }
   MS_LOG(INFO) << "Dump hash map info end.";
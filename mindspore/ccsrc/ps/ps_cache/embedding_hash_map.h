@@ -21,6 +21,7 @@
 #include <utility>
 #include <memory>
 #include <vector>
+#include <functional>
 #include "utils/hash_map.h"
 #include "utils/convert_utils_base.h"
 
@@ -28,10 +29,13 @@ namespace mindspore {
 namespace ps {
 static const size_t INVALID_STEP_VALUE = 0;
 static const int INVALID_INDEX_VALUE = -1;
+static const uint8_t MAX_FREQUENCY_VALUE = UINT8_MAX;
 
 struct HashMapElement {
   int id_{INVALID_INDEX_VALUE};
   size_t step_{INVALID_STEP_VALUE};
+  // The number of steps which use the id, it is halved when the element is passed over by the eviction.
+  uint8_t frequency_{0};
   bool IsEmpty() const { return step_ == INVALID_STEP_VALUE; }
   bool IsExpired(size_t graph_running_step) const { return graph_running_step > step_; }
   bool IsStep(size_t step) const { return step_ == step; }
@@ -39,7 +43,40 @@ struct HashMapElement {
   void set_step(size_t step) { step_ = step; }
 };
 
+// The open addressing table which maps the ids to the hash indexes. The slots are probed by groups of 8, and the 7-bit
+// tags of a group are compared at once by the bit operations on a 64-bit word, so the ids are only compared for the
+// matched tags.
+class IdIndexTable {
+ public:
+  explicit IdIndexTable(size_t capacity);
+  ~IdIndexTable() = default;
+
+  bool Find(int id, int *index) const;
+  // The id must not be in the table.
+  void Insert(int id, int index);
+  bool Erase(int id);
+  size_t size() const { return size_; }
+  void ForEach(const std::function<void(int, int)> &func) const;
+
+ private:
+  // Find the slot of the id, or the slot to insert the id if it is not found.
+  bool FindSlot(int id, size_t hash, size_t *slot) const;
+  void Rehash(size_t group_num);
+
+  // The tags of slots, 8 tags per group.
+  std::vector<uint64_t> tag_groups_;
+  std::vector<int> ids_;
+  std::vector<int> indexes_;
+  size_t group_mask_{0};
+  size_t size_{0};
+  size_t deleted_size_{0};
+};
+
 // Hash table is held in device, HashMap is used to manage hash table in host.
+// The ids are mapped to the hash indexes by the shards of IdIndexTable, and the ids of different shards can be looked
+// up by different threads. The positions of hash table are scanned circularly for the insertion, the empty position or
+// the expired position of an infrequent id is taken, and the frequency of a passed over id is halved, so the frequent
+// ids stay in the cache longer than the ids which are used once.
 class EmbeddingHashMap {
  public:
   EmbeddingHashMap(size_t hash_count, size_t hash_capacity)
@@ -57,26 +94,44 @@ class EmbeddingHashMap {
     hash_map_elements_.front().set_step(SIZE_MAX);
     hash_map_elements_.back().set_step(SIZE_MAX);
     graph_running_index_ = std::make_unique<int[]>(hash_capacity);
+    for (size_t i = 0; i < kShardNum; ++i) {
+      (void)id_index_shards_.emplace_back(hash_capacity / kShardNum);
+    }
   }
   virtual ~EmbeddingHashMap() = default;
   int ParseData(const int id, int *const swap_out_index, int *const swap_out_ids, const size_t data_step,
                 const size_t graph_running_step, size_t *const swap_out_size, bool *const need_wait_graph);
   size_t hash_step(const int hash_index) const { return hash_map_elements_[IntToSize(hash_index)].step_; }
+  // Set the step of a cached id when it is used by a new step.
   void set_hash_step(const int hash_index, const size_t step) {
-    hash_map_elements_[IntToSize(hash_index)].set_step(step);
+    auto &element = hash_map_elements_[IntToSize(hash_index)];
+    element.set_step(step);
+    if (element.frequency_ < MAX_FREQUENCY_VALUE) {
+      ++element.frequency_;
+    }
   }
-  const mindspore::HashMap<int, int> &hash_id_to_index() const { return hash_id_to_index_; }
+  // Find the hash index of the id. The ids of different shards can be found in parallel, and so can set_hash_step of
+  // the found indexes.
+  bool GetHashIndex(const int id, int *const hash_index) const {
+    return id_index_shards_[GetShard(id)].Find(id, hash_index);
+  }
+  size_t hash_id_count() const;
+  // Visit the ids and their hash indexes.
+  void ForEachHashId(const std::function<void(int, int)> &func) const;
+  static size_t GetShard(const int id) { return static_cast<size_t>(static_cast<uint32_t>(id)) % kShardNum; }
   size_t hash_capacity() const { return hash_capacity_; }
   void DumpHashMap();
   void Reset();
 
+  static constexpr size_t kShardNum = 16;
+
  private:
   int FindInsertionPos(const size_t data_step, const size_t graph_running_step, bool *const need_swap,
                        bool *const need_wait_graph);
   size_t hash_count_;
   size_t hash_capacity_;
   std::vector<HashMapElement> hash_map_elements_;
-  mindspore::HashMap<int, int> hash_id_to_index_;
+  std::vector<IdIndexTable> id_index_shards_;
   size_t current_pos_;
   size_t current_batch_start_pos_;
   size_t graph_running_index_num_;
@@ -0,0 +1,206 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ps/ps_cache/embedding_swap_pipeline.h"
+#include <algorithm>
+#include <utility>
+#include "utils/log_adapter.h"
+#include "include/common/thread_pool.h"
+
+namespace mindspore {
+namespace ps {
+EmbeddingSwapPipeline::EmbeddingSwapPipeline(const PushFunc &push_func, const PullFunc &pull_func,
+                                             size_t window_size)
+    : push_func_(push_func), pull_func_(pull_func), window_size_(std::max(window_size, static_cast<size_t>(1))) {
+  push_thread_ = std::thread(&EmbeddingSwapPipeline::PushLoop, this);
+  pull_thread_ = std::thread(&EmbeddingSwapPipeline::PullLoop, this);
+}
+
+EmbeddingSwapPipeline::~EmbeddingSwapPipeline() { Stop(); }
+
+bool EmbeddingSwapPipeline::PushAsync(size_t step, size_t key, std::vector<int> &&ids, std::vector<float> &&values) {
+  if (ids.empty()) {
+    return true;
+  }
+  std::unique_lock<std::mutex> locker(mutex_);
+  finish_cond_var_.wait(locker, [this, step]() {
+    return push_failed_ || stopped_ || pending_step_push_num_.size() < window_size_ ||
+           pending_step_push_num_.count(step) != 0;
+  });
+  if (push_failed_ || stopped_) {
+    MS_LOG(ERROR) << "The embedding swap pipeline is " << (stopped_ ? "stopped." : "failed.");
+    return false;
+  }
+  ++pending_step_push_num_[step];
+  auto &key_pending_ids = pending_ids_[key];
+  for (const auto id : ids) {
+    ++key_pending_ids[id];
+  }
+  push_tasks_.push({step, key, std::move(ids), std::move(values)});
+  push_cond_var_.notify_one();
+  return true;
+}
+
+std::future<bool> EmbeddingSwapPipeline::PullAsync(size_t key, std::vector<int> &&ids, std::vector<float> *values) {
+  if (ids.empty()) {
+    std::promise<bool> promise;
+    promise.set_value(true);
+    return promise.get_future();
+  }
+  std::lock_guard<std::mutex> locker(mutex_);
+  if (stopped_) {
+    std::promise<bool> promise;
+    promise.set_value(false);
+    return promise.get_future();
+  }
+  PullTask task;
+  task.key_ = key;
+  task.ids_ = std::move(ids);
+  task.values_ = values;
+  auto future = task.promise_.get_future();
+  pull_tasks_.push_back(std::move(task));
+  pull_cond_var_.notify_one();
+  return future;
+}
+
+bool EmbeddingSwapPipeline::WaitPushFinished() {
+  std::unique_lock<std::mutex> locker(mutex_);
+  finish_cond_var_.wait(locker, [this]() { return push_failed_ || stopped_ || pending_step_push_num_.empty(); });
+  return !push_failed_ && pending_step_push_num_.empty();
+}
+
+void EmbeddingSwapPipeline::Stop() {
+  {
+    std::lock_guard<std::mutex> locker(mutex_);
+    if (stopped_) {
+      return;
+    }
+    stopped_ = true;
+  }
+  push_cond_var_.notify_all();
+  finish_cond_var_.notify_all();
+  pull_cond_var_.notify_all();
+  if (push_thread_.joinable()) {
+    push_thread_.join();
+  }
+  if (pull_thread_.joinable()) {
+    pull_thread_.join();
+  }
+}
+
+void EmbeddingSwapPipeline::PushLoop() {
+  while (true) {
+    PushTask task;
+    {
+      std::unique_lock<std::mutex> locker(mutex_);
+      push_cond_var_.wait(locker, [this]() { return stopped_ || !push_tasks_.empty(); });
+      if (stopped_) {
+        if (!push_tasks_.empty()) {
+          MS_LOG(WARNING) << "The embedding swap pipeline is stopped with " << push_tasks_.size()
+                          << " unfinished pushes.";
+        }
+        return;
+      }
+      task = std::move(push_tasks_.front());
+      push_tasks_.pop();
+    }
+
+    bool success = false;
+    try {
+      success = push_func_(task.key_, task.ids_, task.values_);
+    } catch (const std::exception &e) {
+      MS_LOG(ERROR) << "Push the embeddings of key " << task.key_ << " failed: " << e.what();
+    }
+    FinishPushTask(task, success);
+  }
+}
+
+void EmbeddingSwapPipeline::PullLoop() {
+  while (true) {
+    std::vector<PullTask> tasks;
+    {
+      std::unique_lock<std::mutex> locker(mutex_);
+      pull_cond_var_.wait(locker, [this]() { return stopped_ || !pull_tasks_.empty(); });
+      tasks.swap(pull_tasks_);
+      if (stopped_) {
+        for (auto &task : tasks) {
+          task.promise_.set_value(false);
+        }
+        return;
+      }
+    }
+
+    // The lookups of the hash tables queued together run concurrently.
+    std::vector<common::Task> pull_tasks;
+    for (auto &task : tasks) {
+      (void)pull_tasks.emplace_back([this, &task]() {
+        task.promise_.set_value(Pull(task));
+        return common::SUCCESS;
+      });
+    }
+    (void)common::ThreadPool::GetInstance().SyncRun(pull_tasks);
+  }
+}
+
+bool EmbeddingSwapPipeline::Pull(const PullTask &task) {
+  {
+    std::unique_lock<std::mutex> locker(mutex_);
+    finish_cond_var_.wait(locker, [this, &task]() {
+      return push_failed_ || stopped_ || !HasPendingId(task.key_, task.ids_);
+    });
+    if (push_failed_ || stopped_) {
+      return false;
+    }
+  }
+  try {
+    return pull_func_(task.key_, task.ids_, task.values_);
+  } catch (const std::exception &e) {
+    MS_LOG(ERROR) << "Lookup the embeddings of key " << task.key_ << " failed: " << e.what();
+  }
+  return false;
+}
+
+void EmbeddingSwapPipeline::FinishPushTask(const PushTask &task, bool success) {
+  {
+    std::lock_guard<std::mutex> locker(mutex_);
+    auto step_iter = pending_step_push_num_.find(task.step_);
+    if (step_iter != pending_step_push_num_.end() && --step_iter->second == 0) {
+      (void)pending_step_push_num_.erase(step_iter);
+    }
+    auto &key_pending_ids = pending_ids_[task.key_];
+    for (const auto id : task.ids_) {
+      auto id_iter = key_pending_ids.find(id);
+      if (id_iter != key_pending_ids.end() && --id_iter->second == 0) {
+        (void)key_pending_ids.erase(id_iter);
+      }
+    }
+    if (!success) {
+      MS_LOG(ERROR) << "Push the embeddings of key " << task.key_ << " in step " << task.step_ << " failed.";
+      push_failed_ = true;
+    }
+  }
+  finish_cond_var_.notify_all();
+}
+
+bool EmbeddingSwapPipeline::HasPendingId(size_t key, const std::vector<int> &ids) const {
+  auto iter = pending_ids_.find(key);
+  if (iter == pending_ids_.end() || iter->second.empty()) {
+    return false;
+  }
+  return std::any_of(ids.begin(), ids.end(), [&iter](int id) { return iter->second.count(id) != 0; });
+}
+}  // namespace ps
+}  // namespace mindspore
@@ -0,0 +1,100 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_PS_PS_CACHE_EMBEDDING_SWAP_PIPELINE_H_
+#define MINDSPORE_CCSRC_PS_PS_CACHE_EMBEDDING_SWAP_PIPELINE_H_
+
+#include <map>
+#include <queue>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <future>
+#include <functional>
+#include <condition_variable>
+#include "utils/hash_map.h"
+
+namespace mindspore {
+namespace ps {
+// The pipeline of the embedding swap between the host cache and the parameter server. The evicted embeddings are
+// pushed to the server by a background thread in order, and the pushes of several steps can be in flight, so the
+// training step doesn't wait for the server updates. The lookup from the server runs concurrently with the device
+// swap, and only waits for the in flight pushes of the same ids to make sure the latest embeddings are read. The
+// lookups are queued to a background thread, which runs the queued lookups of all the hash tables in the common
+// thread pool.
+class EmbeddingSwapPipeline {
+ public:
+  using PushFunc = std::function<bool(size_t key, const std::vector<int> &ids, const std::vector<float> &values)>;
+  using PullFunc = std::function<bool(size_t key, const std::vector<int> &ids, std::vector<float> *values)>;
+
+  // The window_size is the max number of steps whose pushes are in flight.
+  EmbeddingSwapPipeline(const PushFunc &push_func, const PullFunc &pull_func, size_t window_size);
+  ~EmbeddingSwapPipeline();
+
+  // Queue the push of the ids and values, which blocks if the pushes of window_size earlier steps are not finished.
+  bool PushAsync(size_t step, size_t key, std::vector<int> &&ids, std::vector<float> &&values);
+  // Queue the lookup of the ids from the server, which starts after the in flight pushes of these ids finish, the
+  // values are ready when the returned future is ready.
+  std::future<bool> PullAsync(size_t key, std::vector<int> &&ids, std::vector<float> *values);
+  // Wait for all the queued pushes, return false if any push failed.
+  bool WaitPushFinished();
+  void Stop();
+
+  size_t window_size() const { return window_size_; }
+
+ private:
+  struct PushTask {
+    size_t step_{0};
+    size_t key_{0};
+    std::vector<int> ids_;
+    std::vector<float> values_;
+  };
+
+  struct PullTask {
+    size_t key_{0};
+    std::vector<int> ids_;
+    std::vector<float> *values_{nullptr};
+    std::promise<bool> promise_;
+  };
+
+  void PushLoop();
+  void PullLoop();
+  bool Pull(const PullTask &task);
+  void FinishPushTask(const PushTask &task, bool success);
+  bool HasPendingId(size_t key, const std::vector<int> &ids) const;
+
+  PushFunc push_func_;
+  PullFunc pull_func_;
+  size_t window_size_;
+
+  std::mutex mutex_;
+  std::condition_variable push_cond_var_;
+  std::condition_variable finish_cond_var_;
+  std::condition_variable pull_cond_var_;
+  std::queue<PushTask> push_tasks_;
+  std::vector<PullTask> pull_tasks_;
+  // The number of unfinished pushes of each step.
+  std::map<size_t, size_t> pending_step_push_num_;
+  // The reference count of the ids in the unfinished pushes of each key.
+  std::map<size_t, mindspore::HashMap<int, size_t>> pending_ids_;
+  bool push_failed_{false};
+  bool stopped_{false};
+  std::thread push_thread_;
+  std::thread pull_thread_;
+};
+}  // namespace ps
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_PS_PS_CACHE_EMBEDDING_SWAP_PIPELINE_H_
@@ -22,6 +22,11 @@
 using mindspore::kernel::Address;
 namespace mindspore {
 namespace ps {
+namespace {
+// The default max number of steps whose embedding pushes to the parameter server are in flight.
+constexpr size_t kDefaultSwapStepNum = 2;
+}  // namespace
+
 void PsCacheManager::InsertHashTableSize(const std::string &param_name, size_t cache_vocab_size, size_t embedding_size,
                                          size_t vocab_size) {
   if (cache_vocab_size == 0 || embedding_size == 0 || vocab_size == 0) {
@@ -161,6 +166,7 @@ void PsCacheManager::Initialize() {
   AddEmbeddingTable();
   AllocMemForHashTable();
   SetLocalIdRank();
+  InitSwapPipeline();
   DumpHashTables();
   initialized_ps_cache_ = true;
 }
@@ -255,6 +261,27 @@ void PsCacheManager::AllocMemForHashTable() {
   MS_EXCEPTION_IF_NULL(embedding_device_cache_->hash_swap_value_addr_);
 }
 
+void PsCacheManager::InitSwapPipeline() {
+  size_t swap_step_num = kDefaultSwapStepNum;
+  const auto swap_step_num_env = common::GetEnv(kEnvPsCacheSwapStepNum);
+  if (!swap_step_num_env.empty()) {
+    auto value = std::strtol(swap_step_num_env.c_str(), nullptr, kBase);
+    if (value <= 0) {
+      MS_LOG(EXCEPTION) << "The value of " << kEnvPsCacheSwapStepNum << " should be positive, but got "
+                        << swap_step_num_env;
+    }
+    swap_step_num = LongToSize(value);
+  }
+  auto push_func = [](size_t key, const std::vector<int> &ids, const std::vector<float> &values) {
+    return Worker::GetInstance().UpdateEmbeddingTable({key}, ids, values);
+  };
+  auto pull_func = [](size_t key, const std::vector<int> &ids, std::vector<float> *values) {
+    return Worker::GetInstance().DoPSEmbeddingLookup(key, ids, values, mindspore::ps::kEmbeddingLookupCmd);
+  };
+  swap_pipeline_ = std::make_unique<EmbeddingSwapPipeline>(push_func, pull_func, swap_step_num);
+  MS_LOG(INFO) << "The embeddings of at most " << swap_step_num << " steps are swapped to the server asynchronously.";
+}
+
 void PsCacheManager::SetLocalIdRank() {
   auto worker_num = PSContext::instance()->initial_worker_num();
   if (worker_num > 0) {
@@ -370,6 +397,9 @@ void PsCacheManager::Finalize() {
   }
 
   SyncEmbeddingTable();
+  if (swap_pipeline_ != nullptr) {
+    swap_pipeline_->Stop();
+  }
 
   running_ = false;
   PsDataPrefetch::GetInstance().NotifyFinalize();
@@ -418,13 +448,27 @@ bool PsCacheManager::ProcessData() {
     MS_LOG(ERROR) << "Ps cache wait graph finish failed.";
     return false;
   }
+  // Queue the pushes of the evicted embeddings and start the lookups from the server of all the hash tables, then
+  // the server communication is overlapped with the device swap out. The host cache indices of the lookup and the
+  // device swap out are different in one step.
+  std::vector<std::vector<float>> lookup_results(hash_tables_.size());
+  std::vector<std::future<bool>> lookup_futures;
   for (const auto &item : hash_tables_) {
     auto key = Worker::GetInstance().GetParamKey(item.first);
-    auto hash_info = item.second;
+    const auto &hash_info = item.second;
     RETURN_IF_FALSE_WITH_LOG(HashSwapHostToServer(key, hash_info), "HashSwapHostToServer failed.");
+    (void)lookup_futures.emplace_back(
+      HashLookupFromServer(key, hash_info, &lookup_results[lookup_futures.size()]));
+  }
+  size_t table_index = 0;
+  for (const auto &item : hash_tables_) {
+    const auto &hash_info = item.second;
     RETURN_IF_FALSE_WITH_LOG(HashSwapDeviceToHost(hash_info), "HashSwapDeviceToHost failed.");
-    RETURN_IF_FALSE_WITH_LOG(HashSwapServerToHost(key, hash_info), "HashSwapServerToHost failed.");
+    RETURN_IF_FALSE_WITH_LOG(
+      HashSwapServerToHost(hash_info, &lookup_futures[table_index], lookup_results[table_index]),
+      "HashSwapServerToHost failed.");
     RETURN_IF_FALSE_WITH_LOG(HashSwapHostToDevice(hash_info), "HashSwapHostToDevice failed.");
+    ++table_index;
   }
   size_t dest_len = data_size;
   // Replace the batch_ids by hash index for getNext-op getting hash index as input.
@@ -446,7 +490,8 @@ bool PsCacheManager::ProcessData() {
 }
 
 bool PsCacheManager::CheckCacheHitOrOutRangeTask(const int *batch_ids, const size_t batch_ids_len, int *hash_index,
-                                                 bool *in_device, bool *out_range, size_t *hash_hit_count) {
+                                                 bool *in_device, bool *out_range, size_t *hash_hit_count,
+                                                 size_t thread_id, size_t thread_num) {
   MS_ERROR_IF_NULL(batch_ids);
   MS_ERROR_IF_NULL(hash_index);
   MS_ERROR_IF_NULL(in_device);
@@ -454,9 +499,12 @@ bool PsCacheManager::CheckCacheHitOrOutRangeTask(const int *batch_ids, const siz
   MS_ERROR_IF_NULL(embedding_device_cache_);
   auto &device_hash_map = embedding_device_cache_->device_hash_map_;
   MS_ERROR_IF_NULL(device_hash_map);
-  const auto &hash_id_to_index = device_hash_map->hash_id_to_index();
 
   for (size_t i = 0; i < batch_ids_len; ++i) {
+    // The ids of a shard are checked by one thread, so the same id is never updated by different threads.
+    if (EmbeddingHashMap::GetShard(batch_ids[i]) % thread_num != thread_id) {
+      continue;
+    }
     if (batch_ids[i] < emb_table_slice_bounds_.first) {
       hash_index[i] = batch_ids[i] - emb_table_slice_bounds_.first + cache_indices_bounds_.first;
       out_range[i] = true;
@@ -467,12 +515,12 @@ bool PsCacheManager::CheckCacheHitOrOutRangeTask(const int *batch_ids, const siz
       out_range[i] = true;
       continue;
     }
-    auto iter = hash_id_to_index.find(batch_ids[i]);
-    if (iter != hash_id_to_index.end()) {
-      hash_index[i] = iter->second + cache_indices_bounds_.first;
-      if (device_hash_map->hash_step(iter->second) != data_step_) {
+    int index = INVALID_INDEX_VALUE;
+    if (device_hash_map->GetHashIndex(batch_ids[i], &index)) {
+      hash_index[i] = index + cache_indices_bounds_.first;
+      if (device_hash_map->hash_step(index) != data_step_) {
         ++(*hash_hit_count);
-        device_hash_map->set_hash_step(iter->second, data_step_);
+        device_hash_map->set_hash_step(index, data_step_);
       }
       in_device[i] = true;
     }
@@ -489,29 +537,18 @@ bool PsCacheManager::CheckCacheHitOrOutRange(const int *batch_ids, const size_t
 
   size_t thread_num = batch_ids_len / kMaxIdsPerThread + 1;
   thread_num = thread_num > kMaxThreadNum ? kMaxThreadNum : thread_num;
+  thread_num = thread_num > EmbeddingHashMap::kShardNum ? EmbeddingHashMap::kShardNum : thread_num;
   std::thread threads[kMaxThreadNum];
   size_t hash_hit_count[kMaxThreadNum] = {0};
-  size_t i = 0;
-  size_t task_offset = 0;
-
-  for (; i < thread_num; ++i) {
-    if (task_offset >= batch_ids_len) {
-      break;
-    }
-    size_t task_proc_lens = batch_ids_len / thread_num + (i < (batch_ids_len % thread_num) ? 1 : 0);
-    threads[i] =
-      std::thread(&PsCacheManager::CheckCacheHitOrOutRangeTask, this, batch_ids + task_offset, task_proc_lens,
-                  hash_index + task_offset, in_device + task_offset, out_range + task_offset, hash_hit_count + i);
-    task_offset += task_proc_lens;
-  }
-  if (task_offset != batch_ids_len) {
-    MS_LOG(WARNING) << "Ps cache check id in device inadequate, total:" << batch_ids_len << " checked:" << task_offset;
+  // Every thread checks the ids of its shards in the whole batch.
+  for (size_t i = 0; i < thread_num; ++i) {
+    threads[i] = std::thread(&PsCacheManager::CheckCacheHitOrOutRangeTask, this, batch_ids, batch_ids_len, hash_index,
+                             in_device, out_range, hash_hit_count + i, i, thread_num);
   }
-
-  for (size_t j = 0; j < i; j++) {
+  for (size_t j = 0; j < thread_num; j++) {
     threads[j].join();
   }
-  for (size_t j = 0; j < i; j++) {
+  for (size_t j = 0; j < thread_num; j++) {
     statistics_info_.hash_hit_count_ += hash_hit_count[j];
   }
   return true;
@@ -588,12 +625,9 @@ bool PsCacheManager::ParseDeviceData(size_t id, bool *need_swap_device_to_host,
   MS_ERROR_IF_NULL(device_hash_map);
 
   int index = INVALID_INDEX_VALUE;
-  const auto &hash_id_to_index = device_hash_map->hash_id_to_index();
-  const auto &iter = hash_id_to_index.find(id);
-  if (iter != hash_id_to_index.end()) {
+  if (device_hash_map->GetHashIndex(SizeToInt(id), &index)) {
     *need_swap_device_to_host = false;
     *need_swap_host_to_device = false;
-    index = iter->second;
     if (device_hash_map->hash_step(index) != data_step_) {
       statistics_info_.hash_hit_count_++;
       device_hash_map->set_hash_step(index, data_step_);
@@ -633,10 +667,8 @@ bool PsCacheManager::ParseHostDataHostToDevice(size_t id) {
   auto &host_hash_map = embedding_host_cache_->host_hash_map_;
   MS_ERROR_IF_NULL(host_hash_map);
 
-  const auto &hash_id_to_index = host_hash_map->hash_id_to_index();
-  const auto &iter = hash_id_to_index.find(id);
-  if (iter != hash_id_to_index.end()) {
-    auto index = iter->second;
+  int index = INVALID_INDEX_VALUE;
+  if (host_hash_map->GetHashIndex(SizeToInt(id), &index)) {
     if (host_hash_map->hash_step(index) != data_step_) {
       host_hash_map->set_hash_step(index, data_step_);
     }
@@ -649,9 +681,8 @@ bool PsCacheManager::ParseHostDataHostToDevice(size_t id) {
     MS_ERROR_IF_NULL(server_to_host_index);
     MS_ERROR_IF_NULL(server_to_host_ids);
     while (true) {
-      auto index =
-        host_hash_map->ParseData(id, host_to_server_index, host_to_server_ids, data_step_, graph_running_step_,
-                                 &statistics_info_.host_to_server_size_, &host_need_wait_graph_);
+      index = host_hash_map->ParseData(id, host_to_server_index, host_to_server_ids, data_step_, graph_running_step_,
+                                       &statistics_info_.host_to_server_size_, &host_need_wait_graph_);
       if (index == INVALID_INDEX_VALUE) {
         RETURN_IF_FALSE(WaitGraphRun());
         continue;
@@ -676,10 +707,8 @@ bool PsCacheManager::ParseHostDataDeviceToHost() {
   auto &host_hash_map = embedding_host_cache_->host_hash_map_;
   MS_ERROR_IF_NULL(host_hash_map);
   int swap_device_to_host_id = device_to_host_ids[statistics_info_.device_to_host_size_ - 1];
-  const auto &hash_id_to_index = host_hash_map->hash_id_to_index();
-  const auto &iter = hash_id_to_index.find(swap_device_to_host_id);
-  if (iter != hash_id_to_index.end()) {
-    auto index = iter->second;
+  int index = INVALID_INDEX_VALUE;
+  if (host_hash_map->GetHashIndex(swap_device_to_host_id, &index)) {
     if (host_hash_map->hash_step(index) != data_step_) {
       host_hash_map->set_hash_step(index, data_step_);
     }
@@ -688,9 +717,9 @@ bool PsCacheManager::ParseHostDataDeviceToHost() {
     int *host_to_server_index = embedding_host_cache_->host_to_server_index.get();
     int *host_to_server_ids = embedding_host_cache_->host_to_server_ids.get();
     while (true) {
-      auto index =
-        host_hash_map->ParseData(swap_device_to_host_id, host_to_server_index, host_to_server_ids, data_step_,
-                                 graph_running_step_, &statistics_info_.host_to_server_size_, &host_need_wait_graph_);
+      index = host_hash_map->ParseData(swap_device_to_host_id, host_to_server_index, host_to_server_ids, data_step_,
+                                       graph_running_step_, &statistics_info_.host_to_server_size_,
+                                       &host_need_wait_graph_);
       if (index == INVALID_INDEX_VALUE) {
         RETURN_IF_FALSE(WaitGraphRun());
         continue;
@@ -902,16 +931,30 @@ bool PsCacheManager::HashSwapHostToServer(size_t key, const HashTableInfo &hash_
     MS_LOG(ERROR) << "Lookup id memcpy failed.";
     return false;
   }
-  RETURN_IF_FALSE_WITH_LOG(Worker::GetInstance().UpdateEmbeddingTable({key}, lookup_ids, swap_out_data),
+  // The rows are copied out of the host cache, so the evicted host cache indices can be reused before the push ends.
+  RETURN_IF_FALSE_WITH_LOG(swap_pipeline_->PushAsync(data_step_, key, std::move(lookup_ids), std::move(swap_out_data)),
                            "Update embedding table to parameter server failed.");
   return true;
 }
 
-bool PsCacheManager::HashSwapServerToHost(size_t key, const HashTableInfo &hash_info) {
-  MS_ERROR_IF_NULL(embedding_host_cache_);
+std::future<bool> PsCacheManager::HashLookupFromServer(size_t key, const HashTableInfo &hash_info,
+                                                       std::vector<float> *lookup_result) {
+  MS_EXCEPTION_IF_NULL(embedding_host_cache_);
+  MS_EXCEPTION_IF_NULL(lookup_result);
   auto swap_indices_size = statistics_info_.server_to_host_size_;
   auto server_to_host_ids = embedding_host_cache_->server_to_host_ids.get();
-  MS_ERROR_IF_NULL_W_RET_VAL(server_to_host_ids, false);
+  MS_EXCEPTION_IF_NULL(server_to_host_ids);
+  std::vector<int> lookup_ids(server_to_host_ids, server_to_host_ids + swap_indices_size);
+  lookup_result->resize(swap_indices_size * hash_info.embedding_size, 0);
+  return swap_pipeline_->PullAsync(key, std::move(lookup_ids), lookup_result);
+}
+
+bool PsCacheManager::HashSwapServerToHost(const HashTableInfo &hash_info, std::future<bool> *lookup_future,
+                                          const std::vector<float> &lookup_result) {
+  MS_ERROR_IF_NULL(embedding_host_cache_);
+  MS_ERROR_IF_NULL(lookup_future);
+  RETURN_IF_FALSE_WITH_LOG(lookup_future->get(), "Embedding lookup from parameter server executed failed.");
+  auto swap_indices_size = statistics_info_.server_to_host_size_;
   auto server_to_host_index = embedding_host_cache_->server_to_host_index.get();
   MS_ERROR_IF_NULL_W_RET_VAL(server_to_host_index, false);
   if (swap_indices_size == 0) {
@@ -919,20 +962,7 @@ bool PsCacheManager::HashSwapServerToHost(size_t key, const HashTableInfo &hash_
   }
   auto host_hash_table_addr = reinterpret_cast<float *>(hash_info.host_address.get());
   MS_ERROR_IF_NULL_W_RET_VAL(host_hash_table_addr, false);
-  auto embedding_size = hash_info.embedding_size;
-  std::vector<float> lookup_result(swap_indices_size * embedding_size, 0);
-  std::vector<int> lookup_ids(swap_indices_size, 0);
-  size_t copy_len = swap_indices_size * sizeof(int);
-  size_t dest_len = copy_len;
-  auto ret = memcpy_s(lookup_ids.data(), dest_len, server_to_host_ids, copy_len);
-  if (ret != EOK) {
-    MS_LOG(ERROR) << "Lookup id memcpy failed.";
-    return false;
-  }
-  RETURN_IF_FALSE_WITH_LOG(
-    Worker::GetInstance().DoPSEmbeddingLookup(key, lookup_ids, &lookup_result, mindspore::ps::kEmbeddingLookupCmd),
-    "Embedding lookup from parameter server executed failed.");
-  RETURN_IF_FALSE(InsertHostHashTable(embedding_size, IntToSize(swap_indices_size), server_to_host_index,
+  RETURN_IF_FALSE(InsertHostHashTable(hash_info.embedding_size, IntToSize(swap_indices_size), server_to_host_index,
                                       lookup_result.data(), host_hash_table_addr));
   return true;
 }
@@ -949,6 +979,10 @@ void PsCacheManager::SyncEmbeddingTable() {
   if (!initialized_ps_cache_) {
     return;
   }
+  // The pushes in flight must finish before, otherwise they may overwrite the synchronized embeddings.
+  if (swap_pipeline_ != nullptr && !swap_pipeline_->WaitPushFinished()) {
+    MS_LOG(ERROR) << "Wait for the embedding pushes to parameter server failed.";
+  }
   if (!SyncHostEmbeddingTable()) {
     MS_LOG(ERROR) << "SyncHostEmbeddingTable failed.";
   }
@@ -961,8 +995,8 @@ void PsCacheManager::SyncEmbeddingTable() {
 bool PsCacheManager::SyncHostEmbeddingTable() {
   MS_ERROR_IF_NULL(embedding_host_cache_);
   MS_ERROR_IF_NULL(embedding_host_cache_->host_hash_map_);
-  const auto &hash_id_to_index = embedding_host_cache_->host_hash_map_->hash_id_to_index();
-  size_t swap_indices_lens = hash_id_to_index.size();
+  const auto &host_hash_map = embedding_host_cache_->host_hash_map_;
+  size_t swap_indices_lens = host_hash_map->hash_id_count();
   if (swap_indices_lens == 0) {
     return true;
   }
@@ -971,10 +1005,10 @@ bool PsCacheManager::SyncHostEmbeddingTable() {
   std::unique_ptr<int[]> host_to_server_indices_ptr = std::make_unique<int[]>(swap_indices_lens);
   MS_ERROR_IF_NULL(host_to_server_indices_ptr);
   size_t idx = 0;
-  for (const auto &item : hash_id_to_index) {
-    host_to_server_ids_ptr[idx] = item.first;
-    host_to_server_indices_ptr[idx++] = item.second;
-  }
+  host_hash_map->ForEachHashId([&host_to_server_ids_ptr, &host_to_server_indices_ptr, &idx](int id, int index) {
+    host_to_server_ids_ptr[idx] = id;
+    host_to_server_indices_ptr[idx++] = index;
+  });
   for (const auto &item : hash_tables_) {
     const auto &hash_info = item.second;
     if (hash_info.param_init_info_.param_type_ != kWeight) {
@@ -1008,8 +1042,7 @@ bool PsCacheManager::SyncDeviceEmbeddingTable() {
   MS_ERROR_IF_NULL(embedding_device_cache_->cache_);
   const auto &device_hash_map = embedding_device_cache_->device_hash_map_;
   MS_ERROR_IF_NULL(device_hash_map);
-  const auto &hash_id_to_index = device_hash_map->hash_id_to_index();
-  size_t swap_indices_lens = hash_id_to_index.size();
+  size_t swap_indices_lens = device_hash_map->hash_id_count();
   if (swap_indices_lens == 0) {
     return true;
   }
@@ -1018,10 +1051,10 @@ bool PsCacheManager::SyncDeviceEmbeddingTable() {
   std::unique_ptr<int[]> device_to_server_indices_ptr = std::make_unique<int[]>(swap_indices_lens);
   MS_ERROR_IF_NULL(device_to_server_indices_ptr);
   size_t idx = 0;
-  for (const auto &item : hash_id_to_index) {
-    device_to_server_ids_ptr[idx] = item.first;
-    device_to_server_indices_ptr[idx++] = item.second;
-  }
+  device_hash_map->ForEachHashId([&device_to_server_ids_ptr, &device_to_server_indices_ptr, &idx](int id, int index) {
+    device_to_server_ids_ptr[idx] = id;
+    device_to_server_indices_ptr[idx++] = index;
+  });
   for (const auto &item : hash_tables_) {
     const auto &hash_info = item.second;
     if (hash_info.param_init_info_.param_type_ != kWeight) {
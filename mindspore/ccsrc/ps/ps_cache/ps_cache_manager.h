@@ -24,6 +24,7 @@
 #include <atomic>
 #include <utility>
 #include <memory>
+#include <future>
 #include <condition_variable>
 #include "utils/ms_context.h"
 #include "kernel/kernel.h"
@@ -34,6 +35,7 @@
 #include "ps/ps_context.h"
 #include "ps/ps_cache/ps_data/ps_data_prefetch.h"
 #include "ps/ps_cache/embedding_hash_map.h"
+#include "ps/ps_cache/embedding_swap_pipeline.h"
 #include "ps/ps_cache/ps_cache_factory.h"
 #include "include/backend/visible.h"
 
@@ -146,6 +148,7 @@ class BACKEND_EXPORT PsCacheManager {
   bool InitParameterServer();
   void InitDataChannel();
   void AllocMemForHashTable();
+  void InitSwapPipeline();
   void SetLocalIdRank();
   void ProcessDataTask(uint32_t device_id, const void *context);
   bool ProcessData();
@@ -159,7 +162,10 @@ class BACKEND_EXPORT PsCacheManager {
   bool HashSwapHostToDevice(const HashTableInfo &hash_info);
   bool HashSwapDeviceToHost(const HashTableInfo &hash_info);
   bool HashSwapHostToServer(size_t key, const HashTableInfo &hash_info);
-  bool HashSwapServerToHost(size_t key, const HashTableInfo &hash_info);
+  std::future<bool> HashLookupFromServer(size_t key, const HashTableInfo &hash_info,
+                                         std::vector<float> *lookup_result);
+  bool HashSwapServerToHost(const HashTableInfo &hash_info, std::future<bool> *lookup_future,
+                            const std::vector<float> &lookup_result);
   bool InsertHostHashTable(size_t embedding_size, size_t insert_indices_size, const int *insert_indices,
                            const float *insert_data, float *hash_table_addr);
   bool LookUpHostHashTable(size_t embedding_size, size_t indices_lens, const float *hash_table_addr,
@@ -173,7 +179,7 @@ class BACKEND_EXPORT PsCacheManager {
   bool SyncHostEmbeddingTable();
   bool SyncDeviceEmbeddingTable();
   bool CheckCacheHitOrOutRangeTask(const int *batch_ids, const size_t batch_ids_len, int *hash_index, bool *in_device,
-                                   bool *out_range, size_t *hash_hit_count);
+                                   bool *out_range, size_t *hash_hit_count, size_t thread_id, size_t thread_num);
   bool CheckCacheHitOrOutRange(const int *batch_ids, const size_t batch_ids_len, int *hash_index, bool *in_device,
                                bool *out_range);
   bool ResetEmbeddingHashMap();
@@ -192,6 +198,7 @@ class BACKEND_EXPORT PsCacheManager {
   std::map<std::string, HashTableInfo> hash_tables_;
   std::shared_ptr<EmbeddingDeviceCache> embedding_device_cache_;
   std::shared_ptr<EmbeddingHostCache> embedding_host_cache_;
+  std::unique_ptr<EmbeddingSwapPipeline> swap_pipeline_;
 
   size_t vocab_size_{0};
   size_t vocab_cache_size_{0};
@@ -0,0 +1,422 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ps/ps_compressor.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <numeric>
+#include <utility>
+#include "utils/log_adapter.h"
+#include "plugin/device/cpu/kernel/nnacl/errorcode.h"
+#include "plugin/device/cpu/kernel/nnacl/fp32/stochastic_quant_fp32.h"
+
+namespace mindspore {
+namespace ps {
+namespace {
+constexpr uint32_t kQuant8Bits = 8;
+constexpr uint32_t kQuant4Bits = 4;
+constexpr uint32_t kLowHalfByteMask = 0x0F;
+constexpr size_t kQuantBlockHeaderSize = 2 * sizeof(float);
+constexpr uint32_t kDefaultNoiseSeed = 0x9E3779B9;
+constexpr uint32_t kNoiseMantissaShift = 8;
+constexpr size_t kNoiseLaneNum = 16;
+constexpr float kNoiseScale = 1.0f / (1 << 24);
+constexpr size_t kTopKSampleStride = 64;
+constexpr size_t kTopKOverSampleRate = 2;
+
+const std::map<std::string, PSCompressType> kCompressTypes = {{"NO_COMPRESS", PSCompressType::kNoCompress},
+                                                              {"TOPK", PSCompressType::kTopK},
+                                                              {"QUANT_8BIT", PSCompressType::kQuant8Bit},
+                                                              {"QUANT_4BIT", PSCompressType::kQuant4Bit},
+                                                              {"DELTA_QUANT_8BIT", PSCompressType::kDeltaQuant8Bit}};
+
+// Called with each decoded block, 'begin' is the offset of the block in the whole data.
+using DecodedBlockFunc = std::function<void(size_t begin, const float *decoded, size_t num)>;
+
+// The uniform noise in [0, 1) of the stochastic rounding. Xorshift is cheap and good enough for the rounding, the
+// independent lanes break the dependency chain of a single generator so that the lanes are vectorized.
+class UniformNoise {
+ public:
+  explicit UniformNoise(uint32_t seed) {
+    for (size_t lane = 0; lane < kNoiseLaneNum; ++lane) {
+      uint32_t state = (seed + static_cast<uint32_t>(lane)) * kDefaultNoiseSeed;
+      state_[lane] = state == 0 ? kDefaultNoiseSeed : state;
+    }
+  }
+  ~UniformNoise() = default;
+
+  void Fill(float *noise, size_t size) {
+    size_t i = 0;
+    for (; i + kNoiseLaneNum <= size; i += kNoiseLaneNum) {
+      for (size_t lane = 0; lane < kNoiseLaneNum; ++lane) {
+        noise[i + lane] = Next(lane);
+      }
+    }
+    for (size_t lane = 0; i < size; ++i, ++lane) {
+      noise[i] = Next(lane);
+    }
+  }
+
+ private:
+  float Next(size_t lane) {
+    uint32_t state = state_[lane];
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    state_[lane] = state;
+    return static_cast<float>(state >> kNoiseMantissaShift) * kNoiseScale;
+  }
+
+  uint32_t state_[kNoiseLaneNum];
+};
+
+size_t QuantCodeSize(size_t num, uint32_t bits) { return (num * bits + kQuant8Bits - 1) / kQuant8Bits; }
+
+size_t QuantDataSize(size_t size, uint32_t bits) {
+  size_t block_num = (size + kQuantBlockSize - 1) / kQuantBlockSize;
+  return block_num * kQuantBlockHeaderSize + (size / kQuantBlockSize) * QuantCodeSize(kQuantBlockSize, bits) +
+         QuantCodeSize(size % kQuantBlockSize, bits);
+}
+
+void PackCodes(const float *codes, size_t num, uint32_t bits, uint8_t *out) {
+  if (bits == kQuant8Bits) {
+    for (size_t i = 0; i < num; ++i) {
+      out[i] = static_cast<uint8_t>(codes[i]);
+    }
+    return;
+  }
+  size_t i = 0;
+  for (; i + 1 < num; i += 2) {
+    uint32_t low = static_cast<uint32_t>(codes[i]);
+    uint32_t high = static_cast<uint32_t>(codes[i + 1]);
+    out[i / 2] = static_cast<uint8_t>(low | (high << kQuant4Bits));
+  }
+  if (i < num) {
+    out[i / 2] = static_cast<uint8_t>(codes[i]);
+  }
+}
+
+void UnpackCodes(const uint8_t *in, size_t num, uint32_t bits, float *codes) {
+  if (bits == kQuant8Bits) {
+    for (size_t i = 0; i < num; ++i) {
+      codes[i] = static_cast<float>(in[i]);
+    }
+    return;
+  }
+  size_t i = 0;
+  for (; i + 1 < num; i += 2) {
+    uint32_t byte = in[i / 2];
+    codes[i] = static_cast<float>(byte & kLowHalfByteMask);
+    codes[i + 1] = static_cast<float>(byte >> kQuant4Bits);
+  }
+  if (i < num) {
+    codes[i] = static_cast<float>(in[i / 2] & kLowHalfByteMask);
+  }
+}
+
+bool IsFinite(const float *data, size_t size) {
+  return std::all_of(data, data + size, [](float value) { return std::isfinite(value); });
+}
+
+// Each block is encoded as [min, scale, codes], the decoded blocks are passed to 'func' so that the sender knows the
+// exact value the receiver gets. The ranges of all the blocks are checked before any block is encoded, so 'func' is
+// never called if the data can't be quantized.
+bool QuantEncode(const float *data, size_t size, uint32_t bits, uint32_t seed, std::string *compress_data,
+                 const DecodedBlockFunc &func) {
+  MS_ERROR_IF_NULL(data);
+  MS_ERROR_IF_NULL(compress_data);
+  // NaN is skipped by the min/max comparisons and would be encoded as the min value of its block.
+  if (!IsFinite(data, size)) {
+    MS_LOG(ERROR) << "The data to be quantized is not finite.";
+    return false;
+  }
+  std::vector<std::pair<float, float>> ranges;
+  ranges.reserve((size + kQuantBlockSize - 1) / kQuantBlockSize);
+  for (size_t begin = 0; begin < size; begin += kQuantBlockSize) {
+    size_t num = std::min(kQuantBlockSize, size - begin);
+    float min_val = 0;
+    float max_val = 0;
+    if (MinMaxFp32(data + begin, num, &min_val, &max_val) != NNACL_OK || !std::isfinite(max_val - min_val)) {
+      MS_LOG(ERROR) << "The range [" << min_val << ", " << max_val << "] of the data to be quantized overflows.";
+      return false;
+    }
+    (void)ranges.emplace_back(min_val, max_val);
+  }
+
+  const float max_code = static_cast<float>((1U << bits) - 1);
+  compress_data->resize(QuantDataSize(size, bits));
+  auto out = reinterpret_cast<uint8_t *>(&(*compress_data)[0]);
+  UniformNoise noise_generator(seed);
+  float noise[kQuantBlockSize];
+  float codes[kQuantBlockSize];
+  for (size_t begin = 0, block = 0; begin < size; begin += kQuantBlockSize, ++block) {
+    size_t num = std::min(kQuantBlockSize, size - begin);
+    float min_val = ranges[block].first;
+    float scale = (ranges[block].second - min_val) / max_code;
+    float inv_scale = scale > 0 ? 1.0f / scale : 0.0f;
+    noise_generator.Fill(noise, num);
+    (void)StochasticQuantFp32(data + begin, noise, num, min_val, inv_scale, max_code, codes);
+    if (memcpy_s(out, sizeof(float), &min_val, sizeof(float)) != EOK ||
+        memcpy_s(out + sizeof(float), sizeof(float), &scale, sizeof(float)) != EOK) {
+      MS_LOG(ERROR) << "Write the quantization header failed.";
+      return false;
+    }
+    out += kQuantBlockHeaderSize;
+    PackCodes(codes, num, bits, out);
+    out += QuantCodeSize(num, bits);
+    (void)DequantFp32(codes, num, min_val, scale, codes);
+    func(begin, codes, num);
+  }
+  return true;
+}
+
+bool QuantDecode(const std::string &compress_data, size_t size, uint32_t bits, const DecodedBlockFunc &func) {
+  if (compress_data.size() != QuantDataSize(size, bits)) {
+    MS_LOG(ERROR) << "The size of the quantized data " << compress_data.size() << " mismatches the " << size
+                  << " elements of " << bits << " bits.";
+    return false;
+  }
+  auto in = reinterpret_cast<const uint8_t *>(compress_data.data());
+  float codes[kQuantBlockSize];
+  for (size_t begin = 0; begin < size; begin += kQuantBlockSize) {
+    size_t num = std::min(kQuantBlockSize, size - begin);
+    float min_val = 0;
+    float scale = 0;
+    if (memcpy_s(&min_val, sizeof(float), in, sizeof(float)) != EOK ||
+        memcpy_s(&scale, sizeof(float), in + sizeof(float), sizeof(float)) != EOK) {
+      MS_LOG(ERROR) << "Read the quantization header failed.";
+      return false;
+    }
+    in += kQuantBlockHeaderSize;
+    UnpackCodes(in, num, bits, codes);
+    in += QuantCodeSize(num, bits);
+    (void)DequantFp32(codes, num, min_val, scale, codes);
+    func(begin, codes, num);
+  }
+  return true;
+}
+
+// Return the k-th largest magnitude of 'data' and the number of the magnitudes greater than it. A lower bound of the
+// k-th magnitude is estimated on a strided sample, then only the candidates above the bound are selected exactly, the
+// selection over all the magnitudes is the fallback when the bound is too high.
+float SelectTopKThreshold(const float *data, size_t size, size_t k, size_t *greater_num) {
+  std::vector<float> candidates;
+  if (size >= kTopKSampleStride * kTopKSampleStride) {
+    std::vector<float> samples;
+    samples.reserve(size / kTopKSampleStride + 1);
+    for (size_t i = 0; i < size; i += kTopKSampleStride) {
+      samples.push_back(std::fabs(data[i]));
+    }
+    size_t sample_k = std::min(samples.size(), k * kTopKOverSampleRate / kTopKSampleStride + 1);
+    (void)std::nth_element(samples.begin(), samples.begin() + (sample_k - 1), samples.end(), std::greater<float>());
+    float lower_bound = samples[sample_k - 1];
+    candidates.reserve(k * kTopKOverSampleRate);
+    for (size_t i = 0; i < size; ++i) {
+      float magnitude = std::fabs(data[i]);
+      if (magnitude >= lower_bound) {
+        candidates.push_back(magnitude);
+      }
+    }
+  }
+  if (candidates.size() < k) {
+    candidates.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+      candidates[i] = std::fabs(data[i]);
+    }
+  }
+  (void)std::nth_element(candidates.begin(), candidates.begin() + (k - 1), candidates.end(), std::greater<float>());
+  float threshold = candidates[k - 1];
+  *greater_num = static_cast<size_t>(
+    std::count_if(candidates.begin(), candidates.begin() + (k - 1), [threshold](float m) { return m > threshold; }));
+  return threshold;
+}
+
+// Top-k is encoded as [k, k indices, k values], the indices are in ascending order.
+bool TopKEncode(size_t size, float sparse_rate, std::vector<float> *accumulation, std::string *compress_data) {
+  size_t k = static_cast<size_t>(std::ceil(static_cast<double>(size) * sparse_rate));
+  k = std::max<size_t>(std::min(k, size), 1);
+  float *acc = accumulation->data();
+  if (!IsFinite(acc, size)) {
+    MS_LOG(ERROR) << "The data to be sparsified is not finite.";
+    return false;
+  }
+  size_t greater_num = 0;
+  float threshold = SelectTopKThreshold(acc, size, k, &greater_num);
+  size_t equal_num = k - greater_num;
+
+  compress_data->resize(sizeof(uint32_t) + k * (sizeof(uint32_t) + sizeof(float)));
+  auto out = reinterpret_cast<uint8_t *>(&(*compress_data)[0]);
+  uint32_t k_value = static_cast<uint32_t>(k);
+  if (memcpy_s(out, sizeof(uint32_t), &k_value, sizeof(uint32_t)) != EOK) {
+    MS_LOG(ERROR) << "Write the top-k data failed.";
+    return false;
+  }
+  auto indices = reinterpret_cast<uint32_t *>(out + sizeof(uint32_t));
+  auto values = reinterpret_cast<float *>(out + sizeof(uint32_t) + k * sizeof(uint32_t));
+  size_t selected = 0;
+  for (size_t i = 0; i < size && selected < k; ++i) {
+    float magnitude = std::fabs(acc[i]);
+    if (magnitude > threshold || (magnitude == threshold && equal_num > 0)) {
+      equal_num -= magnitude == threshold ? 1 : 0;
+      indices[selected] = static_cast<uint32_t>(i);
+      values[selected] = acc[i];
+      acc[i] = 0;
+      ++selected;
+    }
+  }
+  return true;
+}
+
+bool TopKDecode(const std::string &compress_data, float *data, size_t size) {
+  uint32_t k = 0;
+  if (compress_data.size() < sizeof(uint32_t) ||
+      memcpy_s(&k, sizeof(uint32_t), compress_data.data(), sizeof(uint32_t)) != EOK || k > size ||
+      compress_data.size() != sizeof(uint32_t) + k * (sizeof(uint32_t) + sizeof(float))) {
+    MS_LOG(ERROR) << "The size of the top-k data " << compress_data.size() << " is invalid for " << size
+                  << " elements.";
+    return false;
+  }
+  std::vector<uint32_t> indices(k);
+  std::vector<float> values(k);
+  auto in = reinterpret_cast<const uint8_t *>(compress_data.data()) + sizeof(uint32_t);
+  if (k > 0 && (memcpy_s(indices.data(), k * sizeof(uint32_t), in, k * sizeof(uint32_t)) != EOK ||
+                memcpy_s(values.data(), k * sizeof(float), in + k * sizeof(uint32_t), k * sizeof(float)) != EOK)) {
+    MS_LOG(ERROR) << "Read the top-k data failed.";
+    return false;
+  }
+  std::fill(data, data + size, 0.0f);
+  for (size_t i = 0; i < k; ++i) {
+    if (indices[i] >= size) {
+      MS_LOG(ERROR) << "The top-k index " << indices[i] << " is out of range " << size;
+      return false;
+    }
+    data[indices[i]] = values[i];
+  }
+  return true;
+}
+}  // namespace
+
+PSCompressType PSCompressor::GetCompressType(const std::string &compress_type) {
+  auto iter = kCompressTypes.find(compress_type);
+  if (iter == kCompressTypes.end()) {
+    MS_LOG(WARNING) << "The compress type " << compress_type << " is not supported, the data is not compressed.";
+    return PSCompressType::kNoCompress;
+  }
+  return iter->second;
+}
+
+bool PSCompressor::Compress(PSCompressType compress_type, const float *data, size_t size, float sparse_rate,
+                            uint32_t seed, std::vector<float> *residual, std::string *compress_data) {
+  MS_ERROR_IF_NULL(data);
+  MS_ERROR_IF_NULL(residual);
+  MS_ERROR_IF_NULL(compress_data);
+  if (size == 0) {
+    MS_LOG(ERROR) << "The size of the data to be compressed is 0.";
+    return false;
+  }
+  // A non-finite gradient is rejected before it is accumulated, so the residual is kept for the next push.
+  if (!IsFinite(data, size)) {
+    MS_LOG(WARNING) << "The data to be compressed is not finite.";
+    return false;
+  }
+  // The residual turns into the accumulation of the gradient and the error left by the last compression.
+  if (residual->size() != size) {
+    residual->assign(size, 0.0f);
+  }
+  float *acc = residual->data();
+  for (size_t i = 0; i < size; ++i) {
+    acc[i] += data[i];
+  }
+  bool ret = false;
+  switch (compress_type) {
+    case PSCompressType::kTopK:
+      ret = TopKEncode(size, sparse_rate, residual, compress_data);
+      break;
+    case PSCompressType::kQuant8Bit:
+    case PSCompressType::kQuant4Bit: {
+      uint32_t bits = compress_type == PSCompressType::kQuant8Bit ? kQuant8Bits : kQuant4Bits;
+      ret = QuantEncode(acc, size, bits, seed, compress_data, [acc](size_t begin, const float *decoded, size_t num) {
+        for (size_t i = 0; i < num; ++i) {
+          acc[begin + i] -= decoded[i];
+        }
+      });
+      break;
+    }
+    default:
+      MS_LOG(ERROR) << "The compress type " << static_cast<uint32_t>(compress_type) << " is invalid for the push.";
+      return false;
+  }
+  // The accumulation overflowed, the gradient is pushed as it is and the residual starts over.
+  if (!ret) {
+    residual->clear();
+  }
+  return ret;
+}
+
+bool PSCompressor::Decompress(PSCompressType compress_type, const std::string &compress_data, float *data,
+                              size_t size) {
+  MS_ERROR_IF_NULL(data);
+  switch (compress_type) {
+    case PSCompressType::kTopK:
+      return TopKDecode(compress_data, data, size);
+    case PSCompressType::kQuant8Bit:
+    case PSCompressType::kQuant4Bit: {
+      uint32_t bits = compress_type == PSCompressType::kQuant8Bit ? kQuant8Bits : kQuant4Bits;
+      return QuantDecode(compress_data, size, bits, [data](size_t begin, const float *decoded, size_t num) {
+        (void)std::copy(decoded, decoded + num, data + begin);
+      });
+    }
+    default:
+      MS_LOG(ERROR) << "The compress type " << static_cast<uint32_t>(compress_type) << " is invalid for the push.";
+      return false;
+  }
+}
+
+bool PSCompressor::EncodeDelta(const float *weight, size_t size, uint32_t seed, std::vector<float> *snapshot,
+                               std::string *compress_data) {
+  MS_ERROR_IF_NULL(weight);
+  MS_ERROR_IF_NULL(snapshot);
+  if (snapshot->size() != size) {
+    MS_LOG(ERROR) << "The snapshot size " << snapshot->size() << " mismatches the weight size " << size;
+    return false;
+  }
+  float *base = snapshot->data();
+  std::vector<float> delta(size);
+  for (size_t i = 0; i < size; ++i) {
+    delta[i] = weight[i] - base[i];
+  }
+  return QuantEncode(delta.data(), size, kQuant8Bits, seed, compress_data,
+                     [base](size_t begin, const float *decoded, size_t num) {
+                       for (size_t i = 0; i < num; ++i) {
+                         base[begin + i] += decoded[i];
+                       }
+                     });
+}
+
+bool PSCompressor::DecodeDelta(const std::string &compress_data, std::vector<float> *snapshot) {
+  MS_ERROR_IF_NULL(snapshot);
+  float *base = snapshot->data();
+  return QuantDecode(compress_data, snapshot->size(), kQuant8Bits,
+                     [base](size_t begin, const float *decoded, size_t num) {
+                       for (size_t i = 0; i < num; ++i) {
+                         base[begin + i] += decoded[i];
+                       }
+                     });
+}
+}  // namespace ps
+}  // namespace mindspore
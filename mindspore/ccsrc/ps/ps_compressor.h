@@ -0,0 +1,57 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_PS_PS_COMPRESSOR_H_
+#define MINDSPORE_CCSRC_PS_PS_COMPRESSOR_H_
+
+#include <string>
+#include <vector>
+#include "include/backend/visible.h"
+
+namespace mindspore {
+namespace ps {
+// The compress type is carried in the KVMessage, kNoCompress means the values are sent as they are.
+enum class PSCompressType : uint32_t { kNoCompress = 0, kTopK, kQuant8Bit, kQuant4Bit, kDeltaQuant8Bit };
+
+// The quantized data is encoded by blocks, each block has its own min value and scale.
+constexpr size_t kQuantBlockSize = 1024;
+
+// The compression of the dense data exchanged between the workers and the parameter servers:
+// 1. The pushed gradients are sparsified by top-k or stochastically quantized to 8/4 bits, the compress error is kept
+//    in the residual of the worker and added back to the gradient of the next push.
+// 2. The pulled weights are sent as the 8 bits quantized difference to the snapshot both sides kept since the last
+//    pull, the snapshots are updated by the same decoded difference so they never drift from each other.
+class BACKEND_EXPORT PSCompressor {
+ public:
+  // Return kNoCompress for the unknown compress type.
+  static PSCompressType GetCompressType(const std::string &compress_type);
+
+  // Compress the 'size' elements of 'data' with the error feedback of 'residual'. The 'seed' drives the random rounding
+  // of the quantization and 'sparse_rate' is the ratio of the elements kept by top-k. Return false for the non-finite
+  // data, which should be sent uncompressed, the residual is kept or cleared if it overflowed.
+  static bool Compress(PSCompressType compress_type, const float *data, size_t size, float sparse_rate, uint32_t seed,
+                       std::vector<float> *residual, std::string *compress_data);
+  static bool Decompress(PSCompressType compress_type, const std::string &compress_data, float *data, size_t size);
+
+  // Encode the difference of 'weight' to 'snapshot', then apply the decoded difference to 'snapshot'. Return false
+  // with 'snapshot' unchanged if the difference is not finite.
+  static bool EncodeDelta(const float *weight, size_t size, uint32_t seed, std::vector<float> *snapshot,
+                          std::string *compress_data);
+  static bool DecodeDelta(const std::string &compress_data, std::vector<float> *snapshot);
+};
+}  // namespace ps
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_PS_PS_COMPRESSOR_H_
@@ -563,6 +563,34 @@ void PSContext::set_download_compress_type(const std::string &download_compress_
 }
 std::string PSContext::download_compress_type() const { return download_compress_type_; }
 
+void PSContext::set_push_compress_type(const std::string &push_compress_type) {
+  push_compress_type_ = push_compress_type;
+}
+std::string PSContext::push_compress_type() const { return push_compress_type_; }
+
+void PSContext::set_push_sparse_rate(float push_sparse_rate) {
+  if (push_sparse_rate > 0 && push_sparse_rate <= 1) {
+    push_sparse_rate_ = push_sparse_rate;
+  } else {
+    MS_LOG(WARNING) << push_sparse_rate << " is invalid, push_sparse_rate must be in (0, 1], 0.01 is used by default.";
+    push_sparse_rate_ = kDefaultPushSparseRate;
+  }
+}
+float PSContext::push_sparse_rate() const { return push_sparse_rate_; }
+
+void PSContext::set_pull_compress_type(const std::string &pull_compress_type) {
+  pull_compress_type_ = pull_compress_type;
+}
+std::string PSContext::pull_compress_type() const { return pull_compress_type_; }
+
+void PSContext::set_enable_embedding_hash_shard(bool enable_embedding_hash_shard) {
+  enable_embedding_hash_shard_ = enable_embedding_hash_shard;
+}
+bool PSContext::enable_embedding_hash_shard() const { return enable_embedding_hash_shard_; }
+
+void PSContext::set_embedding_server_num(size_t embedding_server_num) { embedding_server_num_ = embedding_server_num; }
+size_t PSContext::embedding_server_num() const { return embedding_server_num_; }
+
 std::string PSContext::checkpoint_dir() const { return checkpoint_dir_; }
 
 void PSContext::set_checkpoint_dir(const std::string &checkpoint_dir) { checkpoint_dir_ = checkpoint_dir; }
@@ -42,6 +42,7 @@ constexpr char kStablePWEncryptType[] = "STABLE_PW_ENCRYPT";
 constexpr char kNotEncryptType[] = "NOT_ENCRYPT";
 constexpr char kDSEncryptType[] = "SIGNDS";
 constexpr char kNoCompressType[] = "NO_COMPRESS";
+constexpr float kDefaultPushSparseRate = 0.01f;
 
 // Use binary data to represent federated learning server's context so that we can judge which round resets the
 // iteration. From right to left, each bit stands for:
@@ -241,6 +242,21 @@ class BACKEND_EXPORT PSContext {
   void set_download_compress_type(const std::string &download_compress_type);
   std::string download_compress_type() const;
 
+  void set_push_compress_type(const std::string &push_compress_type);
+  std::string push_compress_type() const;
+
+  void set_push_sparse_rate(float push_sparse_rate);
+  float push_sparse_rate() const;
+
+  void set_pull_compress_type(const std::string &pull_compress_type);
+  std::string pull_compress_type() const;
+
+  void set_enable_embedding_hash_shard(bool enable_embedding_hash_shard);
+  bool enable_embedding_hash_shard() const;
+
+  void set_embedding_server_num(size_t embedding_server_num);
+  size_t embedding_server_num() const;
+
   std::string checkpoint_dir() const;
   void set_checkpoint_dir(const std::string &checkpoint_dir);
 
@@ -300,6 +316,11 @@ class BACKEND_EXPORT PSContext {
         upload_compress_type_(kNoCompressType),
         upload_sparse_rate_(0.4f),
         download_compress_type_(kNoCompressType),
+        push_compress_type_(kNoCompressType),
+        push_sparse_rate_(kDefaultPushSparseRate),
+        pull_compress_type_(kNoCompressType),
+        enable_embedding_hash_shard_(false),
+        embedding_server_num_(0),
         checkpoint_dir_("") {}
   bool ps_enabled_;
   bool is_worker_;
@@ -440,6 +461,16 @@ class BACKEND_EXPORT PSContext {
   // Hyper parameters for download compression.
   std::string download_compress_type_;
 
+  // The compression of the dense gradients pushed and the weights pulled in parameter server mode.
+  std::string push_compress_type_;
+  float push_sparse_rate_;
+  std::string pull_compress_type_;
+
+  // Shard the embedding tables of parameter server mode by consistent hashing, and the number of the servers the tables
+  // are placed on, 0 for all the servers. Changing it during the training migrates the rows between the servers.
+  bool enable_embedding_hash_shard_;
+  size_t embedding_server_num_;
+
   // directory of server checkpoint
   std::string checkpoint_dir_;
 };
@@ -0,0 +1,68 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ps/striped_mutex.h"
+#include <algorithm>
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace ps {
+namespace {
+// The number of the ids grouped by the stripe at a time.
+constexpr size_t kStripeGroupChunkSize = 1024;
+}  // namespace
+
+std::vector<std::unique_lock<std::mutex>> StripedMutex::LockAll() {
+  std::vector<std::unique_lock<std::mutex>> locks;
+  locks.reserve(kLockStripeNum);
+  for (auto &stripe_mutex : mutexes_) {
+    (void)locks.emplace_back(stripe_mutex);
+  }
+  return locks;
+}
+
+void StripedMutex::ForEachStripe(const size_t *ids, size_t ids_num,
+                                 const std::function<void(const size_t *positions, size_t num)> &func) {
+  MS_EXCEPTION_IF_NULL(ids);
+  // The positions are grouped by the counting sort, which keeps the order of the duplicate ids.
+  std::array<size_t, kLockStripeNum + 1> stripe_offsets;
+  std::array<size_t, kLockStripeNum> stripe_ends;
+  std::array<size_t, kStripeGroupChunkSize> positions;
+  for (size_t begin = 0; begin < ids_num; begin += kStripeGroupChunkSize) {
+    size_t end = std::min(ids_num, begin + kStripeGroupChunkSize);
+    stripe_offsets.fill(0);
+    for (size_t i = begin; i < end; i++) {
+      stripe_offsets[ids[i] % kLockStripeNum + 1]++;
+    }
+    for (size_t i = 0; i < kLockStripeNum; i++) {
+      stripe_offsets[i + 1] += stripe_offsets[i];
+      stripe_ends[i] = stripe_offsets[i];
+    }
+    for (size_t i = begin; i < end; i++) {
+      positions[stripe_ends[ids[i] % kLockStripeNum]++] = i;
+    }
+    for (size_t stripe = 0; stripe < kLockStripeNum; stripe++) {
+      size_t num = stripe_offsets[stripe + 1] - stripe_offsets[stripe];
+      if (num == 0) {
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(mutexes_[stripe]);
+      func(positions.data() + stripe_offsets[stripe], num);
+    }
+  }
+}
+}  // namespace ps
+}  // namespace mindspore
@@ -0,0 +1,54 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_PS_STRIPED_MUTEX_H_
+#define MINDSPORE_CCSRC_PS_STRIPED_MUTEX_H_
+
+#include <array>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "include/backend/visible.h"
+
+namespace mindspore {
+namespace ps {
+// The number of the striped locks for the updates of the embedding rows.
+constexpr size_t kLockStripeNum = 64;
+
+// The mutexes striped by id, so only the ids of the same stripe are serialized. The readers and writers of all the ids
+// lock all the stripes.
+class BACKEND_EXPORT StripedMutex {
+ public:
+  StripedMutex() = default;
+  ~StripedMutex() = default;
+
+  std::mutex &mutex(size_t id) { return mutexes_[id % kLockStripeNum]; }
+
+  // Lock all the stripes in order.
+  std::vector<std::unique_lock<std::mutex>> LockAll();
+
+  // Group the ids by the stripe, and call func with the positions of the ids of each stripe while holding the lock of
+  // the stripe. The positions of the duplicate ids keep their order. The ids are grouped chunk by chunk, so the data of
+  // the positions stays in the cache.
+  void ForEachStripe(const size_t *ids, size_t ids_num,
+                     const std::function<void(const size_t *positions, size_t num)> &func);
+
+ private:
+  std::array<std::mutex, kLockStripeNum> mutexes_;
+};
+}  // namespace ps
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_PS_STRIPED_MUTEX_H_
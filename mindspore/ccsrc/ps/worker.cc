@@ -21,6 +21,7 @@ namespace mindspore {
 namespace ps {
 namespace {
 constexpr int kRetryDuration = 2000;
+constexpr uint32_t kPushSeedStride = 0x9E3779B1;
 }  // namespace
 
 Worker &Worker::GetInstance() {
@@ -115,7 +116,9 @@ void Worker::Push(const std::vector<size_t> &keys, std::vector<uintptr_t> addrs,
   (void)std::transform(sizes.begin(), sizes.end(), std::back_inserter(sizes_int),
                        [](const int64_t &value) { return static_cast<int>(value); });
   if (!is_sparse) {
-    PushData(std::vector<Key>(keys), total_buffer, std::vector<int>(sizes_int), kPushCmd);
+    if (!PushCompressedData(keys, total_buffer, sizes_int, optim_id)) {
+      PushData(std::vector<Key>(keys), total_buffer, std::vector<int>(sizes_int), kPushCmd);
+    }
   } else {
     std::vector<int64_t> &var_shape = key_to_optim_shapes_[key][0];
     int64_t first_dim_size = var_shape[0];
@@ -134,7 +137,13 @@ void Worker::Pull(const size_t key, void *dev_addr, const size_t size) {
   while (running_ && (!IsReadyForPull(key))) {
     continue;
   }
-  PullData({key}, &variables, nullptr, kPullCmd);
+  if (EmbeddingHashShard(key)) {
+    PullEmbeddingRows(key, &variables);
+  } else if (pull_compress_type_ == PSCompressType::kDeltaQuant8Bit && embedding_table_ranges_.count(key) == 0) {
+    PullCompressedData(key, &variables);
+  } else {
+    PullData({key}, &variables, nullptr, kPullCmd);
+  }
   MS_LOG(DEBUG) << "The variables:" << variables << " the size is:" << size;
   size_t dst_size = size;
   size_t src_size = size;
@@ -216,6 +225,21 @@ void Worker::AddEmbeddingTable(const Key &key, const size_t &row_count) {
     embedding_table_ranges_[key]->push_back(range);
   }
   embedding_row_cnt_[key] = row_count;
+
+  if (PSContext::instance()->enable_embedding_hash_shard()) {
+    if (PsDataPrefetch::GetInstance().cache_enable()) {
+      MS_LOG(EXCEPTION) << "The embedding table sharded by consistent hashing doesn't support the embedding cache.";
+    }
+    // The table is spread on all the servers at first.
+    std::vector<uint32_t> server_ranks(LongToSize(server_num_));
+    for (size_t i = 0; i < server_ranks.size(); i++) {
+      server_ranks[i] = static_cast<uint32_t>(i);
+    }
+    std::lock_guard<std::mutex> lock(embedding_shard_mutex_);
+    embedding_shard_maps_[key] = std::make_shared<EmbeddingShardMap>(row_count, server_ranks, 0);
+    embedding_push_steps_[key] = 0;
+    embedding_server_num_ = server_ranks.size();
+  }
 }
 
 bool Worker::InitPSEmbeddingTable(const size_t &key, const std::vector<size_t> &input_shape,
@@ -293,35 +317,53 @@ bool Worker::DoPSEmbeddingLookup(const Key &key, const std::vector<int> &lookup_
   embedding_table_lookup.set_key(key);
   *embedding_table_lookup.mutable_keys() = {lookup_ids.begin(), lookup_ids.end()};
 
-  PartitionEmbeddingMessages messages;
-  lookup_partitioner_(embedding_table_lookup, &messages, {});
-  std::vector<uint32_t> rank_ids;
-  std::vector<std::string> data_strs;
-  for (size_t i = 0; i < messages.size(); i++) {
-    if (messages.at(i).first) {
-      rank_ids.push_back(i);
-      data_strs.emplace_back(messages.at(i).second.SerializeAsString());
-    }
+  bool hash_shard = EmbeddingHashShard(key);
+  if (hash_shard && worker_node_.rank_id() == 0) {
+    RebalanceEmbeddingTables();
   }
+  std::vector<KVMessage> res_messages;
+  do {
+    // The lookup is partitioned again by the placement learned from the replies if it should be retried.
+    PartitionEmbeddingMessages messages;
+    lookup_partitioner_(embedding_table_lookup, &messages, {});
+    std::vector<uint32_t> rank_ids;
+    std::vector<std::string> data_strs;
+    for (size_t i = 0; i < messages.size(); i++) {
+      if (messages.at(i).first) {
+        rank_ids.push_back(i);
+        data_strs.emplace_back(messages.at(i).second.SerializeAsString());
+      }
+    }
 
-  std::vector<VectorPtr> resp;
-  while (!worker_node_.Send(core::NodeRole::SERVER, rank_ids, data_strs, LongToInt(cmd), &resp)) {
-    MS_LOG(INFO) << "Worker send failed!, retrying.";
-    if (!running_) {
-      MS_LOG(ERROR) << "Worker send failed!";
-      return false;
+    std::vector<VectorPtr> resp;
+    while (!worker_node_.Send(core::NodeRole::SERVER, rank_ids, data_strs, LongToInt(cmd), &resp)) {
+      MS_LOG(INFO) << "Worker send failed!, retrying.";
+      if (!running_) {
+        MS_LOG(ERROR) << "Worker send failed!";
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(kRetryDuration));
     }
-    std::this_thread::sleep_for(std::chrono::milliseconds(kRetryDuration));
-  }
+    res_messages.resize(resp.size());
+    for (size_t i = 0; i < resp.size(); ++i) {
+      CHECK_RETURN_TYPE(res_messages[i].ParseFromArray(resp.at(i)->data(), resp.at(i)->size()));
+    }
+    if (hash_shard && RetryEmbeddingLookup(res_messages)) {
+      if (!running_) {
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(kRetryIntervalInMs));
+      continue;
+    }
+    break;
+  } while (true);
 
   int64_t single_id_len = SizeToLong(lookup_result->size() / lookup_ids.size());
   mindspore::HashMap<Key, std::shared_ptr<std::pair<float *, int64_t>>> id_addr_map;
   std::shared_ptr<std::vector<float>> values = std::make_shared<std::vector<float>>();
   std::shared_ptr<std::vector<Key>> keys = std::make_shared<std::vector<Key>>();
   int64_t value_offset = 0;
-  for (size_t i = 0; i < resp.size(); ++i) {
-    KVMessage message;
-    CHECK_RETURN_TYPE(message.ParseFromArray(resp.at(i)->data(), resp.at(i)->size()));
+  for (const auto &message : res_messages) {
     for (auto j = 0; j < message.values_size(); j++) {
       values->push_back(message.values(j));
     }
@@ -408,6 +450,9 @@ void Worker::Finalize() {
     worker_node_.Finish();
     worker_node_.Stop();
     running_ = false;
+    if (rebalance_thread_ != nullptr && rebalance_thread_->joinable()) {
+      rebalance_thread_->join();
+    }
     MS_LOG(INFO) << "Worker finalized successfully.";
   }
 }
@@ -431,6 +476,17 @@ void Worker::Initialize() {
   broadcast_partitioner_ = [this](auto &&send, auto &&partition, auto &&attrs) {
     BroadcastPartitioner(send, partition, attrs);
   };
+
+  push_compress_type_ = PSCompressor::GetCompressType(PSContext::instance()->push_compress_type());
+  if (push_compress_type_ == PSCompressType::kDeltaQuant8Bit) {
+    MS_LOG(WARNING) << "The delta encoding is only for the pull, the pushed gradients are not compressed.";
+    push_compress_type_ = PSCompressType::kNoCompress;
+  }
+  pull_compress_type_ = PSCompressor::GetCompressType(PSContext::instance()->pull_compress_type());
+  if (pull_compress_type_ != PSCompressType::kNoCompress && pull_compress_type_ != PSCompressType::kDeltaQuant8Bit) {
+    MS_LOG(WARNING) << "Only the delta encoding is supported for the pull, the pulled weights are not compressed.";
+    pull_compress_type_ = PSCompressType::kNoCompress;
+  }
 }
 
 bool Worker::IsKeyInit(const size_t key) {
@@ -654,6 +710,10 @@ void Worker::PushSparseData(const std::vector<Key> &keys, const std::vector<floa
   if (embedding_table_ranges_.count(keys[0])) {
     std::map<int64_t, int64_t> attrs{{0, grad_index}, {1, indice_index}, {2, first_dim_size}, {3, outer_dim_size}};
     SendForPush(kPushCmd, kvs, sparse_partitioner_, attrs);
+    if (EmbeddingHashShard(keys[0])) {
+      std::lock_guard<std::mutex> lock(embedding_shard_mutex_);
+      embedding_push_steps_[keys[0]]++;
+    }
   } else {
     SendForPush(kPushCmd, kvs, round_robin_partitioner_, {});
   }
@@ -671,6 +731,80 @@ void Worker::PullData(const std::vector<Key> &keys, std::vector<float> *const va
   }
 }
 
+bool Worker::PushCompressedData(const std::vector<Key> &keys, const std::vector<float> &vals,
+                                const std::vector<int> &lens, int64_t optim_id) {
+  // Only the dense gradient of a single parameter is compressed, it is sent to the server of the key as a whole.
+  if (push_compress_type_ == PSCompressType::kNoCompress || embedding_table_ranges_.count(keys[0]) > 0 ||
+      std::any_of(keys.begin(), keys.end(), [&keys](const Key &key) { return key != keys[0]; })) {
+    return false;
+  }
+  auto send_idx = kOptimToPSSendIdx.find(Util::optimizer_name(optim_id));
+  if (send_idx == kOptimToPSSendIdx.end() || send_idx->second.count("grad") == 0) {
+    return false;
+  }
+  size_t grad_index = send_idx->second.at("grad");
+  if (grad_index >= lens.size()) {
+    return false;
+  }
+  Key key = keys[0];
+  size_t grad_offset = IntToSize(std::accumulate(lens.begin(), lens.begin() + grad_index, 0));
+  size_t grad_size = IntToSize(lens[grad_index]);
+  if (grad_offset + grad_size > vals.size()) {
+    MS_LOG(EXCEPTION) << "The gradient of key " << key << " is out of the pushed values " << vals.size();
+  }
+
+  std::vector<float> *residual = nullptr;
+  uint32_t seed = 0;
+  {
+    std::lock_guard<std::mutex> lock(compress_mutex_);
+    residual = &push_residuals_[key];
+    seed = ++push_steps_[key] * kPushSeedStride + worker_node_.rank_id();
+  }
+  KVMessage kvs;
+  if (!PSCompressor::Compress(push_compress_type_, vals.data() + grad_offset, grad_size,
+                              PSContext::instance()->push_sparse_rate(), seed, residual, kvs.mutable_compress_data())) {
+    MS_LOG(WARNING) << "Compress the gradient of key " << key << " failed, it is pushed without compression.";
+    return false;
+  }
+  *kvs.mutable_keys() = {keys.begin(), keys.end()};
+  *kvs.mutable_values() = {vals.begin(), vals.begin() + grad_offset};
+  kvs.mutable_values()->Add(vals.begin() + grad_offset + grad_size, vals.end());
+  *kvs.mutable_len() = {lens.begin(), lens.end()};
+  kvs.set_compress_type(static_cast<uint32_t>(push_compress_type_));
+  kvs.set_compress_index(grad_index);
+  uint32_t server_id = static_cast<uint32_t>(key_to_server_id_[key]);
+  worker_node_.Send(core::NodeRole::SERVER, server_id, kvs.SerializeAsString(), kPushCmd);
+  return true;
+}
+
+void Worker::PullCompressedData(const Key &key, std::vector<float> *const vals) {
+  MS_EXCEPTION_IF_NULL(vals);
+  std::pair<uint64_t, std::vector<float>> *snapshot = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(compress_mutex_);
+    snapshot = &pull_snapshots_[key];
+  }
+  // The server replies the full weight if the snapshot version mismatches its own, e.g. the first pull.
+  KVMessage kvs;
+  kvs.add_keys(key);
+  kvs.set_compress_type(static_cast<uint32_t>(pull_compress_type_));
+  kvs.set_compress_index(snapshot->first);
+  kvs.set_rank_id(worker_node_.rank_id());
+  VectorPtr resp = nullptr;
+  uint32_t server_id = static_cast<uint32_t>(key_to_server_id_[key]);
+  worker_node_.Send(core::NodeRole::SERVER, server_id, kvs.SerializeAsString(), kPullCmd, &resp);
+  MS_EXCEPTION_IF_NULL(resp);
+  KVMessage message;
+  CHECK_RETURN_TYPE(message.ParseFromArray(resp->data(), SizeToInt(resp->size())));
+  if (message.compress_type() == static_cast<uint32_t>(PSCompressType::kNoCompress)) {
+    snapshot->second.assign(message.values().begin(), message.values().end());
+  } else if (!PSCompressor::DecodeDelta(message.compress_data(), &snapshot->second)) {
+    MS_LOG(EXCEPTION) << "Decode the pulled weight of key " << key << " failed.";
+  }
+  snapshot->first = message.compress_index();
+  *vals = snapshot->second;
+}
+
 void Worker::LookupIdPartitioner(const EmbeddingTableLookup &send, PartitionEmbeddingMessages *partition,
                                  const std::map<int64_t, int64_t> &) {
   MS_EXCEPTION_IF_NULL(partition);
@@ -678,6 +812,8 @@ void Worker::LookupIdPartitioner(const EmbeddingTableLookup &send, PartitionEmbe
   const Key &key = send.key();
   const std::vector<EmbeddingTableShardMetadata> &ranges = *(embedding_table_ranges_[key]);
   partition->resize(ranges.size());
+  uint64_t step = 0;
+  std::shared_ptr<EmbeddingShardMap> shard_map = EmbeddingHashShard(key) ? RoutingShardMap(key, &step) : nullptr;
 
   for (size_t i = 0; i < ranges.size(); i++) {
     const EmbeddingTableShardMetadata &range = ranges[i];
@@ -687,9 +823,20 @@ void Worker::LookupIdPartitioner(const EmbeddingTableLookup &send, PartitionEmbe
     auto &kvs = partition->at(i).second;
 
     kvs.set_key(key);
+    if (shard_map != nullptr) {
+      EmbeddingShardMeta *shard_meta = kvs.mutable_shard_meta();
+      shard_meta->set_key(key);
+      shard_meta->set_version(shard_map->version());
+      shard_meta->set_step(step);
+    }
 
     std::for_each(send.keys().begin(), send.keys().end(), [&](int32_t lookup_id) {
-      if (lookup_id >= SizeToInt(begin) && lookup_id <= SizeToInt(end)) {
+      if (shard_map != nullptr) {
+        if (lookup_id >= 0 && IntToSize(lookup_id) < shard_map->row_count() &&
+            shard_map->OwnerOf(IntToSize(lookup_id)) == i) {
+          unique_ids.insert(lookup_id);
+        }
+      } else if (lookup_id >= SizeToInt(begin) && lookup_id <= SizeToInt(end)) {
         unique_ids.insert(lookup_id);
       }
     });
@@ -755,6 +902,8 @@ void Worker::SparsePartitioner(const KVMessage &send, PartitionKVMessages *parti
   const Key &key = send.keys()[0];
   const std::vector<EmbeddingTableShardMetadata> &ranges = *(embedding_table_ranges_[key]);
   partition->resize(ranges.size());
+  uint64_t step = 0;
+  std::shared_ptr<EmbeddingShardMap> shard_map = EmbeddingHashShard(key) ? RoutingShardMap(key, &step) : nullptr;
 
   // Construct reduced sparse data for each server
   for (size_t i = 0; i < ranges.size(); i++) {
@@ -770,7 +919,10 @@ void Worker::SparsePartitioner(const KVMessage &send, PartitionKVMessages *parti
     mindspore::HashSet<int> distinct_ids;
     for (size_t j = 0; j < indice_size; j++) {
       size_t indice = static_cast<size_t>(indice_data[j]);
-      if (indice >= begin && indice <= end) {
+      bool on_server = shard_map != nullptr
+                         ? indice_data[j] >= 0 && indice < shard_map->row_count() && shard_map->OwnerOf(indice) == i
+                         : indice >= begin && indice <= end;
+      if (on_server) {
         indice_ids.push_back(indice);
         distinct_ids.insert(indice);
       }
@@ -862,6 +1014,24 @@ void Worker::WorkerInitEmbeddingPartitioner(const KVMessage &send, std::vector<s
   auto lens = send.len();
 
   int32_t col_cnt = lens[0] / embedding_row_cnt_[keys[0]];
+  if (EmbeddingHashShard(keys[0])) {
+    // Each server is sent the rows of its buckets in ascending order, which is the order of its local slots.
+    uint64_t step = 0;
+    std::shared_ptr<EmbeddingShardMap> shard_map = RoutingShardMap(keys[0], &step);
+    MS_EXCEPTION_IF_NULL(shard_map);
+    for (size_t i = 0; i < partition->size(); i++) {
+      KVMessage kvs;
+      *kvs.mutable_keys() = keys;
+      for (size_t bucket : shard_map->OwnedBuckets(static_cast<uint32_t>(i))) {
+        auto begin = values.begin() + bucket * shard_map->bucket_rows() * IntToSize(col_cnt);
+        kvs.mutable_values()->Add(begin, begin + shard_map->BucketRowNum(bucket) * IntToSize(col_cnt));
+      }
+      kvs.add_len(kvs.values_size());
+      partition->at(i).first = true;
+      partition->at(i).second = kvs;
+    }
+    return;
+  }
   const std::vector<EmbeddingTableShardMetadata> &ranges = *(embedding_table_ranges_[keys[0]]);
   for (size_t i = 0; i < ranges.size(); i++) {
     size_t offset_begin = ranges[i].begin() * col_cnt;
@@ -954,8 +1124,10 @@ void Worker::SendForPull(int cmd, const KVMessage &send, const KVPartitioner &pa
     }
   }
   std::vector<VectorPtr> resp;
-  worker_node_.Send(core::NodeRole::SERVER, rank_ids, data_strs, cmd, &resp);
   vals->clear();
+  if (!SendWithRetry(rank_ids, data_strs, cmd, &resp)) {
+    return;
+  }
   for (size_t i = 0; i < resp.size(); ++i) {
     KVMessage message;
     CHECK_RETURN_TYPE(message.ParseFromArray(resp.at(i)->data(), SizeToInt(resp.at(i)->size())));
@@ -967,5 +1139,268 @@ void Worker::SendForPull(int cmd, const KVMessage &send, const KVPartitioner &pa
     }
   }
 }
+
+bool Worker::SendWithRetry(const std::vector<uint32_t> &rank_ids, const std::vector<std::string> &data_strs, int cmd,
+                           std::vector<VectorPtr> *resp) {
+  MS_EXCEPTION_IF_NULL(resp);
+  while (!worker_node_.Send(core::NodeRole::SERVER, rank_ids, data_strs, cmd, resp)) {
+    MS_LOG(INFO) << "Worker send failed!, retrying.";
+    resp->clear();
+    if (!running_) {
+      MS_LOG(ERROR) << "Worker send failed!";
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(kRetryDuration));
+  }
+  return true;
+}
+
+void Worker::PullEmbeddingRows(const Key &key, std::vector<float> *const vals) {
+  MS_EXCEPTION_IF_NULL(vals);
+  KVMessage kvs;
+  kvs.add_keys(key);
+  PartitionKVMessages messages;
+  broadcast_partitioner_(kvs, &messages, {});
+  std::vector<uint32_t> rank_ids;
+  std::vector<std::string> data_strs;
+  for (size_t i = 0; i < messages.size(); i++) {
+    rank_ids.push_back(i);
+    data_strs.emplace_back(messages.at(i).second.SerializeAsString());
+  }
+  std::vector<VectorPtr> resp;
+  if (!SendWithRetry(rank_ids, data_strs, kPullCmd, &resp)) {
+    MS_LOG(EXCEPTION) << "Pull the rows of the embedding table of key " << key << " failed.";
+  }
+
+  size_t row_count = embedding_row_cnt_[key];
+  if (row_count == 0) {
+    MS_LOG(EXCEPTION) << "The embedding table of key " << key << " has no rows.";
+  }
+  size_t row_size = vals->size() / row_count;
+  size_t bucket_rows = EmbeddingShardMap::BucketRows(row_count);
+  for (size_t i = 0; i < resp.size(); ++i) {
+    KVMessage message;
+    CHECK_RETURN_TYPE(message.ParseFromArray(resp.at(i)->data(), SizeToInt(resp.at(i)->size())));
+    // The 'len' of the reply are the buckets of the rows in order.
+    size_t offset = 0;
+    for (uint64_t bucket : message.len()) {
+      size_t begin = bucket * bucket_rows;
+      size_t rows = begin < row_count ? std::min(bucket_rows, row_count - begin) : 0;
+      if (offset + rows * row_size > IntToSize(message.values_size())) {
+        MS_LOG(EXCEPTION) << "The pulled rows of the embedding table of key " << key << " are less than the buckets.";
+      }
+      (void)std::copy(message.values().begin() + offset, message.values().begin() + offset + rows * row_size,
+                      vals->begin() + begin * row_size);
+      offset += rows * row_size;
+    }
+  }
+}
+
+bool Worker::EmbeddingHashShard(const Key &key) const {
+  return PSContext::instance()->enable_embedding_hash_shard() && embedding_table_ranges_.count(key) > 0;
+}
+
+std::shared_ptr<EmbeddingShardMap> Worker::RoutingShardMap(const Key &key, uint64_t *step) {
+  MS_EXCEPTION_IF_NULL(step);
+  std::lock_guard<std::mutex> lock(embedding_shard_mutex_);
+  *step = embedding_push_steps_[key];
+  auto pending_iter = pending_shard_maps_.find(key);
+  if (pending_iter != pending_shard_maps_.end() && *step >= pending_iter->second.first) {
+    MS_LOG(INFO) << "The embedding table of key " << key << " switches to the placement of version "
+                 << pending_iter->second.second->version() << " at step " << *step;
+    embedding_shard_maps_[key] = pending_iter->second.second;
+    (void)pending_shard_maps_.erase(pending_iter);
+  }
+  auto iter = embedding_shard_maps_.find(key);
+  if (iter == embedding_shard_maps_.end()) {
+    MS_LOG(EXCEPTION) << "The embedding table of key " << key << " is not sharded by consistent hashing.";
+  }
+  return iter->second;
+}
+
+void Worker::UpdateShardMeta(const EmbeddingShardMeta &shard_meta) {
+  const Key &key = shard_meta.key();
+  std::lock_guard<std::mutex> lock(embedding_shard_mutex_);
+  auto iter = embedding_shard_maps_.find(key);
+  if (iter == embedding_shard_maps_.end() || shard_meta.version() <= iter->second->version()) {
+    return;
+  }
+  auto pending_iter = pending_shard_maps_.find(key);
+  if (pending_iter != pending_shard_maps_.end() && shard_meta.version() <= pending_iter->second.second->version()) {
+    return;
+  }
+  std::vector<uint32_t> server_ranks = {shard_meta.server_ranks().begin(), shard_meta.server_ranks().end()};
+  auto shard_map = std::make_shared<EmbeddingShardMap>(iter->second->row_count(), server_ranks, shard_meta.version());
+  pending_shard_maps_[key] = std::make_pair(shard_meta.switch_step(), shard_map);
+  MS_LOG(INFO) << "The embedding table of key " << key << " will switch to the placement of version "
+               << shard_meta.version() << " on " << server_ranks.size() << " servers at step "
+               << shard_meta.switch_step();
+}
+
+bool Worker::RetryEmbeddingLookup(const std::vector<KVMessage> &responses) {
+  bool retry = false;
+  for (const auto &response : responses) {
+    if (!response.has_shard_meta()) {
+      continue;
+    }
+    UpdateShardMeta(response.shard_meta());
+    if (response.shard_meta().state() == static_cast<uint32_t>(EmbeddingMigrationState::kRetry)) {
+      retry = true;
+    }
+  }
+  return retry;
+}
+
+void Worker::RebalanceEmbeddingTables() {
+  if (rebalancing_) {
+    return;
+  }
+  // The tables are placed on the first 'embedding_server_num' servers, 0 means all the servers.
+  size_t server_num = PSContext::instance()->embedding_server_num();
+  if (server_num == 0 || server_num > LongToSize(server_num_)) {
+    server_num = LongToSize(server_num_);
+  }
+  if (server_num == embedding_server_num_) {
+    return;
+  }
+  if (rebalance_thread_ != nullptr && rebalance_thread_->joinable()) {
+    rebalance_thread_->join();
+  }
+  MS_LOG(INFO) << "Start migrating the embedding tables from " << embedding_server_num_ << " servers to "
+               << server_num << " servers.";
+  embedding_server_num_ = server_num;
+  std::vector<uint32_t> server_ranks(server_num);
+  for (size_t i = 0; i < server_num; i++) {
+    server_ranks[i] = static_cast<uint32_t>(i);
+  }
+  rebalancing_ = true;
+  rebalance_thread_ = std::make_unique<std::thread>(&Worker::MigrateEmbeddingTables, this, server_ranks);
+}
+
+void Worker::MigrateEmbeddingTables(const std::vector<uint32_t> &server_ranks) {
+  std::vector<Key> keys;
+  {
+    std::lock_guard<std::mutex> lock(embedding_shard_mutex_);
+    (void)std::transform(embedding_shard_maps_.begin(), embedding_shard_maps_.end(), std::back_inserter(keys),
+                         [](const auto &iter) { return iter.first; });
+  }
+  try {
+    for (const Key &key : keys) {
+      if (!MigrateEmbeddingTable(key, server_ranks)) {
+        MS_LOG(WARNING) << "The embedding table of key " << key << " is not migrated to " << server_ranks.size()
+                        << " servers.";
+      }
+    }
+  } catch (const std::exception &e) {
+    MS_LOG(ERROR) << "Migrating the embedding tables failed: " << e.what();
+  }
+  rebalancing_ = false;
+}
+
+bool Worker::MigrateEmbeddingTable(const Key &key, const std::vector<uint32_t> &server_ranks) {
+  EmbeddingShardMeta request;
+  request.set_key(key);
+  std::vector<EmbeddingShardMeta> responses;
+  auto all_in_state = [&responses](EmbeddingMigrationState state) {
+    return std::all_of(responses.begin(), responses.end(), [state](const EmbeddingShardMeta &response) {
+      return response.state() == static_cast<uint32_t>(state);
+    });
+  };
+  auto any_in_state = [&responses](EmbeddingMigrationState state) {
+    return std::any_of(responses.begin(), responses.end(), [state](const EmbeddingShardMeta &response) {
+      return response.state() == static_cast<uint32_t>(state);
+    });
+  };
+
+  // Wait for the handoff of the last migration.
+  request.set_phase(static_cast<uint32_t>(EmbeddingMigrationPhase::kQuery));
+  while (true) {
+    if (!SendMigrationPhase(request, &responses)) {
+      return false;
+    }
+    if (all_in_state(EmbeddingMigrationState::kIdle)) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(kEmbeddingMigrateIntervalInMs));
+  }
+  uint64_t version = 0;
+  for (const auto &response : responses) {
+    version = std::max(version, response.version());
+  }
+  std::vector<uint32_t> current_ranks = {responses.front().server_ranks().begin(),
+                                         responses.front().server_ranks().end()};
+  size_t row_count = embedding_row_cnt_[key];
+  if (EmbeddingShardMap(row_count, current_ranks, version).SamePlacement(server_ranks)) {
+    return true;
+  }
+
+  // Prepare the migration on all the servers, the moved rows are pre-copied while the training goes on.
+  request.set_version(version + 1);
+  *request.mutable_server_ranks() = {server_ranks.begin(), server_ranks.end()};
+  request.set_phase(static_cast<uint32_t>(EmbeddingMigrationPhase::kPrepare));
+  bool prepared = SendMigrationPhase(request, &responses) && !any_in_state(EmbeddingMigrationState::kFailed);
+  request.set_phase(static_cast<uint32_t>(EmbeddingMigrationPhase::kQuery));
+  while (prepared) {
+    if (!SendMigrationPhase(request, &responses) || any_in_state(EmbeddingMigrationState::kFailed)) {
+      prepared = false;
+      break;
+    }
+    if (all_in_state(EmbeddingMigrationState::kConverged)) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(kEmbeddingMigrateIntervalInMs));
+  }
+  if (!prepared) {
+    request.set_phase(static_cast<uint32_t>(EmbeddingMigrationPhase::kAbort));
+    (void)SendMigrationPhase(request, &responses);
+    return false;
+  }
+
+  // The pushes of this worker are blocked while the commit is sent, so the switch step is still ahead of all the
+  // workers, which are at most one step ahead of the servers.
+  std::lock_guard<std::mutex> lock(embedding_shard_mutex_);
+  uint64_t step = embedding_push_steps_[key];
+  for (const auto &response : responses) {
+    step = std::max(step, response.step() + 1);
+  }
+  uint64_t switch_step = step + kEmbeddingSwitchStepLag;
+  request.set_switch_step(switch_step);
+  // The servers which accept the switch step hold their updates until the decision, so the migration is rolled back
+  // on all the servers if any of them refuses, and the commit can't be refused after that.
+  request.set_phase(static_cast<uint32_t>(EmbeddingMigrationPhase::kPrecommit));
+  if (!SendMigrationPhase(request, &responses) || !all_in_state(EmbeddingMigrationState::kPrecommitted)) {
+    MS_LOG(WARNING) << "Precommit the migration of the embedding table of key " << key << " at step " << switch_step
+                    << " failed, roll it back.";
+    request.set_phase(static_cast<uint32_t>(EmbeddingMigrationPhase::kAbort));
+    (void)SendMigrationPhase(request, &responses);
+    return false;
+  }
+  request.set_phase(static_cast<uint32_t>(EmbeddingMigrationPhase::kCommit));
+  if (!SendMigrationPhase(request, &responses) || !all_in_state(EmbeddingMigrationState::kCommitted)) {
+    MS_LOG(EXCEPTION) << "Commit the migration of the embedding table of key " << key << " at step " << switch_step
+                      << " failed.";
+  }
+  pending_shard_maps_[key] =
+    std::make_pair(switch_step, std::make_shared<EmbeddingShardMap>(row_count, server_ranks, version + 1));
+  MS_LOG(INFO) << "The embedding table of key " << key << " is migrated to " << server_ranks.size()
+               << " servers, the workers switch at step " << switch_step;
+  return true;
+}
+
+bool Worker::SendMigrationPhase(const EmbeddingShardMeta &request, std::vector<EmbeddingShardMeta> *responses) {
+  MS_EXCEPTION_IF_NULL(responses);
+  std::vector<uint32_t> rank_ids(LongToSize(server_num_));
+  std::iota(rank_ids.begin(), rank_ids.end(), 0);
+  std::vector<std::string> data_strs(rank_ids.size(), request.SerializeAsString());
+  std::vector<VectorPtr> resp;
+  if (!SendWithRetry(rank_ids, data_strs, kMigrateEmbeddingCmd, &resp)) {
+    return false;
+  }
+  responses->resize(resp.size());
+  for (size_t i = 0; i < resp.size(); ++i) {
+    CHECK_RETURN_TYPE(responses->at(i).ParseFromArray(resp.at(i)->data(), SizeToInt(resp.at(i)->size())));
+  }
+  return !responses->empty();
+}
 }  // namespace ps
 }  // namespace mindspore
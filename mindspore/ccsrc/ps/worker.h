@@ -26,6 +26,8 @@
 #include <algorithm>
 #include <map>
 #include <mutex>
+#include <atomic>
+#include <thread>
 
 #include "utils/hash_map.h"
 #include "utils/hash_set.h"
@@ -37,9 +39,11 @@
 #include "ps/ps_cache/ps_data/ps_data_prefetch.h"
 #include "ps/core/ps_worker_node.h"
 #include "ps/embedding_table_shard_metadata.h"
+#include "ps/embedding_shard_table.h"
 #include "proto/comm.pb.h"
 #include "proto/ps.pb.h"
 #include "ps/ps_context.h"
+#include "ps/ps_compressor.h"
 #include "include/backend/visible.h"
 
 namespace mindspore {
@@ -105,6 +109,27 @@ class BACKEND_EXPORT Worker {
                       size_t grad_index, size_t indice_index, size_t first_dim_size, size_t outer_dim_size);
   void PullData(const std::vector<Key> &keys, std::vector<float> *const vals, std::vector<int> *lens = nullptr,
                 int cmd = 0, int64_t priority = 0);
+  // Return false if the push can't be compressed, then it should be pushed by PushData.
+  bool PushCompressedData(const std::vector<Key> &keys, const std::vector<float> &vals, const std::vector<int> &lens,
+                          int64_t optim_id);
+  void PullCompressedData(const Key &key, std::vector<float> *const vals);
+  // Pull the rows of the consistent hash sharded table, each server replies the rows of its buckets.
+  void PullEmbeddingRows(const Key &key, std::vector<float> *const vals);
+
+  // Whether the embedding table is sharded by consistent hashing instead of the ranges.
+  bool EmbeddingHashShard(const Key &key) const;
+  // The placement the lookups and the pushes of the current step are routed by, and the current push step.
+  std::shared_ptr<EmbeddingShardMap> RoutingShardMap(const Key &key, uint64_t *step);
+  // Learn the placement committed by the worker 0 from the lookup responses.
+  void UpdateShardMeta(const EmbeddingShardMeta &shard_meta);
+  // Return true if the lookup should be retried, e.g. the rows are not handed off to the new owner yet.
+  bool RetryEmbeddingLookup(const std::vector<KVMessage> &responses);
+
+  // The worker 0 migrates the embedding tables to the number of the servers set by 'embedding_server_num'.
+  void RebalanceEmbeddingTables();
+  void MigrateEmbeddingTables(const std::vector<uint32_t> &server_ranks);
+  bool MigrateEmbeddingTable(const Key &key, const std::vector<uint32_t> &server_ranks);
+  bool SendMigrationPhase(const EmbeddingShardMeta &request, std::vector<EmbeddingShardMeta> *responses);
 
   void LookupIdPartitioner(const EmbeddingTableLookup &send, PartitionEmbeddingMessages *partition,
                            const std::map<int64_t, int64_t> &attrs);
@@ -123,6 +148,9 @@ class BACKEND_EXPORT Worker {
                    const std::map<int64_t, int64_t> &attrs);
   void SendForPull(int cmd, const KVMessage &send, const KVPartitioner &partitioner,
                    const std::map<int64_t, int64_t> &attrs, std::vector<float> *vals, std::vector<int> *lens);
+  // Send the requests to the servers and wait for the responses, retry until it succeeds or the worker stops.
+  bool SendWithRetry(const std::vector<uint32_t> &rank_ids, const std::vector<std::string> &data_strs, int cmd,
+                     std::vector<VectorPtr> *resp);
 
   int64_t server_num_;
   bool running_;
@@ -145,6 +173,26 @@ class BACKEND_EXPORT Worker {
   mindspore::HashMap<Key, size_t> embedding_row_cnt_;
 
   mindspore::HashMap<Key, std::shared_ptr<std::vector<EmbeddingTableShardMetadata>>> embedding_table_ranges_;
+
+  // The compress error of the pushed gradients and the weight snapshots of the delta encoded pulls of each key, the
+  // elements of std::map are never moved so each key is compressed out of the lock.
+  PSCompressType push_compress_type_{PSCompressType::kNoCompress};
+  PSCompressType pull_compress_type_{PSCompressType::kNoCompress};
+  std::mutex compress_mutex_;
+  std::map<Key, std::vector<float>> push_residuals_;
+  std::map<Key, uint32_t> push_steps_;
+  std::map<Key, std::pair<uint64_t, std::vector<float>>> pull_snapshots_;
+
+  // The placement of each consistent hash sharded embedding table, the placement committed but not switched to yet with
+  // its switch step, and the number of the pushes of each table.
+  std::mutex embedding_shard_mutex_;
+  std::map<Key, std::shared_ptr<EmbeddingShardMap>> embedding_shard_maps_;
+  std::map<Key, std::pair<uint64_t, std::shared_ptr<EmbeddingShardMap>>> pending_shard_maps_;
+  std::map<Key, uint64_t> embedding_push_steps_;
+  // The number of the servers the embedding tables are placed on, and the migration run by the worker 0.
+  size_t embedding_server_num_{0};
+  std::unique_ptr<std::thread> rebalance_thread_{nullptr};
+  std::atomic_bool rebalancing_{false};
 };
 }  // namespace ps
 }  // namespace mindspore
@@ -194,20 +194,43 @@ bool MemScheduler::PreComputeGet(const std::shared_ptr<MemEvent> &event, void *s
     return false;
   }
   auto device_ptr = MallocDevice(mem_size, stream);
+  if (device_ptr == nullptr) {
+    return false;
+  }
   mem_handler_->SwapIn(host_ptr, device_ptr, mem_size, stream);
   if (!from_init) {
-    (void)swap_host_ptr_.erase(host_ptr);
+    (void)swap_host_ptr_.erase(key);
     mem_handler_->FreeHost(host_ptr);
   }
   mem_result_[key] = device_ptr;
   return true;
 }
 
+void MemScheduler::PrefetchSwapInMem() {
+  if (!optimized_ || prefetch_step_ == 0 || total_step_ == 0) {
+    return;
+  }
+  // The memory swapped in at the step which is prefetch_step_ steps later, it may be in the next run of graph.
+  const auto prefetch_step = (current_step_ + prefetch_step_) % total_step_;
+  const auto &events = strategy_->GetPreComputeEvents(prefetch_step);
+  for (const auto &event : events) {
+    MS_EXCEPTION_IF_NULL(event);
+    if (event->type != kSwapIn || mem_result_.count(event->key) != 0) {
+      continue;
+    }
+    const auto iter = swap_host_ptr_.find(event->key);
+    if (iter != swap_host_ptr_.end() && iter->second != nullptr) {
+      mem_handler_->PrefetchHost(iter->second, event->mem_size);
+    }
+  }
+}
+
 bool MemScheduler::PreCompute(void *stream) {
   if (strategy_ == nullptr) {
     return true;
   }
   MS_EXCEPTION_IF_NULL(mem_handler_);
+  PrefetchSwapInMem();
   auto &events = strategy_->GetPreComputeEvents(current_step_);
   for (auto &event : events) {
     MS_EXCEPTION_IF_NULL(event);
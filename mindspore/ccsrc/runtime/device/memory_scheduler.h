@@ -36,10 +36,14 @@ class MemHandler {
   virtual void FreeHost(void *ptr) = 0;
   virtual void SwapIn(const void *host_ptr, void *device_ptr, size_t mem_size, void *stream) = 0;
   virtual void SwapOut(const void *device_ptr, void *host_ptr, size_t mem_size, void *stream) = 0;
+  // Hint that the host memory will be swapped in soon, the host memory backed by the disk can be read ahead.
+  virtual void PrefetchHost(const void *host_ptr, size_t mem_size) {}
 };
 
 class MemScheduler {
  public:
+  static constexpr size_t kDefaultPrefetchStep = 2;
+
   MemScheduler() = default;
   ~MemScheduler() = default;
 
@@ -88,6 +92,9 @@ class MemScheduler {
 
   void ClearMemNeedInit() { high_priority_mem_need_init_.clear(); }
 
+  // The host memory swapped in at the later steps is prefetched in PreCompute.
+  void set_prefetch_step(size_t prefetch_step) { prefetch_step_ = prefetch_step; }
+
  private:
   void Record(const void *key, const MemEventType &event_type, size_t mem_size = 0);
 
@@ -115,6 +122,8 @@ class MemScheduler {
 
   bool PreComputeGet(const std::shared_ptr<MemEvent> &event, void *stream);
 
+  void PrefetchSwapInMem();
+
   std::map<const void *, MemPriority> mem_priority_;
   std::map<const void *, std::vector<std::shared_ptr<MemEvent>>> mem_events_;
   std::set<const void *> manual_offload_keys_;
@@ -126,6 +135,7 @@ class MemScheduler {
   std::set<const void *> high_priority_mem_need_init_;
   size_t total_step_{0};
   size_t current_step_{0};
+  size_t prefetch_step_{kDefaultPrefetchStep};
   bool need_record_event_{true};
   bool optimized_{false};
   double compute_start_time_{0};
@@ -0,0 +1,227 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "runtime/device/mmap_swap_file.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <cerrno>
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace device {
+namespace {
+size_t AlignUp(size_t size, size_t align) { return (size + align - 1) / align * align; }
+}  // namespace
+
+MmapSwapFile::MmapSwapFile(const std::string &dir_path, size_t segment_size) {
+#ifdef _WIN32
+  MS_LOG(EXCEPTION) << "The swap file is not supported on windows, dir path: " << dir_path
+                    << ", segment size: " << segment_size;
+#else
+  page_size_ = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  segment_size_ = AlignUp(segment_size, page_size_);
+  std::string file_template = dir_path + "/ms_swap_XXXXXX";
+  std::vector<char> file_name(file_template.begin(), file_template.end());
+  file_name.push_back('\0');
+  fd_ = mkstemp(file_name.data());
+  if (fd_ < 0) {
+    MS_LOG(EXCEPTION) << "Create the swap file in " << dir_path << " failed, errno: " << errno;
+  }
+  // The file is removed from the disk when it is closed.
+  (void)unlink(file_name.data());
+  MS_LOG(INFO) << "Create the swap file " << file_name.data() << ", segment size: " << segment_size_;
+#endif
+}
+
+MmapSwapFile::~MmapSwapFile() {
+#ifndef _WIN32
+  for (const auto &segment : segments_) {
+    (void)munmap(segment.base_, segment.size_);
+  }
+  segments_.clear();
+  if (fd_ >= 0) {
+    (void)close(fd_);
+    fd_ = -1;
+  }
+#endif
+}
+
+bool MmapSwapFile::AddSegment(size_t size) {
+#ifdef _WIN32
+  return false;
+#else
+  const auto segment_size = std::max(segment_size_, size);
+  const auto new_file_size = file_size_ + segment_size;
+  // The file is sparse, the disk is only used by the written pages.
+  if (ftruncate(fd_, static_cast<off_t>(new_file_size)) != 0) {
+    MS_LOG(ERROR) << "Resize the swap file to " << new_file_size << " failed, errno: " << errno;
+    return false;
+  }
+  auto base = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, static_cast<off_t>(file_size_));
+  if (base == MAP_FAILED) {
+    MS_LOG(ERROR) << "Map the swap file segment of size " << segment_size << " failed, errno: " << errno;
+    (void)ftruncate(fd_, static_cast<off_t>(file_size_));
+    return false;
+  }
+  const auto segment_index = segments_.size();
+  (void)segments_.emplace_back(Segment{static_cast<uint8_t *>(base), segment_size, file_size_});
+  AddIdleBlock(static_cast<uint8_t *>(base), {segment_size, segment_index});
+  file_size_ = new_file_size;
+  MS_LOG(INFO) << "Add the swap file segment of size " << segment_size << ", file size: " << file_size_;
+  return true;
+#endif
+}
+
+void MmapSwapFile::AddIdleBlock(const uint8_t *ptr, const BlockInfo &block_info) {
+  idle_blocks_[ptr] = block_info;
+  (void)idle_sizes_.emplace(block_info.first, ptr);
+}
+
+void MmapSwapFile::RemoveIdleBlock(std::map<const uint8_t *, BlockInfo>::iterator iter) {
+  auto range = idle_sizes_.equal_range(iter->second.first);
+  for (auto size_iter = range.first; size_iter != range.second; ++size_iter) {
+    if (size_iter->second == iter->first) {
+      (void)idle_sizes_.erase(size_iter);
+      break;
+    }
+  }
+  (void)idle_blocks_.erase(iter);
+}
+
+void *MmapSwapFile::TakeIdleBlock(size_t size) {
+  // The smallest idle block which is large enough.
+  auto size_iter = idle_sizes_.lower_bound(size);
+  if (size_iter == idle_sizes_.end()) {
+    return nullptr;
+  }
+  auto block_iter = idle_blocks_.find(size_iter->second);
+  if (block_iter == idle_blocks_.end()) {
+    MS_LOG(EXCEPTION) << "The idle block of size " << size_iter->first << " is missing in the swap file.";
+  }
+  const auto block_ptr = block_iter->first;
+  const auto block_info = block_iter->second;
+  RemoveIdleBlock(block_iter);
+  if (block_info.first > size) {
+    AddIdleBlock(block_ptr + size, {block_info.first - size, block_info.second});
+  }
+  used_blocks_[block_ptr] = {size, block_info.second};
+  used_size_ += size;
+  return const_cast<uint8_t *>(block_ptr);
+}
+
+void *MmapSwapFile::Malloc(size_t size) {
+  const auto alloc_size = AlignUp(std::max(size, static_cast<size_t>(1)), page_size_);
+  auto ptr = TakeIdleBlock(alloc_size);
+  if (ptr != nullptr || !AddSegment(alloc_size)) {
+    return ptr;
+  }
+  return TakeIdleBlock(alloc_size);
+}
+
+bool MmapSwapFile::Free(void *ptr) {
+  auto iter = used_blocks_.find(static_cast<const uint8_t *>(ptr));
+  if (iter == used_blocks_.end()) {
+    return false;
+  }
+  const auto block_ptr = iter->first;
+  auto block_info = iter->second;
+  (void)used_blocks_.erase(iter);
+  used_size_ -= block_info.first;
+#ifdef __linux__
+  // The data of the free block is useless, drop it from the page cache and the disk.
+  uint8_t *page_ptr = nullptr;
+  size_t page_size = 0;
+  size_t file_offset = 0;
+  if (GetFileRange(block_ptr, block_info.first, &page_ptr, &page_size, &file_offset)) {
+    (void)fallocate(fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(file_offset),
+                    static_cast<off_t>(page_size));
+  }
+#endif
+
+  // Combine the block with the adjacent idle blocks of the same segment.
+  auto next_iter = idle_blocks_.find(block_ptr + block_info.first);
+  if (next_iter != idle_blocks_.end() && next_iter->second.second == block_info.second) {
+    block_info.first += next_iter->second.first;
+    RemoveIdleBlock(next_iter);
+  }
+  auto prev_iter = idle_blocks_.lower_bound(block_ptr);
+  if (prev_iter != idle_blocks_.begin()) {
+    --prev_iter;
+    if (prev_iter->first + prev_iter->second.first == block_ptr && prev_iter->second.second == block_info.second) {
+      const auto prev_ptr = prev_iter->first;
+      block_info.first += prev_iter->second.first;
+      RemoveIdleBlock(prev_iter);
+      AddIdleBlock(prev_ptr, block_info);
+      return true;
+    }
+  }
+  AddIdleBlock(block_ptr, block_info);
+  return true;
+}
+
+bool MmapSwapFile::GetFileRange(const void *ptr, size_t size, uint8_t **page_ptr, size_t *page_size,
+                                size_t *file_offset) const {
+  const auto begin = static_cast<const uint8_t *>(ptr);
+  for (const auto &segment : segments_) {
+    if (begin < segment.base_ || begin + size > segment.base_ + segment.size_) {
+      continue;
+    }
+    const auto begin_offset = (static_cast<size_t>(begin - segment.base_) / page_size_) * page_size_;
+    const auto end_offset = std::min(AlignUp(static_cast<size_t>(begin - segment.base_) + size, page_size_),
+                                     segment.size_);
+    *page_ptr = segment.base_ + begin_offset;
+    *page_size = end_offset - begin_offset;
+    *file_offset = segment.file_offset_ + begin_offset;
+    return true;
+  }
+  return false;
+}
+
+void MmapSwapFile::Prefetch(const void *ptr, size_t size) const {
+#ifndef _WIN32
+  uint8_t *page_ptr = nullptr;
+  size_t page_size = 0;
+  size_t file_offset = 0;
+  if (!GetFileRange(ptr, size, &page_ptr, &page_size, &file_offset)) {
+    return;
+  }
+  // The read ahead is started by the kernel and doesn't block.
+  (void)madvise(page_ptr, page_size, MADV_WILLNEED);
+#endif
+}
+
+void MmapSwapFile::Evict(const void *ptr, size_t size) const {
+#ifndef _WIN32
+  uint8_t *page_ptr = nullptr;
+  size_t page_size = 0;
+  size_t file_offset = 0;
+  if (!GetFileRange(ptr, size, &page_ptr, &page_size, &file_offset)) {
+    return;
+  }
+#ifdef __linux__
+  // Start writing the dirty pages back without waiting, then they can be reclaimed at once under memory pressure.
+  (void)sync_file_range(fd_, static_cast<off_t>(file_offset), static_cast<off_t>(page_size), SYNC_FILE_RANGE_WRITE);
+#endif
+  // The dirty pages are kept in the page cache of the shared file mapping, so the data is not lost.
+  (void)madvise(page_ptr, page_size, MADV_DONTNEED);
+#endif
+}
+}  // namespace device
+}  // namespace mindspore
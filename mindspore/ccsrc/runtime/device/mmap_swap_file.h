@@ -0,0 +1,80 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_RUNTIME_DEVICE_MMAP_SWAP_FILE_H_
+#define MINDSPORE_CCSRC_RUNTIME_DEVICE_MMAP_SWAP_FILE_H_
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mindspore {
+namespace device {
+// The host memory of the memory offload, which is mapped from a file, so the swapped out memory is backed by the disk
+// instead of the RAM. The file is created in the given directory and removed at once, it grows by segments which are
+// mapped separately, and the blocks are allocated from the segments by the best fit. The pages of a swapped out block
+// are written back and dropped from the process by Evict, and read ahead asynchronously by Prefetch before the block
+// is swapped in.
+class MmapSwapFile {
+ public:
+  explicit MmapSwapFile(const std::string &dir_path, size_t segment_size = kDefaultSegmentSize);
+  ~MmapSwapFile();
+
+  void *Malloc(size_t size);
+  // Return false if the ptr is not allocated from the file.
+  bool Free(void *ptr);
+  bool Contains(const void *ptr) const { return used_blocks_.count(static_cast<const uint8_t *>(ptr)) != 0; }
+
+  // Read the pages of the memory into the page cache asynchronously.
+  void Prefetch(const void *ptr, size_t size) const;
+  // Start the write back of the memory and drop its pages from the process.
+  void Evict(const void *ptr, size_t size) const;
+
+  size_t file_size() const { return file_size_; }
+  size_t used_size() const { return used_size_; }
+
+  static constexpr size_t kDefaultSegmentSize = 1UL << 30;
+
+ private:
+  struct Segment {
+    uint8_t *base_;
+    size_t size_;
+    size_t file_offset_;
+  };
+  // The size and the segment index of a block.
+  using BlockInfo = std::pair<size_t, size_t>;
+
+  bool AddSegment(size_t size);
+  void *TakeIdleBlock(size_t size);
+  void AddIdleBlock(const uint8_t *ptr, const BlockInfo &block_info);
+  void RemoveIdleBlock(std::map<const uint8_t *, BlockInfo>::iterator iter);
+  // The page aligned range of the file which the memory covers.
+  bool GetFileRange(const void *ptr, size_t size, uint8_t **page_ptr, size_t *page_size, size_t *file_offset) const;
+
+  int fd_{-1};
+  size_t page_size_{0};
+  size_t segment_size_{0};
+  size_t file_size_{0};
+  size_t used_size_{0};
+  std::vector<Segment> segments_;
+  // The idle blocks by the address to combine the adjacent ones, and by the size to find the best fit.
+  std::map<const uint8_t *, BlockInfo> idle_blocks_;
+  std::multimap<size_t, const uint8_t *> idle_sizes_;
+  std::map<const uint8_t *, BlockInfo> used_blocks_;
+};
+}  // namespace device
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_RUNTIME_DEVICE_MMAP_SWAP_FILE_H_
@@ -195,6 +195,11 @@ void DumpSuperKernelActor(const SuperKernelActor *actor, std::ofstream &ofs) {
       << "\tis_executing_sink:" << graph->is_executing_sink() << "\tis_loop_count_sink:" << graph->is_loop_count_sink()
       << "\tinputs_num:" << (graph->input_nodes()).size() << "\tkernels_num:" << (graph->execution_order()).size()
       << "\n";
+  const auto &execution_plan = actor->execution_plan();
+  if (execution_plan != nullptr) {
+    ofs << "\t\tstatic_execution_plan_levels_num:" << execution_plan->levels_num()
+        << "\tmemory_size:" << execution_plan->memory_size() << "\n";
+  }
 
   DumpAbstractActor(actor, ofs);
   ofs << "\n";
@@ -75,7 +75,7 @@ void SuperKernelActor::Run(OpContext<DeviceTensor> *const context) {
   }
 
   try {
-    auto ret = device_contexts_[0]->LaunchGraph(graph_);
+    auto ret = (execution_plan_ != nullptr) ? execution_plan_->Run() : device_contexts_[0]->LaunchGraph(graph_);
     if (!ret) {
       std::string error_info = "Launch graph failed, graph id: " + std::to_string(graph_->graph_id());
       SET_OPCONTEXT_FAIL_RET_WITH_ERROR((*context), error_info);
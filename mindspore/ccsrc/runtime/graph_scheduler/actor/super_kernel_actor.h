@@ -25,6 +25,7 @@
 #include <queue>
 #include "runtime/graph_scheduler/actor/debug_aware_actor.h"
 #include "runtime/graph_scheduler/actor/actor_common.h"
+#include "runtime/graph_scheduler/static_execution_plan.h"
 #include "runtime/hardware/device_context.h"
 #include "ir/anf.h"
 
@@ -53,6 +54,7 @@ class SuperKernelActor : public DebugAwareActor {
   void SendMemoryFreeReq(OpContext<DeviceTensor> *const context) override;
 
   const KernelGraphPtr &graph() const { return graph_; }
+  const StaticExecutionPlanPtr &execution_plan() const { return execution_plan_; }
 
  protected:
   void Init() override;
@@ -65,6 +67,9 @@ class SuperKernelActor : public DebugAwareActor {
 
   KernelGraphPtr graph_;
 
+  // The graph is launched by the static execution plan instead of the device when the plan exists.
+  StaticExecutionPlanPtr execution_plan_{nullptr};
+
   std::map<AnfNodePtr, DeviceAddress *> ref_node_addr_map_;
 
   // The lists of device tensors which need free by dynamic ref count, will be cleared at the end of step.
@@ -575,14 +575,19 @@ GraphId GraphCompiler::CompileGraph(const session::OpRunInfo &op_run_info, bool
   // Check if the graph cache exists.
   auto iter = run_op_graphs_.find(op_run_info.graph_info);
   auto &op_executor = runtime::OpExecutor::GetInstance();
-  if (iter != run_op_graphs_.end() && op_executor.BuildQueueEmpty()) {
+  // The cached graph can't be reused until it is built.
+  if (iter != run_op_graphs_.end() && !op_executor.BuildInQueue(iter->second->graph_id())) {
     const auto &graph = iter->second;
     MS_EXCEPTION_IF_NULL(graph);
     SetGraphInputNodeActualAbstract(op_run_info, graph);
     *single_op_cache_hit = true;
+    ++single_op_cache_hit_count_;
     return graph->graph_id();
   }
   *single_op_cache_hit = false;
+  ++single_op_cache_miss_count_;
+  MS_LOG(INFO) << "Single op graph cache miss: " << op_run_info.graph_info
+               << ", hit count: " << single_op_cache_hit_count_ << ", miss count: " << single_op_cache_miss_count_;
   // Generate kernel graph.
   MS_EXCEPTION_IF_NULL(session_);
   KernelGraphPtr graph =
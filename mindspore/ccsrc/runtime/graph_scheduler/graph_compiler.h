@@ -208,6 +208,9 @@ class GraphCompiler {
   mindspore::HashMap<GraphInfo, KernelGraphPtr> run_op_graphs_;
   // Single op kernel graph output nodes cache for PyNative mode.
   mindspore::HashMap<GraphId, std::vector<KernelWithIndex>> run_op_graph_output_nodes_;
+  // The hit and miss count of the single op kernel graph cache.
+  size_t single_op_cache_hit_count_{0};
+  size_t single_op_cache_miss_count_{0};
 
   // The member variable 'session_' will be removed after removing session module.
   // Now all the GraphCompiler share the same 'session_'.
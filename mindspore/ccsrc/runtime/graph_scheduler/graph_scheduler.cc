@@ -434,6 +434,11 @@ void GraphScheduler::Initialize() {
   if (ret != MINDRT_OK) {
     MS_LOG(EXCEPTION) << "Actor manager init failed.";
   }
+  // Run the actors made ready by an actor on the same worker, idle workers steal them.
+  auto thread_pool = actor_manager->GetActorThreadPool();
+  if (thread_pool != nullptr) {
+    thread_pool->SetWorkStealing(true);
+  }
   common::SetOMPThreadNum();
   MS_LOG(INFO) << "The actor thread number: " << actor_thread_num
                << ", the kernel thread number: " << (actor_and_kernel_thread_num - actor_thread_num);
@@ -517,6 +522,7 @@ ActorSet *GraphScheduler::Transform(const GraphCompilerInfo &graph_compiler_info
     execution_order_running_ = true;
     graph_compiler_info.strategy_ = GraphExecutionStrategy::kPipeline;
   }
+  EnableStaticExecutionPlan(graph_compiler_info);
   PersistDeviceTensor(graph_compiler_info);
   const auto &actor_set = Build(graph_compiler_info);
   MS_EXCEPTION_IF_NULL(actor_set);
@@ -957,6 +963,25 @@ std::vector<KernelActorPtr> GraphScheduler::BuildKernelActor(const GraphCompiler
   return kernel_actors;
 }
 
+void GraphScheduler::EnableStaticExecutionPlan(const GraphCompilerInfo &graph_compiler_info) const {
+  // The graphs in the control flow are linked by the control actors kernel by kernel.
+  if ((graph_compiler_info.strategy_ != GraphExecutionStrategy::kPipeline) || execution_order_running_ ||
+      (graph_compiler_info.control_node_parser_ != nullptr && graph_compiler_info.control_node_parser_->IsInited())) {
+    return;
+  }
+
+  for (size_t i = 0; i < graph_compiler_info.graphs_.size(); ++i) {
+    const auto &graph = graph_compiler_info.graphs_[i];
+    MS_EXCEPTION_IF_NULL(graph);
+    const auto &device_context = graph_compiler_info.device_contexts_[i];
+    if (graph->is_executing_sink() || !StaticExecutionPlan::IsSupported(graph, device_context)) {
+      continue;
+    }
+    MS_LOG(INFO) << "The graph " << graph->graph_id() << " is run by the static execution plan.";
+    graph->set_is_executing_sink(true);
+  }
+}
+
 std::vector<SuperKernelActorPtr> GraphScheduler::BuildSuperKernelActor(const GraphCompilerInfo &graph_compiler_info) {
   std::vector<SuperKernelActorPtr> super_kernel_actors;
 
@@ -977,6 +1002,11 @@ std::vector<SuperKernelActorPtr> GraphScheduler::BuildSuperKernelActor(const Gra
     auto super_kernel_actor =
       std::make_shared<SuperKernelActor>(actor_name, graph, device_context, memory_manager_aid_, debug_aid_, nullptr);
     MS_EXCEPTION_IF_NULL(super_kernel_actor);
+    // The CPU device can't launch the graph, so the graph which sinks on CPU is run by the static execution plan.
+    if (device_context->GetDeviceAddressType() == device::DeviceAddressType::kCPU) {
+      super_kernel_actor->execution_plan_ = std::make_shared<StaticExecutionPlan>(graph, device_context);
+      super_kernel_actor->execution_plan_->Compile();
+    }
     InsertActor(super_kernel_actor.get());
     (void)super_kernel_actors.emplace_back(super_kernel_actor);
   }
@@ -1817,9 +1847,15 @@ void GraphScheduler::LinkControlArrowByCommunicationNode(const std::vector<CNode
   }
 
   // Ensure all actors execute orderly to optimize the execution performance in the multi device scenario currently.
-  // Using the multi stream to optimize the performance in the future.
+  // Using the multi stream to optimize the performance in the future. The cpu kernels are launched synchronously, so
+  // the cpu graph whose AllReduce is fused into buckets is not serialized, then the other kernels run on the other
+  // actor threads when a bucket is being reduced.
   if (!execution_order_running_) {
     for (auto &graph : graphs) {
+      MS_EXCEPTION_IF_NULL(graph);
+      if (graph->device_target() == device::DeviceAddressType::kCPU && graph->has_flag(kAttrAllReduceBucketed)) {
+        continue;
+      }
       LinkControlArrowByExecutionOrder(graph);
     }
   }
@@ -92,6 +92,9 @@ class BACKEND_EXPORT GraphScheduler {
   // The Global actors contain memory manager actor, recorder actor and debug actor.
   void BuildAndScheduleGlobalActor();
 
+  // Run the static graphs by the static execution plan in the super kernel actor instead of the kernel actors.
+  void EnableStaticExecutionPlan(const GraphCompilerInfo &graph_compiler_info) const;
+
   // Transform the nodes of graph to actors.
   ActorSetPtr Build(const GraphCompilerInfo &graph_compiler_info);
   // Link actors to DAG through the edge connection of graph and graph execution strategy.
@@ -0,0 +1,497 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "runtime/graph_scheduler/static_execution_plan.h"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <map>
+#include "runtime/graph_scheduler/actor/actor_common.h"
+#include "runtime/device/memory_manager.h"
+#include "runtime/device/kernel_info.h"
+#include "backend/common/somas/somas_solver_pre.h"
+#include "backend/common/session/anf_runtime_algorithm.h"
+#include "include/common/utils/anfalgo.h"
+#include "mindrt/src/actor/actormgr.h"
+#include "utils/ms_context.h"
+#include "utils/ms_utils.h"
+#include "utils/log_adapter.h"
+#ifdef ENABLE_DEBUGGER
+#include "debug/debugger/debugger.h"
+#endif
+#ifndef ENABLE_SECURITY
+#include "debug/data_dump/dump_json_parser.h"
+#endif
+
+namespace mindspore {
+namespace runtime {
+namespace {
+constexpr size_t kInfiniteLevel = std::numeric_limits<size_t>::max();
+constexpr size_t kInvalidKernelIndex = std::numeric_limits<size_t>::max();
+// The reuse matrix of SOMAS takes tensor_num * tensor_num bits, the larger plans are placed by the greedy way only.
+constexpr size_t kSomasMaxTensorNum = 20000;
+
+size_t AlignMemorySize(size_t size) {
+  return (size + device::kMemAlignSize - 1) / device::kMemAlignSize * device::kMemAlignSize;
+}
+
+bool HasMonadInput(const CNodePtr &kernel) {
+  MS_EXCEPTION_IF_NULL(kernel);
+  const auto &inputs = kernel->inputs();
+  return std::any_of(inputs.begin() + 1, inputs.end(), [](const AnfNodePtr &input) { return HasAbstractMonad(input); });
+}
+}  // namespace
+
+StaticExecutionPlan::~StaticExecutionPlan() {
+  if (memory_ == nullptr) {
+    return;
+  }
+  // The device tensors may have been taken over by a new plan of the graph.
+  for (auto &address : addresses_) {
+    if (address.device_tensor_ != nullptr &&
+        address.device_tensor_->GetPtr() == static_cast<uint8_t *>(memory_) + address.offset_) {
+      address.device_tensor_->set_ptr(nullptr);
+    }
+  }
+  device_context_->FreeMemory(memory_);
+  memory_ = nullptr;
+}
+
+bool StaticExecutionPlan::IsSupported(const KernelGraphPtr &graph, const DeviceContext *device_context) {
+  MS_EXCEPTION_IF_NULL(graph);
+  MS_EXCEPTION_IF_NULL(device_context);
+  if (common::GetEnv(kEnableCpuStaticPlanEnv) != "1") {
+    return false;
+  }
+  auto ms_context = MsContext::GetInstance();
+  MS_EXCEPTION_IF_NULL(ms_context);
+  if ((device_context->GetDeviceAddressType() != device::DeviceAddressType::kCPU) ||
+      (ms_context->get_param<int>(MS_CTX_EXECUTION_MODE) != kGraphMode) || graph->is_dynamic_shape() ||
+      graph->summary_node_exist() || graph->execution_order().empty()) {
+    return false;
+  }
+#ifndef ENABLE_SECURITY
+  // The dump needs the kernel by kernel launching.
+  if (DumpJsonParser::GetInstance().e2e_dump_enabled()) {
+    return false;
+  }
+#endif
+#ifdef ENABLE_DEBUGGER
+  const auto &debugger = Debugger::GetInstance();
+  if (debugger != nullptr && debugger->DebuggerBackendEnabled()) {
+    return false;
+  }
+#endif
+
+  // The kernels which need the actor interaction or the dynamic memory are left to the kernel actors.
+  const auto &execution_order = graph->execution_order();
+  return std::all_of(execution_order.begin(), execution_order.end(), [](const CNodePtr &kernel) {
+    MS_EXCEPTION_IF_NULL(kernel);
+    if (IsCustomActor(kernel) || IsRpcActor(kernel) || IsDeviceQueueDSActor(kernel) || IsSkippedKernelActor(kernel) ||
+        common::AnfAlgo::IsCommunicationOp(kernel) || common::AnfAlgo::IsDynamicShape(kernel)) {
+      MS_LOG(INFO) << "The static execution plan doesn't support the kernel: " << kernel->fullname_with_scope();
+      return false;
+    }
+    return AnfAlgo::GetKernelMod(kernel) != nullptr;
+  });
+}
+
+size_t StaticExecutionPlan::FetchInputAddress(const AnfNodePtr &node, size_t index) {
+  MS_EXCEPTION_IF_NULL(node);
+  auto device_tensor = AnfAlgo::GetMutableOutputAddr(node, index, false);
+  MS_EXCEPTION_IF_NULL(device_tensor);
+  const auto &iter = device_tensor_to_address_.find(device_tensor.get());
+  if (iter != device_tensor_to_address_.end()) {
+    return iter->second;
+  }
+  if (AnfUtils::IsRealCNodeKernel(node)) {
+    MS_LOG(EXCEPTION) << "The input kernel " << node->fullname_with_scope()
+                      << " isn't launched before its users in graph " << graph_->graph_id();
+  }
+
+  // The input of graph, its device tensor may be replaced between the steps, so it is fetched by node.
+  PlanAddress address;
+  address.address_ = std::make_shared<kernel::Address>();
+  address.input_node_ = node;
+  address.input_index_ = index;
+  address.first_level_ = 0;
+  address.last_level_ = kInfiniteLevel;
+  (void)addresses_.emplace_back(address);
+  (void)input_addresses_.emplace_back(addresses_.size() - 1);
+  device_tensor_to_address_[device_tensor.get()] = addresses_.size() - 1;
+  return addresses_.size() - 1;
+}
+
+size_t StaticExecutionPlan::FetchOutputAddress(const CNodePtr &kernel, size_t index) {
+  MS_EXCEPTION_IF_NULL(kernel);
+  session::AnfWithOutIndex out_pair(kernel, index);
+  if (graph_->IsInRefOutputMap(out_pair)) {
+    const auto &origin_pair = graph_->GetRefCorrespondOutput(out_pair);
+    return FetchInputAddress(origin_pair.first, origin_pair.second);
+  }
+
+  auto device_tensor = AnfAlgo::GetMutableOutputAddr(kernel, index, false);
+  MS_EXCEPTION_IF_NULL(device_tensor);
+  // The inplace kernels share the device tensor.
+  const auto &iter = device_tensor_to_address_.find(device_tensor.get());
+  if (iter != device_tensor_to_address_.end()) {
+    return iter->second;
+  }
+  PlanAddress address;
+  address.address_ = std::make_shared<kernel::Address>();
+  address.device_tensor_ = device_tensor.get();
+  address.size_ = device_tensor->GetSize();
+  (void)addresses_.emplace_back(address);
+  device_tensor_to_address_[device_tensor.get()] = addresses_.size() - 1;
+  return addresses_.size() - 1;
+}
+
+void StaticExecutionPlan::Compile() {
+  MS_EXCEPTION_IF_NULL(graph_);
+  MS_EXCEPTION_IF_NULL(device_context_);
+  for (const auto &kernel : graph_->execution_order()) {
+    MS_EXCEPTION_IF_NULL(kernel);
+    KernelLaunchInfo launch_info;
+    launch_info.kernel_ = kernel;
+    for (size_t i = 0; i < common::AnfAlgo::GetInputTensorNum(kernel); ++i) {
+      const auto &input_with_index = common::AnfAlgo::GetPrevNodeOutput(kernel, i, false);
+      (void)launch_info.input_indexes_.emplace_back(FetchInputAddress(input_with_index.first, input_with_index.second));
+    }
+    auto kernel_info = dynamic_cast<device::KernelInfo *>(kernel->kernel_info());
+    MS_EXCEPTION_IF_NULL(kernel_info);
+    for (size_t i = 0; i < kernel_info->output_address_list().size(); ++i) {
+      (void)launch_info.output_indexes_.emplace_back(FetchOutputAddress(kernel, i));
+    }
+    for (const auto &workspace : kernel_info->workspace_address_list()) {
+      MS_EXCEPTION_IF_NULL(workspace);
+      PlanAddress address;
+      address.address_ = std::make_shared<kernel::Address>();
+      address.device_tensor_ = workspace.get();
+      address.size_ = workspace->GetSize();
+      (void)addresses_.emplace_back(address);
+      (void)launch_info.workspace_indexes_.emplace_back(addresses_.size() - 1);
+    }
+    (void)launch_infos_.emplace_back(std::move(launch_info));
+  }
+
+  LevelKernels();
+  AssignMemory();
+
+  for (auto &launch_info : launch_infos_) {
+    auto fetch_address = [this](size_t index) { return addresses_[index].address_; };
+    (void)std::transform(launch_info.input_indexes_.begin(), launch_info.input_indexes_.end(),
+                         std::back_inserter(launch_info.inputs_), fetch_address);
+    (void)std::transform(launch_info.workspace_indexes_.begin(), launch_info.workspace_indexes_.end(),
+                         std::back_inserter(launch_info.workspaces_), fetch_address);
+    (void)std::transform(launch_info.output_indexes_.begin(), launch_info.output_indexes_.end(),
+                         std::back_inserter(launch_info.outputs_), fetch_address);
+  }
+  MS_LOG(INFO) << "The static execution plan of graph " << graph_->graph_id() << " has " << launch_infos_.size()
+               << " kernels in " << levels_.size() << " levels, memory size: " << memory_size_ << "B.";
+}
+
+void StaticExecutionPlan::LevelKernels() {
+  // The kernels are in a valid sequential order, so the kernel only needs to run after the kernels which it conflicts
+  // with before it in the order: the last writer of its inputs and outputs, and the readers of its outputs since then.
+  std::vector<size_t> kernel_levels(launch_infos_.size(), 0);
+  std::vector<size_t> last_writers(addresses_.size(), kInvalidKernelIndex);
+  std::vector<std::vector<size_t>> readers(addresses_.size());
+  size_t last_side_effect_kernel = kInvalidKernelIndex;
+  for (size_t i = 0; i < launch_infos_.size(); ++i) {
+    auto &launch_info = launch_infos_[i];
+    size_t level = 0;
+    auto run_after = [&level, &kernel_levels](size_t kernel_index) {
+      if (kernel_index != kInvalidKernelIndex) {
+        level = std::max(level, kernel_levels[kernel_index] + 1);
+      }
+    };
+    for (auto index : launch_info.input_indexes_) {
+      run_after(last_writers[index]);
+    }
+    for (auto index : launch_info.output_indexes_) {
+      run_after(last_writers[index]);
+      std::for_each(readers[index].begin(), readers[index].end(), run_after);
+    }
+    // The kernels with side effect keep their order.
+    if (HasMonadInput(launch_info.kernel_)) {
+      run_after(last_side_effect_kernel);
+      last_side_effect_kernel = i;
+    }
+
+    kernel_levels[i] = level;
+    if (levels_.size() <= level) {
+      levels_.resize(level + 1);
+    }
+    (void)levels_[level].emplace_back(i);
+    for (auto index : launch_info.input_indexes_) {
+      (void)readers[index].emplace_back(i);
+      addresses_[index].last_level_ = std::max(addresses_[index].last_level_, level);
+    }
+    for (auto index : launch_info.output_indexes_) {
+      if (last_writers[index] == kInvalidKernelIndex && addresses_[index].input_node_ == nullptr) {
+        addresses_[index].first_level_ = level;
+      }
+      last_writers[index] = i;
+      readers[index].clear();
+      addresses_[index].last_level_ = std::max(addresses_[index].last_level_, level);
+    }
+    for (auto index : launch_info.workspace_indexes_) {
+      addresses_[index].first_level_ = level;
+      addresses_[index].last_level_ = level;
+    }
+  }
+
+  // The graph outputs are fetched by the other actors after the graph is run.
+  for (const auto &output_with_index : common::AnfAlgo::GetAllOutputWithIndex(graph_->output())) {
+    const auto &output_node = output_with_index.first;
+    MS_EXCEPTION_IF_NULL(output_node);
+    if (!AnfUtils::IsRealCNodeKernel(output_node)) {
+      continue;
+    }
+    auto device_tensor = AnfAlgo::GetMutableOutputAddr(output_node, output_with_index.second, false);
+    const auto &iter = device_tensor_to_address_.find(device_tensor.get());
+    if (iter != device_tensor_to_address_.end()) {
+      addresses_[iter->second].last_level_ = kInfiniteLevel;
+    }
+  }
+}
+
+size_t StaticExecutionPlan::AssignOffsetsGreedily(const std::vector<size_t> &owned_indexes,
+                                                  std::vector<size_t> *offsets) const {
+  MS_EXCEPTION_IF_NULL(offsets);
+  // Place the larger device tensors first, every device tensor takes the lowest offset which doesn't overlap the
+  // placed device tensors living in the same levels.
+  std::vector<size_t> order(owned_indexes.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [this, &owned_indexes](size_t a, size_t b) {
+    return addresses_[owned_indexes[a]].size_ > addresses_[owned_indexes[b]].size_;
+  });
+
+  size_t memory_size = 0;
+  offsets->assign(owned_indexes.size(), 0);
+  std::vector<size_t> placed;
+  for (auto i : order) {
+    const auto &address = addresses_[owned_indexes[i]];
+    // The memory ranges of the placed device tensors living at the same time, ordered by offset.
+    std::multimap<size_t, size_t> busy_ranges;
+    for (auto placed_i : placed) {
+      const auto &placed_address = addresses_[owned_indexes[placed_i]];
+      if (placed_address.first_level_ <= address.last_level_ && address.first_level_ <= placed_address.last_level_) {
+        (void)busy_ranges.emplace((*offsets)[placed_i], (*offsets)[placed_i] + AlignMemorySize(placed_address.size_));
+      }
+    }
+    size_t offset = 0;
+    auto aligned_size = AlignMemorySize(address.size_);
+    for (const auto &range : busy_ranges) {
+      if (range.first >= offset + aligned_size) {
+        break;
+      }
+      offset = std::max(offset, range.second);
+    }
+    (*offsets)[i] = offset;
+    memory_size = std::max(memory_size, offset + aligned_size);
+    (void)placed.emplace_back(i);
+  }
+  return memory_size;
+}
+
+size_t StaticExecutionPlan::AssignOffsetsBySomas(const std::vector<size_t> &owned_indexes,
+                                                 std::vector<size_t> *offsets) const {
+  MS_EXCEPTION_IF_NULL(offsets);
+  offsets->assign(owned_indexes.size(), 0);
+  // The empty device tensors take no memory and are left out of the solver.
+  std::vector<size_t> solver_tensors;
+  for (size_t i = 0; i < owned_indexes.size(); ++i) {
+    if (AlignMemorySize(addresses_[owned_indexes[i]].size_) > 0) {
+      (void)solver_tensors.emplace_back(i);
+    }
+  }
+  if (solver_tensors.empty()) {
+    return 0;
+  }
+
+  // Two device tensors can reuse the same memory when their lifetimes in levels don't overlap. Sorted by the first
+  // level, the tensors after the first one born after the death of a tensor can all reuse its memory.
+  size_t tensor_num = solver_tensors.size();
+  std::vector<size_t> order(tensor_num);
+  for (size_t i = 0; i < tensor_num; ++i) {
+    order[i] = i;
+  }
+  auto first_level = [this, &owned_indexes, &solver_tensors](size_t i) {
+    return addresses_[owned_indexes[solver_tensors[i]]].first_level_;
+  };
+  std::stable_sort(order.begin(), order.end(),
+                   [&first_level](size_t a, size_t b) { return first_level(a) < first_level(b); });
+  std::vector<somas::DynamicBitSet> reuse_matrix;
+  for (size_t i = 0; i < tensor_num; ++i) {
+    (void)reuse_matrix.emplace_back(tensor_num);
+  }
+  for (size_t i = 0; i < tensor_num; ++i) {
+    auto last_level = addresses_[owned_indexes[solver_tensors[i]]].last_level_;
+    auto iter = std::upper_bound(order.begin(), order.end(), last_level,
+                                 [&first_level](size_t level, size_t j) { return level < first_level(j); });
+    for (; iter != order.end(); ++iter) {
+      reuse_matrix[i].SetBitTrue(*iter);
+      reuse_matrix[*iter].SetBitTrue(i);
+    }
+  }
+
+  somas::TensorsDescMap tensors;
+  for (size_t i = 0; i < tensor_num; ++i) {
+    auto size = AlignMemorySize(addresses_[owned_indexes[solver_tensors[i]]].size_);
+    (void)tensors.emplace(i, std::make_shared<somas::SomasSolverTensorDesc>(i, size, 0, false));
+  }
+  somas::SomasSolverPre solver;
+  if (solver.Solving(graph_.get(), &tensors, &reuse_matrix, {}, false) != somas::SUCCESS) {
+    MS_LOG(WARNING) << "The SOMAS solver failed for the static execution plan of graph " << graph_->graph_id();
+    return std::numeric_limits<size_t>::max();
+  }
+  for (size_t i = 0; i < tensor_num; ++i) {
+    (*offsets)[solver_tensors[i]] = tensors[i]->offset_;
+  }
+  return solver.GetMaxOffset();
+}
+
+void StaticExecutionPlan::AssignMemory() {
+  std::vector<size_t> owned_indexes;
+  for (size_t i = 0; i < addresses_.size(); ++i) {
+    if (addresses_[i].device_tensor_ != nullptr) {
+      (void)owned_indexes.emplace_back(i);
+    }
+  }
+
+  // The memory of every device tensor without reuse, and the lower bound which is the most memory living in a level.
+  size_t total_size = 0;
+  std::vector<size_t> level_sizes(levels_.size() + 1, 0);
+  for (auto index : owned_indexes) {
+    const auto &address = addresses_[index];
+    auto aligned_size = AlignMemorySize(address.size_);
+    total_size += aligned_size;
+    level_sizes[address.first_level_] += aligned_size;
+    level_sizes[std::min(address.last_level_, levels_.size() - 1) + 1] -= aligned_size;
+  }
+  size_t lower_bound = 0;
+  size_t living_size = 0;
+  for (auto level_size : level_sizes) {
+    living_size += level_size;
+    lower_bound = std::max(lower_bound, living_size);
+  }
+
+  // Plan the offsets by the greedy way and by the SOMAS solver, and take the smaller memory.
+  std::vector<size_t> offsets;
+  memory_size_ = AssignOffsetsGreedily(owned_indexes, &offsets);
+  size_t greedy_size = memory_size_;
+  size_t somas_size = 0;
+  if (owned_indexes.size() <= kSomasMaxTensorNum) {
+    std::vector<size_t> somas_offsets;
+    somas_size = AssignOffsetsBySomas(owned_indexes, &somas_offsets);
+    if (somas_size < memory_size_) {
+      memory_size_ = somas_size;
+      offsets.swap(somas_offsets);
+    }
+  }
+  for (size_t i = 0; i < owned_indexes.size(); ++i) {
+    addresses_[owned_indexes[i]].offset_ = offsets[i];
+  }
+  MS_LOG(INFO) << "The memory plan of graph " << graph_->graph_id() << ": " << owned_indexes.size()
+               << " device tensors, planned size: " << memory_size_ << "B, SOMAS size: " << somas_size
+               << "B, greedy size: " << greedy_size << "B, lower bound: " << lower_bound
+               << "B, size without reuse: " << total_size << "B.";
+
+  if (memory_size_ > 0) {
+    memory_ = device_context_->AllocateMemory(memory_size_);
+    if (memory_ == nullptr) {
+      MS_LOG(EXCEPTION) << "Device(id:" << device_context_->device_context_key().device_id_
+                        << ") memory isn't enough and alloc failed for the static execution plan of graph "
+                        << graph_->graph_id() << ", alloc size: " << memory_size_ << "B.";
+    }
+  }
+  for (auto index : owned_indexes) {
+    auto &address = addresses_[index];
+    auto device_tensor = address.device_tensor_;
+    MS_EXCEPTION_IF_NULL(device_tensor);
+    if (device_tensor->GetPtr() != nullptr && device_tensor->from_mem_pool()) {
+      device_context_->FreeMemory(device_tensor);
+    }
+    // The device tensor points into the plan memory for ever, it can't be freed or moved by the actors.
+    device_tensor->set_ptr(static_cast<uint8_t *>(memory_) + address.offset_);
+    device_tensor->set_from_mem_pool(false);
+    device_tensor->set_is_ptr_persisted(true);
+    device_tensor->set_original_ref_count(SIZE_MAX);
+    device_tensor->ResetRefCount();
+    device_tensor->set_dynamic_ref_count(INT32_MAX);
+    address.address_->addr = device_tensor->GetMutablePtr();
+    address.address_->size = device_tensor->GetSize();
+  }
+}
+
+bool StaticExecutionPlan::LaunchKernel(const KernelLaunchInfo &launch_info) const {
+  try {
+    if (!device_context_->LaunchKernel(launch_info.kernel_, launch_info.inputs_, launch_info.workspaces_,
+                                       launch_info.outputs_, false)) {
+      MS_LOG(ERROR) << "Launch kernel failed: " << launch_info.kernel_->fullname_with_scope();
+      return false;
+    }
+  } catch (const std::exception &e) {
+    MS_LOG(ERROR) << "Launch kernel " << launch_info.kernel_->fullname_with_scope() << " exception: " << e.what();
+    return false;
+  }
+  return true;
+}
+
+bool StaticExecutionPlan::Run() {
+  for (auto index : input_addresses_) {
+    auto &address = addresses_[index];
+    auto device_tensor = AnfAlgo::GetMutableOutputAddr(address.input_node_, address.input_index_, false);
+    MS_EXCEPTION_IF_NULL(device_tensor);
+    if (device_tensor->GetPtr() == nullptr) {
+      MS_LOG(ERROR) << "The device address of input " << address.input_node_->DebugString() << " is nullptr.";
+      return false;
+    }
+    address.address_->addr = device_tensor->GetMutablePtr();
+    address.address_->size = device_tensor->GetSize();
+  }
+
+  auto thread_pool = ActorMgr::GetActorMgrRef()->GetActorThreadPool();
+  MS_EXCEPTION_IF_NULL(thread_pool);
+  for (const auto &level : levels_) {
+    if (level.size() == 1) {
+      if (!LaunchKernel(launch_infos_[level[0]])) {
+        return false;
+      }
+      continue;
+    }
+
+    // The kernels of the level are shared by the tasks in turn, the current thread runs one of the tasks.
+    auto task_num = std::min(level.size(), thread_pool->GetKernelThreadNum() + 1);
+    auto task = [this, &level, task_num](void *, int task_id, float, float) {
+      for (size_t i = IntToSize(task_id); i < level.size(); i += task_num) {
+        if (!LaunchKernel(launch_infos_[level[i]])) {
+          return THREAD_ERROR;
+        }
+      }
+      return THREAD_OK;
+    };
+    if (thread_pool->ParallelLaunch(task, nullptr, SizeToInt(task_num)) != THREAD_OK) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace runtime
+}  // namespace mindspore
@@ -0,0 +1,126 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_RUNTIME_FRAMEWORK_STATIC_EXECUTION_PLAN_H_
+#define MINDSPORE_CCSRC_RUNTIME_FRAMEWORK_STATIC_EXECUTION_PLAN_H_
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include "runtime/hardware/device_context.h"
+#include "backend/common/session/kernel_graph.h"
+#include "kernel/kernel.h"
+#include "ir/anf.h"
+#include "utils/hash_map.h"
+
+namespace mindspore {
+namespace runtime {
+using mindspore::device::DeviceAddress;
+using mindspore::device::DeviceContext;
+using mindspore::kernel::AddressPtr;
+using mindspore::session::KernelGraph;
+
+// The environment variable which enables the static execution plan of the CPU graphs.
+constexpr char kEnableCpuStaticPlanEnv[] = "MS_DEV_ENABLE_CPU_STATIC_PLAN";
+
+// The static execution plan runs a static shape CPU kernel graph without the kernel actors. The kernels are flattened
+// into topological levels at compile time, the kernels of a level don't depend on each other and are launched in
+// parallel by the actor thread pool, and the levels are launched one after another.
+// The output and workspace memory of all kernels is planned at compile time: every device tensor gets an offset in one
+// memory block by its lifetime in levels, so the launch addresses are resolved once and no memory is allocated or freed
+// while running. The offsets are solved by the SOMAS solver, the device tensors of disjoint lifetimes share memory,
+// and the greedy placement is the fallback of the huge graphs. Only the addresses of the graph inputs, which are owned
+// by the data source actors and the device tensor store, are fetched at the beginning of every step.
+// The graph is run by its super kernel actor, the control flow between graphs is still driven by the control actors.
+class StaticExecutionPlan {
+ public:
+  StaticExecutionPlan(const KernelGraphPtr &graph, const DeviceContext *device_context)
+      : graph_(graph), device_context_(device_context) {}
+  ~StaticExecutionPlan();
+
+  // Whether the graph can be run by the static execution plan, which is checked after the kernels are created.
+  static bool IsSupported(const KernelGraphPtr &graph, const DeviceContext *device_context);
+
+  // Level the kernels, plan and allocate the memory and resolve the launch addresses.
+  void Compile();
+
+  // Run the kernels of graph one step.
+  bool Run();
+
+  size_t levels_num() const { return levels_.size(); }
+  size_t memory_size() const { return memory_size_; }
+
+ private:
+  // The launch information of a kernel, the addresses are shared with the producers and consumers of the kernel.
+  struct KernelLaunchInfo {
+    CNodePtr kernel_;
+    // The indexes of plan addresses.
+    std::vector<size_t> input_indexes_;
+    std::vector<size_t> workspace_indexes_;
+    std::vector<size_t> output_indexes_;
+    std::vector<AddressPtr> inputs_;
+    std::vector<AddressPtr> workspaces_;
+    std::vector<AddressPtr> outputs_;
+  };
+
+  // The address of a device tensor in the plan.
+  struct PlanAddress {
+    AddressPtr address_;
+    // The device tensor owned by the plan, which points into the plan memory.
+    DeviceAddress *device_tensor_{nullptr};
+    // The graph input which owns the device tensor, its address is fetched in every step.
+    AnfNodePtr input_node_{nullptr};
+    size_t input_index_{0};
+    size_t size_{0};
+    size_t offset_{0};
+    // The lifetime in levels.
+    size_t first_level_{0};
+    size_t last_level_{0};
+  };
+
+  // Fetch the plan address of a kernel input, which is the output of a previous kernel or the graph input.
+  size_t FetchInputAddress(const AnfNodePtr &node, size_t index);
+  // Fetch the plan address of a kernel output, the ref output shares the address of its origin.
+  size_t FetchOutputAddress(const CNodePtr &kernel, size_t index);
+  // Compute the levels of kernels by the data, ref and side effect dependencies.
+  void LevelKernels();
+  // Assign the offsets of the owned device tensors in the plan memory and allocate it.
+  void AssignMemory();
+  // Assign the offsets of the device tensors by the greedy way or by the SOMAS solver, the offsets are in the order of
+  // owned indexes and the memory size is returned.
+  size_t AssignOffsetsGreedily(const std::vector<size_t> &owned_indexes, std::vector<size_t> *offsets) const;
+  size_t AssignOffsetsBySomas(const std::vector<size_t> &owned_indexes, std::vector<size_t> *offsets) const;
+  bool LaunchKernel(const KernelLaunchInfo &launch_info) const;
+
+  KernelGraphPtr graph_;
+  const DeviceContext *device_context_;
+
+  std::vector<KernelLaunchInfo> launch_infos_;
+  // The index of launch infos of every level.
+  std::vector<std::vector<size_t>> levels_;
+  std::vector<PlanAddress> addresses_;
+  mindspore::HashMap<const DeviceAddress *, size_t> device_tensor_to_address_;
+  // The indexes of addresses which are fetched from the graph inputs in every step.
+  std::vector<size_t> input_addresses_;
+
+  void *memory_{nullptr};
+  size_t memory_size_{0};
+};
+using StaticExecutionPlanPtr = std::shared_ptr<StaticExecutionPlan>;
+}  // namespace runtime
+}  // namespace mindspore
+
+#endif  // MINDSPORE_CCSRC_RUNTIME_FRAMEWORK_STATIC_EXECUTION_PLAN_H_
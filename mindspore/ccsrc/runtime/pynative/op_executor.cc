@@ -15,26 +15,53 @@
  */
 
 #include "runtime/pynative/op_executor.h"
+#include <algorithm>
+#include "pybind11/pybind11.h"
 
+namespace py = pybind11;
 namespace mindspore::runtime {
 OpExecutor &OpExecutor::GetInstance() {
   static OpExecutor instance;
   return instance;
 }
 
-OpExecutor::OpExecutor() { worker_ = std::make_shared<std::thread>(&OpExecutor::WorkerLoop, this); }
+OpExecutor::OpExecutor() {
+  worker_ = std::make_shared<std::thread>(&OpExecutor::WorkerLoop, this);
+  build_worker_ = std::make_shared<std::thread>(&OpExecutor::BuildLoop, this);
+}
 
 OpExecutor::~OpExecutor() { WorkerJoin(); }
 
 void OpExecutor::Register(const std::function<void()> &callback) {
-  batch_build_callback_ = callback;
-  registered_ = true;
+  bool batch_ready = false;
+  {
+    std::lock_guard<std::mutex> lock(build_mutex_);
+    batch_build_callback_ = callback;
+    registered_ = true;
+    batch_ready = BuildBatchReady();
+  }
+  if (batch_ready) {
+    build_cond_var_.notify_all();
+  }
 }
 
 void OpExecutor::Reset() {
+  // Wait for the batch in building on the build thread, unless the reset is called by the build callback.
+  std::unique_lock<std::recursive_mutex> compile_lock;
+  if (!executing_) {
+    compile_lock = LockCompile();
+  }
   ClearResources();
-  batch_build_callback_ = nullptr;
-  registered_ = false;
+  {
+    std::lock_guard<std::mutex> lock(build_mutex_);
+    batch_build_callback_ = nullptr;
+    registered_ = false;
+  }
+  // The run tasks may wait for the build tasks pushed after the clearing, which are never built if the build thread
+  // waits here. The exception of the build thread is thrown by the next Wait of the python thread.
+  if (std::this_thread::get_id() == build_worker_->get_id()) {
+    return;
+  }
 
   // There is still one task in progress
   try {
@@ -48,30 +75,53 @@ void OpExecutor::Reset() {
 
 void OpExecutor::ClearResources() {
   MS_LOG(DEBUG) << "Start clear tasks";
-  std::lock_guard<std::mutex> lock(task_mutex_);
-  ClearRunOpTasks();
+  {
+    std::lock_guard<std::mutex> lock(task_mutex_);
+    ClearRunOpTasks();
+  }
 
   // Set the build task failed, and no need to run op_run_tasks.
+  std::lock_guard<std::mutex> lock(build_mutex_);
   for (auto &build_task : op_build_tasks_) {
     build_task->SetBuildReady(false);
   }
   op_build_tasks_.clear();
+  for (auto &build_task : building_tasks_) {
+    build_task->SetBuildReady(false);
+  }
+  building_tasks_.clear();
   MS_LOG(DEBUG) << "End clear tasks";
 }
 
 void OpExecutor::WaitForBuild() {
-  if (!executing_) {
-    ExecuteGuard guard;
-    if (batch_build_callback_ != nullptr) {
-      batch_build_callback_();
-    }
+  if (executing_) {
+    return;
+  }
+  // The build thread holds the compile lock while building a batch, so the batch in building is finished after the
+  // lock is taken, and the rest tasks are built on the current thread.
+  auto compile_lock = LockCompile();
+  BuildOnce();
+}
+
+std::unique_lock<std::recursive_mutex> OpExecutor::LockCompile() {
+  std::unique_lock<std::recursive_mutex> lock(compile_mutex_, std::try_to_lock);
+  if (lock.owns_lock()) {
+    return lock;
   }
+  // The build thread may acquire the GIL in building the kernels, so the GIL is released while waiting for the lock.
+  if (Py_IsInitialized() != 0 && PyGILState_Check() != 0) {
+    py::gil_scoped_release gil_release;
+    lock.lock();
+  } else {
+    lock.lock();
+  }
+  return lock;
 }
 
 void OpExecutor::WaitForRun() {
   MS_LOG(DEBUG) << "Start";
   std::unique_lock<std::mutex> lock(task_mutex_);
-  task_cond_var_.wait(lock, [this]() { return op_run_tasks_.empty(); });
+  task_cond_var_.wait(lock, [this]() { return unfinished_run_task_num_.load() == 0; });
   MsException::Instance().CheckException();
   MS_LOG(DEBUG) << "All task finish";
 }
@@ -82,60 +132,178 @@ void OpExecutor::Wait() {
 }
 
 void OpExecutor::PushOpBuildTask(const std::shared_ptr<OpBuildTask> &op_build_task) {
-  std::lock_guard<std::mutex> lock(task_mutex_);
-  op_build_tasks_.push_back(op_build_task);
+  bool batch_ready = false;
+  {
+    std::lock_guard<std::mutex> lock(build_mutex_);
+    op_build_tasks_.push_back(op_build_task);
+    batch_ready = BuildBatchReady();
+  }
+  // The build thread only builds full batches, the rest of the tasks are built by the next Wait.
+  if (batch_ready) {
+    build_cond_var_.notify_all();
+  }
+}
+
+bool OpExecutor::BuildBatchReady() const {
+  return op_build_tasks_.size() >= kMaxQueueSize && batch_build_callback_ != nullptr;
 }
 
 void OpExecutor::PushOpRunTask(const std::shared_ptr<OpTask> &op_run_task) {
-  std::lock_guard<std::mutex> lock(task_mutex_);
-  op_run_tasks_.push(op_run_task);
-  actor_in_queue_.insert(op_run_task->context()->graph_compiler_info()->name_);
-  task_cond_var_.notify_all();
+  {
+    std::lock_guard<std::mutex> lock(actor_mutex_);
+    (void)actor_in_queue_.insert(op_run_task->context()->graph_compiler_info()->name_);
+  }
+  ++unfinished_run_task_num_;
+  // The queue is full only if the worker falls far behind, wait for the worker to make room.
+  while (!op_run_tasks_.Push(op_run_task)) {
+    std::this_thread::yield();
+  }
+  NotifyWorker();
+}
+
+void OpExecutor::NotifyWorker() {
+  // The worker sets the waiting flag before checking the queue, and the queue is checked here after the push, so
+  // either the worker finds the task or the worker is notified.
+  if (worker_waiting_.load()) {
+    std::lock_guard<std::mutex> lock(task_mutex_);
+    task_cond_var_.notify_all();
+  }
 }
 
 void OpExecutor::ClearOpBuildTasks() {
-  std::lock_guard<std::mutex> lock(task_mutex_);
-  for (auto &task : op_build_tasks_) {
+  std::lock_guard<std::mutex> lock(build_mutex_);
+  for (auto &task : building_tasks_) {
     task->SetBuildReady(true);
   }
-  op_build_tasks_.clear();
+  building_tasks_.clear();
   MS_LOG(DEBUG) << "Clear build task";
 }
 
 bool OpExecutor::BuildQueueEmpty() {
-  std::lock_guard<std::mutex> lock(task_mutex_);
-  return op_build_tasks_.empty();
+  std::lock_guard<std::mutex> lock(build_mutex_);
+  return op_build_tasks_.empty() && building_tasks_.empty();
 }
 
 bool OpExecutor::BuildQueueFull() {
-  std::lock_guard<std::mutex> lock(task_mutex_);
+  std::lock_guard<std::mutex> lock(build_mutex_);
   return op_build_tasks_.size() > kMaxQueueSize;
 }
 
+bool OpExecutor::BuildInQueue(GraphId graph_id) {
+  auto is_graph_task = [graph_id](const std::shared_ptr<OpBuildTask> &task) {
+    return task->context()->graph()->graph_id() == graph_id;
+  };
+  std::lock_guard<std::mutex> lock(build_mutex_);
+  return std::any_of(op_build_tasks_.begin(), op_build_tasks_.end(), is_graph_task) ||
+         std::any_of(building_tasks_.begin(), building_tasks_.end(), is_graph_task);
+}
+
 bool OpExecutor::ActorInQueue(const std::string &actor_info) {
-  std::lock_guard<std::mutex> lock(task_mutex_);
+  std::lock_guard<std::mutex> lock(actor_mutex_);
   auto iter = actor_in_queue_.find(actor_info);
   return iter != actor_in_queue_.end();
 }
 
 void OpExecutor::ClearRunOpTasks() {
-  actor_in_queue_.clear();
-  std::queue<std::shared_ptr<OpTask>> empty;
+  {
+    std::lock_guard<std::mutex> lock(actor_mutex_);
+    actor_in_queue_.clear();
+  }
   // No need to worry about ExitOpTask.
   // ClearRunOpTasks is executed before ~OpExecutor
-  std::swap(op_run_tasks_, empty);
+  std::shared_ptr<OpTask> task;
+  while (op_run_tasks_.Pop(&task)) {
+    if (task != nullptr && task->task_type() != kExitTask) {
+      --unfinished_run_task_num_;
+    }
+  }
 }
 
-void OpExecutor::WorkerLoop() {
+void OpExecutor::BuildOnce() {
+  std::function<void()> callback;
+  {
+    std::lock_guard<std::mutex> lock(build_mutex_);
+    if (op_build_tasks_.empty() || batch_build_callback_ == nullptr) {
+      return;
+    }
+    building_tasks_.swap(op_build_tasks_);
+    callback = batch_build_callback_;
+  }
+  MS_LOG(DEBUG) << "Build " << building_tasks_.size() << " tasks";
+  ExecuteGuard guard;
+  callback();
+}
+
+void OpExecutor::BuildLoop() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(build_mutex_);
+      build_cond_var_.wait(lock, [this]() { return build_exit_ || BuildBatchReady(); });
+      if (build_exit_) {
+        MS_LOG(DEBUG) << "Build thread exit";
+        return;
+      }
+    }
+    // The tasks are taken after the compile lock, then the python thread which holds the lock can build them itself.
+    // The lock is also held while the tasks are cleared on failure, so the python thread never sees a half cleared
+    // batch.
+    std::lock_guard<std::recursive_mutex> compile_lock(compile_mutex_);
+    try {
+      BuildOnce();
+    } catch (...) {
+      // The exception is kept as it is and rethrown by the next Wait on the python thread, which holds the GIL, so
+      // no python exception is made or destroyed on this thread.
+      MS_LOG(ERROR) << "Build lazy task failed.";
+      ClearResources();
+      std::lock_guard<std::mutex> lock(task_mutex_);
+      MsException::Instance().SetException();
+      task_cond_var_.notify_all();
+    }
+  }
+}
+
+std::shared_ptr<OpTask> OpExecutor::PopRunTask() {
+  std::shared_ptr<OpTask> task;
+  for (size_t i = 0; i < kWorkerSpinCount; ++i) {
+    if (op_run_tasks_.Pop(&task)) {
+      return task;
+    }
+    std::this_thread::yield();
+  }
   while (true) {
-    std::shared_ptr<OpTask> task;
     {
       MS_LOG(DEBUG) << "Wait task in queue";
       std::unique_lock<std::mutex> lock(task_mutex_);
-      task_cond_var_.wait(lock, [this]() { return !op_run_tasks_.empty(); });
-      task = op_run_tasks_.front();
+      worker_waiting_ = true;
+      task_cond_var_.wait(lock, [this]() { return !op_run_tasks_.Empty(); });
+      worker_waiting_ = false;
+    }
+    // The task may be popped by the clearing thread, or still in pushing.
+    for (size_t i = 0; i < kWorkerSpinCount; ++i) {
+      if (op_run_tasks_.Pop(&task)) {
+        return task;
+      }
+      std::this_thread::yield();
     }
+  }
+}
+
+void OpExecutor::FinishRunTask(const std::shared_ptr<OpTask> &task) {
+  {
+    std::lock_guard<std::mutex> lock(actor_mutex_);
+    (void)actor_in_queue_.erase(task->context()->graph_compiler_info()->name_);
+  }
+  if (--unfinished_run_task_num_ == 0) {
+    MS_LOG(DEBUG) << "Task queue empty";
+    std::lock_guard<std::mutex> lock(task_mutex_);
+    task_cond_var_.notify_all();
+  }
+}
 
+void OpExecutor::WorkerLoop() {
+  while (true) {
+    // The tasks are launched back to back, the waiting thread is only notified when all tasks are finished.
+    auto task = PopRunTask();
     MS_LOG(DEBUG) << "Get task";
     MS_EXCEPTION_IF_NULL(task);
     if (task->task_type() == kExitTask) {
@@ -144,36 +312,38 @@ void OpExecutor::WorkerLoop() {
     }
     try {
       task->Run();
-      std::unique_lock<std::mutex> lock(task_mutex_);
-      if (!op_run_tasks_.empty()) {
-        op_run_tasks_.pop();
-        actor_in_queue_.erase(task->context()->graph_compiler_info()->name_);
-      }
-
-      if (op_run_tasks_.empty()) {
-        MS_LOG(DEBUG) << "Task queue empty";
-        task_cond_var_.notify_all();
-      }
     } catch (const std::exception &e) {
       MS_LOG(ERROR) << "Run lazy task failed, error message:" << e.what();
       {
         std::unique_lock<std::mutex> lock(task_mutex_);
         ClearRunOpTasks();
         MsException::Instance().SetException();
-        task_cond_var_.notify_all();
       }
     }
+    FinishRunTask(task);
   }
 }
 
 void OpExecutor::WorkerJoin() {
   try {
+    // Avoid build thread join itself which will cause deadlock
+    if (build_worker_->joinable() && build_worker_->get_id() != std::this_thread::get_id()) {
+      {
+        std::lock_guard<std::mutex> lock(build_mutex_);
+        build_exit_ = true;
+      }
+      build_cond_var_.notify_all();
+      build_worker_->join();
+      MS_LOG(DEBUG) << "Build worker join finish";
+    }
     // Avoid worker thread join itself which will cause deadlock
     if (worker_->joinable() && worker_->get_id() != std::this_thread::get_id()) {
+      auto task = std::make_shared<ExitOpTask>();
+      while (!op_run_tasks_.Push(task)) {
+        std::this_thread::yield();
+      }
       {
         std::lock_guard<std::mutex> lock(task_mutex_);
-        auto task = std::make_shared<ExitOpTask>();
-        op_run_tasks_.push(task);
         task_cond_var_.notify_all();
         MS_LOG(DEBUG) << "Push exit task and notify all";
       }
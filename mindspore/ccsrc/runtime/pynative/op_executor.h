@@ -24,23 +24,29 @@
 #include <string>
 #include <set>
 #include <utility>
+#include <atomic>
 #include "backend/common/session/kernel_graph.h"
 #include "backend/common/session/anf_runtime_algorithm.h"
 #include "include/common/utils/anfalgo.h"
 #include "runtime/hardware/device_context.h"
 #include "runtime/graph_scheduler/graph_scheduler.h"
 #include "runtime/pynative/op_task.h"
+#include "runtime/pynative/op_task_queue.h"
 #include "include/backend/visible.h"
 
 namespace mindspore::runtime {
+// The op tasks of PyNative are run by a pipeline of three stages on separate threads: the python thread infers the ops
+// and pushes the tasks, the build thread builds the kernels of the pushed ops once they fill a batch, and the worker
+// thread launches the built kernels. A Wait on the python thread builds the rest of the tasks itself. The run tasks are passed by a lock-free queue and launched back to back by the worker, the worker
+// only sleeps when the queue keeps empty for a while.
 class BACKEND_EXPORT OpExecutor {
  public:
   static OpExecutor &GetInstance();
 
   class ExecuteGuard {
    public:
-    ExecuteGuard() { OpExecutor::GetInstance().executing_ = true; }
-    ~ExecuteGuard() { OpExecutor::GetInstance().executing_ = false; }
+    ExecuteGuard() { OpExecutor::executing_ = true; }
+    ~ExecuteGuard() { OpExecutor::executing_ = false; }
   };
 
   // Register build callback function
@@ -50,10 +56,14 @@ class BACKEND_EXPORT OpExecutor {
 
   void PushOpRunTask(const std::shared_ptr<OpTask> &op_run_task);
 
-  const std::vector<std::shared_ptr<OpBuildTask>> &GetOpBuildTasks() const { return op_build_tasks_; }
+  // The build tasks of the batch in building.
+  const std::vector<std::shared_ptr<OpBuildTask>> &GetOpBuildTasks() const { return building_tasks_; }
 
   bool BuildQueueEmpty();
 
+  // Whether the graph is waiting for build or in building.
+  bool BuildInQueue(GraphId graph_id);
+
   // If the build queue is full, we can compile the kernels in parallel.
   bool BuildQueueFull();
 
@@ -71,6 +81,10 @@ class BACKEND_EXPORT OpExecutor {
   // Wait for all OpRunTasks to finish executing.
   void Wait();
 
+  // The graph compiler is shared by the python thread and the build thread, lock it before compiling the graph on the
+  // python thread. The lock is recursive, because the build tasks may be waited for in compiling.
+  std::unique_lock<std::recursive_mutex> LockCompile();
+
   // Thread join before the process exit.
   void WorkerJoin();
 
@@ -81,20 +95,41 @@ class BACKEND_EXPORT OpExecutor {
 
   void WaitForBuild();
   void WaitForRun();
+  // Whether the build thread can build a full batch, the caller holds the build mutex.
+  bool BuildBatchReady() const;
+  // Build the pending build tasks by one batch, the caller holds the compile lock.
+  void BuildOnce();
+  void BuildLoop();
   void WorkerLoop();
+  // Pop the next run task, spin for a while before sleeping.
+  std::shared_ptr<OpTask> PopRunTask();
+  void NotifyWorker();
+  void FinishRunTask(const std::shared_ptr<OpTask> &task);
   void ClearRunOpTasks();
   void ClearResources();
 
   std::vector<std::shared_ptr<OpBuildTask>> op_build_tasks_;
-  std::queue<std::shared_ptr<OpTask>> op_run_tasks_;
+  std::vector<std::shared_ptr<OpBuildTask>> building_tasks_;
+  OpTaskQueue<std::shared_ptr<OpTask>> op_run_tasks_{kMaxRunQueueSize};
+  std::atomic<size_t> unfinished_run_task_num_{0};
+  std::atomic<bool> worker_waiting_{false};
   std::set<std::string> actor_in_queue_;
   std::function<void()> batch_build_callback_{nullptr};
   inline static size_t kMaxQueueSize = 20;
-  bool executing_{false};
+  inline static size_t kMaxRunQueueSize = 1024;
+  inline static size_t kWorkerSpinCount = 2000;
+  // Whether the build callback is executing on the current thread.
+  inline static thread_local bool executing_{false};
   bool registered_{false};
+  bool build_exit_{false};
   std::shared_ptr<std::thread> worker_;
+  std::shared_ptr<std::thread> build_worker_;
   std::mutex task_mutex_;
   std::condition_variable task_cond_var_;
+  std::mutex actor_mutex_;
+  std::mutex build_mutex_;
+  std::condition_variable build_cond_var_;
+  std::recursive_mutex compile_mutex_;
 };
 }  // namespace mindspore::runtime
 #endif  // MINDSPORE_MINDSPORE_CCSRC_RUNTIME_PYNATIVE_OP_EXECUTOR_H_
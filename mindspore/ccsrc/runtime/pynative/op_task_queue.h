@@ -0,0 +1,107 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_MINDSPORE_CCSRC_RUNTIME_PYNATIVE_OP_TASK_QUEUE_H_
+#define MINDSPORE_MINDSPORE_CCSRC_RUNTIME_PYNATIVE_OP_TASK_QUEUE_H_
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace mindspore::runtime {
+// A bounded lock-free queue which any thread can push to and pop from, refer to the bounded MPMC queue of Dmitry
+// Vyukov. Every cell has a sequence number which tells whether it is ready for the push or the pop of a position, so
+// the pushing and popping threads only contend on the position counters.
+template <typename T>
+class OpTaskQueue {
+ public:
+  // The capacity is rounded up to a power of two.
+  explicit OpTaskQueue(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    mask_ = size - 1;
+    cells_ = std::make_unique<Cell[]>(size);
+    for (size_t i = 0; i < size; ++i) {
+      cells_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+  }
+  ~OpTaskQueue() = default;
+
+  // Return false if the queue is full.
+  bool Push(T value) {
+    auto pos = push_pos_.load(std::memory_order_relaxed);
+    Cell *cell = nullptr;
+    while (true) {
+      cell = &cells_[pos & mask_];
+      auto sequence = cell->sequence_.load(std::memory_order_acquire);
+      auto diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+      if (diff == 0) {
+        if (push_pos_.compare_exchange_weak(pos, pos + 1)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = push_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->value_ = std::move(value);
+    cell->sequence_.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Return false if the queue is empty, or the value being pushed is not ready yet.
+  bool Pop(T *value) {
+    auto pos = pop_pos_.load(std::memory_order_relaxed);
+    Cell *cell = nullptr;
+    while (true) {
+      cell = &cells_[pos & mask_];
+      auto sequence = cell->sequence_.load(std::memory_order_acquire);
+      auto diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos + 1);
+      if (diff == 0) {
+        if (pop_pos_.compare_exchange_weak(pos, pos + 1)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = pop_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    *value = std::move(cell->value_);
+    cell->value_ = T();
+    cell->sequence_.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Whether no value is pushed or being pushed.
+  bool Empty() const { return push_pos_.load() == pop_pos_.load(); }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence_{0};
+    T value_;
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_{0};
+  alignas(64) std::atomic<size_t> push_pos_{0};
+  alignas(64) std::atomic<size_t> pop_pos_{0};
+};
+}  // namespace mindspore::runtime
+#endif  // MINDSPORE_MINDSPORE_CCSRC_RUNTIME_PYNATIVE_OP_TASK_QUEUE_H_
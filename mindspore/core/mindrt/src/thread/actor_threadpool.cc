@@ -21,10 +21,18 @@
 #include "thread/core_affinity.h"
 
 namespace mindspore {
+namespace {
+// the pool and the index of the actor worker running on the current thread
+thread_local ActorThreadPool *current_pool = nullptr;
+thread_local size_t current_worker_index = 0;
+}  // namespace
+
 void ActorWorker::CreateThread() { thread_ = std::thread(&ActorWorker::RunWithSpin, this); }
 
 void ActorWorker::RunWithSpin() {
   SetAffinity();
+  current_pool = reinterpret_cast<ActorThreadPool *>(pool_);
+  current_worker_index = worker_id_;
 #if !defined(__APPLE__) && !defined(SUPPORT_MSVC)
   static std::atomic_int index = {0};
   (void)pthread_setname_np(pthread_self(), ("ActorThread_" + std::to_string(index++)).c_str());
@@ -52,7 +60,7 @@ bool ActorWorker::RunQueueActorTask() {
   if (pool_ == nullptr) {
     return false;
   }
-  auto actor = reinterpret_cast<ActorThreadPool *>(pool_)->PopActorFromQueue();
+  auto actor = reinterpret_cast<ActorThreadPool *>(pool_)->PopActorFromQueue(worker_id_);
   if (actor == nullptr) {
     return false;
   }
@@ -87,14 +95,7 @@ ActorThreadPool::~ActorThreadPool() {
   bool terminate = false;
   int count = 0;
   do {
-    {
-#ifdef USE_HQUEUE
-      terminate = actor_queue_.Empty();
-#else
-      std::lock_guard<std::mutex> _l(actor_mutex_);
-      terminate = actor_queue_.empty();
-#endif
-    }
+    terminate = ActorQueueEmpty();
     if (!terminate) {
       for (auto &worker : workers_) {
         worker->Active();
@@ -109,6 +110,24 @@ ActorThreadPool::~ActorThreadPool() {
   workers_.clear();
 #ifdef USE_HQUEUE
   actor_queue_.Clean();
+#endif
+  for (auto &worker_queue : worker_queues_) {
+    worker_queue->queue.Clean();
+  }
+  worker_queues_.clear();
+}
+
+bool ActorThreadPool::ActorQueueEmpty() {
+  for (auto &worker_queue : worker_queues_) {
+    if (worker_queue->successor.load(std::memory_order_relaxed) != nullptr || !worker_queue->queue.Empty()) {
+      return false;
+    }
+  }
+#ifdef USE_HQUEUE
+  return actor_queue_.Empty();
+#else
+  std::lock_guard<std::mutex> _l(actor_mutex_);
+  return actor_queue_.empty();
 #endif
 }
 
@@ -126,10 +145,95 @@ ActorBase *ActorThreadPool::PopActorFromQueue() {
 #endif
 }
 
+ActorBase *ActorThreadPool::PopActorFromQueue(size_t worker_index) {
+  if (!work_stealing_ || worker_index >= worker_queues_.size()) {
+    return PopActorFromQueue();
+  }
+  auto &local = worker_queues_[worker_index];
+  // the worker is done with the actor it ran last, the thieves leave its successor alone from now on
+  local->busy.store(false, std::memory_order_relaxed);
+  ActorBase *actor = nullptr;
+  if (local->successor_runs < kMaxSuccessorRuns) {
+    actor = TakeSuccessor(local.get());
+    if (actor != nullptr) {
+      local->successor_runs++;
+    }
+  }
+  if (actor == nullptr) {
+    // give the other ready actors a turn, the successor is the last resort of the worker
+    local->successor_runs = 0;
+    actor = TakeQueued(local.get());
+    if (actor == nullptr) {
+      actor = PopActorFromQueue();
+    }
+    if (actor == nullptr) {
+      actor = TakeSuccessor(local.get());
+    }
+    if (actor == nullptr) {
+      actor = StealActor(worker_index);
+    }
+  }
+  if (actor != nullptr) {
+    local->busy.store(true, std::memory_order_relaxed);
+  }
+  return actor;
+}
+
+ActorBase *ActorThreadPool::TakeSuccessor(ActorWorkerQueue *worker_queue) {
+  auto actor = worker_queue->successor.exchange(nullptr);
+  if (actor != nullptr) {
+    worker_queue->ready_num--;
+  }
+  return actor;
+}
+
+ActorBase *ActorThreadPool::TakeQueued(ActorWorkerQueue *worker_queue) {
+  auto actor = worker_queue->queue.Dequeue();
+  if (actor != nullptr) {
+    worker_queue->ready_num--;
+  }
+  return actor;
+}
+
+ActorBase *ActorThreadPool::StealActor(size_t thief_index) {
+  size_t num = worker_queues_.size();
+  for (size_t i = 1; i < num; ++i) {
+    auto actor = TakeQueued(worker_queues_[(thief_index + i) % num].get());
+    if (actor != nullptr) {
+      return actor;
+    }
+  }
+  // a successor is taken from a worker that is busy, e.g. with a long kernel or an actor that waits for the
+  // successor, rather than left waiting while this worker is idle
+  for (size_t i = 1; i < num; ++i) {
+    auto &victim = worker_queues_[(thief_index + i) % num];
+    if (!victim->busy.load(std::memory_order_relaxed)) {
+      continue;
+    }
+    auto actor = TakeSuccessor(victim.get());
+    if (actor != nullptr) {
+      return actor;
+    }
+  }
+  return nullptr;
+}
+
 void ActorThreadPool::PushActorToQueue(ActorBase *actor) {
   if (!actor) {
     return;
   }
+  if (work_stealing_ && current_pool == this && current_worker_index < worker_queues_.size()) {
+    // the actor is made ready by an actor running on this worker, run it next on the same worker
+    auto &local = worker_queues_[current_worker_index];
+    actor = local->successor.exchange(actor);
+    if (actor == nullptr || local->queue.Enqueue(actor)) {
+      // every ready actor of this worker can go to an idle worker while this one is busy
+      auto ready_num = ++local->ready_num;
+      ActiveActorWorker(ready_num > 0 ? static_cast<size_t>(ready_num) : 1);
+      return;
+    }
+    // the local queue is full, share the older ready actor with all the workers
+  }
   {
 #ifdef USE_HQUEUE
     while (!actor_queue_.Enqueue(actor)) {
@@ -140,11 +244,15 @@ void ActorThreadPool::PushActorToQueue(ActorBase *actor) {
 #endif
   }
   THREAD_DEBUG("actor[%s] enqueue success", actor->GetAID().Name().c_str());
-  // active one idle actor thread if exist
-  for (size_t i = 0; i < actor_thread_num_; ++i) {
+  ActiveActorWorker();
+}
+
+void ActorThreadPool::ActiveActorWorker(size_t num) {
+  // active up to num idle actor threads if exist
+  for (size_t i = 0; i < actor_thread_num_ && num > 0; ++i) {
     auto worker = reinterpret_cast<ActorWorker *>(workers_[i]);
     if (worker->ActorActive()) {
-      break;
+      num--;
     }
   }
 }
@@ -174,6 +282,15 @@ int ActorThreadPool::CreateThreads(size_t actor_thread_num, size_t all_thread_nu
   THREAD_INFO("ThreadInfo, Actor: [%zu], All: [%zu], CoreNum: [%zu]", actor_thread_num, all_thread_num, core_num);
   actor_thread_num_ = actor_thread_num < core_num ? actor_thread_num : core_num;
   core_num -= actor_thread_num_;
+  // the queues of the actor workers are ready before the workers start
+  for (size_t i = 0; i < actor_thread_num_; ++i) {
+    auto worker_queue = std::make_unique<ActorWorkerQueue>();
+    if (!worker_queue->queue.Init(kLocalReadyActorNum)) {
+      THREAD_ERROR("init actor queue of worker failed.");
+      return THREAD_ERROR;
+    }
+    worker_queues_.push_back(std::move(worker_queue));
+  }
   if (ThreadPool::CreateThreads<ActorWorker>(actor_thread_num_, core_list) != THREAD_OK) {
     return THREAD_ERROR;
   }
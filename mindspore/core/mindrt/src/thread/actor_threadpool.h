@@ -19,7 +19,9 @@
 
 #include <queue>
 #include <vector>
+#include <memory>
 #include <mutex>
+#include <utility>
 #include <atomic>
 #include <condition_variable>
 #include "thread/threadpool.h"
@@ -31,6 +33,9 @@
 #endif
 namespace mindspore {
 constexpr size_t MAX_READY_ACTOR_NR = 8192;
+constexpr size_t kLocalReadyActorNum = 1024;
+// the number of successors a worker runs in a row before it turns to its queue again
+constexpr int kMaxSuccessorRuns = 32;
 class ActorThreadPool;
 class ActorWorker : public Worker {
  public:
@@ -44,6 +49,20 @@ class ActorWorker : public Worker {
   bool RunQueueActorTask();
 };
 
+// the ready actors owned by one actor worker
+struct ActorWorkerQueue {
+  // the actor made ready last by the actor running on the worker, it runs next on the same worker
+  // while the data it consumes is still in cache, unless an idle worker steals it first
+  std::atomic<ActorBase *> successor{nullptr};
+  int successor_runs{0};
+  // whether the worker runs an actor, or a kernel task after it, and cannot take its successor now
+  std::atomic_bool busy{false};
+  // the number of actors in successor and queue, tells how many idle workers to wake up
+  std::atomic_int ready_num{0};
+  // the other actors made ready on the worker, idle workers steal from here
+  HQueue<ActorBase> queue;
+};
+
 class ActorThreadPool : public ThreadPool {
  public:
   // create ThreadPool that contains actor thread and kernel thread
@@ -61,9 +80,24 @@ class ActorThreadPool : public ThreadPool {
   virtual int ActorQueueInit();
   virtual void PushActorToQueue(ActorBase *actor);
   virtual ActorBase *PopActorFromQueue();
+  // pop a ready actor for an actor worker: its successor, its own queue, the shared queue, and at last the
+  // queues of the other actor workers
+  ActorBase *PopActorFromQueue(size_t worker_index);
+
+  // actors made ready by an actor worker stay on that worker and are stolen by idle workers, otherwise all
+  // the ready actors go through the shared queue. Off by default, it must be set before any actor is scheduled
+  // as the actors left in the worker queues are not taken once it is turned off.
+  void SetWorkStealing(bool enable) { work_stealing_ = enable; }
+  bool work_stealing() const { return work_stealing_; }
 
  protected:
   ActorThreadPool() = default;
+  bool ActorQueueEmpty();
+  ActorBase *StealActor(size_t thief_index);
+  ActorBase *TakeSuccessor(ActorWorkerQueue *worker_queue);
+  ActorBase *TakeQueued(ActorWorkerQueue *worker_queue);
+  // wake up to num idle actor workers
+  void ActiveActorWorker(size_t num = 1);
 
   std::mutex actor_mutex_;
   std::condition_variable actor_cond_;
@@ -72,6 +106,8 @@ class ActorThreadPool : public ThreadPool {
 #else
   std::queue<ActorBase *> actor_queue_;
 #endif
+  std::vector<std::unique_ptr<ActorWorkerQueue>> worker_queues_;
+  std::atomic_bool work_stealing_{false};
 
  private:
   int CreateThreads(size_t actor_thread_num, size_t all_thread_num, const std::vector<int> &core_list);
@@ -625,7 +625,7 @@ def _check_target_specific_cfgs(device, arg_key):
         'print_file_path': ['Ascend'],
         'variable_memory_max_size': ['Ascend'],
         'auto_tune_mode': ['Ascend'],
-        'max_device_memory': ['Ascend', 'GPU'],
+        'max_device_memory': ['Ascend', 'GPU', 'CPU'],
         'mempool_block_size': ['GPU', 'Ascend']
     }
     # configs not in map device_cfgs are supposed to be suitable for all devices
@@ -670,7 +670,7 @@ def set_context(**kwargs):
     |                         +------------------------------+----------------------------+
     |                         |   device_target              |   CPU/GPU/Ascend           |
     |                         +------------------------------+----------------------------+
-    |                         |  max_device_memory           |  GPU/Ascend                |
+    |                         |  max_device_memory           |  CPU/GPU/Ascend            |
     |                         +------------------------------+----------------------------+
     |                         |  variable_memory_max_size    |  Ascend                    |
     |                         +------------------------------+----------------------------+
@@ -730,6 +730,8 @@ def set_context(**kwargs):
             If device target is not set, the version of MindSpore package is used.
         max_device_memory (str): Set the maximum memory available for devices. The format is "xxGB". Default: "1024GB".
             The actual used memory size is the minimum of the available memory of the device and max_device_memory.
+            On CPU, it limits the memory of the graphs offloaded to the directory of the environment variable
+            MS_DEV_CPU_OFFLOAD_PATH in graph mode.
         variable_memory_max_size (str): This parameter is deprecated, and will be removed in a future version.
             Please use parameter 'max_device_memory' instead.
         mempool_block_size (str): Set the size of the memory pool block in PyNative mode for devices.
@@ -1022,6 +1024,21 @@ def set_ps_context(**kwargs):
         enable_ssl (bool): Set PS SSL mode enabled or disabled. Default: False.
         client_password (str): Password to decrypt the secret key stored in the client certificate. Default: ''.
         server_password (str): Password to decrypt the secret key stored in the server certificate. Default: ''.
+        push_compress_type (str): The compression of the dense gradients pushed to the servers, one of 'NO_COMPRESS',
+                                  'TOPK', 'QUANT_8BIT' and 'QUANT_4BIT'. The compress error is added back to the
+                                  gradient of the next push. A gradient with inf or nan is pushed without
+                                  compression. Default: 'NO_COMPRESS'.
+        push_sparse_rate (float): The ratio of the gradient elements pushed by 'TOPK', in (0, 1]. Default: 0.01.
+        pull_compress_type (str): The compression of the weights pulled from the servers, 'DELTA_QUANT_8BIT' sends
+                                  the 8 bits quantized change since the last pull. The servers keep the last pulled
+                                  weight of each worker, which costs worker_num times the memory of the dense
+                                  weights. Default: 'NO_COMPRESS'.
+        enable_embedding_hash_shard (bool): Shard the rows of the embedding tables on the servers by consistent
+                                            hashing instead of by contiguous ranges. Default: False.
+        embedding_server_num (int): The number of the servers the embedding tables are placed on, 0 for all the
+                                    servers. It takes effect with enable_embedding_hash_shard, and changing it
+                                    during the training migrates the rows between the servers while the training
+                                    goes on. Default: 0.
 
     Raises:
         ValueError: If input key is not the attribute in parameter server training mode context.
@@ -40,6 +40,7 @@ __all__ = ['set_sending_batches', 'load', '_init_device_info',
            'set_callback_timeout', 'get_callback_timeout',
            'set_auto_num_workers', 'get_auto_num_workers',
            'set_enable_shared_mem', 'get_enable_shared_mem',
+           'set_enable_slab_allocator', 'get_enable_slab_allocator',
            'set_enable_autotune', 'get_enable_autotune',
            'set_autotune_interval', 'get_autotune_interval',
            'set_auto_offload', 'get_auto_offload',
@@ -654,6 +655,47 @@ def set_enable_shared_mem(enable):
     _config.set_enable_shared_mem(enable)
 
 
+def set_enable_slab_allocator(enable):
+    """
+    Set whether the data of tensors in the pipeline is allocated from a slab allocator. The slab allocator
+    recycles the memory of released tensors instead of returning it to the system, which saves most of the
+    malloc and free calls of a steady pipeline and keeps its memory usage from fragmenting.
+
+    Note:
+        The memory reserved by the slab allocator is kept until the process exits.
+        Only tensors created after this call are affected.
+
+    Args:
+        enable (bool): Whether to allocate the data of tensors from the slab allocator.
+
+    Raises:
+        TypeError: If `enable` is not a boolean data type.
+
+    Examples:
+        >>> # Allocate the data of tensors from the slab allocator.
+        >>> ds.config.set_enable_slab_allocator(True)
+    """
+    if not isinstance(enable, bool):
+        raise TypeError("enable must be of type bool.")
+    _config.set_enable_slab_allocator(enable)
+
+
+def get_enable_slab_allocator():
+    """
+    Get whether the data of tensors in the pipeline is allocated from the slab allocator.
+    This is the value of `ds.config.set_enable_slab_allocator(enable)` if it is called before,
+    otherwise the default value is False.
+
+    Returns:
+        bool, whether the slab allocator is enabled.
+
+    Examples:
+        >>> # Get the flag of the slab allocator.
+        >>> slab_allocator_flag = ds.config.get_enable_slab_allocator()
+    """
+    return _config.get_enable_slab_allocator()
+
+
 def set_sending_batches(batch_num):
     """
     Set the default sending batches when training with sink_mode=True in Ascend device.
@@ -482,7 +482,8 @@ class Dataset:
 
     @check_bucket_batch_by_length
     def bucket_batch_by_length(self, column_names, bucket_boundaries, bucket_batch_sizes, element_length_function=None,
-                               pad_info=None, pad_to_bucket_boundary=False, drop_remainder=False):
+                               pad_info=None, pad_to_bucket_boundary=False, drop_remainder=False, max_tokens=None,
+                               window_size=1000):
         """
         Bucket elements according to their lengths. Each bucket will be padded and batched when
         they are full.
@@ -493,6 +494,11 @@ class Dataset:
         padded according to pad_info, and then form a batch.
         Each batch will be full, except one special case: the last batch for each bucket may not be full.
 
+        If max_tokens is set, the rows are batched by a token budget instead and the buckets are not used.
+        Every window_size rows are sorted by length and cut into batches of rows of similar length,
+        so that the number of rows in a batch times the longest length in it does not exceed max_tokens.
+        A row longer than max_tokens forms a batch on its own.
+
         Args:
             column_names (list[str]): Columns passed to element_length_function.
             bucket_boundaries (list[int]): A list consisting of the upper boundaries
@@ -521,6 +527,11 @@ class Dataset:
                 (default=False).
             drop_remainder (bool, optional): If True, will drop the last batch for each
                 bucket if it is not a full batch (default=False).
+            max_tokens (int, optional): The maximum number of tokens in a batch including padding. If set,
+                bucket_boundaries and bucket_batch_sizes are ignored and pad_to_bucket_boundary must be
+                False (default=None).
+            window_size (int, optional): The number of rows sorted by length together when max_tokens is
+                set. A larger window wastes less on padding but mixes the order of the rows more (default=1000).
 
         Returns:
             Dataset, dataset bucketed and batched by length.
@@ -546,9 +557,15 @@ class Dataset:
             ...                                          bucket_batch_sizes,
             ...                                          element_length_function, pad_info,
             ...                                          pad_to_bucket_boundary)
+            >>>
+            >>> # Batch col2 by a budget of 64 tokens per batch, padding included
+            >>> dataset = ds.GeneratorDataset(generate_2_columns(8), column_names)
+            >>> dataset = dataset.bucket_batch_by_length(["col2"], None, None, pad_info={"col2": ([None], -1)},
+            ...                                          max_tokens=64, window_size=100)
         """
         return BucketBatchByLengthDataset(self, column_names, bucket_boundaries, bucket_batch_sizes,
-                                          element_length_function, pad_info, pad_to_bucket_boundary, drop_remainder)
+                                          element_length_function, pad_info, pad_to_bucket_boundary, drop_remainder,
+                                          max_tokens, window_size)
 
     @check_batch
     def batch(self, batch_size, drop_remainder=False, num_parallel_workers=None, per_batch_map=None,
@@ -2314,7 +2331,7 @@ class BucketBatchByLengthDataset(UnionBaseDataset):
     """
 
     def __init__(self, input_dataset, column_names, bucket_boundaries, bucket_batch_sizes, element_length_function,
-                 pad_info, pad_to_bucket_boundary, drop_remainder):
+                 pad_info, pad_to_bucket_boundary, drop_remainder, max_tokens=None, window_size=1000):
         super().__init__(children=input_dataset)
 
         self.column_names = to_list(column_names)
@@ -2324,11 +2341,14 @@ class BucketBatchByLengthDataset(UnionBaseDataset):
         self.pad_info = replace_none(pad_info, {})
         self.pad_to_bucket_boundary = replace_none(pad_to_bucket_boundary, False)
         self.drop_remainder = replace_none(drop_remainder, False)
+        self.max_tokens = replace_none(max_tokens, 0)
+        self.window_size = replace_none(window_size, 0)
 
     def parse(self, children=None):
         return cde.BucketBatchByLengthNode(children[0], self.column_names, self.bucket_boundaries,
                                            self.bucket_batch_sizes, self.element_length_function, self.pad_info,
-                                           self.pad_to_bucket_boundary, self.drop_remainder)
+                                           self.pad_to_bucket_boundary, self.drop_remainder, self.max_tokens,
+                                           self.window_size)
 
 
 def _check_shm_usage(num_worker, queue_size, max_rowsize, num_queues=1):
@@ -1153,11 +1153,9 @@ def check_bucket_batch_by_length(method):
     @wraps(method)
     def new_method(self, *args, **kwargs):
         [column_names, bucket_boundaries, bucket_batch_sizes, element_length_function, pad_info,
-         pad_to_bucket_boundary, drop_remainder], _ = parse_user_args(method, *args, **kwargs)
+         pad_to_bucket_boundary, drop_remainder, max_tokens, window_size], _ = parse_user_args(method, *args, **kwargs)
 
-        nreq_param_list = ['column_names', 'bucket_boundaries', 'bucket_batch_sizes']
-
-        type_check_list([column_names, bucket_boundaries, bucket_batch_sizes], (list,), nreq_param_list)
+        type_check(column_names, (list,), "column_names")
 
         nbool_param_list = ['pad_to_bucket_boundary', 'drop_remainder']
         type_check_list([pad_to_bucket_boundary, drop_remainder], (bool,), nbool_param_list)
@@ -1171,33 +1169,14 @@ def check_bucket_batch_by_length(method):
         if element_length_function is not None and not callable(element_length_function):
             raise TypeError("element_length_function object is not callable.")
 
-        # check bucket_boundaries: must be list of int, positive and strictly increasing
-        if not bucket_boundaries:
-            raise ValueError("bucket_boundaries cannot be empty.")
-
-        all_int = all(isinstance(item, int) for item in bucket_boundaries)
-        if not all_int:
-            raise TypeError("bucket_boundaries should be a list of int.")
-
-        all_non_negative = all(item > 0 for item in bucket_boundaries)
-        if not all_non_negative:
-            raise ValueError("bucket_boundaries must only contain positive numbers.")
-
-        for i in range(len(bucket_boundaries) - 1):
-            if not bucket_boundaries[i + 1] > bucket_boundaries[i]:
-                raise ValueError("bucket_boundaries should be strictly increasing.")
-
-        # check bucket_batch_sizes: must be list of int and positive
-        if len(bucket_batch_sizes) != len(bucket_boundaries) + 1:
-            raise ValueError("bucket_batch_sizes must contain one element more than bucket_boundaries.")
-
-        all_int = all(isinstance(item, int) for item in bucket_batch_sizes)
-        if not all_int:
-            raise TypeError("bucket_batch_sizes should be a list of int.")
-
-        all_non_negative = all(item > 0 for item in bucket_batch_sizes)
-        if not all_non_negative:
-            raise ValueError("bucket_batch_sizes should be a list of positive numbers.")
+        if max_tokens is not None:
+            # token budget mode, the buckets are not used
+            check_pos_int32(max_tokens, "max_tokens")
+            check_pos_int32(window_size, "window_size")
+            if pad_to_bucket_boundary:
+                raise ValueError("pad_to_bucket_boundary can not be used when max_tokens is set.")
+        else:
+            check_bucket_boundaries(bucket_boundaries, bucket_batch_sizes)
 
         if pad_info is not None:
             type_check(pad_info, (dict,), "pad_info")
@@ -1210,6 +1189,40 @@ def check_bucket_batch_by_length(method):
     return new_method
 
 
+def check_bucket_boundaries(bucket_boundaries, bucket_batch_sizes):
+    """check the buckets of bucket_batch_by_length."""
+    nreq_param_list = ['bucket_boundaries', 'bucket_batch_sizes']
+    type_check_list([bucket_boundaries, bucket_batch_sizes], (list,), nreq_param_list)
+
+    # check bucket_boundaries: must be list of int, positive and strictly increasing
+    if not bucket_boundaries:
+        raise ValueError("bucket_boundaries cannot be empty.")
+
+    all_int = all(isinstance(item, int) for item in bucket_boundaries)
+    if not all_int:
+        raise TypeError("bucket_boundaries should be a list of int.")
+
+    all_non_negative = all(item > 0 for item in bucket_boundaries)
+    if not all_non_negative:
+        raise ValueError("bucket_boundaries must only contain positive numbers.")
+
+    for i in range(len(bucket_boundaries) - 1):
+        if not bucket_boundaries[i + 1] > bucket_boundaries[i]:
+            raise ValueError("bucket_boundaries should be strictly increasing.")
+
+    # check bucket_batch_sizes: must be list of int and positive
+    if len(bucket_batch_sizes) != len(bucket_boundaries) + 1:
+        raise ValueError("bucket_batch_sizes must contain one element more than bucket_boundaries.")
+
+    all_int = all(isinstance(item, int) for item in bucket_batch_sizes)
+    if not all_int:
+        raise TypeError("bucket_batch_sizes should be a list of int.")
+
+    all_non_negative = all(item > 0 for item in bucket_batch_sizes)
+    if not all_non_negative:
+        raise ValueError("bucket_batch_sizes should be a list of positive numbers.")
+
+
 def check_batch(method):
     """check the input arguments of batch."""
 
@@ -83,6 +83,11 @@ _set_ps_context_func_map = {
     "upload_compress_type": ps_context().set_upload_compress_type,
     "upload_sparse_rate": ps_context().set_upload_sparse_rate,
     "download_compress_type": ps_context().set_download_compress_type,
+    "push_compress_type": ps_context().set_push_compress_type,
+    "push_sparse_rate": ps_context().set_push_sparse_rate,
+    "pull_compress_type": ps_context().set_pull_compress_type,
+    "enable_embedding_hash_shard": ps_context().set_enable_embedding_hash_shard,
+    "embedding_server_num": ps_context().set_embedding_server_num,
 }
 
 _get_ps_context_func_map = {
@@ -134,6 +139,11 @@ _get_ps_context_func_map = {
     "upload_compress_type": ps_context().upload_compress_type,
     "upload_sparse_rate": ps_context().upload_sparse_rate,
     "download_compress_type": ps_context().download_compress_type,
+    "push_compress_type": ps_context().push_compress_type,
+    "push_sparse_rate": ps_context().push_sparse_rate,
+    "pull_compress_type": ps_context().pull_compress_type,
+    "enable_embedding_hash_shard": ps_context().enable_embedding_hash_shard,
+    "embedding_server_num": ps_context().embedding_server_num,
 }
 
 _check_positive_int_keys = ["server_num", "scheduler_port", "fl_server_port",
@@ -141,7 +151,7 @@ _check_positive_int_keys = ["server_num", "scheduler_port", "fl_server_port",
                             "fl_iteration_num", "client_epoch_num", "client_batch_size", "cipher_time_window",
                             "reconstruct_secrets_threshold"]
 
-_check_non_negative_int_keys = ["worker_num"]
+_check_non_negative_int_keys = ["worker_num", "embedding_server_num"]
 
 _check_positive_float_keys = ["update_model_ratio", "client_learning_rate"]
 
@@ -150,10 +160,13 @@ _check_port_keys = ["scheduler_port", "fl_server_port"]
 _check_string_keys = {
     "upload_compress_type": ["NO_COMPRESS", "DIFF_SPARSE_QUANT"],
     "download_compress_type": ["NO_COMPRESS", "QUANT"],
+    "push_compress_type": ["NO_COMPRESS", "TOPK", "QUANT_8BIT", "QUANT_4BIT"],
+    "pull_compress_type": ["NO_COMPRESS", "DELTA_QUANT_8BIT"],
 }
 
 _check_float_range_keys = {
     "upload_sparse_rate": {"lower_limit": 0.0, "upper_limit": 1.0, "rel": Rel.INC_RIGHT},
+    "push_sparse_rate": {"lower_limit": 0.0, "upper_limit": 1.0, "rel": Rel.INC_RIGHT},
 }
 
 def _get_ps_mode_rank():
@@ -192,6 +205,18 @@ def _set_ps_context(**kwargs):
         enable_ssl (bool): Set PS SSL mode enabled or disabled. Default: False.
         client_password (str): Password to decrypt the secret key stored in the client certificate. Default: ''.
         server_password (str): Password to decrypt the secret key stored in the server certificate. Default: ''.
+        push_compress_type (str): The compression of the dense gradients pushed to the servers, one of 'NO_COMPRESS',
+                                  'TOPK', 'QUANT_8BIT' and 'QUANT_4BIT'. The compress error is added back to the
+                                  gradient of the next push. Default: 'NO_COMPRESS'.
+        push_sparse_rate (float): The ratio of the gradient elements pushed by 'TOPK', in (0, 1]. Default: 0.01.
+        pull_compress_type (str): The compression of the weights pulled from the servers, 'DELTA_QUANT_8BIT' sends
+                                  the 8 bits quantized change since the last pull. Default: 'NO_COMPRESS'.
+        enable_embedding_hash_shard (bool): Shard the rows of the embedding tables on the servers by consistent
+                                            hashing instead of by contiguous ranges. Default: False.
+        embedding_server_num (int): The number of the servers the embedding tables are placed on, 0 for all the
+                                    servers. It takes effect with enable_embedding_hash_shard, and changing it
+                                    during the training migrates the rows between the servers while the training
+                                    goes on. Default: 0.
 
     Raises:
         ValueError: If input key is not the attribute in parameter server training mode context.
@@ -14,7 +14,7 @@
 # limitations under the License.
 # ============================================================================
 
-export MS_WORKER_NUM=8
+export MS_WORKER_NUM=${3:-8}
 export MS_SCHED_HOST=127.0.0.1
 export MS_SCHED_PORT=$2
 
@@ -24,10 +24,10 @@ python3 $1 >scheduler.txt 2>&1 &
 sched_pid=${!}
 echo "scheduler start success!"
 
-# Launch 8 workers.
+# Launch the workers.
 export MS_ROLE=MS_WORKER
 process_pid=()
-for((i=0;i<8;i++));
+for((i=0;i<${MS_WORKER_NUM};i++));
 do
     python3 $1 >worker_$i.txt 2>&1 &
     echo "worker ${i} start success with pid ${!}"
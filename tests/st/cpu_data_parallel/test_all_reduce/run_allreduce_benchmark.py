@@ -0,0 +1,69 @@
+# Copyright 2022 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ============================================================================
+
+"""benchmark AllReduce of different data sizes on CPU"""
+
+import time
+
+import numpy as np
+
+from mindspore import Tensor
+from mindspore import context
+from mindspore import nn
+from mindspore.ops import operations as P
+from mindspore.communication.management import init, get_group_size, get_rank
+
+context.set_context(mode=context.GRAPH_MODE, device_target='CPU')
+context.set_ps_context(enable_ssl=False)
+init()
+
+# The small data uses the halving doubling algorithm on the power of two ranks, and the large data uses the ring.
+DATA_NUMS = [1024, 16 * 1024, 256 * 1024, 4 * 1024 * 1024]
+WARMUP_STEPS = 2
+BENCHMARK_STEPS = 10
+
+
+class Net(nn.Cell):
+    def __init__(self):
+        super(Net, self).__init__()
+        self.all_reduce = P.AllReduce()
+
+    def construct(self, x):
+        return self.all_reduce(x)
+
+
+def run_all_reduce_benchmark():
+    """ Run all reduce of different data sizes and print the bus bandwidth"""
+    rank_size = get_group_size()
+    rank_id = get_rank()
+    all_reduce = Net()
+    for data_num in DATA_NUMS:
+        x_np = (np.arange(data_num) % 97).astype(np.float32) * (rank_id + 1)
+        x_input = Tensor(x_np)
+        for _ in range(WARMUP_STEPS):
+            output = all_reduce(x_input)
+        start = time.time()
+        for _ in range(BENCHMARK_STEPS):
+            output = all_reduce(x_input)
+        cost = (time.time() - start) / BENCHMARK_STEPS
+        expect = (np.arange(data_num) % 97).astype(np.float32) * (rank_size * (rank_size + 1) / 2)
+        assert np.allclose(output.asnumpy(), expect)
+        # Each rank sends and receives 2 * (n - 1) / n of the data at least.
+        bus_bandwidth = data_num * 4 * 2 * (rank_size - 1) / rank_size / cost / (1 << 20)
+        print("AllReduce rank size: {}, data size: {} bytes, time cost: {:.3f} ms, bus bandwidth: {:.2f} MB/s"
+              .format(rank_size, data_num * 4, cost * 1000, bus_bandwidth), flush=True)
+
+
+run_all_reduce_benchmark()
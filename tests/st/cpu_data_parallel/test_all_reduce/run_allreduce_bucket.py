@@ -0,0 +1,78 @@
+# Copyright 2022 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ============================================================================
+
+"""define and run the AllReduce network whose inputs are fused into several buckets"""
+
+import glob
+import os
+import re
+
+import numpy as np
+
+from mindspore import Tensor
+from mindspore import context
+from mindspore import nn
+from mindspore.ops import operations as P
+from mindspore.communication.management import init, get_group_size, get_rank
+
+context.set_context(mode=context.GRAPH_MODE, device_target='CPU')
+context.set_ps_context(enable_ssl=False)
+init()
+
+# Each input is 1MB, and the inputs are fused into the buckets of 4MB, which are 4MB, 4MB and 2MB.
+INPUT_NUM = 10
+INPUT_SHAPE = (512, 512)
+BUCKET_NUM = 3
+
+
+class Net(nn.Cell):
+    def __init__(self):
+        super(Net, self).__init__()
+        self.all_reduce = P.AllReduce().add_prim_attr("fusion", 1)
+        self.mul = P.Mul()
+
+    def construct(self, inputs):
+        outputs = ()
+        for x in inputs:
+            # The computation of the later inputs overlaps the reduction of the ready buckets.
+            outputs += (self.all_reduce(self.mul(x, x)),)
+        return outputs
+
+
+def count_fused_all_reduce(graph_path):
+    """ Count the AllReduce ops in the graph after the AllReduce fusion pass"""
+    ir_files = glob.glob(os.path.join(graph_path, "verbose_ir_files", "hwopt_*all_reduce_fusion*.ir"))
+    assert ir_files
+    with open(ir_files[0], "r") as f:
+        return len(re.findall(r"= [\w:]*AllReduce\(", f.read()))
+
+
+def run_all_reduce_bucket():
+    """ Run all reduce of the buckets"""
+    rank_size = get_group_size()
+    rank_id = get_rank()
+    graph_path = "./allreduce_bucket_graphs_{}".format(rank_id)
+    context.set_context(save_graphs=True, save_graphs_path=graph_path)
+    all_reduce = Net()
+    inputs_np = [np.full(INPUT_SHAPE, i + 1, np.float32) * (rank_id + 1) for i in range(INPUT_NUM)]
+    outputs = all_reduce(tuple(Tensor(x) for x in inputs_np))
+    square_sum = sum((r + 1) * (r + 1) for r in range(rank_size))
+    for i in range(INPUT_NUM):
+        expect = np.full(INPUT_SHAPE, (i + 1) * (i + 1) * square_sum, np.float32)
+        assert np.array_equal(outputs[i].asnumpy(), expect)
+    assert count_fused_all_reduce(graph_path) == BUCKET_NUM
+
+
+run_all_reduce_bucket()
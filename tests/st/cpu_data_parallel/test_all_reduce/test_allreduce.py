@@ -49,3 +49,35 @@ def test_allreduce_small_scale_data():
         return
     return_code = os.system("bash build_allreduce_net_cluster.sh run_allreduce_small_scale_data.py 8081")
     assert return_code == 0
+
+
+@pytest.mark.level1
+@pytest.mark.platform_x86_cpu
+@pytest.mark.env_onecard
+def test_allreduce_benchmark():
+    """
+    Feature: CPU data parallel.
+    Description: Benchmark allreduce of different data sizes on 4 and 6 local processes over loopback.
+    Expectation: Each node obtains all node reduced result, and the bandwidth is printed in the worker logs.
+    """
+    if sys.platform != 'linux':
+        return
+    return_code = os.system("bash build_allreduce_net_cluster.sh run_allreduce_benchmark.py 8123 4")
+    assert return_code == 0
+    return_code = os.system("bash build_allreduce_net_cluster.sh run_allreduce_benchmark.py 8125 6")
+    assert return_code == 0
+
+
+@pytest.mark.level0
+@pytest.mark.platform_x86_cpu
+@pytest.mark.env_onecard
+def test_allreduce_bucket():
+    """
+    Feature: CPU data parallel.
+    Description: Test the AllReduce ops which are fused into several buckets on CPU.
+    Expectation: Each node obtains all node reduced result.
+    """
+    if sys.platform != 'linux':
+        return
+    return_code = os.system("bash build_allreduce_net_cluster.sh run_allreduce_bucket.py 8127 4")
+    assert return_code == 0
@@ -0,0 +1,81 @@
+# Copyright 2022 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ============================================================================
+import time
+import numpy as np
+import pytest
+import mindspore.context as context
+import mindspore.nn as nn
+from mindspore import Tensor
+from mindspore.ops import operations as P
+
+
+class ElementwiseNet(nn.Cell):
+    def __init__(self, loop_count):
+        super(ElementwiseNet, self).__init__()
+        self.loop_count = loop_count
+        self.add = P.Add()
+        self.mul = P.Mul()
+        self.sub = P.Sub()
+        self.relu = P.ReLU()
+
+    def construct(self, x, y):
+        out = x
+        for _ in range(self.loop_count):
+            out = self.add(out, y)
+            out = self.mul(out, y)
+            out = self.sub(out, x)
+            out = self.relu(out)
+        return out
+
+
+def elementwise_numpy(x, y, loop_count):
+    out = x
+    for _ in range(loop_count):
+        out = np.maximum((out + y) * y - x, 0)
+    return out
+
+
+@pytest.mark.level0
+@pytest.mark.platform_x86_cpu
+@pytest.mark.env_onecard
+def test_pynative_op_pipeline_elementwise():
+    """
+    Feature: PyNative op pipeline
+    Description: Run short elementwise ops in a cell, the ops are built and launched by the pipeline of op executor.
+    Expectation: The result is the same as numpy, and the ops per second is printed.
+    """
+    context.set_context(mode=context.PYNATIVE_MODE, device_target="CPU")
+    loop_count = 100
+    op_count = loop_count * 4
+    step_count = 20
+    np.random.seed(0)
+    x_np = np.random.rand(16, 16).astype(np.float32)
+    y_np = np.random.rand(16, 16).astype(np.float32)
+    x = Tensor(x_np)
+    y = Tensor(y_np)
+    net = ElementwiseNet(loop_count)
+
+    # The first step builds the kernels.
+    out = net(x, y)
+    expect = elementwise_numpy(x_np, y_np, loop_count)
+    assert np.allclose(out.asnumpy(), expect, rtol=1e-4, atol=1e-4)
+
+    start = time.time()
+    for _ in range(step_count):
+        out = net(x, y)
+    out.asnumpy()
+    cost = time.time() - start
+    print("PyNative elementwise ops per second: {:.1f}".format(op_count * step_count / cost))
+    assert np.allclose(out.asnumpy(), expect, rtol=1e-4, atol=1e-4)
@@ -0,0 +1,148 @@
+# Copyright 2022 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ============================================================================
+import os
+import time
+import numpy as np
+import pytest
+
+import mindspore.nn as nn
+from mindspore import context, Tensor
+from mindspore.common.initializer import One
+from mindspore.nn.wrap.cell_wrapper import WithLossCell, TrainOneStepCell
+
+context.set_context(mode=context.GRAPH_MODE, device_target="CPU")
+
+STATIC_PLAN_ENV = 'MS_DEV_ENABLE_CPU_STATIC_PLAN'
+
+
+class SmallMLP(nn.Cell):
+    def __init__(self, width=32, depth=4):
+        super(SmallMLP, self).__init__()
+        layers = [nn.Dense(width, width, weight_init=One(), bias_init=One(), activation='relu') for _ in range(depth)]
+        self.layers = nn.SequentialCell(layers)
+        self.head = nn.Dense(width, 1, weight_init=One(), bias_init=One())
+
+    def construct(self, x):
+        return self.head(self.layers(x))
+
+
+class ResidualBlock(nn.Cell):
+    def __init__(self, channels):
+        super(ResidualBlock, self).__init__()
+        self.conv1 = nn.Conv2d(channels, channels, 3, weight_init=One())
+        self.bn1 = nn.BatchNorm2d(channels)
+        self.conv2 = nn.Conv2d(channels, channels, 3, weight_init=One())
+        self.bn2 = nn.BatchNorm2d(channels)
+        self.relu = nn.ReLU()
+
+    def construct(self, x):
+        out = self.relu(self.bn1(self.conv1(x)))
+        out = self.bn2(self.conv2(out))
+        return self.relu(out + x)
+
+
+class SmallResNet(nn.Cell):
+    def __init__(self, channels=8, depth=4):
+        super(SmallResNet, self).__init__()
+        self.stem = nn.Conv2d(3, channels, 3, weight_init=One())
+        self.blocks = nn.SequentialCell([ResidualBlock(channels) for _ in range(depth)])
+        self.pool = nn.AvgPool2d(kernel_size=16)
+        self.flatten = nn.Flatten()
+        self.head = nn.Dense(channels, 10, weight_init=One(), bias_init=One())
+
+    def construct(self, x):
+        return self.head(self.flatten(self.pool(self.blocks(self.stem(x)))))
+
+
+def run_steps(net, inputs, steps):
+    """Run the net for steps, return the last output and the time per step in microseconds."""
+    output = net(*inputs)
+    start = time.perf_counter()
+    for _ in range(steps):
+        output = net(*inputs)
+    cost = (time.perf_counter() - start) * 1e6 / steps
+    return output.asnumpy(), cost
+
+
+def run_with_static_plan(create_net, inputs, steps, enable):
+    os.environ[STATIC_PLAN_ENV] = '1' if enable else ''
+    try:
+        return run_steps(create_net(), inputs, steps)
+    finally:
+        os.environ[STATIC_PLAN_ENV] = ''
+
+
+@pytest.mark.level0
+@pytest.mark.platform_x86_cpu
+@pytest.mark.env_onecard
+def test_static_plan_mlp_inference():
+    """
+    Feature: Static execution plan of CPU graphs.
+    Description: Run a small MLP with and without the static execution plan, and log the time per step.
+    Expectation: The outputs are the same.
+    """
+    x = Tensor(np.random.rand(8, 32).astype(np.float32) / 32)
+    expect, actor_cost = run_with_static_plan(SmallMLP, [x], 200, False)
+    output, plan_cost = run_with_static_plan(SmallMLP, [x], 200, True)
+    print("Small MLP inference, actors: {:.1f}us/step, static plan: {:.1f}us/step".format(actor_cost, plan_cost))
+    assert np.allclose(output, expect, rtol=1e-5)
+
+
+@pytest.mark.level0
+@pytest.mark.platform_x86_cpu
+@pytest.mark.env_onecard
+def test_static_plan_mlp_train():
+    """
+    Feature: Static execution plan of CPU graphs.
+    Description: Train a small MLP with and without the static execution plan, the optimizer updates the weights in
+        place after the gradients are computed.
+    Expectation: The losses after the same steps are the same.
+    """
+    def create_train_net():
+        net = SmallMLP()
+        loss_net = WithLossCell(net, nn.MSELoss())
+        optimizer = nn.Momentum(net.trainable_params(), learning_rate=0.001, momentum=0.9)
+        return TrainOneStepCell(loss_net, optimizer)
+
+    x = Tensor(np.random.rand(8, 32).astype(np.float32) / 32)
+    label = Tensor(np.ones((8, 1)).astype(np.float32))
+    expect, actor_cost = run_with_static_plan(create_train_net, [x, label], 50, False)
+    loss, plan_cost = run_with_static_plan(create_train_net, [x, label], 50, True)
+    print("Small MLP train, actors: {:.1f}us/step, static plan: {:.1f}us/step".format(actor_cost, plan_cost))
+    assert np.allclose(loss, expect, rtol=1e-5)
+
+
+@pytest.mark.level0
+@pytest.mark.platform_x86_cpu
+@pytest.mark.env_onecard
+def test_static_plan_resnet_train():
+    """
+    Feature: Static execution plan of CPU graphs.
+    Description: Train a small residual network with and without the static execution plan, the activations and the
+        gradients of the different layers share the plan memory solved by SOMAS.
+    Expectation: The losses after the same steps are the same.
+    """
+    def create_train_net():
+        net = SmallResNet()
+        loss_net = WithLossCell(net, nn.SoftmaxCrossEntropyWithLogits(sparse=True, reduction='mean'))
+        optimizer = nn.Momentum(net.trainable_params(), learning_rate=0.0001, momentum=0.9)
+        return TrainOneStepCell(loss_net, optimizer)
+
+    x = Tensor(np.random.rand(4, 3, 16, 16).astype(np.float32) / 16)
+    label = Tensor(np.arange(4).astype(np.int32))
+    expect, actor_cost = run_with_static_plan(create_train_net, [x, label], 20, False)
+    loss, plan_cost = run_with_static_plan(create_train_net, [x, label], 20, True)
+    print("Small ResNet train, actors: {:.1f}us/step, static plan: {:.1f}us/step".format(actor_cost, plan_cost))
+    assert np.allclose(loss, expect, rtol=1e-5)
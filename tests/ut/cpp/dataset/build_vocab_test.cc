@@ -21,7 +21,12 @@
 #include "common/common.h"
 #include "include/api/status.h"
 #include "minddata/dataset/include/dataset/text.h"
+#include "minddata/dataset/text/frozen_vocab.h"
+#include "minddata/dataset/text/kernels/lookup_op.h"
 
+using mindspore::dataset::DataType;
+using mindspore::dataset::FrozenVocab;
+using mindspore::dataset::LookupOp;
 using mindspore::dataset::Tensor;
 using mindspore::dataset::Vocab;
 
@@ -248,3 +253,67 @@ TEST_F(MindDataTestVocab, TestVocabFromFileFail4) {
   Status s = Vocab::BuildFromFile(vocab_dir, ",", -1, {"home"}, true, &vocab);
   EXPECT_NE(s, Status::OK());
 }
+
+/// Feature: FrozenVocab
+/// Description: Test lookup in a frozen copy of a vocab
+/// Expectation: Every word gets the same id as from the original vocab, unknown words get -1
+TEST_F(MindDataTestVocab, TestFrozenVocabLookup) {
+  MS_LOG(INFO) << "Doing MindDataTestVocab-TestFrozenVocabLookup.";
+  std::vector<std::string> list;
+  for (int32_t i = 0; i < 1000; ++i) {
+    list.push_back("word" + std::to_string(i));
+  }
+  list.push_back("");
+  std::shared_ptr<Vocab> vocab = std::make_shared<Vocab>();
+  Status s = Vocab::BuildFromVector(list, {"<pad>", "<unk>"}, true, &vocab);
+  EXPECT_EQ(s, Status::OK());
+
+  std::unique_ptr<FrozenVocab> frozen;
+  s = FrozenVocab::Build(*vocab, &frozen);
+  EXPECT_EQ(s, Status::OK());
+  EXPECT_EQ(frozen->size(), vocab->GetVocab().size());
+  for (const auto &wd : vocab->GetVocab()) {
+    EXPECT_EQ(frozen->Lookup(wd.first), wd.second);
+  }
+  EXPECT_EQ(frozen->Lookup("word1000"), -1);
+  EXPECT_EQ(frozen->Lookup("word"), -1);
+}
+
+/// Feature: FrozenVocab
+/// Description: Test lookup in a frozen copy of an empty vocab
+/// Expectation: Every lookup returns -1
+TEST_F(MindDataTestVocab, TestFrozenVocabEmpty) {
+  MS_LOG(INFO) << "Doing MindDataTestVocab-TestFrozenVocabEmpty.";
+  std::shared_ptr<Vocab> vocab = std::make_shared<Vocab>();
+  std::unique_ptr<FrozenVocab> frozen;
+  Status s = FrozenVocab::Build(*vocab, &frozen);
+  EXPECT_EQ(s, Status::OK());
+  EXPECT_EQ(frozen->size(), 0U);
+  EXPECT_EQ(frozen->Lookup("apple"), -1);
+}
+
+/// Feature: LookupOp
+/// Description: Test lookup of a word appended to the vocab after the first lookup
+/// Expectation: The appended word gets its new id instead of the default id
+TEST_F(MindDataTestVocab, TestLookupAfterAppendWord) {
+  MS_LOG(INFO) << "Doing MindDataTestVocab-TestLookupAfterAppendWord.";
+  std::shared_ptr<Vocab> vocab = std::make_shared<Vocab>();
+  Status s = Vocab::BuildFromVector({"apple", "banana"}, {"<unk>"}, true, &vocab);
+  EXPECT_EQ(s, Status::OK());
+  LookupOp op(vocab, 0, DataType(DataType::DE_INT32));
+
+  std::shared_ptr<Tensor> input;
+  EXPECT_EQ(Tensor::CreateFromVector(std::vector<std::string>{"banana", "cherry"}, &input), Status::OK());
+  std::shared_ptr<Tensor> output;
+  EXPECT_EQ(op.Compute(input, &output), Status::OK());
+  int32_t id = -1;
+  EXPECT_EQ(output->GetItemAt(&id, {1}), Status::OK());
+  EXPECT_EQ(id, 0);
+
+  vocab->AppendWord("cherry");
+  EXPECT_EQ(op.Compute(input, &output), Status::OK());
+  EXPECT_EQ(output->GetItemAt(&id, {0}), Status::OK());
+  EXPECT_EQ(id, 2);
+  EXPECT_EQ(output->GetItemAt(&id, {1}), Status::OK());
+  EXPECT_EQ(id, 3);
+}
@@ -0,0 +1,179 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <sstream>
+#include "common/common.h"
+#include "minddata/dataset/core/tensor_row.h"
+#include "minddata/dataset/engine/datasetops/snapshot_op.h"
+#include "minddata/dataset/include/dataset/datasets.h"
+#include "minddata/dataset/util/path.h"
+#include "minddata/dataset/util/services.h"
+
+using namespace mindspore::dataset;
+using mindspore::dataset::Tensor;
+
+class MindDataTestPipeline : public UT::DatasetOpTesting {
+ protected:
+};
+
+namespace {
+// Remove a snapshot root directory along with the snapshots in it
+void RemoveSnapshots(const std::string &root) {
+  Path root_dir(root);
+  auto it = Path::DirIterator::OpenDirectory(&root_dir);
+  while (it != nullptr && it->HasNext()) {
+    Path snapshot = it->Next();
+    auto files = Path::DirIterator::OpenDirectory(&snapshot);
+    while (files != nullptr && files->HasNext()) {
+      (void)files->Next().Remove();
+    }
+    (void)snapshot.Remove();
+  }
+  (void)root_dir.Remove();
+}
+
+// Iterate over a dataset and collect the labels
+std::vector<int32_t> CollectLabels(const std::shared_ptr<Dataset> &ds) {
+  std::vector<int32_t> labels;
+  std::shared_ptr<Iterator> iter = ds->CreateIterator();
+  EXPECT_NE(iter, nullptr);
+  std::unordered_map<std::string, mindspore::MSTensor> row;
+  EXPECT_OK(iter->GetNextRow(&row));
+  while (row.size() != 0) {
+    auto label = row["label"];
+    labels.push_back(*reinterpret_cast<const int32_t *>(label.Data().get()));
+    EXPECT_OK(iter->GetNextRow(&row));
+  }
+  iter->Stop();
+  return labels;
+}
+}  // namespace
+
+/// Feature: Snapshot
+/// Description: Test serializing and deserializing a row with numeric, string and empty tensors
+/// Expectation: The row read back is identical to the row written
+TEST_F(MindDataTestPipeline, TestSnapshotRowSerdes) {
+  std::shared_ptr<Tensor> numeric;
+  std::shared_ptr<Tensor> text;
+  std::shared_ptr<Tensor> empty;
+  ASSERT_OK(Tensor::CreateFromVector(std::vector<int16_t>{1, 2, 3, 4, 5, 6}, TensorShape({2, 3}), &numeric));
+  ASSERT_OK(Tensor::CreateFromVector(std::vector<std::string>{"snap", "", "shot"}, &text));
+  ASSERT_OK(Tensor::CreateEmpty(TensorShape({0}), DataType(DataType::DE_FLOAT32), &empty));
+  TensorRow row({numeric, text, empty});
+
+  std::stringstream ss;
+  uint64_t num_bytes = 0;
+  ASSERT_OK(SnapshotOp::SerializeRow(row, &ss, &num_bytes));
+  std::string data = ss.str();
+  ASSERT_EQ(data.size(), num_bytes);
+  ASSERT_EQ(num_bytes % 8, 0);
+
+  TensorRow out;
+  ASSERT_OK(SnapshotOp::DeserializeRow(reinterpret_cast<const uint8_t *>(data.data()), num_bytes, &out));
+  ASSERT_EQ(out.size(), row.size());
+  for (size_t i = 0; i < row.size(); ++i) {
+    EXPECT_EQ(*out[i], *row[i]);
+  }
+
+  // A truncated record is rejected
+  TensorRow truncated;
+  EXPECT_ERROR(SnapshotOp::DeserializeRow(reinterpret_cast<const uint8_t *>(data.data()), num_bytes - 8, &truncated));
+}
+
+/// Feature: Snapshot
+/// Description: Test a pipeline is written to a snapshot in the first run and replayed from it in the second run
+/// Expectation: Both runs return the same rows, and the snapshot is complete after the first run
+TEST_F(MindDataTestPipeline, TestSnapshotWriteThenRead) {
+  MS_LOG(INFO) << "Doing MindDataTestPipeline-TestSnapshotWriteThenRead.";
+  std::string folder_path = datasets_root_path_ + "/testPK/data/";
+  std::string root = "./snapshot_test_" + Services::GetUniqueID();
+
+  auto make_pipeline = [&folder_path, &root]() {
+    std::shared_ptr<Dataset> ds = ImageFolder(folder_path, false, std::make_shared<SequentialSampler>(0, 10));
+    EXPECT_NE(ds, nullptr);
+    ds = ds->Project({"label"});
+    EXPECT_NE(ds, nullptr);
+    ds = ds->Snapshot(root, 3);
+    EXPECT_NE(ds, nullptr);
+    return ds;
+  };
+
+  std::vector<int32_t> written = CollectLabels(make_pipeline());
+  EXPECT_EQ(written.size(), 10);
+
+  // Exactly one complete snapshot is left behind
+  Path root_dir(root);
+  auto it = Path::DirIterator::OpenDirectory(&root_dir);
+  ASSERT_NE(it, nullptr);
+  int32_t num_snapshots = 0;
+  while (it->HasNext()) {
+    EXPECT_TRUE(SnapshotOp::SnapshotReady(it->Next().ToString()));
+    num_snapshots++;
+  }
+  EXPECT_EQ(num_snapshots, 1);
+
+  std::shared_ptr<Dataset> replay = make_pipeline();
+  EXPECT_EQ(replay->GetDatasetSize(), 10);
+  std::vector<int32_t> replayed = CollectLabels(replay);
+  EXPECT_EQ(replayed, written);
+
+  RemoveSnapshots(root);
+}
+
+/// Feature: Snapshot
+/// Description: Test a snapshot of a pipeline with a Repeat beneath it
+/// Expectation: The snapshot holds the rows of all the repeats and replays them all
+TEST_F(MindDataTestPipeline, TestSnapshotRepeatInside) {
+  MS_LOG(INFO) << "Doing MindDataTestPipeline-TestSnapshotRepeatInside.";
+  std::string folder_path = datasets_root_path_ + "/testPK/data/";
+  std::string root = "./snapshot_test_" + Services::GetUniqueID();
+
+  auto make_pipeline = [&folder_path, &root]() {
+    std::shared_ptr<Dataset> ds = ImageFolder(folder_path, false, std::make_shared<SequentialSampler>(0, 5));
+    EXPECT_NE(ds, nullptr);
+    ds = ds->Project({"label"});
+    EXPECT_NE(ds, nullptr);
+    ds = ds->Repeat(3);
+    EXPECT_NE(ds, nullptr);
+    ds = ds->Snapshot(root, 2);
+    EXPECT_NE(ds, nullptr);
+    return ds;
+  };
+
+  std::vector<int32_t> written = CollectLabels(make_pipeline());
+  EXPECT_EQ(written.size(), 15);
+
+  std::shared_ptr<Dataset> replay = make_pipeline();
+  EXPECT_EQ(replay->GetDatasetSize(), 15);
+  std::vector<int32_t> replayed = CollectLabels(replay);
+  EXPECT_EQ(replayed, written);
+
+  RemoveSnapshots(root);
+}
+
+/// Feature: Snapshot
+/// Description: Test Snapshot with an invalid number of shards
+/// Expectation: Error is raised when creating the iterator
+TEST_F(MindDataTestPipeline, TestSnapshotFail) {
+  MS_LOG(INFO) << "Doing MindDataTestPipeline-TestSnapshotFail.";
+  std::string folder_path = datasets_root_path_ + "/testPK/data/";
+  std::shared_ptr<Dataset> ds = ImageFolder(folder_path, false, std::make_shared<SequentialSampler>(0, 10));
+  EXPECT_NE(ds, nullptr);
+  ds = ds->Snapshot("./snapshot_test_fail", 0);
+  EXPECT_NE(ds, nullptr);
+  std::shared_ptr<Iterator> iter = ds->CreateIterator();
+  // Expect failure: invalid number of shards
+  EXPECT_EQ(iter, nullptr);
+}
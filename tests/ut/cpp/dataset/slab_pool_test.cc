@@ -0,0 +1,168 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "common/common.h"
+#include "gtest/gtest.h"
+#include "minddata/dataset/core/global_context.h"
+#include "minddata/dataset/core/tensor.h"
+#include "minddata/dataset/util/queue.h"
+#include "minddata/dataset/util/slab_pool.h"
+#include "minddata/dataset/util/system_pool.h"
+#include "minddata/dataset/util/task_manager.h"
+#include "utils/log_adapter.h"
+
+using namespace mindspore::dataset;
+
+class MindDataTestSlabPool : public UT::Common {
+ public:
+  MindDataTestSlabPool() {}
+};
+
+namespace {
+// Allocate and free batches of buffers of mixed sizes, return the elapsed time in microseconds
+Status AllocFreeLoop(const std::shared_ptr<MemoryPool> &pool, int32_t num_iters, int64_t *elapsed_us) {
+  const std::vector<size_t> sizes = {100, 3000, 50000, 150528, 602112};
+  std::vector<void *> buffers(sizes.size(), nullptr);
+  auto start = std::chrono::steady_clock::now();
+  for (int32_t i = 0; i < num_iters; ++i) {
+    for (size_t j = 0; j < sizes.size(); ++j) {
+      RETURN_IF_NOT_OK(pool->Allocate(sizes[j], &buffers[j]));
+      static_cast<uint8_t *>(buffers[j])[0] = static_cast<uint8_t>(i);
+    }
+    for (auto p : buffers) {
+      pool->Deallocate(p);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  *elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+  return Status::OK();
+}
+}  // namespace
+
+/// Feature: SlabPool
+/// Description: Test allocating, reallocating and freeing blocks of different size classes and a large block
+/// Expectation: Blocks are aligned and usable, freed blocks are recycled and large blocks bypass the slabs
+TEST_F(MindDataTestSlabPool, TestAllocateFree) {
+  SlabPool pool;
+  EXPECT_EQ(SlabPool::SizeClass(1), 0);
+  EXPECT_EQ(SlabPool::SizeClass(SlabPool::kMinBlockSize), 0);
+  EXPECT_EQ(SlabPool::SizeClass(SlabPool::kMinBlockSize + 1), 1);
+  EXPECT_EQ(SlabPool::SizeClass(SlabPool::kMaxBlockSize), SlabPool::kNumSizeClasses - 1);
+  EXPECT_EQ(SlabPool::SizeClass(SlabPool::kMaxBlockSize + 1), SlabPool::kNumSizeClasses);
+
+  void *p1 = nullptr;
+  void *p2 = nullptr;
+  ASSERT_OK(pool.Allocate(100, &p1));
+  ASSERT_OK(pool.Allocate(100, &p2));
+  ASSERT_NE(p1, p2);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(p1) % 16, 0);
+  memset(p1, 1, 100);
+  memset(p2, 2, 100);
+  pool.Deallocate(p1);
+  void *p3 = nullptr;
+  ASSERT_OK(pool.Allocate(120, &p3));
+  EXPECT_EQ(p1, p3);
+
+  // Growing within the size class keeps the block, growing beyond it moves the content
+  void *p4 = p2;
+  ASSERT_OK(pool.Reallocate(&p4, 100, 128));
+  EXPECT_EQ(p4, p2);
+  ASSERT_OK(pool.Reallocate(&p4, 128, 1000));
+  EXPECT_NE(p4, p2);
+  EXPECT_EQ(static_cast<uint8_t *>(p4)[99], 2);
+
+  void *large = nullptr;
+  ASSERT_OK(pool.Allocate(SlabPool::kMaxBlockSize + 1, &large));
+  EXPECT_EQ(pool.GetStats().large_bytes, SlabPool::kMaxBlockSize + 1);
+  pool.Deallocate(large);
+  EXPECT_EQ(pool.GetStats().large_bytes, 0);
+
+  pool.Deallocate(p3);
+  pool.Deallocate(p4);
+  EXPECT_GT(pool.GetStats().num_slabs, 0);
+}
+
+/// Feature: SlabPool
+/// Description: Test blocks allocated by one thread and freed by another thread
+/// Expectation: The reserved memory stays bounded, so freed blocks are recycled across threads
+TEST_F(MindDataTestSlabPool, TestCrossThreadFree) {
+  const int32_t num_blocks = 100000;
+  const size_t block_size = 4096;
+  auto pool = std::make_shared<SlabPool>();
+  Queue<void *> handoff(64);
+  TaskGroup vg;
+  ASSERT_OK(handoff.Register(&vg));
+  auto producer = [&pool, &handoff, num_blocks, block_size]() -> Status {
+    TaskManager::FindMe()->Post();
+    for (int32_t i = 0; i < num_blocks; ++i) {
+      void *p = nullptr;
+      RETURN_IF_NOT_OK(pool->Allocate(block_size, &p));
+      *static_cast<int32_t *>(p) = i;
+      RETURN_IF_NOT_OK(handoff.Add(p));
+    }
+    return Status::OK();
+  };
+  auto consumer = [&pool, &handoff, num_blocks]() -> Status {
+    TaskManager::FindMe()->Post();
+    for (int32_t i = 0; i < num_blocks; ++i) {
+      void *p = nullptr;
+      RETURN_IF_NOT_OK(handoff.PopFront(&p));
+      CHECK_FAIL_RETURN_UNEXPECTED(*static_cast<int32_t *>(p) == i, "Block corrupted.");
+      pool->Deallocate(p);
+    }
+    return Status::OK();
+  };
+  ASSERT_OK(vg.CreateAsyncTask("Producer", producer));
+  ASSERT_OK(vg.CreateAsyncTask("Consumer", consumer));
+  ASSERT_OK(vg.join_all());
+  ASSERT_OK(vg.GetTaskErrorIfAny());
+  // 400MB went through the pool, the blocks in flight and in the caches need far less than that
+  auto stats = pool->GetStats();
+  MS_LOG(INFO) << "Reserved " << stats.slab_bytes << " bytes in " << stats.num_slabs << " slabs.";
+  EXPECT_LT(stats.slab_bytes, 16 * SlabPool::kSlabSize);
+}
+
+/// Feature: SlabPool
+/// Description: Compare the allocation throughput of the slab pool with the system pool
+/// Expectation: Both pools serve the same sequence of requests, the timings are logged
+TEST_F(MindDataTestSlabPool, TestThroughput) {
+  const int32_t num_iters = 20000;
+  int64_t system_us = 0;
+  int64_t slab_us = 0;
+  ASSERT_OK(AllocFreeLoop(std::make_shared<SystemPool>(), num_iters, &system_us));
+  auto slab_pool = std::make_shared<SlabPool>();
+  ASSERT_OK(AllocFreeLoop(slab_pool, num_iters, &slab_us));
+  MS_LOG(INFO) << "Alloc/free " << num_iters << " batches, system pool: " << system_us << "us, slab pool: " << slab_us
+               << "us, reserved by slab pool: " << slab_pool->GetStats().slab_bytes << " bytes.";
+}
+
+/// Feature: SlabPool
+/// Description: Test the slab pool is used for new tensors when it is enabled in the config
+/// Expectation: Tensors are created and hold their data with either pool
+TEST_F(MindDataTestSlabPool, TestTensorAllocator) {
+  auto config = GlobalContext::config_manager();
+  bool old_flag = config->enable_slab_allocator();
+  std::shared_ptr<Tensor> before;
+  ASSERT_OK(Tensor::CreateFromVector(std::vector<float>(1000, 1.5f), &before));
+  config->set_enable_slab_allocator(true);
+  EXPECT_NE(GlobalContext::Instance()->tensor_mem_pool(), GlobalContext::Instance()->mem_pool());
+  std::shared_ptr<Tensor> after;
+  ASSERT_OK(Tensor::CreateFromVector(std::vector<float>(1000, 1.5f), &after));
+  EXPECT_EQ(*before, *after);
+  config->set_enable_slab_allocator(old_flag);
+}
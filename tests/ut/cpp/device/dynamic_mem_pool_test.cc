@@ -0,0 +1,195 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <vector>
+#include "common/common_test.h"
+#include "common/mem_reuse/mem_dynamic_allocator.h"
+#include "utils/convert_utils_base.h"
+
+namespace mindspore::device {
+constexpr size_t kUnitSize = 1 << 20;
+constexpr size_t kDeviceMemSize = 4 << 20;
+
+// The memory pool allocating the memory blocks by malloc as the CPU memory pool, with a limited device memory.
+class MallocMemoryPool : public DynamicMemPoolBestFit {
+ public:
+  MallocMemoryPool() { SetMemAllocUintSize(kUnitSize, kUnitSize); }
+  ~MallocMemoryPool() override { ReleaseDeviceRes(); }
+
+  size_t AllocDeviceMem(size_t size, DeviceMemPtr *addr) override {
+    if (used_size_ + size > kDeviceMemSize) {
+      return 0;
+    }
+    *addr = malloc(size);
+    if (*addr == nullptr) {
+      return 0;
+    }
+    used_size_ += size;
+    block_sizes_[*addr] = size;
+    return size;
+  }
+
+  bool FreeDeviceMem(const DeviceMemPtr &addr) override {
+    used_size_ -= block_sizes_[addr];
+    (void)block_sizes_.erase(addr);
+    free(addr);
+    return true;
+  }
+
+  size_t free_mem_size() override { return kDeviceMemSize - used_size_; }
+
+  bool SyncStream(size_t stream_id) override {
+    ++sync_count_;
+    return true;
+  }
+
+  size_t sync_count() const { return sync_count_; }
+  size_t block_count() const { return block_sizes_.size(); }
+
+ protected:
+  bool IsMemBlockReleasable() const override { return true; }
+  // The device memory is smaller than the minimum alloc size of the base memory pool.
+  size_t CalMemBlockAllocSize(size_t size, bool from_persistent_mem) override {
+    auto alloc_size = std::max(size, MemAllocUnitSize(from_persistent_mem));
+    return alloc_size <= free_mem_size() ? alloc_size : 0;
+  }
+
+ private:
+  size_t used_size_{0};
+  size_t sync_count_{0};
+  std::map<DeviceMemPtr, size_t> block_sizes_;
+};
+
+class TestDynamicMemPool : public UT::Common {
+ public:
+  TestDynamicMemPool() = default;
+};
+
+/// Feature: Size class bins of the dynamic memory pool.
+/// Description: Free the small memory of different sizes and allocate them again.
+/// Expectation: The smallest idle memory buf which is big enough is reused, and the lower address first.
+TEST_F(TestDynamicMemPool, TestSizeClassBin) {
+  MallocMemoryPool pool;
+  auto addr_512 = pool.AllocTensorMem(100);
+  auto addr_guard1 = pool.AllocTensorMem(512);
+  auto addr_2k = pool.AllocTensorMem(2048);
+  auto addr_guard2 = pool.AllocTensorMem(512);
+  auto addr_1k = pool.AllocTensorMem(1000);
+  auto addr_guard3 = pool.AllocTensorMem(512);
+  for (auto addr : {addr_512, addr_guard1, addr_2k, addr_guard2, addr_1k, addr_guard3}) {
+    ASSERT_NE(addr, nullptr);
+  }
+  pool.FreeTensorMem(addr_512);
+  pool.FreeTensorMem(addr_2k);
+  pool.FreeTensorMem(addr_1k);
+
+  // The 1k buf is the best fit of 600 bytes.
+  EXPECT_EQ(pool.AllocTensorMem(600), addr_1k);
+  // The 512 buf is the best fit of 1 byte.
+  EXPECT_EQ(pool.AllocTensorMem(1), addr_512);
+  // Split the 2k buf.
+  EXPECT_EQ(pool.AllocTensorMem(512), addr_2k);
+  EXPECT_EQ(pool.AllocTensorMem(1536), AddressOffset(addr_2k, 512));
+  EXPECT_EQ(pool.TotalMemStatistics(), kUnitSize);
+}
+
+/// Feature: Coalescing of the dynamic memory pool.
+/// Description: Free the adjacent memory bufs in different orders.
+/// Expectation: The adjacent idle memory bufs are combined into one, and the fragmentation is reported.
+TEST_F(TestDynamicMemPool, TestCombineMemBuf) {
+  MallocMemoryPool pool;
+  std::vector<DeviceMemPtr> addrs;
+  for (size_t i = 0; i < 8; ++i) {
+    addrs.push_back(pool.AllocTensorMem(4096));
+    ASSERT_NE(addrs.back(), nullptr);
+  }
+  // Free every other buf, the idle memory is fragmented in the freed bufs and the rest of block.
+  for (size_t i = 0; i < addrs.size(); i += 2) {
+    pool.FreeTensorMem(addrs[i]);
+  }
+  auto state = pool.FragmentationStatistics();
+  EXPECT_EQ(state.total_idle_size_, kUnitSize - 4 * 4096);
+  EXPECT_EQ(state.idle_buf_count_, 5);
+  EXPECT_GT(state.fragmentation_, 0.0f);
+  EXPECT_EQ(state.free_block_size_, 0);
+
+  // Free the rest, all the bufs are combined into the whole block.
+  for (size_t i = 1; i < addrs.size(); i += 2) {
+    pool.FreeTensorMem(addrs[i]);
+  }
+  state = pool.FragmentationStatistics();
+  EXPECT_EQ(state.total_idle_size_, kUnitSize);
+  EXPECT_EQ(state.max_idle_buf_size_, kUnitSize);
+  EXPECT_EQ(state.idle_buf_count_, 1);
+  EXPECT_EQ(state.fragmentation_, 0.0f);
+  EXPECT_EQ(state.free_block_size_, kUnitSize);
+  pool.DumpDynamicMemPoolStateInfo();
+}
+
+/// Feature: Stream ordered deferred free of the dynamic memory pool.
+/// Description: Free the memory on the streams, and allocate the memory before and after the streams are synchronized.
+/// Expectation: The memory is reused only after it is released, and the streams are synchronized when out of memory.
+TEST_F(TestDynamicMemPool, TestDeferredFree) {
+  MallocMemoryPool pool;
+  auto addr1 = pool.AllocTensorMem(kUnitSize);
+  ASSERT_NE(addr1, nullptr);
+  pool.FreeTensorMemOnStream(addr1, 0);
+  EXPECT_EQ(pool.DeferredFreeMemSize(), kUnitSize);
+  // The memory freed on the stream is still in use.
+  auto addr2 = pool.AllocTensorMem(kUnitSize);
+  ASSERT_NE(addr2, nullptr);
+  EXPECT_NE(addr2, addr1);
+  pool.ReleaseDeferredFreeMem(0);
+  EXPECT_EQ(pool.DeferredFreeMemSize(), 0);
+  EXPECT_EQ(pool.AllocTensorMem(kUnitSize), addr1);
+
+  // Fill the device memory, then the stream is synchronized to reuse the memory freed on it.
+  auto addr3 = pool.AllocTensorMem(kUnitSize);
+  auto addr4 = pool.AllocTensorMem(kUnitSize);
+  ASSERT_NE(addr3, nullptr);
+  ASSERT_NE(addr4, nullptr);
+  pool.FreeTensorMemOnStream(addr3, 1);
+  EXPECT_EQ(pool.sync_count(), 0);
+  EXPECT_EQ(pool.AllocTensorMem(kUnitSize), addr3);
+  EXPECT_EQ(pool.sync_count(), 1);
+  EXPECT_EQ(pool.DeferredFreeMemSize(), 0);
+}
+
+/// Feature: Defragmentation of the dynamic memory pool.
+/// Description: The idle memory is in several memory blocks, allocate the memory bigger than any block.
+/// Expectation: The free memory blocks are released and the memory is allocated in a new memory block.
+TEST_F(TestDynamicMemPool, TestReleaseFreeMemBlock) {
+  MallocMemoryPool pool;
+  std::vector<DeviceMemPtr> addrs;
+  for (size_t i = 0; i < 4; ++i) {
+    addrs.push_back(pool.AllocTensorMem(kUnitSize));
+    ASSERT_NE(addrs.back(), nullptr);
+  }
+  EXPECT_EQ(pool.block_count(), 4);
+  for (size_t i = 0; i < 3; ++i) {
+    pool.FreeTensorMem(addrs[i]);
+  }
+  EXPECT_EQ(pool.FragmentationStatistics().free_block_size_, 3 * kUnitSize);
+  auto addr = pool.AllocTensorMem(3 * kUnitSize);
+  ASSERT_NE(addr, nullptr);
+  EXPECT_EQ(pool.block_count(), 2);
+  EXPECT_EQ(pool.TotalMemStatistics(), 4 * kUnitSize);
+  EXPECT_EQ(pool.TotalUsedMemStatistics(), 4 * kUnitSize);
+}
+}  // namespace mindspore::device
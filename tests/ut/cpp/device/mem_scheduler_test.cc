@@ -14,13 +14,19 @@
  * limitations under the License.
  */
 
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <vector>
 #include <map>
 #include "common/common_test.h"
 #include "runtime/device/memory_scheduler.h"
+#include "runtime/device/mmap_swap_file.h"
+#include "utils/log_adapter.h"
 namespace mindspore::device {
 constexpr size_t kDeviceMemSize = 5;
 constexpr size_t kMaxVirtualCount = 1024;
+constexpr size_t kSwapSegmentSize = 4 << 20;
 class MemHandlerImpl : public MemHandler {
  public:
   MemHandlerImpl() {
@@ -75,6 +81,71 @@ class MemHandlerImpl : public MemHandler {
   std::map<void *, size_t> host_mem_size_;
 };
 
+// The memory handler of the CPU memory offload, the device memory is limited and the host memory is in a swap file.
+class SwapFileMemHandler : public MemHandler {
+ public:
+  explicit SwapFileMemHandler(size_t device_mem_size)
+      : device_mem_size_(device_mem_size), swap_file_(".", kSwapSegmentSize) {}
+  ~SwapFileMemHandler() override {
+    for (auto &item : device_mem_) {
+      free(item.first);
+    }
+  }
+
+  size_t GetAvailableMemSize() override { return device_mem_size_; }
+
+  void *MallocDevice(size_t mem_size) override {
+    if (used_device_mem_size_ + mem_size > device_mem_size_) {
+      return nullptr;
+    }
+    auto ptr = malloc(mem_size);
+    if (ptr != nullptr) {
+      device_mem_[ptr] = mem_size;
+      used_device_mem_size_ += mem_size;
+    }
+    return ptr;
+  }
+
+  void FreeDevice(void *ptr) override {
+    used_device_mem_size_ -= device_mem_[ptr];
+    (void)device_mem_.erase(ptr);
+    free(ptr);
+  }
+
+  void *MallocHost(size_t mem_size) override { return swap_file_.Malloc(mem_size); }
+
+  void FreeHost(void *ptr) override { (void)swap_file_.Free(ptr); }
+
+  void SwapIn(const void *host_ptr, void *device_ptr, size_t mem_size, void *stream) override {
+    (void)memcpy(device_ptr, host_ptr, mem_size);
+    ++swap_in_count_;
+  }
+
+  void SwapOut(const void *device_ptr, void *host_ptr, size_t mem_size, void *stream) override {
+    (void)memcpy(host_ptr, device_ptr, mem_size);
+    if (swap_file_.Contains(host_ptr)) {
+      swap_file_.Evict(host_ptr, mem_size);
+    }
+  }
+
+  void PrefetchHost(const void *host_ptr, size_t mem_size) override {
+    swap_file_.Prefetch(host_ptr, mem_size);
+    ++prefetch_count_;
+  }
+
+  size_t swap_in_count() const { return swap_in_count_; }
+  size_t prefetch_count() const { return prefetch_count_; }
+  size_t swap_file_size() const { return swap_file_.file_size(); }
+
+ private:
+  size_t device_mem_size_;
+  size_t used_device_mem_size_{0};
+  std::map<void *, size_t> device_mem_;
+  MmapSwapFile swap_file_;
+  size_t swap_in_count_{0};
+  size_t prefetch_count_{0};
+};
+
 class TestMemScheduler : public UT::Common {
  public:
   TestMemScheduler() {}
@@ -232,4 +303,144 @@ TEST_F(TestMemScheduler, test_manual_mem_scheduler) {
   // run
   Run(scheduler);
 }
-}  // namespace mindspore::device
\ No newline at end of file
+/// Feature: MmapSwapFile
+/// Description: Malloc and free the memory of swap file, evict the memory and prefetch it
+/// Expectation: The free memory is combined and reused, and the data is kept after the memory is evicted
+TEST_F(TestMemScheduler, test_mmap_swap_file) {
+  MmapSwapFile swap_file(".", kSwapSegmentSize);
+  auto ptr1 = swap_file.Malloc(100);
+  auto ptr2 = swap_file.Malloc(kSwapSegmentSize / 2);
+  auto ptr3 = swap_file.Malloc(100);
+  ASSERT_NE(ptr1, nullptr);
+  ASSERT_NE(ptr2, nullptr);
+  ASSERT_NE(ptr3, nullptr);
+  ASSERT_EQ(swap_file.file_size(), kSwapSegmentSize);
+  ASSERT_TRUE(swap_file.Contains(ptr2));
+
+  std::vector<uint8_t> data(kSwapSegmentSize / 2);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<uint8_t>(i * 7);
+  }
+  (void)memcpy(ptr2, data.data(), data.size());
+  swap_file.Evict(ptr2, data.size());
+  swap_file.Prefetch(ptr2, data.size());
+  ASSERT_EQ(memcmp(ptr2, data.data(), data.size()), 0);
+
+  // The block bigger than the segment is in a new segment.
+  auto ptr4 = swap_file.Malloc(kSwapSegmentSize + 1);
+  ASSERT_NE(ptr4, nullptr);
+  ASSERT_GT(swap_file.file_size(), 2 * kSwapSegmentSize);
+  ASSERT_TRUE(swap_file.Free(ptr4));
+  ASSERT_FALSE(swap_file.Free(ptr4));
+
+  // The smallest idle block which fits is taken.
+  ASSERT_TRUE(swap_file.Free(ptr1));
+  ASSERT_EQ(swap_file.Malloc(100), ptr1);
+
+  // The freed blocks are combined with the rest of segment.
+  ASSERT_TRUE(swap_file.Free(ptr1));
+  ASSERT_TRUE(swap_file.Free(ptr2));
+  ASSERT_TRUE(swap_file.Free(ptr3));
+  ASSERT_EQ(swap_file.used_size(), 0);
+  auto ptr5 = swap_file.Malloc(kSwapSegmentSize);
+  ASSERT_EQ(ptr5, ptr1);
+}
+
+/// Feature: MemScheduler offload to swap file
+/// Description: Run a training-like graph whose activations are saved for the backward steps, with the device memory
+/// limited to several memory caps, and the swapped out memory in a swap file
+/// Expectation: The data of activations is kept when they are swapped, and the step time of every memory cap is
+/// reported
+TEST_F(TestMemScheduler, test_mem_scheduler_swap_file) {
+  constexpr size_t kLayerNum = 8;
+  constexpr size_t kActivationSize = 1 << 20;
+  constexpr size_t kWeightSize = 1 << 16;
+  constexpr size_t kRunTimes = 5;
+  // The forward step i saves the activation i and the backward step 2 * kLayerNum - 1 - i reads it with the gradient
+  // of the next layer.
+  const size_t total_step = 2 * kLayerNum;
+  std::vector<uint8_t> weight_keys(kLayerNum);
+  std::vector<uint8_t> activation_keys(kLayerNum);
+  std::vector<uint8_t> grad_keys(kLayerNum);
+  std::vector<std::vector<uint8_t>> weights(kLayerNum, std::vector<uint8_t>(kWeightSize, 1));
+
+  // The CPU has no stream, the scheduler only needs a non-null one.
+  int host_stream = 0;
+  void *stream = &host_stream;
+  auto run_step = [&](const std::shared_ptr<MemScheduler> &scheduler, size_t step, bool record) {
+    const bool forward = step < kLayerNum;
+    const size_t layer = forward ? step : total_step - 1 - step;
+    if (!record) {
+      ASSERT_TRUE(scheduler->PreCompute(stream));
+    }
+    auto weight = scheduler->GetOrMalloc(&weight_keys[layer], kWeightSize, kMemPriorityHigh);
+    auto activation = scheduler->GetOrMalloc(&activation_keys[layer], kActivationSize);
+    void *grad = nullptr;
+    void *next_grad = nullptr;
+    if (!forward) {
+      if (layer + 1 < kLayerNum) {
+        next_grad = scheduler->GetOrMalloc(&grad_keys[layer + 1], kActivationSize);
+      }
+      grad = scheduler->GetOrMalloc(&grad_keys[layer], kActivationSize);
+    }
+    if (!record) {
+      ASSERT_NE(weight, nullptr);
+      ASSERT_NE(activation, nullptr);
+      auto activation_data = static_cast<uint8_t *>(activation);
+      if (forward) {
+        (void)memset(activation, static_cast<int>(layer + 1), kActivationSize);
+      } else {
+        ASSERT_NE(grad, nullptr);
+        ASSERT_EQ(activation_data[0], layer + 1);
+        ASSERT_EQ(activation_data[kActivationSize - 1], layer + 1);
+        if (next_grad != nullptr) {
+          ASSERT_EQ(static_cast<uint8_t *>(next_grad)[kActivationSize / 2], layer + 2);
+        }
+        (void)memcpy(grad, activation, kActivationSize);
+      }
+    }
+    ASSERT_TRUE(scheduler->PostCompute(stream));
+  };
+
+  const size_t total_mem_size = kLayerNum * (2 * kActivationSize + kWeightSize);
+  for (size_t mem_cap : {total_mem_size, total_mem_size / 2, total_mem_size / 4}) {
+    auto scheduler = std::make_shared<MemScheduler>();
+    auto mem_handler = std::make_shared<SwapFileMemHandler>(mem_cap);
+    scheduler->SetMemHandler(mem_handler);
+    scheduler->SetTotalStep(total_step);
+    for (size_t i = 0; i < kLayerNum; ++i) {
+      scheduler->Init(&weight_keys[i], weights[i].data(), kWeightSize, kMemPriorityHigh);
+    }
+    for (size_t step = 0; step < total_step; ++step) {
+      run_step(scheduler, step, true);
+    }
+    scheduler->set_need_record_event(false);
+    ASSERT_TRUE(scheduler->Optimize());
+
+    int64_t elapsed_us = 0;
+    for (size_t run = 0; run < kRunTimes; ++run) {
+      auto start = std::chrono::steady_clock::now();
+      scheduler->Reset();
+      scheduler->Update();
+      for (size_t i = 0; i < kLayerNum; ++i) {
+        scheduler->Init(&weight_keys[i], weights[i].data(), kWeightSize, kMemPriorityHigh);
+      }
+      for (size_t step = 0; step < total_step; ++step) {
+        run_step(scheduler, step, false);
+      }
+      auto end = std::chrono::steady_clock::now();
+      elapsed_us += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    }
+    // The activations are swapped out to the swap file and prefetched before they are swapped in.
+    if (mem_cap < total_mem_size / 2) {
+      ASSERT_GT(mem_handler->prefetch_count(), 0);
+      ASSERT_GT(mem_handler->swap_file_size(), 0);
+    }
+    MS_LOG(INFO) << "Memory cap " << (mem_cap >> 10) << "KB of " << (total_mem_size >> 10) << "KB: step time "
+                 << (elapsed_us / static_cast<int64_t>(kRunTimes)) << "us, swap in " << mem_handler->swap_in_count()
+                 << " times, prefetch " << mem_handler->prefetch_count() << " times, swap file size "
+                 << (mem_handler->swap_file_size() >> 10) << "KB.";
+    scheduler->ClearAllocatedMem();
+  }
+}
+}  // namespace mindspore::device
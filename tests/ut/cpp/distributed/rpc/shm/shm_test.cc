@@ -0,0 +1,315 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "distributed/rpc/shm/shm_ring_buffer.h"
+#include "distributed/rpc/shm/shm_channel.h"
+#include "distributed/rpc/tcp/tcp_server.h"
+#include "distributed/rpc/tcp/tcp_client.h"
+#include "common/common_test.h"
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace distributed {
+namespace rpc {
+class ShmTest : public UT::Common {
+ protected:
+  void SetUp() { (void)setenv(kEnvEnableShmTransport, "1", 1); }
+  void TearDown() { (void)unsetenv(kEnvEnableShmTransport); }
+};
+
+namespace {
+std::unique_ptr<MessageBase> CreateMessage(const std::string &server_url, size_t msg_size) {
+  std::unique_ptr<MessageBase> message = std::make_unique<MessageBase>();
+  message->name = "testname";
+  message->from = AID("client", "127.0.0.1:1234");
+  message->to = AID("server", server_url);
+  message->body = std::string(msg_size, 'A');
+  return message;
+}
+
+bool WaitForValue(const std::atomic<size_t> &value, size_t expected_value, int timeout_in_sec) {
+  auto start = std::chrono::steady_clock::now();
+  while (value.load() < expected_value) {
+    if (std::chrono::steady_clock::now() - start > std::chrono::seconds(timeout_in_sec)) {
+      return false;
+    }
+    std::this_thread::yield();
+  }
+  return true;
+}
+}  // namespace
+
+/// Feature: test the shared memory ring buffer.
+/// Description: write the data larger than the capacity of the ring buffer and read it by another thread.
+/// Expectation: the data is streamed through the ring buffer in order.
+TEST_F(ShmTest, RingBufferStreamData) {
+  const size_t capacity = 4096;
+  auto name = ShmChannel::GenerateName();
+  ShmRingBuffer writer;
+  ASSERT_TRUE(writer.Create(name, capacity));
+  ShmRingBuffer reader;
+  ASSERT_TRUE(reader.Open(name));
+  writer.Unlink();
+
+  const size_t data_size = capacity * 10 + 7;
+  std::vector<uint32_t> data(data_size);
+  for (size_t i = 0; i < data_size; ++i) {
+    data[i] = static_cast<uint32_t>(i);
+  }
+  std::thread write_thread(
+    [&writer, &data]() { EXPECT_TRUE(writer.Write(data.data(), data.size() * sizeof(uint32_t))); });
+  std::vector<uint32_t> recv_data(data_size);
+  ASSERT_TRUE(reader.Read(recv_data.data(), recv_data.size() * sizeof(uint32_t)));
+  write_thread.join();
+  EXPECT_EQ(data, recv_data);
+
+  // The reader is waken up after the ring buffer is closed.
+  writer.Close();
+  EXPECT_FALSE(reader.Read(recv_data.data(), 1));
+}
+
+/// Feature: test the shared memory ring buffer.
+/// Description: open the ring buffer in a child process which exits without closing it, then read from it.
+/// Expectation: the blocked reader finds out the exit of the peer and the ring buffer is closed.
+TEST_F(ShmTest, RingBufferPeerExit) {
+  auto name = ShmChannel::GenerateName();
+  ShmRingBuffer reader;
+  ASSERT_TRUE(reader.Create(name, 4096));
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    ShmRingBuffer writer;
+    _exit(writer.Open(name) ? 0 : 1);
+  }
+  int status = 0;
+  ASSERT_EQ(pid, waitpid(pid, &status, 0));
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(0, WEXITSTATUS(status));
+  reader.Unlink();
+
+  char data = 0;
+  EXPECT_FALSE(reader.Read(&data, 1));
+  EXPECT_TRUE(reader.IsClosed());
+}
+
+/// Feature: test the shared memory transport of the tcp client.
+/// Description: connect a client to the server on the same host, then send messages and receive the reply.
+/// Expectation: the messages go through the shared memory channel and the reply is received by the client.
+TEST_F(ShmTest, SendThroughSharedMemory) {
+  std::unique_ptr<TCPServer> server = std::make_unique<TCPServer>();
+  ASSERT_TRUE(server->Initialize("127.0.0.1:8091"));
+  std::atomic<size_t> recv_num(0);
+  server->SetMessageHandler([&recv_num](MessageBase *const message) -> MessageBase *const {
+    ++recv_num;
+    MessageBase *reply = nullptr;
+    if (message->name == "request") {
+      reply = new MessageBase();
+      reply->name = "reply";
+      reply->to = message->from;
+      reply->body = message->body + "_reply";
+    }
+    delete message;
+    return reply;
+  });
+
+  std::unique_ptr<TCPClient> client = std::make_unique<TCPClient>();
+  ASSERT_TRUE(client->Initialize());
+  auto server_url = "127.0.0.1:8091";
+  ASSERT_TRUE(client->Connect(server_url));
+  ASSERT_TRUE(client->IsShmConnected(server_url));
+
+  size_t msg_cnt = 10;
+  for (size_t i = 0; i < msg_cnt; ++i) {
+    client->SendAsync(CreateMessage(server_url, 100));
+  }
+  EXPECT_TRUE(WaitForValue(recv_num, msg_cnt, 5));
+
+  auto request = CreateMessage(server_url, 0);
+  request->name = "request";
+  request->body = "hello";
+  MessageBase *reply = client->ReceiveSync(std::move(request));
+  ASSERT_NE(nullptr, reply);
+  EXPECT_EQ("hello_reply", reply->body);
+  delete reply;
+
+  client->Disconnect(server_url);
+  client->Finalize();
+  server->Finalize();
+}
+
+/// Feature: test the shared memory transport of the tcp server.
+/// Description: send the messages from two clients through the shared memory channels at the same time.
+/// Expectation: the messages of both channels are handled in order by the receiving event loop of the server.
+TEST_F(ShmTest, HandleInReceivingEventLoop) {
+  std::unique_ptr<TCPServer> server = std::make_unique<TCPServer>();
+  ASSERT_TRUE(server->Initialize("127.0.0.1:8093"));
+  std::atomic<size_t> recv_num(0);
+  std::atomic<size_t> error_num(0);
+  std::mutex mutex;
+  std::set<std::thread::id> handler_threads;
+  std::vector<size_t> next_ids(2, 0);
+  server->SetMessageHandler([&](MessageBase *const message) -> MessageBase *const {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      (void)handler_threads.insert(std::this_thread::get_id());
+      auto client_index = std::stoul(message->name);
+      if (std::stoul(message->body) != next_ids[client_index]++) {
+        ++error_num;
+      }
+    }
+    ++recv_num;
+    delete message;
+    return NULL_MSG;
+  });
+
+  auto server_url = "127.0.0.1:8093";
+  size_t msg_cnt = 1000;
+  std::vector<std::unique_ptr<TCPClient>> clients;
+  for (size_t i = 0; i < next_ids.size(); ++i) {
+    clients.push_back(std::make_unique<TCPClient>());
+    ASSERT_TRUE(clients[i]->Initialize());
+    ASSERT_TRUE(clients[i]->Connect(server_url));
+    ASSERT_TRUE(clients[i]->IsShmConnected(server_url));
+  }
+  std::vector<std::thread> send_threads;
+  for (size_t i = 0; i < clients.size(); ++i) {
+    send_threads.emplace_back([&clients, server_url, msg_cnt, i]() {
+      for (size_t j = 0; j < msg_cnt; ++j) {
+        auto message = CreateMessage(server_url, 0);
+        message->name = std::to_string(i);
+        message->body = std::to_string(j);
+        clients[i]->SendAsync(std::move(message));
+      }
+    });
+  }
+  for (auto &send_thread : send_threads) {
+    send_thread.join();
+  }
+  EXPECT_TRUE(WaitForValue(recv_num, clients.size() * msg_cnt, 30));
+  EXPECT_EQ(0, error_num.load());
+  EXPECT_EQ(1, handler_threads.size());
+
+  for (auto &client : clients) {
+    client->Disconnect(server_url);
+    client->Finalize();
+  }
+  server->Finalize();
+}
+
+/// Feature: test the shared memory transport of the tcp server.
+/// Description: connect with the transport off, then ask the server to open the shared memory which is not a channel.
+/// Expectation: the client keeps using TCP and the server rejects the requests.
+TEST_F(ShmTest, RejectInvalidChannel) {
+  std::unique_ptr<TCPServer> server = std::make_unique<TCPServer>();
+  ASSERT_TRUE(server->Initialize("127.0.0.1:8094"));
+  server->SetMessageHandler([](MessageBase *const message) -> MessageBase *const {
+    delete message;
+    return NULL_MSG;
+  });
+
+  // The transport is opt in.
+  (void)unsetenv(kEnvEnableShmTransport);
+  auto server_url = "127.0.0.1:8094";
+  std::unique_ptr<TCPClient> client = std::make_unique<TCPClient>();
+  ASSERT_TRUE(client->Initialize());
+  ASSERT_TRUE(client->Connect(server_url));
+  EXPECT_FALSE(client->IsShmConnected(server_url));
+
+  (void)setenv(kEnvEnableShmTransport, "1", 1);
+  std::vector<std::string> names = {"/other_shm", "mindspore_rpc_0_0", std::string(kShmNamePrefix) + "../other_shm",
+                                    std::string(kShmNamePrefix) + "0_0"};
+  for (const auto &name : names) {
+    auto request = CreateMessage(server_url, 0);
+    request->name = kShmConnectMsgName;
+    request->body = name;
+    MessageBase *reply = client->ReceiveSync(std::move(request));
+    ASSERT_NE(nullptr, reply);
+    EXPECT_EQ(kShmConnectFailure, reply->body);
+    delete reply;
+  }
+  client->Disconnect(server_url);
+  client->Finalize();
+  server->Finalize();
+}
+
+/// Feature: test the performance of the shared memory transport.
+/// Description: send the messages from 4KB to 64MB to the server on the same host through TCP and shared memory.
+/// Expectation: all the messages are received through both transports.
+TEST_F(ShmTest, CompareWithTcpLoopback) {
+  std::unique_ptr<TCPServer> server = std::make_unique<TCPServer>();
+  ASSERT_TRUE(server->Initialize("127.0.0.1:8092"));
+  std::atomic<size_t> recv_num(0);
+  server->SetMessageHandler([&recv_num](MessageBase *const message) -> MessageBase *const {
+    ++recv_num;
+    delete message;
+    return NULL_MSG;
+  });
+  auto server_url = "127.0.0.1:8092";
+
+  auto run_transport = [server_url, &recv_num](bool use_shm, size_t msg_size, size_t msg_cnt) {
+    if (use_shm) {
+      (void)setenv(kEnvEnableShmTransport, "1", 1);
+    } else {
+      (void)unsetenv(kEnvEnableShmTransport);
+    }
+    std::unique_ptr<TCPClient> client = std::make_unique<TCPClient>();
+    EXPECT_TRUE(client->Initialize());
+    EXPECT_TRUE(client->Connect(server_url));
+    EXPECT_EQ(use_shm, client->IsShmConnected(server_url));
+
+    // Limit the in flight messages to bound the memory of the messages queued by TCP.
+    size_t window = std::max<size_t>(1, std::min<size_t>(SEND_MSG_BATCH_NUM, (64 << 20) / msg_size));
+    recv_num = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < msg_cnt; ++i) {
+      client->SendAsync(CreateMessage(server_url, msg_size));
+      EXPECT_TRUE(WaitForValue(recv_num, i + 1 > window ? i + 1 - window : 0, 60));
+    }
+    EXPECT_TRUE(WaitForValue(recv_num, msg_cnt, 60));
+    double cost = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    client->Disconnect(server_url);
+    client->Finalize();
+    return msg_size * msg_cnt / cost / (1 << 20);
+  };
+
+  const size_t total_size = 128 << 20;
+  const size_t max_msg_cnt = 10000;
+  for (size_t msg_size = 4 << 10; msg_size <= (64 << 20); msg_size *= 4) {
+    size_t msg_cnt = std::min(max_msg_cnt, total_size / msg_size);
+    auto tcp_bandwidth = run_transport(false, msg_size, msg_cnt);
+    auto shm_bandwidth = run_transport(true, msg_size, msg_cnt);
+    MS_LOG(INFO) << "Message size: " << msg_size << " bytes, tcp loopback: " << tcp_bandwidth
+                 << " MB/s, shared memory: " << shm_bandwidth << " MB/s";
+  }
+  server->Finalize();
+}
+}  // namespace rpc
+}  // namespace distributed
+}  // namespace mindspore
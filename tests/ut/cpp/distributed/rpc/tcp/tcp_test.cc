@@ -18,6 +18,7 @@
 #include <sys/types.h>
 #include <dirent.h>
 #include <atomic>
+#include <chrono>
 #include <string>
 #include <thread>
 #include <csignal>
@@ -28,6 +29,7 @@
 #include "distributed/rpc/tcp/tcp_client.h"
 #include "distributed/rpc/tcp/constants.h"
 #include "common/common_test.h"
+#include "utils/log_adapter.h"
 
 namespace mindspore {
 namespace distributed {
@@ -328,6 +330,78 @@ TEST_F(TCPTest, SendLargeMessages) {
   server->Finalize();
 }
 
+/// Feature: test the throughput and latency of small messages on the loopback.
+/// Description: send many small messages asynchronously, then send the messages one by one and wait for each of them.
+/// Expectation: the coalesced messages are received in order with the right content.
+TEST_F(TCPTest, SmallMessagesBenchmark) {
+  // Start the tcp server.
+  std::unique_ptr<TCPServer> server = std::make_unique<TCPServer>();
+  bool ret = server->Initialize();
+  ASSERT_TRUE(ret);
+
+  std::atomic<size_t> recv_num(0);
+  std::atomic<size_t> error_num(0);
+  server->SetMessageHandler([&recv_num, &error_num](MessageBase *const message) -> MessageBase *const {
+    if (message->body != std::to_string(recv_num.load())) {
+      ++error_num;
+    }
+    ++recv_num;
+    delete message;
+    return NULL_MSG;
+  });
+
+  // Start the tcp client.
+  auto client_url = "127.0.0.1:1234";
+  std::unique_ptr<TCPClient> client = std::make_unique<TCPClient>();
+  ret = client->Initialize();
+  ASSERT_TRUE(ret);
+
+  auto server_url = server->GetIP() + ":" + std::to_string(server->GetPort());
+  client->Connect(server_url);
+
+  auto wait_recv_num = [&recv_num](size_t expected_num) {
+    auto start = std::chrono::steady_clock::now();
+    while (recv_num.load() < expected_num) {
+      if (std::chrono::steady_clock::now() - start > std::chrono::seconds(30)) {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+    return true;
+  };
+
+  // The throughput of the messages sent asynchronously.
+  size_t msg_cnt = 10000;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < msg_cnt; ++i) {
+    auto message = CreateMessage(server_url, client_url, 0);
+    message->body = std::to_string(i);
+    client->SendAsync(std::move(message));
+  }
+  ASSERT_TRUE(wait_recv_num(msg_cnt));
+  double cost = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  MS_LOG(INFO) << "Send " << msg_cnt << " small messages, throughput: " << msg_cnt / cost << " msg/s";
+
+  // The latency of the messages sent one by one.
+  size_t round_cnt = 1000;
+  start = std::chrono::steady_clock::now();
+  for (size_t i = msg_cnt; i < msg_cnt + round_cnt; ++i) {
+    auto message = CreateMessage(server_url, client_url, 0);
+    message->body = std::to_string(i);
+    auto body_size = message->body.size();
+    EXPECT_EQ(body_size, client->SendSync(std::move(message)));
+    ASSERT_TRUE(wait_recv_num(i + 1));
+  }
+  cost = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+  MS_LOG(INFO) << "Send " << round_cnt << " small messages one by one, latency: " << cost / round_cnt << " us";
+  EXPECT_EQ(0, error_num.load());
+
+  // Destroy
+  client->Disconnect(server_url);
+  client->Finalize();
+  server->Finalize();
+}
+
 /// Feature: test creating many TCP connections.
 /// Description: create many servers and clients, then connect each client to a server.
 /// Expectation: all the servers and clients are created successfully.
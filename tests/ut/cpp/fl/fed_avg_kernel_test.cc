@@ -0,0 +1,348 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "common/common_test.h"
+#include "fl/compression/decode_executor.h"
+#include "fl/server/kernel/fed_avg_kernel.h"
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace fl {
+namespace server {
+namespace kernel {
+namespace {
+// Exposes the local merge of AllReduce, which runs without a server cluster.
+class LocalFedAvgKernel : public FedAvgKernel<float, size_t> {
+ public:
+  using FedAvgKernel<float, size_t>::MergeAccumulators;
+};
+
+struct Upload {
+  std::vector<float> weight;
+  size_t data_size;
+};
+
+std::vector<Upload> MakeUploads(size_t num_uploads, size_t weight_num) {
+  std::mt19937 rng(2022);
+  std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+  std::uniform_int_distribution<size_t> data_size(1, 100);
+  std::vector<Upload> uploads(num_uploads);
+  for (auto &upload : uploads) {
+    upload.weight.resize(weight_num);
+    std::generate(upload.weight.begin(), upload.weight.end(), [&]() { return value(rng); });
+    upload.data_size = data_size(rng);
+  }
+  return uploads;
+}
+}  // namespace
+
+class TestFedAvgKernel : public UT::Common {
+ public:
+  TestFedAvgKernel() = default;
+  virtual ~TestFedAvgKernel() = default;
+
+  void SetUp() override {
+    weight_.assign(kWeightNum, 0.0f);
+    data_size_ = 0;
+    kernel_ = std::make_shared<LocalFedAvgKernel>();
+    // Only the weight and the data size are used by the kernel, the uploads come with each Launch.
+    std::vector<AddressPtr> inputs = {std::make_shared<Address>(weight_.data(), weight_.size() * sizeof(float)),
+                                      std::make_shared<Address>(&data_size_, sizeof(size_t)), nullptr, nullptr};
+    kernel_->SetParameterAddress(inputs, {}, {});
+  }
+  void TearDown() override { kernel_ = nullptr; }
+
+ protected:
+  // Larger than the decode chunk, and not a multiple of the simd width.
+  static constexpr size_t kWeightNum = 3001;
+
+  bool LaunchUpload(Upload *upload) {
+    std::vector<AddressPtr> inputs = {
+      std::make_shared<Address>(weight_.data(), weight_.size() * sizeof(float)),
+      std::make_shared<Address>(&data_size_, sizeof(size_t)),
+      std::make_shared<Address>(upload->weight.data(), upload->weight.size() * sizeof(float)),
+      std::make_shared<Address>(&upload->data_size, sizeof(size_t))};
+    return kernel_->Launch(inputs, {}, {});
+  }
+
+  std::vector<float> weight_;
+  size_t data_size_{0};
+  std::shared_ptr<LocalFedAvgKernel> kernel_;
+};
+
+/// Feature: FedAvgKernel partial accumulators
+/// Description: Several threads launch the uploads concurrently, half of them as plain weights and half through an
+/// accumulate function, then the partial accumulators are merged
+/// Expectation: The merged weight and data size match the serial sum of the uploads
+TEST_F(TestFedAvgKernel, ConcurrentUploadsMatchSerialSum) {
+  const size_t num_uploads = 64;
+  const size_t num_threads = 8;
+  auto uploads = MakeUploads(num_uploads, kWeightNum);
+  std::vector<double> expected_weight(kWeightNum, 0.0);
+  size_t expected_data_size = 0;
+  for (const auto &upload : uploads) {
+    for (size_t i = 0; i < kWeightNum; ++i) {
+      expected_weight[i] += upload.weight[i];
+    }
+    expected_data_size += upload.data_size;
+  }
+
+  std::atomic<size_t> next_upload{0};
+  std::atomic<size_t> num_failed{0};
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&]() {
+      for (size_t u = next_upload++; u < num_uploads; u = next_upload++) {
+        bool ret;
+        if (u % 2 == 0) {
+          ret = LaunchUpload(&uploads[u]);
+        } else {
+          const auto &weight = uploads[u].weight;
+          auto accumulate = [&weight](float *accum, size_t accum_num) -> bool {
+            if (accum_num != weight.size()) {
+              return false;
+            }
+            for (size_t i = 0; i < accum_num; ++i) {
+              accum[i] += weight[i];
+            }
+            return true;
+          };
+          ret = kernel_->LaunchAccumulate(accumulate, uploads[u].data_size);
+        }
+        if (!ret) {
+          num_failed++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(num_failed.load(), static_cast<size_t>(0));
+
+  kernel_->MergeAccumulators(weight_.data(), weight_.size(), &data_size_);
+  EXPECT_EQ(data_size_, expected_data_size);
+  for (size_t i = 0; i < kWeightNum; ++i) {
+    ASSERT_NEAR(weight_[i], expected_weight[i], 1e-4 * (1.0 + std::fabs(expected_weight[i]))) << "index " << i;
+  }
+  MS_LOG(INFO) << "Merged " << num_uploads << " uploads of " << kWeightNum << " weights from " << num_threads
+               << " threads, total data size " << data_size_;
+
+  // The accumulation of the round is closed once merged, a late upload is dropped until the kernel is reset.
+  auto merged_weight = weight_;
+  EXPECT_TRUE(LaunchUpload(&uploads[0]));
+  kernel_->MergeAccumulators(weight_.data(), weight_.size(), &data_size_);
+  EXPECT_EQ(weight_, merged_weight);
+  EXPECT_EQ(data_size_, expected_data_size);
+
+  kernel_->Reset();
+  EXPECT_EQ(data_size_, static_cast<size_t>(0));
+  EXPECT_TRUE(LaunchUpload(&uploads[0]));
+  kernel_->MergeAccumulators(weight_.data(), weight_.size(), &data_size_);
+  EXPECT_EQ(weight_, uploads[0].weight);
+  EXPECT_EQ(data_size_, uploads[0].data_size);
+}
+
+/// Feature: FedAvgKernel partial accumulators
+/// Description: Launch an upload of the wrong size and an accumulate function that fails
+/// Expectation: Both are rejected and leave the merged result unchanged
+TEST_F(TestFedAvgKernel, RejectMismatchedUploads) {
+  auto uploads = MakeUploads(1, kWeightNum);
+  Upload truncated = uploads[0];
+  truncated.weight.pop_back();
+  EXPECT_FALSE(LaunchUpload(&truncated));
+  EXPECT_FALSE(kernel_->LaunchAccumulate([](float *, size_t) { return false; }, 10));
+  EXPECT_TRUE(LaunchUpload(&uploads[0]));
+
+  kernel_->MergeAccumulators(weight_.data(), weight_.size(), &data_size_);
+  EXPECT_EQ(weight_, uploads[0].weight);
+  EXPECT_EQ(data_size_, uploads[0].data_size);
+}
+}  // namespace kernel
+
+namespace {
+// Quantize the retained elements of the difference to 8 bits the way the clients do, in segments of their own range.
+struct CompressedUpload {
+  std::vector<std::vector<int8_t>> segments;
+  std::vector<std::pair<float, float>> ranges;
+  std::vector<float> expected;  // the decoded upload: data_size * last weight plus the dequantized difference
+};
+
+CompressedUpload CompressUpload(const std::vector<float> &last_weight, const std::vector<uint8_t> &mask,
+                                size_t data_size, size_t num_segments) {
+  std::mt19937 rng(49);
+  std::uniform_real_distribution<float> value(-0.5f, 0.5f);
+  std::vector<float> retained;
+  for (size_t i = 0; i < mask.size(); ++i) {
+    if (mask[i] == 1) {
+      retained.push_back(value(rng));
+    }
+  }
+  CompressedUpload upload;
+  std::vector<float> dequantized;
+  size_t segment_size = (retained.size() + num_segments - 1) / num_segments;
+  for (size_t begin = 0; begin < retained.size(); begin += segment_size) {
+    size_t end = std::min(begin + segment_size, retained.size());
+    float min_val = *std::min_element(retained.begin() + begin, retained.begin() + end);
+    float max_val = *std::max_element(retained.begin() + begin, retained.begin() + end);
+    float scale_val = (max_val - min_val) / 255.0f + 1e-10f;
+    std::vector<int8_t> segment;
+    for (size_t i = begin; i < end; ++i) {
+      auto q = static_cast<int>(std::round((retained[i] - min_val) / scale_val)) - 128;
+      segment.push_back(static_cast<int8_t>(std::max(-128, std::min(127, q))));
+      dequantized.push_back((static_cast<float>(segment.back()) + 128.0f) * scale_val + min_val);
+    }
+    upload.segments.push_back(segment);
+    upload.ranges.emplace_back(min_val, max_val);
+  }
+  size_t quant_index = 0;
+  for (size_t i = 0; i < mask.size(); ++i) {
+    float diff = mask[i] == 1 ? dequantized[quant_index++] : 0.0f;
+    upload.expected.push_back(static_cast<float>(data_size) * last_weight[i] + diff);
+  }
+  return upload;
+}
+
+std::vector<compression::CompressFeatureMap> FeatureMaps(const CompressedUpload &upload) {
+  std::vector<compression::CompressFeatureMap> maps;
+  for (size_t i = 0; i < upload.segments.size(); ++i) {
+    compression::CompressFeatureMap map;
+    map.compress_data = upload.segments[i].data();
+    map.compress_data_size = upload.segments[i].size();
+    map.min_val = upload.ranges[i].first;
+    map.max_val = upload.ranges[i].second;
+    maps.push_back(map);
+  }
+  return maps;
+}
+}  // namespace
+
+class TestDecodeExecutor : public UT::Common {
+ public:
+  TestDecodeExecutor() = default;
+  virtual ~TestDecodeExecutor() = default;
+
+  void SetUp() override {
+    std::mt19937 rng(2022);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    for (size_t i = 0; i < names_.size(); ++i) {
+      last_weights_.emplace_back(shapes_[i]);
+      std::generate(last_weights_[i].begin(), last_weights_[i].end(), [&]() { return value(rng); });
+      last_model_[names_[i]] =
+        std::make_shared<Address>(last_weights_[i].data(), last_weights_[i].size() * sizeof(float));
+    }
+    size_t param_num = shapes_[0] + shapes_[1];
+    mask_ = compression::DecodeExecutor::GetInstance().ConstructMaskArray(kSeed, kSparseRate, param_num);
+    std::vector<float> last_weight(last_weights_[0]);
+    last_weight.insert(last_weight.end(), last_weights_[1].begin(), last_weights_[1].end());
+    // Three segments, so the quantized stream of a weight spans two of them.
+    upload_ = CompressUpload(last_weight, mask_, kDataSize, 3);
+  }
+  void TearDown() override {}
+
+ protected:
+  static constexpr int kSeed = 7;
+  static constexpr float kSparseRate = 0.4f;
+  static constexpr size_t kDataSize = 5;
+
+  std::vector<std::string> names_ = {"conv.weight", "fc.weight"};
+  std::vector<size_t> shapes_ = {2500, 777};
+  std::vector<std::vector<float>> last_weights_;
+  std::map<std::string, AddressPtr> last_model_;
+  std::vector<uint8_t> mask_;
+  CompressedUpload upload_;
+};
+
+/// Feature: DecodeExecutor streaming decode
+/// Description: Decode a sparse 8 bits quantized difference upload chunk by chunk into zeroed accumulators, from
+/// several threads at once
+/// Expectation: Every accumulator holds the weight decoded by the reference, and it is added to what was there
+TEST_F(TestDecodeExecutor, DecodeMatchesReference) {
+  std::map<std::string, AccumulateFunc> funcs;
+  ASSERT_TRUE(compression::DecodeExecutor::GetInstance().DeQuantSparseDiff(
+    &funcs, last_model_, FeatureMaps(upload_), 8, kSparseRate, kSeed, names_, kDataSize));
+  ASSERT_EQ(funcs.size(), names_.size());
+
+  const size_t num_threads = 4;
+  std::vector<std::vector<std::vector<float>>> accums(num_threads);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i < names_.size(); ++i) {
+        accums[t].emplace_back(shapes_[i], static_cast<float>(t));
+        (void)funcs.at(names_[i])(accums[t][i].data(), shapes_[i]);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (size_t t = 0; t < num_threads; ++t) {
+    size_t offset = 0;
+    for (size_t i = 0; i < names_.size(); ++i) {
+      for (size_t j = 0; j < shapes_[i]; ++j) {
+        float expected = upload_.expected[offset + j] + static_cast<float>(t);
+        ASSERT_NEAR(accums[t][i][j], expected, 1e-4f * (1.0f + std::fabs(expected)))
+          << names_[i] << " index " << j << " thread " << t;
+      }
+      offset += shapes_[i];
+    }
+  }
+}
+
+/// Feature: DecodeExecutor streaming decode
+/// Description: Decode uploads that are truncated, miss a weight or don't match the accumulator
+/// Expectation: They are rejected and a rejected accumulate function leaves the accumulator unmodified
+TEST_F(TestDecodeExecutor, RejectInvalidUploads) {
+  auto &decoder = compression::DecodeExecutor::GetInstance();
+  std::map<std::string, AccumulateFunc> funcs;
+
+  auto truncated = FeatureMaps(upload_);
+  truncated.back().compress_data_size--;
+  EXPECT_FALSE(decoder.DeQuantSparseDiff(&funcs, last_model_, truncated, 8, kSparseRate, kSeed, names_, kDataSize));
+
+  auto dropped = FeatureMaps(upload_);
+  dropped.pop_back();
+  EXPECT_FALSE(decoder.DeQuantSparseDiff(&funcs, last_model_, dropped, 8, kSparseRate, kSeed, names_, kDataSize));
+
+  auto null_data = FeatureMaps(upload_);
+  null_data[0].compress_data = nullptr;
+  EXPECT_FALSE(decoder.DeQuantSparseDiff(&funcs, last_model_, null_data, 8, kSparseRate, kSeed, names_, kDataSize));
+
+  std::vector<std::string> unknown_names = {names_[0], "unknown.weight"};
+  EXPECT_FALSE(decoder.DeQuantSparseDiff(&funcs, last_model_, FeatureMaps(upload_), 8, kSparseRate, kSeed,
+                                         unknown_names, kDataSize));
+  EXPECT_TRUE(funcs.empty());
+
+  ASSERT_TRUE(decoder.DeQuantSparseDiff(&funcs, last_model_, FeatureMaps(upload_), 8, kSparseRate, kSeed, names_,
+                                        kDataSize));
+  std::vector<float> accum(shapes_[0] + 1, 1.0f);
+  EXPECT_FALSE(funcs[names_[0]](accum.data(), accum.size()));
+  EXPECT_FALSE(funcs[names_[0]](nullptr, shapes_[0]));
+  EXPECT_TRUE(std::all_of(accum.begin(), accum.end(), [](float v) { return v == 1.0f; }));
+}
+}  // namespace server
+}  // namespace fl
+}  // namespace mindspore
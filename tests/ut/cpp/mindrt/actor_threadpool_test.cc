@@ -0,0 +1,277 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "common/common_test.h"
+#include "actor/actor.h"
+#include "async/async.h"
+#include "thread/actor_threadpool.h"
+#include "actor/actormgr.h"
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace {
+constexpr size_t kActorThreadNum = 4;
+constexpr auto kTimeout = std::chrono::seconds(60);
+
+// Counts the messages a graph of actors still has to deliver, and wakes up the test when it is done
+class Countdown {
+ public:
+  explicit Countdown(int64_t count) : count_(count) {}
+
+  void Done() {
+    if (count_.fetch_sub(1) == 1) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      cv_.notify_all();
+    }
+  }
+
+  // return false if the messages are not all delivered in time
+  bool Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cv_.wait_for(lock, kTimeout, [this]() { return count_.load() == 0; });
+  }
+
+ private:
+  std::atomic<int64_t> count_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+// An actor running a tiny kernel and passing the message on to its successors
+class TinyKernelActor : public ActorBase {
+ public:
+  TinyKernelActor(const std::string &name, ActorThreadPool *pool) : ActorBase(name, pool) {}
+  ~TinyKernelActor() override = default;
+
+  void Connect(const AID &successor) { successors_.push_back(successor); }
+
+  void set_countdown(Countdown *countdown) { countdown_ = countdown; }
+
+  int64_t num_runs() const { return num_runs_.load(); }
+
+  // hops is the number of actors the message still passes on a chain
+  void Run(int64_t hops) {
+    num_runs_++;
+    // the tiny kernel
+    for (int i = 0; i < kKernelSize; ++i) {
+      value_ = value_ * 31 + i;
+    }
+    if (successors_.empty() || hops == 0) {
+      countdown_->Done();
+      return;
+    }
+    for (const auto &successor : successors_) {
+      Async(successor, &TinyKernelActor::Run, hops - 1);
+    }
+  }
+
+ private:
+  static constexpr int kKernelSize = 64;
+  std::vector<AID> successors_;
+  Countdown *countdown_{nullptr};
+  int64_t value_{0};
+  std::atomic<int64_t> num_runs_{0};
+};
+
+// An actor which makes its successor ready and then blocks until the successor has run
+class WaitingActor : public ActorBase {
+ public:
+  WaitingActor(const std::string &name, ActorThreadPool *pool) : ActorBase(name, pool) {}
+  ~WaitingActor() override = default;
+
+  void set_successor(const AID &successor) { successor_ = successor; }
+
+  void Run() {
+    Async(successor_, &WaitingActor::Signal);
+    std::unique_lock<std::mutex> lock(mutex_);
+    successor_ran_ = cv_.wait_for(lock, kTimeout, [this]() { return signaled_; });
+    countdown_->Done();
+  }
+
+  void Signal() {
+    auto waiter = waiter_;
+    std::lock_guard<std::mutex> lock(waiter->mutex_);
+    waiter->signaled_ = true;
+    waiter->cv_.notify_all();
+  }
+
+  void set_waiter(WaitingActor *waiter) { waiter_ = waiter; }
+  void set_countdown(Countdown *countdown) { countdown_ = countdown; }
+  bool successor_ran() const { return successor_ran_; }
+
+ private:
+  AID successor_;
+  WaitingActor *waiter_{nullptr};
+  Countdown *countdown_{nullptr};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool signaled_{false};
+  bool successor_ran_{false};
+};
+
+// The actors of a benchmark graph, terminated when the graph is gone
+class ActorGraph {
+ public:
+  ActorGraph(ActorThreadPool *pool, const std::string &prefix, size_t num_actors) {
+    for (size_t i = 0; i < num_actors; ++i) {
+      auto actor = std::make_shared<TinyKernelActor>(prefix + std::to_string(i), pool);
+      (void)ActorMgr::GetActorMgrRef()->Spawn(actor);
+      actors_.push_back(actor);
+    }
+  }
+
+  ~ActorGraph() {
+    for (auto &actor : actors_) {
+      ActorMgr::GetActorMgrRef()->Terminate(actor->GetAID());
+    }
+  }
+
+  std::shared_ptr<TinyKernelActor> &operator[](size_t i) { return actors_[i]; }
+  size_t size() const { return actors_.size(); }
+
+ private:
+  std::vector<std::shared_ptr<TinyKernelActor>> actors_;
+};
+
+// Run a ring of actors with a few messages going around it, return the time in microseconds
+int64_t RunDeepGraph(ActorThreadPool *pool, size_t num_actors, int64_t num_messages, int64_t hops) {
+  ActorGraph graph(pool, "deep_" + std::to_string(pool->work_stealing()) + "_", num_actors);
+  Countdown countdown(num_messages);
+  for (size_t i = 0; i < num_actors; ++i) {
+    graph[i]->Connect(graph[(i + 1) % num_actors]->GetAID());
+    graph[i]->set_countdown(&countdown);
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < num_messages; ++i) {
+    Async(graph[i % num_actors]->GetAID(), &TinyKernelActor::Run, hops);
+  }
+  if (!countdown.Wait()) {
+    return -1;
+  }
+  auto end = std::chrono::steady_clock::now();
+  int64_t num_runs = 0;
+  for (size_t i = 0; i < num_actors; ++i) {
+    num_runs += graph[i]->num_runs();
+  }
+  EXPECT_EQ(num_runs, num_messages * (hops + 1));
+  return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+// Run rounds of a source actor fanning out to many actors, return the time in microseconds
+int64_t RunWideGraph(ActorThreadPool *pool, size_t width, int64_t num_rounds) {
+  ActorGraph graph(pool, "wide_" + std::to_string(pool->work_stealing()) + "_", width + 1);
+  Countdown countdown(num_rounds * static_cast<int64_t>(width));
+  graph[0]->set_countdown(&countdown);
+  for (size_t i = 1; i <= width; ++i) {
+    graph[0]->Connect(graph[i]->GetAID());
+    graph[i]->set_countdown(&countdown);
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < num_rounds; ++i) {
+    Async(graph[0]->GetAID(), &TinyKernelActor::Run, int64_t(1));
+  }
+  if (!countdown.Wait()) {
+    return -1;
+  }
+  auto end = std::chrono::steady_clock::now();
+  // every actor runs once per round
+  for (size_t i = 0; i <= width; ++i) {
+    EXPECT_EQ(graph[i]->num_runs(), num_rounds);
+  }
+  return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+}  // namespace
+
+class TestActorThreadPool : public UT::Common {
+ public:
+  TestActorThreadPool() = default;
+  void SetUp() override {
+    pool_ = ActorThreadPool::CreateThreadPool(kActorThreadNum);
+    ASSERT_NE(pool_, nullptr);
+  }
+  void TearDown() override {
+    delete pool_;
+    pool_ = nullptr;
+  }
+
+ protected:
+  ActorThreadPool *pool_{nullptr};
+};
+
+/// Feature: ActorThreadPool work stealing
+/// Description: Pass messages along a ring of actors, each actor makes its successor ready
+/// Expectation: Every message goes all the way, with and without work stealing
+TEST_F(TestActorThreadPool, TestDeepGraph) {
+  const size_t num_actors = 64;
+  const int64_t num_messages = 8;
+  const int64_t hops = 20000;
+  for (bool work_stealing : {false, true}) {
+    pool_->SetWorkStealing(work_stealing);
+    auto elapsed_us = RunDeepGraph(pool_, num_actors, num_messages, hops);
+    ASSERT_GE(elapsed_us, 0) << "The deep graph made no progress, work stealing " << work_stealing;
+    auto num_runs = num_messages * (hops + 1);
+    MS_LOG(INFO) << "Deep graph, work stealing " << work_stealing << ": " << num_runs << " actor runs in "
+                 << elapsed_us << "us, " << (elapsed_us * 1000 / hops) << "ns dispatch latency per hop, "
+                 << (num_runs * 1000000 / (elapsed_us + 1)) << " runs/s.";
+  }
+}
+
+/// Feature: ActorThreadPool work stealing
+/// Description: A source actor makes many actors ready at once, which idle workers steal
+/// Expectation: Every actor runs once per round, with and without work stealing
+TEST_F(TestActorThreadPool, TestWideGraph) {
+  const size_t width = 1000;
+  const int64_t num_rounds = 200;
+  for (bool work_stealing : {false, true}) {
+    pool_->SetWorkStealing(work_stealing);
+    auto elapsed_us = RunWideGraph(pool_, width, num_rounds);
+    ASSERT_GE(elapsed_us, 0) << "The wide graph made no progress, work stealing " << work_stealing;
+    auto num_runs = num_rounds * static_cast<int64_t>(width + 1);
+    MS_LOG(INFO) << "Wide graph, work stealing " << work_stealing << ": " << num_runs << " actor runs in "
+                 << elapsed_us << "us, " << (num_runs * 1000000 / (elapsed_us + 1)) << " runs/s.";
+  }
+}
+
+/// Feature: ActorThreadPool work stealing
+/// Description: An actor makes its successor ready and blocks its worker until the successor has run
+/// Expectation: An idle worker steals the successor of the busy worker, so the waiting actor is released
+TEST_F(TestActorThreadPool, TestStealSuccessorOfBusyWorker) {
+  if (pool_->actor_thread_num() < 2) {
+    MS_LOG(WARNING) << "The successor can only be stolen with more than one actor thread, skip the test.";
+    return;
+  }
+  pool_->SetWorkStealing(true);
+  auto waiter = std::make_shared<WaitingActor>("waiting_actor", pool_);
+  auto successor = std::make_shared<WaitingActor>("waiting_successor", pool_);
+  waiter->set_successor(successor->GetAID());
+  successor->set_waiter(waiter.get());
+  (void)ActorMgr::GetActorMgrRef()->Spawn(waiter);
+  (void)ActorMgr::GetActorMgrRef()->Spawn(successor);
+  Countdown countdown(1);
+  waiter->set_countdown(&countdown);
+  Async(waiter->GetAID(), &WaitingActor::Run);
+  EXPECT_TRUE(countdown.Wait());
+  EXPECT_TRUE(waiter->successor_ran());
+  ActorMgr::GetActorMgrRef()->Terminate(waiter->GetAID());
+  ActorMgr::GetActorMgrRef()->Terminate(successor->GetAID());
+}
+}  // namespace mindspore
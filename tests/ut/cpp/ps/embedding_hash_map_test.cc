@@ -0,0 +1,174 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include "common/common_test.h"
+#include "ps/ps_cache/embedding_hash_map.h"
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace ps {
+class TestEmbeddingHashMap : public UT::Common {
+ public:
+  TestEmbeddingHashMap() = default;
+  virtual ~TestEmbeddingHashMap() = default;
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+namespace {
+// Generate the ids whose frequencies follow the zipfian distribution, the id of rank k is k * 7919 % id_num.
+std::vector<int> GenerateZipfianIds(size_t id_num, double exponent, size_t count, uint32_t seed) {
+  std::vector<double> cdf(id_num);
+  double sum = 0;
+  for (size_t i = 0; i < id_num; ++i) {
+    sum += 1.0 / std::pow(static_cast<double>(i + 1), exponent);
+    cdf[i] = sum;
+  }
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> dist(0, sum);
+  std::vector<int> ids(count);
+  for (size_t i = 0; i < count; ++i) {
+    auto rank = static_cast<size_t>(std::upper_bound(cdf.begin(), cdf.end(), dist(gen)) - cdf.begin());
+    rank = std::min(rank, id_num - 1);
+    ids[i] = static_cast<int>((rank * 7919) % id_num);
+  }
+  return ids;
+}
+
+// Run the steps of ids through the hash map like the ps cache, the graph runs one step behind the data. Return the hit
+// rate of the unique ids of every step.
+double RunSteps(EmbeddingHashMap *hash_map, const std::vector<int> &ids, size_t batch_size) {
+  std::vector<int> swap_out_index(batch_size);
+  std::vector<int> swap_out_ids(batch_size);
+  size_t hit_count = 0;
+  size_t unique_count = 0;
+  for (size_t begin = 0, step = 1; begin + batch_size <= ids.size(); begin += batch_size, ++step) {
+    hash_map->Reset();
+    size_t swap_out_size = 0;
+    bool need_wait_graph = false;
+    for (size_t i = begin; i < begin + batch_size; ++i) {
+      int index = INVALID_INDEX_VALUE;
+      if (hash_map->GetHashIndex(ids[i], &index)) {
+        if (hash_map->hash_step(index) != step) {
+          ++hit_count;
+          ++unique_count;
+          hash_map->set_hash_step(index, step);
+        }
+        continue;
+      }
+      ++unique_count;
+      index = hash_map->ParseData(ids[i], swap_out_index.data(), swap_out_ids.data(), step, step - 1, &swap_out_size,
+                                  &need_wait_graph);
+      if (index == INVALID_INDEX_VALUE) {
+        return -1;
+      }
+    }
+  }
+  return static_cast<double>(hit_count) / unique_count;
+}
+}  // namespace
+
+/// Feature: IdIndexTable.
+/// Description: Insert, find and erase random ids, which makes the table grow and reuse the deleted slots.
+/// Expectation: The table is consistent with std::unordered_map.
+TEST_F(TestEmbeddingHashMap, test_id_index_table) {
+  IdIndexTable table(8);
+  std::unordered_map<int, int> expect;
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<int> id_dist(-5000, 5000);
+  for (int i = 0; i < 100000; ++i) {
+    auto id = id_dist(gen);
+    if (expect.count(id) == 0) {
+      table.Insert(id, i);
+      expect[id] = i;
+    } else if (i % 2 == 0) {
+      ASSERT_TRUE(table.Erase(id));
+      (void)expect.erase(id);
+    }
+  }
+  ASSERT_EQ(table.size(), expect.size());
+  for (int id = -5000; id <= 5000; ++id) {
+    int index = INVALID_INDEX_VALUE;
+    auto iter = expect.find(id);
+    ASSERT_EQ(table.Find(id, &index), iter != expect.end());
+    if (iter != expect.end()) {
+      ASSERT_EQ(index, iter->second);
+    }
+  }
+  size_t visited = 0;
+  table.ForEach([&expect, &visited](int id, int index) {
+    ASSERT_EQ(expect[id], index);
+    ++visited;
+  });
+  ASSERT_EQ(visited, expect.size());
+}
+
+/// Feature: EmbeddingHashMap.
+/// Description: Run the steps of zipfian ids through a hash map which caches 10% of ids, and look up the ids of a step
+/// by the threads of shards.
+/// Expectation: The frequent ids stay in the cache, the hit rate and the lookup throughput are logged.
+TEST_F(TestEmbeddingHashMap, test_zipfian_ids) {
+  const size_t id_num = 100000;
+  const size_t batch_size = 2000;
+  const size_t step_num = 200;
+  auto ids = GenerateZipfianIds(id_num, 1.0, batch_size * step_num, 0);
+  EmbeddingHashMap hash_map(0, id_num / 10);
+  auto start_time = std::chrono::steady_clock::now();
+  auto hit_rate = RunSteps(&hash_map, ids, batch_size);
+  auto cost = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  MS_LOG(INFO) << "Zipfian ids hit rate: " << hit_rate << ", parse " << ids.size() / cost << " ids/s";
+  // The hit rate is about 49% if the frequency of ids is ignored by the eviction.
+  ASSERT_GT(hit_rate, 0.5);
+  ASSERT_EQ(hash_map.hash_id_count() + 2, hash_map.hash_capacity());
+
+  // Look up the ids of the last step by the threads of shards.
+  const size_t thread_num = 4;
+  std::vector<size_t> found_count(thread_num, 0);
+  const int *batch_ids = ids.data() + ids.size() - batch_size;
+  start_time = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (size_t thread_id = 0; thread_id < thread_num; ++thread_id) {
+    threads.emplace_back([&hash_map, &found_count, batch_ids, batch_size, thread_id, thread_num]() {
+      for (size_t i = 0; i < batch_size; ++i) {
+        int index = INVALID_INDEX_VALUE;
+        if (EmbeddingHashMap::GetShard(batch_ids[i]) % thread_num == thread_id &&
+            hash_map.GetHashIndex(batch_ids[i], &index)) {
+          ++found_count[thread_id];
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  cost = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  size_t found = 0;
+  for (auto count : found_count) {
+    found += count;
+  }
+  MS_LOG(INFO) << "Parallel lookup " << batch_size / cost << " ids/s";
+  // All ids of the last step are inserted.
+  ASSERT_EQ(found, batch_size);
+}
+}  // namespace ps
+}  // namespace mindspore
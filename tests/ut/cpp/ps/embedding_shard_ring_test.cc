@@ -0,0 +1,308 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <vector>
+#include "common/common_test.h"
+#include "ps/embedding_shard_ring.h"
+#include "ps/embedding_shard_table.h"
+
+namespace mindspore {
+namespace ps {
+class TestEmbeddingShardRing : public UT::Common {
+ public:
+  TestEmbeddingShardRing() = default;
+  virtual ~TestEmbeddingShardRing() = default;
+
+  void SetUp() override {}
+  void TearDown() override {}
+
+  // The local rows of the servers, the value of a row is its id, or the id plus the step it was last updated at.
+  struct Server {
+    std::shared_ptr<EmbeddingShardTable> table;
+    std::vector<float> rows;
+  };
+
+  static std::vector<Server> MakeServers(size_t row_count, size_t server_num) {
+    std::vector<Server> servers(server_num);
+    for (size_t rank = 0; rank < server_num; ++rank) {
+      auto table = std::make_shared<EmbeddingShardTable>(row_count, server_num, rank);
+      servers[rank].table = table;
+      servers[rank].rows.resize(table->slot_num() * table->bucket_rows(), -1);
+      for (const auto &bucket_slot : table->OwnedBuckets()) {
+        for (size_t i = 0; i < table->BucketRowNum(bucket_slot.first); ++i) {
+          servers[rank].rows[bucket_slot.second * table->bucket_rows() + i] =
+            static_cast<float>(bucket_slot.first * table->bucket_rows() + i);
+        }
+      }
+    }
+    return servers;
+  }
+
+  static void CopyBucket(std::vector<Server> *servers, uint32_t src, const EmbeddingBucketMove &move) {
+    auto &source = (*servers)[src];
+    auto &dest = (*servers)[move.dest];
+    size_t bucket_rows = source.table->bucket_rows();
+    int64_t src_slot = source.table->SlotOf(move.bucket);
+    int64_t dest_slot = dest.table->SlotOf(move.bucket);
+    ASSERT_GE(src_slot, 0);
+    ASSERT_GE(dest_slot, 0);
+    for (size_t i = 0; i < bucket_rows; ++i) {
+      dest.rows[dest_slot * bucket_rows + i] = source.rows[src_slot * bucket_rows + i];
+    }
+  }
+
+  // Update the ids by the placement of the workers, the updated rows of the moved buckets are marked dirty.
+  static void Update(std::vector<Server> *servers, const EmbeddingShardMap &shard_map, const std::vector<int> &ids,
+                     float step) {
+    for (int id : ids) {
+      auto &server = (*servers)[shard_map.OwnerOf(id)];
+      int row = -1;
+      ASSERT_TRUE(server.table->ToLocalRows(&id, 1, true, &row));
+      ASSERT_GE(row, 0);
+      server.rows[row] = static_cast<float>(id) + step;
+      server.table->MarkDirtyRows(&row, 1);
+    }
+  }
+
+  // Migrate to the servers while the ids are updated every step, the workers switch two steps after the commit.
+  static void Migrate(std::vector<Server> *servers, const std::vector<uint32_t> &server_ranks, uint64_t version,
+                      const std::vector<int> &ids) {
+    size_t row_count = (*servers)[0].table->row_count();
+    uint64_t old_version;
+    std::vector<uint32_t> old_ranks;
+    uint64_t old_switch_step;
+    (*servers)[0].table->GetPlacement(&old_version, &old_ranks, &old_switch_step);
+    EmbeddingShardMap old_map(row_count, old_ranks, old_version);
+    EmbeddingShardMap new_map(row_count, server_ranks, version);
+    for (auto &server : *servers) {
+      EXPECT_NE(server.table->Prepare(server_ranks, version), EmbeddingMigrationState::kFailed);
+    }
+    uint64_t step = 0;
+    bool converged = false;
+    while (!converged) {
+      Update(servers, old_map, ids, static_cast<float>(++step));
+      converged = true;
+      for (uint32_t rank = 0; rank < servers->size(); ++rank) {
+        for (const auto &move : (*servers)[rank].table->NextCopyBuckets(kMaxEmbeddingBucketNum)) {
+          CopyBucket(servers, rank, move);
+        }
+        converged = converged && (*servers)[rank].table->state() == EmbeddingMigrationState::kConverged;
+      }
+      ASSERT_LE(step, kMaxEmbeddingPreCopyRounds + 2);
+    }
+    // The rows updated after the last copy are handed off at the switch.
+    Update(servers, old_map, ids, static_cast<float>(++step));
+    uint64_t switch_step = step + 2;
+    for (auto &server : *servers) {
+      EXPECT_EQ(server.table->Precommit(version, step, step), EmbeddingMigrationState::kFailed);
+      EXPECT_EQ(server.table->Commit(version, switch_step), EmbeddingMigrationState::kFailed);
+      EXPECT_EQ(server.table->Precommit(version, switch_step, step), EmbeddingMigrationState::kPrecommitted);
+      // The update of this step waits for the decision, otherwise the commit would come too late for the switch.
+      EXPECT_TRUE(server.table->WaitingDecision(step));
+      EXPECT_FALSE(server.table->WaitingDecision(step - 1));
+      EXPECT_EQ(server.table->Commit(version, switch_step), EmbeddingMigrationState::kCommitted);
+      EXPECT_FALSE(server.table->WaitingDecision(step));
+      EXPECT_FALSE(server.table->Abort(version));
+    }
+    Update(servers, old_map, ids, static_cast<float>(++step));
+    ++step;
+    for (uint32_t rank = 0; rank < servers->size(); ++rank) {
+      EXPECT_TRUE((*servers)[rank].table->HandoffBuckets(step - 1).empty());
+      std::vector<size_t> moved;
+      for (const auto &move : (*servers)[rank].table->HandoffBuckets(step)) {
+        if (move.dirty) {
+          CopyBucket(servers, rank, move);
+        }
+        moved.push_back(move.bucket);
+        (*servers)[move.dest].table->FinishIncoming({move.bucket});
+      }
+      (*servers)[rank].table->FinishOutgoing(moved);
+    }
+    for (uint32_t rank = 0; rank < servers->size(); ++rank) {
+      auto &server = (*servers)[rank];
+      EXPECT_EQ(server.table->state(), EmbeddingMigrationState::kIdle);
+      EXPECT_FALSE(server.table->WaitingIncoming(step));
+      uint64_t placement_version;
+      std::vector<uint32_t> placement_ranks;
+      uint64_t placement_step;
+      server.table->GetPlacement(&placement_version, &placement_ranks, &placement_step);
+      EXPECT_EQ(placement_version, version);
+      EXPECT_EQ(placement_ranks, new_map.server_ranks());
+      EXPECT_EQ(placement_step, switch_step);
+    }
+    // Each row is held by its new owner with the value of the last update.
+    std::vector<float> expect(row_count);
+    for (size_t id = 0; id < row_count; ++id) {
+      expect[id] = static_cast<float>(id);
+    }
+    for (int id : ids) {
+      expect[id] += static_cast<float>(step - 1);
+    }
+    for (size_t id = 0; id < row_count; ++id) {
+      auto &server = (*servers)[new_map.OwnerOf(id)];
+      int local_id = static_cast<int>(id);
+      int row = -1;
+      EXPECT_TRUE(server.table->ToLocalRows(&local_id, 1, false, &row));
+      ASSERT_GE(row, 0);
+      EXPECT_EQ(server.rows[row], expect[id]);
+    }
+  }
+};
+
+/// Feature: Consistent hash sharded embedding.
+/// Description: place the buckets of a table on 4 servers.
+/// Expectation: each server owns about a quarter of the buckets and the workers and servers build the same placement.
+TEST_F(TestEmbeddingShardRing, BalancedPlacement) {
+  EmbeddingShardMap shard_map(1000000, {3, 1, 0, 2}, 1);
+  EXPECT_EQ(shard_map.bucket_rows(), 245);
+  EXPECT_EQ(shard_map.bucket_num(), 4082);
+  EXPECT_EQ(shard_map.BucketRowNum(4081), 155);
+  EXPECT_EQ(shard_map.server_ranks(), std::vector<uint32_t>({0, 1, 2, 3}));
+  size_t even_share = shard_map.bucket_num() / 4;
+  for (uint32_t rank = 0; rank < 4; ++rank) {
+    size_t owned = shard_map.OwnedBuckets(rank).size();
+    EXPECT_GT(owned, even_share * 3 / 4);
+    EXPECT_LT(owned, even_share * 5 / 4);
+  }
+  EmbeddingShardMap same_map(1000000, {0, 1, 2, 3}, 2);
+  for (size_t id = 0; id < 1000000; id += 997) {
+    EXPECT_EQ(shard_map.OwnerOf(id), same_map.OwnerOf(id));
+  }
+  EXPECT_TRUE(shard_map.SamePlacement({2, 0, 1, 3}));
+  EXPECT_FALSE(shard_map.SamePlacement({0, 1, 2}));
+}
+
+/// Feature: Consistent hash sharded embedding.
+/// Description: add a server to the placement and remove it again.
+/// Expectation: only the buckets taken by the new server are moved, about a quarter of them.
+TEST_F(TestEmbeddingShardRing, MinimalMovement) {
+  EmbeddingShardMap three_servers(100000, {0, 1, 2}, 0);
+  EmbeddingShardMap four_servers(100000, {0, 1, 2, 3}, 1);
+  size_t moved = 0;
+  for (size_t bucket = 0; bucket < three_servers.bucket_num(); ++bucket) {
+    if (three_servers.BucketOwner(bucket) != four_servers.BucketOwner(bucket)) {
+      EXPECT_EQ(four_servers.BucketOwner(bucket), 3);
+      ++moved;
+    }
+  }
+  EXPECT_GT(moved, three_servers.bucket_num() / 5);
+  EXPECT_LT(moved, three_servers.bucket_num() * 3 / 10);
+}
+
+/// Feature: Consistent hash sharded embedding.
+/// Description: the local rows of the owned buckets and the capacity of the local table.
+/// Expectation: the owned buckets take the first slots in order, the other ids are not found.
+TEST_F(TestEmbeddingShardRing, LocalRows) {
+  size_t row_count = 10000;
+  EmbeddingShardTable table(row_count, 3, 1);
+  EXPECT_EQ(table.bucket_rows(), 3);
+  EXPECT_GE(table.slot_num(), (2 * 3334 + 2) / 3);
+  EXPECT_EQ(EmbeddingShardMap::LocalRowCapacity(row_count, 3), table.slot_num() * table.bucket_rows());
+  EmbeddingShardMap shard_map(row_count, {0, 1, 2}, 0);
+  auto owned = table.OwnedBuckets();
+  EXPECT_EQ(owned.size(), shard_map.OwnedBuckets(1).size());
+  for (size_t i = 0; i < owned.size(); ++i) {
+    EXPECT_EQ(owned[i].second, i);
+  }
+  std::vector<int> ids = {-1, 0, 1, 2, 3, 4, 5, 9999, 10000};
+  std::vector<int> rows(ids.size());
+  EXPECT_TRUE(table.ToLocalRows(ids.data(), ids.size(), false, rows.data()));
+  for (size_t i = 0; i < ids.size(); ++i) {
+    if (ids[i] < 0 || ids[i] >= static_cast<int>(row_count) || shard_map.OwnerOf(ids[i]) != 1) {
+      EXPECT_EQ(rows[i], -1);
+    } else {
+      size_t bucket = shard_map.BucketOf(ids[i]);
+      EXPECT_EQ(rows[i], table.SlotOf(bucket) * 3 + ids[i] % 3);
+    }
+  }
+}
+
+/// Feature: Consistent hash sharded embedding.
+/// Description: drain a table from 3 servers to 2 and spread it back while the rows are updated every step.
+/// Expectation: each row ends on its new owner with its last update, and the slots are released.
+TEST_F(TestEmbeddingShardRing, LiveMigration) {
+  size_t row_count = 5000;
+  auto servers = MakeServers(row_count, 3);
+  std::vector<int> ids;
+  for (int id = 0; id < static_cast<int>(row_count); id += 7) {
+    ids.push_back(id);
+  }
+  Migrate(&servers, {0, 1}, 1, ids);
+  EXPECT_TRUE(servers[2].table->OwnedBuckets().empty());
+  Migrate(&servers, {0, 1, 2}, 2, ids);
+  EmbeddingShardMap shard_map(row_count, {0, 1, 2}, 0);
+  EXPECT_EQ(servers[2].table->OwnedBuckets().size(), shard_map.OwnedBuckets(2).size());
+
+  // The migration can't be prepared twice or without enough slots, and is aborted before the commit.
+  EXPECT_EQ(servers[0].table->Prepare({0}, 3), EmbeddingMigrationState::kFailed);
+  EXPECT_EQ(servers[0].table->state(), EmbeddingMigrationState::kIdle);
+  EXPECT_NE(servers[0].table->Prepare({0, 1}, 3), EmbeddingMigrationState::kFailed);
+  EXPECT_EQ(servers[0].table->Prepare({0, 2}, 4), EmbeddingMigrationState::kFailed);
+  EXPECT_TRUE(servers[0].table->Abort(3));
+  EXPECT_EQ(servers[0].table->state(), EmbeddingMigrationState::kIdle);
+  EXPECT_EQ(servers[0].table->OwnedBuckets().size(), shard_map.OwnedBuckets(0).size());
+  EXPECT_EQ(servers[0].table->Prepare({0, 1}, 2), EmbeddingMigrationState::kFailed);
+}
+
+/// Feature: Consistent hash sharded embedding.
+/// Description: one server refuses the precommit of a migration which the others have precommitted.
+/// Expectation: all the servers roll back, and none of them waits for the handoff or the decision.
+TEST_F(TestEmbeddingShardRing, RollbackPrecommit) {
+  size_t row_count = 5000;
+  auto servers = MakeServers(row_count, 3);
+  EmbeddingShardMap shard_map(row_count, {0, 1, 2}, 0);
+  for (auto &server : servers) {
+    EXPECT_NE(server.table->Prepare({0, 1}, 1), EmbeddingMigrationState::kFailed);
+    for (size_t round = 0; round <= kMaxEmbeddingPreCopyRounds; ++round) {
+      (void)server.table->NextCopyBuckets(kMaxEmbeddingBucketNum);
+    }
+    EXPECT_EQ(server.table->state(), EmbeddingMigrationState::kConverged);
+  }
+  // The rows of the buckets failed to be sent are copied again.
+  auto moves = servers[2].table->NextCopyBuckets(kMaxEmbeddingBucketNum);
+  EXPECT_TRUE(moves.empty());
+  auto owned = servers[2].table->OwnedBuckets();
+  servers[2].table->MarkDirtyBuckets({owned[0].first, owned[1].first});
+  moves = servers[2].table->NextCopyBuckets(kMaxEmbeddingBucketNum);
+  EXPECT_EQ(moves.size(), 2);
+
+  // The server 2 is one step ahead of the others and refuses the switch step.
+  uint64_t switch_step = 5;
+  EXPECT_EQ(servers[0].table->Precommit(1, switch_step, 2), EmbeddingMigrationState::kPrecommitted);
+  EXPECT_EQ(servers[1].table->Precommit(1, switch_step, 2), EmbeddingMigrationState::kPrecommitted);
+  EXPECT_EQ(servers[2].table->Precommit(1, switch_step, 4), EmbeddingMigrationState::kFailed);
+  EXPECT_TRUE(servers[0].table->WaitingDecision(3));
+  for (uint32_t rank = 0; rank < servers.size(); ++rank) {
+    auto &table = servers[rank].table;
+    EXPECT_TRUE(table->Abort(1));
+    EXPECT_EQ(table->state(), EmbeddingMigrationState::kIdle);
+    EXPECT_FALSE(table->WaitingDecision(switch_step));
+    EXPECT_FALSE(table->WaitingIncoming(switch_step));
+    EXPECT_TRUE(table->HandoffBuckets(switch_step).empty());
+    EXPECT_EQ(table->OwnedBuckets().size(), shard_map.OwnedBuckets(rank).size());
+    uint64_t version;
+    std::vector<uint32_t> server_ranks;
+    uint64_t placement_step;
+    table->GetPlacement(&version, &server_ranks, &placement_step);
+    EXPECT_EQ(version, 0);
+    EXPECT_EQ(server_ranks, shard_map.server_ranks());
+  }
+  // The migration is prepared again with a new version.
+  EXPECT_NE(servers[0].table->Prepare({0, 1}, 2), EmbeddingMigrationState::kFailed);
+}
+}  // namespace ps
+}  // namespace mindspore
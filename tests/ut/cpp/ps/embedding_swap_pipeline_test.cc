@@ -0,0 +1,180 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "common/common_test.h"
+#include "ps/ps_cache/embedding_swap_pipeline.h"
+
+namespace mindspore {
+namespace ps {
+class TestEmbeddingSwapPipeline : public UT::Common {
+ public:
+  TestEmbeddingSwapPipeline() = default;
+  virtual ~TestEmbeddingSwapPipeline() = default;
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+namespace {
+constexpr size_t kEmbeddingSize = 4;
+
+// An in memory parameter server of one embedding table, every request takes the latency. The pushes can be held
+// in the server until they are released, to check what runs while a push is in flight.
+class FakeServer {
+ public:
+  explicit FakeServer(size_t latency_ms) : latency_ms_(latency_ms) {}
+
+  bool Push(size_t, const std::vector<int> &ids, const std::vector<float> &values) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(latency_ms_));
+    std::unique_lock<std::mutex> locker(mutex_);
+    ++pushing_num_;
+    cond_var_.notify_all();
+    cond_var_.wait(locker, [this]() { return !hold_push_; });
+    --pushing_num_;
+    for (size_t i = 0; i < ids.size(); ++i) {
+      table_[ids[i]].assign(values.begin() + i * kEmbeddingSize, values.begin() + (i + 1) * kEmbeddingSize);
+    }
+    return true;
+  }
+
+  bool Pull(size_t, const std::vector<int> &ids, std::vector<float> *values) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(latency_ms_));
+    std::lock_guard<std::mutex> locker(mutex_);
+    values->assign(ids.size() * kEmbeddingSize, 0);
+    for (size_t i = 0; i < ids.size(); ++i) {
+      auto iter = table_.find(ids[i]);
+      if (iter != table_.end()) {
+        std::copy(iter->second.begin(), iter->second.end(), values->begin() + i * kEmbeddingSize);
+      }
+    }
+    return true;
+  }
+
+  void HoldPush() {
+    std::lock_guard<std::mutex> locker(mutex_);
+    hold_push_ = true;
+  }
+
+  void ReleasePush() {
+    {
+      std::lock_guard<std::mutex> locker(mutex_);
+      hold_push_ = false;
+    }
+    cond_var_.notify_all();
+  }
+
+  // Wait until the num pushes are held in the server.
+  void WaitPushing(size_t num) {
+    std::unique_lock<std::mutex> locker(mutex_);
+    cond_var_.wait(locker, [this, num]() { return pushing_num_ >= num; });
+  }
+
+  size_t pushing_num() {
+    std::lock_guard<std::mutex> locker(mutex_);
+    return pushing_num_;
+  }
+
+ private:
+  size_t latency_ms_;
+  std::mutex mutex_;
+  std::condition_variable cond_var_;
+  bool hold_push_{false};
+  size_t pushing_num_{0};
+  std::map<int, std::vector<float>> table_;
+};
+
+std::unique_ptr<EmbeddingSwapPipeline> CreatePipeline(FakeServer *server, size_t window_size) {
+  auto push_func = [server](size_t key, const std::vector<int> &ids, const std::vector<float> &values) {
+    return server->Push(key, ids, values);
+  };
+  auto pull_func = [server](size_t key, const std::vector<int> &ids, std::vector<float> *values) {
+    return server->Pull(key, ids, values);
+  };
+  return std::make_unique<EmbeddingSwapPipeline>(push_func, pull_func, window_size);
+}
+}  // namespace
+
+/// Feature: Embedding swap pipeline of ps cache.
+/// Description: Pull the ids which are being pushed asynchronously.
+/// Expectation: The pull waits for the push and reads the pushed embeddings.
+TEST_F(TestEmbeddingSwapPipeline, test_pull_after_push) {
+  const size_t latency_ms = 20;
+  FakeServer server(latency_ms);
+  auto pipeline = CreatePipeline(&server, 2);
+  const size_t key = 0;
+  for (size_t step = 0; step < 4; ++step) {
+    std::vector<int> ids = {static_cast<int>(step), static_cast<int>(step + 100)};
+    std::vector<float> values(ids.size() * kEmbeddingSize, static_cast<float>(step + 1));
+    ASSERT_TRUE(pipeline->PushAsync(step, key, std::move(ids), std::move(values)));
+  }
+  std::vector<float> pull_values;
+  auto pull_future = pipeline->PullAsync(key, {3, 100, 200}, &pull_values);
+  ASSERT_TRUE(pull_future.get());
+  ASSERT_EQ(pull_values.size(), 3 * kEmbeddingSize);
+  for (size_t i = 0; i < kEmbeddingSize; ++i) {
+    EXPECT_EQ(pull_values[i], 4.0f);
+    EXPECT_EQ(pull_values[kEmbeddingSize + i], 1.0f);
+    EXPECT_EQ(pull_values[2 * kEmbeddingSize + i], 0.0f);
+  }
+  ASSERT_TRUE(pipeline->WaitPushFinished());
+}
+
+/// Feature: Embedding swap pipeline of ps cache.
+/// Description: Hold the push of one step in the server, then push the next step and pull other ids.
+/// Expectation: The next step and the pull finish while the push is in flight, the step after the window blocks
+/// until the push finishes.
+TEST_F(TestEmbeddingSwapPipeline, test_swap_overlap) {
+  FakeServer server(0);
+  auto pipeline = CreatePipeline(&server, 2);
+  const size_t key = 0;
+  server.HoldPush();
+  ASSERT_TRUE(pipeline->PushAsync(0, key, {0}, std::vector<float>(kEmbeddingSize, 1.0f)));
+  server.WaitPushing(1);
+
+  // The step in the window is queued and the pull of other ids is served during the push.
+  ASSERT_TRUE(pipeline->PushAsync(1, key, {1}, std::vector<float>(kEmbeddingSize, 2.0f)));
+  std::vector<float> pull_values;
+  ASSERT_TRUE(pipeline->PullAsync(key, {2}, &pull_values).get());
+  EXPECT_EQ(pull_values.size(), kEmbeddingSize);
+  EXPECT_EQ(server.pushing_num(), 1);
+
+  // The step out of the window waits for the earlier pushes.
+  auto push_future = std::async(std::launch::async, [&pipeline, key]() {
+    return pipeline->PushAsync(2, key, {2}, std::vector<float>(kEmbeddingSize, 3.0f));
+  });
+  EXPECT_EQ(push_future.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+  server.ReleasePush();
+  ASSERT_TRUE(push_future.get());
+  ASSERT_TRUE(pipeline->WaitPushFinished());
+
+  ASSERT_TRUE(pipeline->PullAsync(key, {0, 1, 2}, &pull_values).get());
+  ASSERT_EQ(pull_values.size(), 3 * kEmbeddingSize);
+  for (size_t i = 0; i < kEmbeddingSize; ++i) {
+    EXPECT_EQ(pull_values[i], 1.0f);
+    EXPECT_EQ(pull_values[kEmbeddingSize + i], 2.0f);
+    EXPECT_EQ(pull_values[2 * kEmbeddingSize + i], 3.0f);
+  }
+}
+}  // namespace ps
+}  // namespace mindspore
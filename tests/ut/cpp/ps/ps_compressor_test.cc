@@ -0,0 +1,319 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include "common/common_test.h"
+#include "ps/ps_compressor.h"
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace ps {
+class TestPSCompressor : public UT::Common {
+ public:
+  TestPSCompressor() = default;
+  virtual ~TestPSCompressor() = default;
+
+  void SetUp() override {}
+  void TearDown() override {}
+
+  static std::vector<float> MakeData(size_t size) {
+    std::vector<float> data(size);
+    for (size_t i = 0; i < size; ++i) {
+      data[i] = std::sin(static_cast<float>(i) * 0.37f) * static_cast<float>(i % 13);
+    }
+    return data;
+  }
+
+  // Train a noisy quadratic 0.5 * h * (w - w_star)^2 with the momentum optimizer of the server, the gradients are
+  // pushed by 'push_type' and the weights are pulled by the delta encoding if 'delta_pull'. Return the ratio of the
+  // final loss to the initial one and add the bytes sent each step.
+  static double TrainQuadratic(PSCompressType push_type, float sparse_rate, float lr, bool delta_pull,
+                               double *push_bytes, double *pull_bytes) {
+    constexpr size_t kSize = 1 << 16;
+    constexpr size_t kStepNum = 300;
+    constexpr float kMomentum = 0.9f;
+    constexpr float kNoise = 0.1f;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> uniform(0.1f, 1.0f);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    std::vector<float> h(kSize);
+    std::vector<float> w_star(kSize);
+    for (size_t i = 0; i < kSize; ++i) {
+      h[i] = uniform(rng);
+      w_star[i] = normal(rng);
+    }
+    auto loss = [&h, &w_star](const std::vector<float> &w) {
+      double sum = 0;
+      for (size_t i = 0; i < w.size(); ++i) {
+        sum += 0.5 * h[i] * (w[i] - w_star[i]) * (w[i] - w_star[i]);
+      }
+      return sum;
+    };
+    std::vector<float> server_weight(kSize, 0.0f);
+    std::vector<float> server_accum(kSize, 0.0f);
+    std::vector<float> server_snapshot;
+    std::vector<float> worker_weight = server_weight;
+    double init_loss = loss(server_weight);
+    std::vector<float> grad(kSize);
+    std::vector<float> pushed(kSize);
+    std::vector<float> residual;
+    std::string compress_data;
+    for (uint32_t step = 1; step <= kStepNum; ++step) {
+      for (size_t i = 0; i < kSize; ++i) {
+        grad[i] = h[i] * (worker_weight[i] - w_star[i]) + kNoise * normal(rng);
+      }
+      if (push_type == PSCompressType::kNoCompress) {
+        pushed = grad;
+        *push_bytes += kSize * sizeof(float);
+      } else {
+        EXPECT_TRUE(
+          PSCompressor::Compress(push_type, grad.data(), kSize, sparse_rate, step, &residual, &compress_data));
+        EXPECT_TRUE(PSCompressor::Decompress(push_type, compress_data, pushed.data(), kSize));
+        *push_bytes += compress_data.size();
+      }
+      for (size_t i = 0; i < kSize; ++i) {
+        server_accum[i] = server_accum[i] * kMomentum + pushed[i];
+        server_weight[i] -= lr * server_accum[i];
+      }
+      // The first pull sends the full weight as the snapshot of both sides.
+      if (!delta_pull || step == 1) {
+        server_snapshot = server_weight;
+        worker_weight = server_weight;
+        *pull_bytes += kSize * sizeof(float);
+      } else {
+        EXPECT_TRUE(PSCompressor::EncodeDelta(server_weight.data(), kSize, step, &server_snapshot, &compress_data));
+        EXPECT_TRUE(PSCompressor::DecodeDelta(compress_data, &worker_weight));
+        *pull_bytes += compress_data.size();
+      }
+    }
+    *push_bytes /= kStepNum;
+    *pull_bytes /= kStepNum;
+    return loss(server_weight) / init_loss;
+  }
+};
+
+/// Feature: PS compressor.
+/// Description: top-k keeps the largest elements and the others stay in the residual.
+/// Expectation: the decoded data plus the residual equals the input.
+TEST_F(TestPSCompressor, TopKWithErrorFeedback) {
+  std::vector<float> data = {0.1, -5, 0.2, 3, -0.3, 0.05, 4, -0.01};
+  std::vector<float> residual;
+  std::string compress_data;
+  EXPECT_TRUE(PSCompressor::Compress(PSCompressType::kTopK, data.data(), data.size(), 0.3, 1, &residual,
+                                     &compress_data));
+  std::vector<float> decoded(data.size());
+  EXPECT_TRUE(PSCompressor::Decompress(PSCompressType::kTopK, compress_data, decoded.data(), decoded.size()));
+  std::vector<float> expect = {0, -5, 0, 3, 0, 0, 4, 0};
+  EXPECT_EQ(decoded, expect);
+  for (size_t i = 0; i < data.size(); ++i) {
+    EXPECT_FLOAT_EQ(decoded[i] + residual[i], data[i]);
+  }
+
+  // The residual is pushed with the next gradient.
+  std::vector<float> zeros(data.size(), 0);
+  EXPECT_TRUE(PSCompressor::Compress(PSCompressType::kTopK, zeros.data(), zeros.size(), 0.3, 2, &residual,
+                                     &compress_data));
+  EXPECT_TRUE(PSCompressor::Decompress(PSCompressType::kTopK, compress_data, decoded.data(), decoded.size()));
+  EXPECT_FLOAT_EQ(decoded[2], 0.2);
+  EXPECT_FLOAT_EQ(decoded[4], -0.3);
+  EXPECT_FLOAT_EQ(decoded[0], 0.1);
+}
+
+/// Feature: PS compressor.
+/// Description: top-k of the large data whose threshold is estimated on the samples, with many equal magnitudes.
+/// Expectation: exactly k elements are kept and none of the dropped elements is larger than the kept ones.
+TEST_F(TestPSCompressor, TopKLargeData) {
+  size_t size = 64 * 64 * 5 + 3;
+  std::vector<float> data = MakeData(size);
+  for (size_t i = 0; i < size; i += 7) {
+    data[i] = std::round(data[i]);
+  }
+  for (float sparse_rate : {0.001f, 0.01f, 0.3f}) {
+    std::vector<float> residual;
+    std::string compress_data;
+    EXPECT_TRUE(PSCompressor::Compress(PSCompressType::kTopK, data.data(), size, sparse_rate, 1, &residual,
+                                       &compress_data));
+    std::vector<float> decoded(size);
+    EXPECT_TRUE(PSCompressor::Decompress(PSCompressType::kTopK, compress_data, decoded.data(), size));
+    size_t kept_num = 0;
+    float min_kept = 1e30;
+    float max_dropped = 0;
+    for (size_t i = 0; i < size; ++i) {
+      if (residual[i] == 0 && decoded[i] != 0) {
+        ++kept_num;
+        min_kept = std::min(min_kept, std::fabs(decoded[i]));
+      } else {
+        max_dropped = std::max(max_dropped, std::fabs(residual[i]));
+      }
+    }
+    EXPECT_EQ(kept_num, static_cast<size_t>(std::ceil(size * sparse_rate)));
+    EXPECT_GE(min_kept, max_dropped);
+  }
+}
+
+/// Feature: PS compressor.
+/// Description: stochastic quantization of 8 and 4 bits over several blocks.
+/// Expectation: the error of each element is less than one quantization step and is kept in the residual.
+TEST_F(TestPSCompressor, StochasticQuant) {
+  size_t size = kQuantBlockSize * 2 + 37;
+  std::vector<float> data = MakeData(size);
+  for (auto compress_type : {PSCompressType::kQuant8Bit, PSCompressType::kQuant4Bit}) {
+    float max_code = compress_type == PSCompressType::kQuant8Bit ? 255 : 15;
+    std::vector<float> residual;
+    std::string compress_data;
+    EXPECT_TRUE(PSCompressor::Compress(compress_type, data.data(), size, 1, 3, &residual, &compress_data));
+    std::vector<float> decoded(size);
+    EXPECT_TRUE(PSCompressor::Decompress(compress_type, compress_data, decoded.data(), size));
+    float step = 24.0f / max_code;
+    for (size_t i = 0; i < size; ++i) {
+      EXPECT_LE(std::fabs(decoded[i] - data[i]), step * 1.001f);
+      EXPECT_NEAR(decoded[i] + residual[i], data[i], 1e-5);
+    }
+    EXPECT_FALSE(PSCompressor::Decompress(compress_type, compress_data, decoded.data(), size - 1));
+  }
+}
+
+/// Feature: PS compressor.
+/// Description: the worker and the server update their snapshots by the same delta.
+/// Expectation: the snapshots are equal and close to the weight after each pull.
+TEST_F(TestPSCompressor, DeltaEncodedPull) {
+  size_t size = kQuantBlockSize + 100;
+  std::vector<float> weight = MakeData(size);
+  std::vector<float> server_snapshot = weight;
+  std::vector<float> worker_snapshot = weight;
+  std::string compress_data;
+  for (uint32_t step = 1; step <= 10; ++step) {
+    for (size_t i = 0; i < size; ++i) {
+      weight[i] -= 0.01f * std::cos(static_cast<float>(i + step));
+    }
+    EXPECT_TRUE(PSCompressor::EncodeDelta(weight.data(), size, step, &server_snapshot, &compress_data));
+    EXPECT_TRUE(PSCompressor::DecodeDelta(compress_data, &worker_snapshot));
+    EXPECT_EQ(server_snapshot, worker_snapshot);
+    for (size_t i = 0; i < size; ++i) {
+      EXPECT_NEAR(worker_snapshot[i], weight[i], 0.025f / 255);
+    }
+  }
+  EXPECT_EQ(PSCompressor::GetCompressType("DELTA_QUANT_8BIT"), PSCompressType::kDeltaQuant8Bit);
+  EXPECT_EQ(PSCompressor::GetCompressType("UNKNOWN"), PSCompressType::kNoCompress);
+}
+
+/// Feature: PS compressor.
+/// Description: compress the data with nan or inf, and the data whose quantization range overflows.
+/// Expectation: the compression fails without touching the residual or the snapshot, so the data is sent uncompressed.
+TEST_F(TestPSCompressor, NonFiniteData) {
+  size_t size = kQuantBlockSize * 2;
+  std::vector<float> data = MakeData(size);
+  std::string compress_data;
+  for (auto compress_type : {PSCompressType::kTopK, PSCompressType::kQuant8Bit, PSCompressType::kQuant4Bit}) {
+    std::vector<float> residual;
+    EXPECT_TRUE(PSCompressor::Compress(compress_type, data.data(), size, 0.1, 1, &residual, &compress_data));
+    std::vector<float> expect_residual = residual;
+    for (float value : {std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity()}) {
+      std::vector<float> bad_data = data;
+      bad_data[kQuantBlockSize + 1] = value;
+      EXPECT_FALSE(PSCompressor::Compress(compress_type, bad_data.data(), size, 0.1, 2, &residual, &compress_data));
+      EXPECT_EQ(residual, expect_residual);
+    }
+  }
+
+  // The range of the second block overflows, the first block must not be applied to the snapshot.
+  std::vector<float> weight(size, 1.0f);
+  weight[kQuantBlockSize] = -std::numeric_limits<float>::max();
+  weight[kQuantBlockSize + 1] = std::numeric_limits<float>::max();
+  std::vector<float> snapshot(size, 0.0f);
+  EXPECT_FALSE(PSCompressor::EncodeDelta(weight.data(), size, 1, &snapshot, &compress_data));
+  EXPECT_EQ(snapshot, std::vector<float>(size, 0.0f));
+  weight[kQuantBlockSize] = std::numeric_limits<float>::quiet_NaN();
+  EXPECT_FALSE(PSCompressor::EncodeDelta(weight.data(), size, 1, &snapshot, &compress_data));
+  EXPECT_EQ(snapshot, std::vector<float>(size, 0.0f));
+}
+
+/// Feature: PS compressor.
+/// Description: train a noisy quadratic with each compression of the push and the pull, and time the compression.
+/// Expectation: the quantized pushes and the delta encoded pulls converge as well as the uncompressed ones, top-k
+///              converges within 2 times of the loss, and the bytes sent are reduced by the compress ratio.
+TEST_F(TestPSCompressor, ConvergenceBenchmark) {
+  constexpr float kLr = 0.05f;
+  double push_bytes = 0;
+  double pull_bytes = 0;
+  double base_loss = TrainQuadratic(PSCompressType::kNoCompress, 1, kLr, false, &push_bytes, &pull_bytes);
+  double base_push_bytes = push_bytes;
+  MS_LOG(INFO) << "NO_COMPRESS loss ratio " << base_loss << ", push " << push_bytes << " bytes/step, pull "
+               << pull_bytes << " bytes/step.";
+  EXPECT_LT(base_loss, 0.01);
+
+  struct Config {
+    std::string name;
+    PSCompressType push_type;
+    float sparse_rate;
+    float lr;
+    bool delta_pull;
+    double max_loss_rate;
+    double max_push_rate;
+  };
+  // The delayed residual of top-k 1% is amplified by the momentum of the server, so its lr is scaled down.
+  std::vector<Config> configs = {
+    {"QUANT_8BIT", PSCompressType::kQuant8Bit, 1, kLr, false, 1.05, 0.26},
+    {"QUANT_4BIT", PSCompressType::kQuant4Bit, 1, kLr, false, 1.05, 0.13},
+    {"TOPK 10%", PSCompressType::kTopK, 0.1f, kLr, false, 2, 0.21},
+    {"TOPK 1%", PSCompressType::kTopK, 0.01f, kLr / 10, false, 2, 0.021},
+    {"QUANT_8BIT + DELTA_QUANT_8BIT", PSCompressType::kQuant8Bit, 1, kLr, true, 1.05, 0.26}};
+  for (const auto &config : configs) {
+    push_bytes = 0;
+    pull_bytes = 0;
+    double loss = TrainQuadratic(config.push_type, config.sparse_rate, config.lr, config.delta_pull, &push_bytes,
+                                 &pull_bytes);
+    MS_LOG(INFO) << config.name << " loss ratio " << loss << ", push " << push_bytes << " bytes/step, pull "
+                 << pull_bytes << " bytes/step.";
+    EXPECT_LT(loss, base_loss * config.max_loss_rate);
+    EXPECT_LT(push_bytes, base_push_bytes * config.max_push_rate);
+    if (config.delta_pull) {
+      EXPECT_LT(pull_bytes, base_push_bytes * 0.27);
+    }
+  }
+
+  constexpr size_t kSize = 1 << 20;
+  constexpr size_t kRepeatNum = 10;
+  std::vector<float> data = MakeData(kSize);
+  std::vector<float> decoded(kSize);
+  std::string compress_data;
+  auto throughput = [](size_t repeat_num, const std::chrono::steady_clock::time_point &start) {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return kSize * sizeof(float) * repeat_num / seconds / 1e9;
+  };
+  for (auto compress_type : {PSCompressType::kTopK, PSCompressType::kQuant8Bit, PSCompressType::kQuant4Bit}) {
+    std::vector<float> residual;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < kRepeatNum; ++i) {
+      EXPECT_TRUE(PSCompressor::Compress(compress_type, data.data(), kSize, 0.01f, i, &residual, &compress_data));
+    }
+    double encode_throughput = throughput(kRepeatNum, start);
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < kRepeatNum; ++i) {
+      EXPECT_TRUE(PSCompressor::Decompress(compress_type, compress_data, decoded.data(), kSize));
+    }
+    MS_LOG(INFO) << "Compress type " << static_cast<uint32_t>(compress_type) << " encode " << encode_throughput
+                 << " GB/s, decode " << throughput(kRepeatNum, start) << " GB/s.";
+  }
+}
+}  // namespace ps
+}  // namespace mindspore
@@ -0,0 +1,183 @@
+/**
+ * Copyright 2022 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+#include "common/common_test.h"
+#include "ps/striped_mutex.h"
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace ps {
+class TestStripedMutex : public UT::Common {
+ public:
+  TestStripedMutex() = default;
+  virtual ~TestStripedMutex() = default;
+
+  void SetUp() override {}
+  void TearDown() override {}
+
+  // Write the rows of the ids in the way of ParameterServer::UpdateEmbeddings, every value of a row is the same.
+  static void UpdateRows(StripedMutex *row_mutexes, const std::vector<size_t> &ids, float value, size_t row_size,
+                         std::vector<float> *table) {
+    row_mutexes->ForEachStripe(ids.data(), ids.size(), [&](const size_t *positions, size_t num) {
+      for (size_t i = 0; i < num; i++) {
+        std::fill_n(table->begin() + ids[positions[i]] * row_size, row_size, value);
+      }
+    });
+  }
+
+  static std::vector<size_t> RandomIds(size_t num, size_t max_id, uint32_t seed) {
+    std::mt19937 engine(seed);
+    std::uniform_int_distribution<size_t> dist(0, max_id - 1);
+    std::vector<size_t> ids(num);
+    std::generate(ids.begin(), ids.end(), [&]() { return dist(engine); });
+    return ids;
+  }
+};
+
+/// Feature: Group the embedding rows by the lock stripe.
+/// Description: Group the ids of several chunks with duplicate ids.
+/// Expectation: Each position is visited once with the ids of the same stripe, and the duplicate ids keep their order.
+TEST_F(TestStripedMutex, test_for_each_stripe) {
+  StripedMutex row_mutexes;
+  auto ids = RandomIds(3000, 500, 0);
+  std::vector<size_t> visited(ids.size(), 0);
+  std::vector<size_t> last_position(500, 0);
+  std::vector<bool> seen(500, false);
+  row_mutexes.ForEachStripe(ids.data(), ids.size(), [&](const size_t *positions, size_t num) {
+    size_t stripe = ids[positions[0]] % kLockStripeNum;
+    for (size_t i = 0; i < num; i++) {
+      size_t id = ids[positions[i]];
+      EXPECT_EQ(stripe, id % kLockStripeNum);
+      EXPECT_TRUE(!seen[id] || last_position[id] < positions[i]);
+      seen[id] = true;
+      last_position[id] = positions[i];
+      visited[positions[i]]++;
+    }
+  });
+  EXPECT_TRUE(std::all_of(visited.begin(), visited.end(), [](size_t count) { return count == 1; }));
+}
+
+/// Feature: Accumulate the gradients and update the embedding rows concurrently.
+/// Description: The workers accumulate the gradients of the keys under the global mutex and update the embedding rows
+/// under the row stripes, while the optimizer applies to all the rows under all the row stripes.
+/// Expectation: No accumulation is lost and the optimizer never sees a row written partially.
+TEST_F(TestStripedMutex, test_concurrent_accum_grad_and_update_embeddings) {
+  constexpr size_t kWorkerNum = 4;
+  constexpr size_t kPushNum = 200;
+  constexpr size_t kKeyNum = 16;
+  constexpr size_t kRowNum = 1000;
+  constexpr size_t kRowSize = 16;
+  std::mutex accum_grad_mutex;
+  StripedMutex row_mutexes;
+  std::vector<float> grads(kKeyNum, 0);
+  std::vector<float> table(kRowNum * kRowSize, 0);
+  std::atomic<size_t> running_workers(kWorkerNum);
+  std::atomic<size_t> torn_rows(0);
+
+  std::vector<std::thread> workers;
+  for (size_t worker = 0; worker < kWorkerNum; worker++) {
+    (void)workers.emplace_back([&, worker]() {
+      for (size_t step = 0; step < kPushNum; step++) {
+        size_t key = (worker + step) % kKeyNum;
+        {
+          std::unique_lock<std::mutex> lock(accum_grad_mutex);
+          grads[key] += 1;
+        }
+        UpdateRows(&row_mutexes, RandomIds(64, kRowNum, worker * kPushNum + step), static_cast<float>(step), kRowSize,
+                   &table);
+      }
+      running_workers--;
+    });
+  }
+  std::thread optimizer([&]() {
+    while (running_workers > 0) {
+      auto row_locks = row_mutexes.LockAll();
+      for (size_t row = 0; row < kRowNum; row++) {
+        auto begin = table.begin() + row * kRowSize;
+        if (std::any_of(begin, begin + kRowSize, [&begin](float value) { return value != *begin; })) {
+          torn_rows++;
+        }
+      }
+    }
+  });
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  optimizer.join();
+
+  EXPECT_EQ(0, torn_rows.load());
+  EXPECT_EQ(static_cast<float>(kWorkerNum * kPushNum), std::accumulate(grads.begin(), grads.end(), 0.0f));
+}
+
+/// Feature: The throughput of the embedding updates of multiple workers.
+/// Description: The workers push random rows concurrently with the row stripes and with one global mutex.
+/// Expectation: The pushes per second of both are logged, and the rows are updated in both ways.
+TEST_F(TestStripedMutex, test_update_embeddings_benchmark) {
+  constexpr size_t kPushNum = 200;
+  constexpr size_t kIdNum = 4096;
+  constexpr size_t kRowNum = 100000;
+  constexpr size_t kRowSize = 16;
+  size_t worker_num = std::max<size_t>(std::thread::hardware_concurrency(), 2);
+  std::vector<std::vector<size_t>> worker_ids;
+  for (size_t worker = 0; worker < worker_num; worker++) {
+    (void)worker_ids.emplace_back(RandomIds(kIdNum, kRowNum, worker));
+  }
+
+  auto run = [&](const std::function<void(size_t, std::vector<float> *)> &push) {
+    std::vector<float> table(kRowNum * kRowSize, 0);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t worker = 0; worker < worker_num; worker++) {
+      (void)workers.emplace_back([&, worker]() {
+        for (size_t step = 0; step < kPushNum; step++) {
+          push(worker, &table);
+        }
+      });
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+    double cost = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(1.0f, table[worker_ids[0][0] * kRowSize]);
+    return worker_num * kPushNum / cost;
+  };
+
+  StripedMutex row_mutexes;
+  double striped = run([&](size_t worker, std::vector<float> *table) {
+    UpdateRows(&row_mutexes, worker_ids[worker], 1.0f, kRowSize, table);
+  });
+  std::mutex global_mutex;
+  double global = run([&](size_t worker, std::vector<float> *table) {
+    std::unique_lock<std::mutex> lock(global_mutex);
+    for (size_t id : worker_ids[worker]) {
+      std::fill_n(table->begin() + id * kRowSize, kRowSize, 1.0f);
+    }
+  });
+  MS_LOG(INFO) << worker_num << " workers push " << kIdNum << " rows of " << kRowSize
+               << " floats each time, row stripes: " << striped << " pushes/s, global mutex: " << global
+               << " pushes/s";
+}
+}  // namespace ps
+}  // namespace mindspore
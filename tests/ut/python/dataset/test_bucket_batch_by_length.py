@@ -496,6 +496,60 @@ def test_bucket_batch_invalid_column():
         assert "BucketBatchByLength: Couldn't find the specified column in the dataset" in str(info.value)
 
 
+def generate_lengths(lengths):
+    for n in lengths:
+        yield (np.array([j for j in range(n)]),)
+
+
+def test_bucket_batch_token_budget():
+    """
+    Feature: BucketBatchByLength
+    Description: Test batching by a token budget, rows are sorted by length within a window
+    Expectation: Every batch holds rows of similar length and its padded size stays within the budget
+    """
+    lengths = [5, 1, 4, 2, 3, 6, 1, 2]
+    dataset = ds.GeneratorDataset((lambda: generate_lengths(lengths)), ["col1"], shuffle=False)
+    dataset = dataset.bucket_batch_by_length(["col1"], None, None, pad_info={"col1": ([None], 0)},
+                                             max_tokens=8, window_size=4)
+
+    # The unfinished last batch of a window joins the next window, which is cut once 4 new rows have arrived
+    expected_output = [[[0, 0],
+                        [0, 1]],
+                       [[0, 1, 2, 3]],
+                       [[0, 0],
+                        [0, 1]],
+                       [[0, 1, 2]],
+                       [[0, 1, 2, 3, 4]],
+                       [[0, 1, 2, 3, 4, 5]]]
+
+    output = []
+    for data in dataset.create_dict_iterator(num_epochs=1, output_numpy=True):
+        output.append(data["col1"].tolist())
+
+    assert output == expected_output
+
+
+def test_bucket_batch_token_budget_invalid_input():
+    """
+    Feature: BucketBatchByLength
+    Description: Test invalid parameters of batching by a token budget
+    Expectation: Errors are raised
+    """
+    dataset = ds.GeneratorDataset((lambda: generate_sequential(10)), ["col1"])
+
+    with pytest.raises(ValueError) as info:
+        _ = dataset.bucket_batch_by_length(["col1"], None, None, max_tokens=0)
+    assert "max_tokens" in str(info.value)
+
+    with pytest.raises(ValueError) as info:
+        _ = dataset.bucket_batch_by_length(["col1"], None, None, max_tokens=8, window_size=-1)
+    assert "window_size" in str(info.value)
+
+    with pytest.raises(ValueError) as info:
+        _ = dataset.bucket_batch_by_length(["col1"], None, None, pad_to_bucket_boundary=True, max_tokens=8)
+    assert "pad_to_bucket_boundary can not be used when max_tokens is set" in str(info.value)
+
+
 if __name__ == '__main__':
     test_bucket_batch_invalid_input()
     test_bucket_batch_multi_bucket_no_padding()
@@ -511,3 +565,5 @@ if __name__ == '__main__':
     test_bucket_batch_three_columns()
     test_bucket_batch_get_dataset_size()
     test_bucket_batch_invalid_column()
+    test_bucket_batch_token_budget()
+    test_bucket_batch_token_budget_invalid_input()
@@ -439,6 +439,33 @@ def test_multiprocessing_timeout_interval():
     assert saved_config == ds.config.get_multiprocessing_timeout_interval()
 
 
+def test_enable_slab_allocator():
+    """
+    Feature: Test the function of get_enable_slab_allocator and set_enable_slab_allocator.
+    Description: Flip the slab allocator on and off, and run a pipeline with it enabled.
+    Expectation: The default state is False, the state updates on set, and the pipeline output is unchanged.
+    """
+    saved_config = ds.config.get_enable_slab_allocator()
+    assert isinstance(saved_config, bool)
+    assert saved_config is False
+    try:
+        ds.config.set_enable_slab_allocator(True)
+        assert ds.config.get_enable_slab_allocator() is True
+        data = ds.NumpySlicesDataset(np.arange(64 * 100, dtype=np.int32).reshape(64, 100), shuffle=False)
+        data = data.map(operations=[lambda x: x + 1], num_parallel_workers=4)
+        for i, item in enumerate(data.create_tuple_iterator(num_epochs=1, output_numpy=True)):
+            np.testing.assert_array_equal(item[0], np.arange(i * 100, (i + 1) * 100, dtype=np.int32) + 1)
+        ds.config.set_enable_slab_allocator(False)
+        assert ds.config.get_enable_slab_allocator() is False
+    finally:
+        ds.config.set_enable_slab_allocator(saved_config)
+    assert saved_config == ds.config.get_enable_slab_allocator()
+
+    # set_enable_slab_allocator will raise TypeError if input is not a boolean
+    config_error_func(ds.config.set_enable_slab_allocator, 1, TypeError, "enable must be of type bool")
+    config_error_func(ds.config.set_enable_slab_allocator, "True", TypeError, "enable must be of type bool")
+
+
 def test_config_bool_type_error():
     """
     Feature: Now many interfaces of config support bool input even its valid input is int.
@@ -484,4 +511,5 @@ if __name__ == '__main__':
     test_auto_num_workers()
     test_enable_watchdog()
     test_multiprocessing_timeout_interval()
+    test_enable_slab_allocator()
     test_config_bool_type_error()